@@ -156,11 +156,50 @@ static void HAL_SPICSAssert(void);
  */
 static void HAL_SPICSDeassert(void);
 
+#ifdef RADIO_SPI_DMA_ENABLE
+/*
+ * \brief Initializes the DMA channels moving the frame buffer data
+ */
+static void HAL_SPIDmaInit(void);
+
+/*
+ * \brief Starts a DMA transfer of a frame buffer access
+ * \param[in] address Address byte sent before the data
+ * \param[in] rxBuffer Buffer the data read is stored into, NULL to drop it
+ * \param[in] txBuffer Buffer the data written is taken from, NULL to send 0xFF
+ * \param[in] bufferLen Length of the data
+ * \param[in] done Callback called at the end of the transfer
+ */
+static void HAL_SPIDmaStart(uint8_t address, uint8_t *rxBuffer, uint8_t *txBuffer,
+  uint8_t bufferLen, RadioTransferDone_t done);
+
+/*
+ * \brief Ends the DMA transfer if the receive channel is complete
+ */
+static void HAL_SPIDmaPoll(void);
+
+/*
+ * \brief Waits for the end of an ongoing DMA transfer
+ */
+static void HAL_SPIDmaWait(void);
+#endif
+
 /***************************************** GLOBALS ***************************/
 static struct spi_module master;
 struct spi_slave_inst slave;
 static uint8_t dioStatus;	
 
+#ifdef RADIO_SPI_DMA_ENABLE
+/* The radio HAL is the only user of the DMA controller, the descriptor
+ * memory holds the channels of the SPI transfers only */
+COMPILER_ALIGNED(16) static DmacDescriptor spiDmaDescriptor[SX_RF_SPI_DMA_CHANNELS];
+COMPILER_ALIGNED(16) static DmacDescriptor spiDmaWriteBack[SX_RF_SPI_DMA_CHANNELS];
+static volatile bool spiDmaBusy;
+static RadioTransferDone_t spiDmaDone;
+static const uint8_t spiDmaTxFill = 0xFF;
+static uint8_t spiDmaRxSink;
+#endif
+
 /***************************************** MACROS *****************************/
 /*The SPI Baud rate needs to be defined in conf_board.h*/
 
@@ -169,6 +208,30 @@ static uint8_t dioStatus;
 #define SX_RF_SPI_BAUDRATE 2000000
 #endif
 
+#ifdef RADIO_SPI_DMA_ENABLE
+/* DMA channel feeding the SPI DATA register */
+#ifndef SX_RF_SPI_DMA_TX_CHANNEL
+#define SX_RF_SPI_DMA_TX_CHANNEL 0
+#endif
+
+/* DMA channel draining the SPI DATA register, it signals the end of a transfer */
+#ifndef SX_RF_SPI_DMA_RX_CHANNEL
+#define SX_RF_SPI_DMA_RX_CHANNEL 1
+#endif
+
+/* Number of DMA channels with a descriptor, the highest channel used plus one */
+#define SX_RF_SPI_DMA_CHANNELS   2
+
+/* DMA triggers of the radio SERCOM */
+#ifndef SX_RF_SPI_DMAC_ID_TX
+#define SX_RF_SPI_DMAC_ID_TX     SERCOM4_DMAC_ID_TX
+#endif
+
+#ifndef SX_RF_SPI_DMAC_ID_RX
+#define SX_RF_SPI_DMAC_ID_RX     SERCOM4_DMAC_ID_RX
+#endif
+#endif /* RADIO_SPI_DMA_ENABLE */
+
 /*********************************** Implementation***************************/
 
 /** 
@@ -279,6 +342,241 @@ void RADIO_FrameRead(uint8_t offset, uint8_t* buffer, uint8_t bufferLen)
     HAL_SPICSDeassert();
 }
 
+/** 
+ * \brief This function is used to write consecutive radio registers in one
+ * SPI transaction, the radio increments the register address after each byte
+ * \param[in] reg First radio register to be written
+ * \param[in] buffer Pointer to the values to be written into the registers
+ * \param[in] bufferLen Number of registers to be written
+ */
+void RADIO_RegisterBurstWrite(uint8_t reg, uint8_t* buffer, uint8_t bufferLen)
+{
+	RADIO_FrameWrite(reg, buffer, bufferLen);
+}
+
+/** 
+ * \brief This function is used to read consecutive radio registers in one
+ * SPI transaction, the radio increments the register address after each byte
+ * \param[in] reg First radio register to be read
+ * \param[in] buffer Pointer to the data where the register values are stored
+ * \param[in] bufferLen Number of registers to be read
+ */
+void RADIO_RegisterBurstRead(uint8_t reg, uint8_t* buffer, uint8_t bufferLen)
+{
+	RADIO_FrameRead(reg & 0x7F, buffer, bufferLen);
+}
+
+/** 
+ * \brief This function starts writing a stream of data into the Radio Frame buffer
+ * \param[in] offset FIFO offset to be written to
+ * \param[in] buffer Pointer to the data to be written, valid until done is called
+ * \param[in] bufferLen Length of the data to be written
+ * \param[in] done Function called when the transfer is complete, may be NULL
+ * \retval true if the transfer is started, false if another one is ongoing
+ */
+bool RADIO_FrameWriteAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioTransferDone_t done)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	if (spiDmaBusy)
+	{
+		return false;
+	}
+
+	if (bufferLen)
+	{
+		HAL_SPIDmaStart(REG_WRITE_CMD | offset, NULL, buffer, bufferLen, done);
+		return true;
+	}
+#endif
+	RADIO_FrameWrite(offset, buffer, bufferLen);
+	if (done)
+	{
+		done();
+	}
+	return true;
+}
+
+/** 
+ * \brief This function starts reading a stream of data from the Radio Frame buffer
+ * \param[in] offset FIFO offset to be read from
+ * \param[in] buffer Pointer to the data where the data is stored, valid until
+ * done is called
+ * \param[in] bufferLen Length of the data to be read from the frame buffer
+ * \param[in] done Function called when the transfer is complete, may be NULL
+ * \retval true if the transfer is started, false if another one is ongoing
+ */
+bool RADIO_FrameReadAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioTransferDone_t done)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	if (spiDmaBusy)
+	{
+		return false;
+	}
+
+	if (bufferLen)
+	{
+		HAL_SPIDmaStart(offset, buffer, NULL, bufferLen, done);
+		return true;
+	}
+#endif
+	RADIO_FrameRead(offset, buffer, bufferLen);
+	if (done)
+	{
+		done();
+	}
+	return true;
+}
+
+/** 
+ * \brief This function is used to check for an ongoing asynchronous frame transfer
+ * \retval true if a transfer is ongoing
+ */
+bool RADIO_SpiBusy(void)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	return spiDmaBusy;
+#else
+	return false;
+#endif
+}
+
+#ifdef RADIO_SPI_DMA_ENABLE
+/*
+ * \brief Initializes the DMA channels moving the frame buffer data
+ */
+static void HAL_SPIDmaInit(void)
+{
+	system_ahb_clock_set_mask(MCLK_AHBMASK_DMAC);
+
+	DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+	DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+	while (DMAC->CTRL.reg & DMAC_CTRL_SWRST);
+
+	DMAC->BASEADDR.reg = (uint32_t)spiDmaDescriptor;
+	DMAC->WRBADDR.reg = (uint32_t)spiDmaWriteBack;
+	DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN0 | DMAC_CTRL_LVLEN1 |
+		DMAC_CTRL_LVLEN2 | DMAC_CTRL_LVLEN3;
+
+	/* One beat per trigger: a byte is written when DATA is empty and read
+	 * when a byte is received, so the receive channel finishes last */
+	DMAC->CHID.reg = DMAC_CHID_ID(SX_RF_SPI_DMA_TX_CHANNEL);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_TRIGSRC(SX_RF_SPI_DMAC_ID_TX) | DMAC_CHCTRLB_TRIGACT_BEAT;
+
+	DMAC->CHID.reg = DMAC_CHID_ID(SX_RF_SPI_DMA_RX_CHANNEL);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_TRIGSRC(SX_RF_SPI_DMAC_ID_RX) | DMAC_CHCTRLB_TRIGACT_BEAT;
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+
+	spiDmaBusy = false;
+	system_interrupt_enable(SYSTEM_INTERRUPT_MODULE_DMA);
+}
+
+/*
+ * \brief Starts a DMA transfer of a frame buffer access
+ * \param[in] address Address byte sent before the data
+ * \param[in] rxBuffer Buffer the data read is stored into, NULL to drop it
+ * \param[in] txBuffer Buffer the data written is taken from, NULL to send 0xFF
+ * \param[in] bufferLen Length of the data
+ * \param[in] done Callback called at the end of the transfer
+ */
+static void HAL_SPIDmaStart(uint8_t address, uint8_t *rxBuffer, uint8_t *txBuffer,
+  uint8_t bufferLen, RadioTransferDone_t done)
+{
+	SercomSpi *const spi = &(master.hw->SPI);
+	DmacDescriptor *rxDesc = &spiDmaDescriptor[SX_RF_SPI_DMA_RX_CHANNEL];
+	DmacDescriptor *txDesc = &spiDmaDescriptor[SX_RF_SPI_DMA_TX_CHANNEL];
+	irqflags_t flags;
+
+	/* The address byte goes out by polling, the DMA moves the data only */
+	HAL_SPICSAssert();
+	HAL_SPISend(address);
+
+	spiDmaDone = done;
+	spiDmaBusy = true;
+
+	/* An incremented address is the end address of the block */
+	rxDesc->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+		DMAC_BTCTRL_BLOCKACT_NOACT | (rxBuffer ? DMAC_BTCTRL_DSTINC : 0);
+	rxDesc->BTCNT.reg = bufferLen;
+	rxDesc->SRCADDR.reg = (uint32_t)&spi->DATA.reg;
+	rxDesc->DSTADDR.reg = rxBuffer ? (uint32_t)(rxBuffer + bufferLen) : (uint32_t)&spiDmaRxSink;
+	rxDesc->DESCADDR.reg = 0;
+
+	txDesc->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+		DMAC_BTCTRL_BLOCKACT_NOACT | (txBuffer ? DMAC_BTCTRL_SRCINC : 0);
+	txDesc->BTCNT.reg = bufferLen;
+	txDesc->SRCADDR.reg = txBuffer ? (uint32_t)(txBuffer + bufferLen) : (uint32_t)&spiDmaTxFill;
+	txDesc->DSTADDR.reg = (uint32_t)&spi->DATA.reg;
+	txDesc->DESCADDR.reg = 0;
+
+	/* The receive channel is enabled first, the transmit channel is
+	 * triggered at once by the empty DATA register */
+	flags = cpu_irq_save();
+	DMAC->CHID.reg = DMAC_CHID_ID(SX_RF_SPI_DMA_RX_CHANNEL);
+	DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	DMAC->CHID.reg = DMAC_CHID_ID(SX_RF_SPI_DMA_TX_CHANNEL);
+	DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	cpu_irq_restore(flags);
+}
+
+/*
+ * \brief Ends the DMA transfer if the receive channel is complete
+ */
+static void HAL_SPIDmaPoll(void)
+{
+	RadioTransferDone_t done;
+	uint8_t channel = DMAC->CHID.reg;
+
+	DMAC->CHID.reg = DMAC_CHID_ID(SX_RF_SPI_DMA_RX_CHANNEL);
+	if (spiDmaBusy && (DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL))
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		DMAC->CHID.reg = channel;
+
+		HAL_SPICSDeassert();
+		done = spiDmaDone;
+		spiDmaDone = NULL;
+		spiDmaBusy = false;
+		if (done)
+		{
+			done();
+		}
+		return;
+	}
+	DMAC->CHID.reg = channel;
+}
+
+/*
+ * \brief Waits for the end of an ongoing DMA transfer. The flag is polled
+ * with interrupts masked, so that the wait also ends when the caller runs
+ * with interrupts disabled.
+ */
+static void HAL_SPIDmaWait(void)
+{
+	irqflags_t flags;
+
+	while (spiDmaBusy)
+	{
+		flags = cpu_irq_save();
+		HAL_SPIDmaPoll();
+		cpu_irq_restore(flags);
+	}
+}
+
+/*
+ * \brief DMA controller interrupt, ends the radio SPI transfer
+ */
+void DMAC_Handler(void)
+{
+	HAL_SPIDmaPoll();
+}
+#endif /* RADIO_SPI_DMA_ENABLE */
+
 
 #ifdef ENABLE_DIO0
 /** 
@@ -548,7 +846,10 @@ void HAL_RadioSpiInit(void)
 	
 	spi_init(&master, SX_RF_SPI, &config_spi_master);	
 	spi_enable(&master);
-	
+
+#ifdef RADIO_SPI_DMA_ENABLE
+	HAL_SPIDmaInit();
+#endif
 }
 
 
@@ -678,10 +979,14 @@ static void HAL_ResetPinOutputValue(uint8_t value)
 	}
 }
 /*
- * \brief This function is called to select a SPI slave
+ * \brief This function is called to select a SPI slave, after the end of
+ * an ongoing DMA transfer
  */
 static void HAL_SPICSAssert(void)
 {
+#ifdef RADIO_SPI_DMA_ENABLE
+	HAL_SPIDmaWait();
+#endif
 	spi_select_slave(&master, &slave, true);
 }
 
@@ -0,0 +1,71 @@
+/**
+* \file  lorawan_energy.h
+*
+* \brief LoRaWAN header file for the airtime and energy accounting
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+#ifndef _LORAWAN_ENERGY_H_
+#define _LORAWAN_ENERGY_H_
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+
+/*********************************************************************//**
+\brief	Airtime and energy accounting - clears the counters, restores the
+        default currents and starts counting the transceiver times from now
+
+\return					- none.
+*************************************************************************/
+void LorawanEnergyInit(void);
+
+/*********************************************************************//**
+\brief	Counts a frame sent by the radio on the current channel at the
+        current transmit power
+\param[in]  port - FPort of the frame, 0 for the join requests and the
+                   frames of MAC commands only
+\param[in]  timeOnAir - time on air in ms
+\param[in]  retransmission - true if the frame was sent before
+\return					- none.
+*************************************************************************/
+void LorawanEnergyTxDone(uint8_t port, uint32_t timeOnAir, bool retransmission);
+
+/*********************************************************************//**
+\brief	Fills the counters with the transceiver times and the charge
+\param[out] stats - counters since the last reset
+\return					- none.
+*************************************************************************/
+void LorawanEnergyGetStats(EnergyStats_t *stats);
+
+#endif // _LORAWAN_ENERGY_H_
+
+//eof lorawan_energy.h
@@ -46,6 +46,8 @@ extern "C" {
 #include "compiler.h"
 #include "lorawan_defs.h"
 #include "sal.h"
+#include "radio_interface.h"
+#include "system_trace.h"
 
 /****************************** DEFINES ***************************************/ 
 #define INVALID_VALUE         0xFF
@@ -55,7 +57,7 @@ extern "C" {
 
 #define RESERVED_FOR_FUTURE_USE                 0
 
-#define MAXIMUM_BUFFER_LENGTH                   271
+#define MAXIMUM_BUFFER_LENGTH                   255
 
 //Data rate (DR) encoding
 #define DR0                                     0
@@ -107,6 +109,70 @@ extern "C" {
 
 #define ABP_TIMEOUT_MS                          50
 
+/* Delay the link check may be postponed by to share the wakeup of another timer */
+#ifndef LINK_CHECK_TIMER_SLACK_MS
+#define LINK_CHECK_TIMER_SLACK_MS               1000
+#endif
+
+/* Number of frames the uplink queue holds */
+#ifndef LORAWAN_UPLINK_QUEUE_SIZE
+#define LORAWAN_UPLINK_QUEUE_SIZE               4
+#endif
+
+/* Wait of a queued frame the MAC refused without telling when to try again */
+#ifndef LORAWAN_UPLINK_QUEUE_RETRY_MS
+#define LORAWAN_UPLINK_QUEUE_RETRY_MS           1000
+#endif
+
+/* Number of aggregated frames, one filled while the others are sent */
+#ifndef LORAWAN_AGGREGATION_FRAMES
+#define LORAWAN_AGGREGATION_FRAMES              2
+#endif
+
+/* Largest aggregated frame, the maximum MACPayload of the regions */
+#ifndef LORAWAN_AGGREGATION_BUFFER_SIZE
+#define LORAWAN_AGGREGATION_BUFFER_SIZE         242
+#endif
+
+/* Age of the first record at which an aggregated frame is sent */
+#ifndef LORAWAN_AGGREGATION_MAX_AGE_MS
+#define LORAWAN_AGGREGATION_MAX_AGE_MS          60000
+#endif
+
+/* Priority of the records sent at once */
+#ifndef LORAWAN_AGGREGATION_FLUSH_PRIORITY
+#define LORAWAN_AGGREGATION_FLUSH_PRIORITY      1
+#endif
+
+/* Supply currents in uA of the energy estimate, SX1276 figures: transmit
+   current by power index on the RFO output with 2 dB per index, receive
+   in LoRa mode, standby, sleep, and a typical TCXO */
+#ifndef LORAWAN_ENERGY_TX_CURRENTS_UA
+#define LORAWAN_ENERGY_TX_CURRENTS_UA           {29000, 27000, 25000, 23500, 22000, 21000, 20000, 19000}
+#endif
+
+#ifndef LORAWAN_ENERGY_RX_CURRENT_UA
+#define LORAWAN_ENERGY_RX_CURRENT_UA            11500
+#endif
+
+#ifndef LORAWAN_ENERGY_STANDBY_CURRENT_UA
+#define LORAWAN_ENERGY_STANDBY_CURRENT_UA       1600
+#endif
+
+#ifndef LORAWAN_ENERGY_SLEEP_CURRENT_UA
+#define LORAWAN_ENERGY_SLEEP_CURRENT_UA         1
+#endif
+
+#ifndef LORAWAN_ENERGY_TCXO_CURRENT_UA
+#define LORAWAN_ENERGY_TCXO_CURRENT_UA          1500
+#endif
+
+/* Changes the state of the MAC, the change is traced as SYSTEM_TRACE_MAC_STATE */
+#define LORAWAN_SET_MAC_STATE(state)            do { \
+        SYSTEM_TRACE_EVENT(SYSTEM_TRACE_MAC_STATE, (state), loRa.macStatus.macState, 0); \
+        loRa.macStatus.macState = (state); \
+    } while (0)
+
 #define JA_JOIN_NONCE_SIZE                       3
 #define JA_NET_ID_SIZE                          3
 
@@ -394,6 +460,74 @@ typedef struct _LorawanMcastParams_t
 	LorawanMcastActivationParams_t activationParams[LORAWAN_MCAST_GROUP_COUNT_SUPPORTED];
 } LorawanMcastParams_t;
 
+typedef struct _LorawanUplinkQueueEntry
+{
+	/* Send request of the application, kept until its transaction completes */
+	LorawanSendReq_t *sendReq;
+	/* System time in us at which the frame is dropped, UINT64_MAX for never */
+	uint64_t expiryTime;
+	uint8_t priority;
+} LorawanUplinkQueueEntry_t;
+
+typedef struct _LorawanUplinkQueue
+{
+	/* Frames by decreasing priority, in order of queuing for the same priority */
+	LorawanUplinkQueueEntry_t entries[LORAWAN_UPLINK_QUEUE_SIZE];
+	/* System time in us before which the first frame is not released */
+	uint64_t releaseTime;
+	uint8_t count;
+	/* The first frame is handed to the MAC and waits for its transaction */
+	bool headInFlight;
+	uint8_t timerId;
+} LorawanUplinkQueue_t;
+
+/* Frames taken out of the uplink queue. The application is told about them
+   once the queue is consistent again, since it may queue frames from its
+   callback. */
+typedef struct _LorawanUplinkQueueDropped
+{
+	LorawanSendReq_t *sendReq[LORAWAN_UPLINK_QUEUE_SIZE];
+	StackRetStatus_t status[LORAWAN_UPLINK_QUEUE_SIZE];
+	uint8_t count;
+} LorawanUplinkQueueDropped_t;
+
+typedef enum _LorawanAggregationFrameState
+{
+	AGGREGATION_FRAME_FREE = 0,
+	AGGREGATION_FRAME_OPEN,
+	AGGREGATION_FRAME_QUEUED
+} LorawanAggregationFrameState_t;
+
+typedef struct _LorawanAggregationFrame
+{
+	LorawanSendReq_t sendReq;
+	uint8_t buffer[LORAWAN_AGGREGATION_BUFFER_SIZE];
+	/* Time on air in us of the frame once queued, and of its records in
+	   frames of their own */
+	uint32_t airtime;
+	uint32_t separateAirtime;
+	uint8_t records;
+	uint8_t priority;
+	LorawanAggregationFrameState_t state;
+} LorawanAggregationFrame_t;
+
+typedef struct _LorawanAggregation
+{
+	LorawanAggregationFrame_t frames[LORAWAN_AGGREGATION_FRAMES];
+	/* System time in us at which the open frame is queued, UINT64_MAX if none */
+	uint64_t flushTime;
+	AggregationStats_t stats;
+} LorawanAggregation_t;
+
+typedef struct _LorawanEnergy
+{
+	/* Counters of the MAC, the times of the transceiver are filled when read */
+	EnergyStats_t stats;
+	/* Times of the transceiver at the last reset */
+	RadioEnergyTimes_t radioBase;
+	EnergyCurrents_t currents;
+} LorawanEnergy_t;
+
 typedef union _JoinAccept
 {
 	uint8_t joinAcceptCounter[29];
@@ -495,12 +629,17 @@ typedef struct _Lora
 	LorawanLBT_t lbt;
 	ClassCParams classCParams;
 	LorawanMcastParams_t mcastParams;
+	LorawanUplinkQueue_t uplinkQueue;
+	LorawanAggregation_t aggregation;
+	LorawanEnergy_t energy;
 	bool isTransactionDone;
 	ecrConfig_t ecrConfig;
 	LinkAdrResp_t linkAdrResp;
 	bool retransmission;
 	uint8_t radioClkStableDelay;
 	uint8_t maxFcntPdsUpdateValue;
+	/* Uplink frame counter stored in PDS, fCntUp resumes from it after a reset */
+	uint32_t fCntUpCeiling;
 	bool cryptoDeviceEnabled;
     DevTime_t devTime;
     StackVersion_t stackVersion;
@@ -556,6 +695,8 @@ void ResetParametersForUnconfirmedTransmission (void);
 
 void SetJoinFailState(StackRetStatus_t status);
 
+void LorawanUpdateCmacSubkeys(void);
+
 uint16_t Random (uint16_t max);
 
 // MAC commands transmission functions
@@ -610,6 +751,8 @@ uint16_t LorawanGetDutyCycle (uint8_t channelId);
 
 uint8_t LorawanGetIsmBand(void) ;
 
+uint8_t LorawanGetFreePayloadSize (uint8_t dataRate);
+
 StackRetStatus_t LorawanSetEdClass(EdClass_t edclass);
 
 // Helper Functions
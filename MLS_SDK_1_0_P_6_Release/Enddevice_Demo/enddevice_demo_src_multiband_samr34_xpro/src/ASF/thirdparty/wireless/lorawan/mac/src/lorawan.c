@@ -43,6 +43,9 @@
 #include "lorawan_private.h"
 #include "lorawan_radio.h"
 #include "lorawan_mcast.h"
+#include "lorawan_uplink_queue.h"
+#include "lorawan_aggregation.h"
+#include "lorawan_energy.h"
 #include "aes_engine.h"
 #include "radio_interface.h"
 #include "sw_timer.h"
@@ -52,7 +55,6 @@
 #include "system_assert.h"
 #include "pds_interface.h"
 #include "sal.h"
-#include <math.h>
 
 /****************************** VARIABLES *************************************/
 
@@ -123,6 +125,8 @@ static uint32_t ExtractMic (uint8_t *buffer, uint8_t bufferLength);
 
 static uint32_t ComputeMic ( uint8_t *key, uint8_t* buffer, uint8_t bufferLength);
 
+static uint32_t ComputeDataMic (uint8_t *key, salItems_t keyType, uint8_t* buffer, uint8_t bufferLength);
+
 static uint8_t* MacExecuteCommands (uint8_t *buffer, uint8_t fOptsLen);
 
 static void MacClearCommands (void);
@@ -132,6 +136,7 @@ static void SetReceptionNotOkState (void);
 static uint8_t CountfOptsLength (uint8_t *flag);
 
 static uint8_t LorawanGetMaxPayloadSize (uint8_t dataRate);
+static StackRetStatus_t LorawanGetEarliestTxTime (EarliestTxTimeParams_t *params, uint64_t *earliestTxTime);
 
 static void FindSmallestDataRate (void);
 
@@ -141,13 +146,14 @@ static void StopReceiveWindow2Timer(void);
 
 static void handleTransmissionTimeoutCallback(void);
 
-static uint32_t calcPacketTimeOnAir(uint8_t datarate, uint8_t preambleLen,
-uint8_t impHdrMode, uint8_t crcOn, uint8_t cr, uint8_t length);
-
 static void lorawanADR(FCtrl_t *fCtrl);
 
+static void ReserveFcntUp(bool renew);
+
 static StackRetStatus_t checkRxPacketPayloadLen(uint8_t bufferLength, Hdr_t *hdr);
 
+static StackRetStatus_t ProcessJoinAccept(uint8_t *buffer, uint8_t bufferLength);
+
 
 /*********************************************************************//**
 \brief	This function calls the respective callback function of the
@@ -268,6 +274,7 @@ StackRetStatus_t LORAWAN_Reset (IsmBand_t ismBand)
     loRa.lastPacketLength = 0;
     loRa.fCntDown.value = 0;
     loRa.fCntUp.value = 0;
+    loRa.fCntUpCeiling = 0;
     loRa.devNonce = MAC_DEVNONCE;
     loRa.joinNonce = MAC_JOINNONCE;
     loRa.joinNonceType = JOIN_NONCE_INCREMENTAL;
@@ -281,7 +288,7 @@ StackRetStatus_t LORAWAN_Reset (IsmBand_t ismBand)
 	loRa.lbt.maxRetryChannels = 0;
     memset(&loRa.cbPar, 0, sizeof(appCbParams_t));
     loRa.isTransactionDone = true;
-    loRa.macStatus.macState = IDLE;
+    LORAWAN_SET_MAC_STATE(IDLE);
 	memset(&loRa.linkAdrResp,0x00,sizeof(LinkAdrResp_t));
     // link check mechanism should be disabled
     loRa.macStatus.linkCheck = DISABLED;
@@ -296,6 +303,9 @@ StackRetStatus_t LORAWAN_Reset (IsmBand_t ismBand)
     loRa.maxRepetitionsUnconfirmedUplink = MAC_UNCONFIRMABLE_UPLINK_REPITITIONS_MAX; // 0 retransmissions should occur for each unconfirmed frame sent until a response is received
     loRa.counterRepetitionsConfirmedUplink = DEF_CNF_UL_REPT_CNT;
     loRa.counterRepetitionsUnconfirmedUplink = DEF_UNCNF_UL_REPT_CNT;
+
+	/* Erase the CMAC subkeys of the previous keys */
+	SAL_CmacSubkeyClear();
 	
     status = LORAREG_Init(ismBand);
 	if (status != LORAWAN_SUCCESS)
@@ -359,6 +369,9 @@ StackRetStatus_t LORAWAN_Reset (IsmBand_t ismBand)
     loRa.protocolParameters.adrAckLimit = ADR_ACK_LIMIT;
     LorawanLinkCheckConfigure (DISABLED); // disable the link check mechanism
     LorawanMcastInit();
+    LorawanUplinkQueueInit();
+    LorawanAggregationInit();
+    LorawanEnergyInit();
 
 	return status;
 }
@@ -716,7 +729,7 @@ void LorawanReceiveWindow1Callback (void)
 
         RadioReceiveParam_t RadioReceiveParam;
 
-        loRa.macStatus.macState = RX1_OPEN;
+        LORAWAN_SET_MAC_STATE(RX1_OPEN);
         ConfigureRadioRx(loRa.receiveWindow1Parameters.dataRate, loRa.receiveWindow1Parameters.frequency);
 
         RadioReceiveParam.action = RECEIVE_START;
@@ -751,7 +764,7 @@ void LorawanReceiveWindow2Callback(void)
 		 
         if(RADIO_GetState() == RADIO_STATE_IDLE)
         {
-            loRa.macStatus.macState = RX2_OPEN;
+            LORAWAN_SET_MAC_STATE(RX2_OPEN);
             LorawanConfigureRadioForRX2(true);
         }
         else
@@ -824,7 +837,7 @@ void LorawanGetChAndInitiateRadioTransmit(void)
     // if transmission was not possible, we must wait another ACK timeout seconds period of time to initiate a new transmission
     if (CLASS_A == loRa.edClass)
     {
-        loRa.macStatus.macState = RETRANSMISSION_DELAY;
+        LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
     }
 
     
@@ -845,11 +858,11 @@ void LorawanGetChAndInitiateRadioTransmit(void)
 
         ConfigureRadioTx(radioConfig);
         RadioTransmitParam.bufferLen = loRa.lastPacketLength;
-        RadioTransmitParam.bufferPtr = &macBuffer[16];
+        RadioTransmitParam.bufferPtr = macBuffer;
         //resend the last packet
         if (RADIO_Transmit (&RadioTransmitParam) == ERR_NONE)
         {
-            loRa.macStatus.macState = TRANSMISSION_OCCURRING;
+            LORAWAN_SET_MAC_STATE(TRANSMISSION_OCCURRING);
         }
         else
         {
@@ -939,7 +952,7 @@ void UnconfirmedTransmissionCallback (void)
     RadioTransmitParam_t RadioTransmitParam;
     radioConfig_t radioConfig;
     RadioTransmitParam.bufferLen = loRa.lastPacketLength;
-    RadioTransmitParam.bufferPtr = &macBuffer[16];
+    RadioTransmitParam.bufferPtr = macBuffer;
     NewTxChannelReq_t newTxChannelReq;
 
     newTxChannelReq.transmissionType = true;
@@ -959,7 +972,7 @@ void UnconfirmedTransmissionCallback (void)
         {
             if (CLASS_A == loRa.edClass)
             {
-                loRa.macStatus.macState = RETRANSMISSION_DELAY;
+                LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
             }
 
             SwTimerStart(loRa.transmissionErrorTimerId, MS_TO_US(TRANSMISSION_ERROR_TIMEOUT - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)TransmissionErrorCallback, NULL);
@@ -996,7 +1009,7 @@ void AutomaticReplyCallback (void)
 
     if (CLASS_A == loRa.edClass)
     {
-        loRa.macStatus.macState = IDLE;
+        LORAWAN_SET_MAC_STATE(IDLE);
     }
     else if (CLASS_C == loRa.edClass)
     {
@@ -1046,7 +1059,7 @@ void UpdateRetransmissionAckTimeoutState (void)
 {
     if (CLASS_A == loRa.edClass)
     {
-        loRa.macStatus.macState = RETRANSMISSION_DELAY;
+        LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
     }
     SwTimerStart(loRa.ackTimeoutTimerId, MS_TO_US(loRa.protocolParameters.retransmitTimeout - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)AckRetransmissionCallback, NULL);
 }
@@ -1057,7 +1070,7 @@ void UpdateJoinSuccessState(void)
     loRa.macStatus.networkJoined = 1;   //network is joined
 	PDS_STORE(PDS_MAC_LORAWAN_STATUS);
     loRa.fCntUp.value = 0;   // uplink counter becomes 0
-	PDS_STORE(PDS_MAC_FCNT_UP);
+	ReserveFcntUp(true);
 	if(loRa.featuresSupported & JOIN_BACKOFF_SUPPORT)
 	{
 	loRa.joinreqinfo.isFirstJoinReq=false;
@@ -1074,7 +1087,7 @@ void UpdateJoinSuccessState(void)
     loRa.adrAckCnt = 0;  // adr ack counter becomes 0, it increments only for ADR set
     loRa.counterAdrAckDelay = 0;
 
-	loRa.macStatus.macState = IDLE;
+	LORAWAN_SET_MAC_STATE(IDLE);
 	if (!loRa.joinAcceptChMaskReceived)
 	{
 		LORAREG_SetAttr(REG_JOIN_SUCCESS,NULL);
@@ -1114,7 +1127,7 @@ void ResetParametersForConfirmedTransmission (void)
 {
     if (CLASS_A  == loRa.edClass)
     {
-        loRa.macStatus.macState = IDLE;
+        LORAWAN_SET_MAC_STATE(IDLE);
     }
 
     loRa.counterRepetitionsConfirmedUplink = DEF_CNF_UL_REPT_CNT;
@@ -1126,7 +1139,7 @@ void ResetParametersForUnconfirmedTransmission (void)
 {
     if (CLASS_A  == loRa.edClass)
     {
-        loRa.macStatus.macState = IDLE;
+        LORAWAN_SET_MAC_STATE(IDLE);
     }
 
     loRa.counterRepetitionsUnconfirmedUplink = DEF_UNCNF_UL_REPT_CNT;
@@ -1166,7 +1179,7 @@ void SetJoinFailState(StackRetStatus_t status)
 {
     loRa.macStatus.networkJoined = 0;
     loRa.lorawanMacStatus.joining = 0;
-    loRa.macStatus.macState = IDLE;
+    LORAWAN_SET_MAC_STATE(IDLE);
 	if(loRa.featuresSupported & JOIN_BACKOFF_SUPPORT)
 	{
 		loRa.joinreqinfo.isFirstJoinReq = false;
@@ -1215,14 +1228,14 @@ static void HandleAutoReplyFromRxDone(void)
 			{
 				minim = minim + 20;
 			}
-            loRa.macStatus.macState = RETRANSMISSION_DELAY;
+            LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
             SwTimerStart (loRa.automaticReplyTimerId, MS_TO_US(minim - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)AutomaticReplyCallback, NULL);
 
         }
 		else if(loRa.featuresSupported & LBT_SUPPORT)
 		{
 			LORAREG_GetAttr(MIN_LBT_CHANNEL_PAUSE_TIMER,&loRa.currentDataRate,&minim);			
-			loRa.macStatus.macState = RETRANSMISSION_DELAY;
+			LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
 			if(minim != UINT32_MAX)
 			{
 				minim = minim + 1;
@@ -1237,7 +1250,7 @@ static void LorawanNotifyAppOnRxdone(Hdr_t *hdr, uint8_t *packet, uint8_t frmPay
 {
 	if (CLASS_A == loRa.edClass)
 	{
-		loRa.macStatus.macState = IDLE;
+		LORAWAN_SET_MAC_STATE(IDLE);
 	}
 	else if (CLASS_C == loRa.edClass)
 	{
@@ -1269,7 +1282,6 @@ static void LorawanNotifyAppOnRxdone(Hdr_t *hdr, uint8_t *packet, uint8_t frmPay
 static StackRetStatus_t ProcessUnicastRxPacket(uint8_t* buffer, uint8_t bufferLength, Hdr_t *hdr)
 {
     uint8_t frmPayloadLength;
-    uint8_t bufferIndex;
     uint8_t fPort = 0;
     uint8_t *appskey = loRa.activationParameters.applicationSessionKeyRam;
 	uint8_t *nwkskey = loRa.activationParameters.networkSessionKeyRam;
@@ -1323,11 +1335,10 @@ static StackRetStatus_t ProcessUnicastRxPacket(uint8_t* buffer, uint8_t bufferLe
         fPort = *(buffer++);
 
         frmPayloadLength = bufferLength - 8 - hdr->members.fCtrl.fOptsLen - sizeof (extractedMic); //frmPayloadLength includes port
-        bufferIndex = 16 + 8 + hdr->members.fCtrl.fOptsLen + sizeof (fPort);
 
         if (fPort != 0)
         {
-            sal_status = EncryptFRMPayload (buffer, frmPayloadLength - 1, 1, loRa.fCntDown.value, appskey, SAL_APPS_KEY, bufferIndex, radioBuffer, loRa.activationParameters.deviceAddress.value);
+            sal_status = EncryptFRMPayload (buffer, frmPayloadLength - 1, 1, loRa.fCntDown.value, appskey, SAL_APPS_KEY, 0, buffer, loRa.activationParameters.deviceAddress.value);
             if (SAL_SUCCESS != sal_status)
 			{
 				SetReceptionNotOkState();
@@ -1341,7 +1352,7 @@ static StackRetStatus_t ProcessUnicastRxPacket(uint8_t* buffer, uint8_t bufferLe
 			if(hdr->members.fCtrl.fOptsLen == 0)
 			{
                 // Decrypt port 0 payload
-                sal_status = EncryptFRMPayload (buffer, frmPayloadLength - 1, 1, loRa.fCntDown.value, nwkskey, SAL_NWKS_KEY, bufferIndex, radioBuffer, loRa.activationParameters.deviceAddress.value);
+                sal_status = EncryptFRMPayload (buffer, frmPayloadLength - 1, 1, loRa.fCntDown.value, nwkskey, SAL_NWKS_KEY, 0, buffer, loRa.activationParameters.deviceAddress.value);
                 if (SAL_SUCCESS != sal_status)
                 {
 	                SetReceptionNotOkState();
@@ -1422,7 +1433,7 @@ static StackRetStatus_t ProcessUnicastRxPacket(uint8_t* buffer, uint8_t bufferLe
 				loRa.lorawanMacStatus.syncronization = 0;
 				if (CLASS_A  == loRa.edClass)
 				{
-					loRa.macStatus.macState = IDLE;
+					LORAWAN_SET_MAC_STATE(IDLE);
 				}
 				else if (CLASS_C == loRa.edClass)
 				{
@@ -1468,7 +1479,7 @@ static StackRetStatus_t ProcessUnicastRxPacket(uint8_t* buffer, uint8_t bufferLe
 			loRa.lorawanMacStatus.syncronization = 0;
 			if (CLASS_A  == loRa.edClass)
 			{
-				loRa.macStatus.macState = IDLE;
+				LORAWAN_SET_MAC_STATE(IDLE);
 			}	
 			else if (CLASS_C == loRa.edClass)
 			{
@@ -1501,6 +1512,103 @@ static StackRetStatus_t ProcessUnicastRxPacket(uint8_t* buffer, uint8_t bufferLe
 	return LORAWAN_SUCCESS;
 }
 
+static StackRetStatus_t ProcessJoinAccept(uint8_t *buffer, uint8_t bufferLength)
+{
+    uint32_t computedMic, extractedMic;
+    uint8_t temp;
+    SalStatus_t sal_status = SAL_SUCCESS;
+    uint32_t jNonce;
+
+    temp = bufferLength - 1; //MHDR not encrypted
+    //Decode message, all the blocks with one load of the key
+    sal_status = SAL_AESEncodeBlocks (&buffer[1], (temp + AES_BLOCKSIZE - 1) / AES_BLOCKSIZE, SAL_APP_KEY, loRa.activationParameters.applicationKey);
+    if (SAL_SUCCESS != sal_status)
+    {
+        SetJoinFailState(sal_status);
+        SetReceptionNotOkState();
+        return LORAWAN_RXPKT_ENCRYPTION_FAILED;
+    }
+
+    //verify MIC
+    computedMic = ComputeMic (loRa.activationParameters.applicationKey, buffer, bufferLength - sizeof(extractedMic));
+    extractedMic = ExtractMic (buffer, bufferLength);
+    if (extractedMic != computedMic)
+    {
+        if ((loRa.macStatus.macState == RX2_OPEN) || ((loRa.macStatus.macState == RX1_OPEN) && (loRa.rx2DelayExpired)))
+        {
+            SetJoinFailState(LORAWAN_MIC_ERROR);
+        }
+		SetReceptionNotOkState();
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    // if the join request message was received during receive window 1, receive window 2 should not open any more, so its timer will be stopped
+    if (loRa.macStatus.macState == RX1_OPEN)
+    {
+        SwTimerStop (loRa.joinAccept2TimerId);
+    }
+
+    JoinAccept_t *joinAccept;
+    joinAccept = (JoinAccept_t*)buffer;
+    
+    if (loRa.joinNonceType == JOIN_NONCE_INCREMENTAL)
+    {
+        jNonce = 0x00000000 | ((uint32_t) joinAccept->members.joinNonce[0]);
+        jNonce |= (uint32_t) ((uint32_t) joinAccept->members.joinNonce[1]) << 8;
+        jNonce |= (uint32_t) ((uint32_t) joinAccept->members.joinNonce[2]) << 16;
+
+        if (MAC_JOINNONCE != loRa.joinNonce)
+        {
+            if (jNonce <= loRa.joinNonce)
+            {
+                SetJoinFailState(LORAWAN_JOIN_NONCE_ERROR);
+                return LORAWAN_JOIN_NONCE_ERROR;
+            }
+        }
+        loRa.joinNonce = jNonce;
+        PDS_STORE(PDS_MAC_JOIN_NONCE);
+    }
+
+    loRa.activationParameters.deviceAddress.value = joinAccept->members.deviceAddress.value; //device address is saved
+	PDS_STORE(PDS_MAC_DEV_ADDR);
+    UpdateReceiveDelays (joinAccept->members.rxDelay & LAST_NIBBLE); //receive delay 1 and receive delay 2 are updated according to the rxDelay field from the join accept message
+
+    UpdateDLSettings(joinAccept->members.DLSettings.bits.rx2DataRate, joinAccept->members.DLSettings.bits.rx1DROffset);
+	
+	/* Reset the flag before checking whether CFList contains CHMask */
+	loRa.joinAcceptChMaskReceived = false;
+
+    UpdateCfList (bufferLength, joinAccept);
+
+    ComputeSessionKeys (joinAccept); //for activation by personalization, the network and application session keys are computed
+	
+	if (loRa.cryptoDeviceEnabled)
+	{
+		sal_status = SAL_Read(SAL_NWKS_KEY, (uint8_t *)&loRa.activationParameters.networkSessionKeyRam);
+		if (SAL_SUCCESS != sal_status)
+		{
+			SetJoinFailState(sal_status);
+			SetReceptionNotOkState();
+			return LORAWAN_SKEY_READ_FAILED;
+		}
+		sal_status = SAL_Read(SAL_APPS_KEY, (uint8_t *)&loRa.activationParameters.applicationSessionKeyRam);
+		if (SAL_SUCCESS != sal_status)
+		{
+			SetJoinFailState(sal_status);
+			SetReceptionNotOkState();
+			return LORAWAN_SKEY_READ_FAILED;
+		}
+	}
+	else
+	{
+		memcpy(loRa.activationParameters.applicationSessionKeyRam, loRa.activationParameters.applicationSessionKeyRom, 16);
+		memcpy(loRa.activationParameters.networkSessionKeyRam, loRa.activationParameters.networkSessionKeyRom, 16);
+	}
+	SAL_CmacSubkeyUpdate(SAL_NWKS_KEY, 0, loRa.activationParameters.networkSessionKeyRam);
+
+    return LORAWAN_SUCCESS;
+}
+
 StackRetStatus_t LorawanProcessFcntDown(Hdr_t *hdr, bool isMulticast)
 {
 	if (hdr->members.fCnt >= loRa.fCntDown.members.valueLow)
@@ -1546,117 +1654,26 @@ StackRetStatus_t LORAWAN_RxDone (uint8_t *buffer, uint8_t bufferLength)
 {
     uint32_t computedMic, extractedMic;
     Mhdr_t mhdr;
-    uint8_t temp;
 	uint8_t groupId;
     uint32_t fcntDown_temp;
-	SalStatus_t sal_status = SAL_SUCCESS;
-    uint32_t jNonce;
 
     if (loRa.macStatus.macPause == DISABLED)
     {
         mhdr.value = buffer[0];
         if ((mhdr.bits.mType == FRAME_TYPE_JOIN_ACCEPT) && (loRa.activationParameters.activationType == 0) && (loRa.lorawanMacStatus.joining == 1))
         {
-             temp = bufferLength - 1; //MHDR not encrypted
-             while (temp > 0)
-             {
-	             //Decode message
-	             sal_status = SAL_AESEncode (&buffer[bufferLength - temp], SAL_APP_KEY, loRa.activationParameters.applicationKey);
-				 if (SAL_SUCCESS != sal_status)
-				 {
-					 SetJoinFailState(sal_status);
-					 SetReceptionNotOkState();
-					 return LORAWAN_RXPKT_ENCRYPTION_FAILED;
-				 }
-				 
-	             if (temp > AES_BLOCKSIZE)
-	             {
-		             temp -= AES_BLOCKSIZE;
-	             }
-	             else
-	             {
-		             temp = 0;
-	             }
-             }
-         
-            //verify MIC
-            computedMic = ComputeMic (loRa.activationParameters.applicationKey, buffer, bufferLength - sizeof(extractedMic));
-            extractedMic = ExtractMic (buffer, bufferLength);
-            if (extractedMic != computedMic)
-            {
-                if ((loRa.macStatus.macState == RX2_OPEN) || ((loRa.macStatus.macState == RX1_OPEN) && (loRa.rx2DelayExpired)))
-                {
-                    SetJoinFailState(LORAWAN_MIC_ERROR);
-                }
-				SetReceptionNotOkState();
-                return LORAWAN_INVALID_PARAMETER;
-            }
+            StackRetStatus_t status;
 
-            // if the join request message was received during receive window 1, receive window 2 should not open any more, so its timer will be stopped
-            if (loRa.macStatus.macState == RX1_OPEN)
-            {
-                SwTimerStop (loRa.joinAccept2TimerId);
-            }
+            // the crypto device is kept awake from the decryption to the read of the session keys
+            SAL_BatchStart();
+            status = ProcessJoinAccept(buffer, bufferLength);
+            SAL_BatchEnd();
 
-            JoinAccept_t *joinAccept;
-            joinAccept = (JoinAccept_t*)buffer;
-            
-            if (loRa.joinNonceType == JOIN_NONCE_INCREMENTAL)
+            if (LORAWAN_SUCCESS == status)
             {
-                jNonce = 0x00000000 | ((uint32_t) joinAccept->members.joinNonce[0]);
-                jNonce |= (uint32_t) ((uint32_t) joinAccept->members.joinNonce[1]) << 8;
-                jNonce |= (uint32_t) ((uint32_t) joinAccept->members.joinNonce[2]) << 16;
-
-                if (MAC_JOINNONCE != loRa.joinNonce)
-                {
-                    if (jNonce <= loRa.joinNonce)
-                    {
-                        SetJoinFailState(LORAWAN_JOIN_NONCE_ERROR);
-                        return LORAWAN_JOIN_NONCE_ERROR;
-                    }
-                }
-                loRa.joinNonce = jNonce;
-                PDS_STORE(PDS_MAC_JOIN_NONCE);
+                UpdateJoinSuccessState();
             }
-
-            loRa.activationParameters.deviceAddress.value = joinAccept->members.deviceAddress.value; //device address is saved
-			PDS_STORE(PDS_MAC_DEV_ADDR);
-            UpdateReceiveDelays (joinAccept->members.rxDelay & LAST_NIBBLE); //receive delay 1 and receive delay 2 are updated according to the rxDelay field from the join accept message
-
-            UpdateDLSettings(joinAccept->members.DLSettings.bits.rx2DataRate, joinAccept->members.DLSettings.bits.rx1DROffset);
-			
-			/* Reset the flag before checking whether CFList contains CHMask */
-			loRa.joinAcceptChMaskReceived = false;
-
-            UpdateCfList (bufferLength, joinAccept);
-
-            ComputeSessionKeys (joinAccept); //for activation by personalization, the network and application session keys are computed
-			
-			if (loRa.cryptoDeviceEnabled)
-			{
-				sal_status = SAL_Read(SAL_NWKS_KEY, (uint8_t *)&loRa.activationParameters.networkSessionKeyRam);
-				if (SAL_SUCCESS != sal_status)
-				{
-					SetJoinFailState(sal_status);
-					SetReceptionNotOkState();
-					return LORAWAN_SKEY_READ_FAILED;
-				}
-				sal_status = SAL_Read(SAL_APPS_KEY, (uint8_t *)&loRa.activationParameters.applicationSessionKeyRam);
-				if (SAL_SUCCESS != sal_status)
-				{
-					SetJoinFailState(sal_status);
-					SetReceptionNotOkState();
-					return LORAWAN_SKEY_READ_FAILED;
-				}
-			}
-			else
-			{
-				memcpy(loRa.activationParameters.applicationSessionKeyRam, loRa.activationParameters.applicationSessionKeyRom, 16);
-				memcpy(loRa.activationParameters.networkSessionKeyRam, loRa.activationParameters.networkSessionKeyRom, 16);
-			}
-            UpdateJoinSuccessState();
-
-            return LORAWAN_SUCCESS;
+            return status;
         }
         else if (((mhdr.bits.mType == FRAME_TYPE_DATA_UNCONFIRMED_DOWN) || (mhdr.bits.mType == FRAME_TYPE_DATA_CONFIRMED_DOWN)) && (loRa.macStatus.networkJoined == 1))
         {
@@ -1757,18 +1774,7 @@ StackRetStatus_t LORAWAN_RxDone (uint8_t *buffer, uint8_t bufferLength)
                 AssembleEncryptionBlock (1, mcastfcnt->value, bufferLength - sizeof (computedMic), 0x49, devAddr);
             }
 			
-            memcpy (&radioBuffer[0], aesBuffer, sizeof (aesBuffer));
-            memcpy (&radioBuffer[16], buffer, bufferLength-sizeof(computedMic));
-			if(isMcastpkt)
-			{
-				SAL_AESCmac(nwkskey, SAL_MCAST_NWKS_KEY, aesBuffer, &radioBuffer[0], bufferLength - sizeof(computedMic) + sizeof (aesBuffer));
-			}
-			else
-			{
-				SAL_AESCmac(nwkskey, SAL_NWKS_KEY, aesBuffer, &radioBuffer[0], bufferLength - sizeof(computedMic) + sizeof (aesBuffer));
-			}
-
-            memcpy(&computedMic, aesBuffer, sizeof(computedMic));
+            computedMic = ComputeDataMic (nwkskey, isMcastpkt ? SAL_MCAST_NWKS_KEY : SAL_NWKS_KEY, buffer, bufferLength - sizeof(computedMic));
             extractedMic = ExtractMic (&buffer[0], bufferLength);
 
             // verify if the computed MIC is the same with the MIC piggybacked in the packet, if not ignore packet
@@ -2380,7 +2386,8 @@ static void UpdateLinkAdrCommands(uint16_t channelMask,uint8_t chMaskCntl,uint8_
 void AssemblePacket (bool confirmed, uint8_t port, uint8_t *buffer, uint16_t bufferLength)
 {
     Mhdr_t mhdr;
-    uint16_t bufferIndex = 16;
+    uint16_t bufferIndex = 0;
+    uint32_t mic;
     FCtrl_t fCtrl;
     uint16_t macCmdIdx = 0;
 	SalStatus_t sal_status = SAL_SUCCESS;
@@ -2478,15 +2485,14 @@ void AssemblePacket (bool confirmed, uint8_t port, uint8_t *buffer, uint16_t buf
 		bufferIndex = bufferIndex + macCmdIdx;
     }
 
-    AssembleEncryptionBlock (0, loRa.fCntUp.value, bufferIndex - 16, 0x49, loRa.activationParameters.deviceAddress.value);
-    memcpy (&macBuffer[0], aesBuffer, sizeof (aesBuffer));
+    AssembleEncryptionBlock (0, loRa.fCntUp.value, bufferIndex, 0x49, loRa.activationParameters.deviceAddress.value);
 
-    SAL_AESCmac (loRa.activationParameters.networkSessionKeyRam, SAL_NWKS_KEY, aesBuffer, macBuffer, bufferIndex  );
+    mic = ComputeDataMic (loRa.activationParameters.networkSessionKeyRam, SAL_NWKS_KEY, macBuffer, bufferIndex);
 
-    memcpy (&macBuffer[bufferIndex], aesBuffer, 4);
-    bufferIndex = bufferIndex + 4; // 4 is the size of MIC
+    memcpy (&macBuffer[bufferIndex], &mic, sizeof (mic));
+    bufferIndex = bufferIndex + sizeof (mic);
 
-    loRa.lastPacketLength = bufferIndex - 16;
+    loRa.lastPacketLength = bufferIndex;
 }
 
 uint8_t PrepareJoinRequestFrame (void)
@@ -2502,6 +2508,9 @@ uint8_t PrepareJoinRequestFrame (void)
     mhdr.bits.rfu = RESERVED_FOR_FUTURE_USE;
 
     macBuffer[bufferIndex++] = mhdr.value;  // add the mac header to the buffer
+
+    // the crypto device is kept awake from the read of the EUIs to the MIC
+    SAL_BatchStart();
     if (true == loRa.cryptoDeviceEnabled)
 	{
 		SAL_Read(SAL_JOIN_EUI,(uint8_t *) &loRa.activationParameters.joinEui.buffer);
@@ -2529,6 +2538,7 @@ uint8_t PrepareJoinRequestFrame (void)
     bufferIndex = bufferIndex + sizeof( loRa.devNonce );
 
     mic = ComputeMic (loRa.activationParameters.applicationKey, macBuffer, bufferIndex);
+    SAL_BatchEnd();
 
     memcpy ( &macBuffer[bufferIndex], &mic, sizeof (mic));
     bufferIndex = bufferIndex + sizeof(mic);
@@ -2711,14 +2721,14 @@ static void SetReceptionNotOkState (void)
 	{	// just drop the frame in class C, wait for timeout to notify application
 		loRa.isTransactionDone = true;
         loRa.enableRxcWindow = true;
-		loRa.macStatus.macState = RX2_OPEN;
+		LORAWAN_SET_MAC_STATE(RX2_OPEN);
 		//Continue to be in Receive mode with RX2
 		LorawanConfigureRadioForRX2(false);
 	}
 	else
     /* just drop the frame in class C, wait for timeout to notify application */
     {
-        loRa.macStatus.macState = RX2_OPEN;
+        LORAWAN_SET_MAC_STATE(RX2_OPEN);
         //Continue to be in Receive mode with RX2
         LorawanConfigureRadioForRX2(false);
     }
@@ -2817,7 +2827,7 @@ void UpdateJoinInProgress(uint8_t state)
     /* set the states and flags accordingly */
     loRa.macStatus.networkJoined = 0; //last join (if any) is not considered any more, a new join is requested
     loRa.lorawanMacStatus.joining = true;
-    loRa.macStatus.macState = state;
+    LORAWAN_SET_MAC_STATE(state);
 	PDS_STORE(PDS_MAC_LORAWAN_STATUS);
 }
 
@@ -3092,49 +3102,67 @@ static uint32_t ComputeMic ( uint8_t *key, uint8_t* buffer, uint8_t bufferLength
     return mic;
 }
 
+static uint32_t ComputeDataMic (uint8_t *key, salItems_t keyType, uint8_t* buffer, uint8_t bufferLength)  // the block B0 is in aesBuffer
+{
+    SalCmacContext_t cmac;
+    uint32_t mic = 0;
+
+    // B0 and the frame are given as two segments, the frame is not copied behind B0
+    SAL_AESCmacInit(&cmac, key, keyType);
+    SAL_AESCmacUpdate(&cmac, aesBuffer, sizeof (aesBuffer));
+    SAL_AESCmacUpdate(&cmac, buffer, bufferLength);
+    SAL_AESCmacFinal(&cmac, aesBuffer);
+
+    memcpy(&mic, aesBuffer, sizeof( mic ));
+
+    return mic;
+}
+
 SalStatus_t EncryptFRMPayload (uint8_t* buffer, uint8_t bufferLength, uint8_t dir, uint32_t frameCounter, uint8_t* key, uint8_t key_type, uint16_t macBufferIndex, uint8_t* bufferToBeEncrypted, uint32_t devAddr)
 {
-	SalStatus_t sal_status = SAL_SUCCESS;
-    uint8_t k = 0, i = 0, j = 0;
+    /* Counter mode, the block id of A_i is the counter starting from 1 */
+    AssembleEncryptionBlock (dir, frameCounter, 1, 0x01, devAddr);
 
-    k = bufferLength / AES_BLOCKSIZE;
-    for (i = 1; i <= k; i++)
-    {
-	    AssembleEncryptionBlock (dir, frameCounter, i, 0x01, devAddr);
-	    sal_status = SAL_AESEncode(aesBuffer, SAL_APPS_KEY, key);
-		if (SAL_SUCCESS != sal_status )
-		{
-			return sal_status;
-		}
-	    for (j = 0; j < AES_BLOCKSIZE; j++)
-	    {
-		    bufferToBeEncrypted[macBufferIndex++] = aesBuffer[j] ^ buffer[AES_BLOCKSIZE*(i-1) + j];
-	    }
-    }
+    return SAL_AESCtr(&bufferToBeEncrypted[macBufferIndex], buffer, bufferLength, aesBuffer, SAL_APPS_KEY, key);
+}
 
-    if ( (bufferLength % AES_BLOCKSIZE) != 0 )
-    {
-	    AssembleEncryptionBlock (dir, frameCounter, i, 0x01, devAddr);
-	    sal_status = SAL_AESEncode(aesBuffer, SAL_APPS_KEY, key);
-		if (SAL_SUCCESS != sal_status )
+
+/*********************************************************************//**
+\brief	Derives the CMAC subkeys of the keys the MICs are computed with:
+		AppKey, NwkSKey and the NwkSKey of the multicast groups
+*************************************************************************/
+void LorawanUpdateCmacSubkeys(void)
+{
+	uint8_t groupId;
+
+	SAL_CmacSubkeyClear();
+
+	if ((true != loRa.cryptoDeviceEnabled) && loRa.macKeys.applicationKey)
+	{
+		SAL_CmacSubkeyUpdate(SAL_APP_KEY, 0, loRa.activationParameters.applicationKey);
+	}
+
+	if (loRa.macKeys.networkSessionKey || loRa.macStatus.networkJoined)
+	{
+		SAL_CmacSubkeyUpdate(SAL_NWKS_KEY, 0, loRa.activationParameters.networkSessionKeyRam);
+	}
+
+	for (groupId = 0; groupId < LORAWAN_MCAST_GROUP_COUNT_SUPPORTED; groupId++)
+	{
+		if (loRa.mcastParams.activationParams[groupId].mcastKeysMask.mcastNetworkSessionKey)
 		{
-			return sal_status;
+			SAL_CmacSubkeyUpdate(SAL_MCAST_NWKS_KEY, groupId, loRa.mcastParams.activationParams[groupId].mcastNwkSKey);
 		}
-	    for (j = 0; j < (bufferLength % AES_BLOCKSIZE); j++)
-	    {
-		    bufferToBeEncrypted[macBufferIndex++] = aesBuffer[j] ^ buffer[(AES_BLOCKSIZE*k) + j];
-	    }
-    }
-     
-	return sal_status;
+	}
 }
 
-
 void UpdateTransactionCompleteCbParams(StackRetStatus_t status)
 {	
 	 loRa.isTransactionDone = true;
 	 
-    if ((AppPayload.AppData != NULL) && (loRa.evtmask & LORAWAN_EVT_TRANSACTION_COMPLETE) && (loRa.appHandle != NULL))
+	/* A queued frame which found no free channel is sent again later,
+	   without informing the application */
+    if ((false == LorawanUplinkQueueTransactionDone(status)) && (AppPayload.AppData != NULL) && (loRa.evtmask & LORAWAN_EVT_TRANSACTION_COMPLETE) && (loRa.appHandle != NULL))
     {       
 		loRa.cbPar.evt = LORAWAN_EVT_TRANSACTION_COMPLETE;
 		loRa.cbPar.param.transCmpl.status = status;
@@ -3145,8 +3173,8 @@ void UpdateTransactionCompleteCbParams(StackRetStatus_t status)
 	 {
 		loRa.appHandle = NULL;	 
 	 }
-	
-		  
+
+	 LorawanUplinkQueueSchedule();
 }
 
 void UpdateRxDataAvailableCbParams(uint32_t devAddr, uint8_t *pData,uint8_t dataLength,StackRetStatus_t status)
@@ -3303,6 +3331,66 @@ static uint8_t LorawanGetMaxPayloadSize (uint8_t dataRate)
     return result;
 }
 
+/*
+ * \brief Finds the application payload left beside the pending MAC answers
+ *        at a data rate. The answers which do not fit the FOpts field are
+ *        sent in a frame of their own beforehand, see LORAWAN_Send.
+ * \param[in] dataRate Data rate of the frame
+ * \return Free length of the FRMPayload
+ */
+uint8_t LorawanGetFreePayloadSize (uint8_t dataRate)
+{
+    uint8_t foptsFlag = false;
+    uint8_t macCmdReplyLen = CountfOptsLength(&foptsFlag);
+    uint8_t maxPayloadSize = LorawanGetMaxPayloadSize(dataRate);
+
+    if ((false == foptsFlag) || (macCmdReplyLen >= maxPayloadSize))
+    {
+        return maxPayloadSize;
+    }
+    return maxPayloadSize - macCmdReplyLen;
+}
+
+/*
+ * \brief Finds the system time from which the duty cycle allows sending
+ *        a frame of the given length at the given data rate. The sub-band
+ *        and aggregated off times are kept as absolute end times by the
+ *        regional module, so this is read from them without any timer.
+ *        Listen before talk is not predicted, it is decided when sending.
+ * \param[in] params Length of the application payload and data rate
+ * \param[out] earliestTxTime System time in us, the current time if the
+ *        frame can be sent now
+ */
+static StackRetStatus_t LorawanGetEarliestTxTime (EarliestTxTimeParams_t *params, uint64_t *earliestTxTime)
+{
+    uint64_t dutyCycleEndTime;
+    uint64_t now;
+
+    if (LORAREG_ValidateAttr(TX_DATARATE, &(params->dr)) != LORAWAN_SUCCESS)
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    if (params->length > LorawanGetMaxPayloadSize(params->dr))
+    {
+        return LORAWAN_INVALID_BUFFER_LENGTH;
+    }
+
+    now = SwTimerGetTime();
+    *earliestTxTime = now;
+
+    if ((loRa.featuresSupported & DUTY_CYCLE_SUPPORT) || (loRa.aggregatedDutyCycle != 0))
+    {
+        LORAREG_GetAttr(DUTY_CYCLE_END_TIME, &(params->dr), &dutyCycleEndTime);
+        if (dutyCycleEndTime > now)
+        {
+            *earliestTxTime = dutyCycleEndTime;
+        }
+    }
+
+    return LORAWAN_SUCCESS;
+}
+
 StackRetStatus_t LORAWAN_SetMulticastParam(LorawanAttributes_t attrType, void *attrValue)
 {
 	StackRetStatus_t result;
@@ -3418,6 +3506,7 @@ StackRetStatus_t LORAWAN_SetAttr(LorawanAttributes_t attrType, void *attrValue)
 			{
 				memcpy(loRa.activationParameters.networkSessionKeyRom, attrValue, 16);
 				memcpy(loRa.activationParameters.networkSessionKeyRam, attrValue, 16);
+				SAL_CmacSubkeyUpdate(SAL_NWKS_KEY, 0, loRa.activationParameters.networkSessionKeyRam);
 				PDS_STORE(PDS_MAC_NWK_SKEY);
 				loRa.macKeys.networkSessionKey = 1;
 				PDS_STORE(PDS_MAC_LORAWAN_MAC_KEYS);
@@ -3452,6 +3541,7 @@ StackRetStatus_t LORAWAN_SetAttr(LorawanAttributes_t attrType, void *attrValue)
 				if (true != loRa.cryptoDeviceEnabled)
 				{
 					memcpy( loRa.activationParameters.applicationKey, attrValue, 16);
+					SAL_CmacSubkeyUpdate(SAL_APP_KEY, 0, loRa.activationParameters.applicationKey);
 					PDS_STORE(PDS_MAC_APP_KEY);
 					loRa.macKeys.applicationKey = 1;
 					PDS_STORE(PDS_MAC_LORAWAN_MAC_KEYS);
@@ -3521,7 +3611,7 @@ StackRetStatus_t LORAWAN_SetAttr(LorawanAttributes_t attrType, void *attrValue)
 			if(fcntUp < FCNT_MAX)
 			{
 				loRa.fCntUp.value = fcntUp;
-				PDS_STORE(PDS_MAC_FCNT_UP);
+				ReserveFcntUp(true);
 				result = LORAWAN_SUCCESS;
 			}
 		}
@@ -3815,6 +3905,15 @@ StackRetStatus_t LORAWAN_SetAttr(LorawanAttributes_t attrType, void *attrValue)
 			result = LORAWAN_SUCCESS;
 		}
 		break;
+		case ENERGY_CURRENTS:
+		{
+			if (attrValue != NULL)
+			{
+				memcpy(&loRa.energy.currents, attrValue, sizeof(EnergyCurrents_t));
+				result = LORAWAN_SUCCESS;
+			}
+		}
+		break;
         case SEND_DEVICE_TIME_CMD:
         {
             result = EncodeDeviceTimeReq();
@@ -4298,8 +4397,7 @@ StackRetStatus_t LORAWAN_GetAttr(LorawanAttributes_t attrType, void *attrInput,
     break;
     case PACKET_TIME_ON_AIR:
     {
-        TimeOnAirParams_t *toaParams = (TimeOnAirParams_t *)attrInput;
-        *(uint32_t *) attrOutput = calcPacketTimeOnAir(toaParams->dr, toaParams->preambleLen, toaParams->impHdrMode, toaParams->crcOn, toaParams->cr, toaParams->pktLen);
+        result = LORAWAN_GetTimeOnAir((TimeOnAirParams_t *)attrInput, (uint32_t *)attrOutput);
     }
     break;
     case REGIONAL_DUTY_CYCLE:
@@ -4312,6 +4410,26 @@ StackRetStatus_t LORAWAN_GetAttr(LorawanAttributes_t attrType, void *attrInput,
             *(JoinNonceType_t *) attrOutput = loRa.joinNonceType;
         }
             break;
+    case EARLIEST_TX_TIME:
+    {
+        result = LorawanGetEarliestTxTime((EarliestTxTimeParams_t *)attrInput, (uint64_t *)attrOutput);
+    }
+    break;
+    case AGGREGATION_STATS:
+    {
+        memcpy(attrOutput, &loRa.aggregation.stats, sizeof(AggregationStats_t));
+    }
+    break;
+    case ENERGY_STATS:
+    {
+        LorawanEnergyGetStats((EnergyStats_t *)attrOutput);
+    }
+    break;
+    case ENERGY_CURRENTS:
+    {
+        memcpy(attrOutput, &loRa.energy.currents, sizeof(EnergyCurrents_t));
+    }
+    break;
     default:
         result = LORAWAN_INVALID_PARAMETER;
     break;
@@ -4341,12 +4459,12 @@ static void retransmitPacketInBuffer(void)
 			
 		ConfigureRadioTx(radioConfig);
 		RadioTransmitParam.bufferLen = loRa.lastPacketLength;
-		RadioTransmitParam.bufferPtr = &macBuffer[16];
+		RadioTransmitParam.bufferPtr = macBuffer;
 		//resend the last packet		
 		status = RADIO_Transmit (&RadioTransmitParam);
 		if (status == ERR_NONE)
 		{
-			loRa.macStatus.macState = TRANSMISSION_OCCURRING;
+			LORAWAN_SET_MAC_STATE(TRANSMISSION_OCCURRING);
 		}
 		else
 		{
@@ -4436,7 +4554,7 @@ void LORAWAN_TxDone(void *param)
 					{
 						loRa.lbt.elapsedChannels = 0;
 						PDS_STORE(PDS_MAC_LBT_PARAMS);
-						loRa.macStatus.macState = IDLE;
+						LORAWAN_SET_MAC_STATE(IDLE);
 						loRa.lorawanMacStatus.syncronization = DISABLED;
 						if (loRa.lorawanMacStatus.ackRequiredFromNextDownlinkMessage == ENABLED)
 						{		
@@ -4460,18 +4578,21 @@ void LORAWAN_TxDone(void *param)
 				int8_t rxWindowOffset1,rxWindowOffset2;
 				LorawanSendReq_t *LoRaCurrentSendReq = (LorawanSendReq_t *)loRa.appHandle;
 
-				loRa.lbt.elapsedChannels = 0;
-				PDS_STORE(PDS_MAC_LBT_PARAMS);
+				/* Only a transmission which had to retry channels changes the stored LBT parameters */
+				if (0 != loRa.lbt.elapsedChannels)
+				{
+					loRa.lbt.elapsedChannels = 0;
+					PDS_STORE(PDS_MAC_LBT_PARAMS);
+				}
+				LorawanEnergyTxDone(((loRa.lorawanMacStatus.joining == 1) || (NULL == LoRaCurrentSendReq)) ? 0 : LoRaCurrentSendReq->port,
+					localParam.TX.timeOnAir,
+					(0 != loRa.counterRepetitionsUnconfirmedUplink) || (0 != loRa.counterRepetitionsConfirmedUplink));
 				if ((0 == loRa.counterRepetitionsUnconfirmedUplink) && (0 == loRa.counterRepetitionsConfirmedUplink))
 				{
 					if (ENABLED == loRa.macStatus.networkJoined)
 					{
 						loRa.fCntUp.value ++;  // the uplink frame counter increments for every new transmission (it does not increment for a retransmission)
-						/* If maxFcntPdsUpdateValue is '0', means every-time the Frame counter will be updated in PDS */
-						if((0 == loRa.maxFcntPdsUpdateValue) || (0 == (loRa.fCntUp.value & ((1 << loRa.maxFcntPdsUpdateValue) - 1))))
-						{
-							PDS_STORE(PDS_MAC_FCNT_UP);
-						}
+						ReserveFcntUp(false);
 						if (LORAWAN_CNF == LoRaCurrentSendReq->confirmed)
 						{
 							loRa.lorawanMacStatus.ackRequiredFromNextDownlinkMessage = ENABLED;
@@ -4501,7 +4622,7 @@ void LORAWAN_TxDone(void *param)
 				//This flag is used when the reception in RX1 is overlapping the opening of RX2
 				loRa.rx2DelayExpired = 0;
 
-				loRa.macStatus.macState = BEFORE_RX1;
+				LORAWAN_SET_MAC_STATE(BEFORE_RX1);
 
 				rx1WindowParamsReq.currDr = loRa.currentDataRate;
 				rx1WindowParamsReq.drOffset = loRa.offset;
@@ -4677,7 +4798,7 @@ void LorawanCheckAndDoRetryOnTimeout(void)
         {
             if (CLASS_A == loRa.edClass)
             {
-                loRa.macStatus.macState = RETRANSMISSION_DELAY;
+                LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
                 SwTimerStart(loRa.ackTimeoutTimerId, MS_TO_US(loRa.protocolParameters.retransmitTimeout - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)AckRetransmissionCallback, NULL);				
             }
             else if (CLASS_C == loRa.edClass)
@@ -4747,7 +4868,7 @@ void LORAWAN_RxTimeout(void)
             // if the timeout is after the first receive window, we have to wait for the second receive window....
             if ( loRa.macStatus.macState == RX1_OPEN )
             {
-                loRa.macStatus.macState = BETWEEN_RX1_RX2;
+                LORAWAN_SET_MAC_STATE(BETWEEN_RX1_RX2);
             }
             else
             {
@@ -4799,12 +4920,12 @@ static void TransmissionErrorCallback (void)
 	
         ConfigureRadioTx(radioConfig);
         RadioTransmitParam.bufferLen = loRa.lastPacketLength;
-        RadioTransmitParam.bufferPtr = &macBuffer[16];
+        RadioTransmitParam.bufferPtr = macBuffer;
         if (RADIO_Transmit (&RadioTransmitParam) != ERR_NONE)
         {
             if(CLASS_A == loRa.edClass)
             {
-                loRa.macStatus.macState = RETRANSMISSION_DELAY;
+                LORAWAN_SET_MAC_STATE(RETRANSMISSION_DELAY);
             }
         }
         else
@@ -4849,6 +4970,11 @@ static StackRetStatus_t CreateAllSoftwareTimers (void)
 		retVal = SwTimerCreate(&loRa.linkCheckTimerId);
 	}
 
+    if (LORAWAN_SUCCESS == retVal)
+    {
+		retVal = SwTimerSetSlack(loRa.linkCheckTimerId, MS_TO_US(LINK_CHECK_TIMER_SLACK_MS));
+	}
+
     if (LORAWAN_SUCCESS == retVal)
     {	
 		retVal = SwTimerCreate(&loRa.ackTimeoutTimerId);
@@ -4879,6 +5005,11 @@ static StackRetStatus_t CreateAllSoftwareTimers (void)
 		retVal = SwTimerCreate(&loRa.classCParams.ulAckTimerId);
 	}
 
+    if (LORAWAN_SUCCESS == retVal)
+    {
+		retVal = SwTimerCreate(&loRa.uplinkQueue.timerId);
+	}
+
     if (LORAWAN_SUCCESS == retVal)
     {
         retVal = SwTimerTimestampCreate(&loRa.devTime.sysEpochTimeIndex);
@@ -4906,6 +5037,7 @@ static void StopAllSoftwareTimers (void)
     SwTimerStop(loRa.abpJoinTimerId);
     SwTimerStop(loRa.transmissionErrorTimerId);
     SwTimerStop(loRa.classCParams.ulAckTimerId);
+    SwTimerStop(loRa.uplinkQueue.timerId);
 }
 
 void LorawanConfigureRadioForRX2(bool doCallback)
@@ -5103,7 +5235,7 @@ StackRetStatus_t LorawanSetEdClass(EdClass_t edclass)
 
             loRa.edClass = edclass;
 			PDS_STORE(PDS_MAC_ED_CLASS);
-            loRa.macStatus.macState = IDLE;
+            LORAWAN_SET_MAC_STATE(IDLE);
             RadioReceiveParam.action = RECEIVE_STOP;
             if (ERR_NONE != RADIO_Receive(&RadioReceiveParam))
             {
@@ -5172,7 +5304,7 @@ static void StopReceiveWindow2Timer(void)
 {
 	if (CLASS_A  == loRa.edClass)
 	{
-		loRa.macStatus.macState = IDLE;
+		LORAWAN_SET_MAC_STATE(IDLE);
 		if (SwTimerIsRunning(loRa.receiveWindow2TimerId))
 		{
 			/* Stop the receive window 2 timer if it is running
@@ -5184,9 +5316,29 @@ static void StopReceiveWindow2Timer(void)
 	
 }
 
+/*********************************************************************//**
+\brief	Stores a new uplink frame counter ceiling in PDS once the counter
+		has gone past the stored one, reserving 2 ^ maxFcntPdsUpdateValue
+		counters per PDS update.
+\param[in]  renew - true to store a new ceiling from the current counter
+			regardless of the stored one
+*************************************************************************/
+static void ReserveFcntUp(bool renew)
+{
+	if (renew || (loRa.fCntUp.value > loRa.fCntUpCeiling))
+	{
+		uint32_t reserved = (1UL << loRa.maxFcntPdsUpdateValue) - 1;
+
+		loRa.fCntUpCeiling = (loRa.fCntUp.value < (FCNT_MAX - reserved)) ? (loRa.fCntUp.value + reserved) : FCNT_MAX;
+		/* Written before a counter above the former ceiling is sent: a
+		   deferred write would be lost in a reset */
+		PDS_STORE_NOW(PDS_MAC_FCNT_UP);
+	}
+}
+
 static void handleTransmissionTimeoutCallback(void)
 {
-	loRa.macStatus.macState = IDLE;
+	LORAWAN_SET_MAC_STATE(IDLE);
 	if (true == loRa.macStatus.networkJoined)
 	{
 		UpdateTransactionCompleteCbParams(LORAWAN_TX_TIMEOUT);
@@ -5197,109 +5349,6 @@ static void handleTransmissionTimeoutCallback(void)
 	}
 }
 
-/*********************************************************************//**
-\brief  This function returns the packet time on air for a given length
-\param
-    \datarate    - Data rate to be used for packet transmission
-    \preambleLen - Length of preamble (unit: symbols -- Lora, bytes -- FSK)
-    \impHdrMode  - If packet to be sent in implicit header mode
-    \crcOn       - If PHY CRC is to be added in transmitted packet
-    \cr          - Coding rate of the transmitted packet
-    \length      - Length of payload in bytes to be transmitted in packet
-\return
-    'uint32_t' Time-on-Air of packet for the given payload length
-*************************************************************************/
-static uint32_t calcPacketTimeOnAir(uint8_t datarate, uint8_t preambleLen,
-    uint8_t impHdrMode, uint8_t crcOn, uint8_t cr, uint8_t length)
-{
-    bool lowDataRateOptimize = false;
-    double bw, ts, tp, tmpDouble, time = 0.0;
-    uint32_t np;
-    RadioModulation_t modulation;
-    RadioDataRate_t sf;
-
-    LORAREG_GetAttr(SPREADING_FACTOR_ATTR, &datarate, &sf);
-    LORAREG_GetAttr(MODULATION_ATTR, &datarate, &modulation);
-
-    if (MODULATION_LORA == modulation)
-    {
-        RadioLoRaBandWidth_t loraBw;
-		RADIO_GetAttr(BANDWIDTH, &loraBw);
-		
-		if (( SF_12 == sf && ( BW_125KHZ == loraBw || BW_250KHZ == loraBw ) ) || \
-			( SF_11 == sf && BW_125KHZ == loraBw ))
-		{
-			lowDataRateOptimize = true;
-		}
-
-        LORAREG_GetAttr(BANDWIDTH_ATTR, &datarate, &loraBw);
-
-        switch (loraBw)
-        {
-            case BW_125KHZ:
-            {
-                bw = 125000.0;
-                break;
-            }
-
-            case BW_250KHZ:
-            {
-                bw = 250000.0;
-                break;
-            }
-
-            case BW_500KHZ:
-            {
-                bw = 500000.0;
-                break;
-            }
-
-            default:
-            {
-                bw = 0.0;
-                break;
-            }
-        }
-
-        /* Refer: SX1272 data sheet section 4.1.1.7. Time on air */
-
-        /* Compute Ts, time per symbol */
-        ts = 1 / (bw / (1 << sf));
-
-        /* Compute Tpreamble, preamble time-on-air */
-        tp = (preambleLen + 4.25) * ts;
-
-        /* Compute in steps, Npayload, number of panPayloadload snPayloadmbols */
-        tmpDouble  = ((8 * length) - (4 * sf) + 28 + (16 * crcOn) - (impHdrMode ? 20 : 0));
-        tmpDouble /= (4 * (sf - (lowDataRateOptimize ? 2 : 0)));
-
-        /* Ceil this tmpDouble */
-        np = (uint32_t) tmpDouble;
-        if ((tmpDouble - (double)np) > 0.0)
-        {
-            np += 1;
-        }
-
-        np *= (cr + 4);
-        np  = (np > 0) ? np : 0;
-        np += 8;
-
-        /*
-        * Compute Tpacket...
-        * The time on air, or packet duration, in simply then the sum of the preamble and payload duration.
-        * Payload duration is then the symbol period multiplied by the number of Payload symbols
-        */
-	    time = (tp /* Tpreamble */ + (np /* Npayload */ * ts /* Symbol time */));
-	    time = MS_TO_US(1000 * time);
-    }
-    else
-    {
-        time = (RADIO_PHY_FSK_PREAMBLE_BYTES_LENGTH + length) * 8 * 20 /* us: time-per-bit in FSK */;
-    }
-
-    return (uint32_t) time;
-}
-
 static void lorawanADR(FCtrl_t *fCtrl)
 {
     /*
@@ -0,0 +1,184 @@
+/**
+* \file  lorawan_energy.c
+*
+* \brief LoRaWAN file for the airtime and energy accounting
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+/****************************** INCLUDES **************************************/
+#include "conf_stack.h"
+#include "lorawan.h"
+#include "lorawan_defs.h"
+#include "lorawan_private.h"
+#include "lorawan_energy.h"
+#include "lorawan_reg_params.h"
+#include "radio_interface.h"
+#include "sw_timer.h"
+
+/******************* EXTERN DEFINITIONS *************************************/
+extern LoRa_t loRa;
+
+/****************************** DEFINES ***************************************/
+/* uA x us in one nAh */
+#define ENERGY_UA_US_PER_NAH        3600000ULL
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+static EnergyPortStats_t *EnergyGetPort(uint8_t port);
+
+/*********************** FUNCTION DEFINITIONS *********************************/
+
+/*********************************************************************//**
+\brief	Airtime and energy accounting - clears the counters, restores the
+        default currents and starts counting the transceiver times from now
+*************************************************************************/
+void LorawanEnergyInit(void)
+{
+	static const uint32_t txCurrents[] = LORAWAN_ENERGY_TX_CURRENTS_UA;
+	uint8_t last = (sizeof(txCurrents) / sizeof(txCurrents[0])) - 1;
+
+	memset(&loRa.energy, 0, sizeof(loRa.energy));
+
+	/* The power indexes past the table draw the current of the last one */
+	for (uint8_t i = 0; i < LORAWAN_ENERGY_TX_POWERS; i++)
+	{
+		loRa.energy.currents.tx[i] = txCurrents[(i < last) ? i : last];
+	}
+	loRa.energy.currents.rx = LORAWAN_ENERGY_RX_CURRENT_UA;
+	loRa.energy.currents.standby = LORAWAN_ENERGY_STANDBY_CURRENT_UA;
+	loRa.energy.currents.sleep = LORAWAN_ENERGY_SLEEP_CURRENT_UA;
+	loRa.energy.currents.tcxo = LORAWAN_ENERGY_TCXO_CURRENT_UA;
+
+	RADIO_GetAttr(RADIO_ENERGY_TIMES, &loRa.energy.radioBase);
+}
+
+/*********************************************************************//**
+\brief	Counts a frame sent by the radio on the current channel at the
+        current transmit power
+*************************************************************************/
+void LorawanEnergyTxDone(uint8_t port, uint32_t timeOnAir, bool retransmission)
+{
+	EnergyStats_t *stats = &loRa.energy.stats;
+	EnergyPortStats_t *portStats;
+	uint8_t channelIndex;
+	uint8_t subBand;
+
+	stats->txFrames++;
+	if (retransmission)
+	{
+		stats->retransmissions++;
+	}
+
+	if ((LORAWAN_SUCCESS == LORAREG_GetAttr(CURRENT_CHANNEL_INDEX, NULL, &channelIndex)) &&
+		(channelIndex < LORAWAN_ENERGY_CHANNELS))
+	{
+		stats->channelTxTime[channelIndex] += timeOnAir;
+
+		if ((LORAWAN_SUCCESS == LORAREG_GetAttr(CHANNEL_SUB_BAND, &channelIndex, &subBand)) &&
+			(subBand < LORAWAN_ENERGY_SUB_BANDS))
+		{
+			stats->subBandTxTime[subBand] += timeOnAir;
+		}
+	}
+
+	if (loRa.txPower < LORAWAN_ENERGY_TX_POWERS)
+	{
+		stats->powerTxTime[loRa.txPower] += timeOnAir;
+	}
+
+	portStats = EnergyGetPort(port);
+	if (NULL != portStats)
+	{
+		portStats->frames++;
+		portStats->txTime += timeOnAir;
+	}
+	else
+	{
+		stats->otherPortsTxTime += timeOnAir;
+	}
+}
+
+/*********************************************************************//**
+\brief	Fills the counters with the transceiver times and the charge
+*************************************************************************/
+void LorawanEnergyGetStats(EnergyStats_t *stats)
+{
+	const EnergyCurrents_t *currents = &loRa.energy.currents;
+	RadioEnergyTimes_t times;
+	uint64_t charge = 0;
+
+	*stats = loRa.energy.stats;
+
+	RADIO_GetAttr(RADIO_ENERGY_TIMES, &times);
+	stats->txTime = times.txTime - loRa.energy.radioBase.txTime;
+	stats->rxTime = times.rxTime - loRa.energy.radioBase.rxTime;
+	stats->standbyTime = times.standbyTime - loRa.energy.radioBase.standbyTime;
+	stats->sleepTime = times.sleepTime - loRa.energy.radioBase.sleepTime;
+	stats->tcxoTime = times.tcxoTime - loRa.energy.radioBase.tcxoTime;
+
+	/* The transmit current depends on the power, the time on air of each
+	   power index stands for the time in transmit mode */
+	for (uint8_t i = 0; i < LORAWAN_ENERGY_TX_POWERS; i++)
+	{
+		charge += MS_TO_US((uint64_t)stats->powerTxTime[i]) * currents->tx[i];
+	}
+	charge += stats->rxTime * currents->rx;
+	charge += stats->standbyTime * currents->standby;
+	charge += stats->sleepTime * currents->sleep;
+	charge += stats->tcxoTime * currents->tcxo;
+
+	stats->charge = charge / ENERGY_UA_US_PER_NAH;
+}
+
+/*********************************************************************//**
+\brief	Returns the counters of the port, taking a free entry for a port
+        not sent on yet
+\param[in]  port - FPort
+\return	    Counters of the port, NULL if the table is full
+*************************************************************************/
+static EnergyPortStats_t *EnergyGetPort(uint8_t port)
+{
+	EnergyPortStats_t *ports = loRa.energy.stats.ports;
+
+	for (uint8_t i = 0; i < LORAWAN_ENERGY_PORTS; i++)
+	{
+		if ((0 == ports[i].frames) || (port == ports[i].port))
+		{
+			ports[i].port = port;
+			return &ports[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* eof lorawan_energy.c */
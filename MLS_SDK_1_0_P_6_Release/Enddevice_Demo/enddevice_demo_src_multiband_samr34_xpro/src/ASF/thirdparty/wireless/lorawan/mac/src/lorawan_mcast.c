@@ -44,14 +44,13 @@
 #include "lorawan_reg_params.h"
 #include "system_assert.h"
 #include "pds_interface.h"
+#include "sal.h"
 
 /******************* EXTERN DEFINITIONS *************************************/
 extern LoRa_t loRa;
 
 #include "lorawan_pds.h"
 
-extern uint8_t radioBuffer[];
-
 /******************* CONSTANT DEFINITIONS *************************************/
 
 
@@ -207,7 +206,6 @@ StackRetStatus_t LorawanMcastProcessPkt(uint8_t* buffer, uint8_t bufferLength, H
 	SalStatus_t sal_status = SAL_SUCCESS;
 #if (FEATURE_DL_MCAST == 1)
     uint8_t frmPayloadLength;
-    uint8_t bufferIndex;
     uint8_t *packet;
     uint32_t extractedMic;
     uint8_t fPort;
@@ -218,8 +216,6 @@ StackRetStatus_t LorawanMcastProcessPkt(uint8_t* buffer, uint8_t bufferLength, H
     buffer += (LORAWAN_FHDR_SIZE_WITHOUT_FOPTS + sizeof(fPort));
     frmPayloadLength = bufferLength - LORAWAN_FHDR_SIZE_WITHOUT_FOPTS - sizeof (extractedMic); //frmPayloadLength includes port
 
-    bufferIndex = 16 + LORAWAN_FHDR_SIZE_WITHOUT_FOPTS + sizeof (fPort);
-
     if (group->mcastFCntDownMin.value < group->mcastFCntDownMax.value)
     {
         /* there is no wraparound of counter i.e., min <= cur < max */
@@ -242,7 +238,7 @@ StackRetStatus_t LorawanMcastProcessPkt(uint8_t* buffer, uint8_t bufferLength, H
     {
         group->mcastFCntDown.members.valueLow = hdr->members.fCnt;
 		PDS_STORE(PDS_MAC_MCAST_FCNT_DWN);
-        sal_status = EncryptFRMPayload (buffer, frmPayloadLength-1, 1, loRa.mcastParams.activationParams[groupId].mcastFCntDown.value, loRa.mcastParams.activationParams[groupId].mcastAppSKey, SAL_MCAST_APPS_KEY, bufferIndex, radioBuffer, loRa.mcastParams.activationParams[groupId].mcastDevAddr.value);
+        sal_status = EncryptFRMPayload (buffer, frmPayloadLength-1, 1, loRa.mcastParams.activationParams[groupId].mcastFCntDown.value, loRa.mcastParams.activationParams[groupId].mcastAppSKey, SAL_MCAST_APPS_KEY, 0, buffer, loRa.mcastParams.activationParams[groupId].mcastDevAddr.value);
         if (SAL_SUCCESS != sal_status)
         {
 	        /* Transaction complete Event */
@@ -266,7 +262,7 @@ StackRetStatus_t LorawanMcastProcessPkt(uint8_t* buffer, uint8_t bufferLength, H
 
 	if ((loRa.macStatus.macState == RX1_OPEN) && (loRa.edClass == CLASS_C))
 	{   
-		loRa.macStatus.macState = RX2_OPEN;
+		LORAWAN_SET_MAC_STATE(RX2_OPEN);
 	}
 	//Move to Receive state after packet reception
 	loRa.enableRxcWindow = true;
@@ -348,6 +344,7 @@ StackRetStatus_t LorawanAddMcastNwkskey(uint8_t * nwkSkey, uint8_t groupId)
 	else
 	{
 		memcpy(&loRa.mcastParams.activationParams[groupId].mcastNwkSKey, nwkSkey, LORAWAN_SESSIONKEY_LENGTH);
+		SAL_CmacSubkeyUpdate(SAL_MCAST_NWKS_KEY, groupId, loRa.mcastParams.activationParams[groupId].mcastNwkSKey);
 		PDS_STORE(PDS_MAC_MCAST_NWK_SKEY);
 		loRa.mcastParams.activationParams[groupId].mcastKeysMask.mcastNetworkSessionKey = 1;
 		PDS_STORE(PDS_MAC_MCAST_KEYS);
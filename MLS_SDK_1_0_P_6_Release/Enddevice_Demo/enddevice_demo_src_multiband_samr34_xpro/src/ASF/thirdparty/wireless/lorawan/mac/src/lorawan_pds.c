@@ -267,7 +267,8 @@ const ItemMap_t pds_mac_fid2_item_list[] = {
 void Lorawan_Pds_fid1_CB(void)
 {
 	//loRa.mcastParams.activationParams.mcastFCntDown.value += MAX_FCNT_PDS_UPDATE_VALUE;
-	//loRa.fCntUp.value += MAX_FCNT_PDS_UPDATE_VALUE;
+	/* Frame counters below the stored ceiling may have been used before the reset */
+	loRa.fCntUp.value = loRa.fCntUpCeiling;
 }	
 
 void Lorawan_Pds_fid2_CB(void)
@@ -287,7 +288,7 @@ void Lorawan_Pds_fid2_CB(void)
 
 	{
 		/* Clear MAC STATUS Bits which are transactional in nature */
-		loRa.macStatus.macState = 0;
+		LORAWAN_SET_MAC_STATE(0);
 		loRa.macStatus.macPause = 0;
 		loRa.macStatus.rxDone = 0;
 	}
@@ -320,7 +321,9 @@ void Lorawan_Pds_fid2_CB(void)
 		memcpy(loRa.activationParameters.applicationSessionKeyRam, loRa.activationParameters.applicationSessionKeyRom, 16);
 		memcpy(loRa.activationParameters.networkSessionKeyRam, loRa.activationParameters.networkSessionKeyRom, 16);	
 	}
-		
+
+	/* The keys are restored, derive their CMAC subkeys */
+	LorawanUpdateCmacSubkeys();
 }
 
 /**
@@ -44,25 +44,17 @@
 #include "radio_interface.h"
 #include "sw_timer.h"
 #include "system_task_manager.h"
-#include "atomic.h"
 #include "lorawan_reg_params.h"
 #include "lorawan_radio.h"
 #include "system_assert.h"
 
-/******************************************************************************/
-/*                      Static variables                                      */
-/******************************************************************************/
-static SYSTEM_TaskStatus_t (*lorawanHandlers[LORAWAN_TASKS_SIZE])(void) =
-{	
-	LORAWAN_JoinReqHandler,
-    LORAWAN_TxHandler,
-    LORAWAN_RxHandler
-};
-
 /******************************************************************************
-                   Prototypes section
-******************************************************************************/
-SYSTEM_TaskStatus_t LORAWAN_TaskHandler(void);
+                        Defines section
+ ******************************************************************************/
+/* LORAWAN subtasks occupy consecutive scheduler slots from SYSTEM_LORAWAN_TASK_IDX */
+#if (LORAWAN_TASKS_SIZE > (SYSTEM_PDS_TASK_IDX - SYSTEM_LORAWAN_TASK_IDX))
+#error "LORAWAN subtasks exceed the scheduler slots of the LORAWAN layer"
+#endif
 
 /*******************************************************************************
                         Extern Variables
@@ -71,12 +63,6 @@ extern LoRa_t loRa;
 extern uint8_t macBuffer[];
 extern RadioCallbackID_t callbackBackup;
 
-/******************************************************************************
-                        Global variables section
- ******************************************************************************/
-volatile static lorawanTaskID_t lorawanTaskBitMap = 0U;
-
-
 /******************************************************************************
                            Implementations section
  ******************************************************************************/
@@ -88,38 +74,8 @@ volatile static lorawanTaskID_t lorawanTaskBitMap = 0U;
  ******************************************************************************/
 void LORAWAN_PostTask(const lorawanTaskID_t taskID)
 {
-	ATOMIC_SECTION_ENTER
-    lorawanTaskBitMap |= (1U << taskID);
-	ATOMIC_SECTION_EXIT
-    SYSTEM_PostTask(LORAWAN_TASK_ID);
-}
-
-/**************************************************************************//**
-  \brief Global task handler of LORAWAN layer.
-
-  \param[in] None
-  \return
-
- ******************************************************************************/
-SYSTEM_TaskStatus_t LORAWAN_TaskHandler(void)
-{
-	while (lorawanTaskBitMap)
-	{
-		for (uint8_t task_id = 0; task_id < LORAWAN_TASKS_SIZE; task_id++ )
-		{
-			if(lorawanTaskBitMap & ( 1 << task_id))
-			{
-				ATOMIC_SECTION_ENTER
-				lorawanTaskBitMap &= ~( 1U << task_id);
-				ATOMIC_SECTION_EXIT
-
-				lorawanHandlers[task_id]();
-                break;
-			}
-		}
-	}
-
-    return SYSTEM_TASK_SUCCESS;
+    /* Each LORAWAN subtask is dispatched directly by the system scheduler */
+    SYSTEM_PostTask(SYSTEM_TASK_MASK(SYSTEM_LORAWAN_TASK_IDX + taskID));
 }
 
 /**************************************************************************//**
@@ -174,12 +130,12 @@ SYSTEM_TaskStatus_t LORAWAN_TxHandler(void)
         }
 
 		RadioTransmitParam.bufferLen = loRa.lastPacketLength;
-		RadioTransmitParam.bufferPtr = &macBuffer[16];
+		RadioTransmitParam.bufferPtr = macBuffer;
         RadioError_t status;
 		status = RADIO_Transmit(&RadioTransmitParam);
         if (status == ERR_NONE)
 		{
-			loRa.macStatus.macState = TRANSMISSION_OCCURRING; // set the state of MAC to transmission occurring. No other packets can be sent afterwards
+			LORAWAN_SET_MAC_STATE(TRANSMISSION_OCCURRING); // set the state of MAC to transmission occurring. No other packets can be sent afterwards
 		}
 		else
         {
@@ -251,7 +207,7 @@ SYSTEM_TaskStatus_t LORAWAN_JoinReqHandler(void)
 		else
 		{
 
-			loRa.macStatus.macState = TRANSMISSION_OCCURRING;	
+			LORAWAN_SET_MAC_STATE(TRANSMISSION_OCCURRING);	
 		}
 		
 	}
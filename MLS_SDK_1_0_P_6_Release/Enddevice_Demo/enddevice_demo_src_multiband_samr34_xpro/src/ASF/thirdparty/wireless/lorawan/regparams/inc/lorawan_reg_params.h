@@ -127,6 +127,8 @@ typedef enum _LorawanRegionalAttributes
 	REG_JOIN_ENABLE_ALL,
 	CHLIST_DEFAULTS,
 	DEF_TX_PWR,
+	DUTY_CYCLE_END_TIME,
+	CHANNEL_SUB_BAND,
 	REG_NUM_ATTRIBUTES	
 }LorawanRegionalAttributes_t;
 
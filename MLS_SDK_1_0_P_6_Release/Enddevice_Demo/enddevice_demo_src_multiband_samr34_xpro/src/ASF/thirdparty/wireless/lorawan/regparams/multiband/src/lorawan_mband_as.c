@@ -129,7 +129,6 @@ StackRetStatus_t LORAReg_InitAS(IsmBand_t ismBand)
 	RegParams.pChParams = &RegParams.cmnParams.paramsType2.chParams[0];
 	RegParams.pDrParams = &RegParams.cmnParams.paramsType2.DRParams[0];
 	RegParams.pOtherChParams = &RegParams.cmnParams.paramsType2.othChParams[0];
-	RegParams.pDutyCycleTimer = &RegParams.cmnParams.paramsType2.DutyCycleTimer;
 	RegParams.pJoinDutyCycleTimer = &RegParams.joinDutyCycleTimer;
 	RegParams.pJoinBackoffTimer = &RegParams.joinBackoffTimer;
 	RegParams.pSubBandParams = &RegParams.cmnParams.paramsType2.SubBands[0];
@@ -145,15 +144,14 @@ StackRetStatus_t LORAReg_InitAS(IsmBand_t ismBand)
 	RegParams.defTxPwrIndx = MAC_DEF_TX_POWER_AS;
 	RegParams.maxTxPwr = DEFAULT_EIRP_AS;
 	RegParams.cmnParams.paramsType2.minNonDefChId = 2;
-	RegParams.pDutyCycleTimer->timerId = regTimerId[0];
-	RegParams.pJoinBackoffTimer->timerId = regTimerId[1];
-    RegParams.pJoinDutyCycleTimer->timerId = regTimerId[2];
+	RegParams.pJoinBackoffTimer->timerId = regTimerId[0];
+    RegParams.pJoinDutyCycleTimer->timerId = regTimerId[1];
 	RegParams.pJoinDutyCycleTimer->remainingtime = 0;
 	RegParams.joinbccount =0;
 	RegParams.joinDutyCycleTimeout =0;
 	RegParams.cmnParams.paramsType2.txParams.uplinkDwellTime = 1;
 	RegParams.cmnParams.paramsType2.txParams.downlinkDwellTime = 1;
-	RegParams.aggregatedDutyCycleTimeout = 0;
+	RegParams.aggregatedAvailableAt = 0;
 	RegParams.band = ismBand;
 	
 	if(ismBand >= ISM_BRN923 && ismBand <= ISM_VTM923)
@@ -137,7 +137,6 @@ StackRetStatus_t LORAReg_InitAU(IsmBand_t ismBand)
 	RegParams.cmnParams.paramsType1.DownStreamCh0Freq = DOWNSTREAM_CH0_AU;
     RegParams.pJoinDutyCycleTimer = &RegParams.joinDutyCycleTimer;
 	RegParams.pJoinBackoffTimer = &RegParams.joinBackoffTimer;
-	RegParams.pDutyCycleTimer = &RegParams.cmnParams.paramsType1.DutyCycleTimer;
     RegParams.Rx1DrOffset = 5;
 	RegParams.maxTxPwrIndx = 10;
 	RegParams.defTxPwrIndx = MAC_DEF_TX_POWER_AU;
@@ -146,11 +145,10 @@ StackRetStatus_t LORAReg_InitAU(IsmBand_t ismBand)
 
 	RegParams.pJoinBackoffTimer->timerId = regTimerId[0];	
 	RegParams.pJoinDutyCycleTimer->timerId = regTimerId[1];
-	RegParams.pDutyCycleTimer->timerId = regTimerId[2];
 	RegParams.pJoinDutyCycleTimer->remainingtime = 0;
 	RegParams.joinbccount =0;
 	RegParams.joinDutyCycleTimeout =0;
-	RegParams.aggregatedDutyCycleTimeout = 0;
+	RegParams.aggregatedAvailableAt = 0;
 	RegParams.band = ismBand;
 	
     InitDefault915ChannelsAU ();
@@ -190,11 +188,13 @@ static void InitDefault915ChannelsAU (void)
 {
 	memset (RegParams.pChParams, 0, sizeof(DefaultChannels915AU) );
 	memcpy (RegParams.pChParams, DefaultChannels915AU, sizeof(DefaultChannels915AU) );
+	Init915ChannelMasks();
 }
 #if (ENABLE_PDS == 1)
 void LorawanReg_AU_Pds_Cb(void)
 {
-	
+	/* The channel masks follow the restored channel parameters */
+	Init915ChannelMasks();
 }
 #endif
 #endif
@@ -136,7 +136,6 @@ StackRetStatus_t LORAReg_InitNA(IsmBand_t ismBand)
 	RegParams.cmnParams.paramsType1.RxParamWindowOffset1 = 10;
 	RegParams.pJoinDutyCycleTimer = &RegParams.joinDutyCycleTimer;
 	RegParams.pJoinBackoffTimer = &RegParams.joinBackoffTimer;
-	RegParams.pDutyCycleTimer = &RegParams.cmnParams.paramsType1.DutyCycleTimer;
 	RegParams.cmnParams.paramsType1.UpStreamCh0Freq = UPSTREAM_CH0_NA;
 	RegParams.cmnParams.paramsType1.UpStreamCh64Freq = UPSTREAM_CH64_NA;
 	RegParams.cmnParams.paramsType1.DownStreamCh0Freq = DOWNSTREAM_CH0_NA;
@@ -147,12 +146,11 @@ StackRetStatus_t LORAReg_InitNA(IsmBand_t ismBand)
 
 	RegParams.pJoinBackoffTimer->timerId = regTimerId[0];
 	RegParams.pJoinDutyCycleTimer->timerId = regTimerId[1];
-	RegParams.pDutyCycleTimer->timerId = regTimerId[2];
 	RegParams.pJoinDutyCycleTimer->remainingtime =0;
 	RegParams.joinbccount =0;
 	RegParams.joinDutyCycleTimeout =0;
 	RegParams.band = ismBand;
-	RegParams.aggregatedDutyCycleTimeout = 0;
+	RegParams.aggregatedAvailableAt = 0;
     InitDefault915Channels ();
 	memcpy (RegParams.pDrParams, DefaultDrParamsNA, sizeof(DefaultDrParamsNA) );
 	RegParams.cmnParams.paramsType1.alternativeChannel = 0;
@@ -193,12 +191,14 @@ static void InitDefault915Channels (void)
 {
 	memset (RegParams.pChParams, 0, sizeof(DefaultChannels915) );
 	memcpy (RegParams.pChParams, DefaultChannels915, sizeof(DefaultChannels915) );
+	Init915ChannelMasks();
 }
 
 #if (ENABLE_PDS == 1)
 void LorawanReg_NA_Pds_Cb(void)
 {
-	
+	/* The channel masks follow the restored channel parameters */
+	Init915ChannelMasks();
 }
 #endif
 #endif
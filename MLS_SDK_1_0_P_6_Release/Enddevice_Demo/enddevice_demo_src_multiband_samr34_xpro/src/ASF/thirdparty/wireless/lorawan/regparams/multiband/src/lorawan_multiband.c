@@ -74,6 +74,7 @@ static StackRetStatus_t LORAREG_GetAttr_SpreadFactorT1(LorawanRegionalAttributes
 static StackRetStatus_t LORAREG_GetAttr_MinDutyCycleTimer(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 static StackRetStatus_t LORAREG_GetAttr_NewTxChConfigT1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 static StackRetStatus_t LORAREG_GetAttr_FreeChannel1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
+static StackRetStatus_t LORAREG_GetAttr_ChannelSubBandT1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 
 
 static StackRetStatus_t ValidateRxFreqT1 (LorawanRegionalAttributes_t attr, void *attrInput);
@@ -104,6 +105,9 @@ static DataRange_t getChBandDrT1(uint8_t chMaskCntl,uint16_t channelMask);
 static void EnableChannels2(uint8_t startIndx, uint8_t endIndx, uint16_t chMask);
 static uint8_t countChannels (uint16_t channelMask);
 static uint8_t countEnabled915Channels(void);
+static void Update915ChannelMask(uint8_t chid);
+static void WriteChannelMaskBit(ChannelMask_t *mask, uint8_t chid, bool set);
+static uint8_t FindChannelMaskBit(const ChannelMask_t *mask, uint8_t n);
 #endif
 
 #if (NA_BAND == 1 || AU_BAND == 1 || IND_BAND == 1 || KR_BAND == 1)
@@ -124,6 +128,7 @@ static void getRx1WindowparamsType2(Rx1WindowParamsReq_t* rx1WindowParamReq ,Rx1
 #if (EU_BAND == 1) || (AS_BAND == 1) || (JPN_BAND == 1)
 static StackRetStatus_t LORAREG_GetAttr_DutyCycleT2(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 static StackRetStatus_t LORAREG_GetAttr_DutyCycleTimer(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
+static StackRetStatus_t LORAREG_GetAttr_DutyCycleEndTime(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 
 static StackRetStatus_t setDutyCycle(LorawanRegionalAttributes_t attr, void *attrInput);
 static StackRetStatus_t setDutyCycleTimer(LorawanRegionalAttributes_t attr, void *attrInput);
@@ -159,6 +164,7 @@ static StackRetStatus_t LORAREG_GetAttr_SpreadFactorT2(LorawanRegionalAttributes
 static StackRetStatus_t LORAREG_GetAttr_NewTxChConfigT2(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 static StackRetStatus_t LORAREG_GetAttr_FreeChannel2(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 static StackRetStatus_t LORAREG_GetAttr_DlFrequency(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
+static StackRetStatus_t LORAREG_GetAttr_ChannelSubBandT2(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 
 
 static StackRetStatus_t ValidateTxFreqT2 (LorawanRegionalAttributes_t attr, void *attrInput);
@@ -257,12 +263,8 @@ static StackRetStatus_t ValidateSupportedDr (LorawanRegionalAttributes_t attr, v
 static StackRetStatus_t ValidateTxPower (LorawanRegionalAttributes_t attr, void *attrInput);
 static StackRetStatus_t ValidateRx1DataRateOffset(LorawanRegionalAttributes_t attr, void *attrInput);
 
-#if (EU_BAND == 1) || (AS_BAND == 1) || (JPN_BAND == 1)
-static void DutyCycleCallback (uint8_t param);
-#endif
-
 #if (NA_BAND == 1) || (AU_BAND == 1) || (IND_BAND == 1) || (KR_BAND == 1)
-static void DutyCycleCallback1 (uint8_t param);
+static StackRetStatus_t LORAREG_GetAttr_DutyCycleEndTime1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput);
 #endif
 
 static pLoraRegGetAttr_t pGetAttr[REG_NUM_ATTRIBUTES];
@@ -320,6 +322,8 @@ void LORAREG_InitGetAttrFnPtrsNA(void)
     pGetAttr[REG_DEF_TX_POWER] = LORAREG_GetAttr_RegDefTxPwr;
 	pGetAttr[DEF_TX_PWR] = LORAREG_GetAttr_DefTxPwr;
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
+    pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime1;
+    pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT1;
 }
 #endif
 
@@ -361,6 +365,8 @@ void LORAREG_InitGetAttrFnPtrsEU(void)
     pGetAttr[REG_DEF_TX_POWER] = LORAREG_GetAttr_RegDefTxPwr;
 	pGetAttr[DEF_TX_PWR] = LORAREG_GetAttr_DefTxPwr;
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
+    pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime;
+    pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT2;
 }
 #endif
 
@@ -403,6 +409,8 @@ void LORAREG_InitGetAttrFnPtrsAS(void)
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
     pGetAttr[DUTY_CYCLE] = LORAREG_GetAttr_DutyCycleT2;
     pGetAttr[MIN_DUTY_CYCLE_TIMER] = LORAREG_GetAttr_DutyCycleTimer;
+    pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime;
+    pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT2;
 }
 #endif
 
@@ -443,6 +451,8 @@ void LORAREG_InitGetAttrFnPtrsAU(void)
     pGetAttr[REG_DEF_TX_POWER] = LORAREG_GetAttr_RegDefTxPwr;
 	pGetAttr[DEF_TX_PWR] = LORAREG_GetAttr_DefTxPwr;
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
+    pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime1;
+    pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT1;
 }
 #endif
 
@@ -482,6 +492,8 @@ void LORAREG_InitGetAttrFnPtrsIN(void)
     pGetAttr[REG_DEF_TX_POWER] = LORAREG_GetAttr_RegDefTxPwr;
 	pGetAttr[DEF_TX_PWR] = LORAREG_GetAttr_DefTxPwr;
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
+    pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime1;
+    pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT2;
 }
 #endif
 
@@ -525,6 +537,8 @@ void LORAREG_InitGetAttrFnPtrsJP(void)
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
 	pGetAttr[DUTY_CYCLE] = LORAREG_GetAttr_DutyCycleT2;
 	pGetAttr[MIN_DUTY_CYCLE_TIMER] = LORAREG_GetAttr_DutyCycleTimer;
+	pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime;
+	pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT2;
 }
 #endif
 
@@ -566,6 +580,8 @@ void LORAREG_InitGetAttrFnPtrsKR(void)
     pGetAttr[REG_DEF_TX_POWER] = LORAREG_GetAttr_RegDefTxPwr;
 	pGetAttr[DEF_TX_PWR] = LORAREG_GetAttr_DefTxPwr;
     pGetAttr[REG_DEF_TX_DATARATE] = LORAREG_GetAttr_RegDefTxDR;
+    pGetAttr[DUTY_CYCLE_END_TIME] = LORAREG_GetAttr_DutyCycleEndTime1;
+    pGetAttr[CHANNEL_SUB_BAND] = LORAREG_GetAttr_ChannelSubBandT2;
 }
 #endif
 
@@ -1111,6 +1127,24 @@ static StackRetStatus_t LORAREG_GetAttr_DlFrequency(LorawanRegionalAttributes_t
 }
 #endif
 
+#if (EU_BAND == 1 || AS_BAND == 1 || IND_BAND == 1 || JPN_BAND == 1 || KR_BAND == 1)
+static StackRetStatus_t LORAREG_GetAttr_ChannelSubBandT2(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
+{
+	StackRetStatus_t result = LORAWAN_SUCCESS;
+	uint8_t  channelId;
+	channelId = *(uint8_t *)attrInput;
+	if (channelId >= RegParams.maxChannels)
+	{
+		result = LORAWAN_INVALID_PARAMETER;
+	}
+	else
+	{
+		*(uint8_t *)attrOutput = RegParams.pOtherChParams[channelId].subBandId;
+	}
+	return result;
+}
+#endif
+
 
 static StackRetStatus_t LORAREG_GetAttr_ChIdStatus(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
 {
@@ -1169,51 +1203,65 @@ static StackRetStatus_t LORAREG_GetAttr_DutyCycleT2(LorawanRegionalAttributes_t
 static StackRetStatus_t LORAREG_GetAttr_DutyCycleTimer(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
 {
 	StackRetStatus_t result = LORAWAN_SUCCESS;
-    //To get the next free channel when duty cycle is enabled
-    uint32_t minimSubBandTimer = UINT32_MAX;
-    uint32_t minDutyCycleTimer,ticks,delta;
-    uint8_t bandId;
-    uint8_t  currentDataRate;
-    currentDataRate = *(uint8_t *)attrInput;
+	uint64_t endTime;
+	uint64_t now = SwTimerGetTime();
+	uint32_t minDutyCycleTimer = 0;
 
-    for (uint8_t i = 0; i < RegParams.maxChannels; i++)
-    {
-	    if ( (RegParams.pChParams[i].status == ENABLED) )
-	    {
-		    bandId = RegParams.cmnParams.paramsType2.othChParams[i].subBandId;
-		        
-		    if((RegParams.pSubBandParams[bandId].subBandTimeout != 0) && 
-			   (RegParams.pSubBandParams[bandId].subBandTimeout <= minimSubBandTimer) && 
-			   (currentDataRate >= RegParams.pChParams[i].dataRange.min) && 
-			   (currentDataRate <= RegParams.pChParams[i].dataRange.max) )
-		    {
-			    minimSubBandTimer = RegParams.pSubBandParams[bandId].subBandTimeout;
-		    }
-	    }
-    }
-        
-    if((UINT32_MAX != minimSubBandTimer) && (minimSubBandTimer >= RegParams.aggregatedDutyCycleTimeout))
-    {
-	    minDutyCycleTimer = minimSubBandTimer;
-    }
-    else
-    {
-	    minDutyCycleTimer = RegParams.aggregatedDutyCycleTimeout;
-    }
-        
-    ticks = SwTimerReadValue (RegParams.pDutyCycleTimer->timerId);
-    delta = RegParams.pDutyCycleTimer->lastTimerValue - US_TO_MS(ticks);
-    
-	if( minDutyCycleTimer != 0)
+	LORAREG_GetAttr_DutyCycleEndTime(DUTY_CYCLE_END_TIME, attrInput, &endTime);
+	if (endTime > now)
 	{
-		/*Get the time left for the band timer which supports the requested data rate to expire*/
-		minDutyCycleTimer = minDutyCycleTimer - delta; //Logically delta will not be greater than minDcTimer
+		/*Get the time left, rounded up, for the band timer which supports the requested data rate to expire*/
+		minDutyCycleTimer = (uint32_t)US_TO_MS(endTime - now + MS_TO_US(1u) - 1u);
 	}
-        
-    memcpy(attrOutput,&minDutyCycleTimer,sizeof(uint32_t));
+
+	memcpy(attrOutput,&minDutyCycleTimer,sizeof(uint32_t));
 	
 	return result;
 }
+
+/*
+ * \brief Returns the system time in us from which the duty cycle allows a
+ *        transmission at a data rate: the earliest end of the off time of the
+ *        sub-bands with an enabled channel supporting the data rate, not before
+ *        the end of the aggregated off time
+ * \param[in] attrInput Data rate
+ * \param[out] attrOutput System time of type uint64_t, in the past if the
+ *        transmission is allowed now
+ */
+static StackRetStatus_t LORAREG_GetAttr_DutyCycleEndTime(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
+{
+	StackRetStatus_t result = LORAWAN_SUCCESS;
+	uint64_t subBandEndTime = UINT64_MAX;
+	uint64_t endTime;
+	uint8_t bandId;
+	uint8_t currentDataRate;
+	currentDataRate = *(uint8_t *)attrInput;
+
+	for (uint8_t i = 0; i < RegParams.maxChannels; i++)
+	{
+		if ((RegParams.pChParams[i].status == ENABLED) &&
+			(currentDataRate >= RegParams.pChParams[i].dataRange.min) &&
+			(currentDataRate <= RegParams.pChParams[i].dataRange.max))
+		{
+			bandId = RegParams.cmnParams.paramsType2.othChParams[i].subBandId;
+			if (RegParams.pSubBandParams[bandId].availableAt < subBandEndTime)
+			{
+				subBandEndTime = RegParams.pSubBandParams[bandId].availableAt;
+			}
+		}
+	}
+
+	/* No channel supports the data rate, only the aggregated duty cycle is reported */
+	endTime = RegParams.aggregatedAvailableAt;
+	if ((UINT64_MAX != subBandEndTime) && (subBandEndTime > endTime))
+	{
+		endTime = subBandEndTime;
+	}
+
+	memcpy(attrOutput,&endTime,sizeof(uint64_t));
+
+	return result;
+}
 #endif
 
 #if (NA_BAND == 1 || AU_BAND == 1)
@@ -1224,6 +1272,43 @@ static StackRetStatus_t LORAREG_GetAttr_MinDutyCycleTimer(LorawanRegionalAttribu
 }
 #endif
 
+#if (NA_BAND == 1) || (AU_BAND == 1) || (IND_BAND == 1) || (KR_BAND == 1)
+/*
+ * \brief Returns the system time in us from which the aggregated duty cycle
+ *        allows a transmission, the bands without sub-band duty cycle
+ * \param[in] attrInput Data rate, not used
+ * \param[out] attrOutput System time of type uint64_t
+ */
+static StackRetStatus_t LORAREG_GetAttr_DutyCycleEndTime1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
+{
+	memcpy(attrOutput,&RegParams.aggregatedAvailableAt,sizeof(uint64_t));
+	return LORAWAN_SUCCESS;
+}
+#endif
+
+#if (NA_BAND == 1 || AU_BAND == 1)
+/* Each sub-band holds eight 125 kHz channels and one 500 kHz channel */
+static StackRetStatus_t LORAREG_GetAttr_ChannelSubBandT1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
+{
+	StackRetStatus_t result = LORAWAN_SUCCESS;
+	uint8_t  channelId;
+	channelId = *(uint8_t *)attrInput;
+	if (channelId >= RegParams.maxChannels)
+	{
+		result = LORAWAN_INVALID_PARAMETER;
+	}
+	else if (channelId < MAX_CHANNELS_BANDWIDTH_125_AU_NA)
+	{
+		*(uint8_t *)attrOutput = channelId / NO_OF_CH_IN_SUBBAND;
+	}
+	else
+	{
+		*(uint8_t *)attrOutput = channelId - MAX_CHANNELS_BANDWIDTH_125_AU_NA;
+	}
+	return result;
+}
+#endif
+
 static StackRetStatus_t LORAREG_GetAttr_MacRecvDelay1(LorawanRegionalAttributes_t attr, void *attrInput, void *attrOutput)
 {
 	*(uint16_t *)attrOutput = RECEIVE_DELAY1;
@@ -1725,7 +1810,7 @@ StackRetStatus_t LORAREG_Init(IsmBand_t ismBand)
 	{
 		result = LORAReg_InitKR(ismBand);
 	}
-	
+
 	return result;
 }
 
@@ -2561,18 +2646,14 @@ static StackRetStatus_t GetTxChannelConfig2 (bool transmissionType,uint8_t txPwr
 static StackRetStatus_t SearchAvailableChannel1 (uint8_t maxChannels, bool transmissionType,uint8_t currDr, uint8_t* channelIndex)
 {
 	StackRetStatus_t result = LORAWAN_SUCCESS;
-	uint8_t i = 0,j = 0,k = 0;
-	/* Channel list is a 2-dimensional array, which stores the Channel 
-	 * in first index and corresponding Sub-band in second index
-	 * For eg: Channel ID 1 and corresponding sub-band is 1.
-	 * Channel ID 55 and corresponding sub-band is 6 */
-	uint8_t ChList[MAX_CHANNELS_BANDWIDTH_125_AU_NA + MAX_CHANNELS_BANDWIDTH_500_AU_NA][2];
-	static bool chUsed[MAX_CHANNELS_BANDWIDTH_125_AU_NA + MAX_CHANNELS_BANDWIDTH_500_AU_NA];
+	RegParamsType1_t *params = &RegParams.cmnParams.paramsType1;
+	/* Channels used since all the eligible channels were used once */
+	static ChannelMask_t chUsedMask;
+	ChannelMask_t freeChMask = {0, 0};
 	uint8_t num = 0;
 	uint8_t randomNumber = 0;
-	memset(ChList, 0, (MAX_CHANNELS_BANDWIDTH_125_AU_NA + MAX_CHANNELS_BANDWIDTH_500_AU_NA) * 2);  
 	
-	if (RegParams.aggregatedDutyCycleTimeout != 0)
+	if (RegParams.aggregatedAvailableAt > SwTimerGetTime())
 	{
 		return LORAWAN_NO_CHANNELS_FOUND;
 	}
@@ -2583,73 +2664,44 @@ static StackRetStatus_t SearchAvailableChannel1 (uint8_t maxChannels, bool trans
 	} 
 	else
 	{
-	  
-	for (i = 0, k = 0; i < (MAX_CHANNELS_BANDWIDTH_125_AU_NA + MAX_CHANNELS_BANDWIDTH_500_AU_NA); i += 8, k++)
+	/* The channels are eligible if they are ENABLED, currDr is within their data range,
+	 * they are not used in this round and are not the channel of the previous packet */
+	if (currDr <= MAX_TXDR_T1)
 	{
-			for (j = 0; j < NO_OF_CH_IN_SUBBAND; j++)
-			{
-				/* 1. Check and see, the Channel status is ENABLED.
-				* 2. If the request is for data packet,
-				*		2a. Check and see both data rate input is between range min and max Dr of the Channel.
-				*		2b. Check and see, if Channel is not as same as previous packet.
-				* 3. If the request is for join procedure,
-				*		3a. Check and see  transmissionType value is false.
-				*		3b. Check and see the channel falls between the next sub-band of last used sub-band.
-				*			3b1. Channel ID is less than 63 and lastUsedSB is equals to k.
-				*			3b2. Channel ID is greater than 63 and lastUsedSB is equals to Channel ID - 63.
-				*		Here k value is index and goes from 0-7.
-				*		lastUsedSB is value and goes from 1-8. 
-				*		Need to get channels only from next sub-band of previously used one.
-				*/
-				if (((transmissionType) && (currDr >= RegParams.pChParams[i + j].dataRange.min) && (currDr <= RegParams.pChParams[i + j].dataRange.max) 
-					&& ((RegParams.pChParams[i + j].status == ENABLED) && ((i+j) != RegParams.lastUsedChannelIndex)) && (chUsed[i+j] != true)) 
-					||
-					((!transmissionType) &&((RegParams.pChParams[i + j].status == ENABLED) && ((i+j) != RegParams.lastUsedChannelIndex))
-	#if (RANDOM_NW_ACQ == 1)
-					&&
-					((((i+j) < MAX_CHANNELS_BANDWIDTH_125_AU_NA) && (RegParams.cmnParams.paramsType1.lastUsedSB == k))
-					|| 
-					(((i+j) > MAX_CHANNELS_BANDWIDTH_125_AU_NA) && 
-					(RegParams.cmnParams.paramsType1.lastUsedSB == ((i + j) - MAX_CHANNELS_BANDWIDTH_125_AU_NA))))
-                                  
-	#endif        
-					))
-				{
-						// Mark this channel i+j
-						// Mark this sub band k
-						// increment number of channel;
-						ChList[num][0] = i+j;
-						if((i+j) >= MAX_CHANNELS_BANDWIDTH_125_AU_NA)
-						{
-								/* The channel falls under 500KHz range. So need to calculate sub-band correctly */
-								/* Sub-band values are stored in range of 1-8. So adding 1 to the index */
-								ChList[num][1] = ((i + j) - MAX_CHANNELS_BANDWIDTH_125_AU_NA + 1);
-						}
-						else
-						{
-								/* Channel is in the range of 0-63 125Khz range, Store the k value as sub-band */
-								/* Sub-band values are stored in range of 1-8. So adding 1 to the index */
-								ChList[num][1] = k + 1;    
-						}
-						num++;
-					}					
-		}
+		freeChMask.ch125 = params->enabledChMask.ch125 & params->drChMask[currDr].ch125 & ~chUsedMask.ch125;
+		freeChMask.ch500 = params->enabledChMask.ch500 & params->drChMask[currDr].ch500 & ~chUsedMask.ch500;
+	}
+	if (RegParams.lastUsedChannelIndex < MAX_CHANNELS_AU_NA)
+	{
+		WriteChannelMaskBit(&freeChMask, RegParams.lastUsedChannelIndex, false);
 	}
-	/* Get a random number and select a channel */
+	num = (uint8_t)(__builtin_popcountll(freeChMask.ch125) + __builtin_popcount(freeChMask.ch500));
+
+	/* Get a random number and select a channel, counting the eligible channels
+	 * from the lowest channel id */
 	if(0 != num)
 	{
 		randomNumber = rand() % num;
-		*channelIndex = ChList[randomNumber][0];
-		chUsed[*channelIndex] = true;
+		*channelIndex = FindChannelMaskBit(&freeChMask, randomNumber);
+		WriteChannelMaskBit(&chUsedMask, *channelIndex, true);
 	#if (RANDOM_NW_ACQ == 1)          
-		/* Update the lastUsedSB value based on the channel selected */
-		RegParams.cmnParams.paramsType1.lastUsedSB = ChList[randomNumber][1];
+		/* Update the lastUsedSB value based on the channel selected.
+		 * Sub-band values are stored in range of 1-8, a 500KHz channel
+		 * is in the sub-band of its index from channel 64 */
+		if(*channelIndex >= MAX_CHANNELS_BANDWIDTH_125_AU_NA)
+		{
+			params->lastUsedSB = (*channelIndex - MAX_CHANNELS_BANDWIDTH_125_AU_NA + 1);
+		}
+		else
+		{
+			params->lastUsedSB = (*channelIndex / NO_OF_CH_IN_SUBBAND) + 1;
+		}
 		/* If the lastUsedSB value is 8, then it means roll over has to happen.
 		* So changing the value to 1
 		*/
-		if(RegParams.cmnParams.paramsType1.lastUsedSB >= MAX_SUBBANDS)
+		if(params->lastUsedSB >= MAX_SUBBANDS)
 		{
-				RegParams.cmnParams.paramsType1.lastUsedSB = 0;
+				params->lastUsedSB = 0;
 			
 		}
 	#endif 
@@ -2657,14 +2709,14 @@ static StackRetStatus_t SearchAvailableChannel1 (uint8_t maxChannels, bool trans
 	else
 	{
 		//If all enabled channels are used once, clear the used status bit
-		memset(chUsed, 0, (MAX_CHANNELS_BANDWIDTH_125_AU_NA + MAX_CHANNELS_BANDWIDTH_500_AU_NA));  
+		memset(&chUsedMask, 0, sizeof(chUsedMask));
 		
 		if ((RegParams.pChParams[RegParams.lastUsedChannelIndex].status == ENABLED) &&
 		(currDr >= RegParams.pChParams[RegParams.lastUsedChannelIndex].dataRange.min) &&
 		(currDr <= RegParams.pChParams[RegParams.lastUsedChannelIndex].dataRange.max))
 		{
 			*channelIndex = RegParams.lastUsedChannelIndex;
-			chUsed[*channelIndex] = true;
+			WriteChannelMaskBit(&chUsedMask, *channelIndex, true);
 		}
 		else
 		{
@@ -2675,6 +2727,81 @@ static StackRetStatus_t SearchAvailableChannel1 (uint8_t maxChannels, bool trans
 	}
 	return result;	
 }
+
+/*
+ * \brief Sets or clears the bit of a channel in a channel mask
+ * \param[in] mask Channel mask to update
+ * \param[in] chid Channel id, 0 to 71
+ * \param[in] set true to set the bit, false to clear it
+ */
+static void WriteChannelMaskBit(ChannelMask_t *mask, uint8_t chid, bool set)
+{
+	if (chid < MAX_CHANNELS_BANDWIDTH_125_AU_NA)
+	{
+		uint64_t bit = (uint64_t)1 << chid;
+		mask->ch125 = set ? (mask->ch125 | bit) : (mask->ch125 & ~bit);
+	}
+	else
+	{
+		uint8_t bit = (uint8_t)(1 << (chid - MAX_CHANNELS_BANDWIDTH_125_AU_NA));
+		mask->ch500 = set ? (mask->ch500 | bit) : (mask->ch500 & ~bit);
+	}
+}
+
+/*
+ * \brief Finds the n-th set bit of a channel mask
+ * \param[in] mask Channel mask holding more than n set bits
+ * \param[in] n Number of set bits to skip from channel 0
+ * \retval Channel id of the bit
+ */
+static uint8_t FindChannelMaskBit(const ChannelMask_t *mask, uint8_t n)
+{
+	uint64_t bits = mask->ch125;
+	uint8_t firstChId = 0;
+	uint8_t num125 = (uint8_t)__builtin_popcountll(bits);
+
+	if (n >= num125)
+	{
+		bits = mask->ch500;
+		firstChId = MAX_CHANNELS_BANDWIDTH_125_AU_NA;
+		n -= num125;
+	}
+	/* Clear the n lowest set bits, the lowest one left is the channel */
+	while (n--)
+	{
+		bits &= bits - 1;
+	}
+	return (uint8_t)(firstChId + __builtin_ctzll(bits));
+}
+
+/*
+ * \brief Updates the bits of a channel in the enabled and data rate channel
+ *        masks from its status and data range
+ * \param[in] chid Channel id, 0 to 71
+ */
+static void Update915ChannelMask(uint8_t chid)
+{
+	RegParamsType1_t *params = &RegParams.cmnParams.paramsType1;
+	DataRange_t dataRange = params->chParams[chid].dataRange;
+
+	WriteChannelMaskBit(&params->enabledChMask, chid, params->chParams[chid].status == ENABLED);
+	for (uint8_t dr = 0; dr <= MAX_TXDR_T1; dr++)
+	{
+		WriteChannelMaskBit(&params->drChMask[dr], chid, (dr >= dataRange.min) && (dr <= dataRange.max));
+	}
+}
+
+/*
+ * \brief Builds the enabled and data rate channel masks of all the NA and AU
+ *        channels, after the channel parameters are initialized or restored
+ */
+void Init915ChannelMasks(void)
+{
+	for (uint8_t i = 0; i < MAX_CHANNELS_AU_NA; i++)
+	{
+		Update915ChannelMask(i);
+	}
+}
 #endif
 
 static StackRetStatus_t select_channel_jr(uint8_t currDr, uint8_t* channelIndex)
@@ -2796,6 +2923,7 @@ static StackRetStatus_t SearchAvailableChannel2 (uint8_t maxChannels, bool trans
 	uint8_t randomNumber = 0;
 	memset(ChList, 0, sizeof(ChList));
 	bool bandWithoutDutyCycle = (((1 << RegParams.band) & (ISM_EUBAND | ISM_ASBAND | (1 << ISM_JPN923))) == 0);
+	uint64_t now = SwTimerGetTime();
 	
     if(transmissionType == false)
     {
@@ -2809,7 +2937,7 @@ static StackRetStatus_t SearchAvailableChannel2 (uint8_t maxChannels, bool trans
     }
     else
     {
-	    if(RegParams.aggregatedDutyCycleTimeout)
+	    if(RegParams.aggregatedAvailableAt > now)
 	    {
 		    return LORAWAN_NO_CHANNELS_FOUND;
 	    }
@@ -2822,7 +2950,7 @@ static StackRetStatus_t SearchAvailableChannel2 (uint8_t maxChannels, bool trans
 				(currDr <= RegParams.pChParams[i].dataRange.max))
 			{
 				if(((transmissionType == 0)  && (RegParams.pOtherChParams[i].joinRequestChannel == 1)) || 
-				((transmissionType != 0) && (bandWithoutDutyCycle || RegParams.pSubBandParams[RegParams.pOtherChParams[i].subBandId].subBandTimeout == 0))) 
+				((transmissionType != 0) && (bandWithoutDutyCycle || RegParams.pSubBandParams[RegParams.pOtherChParams[i].subBandId].availableAt <= now))) 
 				{
 					ChList[num] = i;
 					num++;
@@ -2951,90 +3079,6 @@ void StopAllRegSoftwareTimers (void)
 }
 
 
-/*
- * \brief Timer callback for updating the duty cycle timer
- * \param Timer Parameters
- */
-#if (EU_BAND == 1) || (AS_BAND == 1) || (JPN_BAND == 1)
-static void DutyCycleCallback (uint8_t param)
-{
-    uint32_t minimSubBandTimer = UINT32_MAX;
-	uint32_t nextTimer;
-    bool found = 0;
-    uint8_t i;
-	uint32_t DutyCycleTimeout = RegParams.aggregatedDutyCycleTimeout;
-
-    for (i=0; i < RegParams.maxSubBands; i++)
-    {
-        //Validate this only for enabled channels
-        if (( RegParams.pSubBandParams[i].subBandTimeout != 0 ))
-        {
-            if ( RegParams.pSubBandParams[i].subBandTimeout > RegParams.pDutyCycleTimer->lastTimerValue )
-            {
-                RegParams.pSubBandParams[i].subBandTimeout = RegParams.pSubBandParams[i].subBandTimeout - RegParams.pDutyCycleTimer->lastTimerValue;
-            }
-            else
-            {
-                RegParams.pSubBandParams[i].subBandTimeout = 0;
-            } 
-            if ( (RegParams.pSubBandParams[i].subBandTimeout <= minimSubBandTimer) && (RegParams.pSubBandParams[i].subBandTimeout != 0) )
-            {
-                minimSubBandTimer  = RegParams.pSubBandParams[i].subBandTimeout;
-                found = 1;
-            }
-        }
-    }
-	
-    if (( DutyCycleTimeout != 0 ))
-    {
-	    if (DutyCycleTimeout > RegParams.pDutyCycleTimer->lastTimerValue)
-	    {
-		    RegParams.aggregatedDutyCycleTimeout = DutyCycleTimeout - RegParams.pDutyCycleTimer->lastTimerValue;
-	    }
-	    else
-	    {
-		    RegParams.aggregatedDutyCycleTimeout = 0;
-	    }
-		
-		DutyCycleTimeout = RegParams.aggregatedDutyCycleTimeout;
-		
-		if(DutyCycleTimeout)
-		{
-			found = 1;
-		}
-    }
-		
-			
-    if ( found == 1 )
-    {		
-		if ((DutyCycleTimeout >= minimSubBandTimer))
-		{
-			nextTimer  = DutyCycleTimeout;			
-		}
-		else
-		{
-			nextTimer = minimSubBandTimer;
-		}
-
-        RegParams.pDutyCycleTimer->lastTimerValue = nextTimer;
-		SwTimerStart (RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, (void *)DutyCycleCallback, NULL);
-        
-    }
-}
-#endif
-
-/*
- * \brief Timer callback for updating the duty cycle timer
- * \param Timer Parameters
- */
-#if (NA_BAND == 1) || (AU_BAND == 1) || (IND_BAND == 1) || (KR_BAND == 1)
-static void DutyCycleCallback1 (uint8_t param)
-{
-	SwTimerStop(RegParams.pDutyCycleTimer->timerId);
-	RegParams.aggregatedDutyCycleTimeout = 0;
-}
-#endif
-
 void JoinDutyCycleCallback (uint8_t param)
 {   
 	
@@ -3319,6 +3363,7 @@ static StackRetStatus_t setDataRange (LorawanRegionalAttributes_t attr, void *at
 	else
 	{
 		RegParams.pChParams[update_dr.channelIndex].dataRange.value = update_dr.dataRangeNew;
+		Update915ChannelMask(update_dr.channelIndex);
 #if (ENABLE_PDS == 1)
 		PDS_STORE(RegParams.regParamItems.ch_param_1_item_id);
 #endif
@@ -3581,6 +3626,12 @@ static void UpdateChannelIdStatus(uint8_t chid, bool statusNew)
 	if(chid < RegParams.maxChannels || ((((1 << RegParams.band) & (ISM_NAAUBAND)) == 0) && chid >= RegParams.cmnParams.paramsType2.minNonDefChId))
 	{
 		RegParams.pChParams[chid].status = statusNew;
+#if (NA_BAND == 1 || AU_BAND == 1)
+		if(((1 << RegParams.band) & (ISM_NAAUBAND)) != 0)
+		{
+			Update915ChannelMask(chid);
+		}
+#endif
 #if (ENABLE_PDS == 1)
 		PDS_STORE(RegParams.regParamItems.ch_param_1_item_id);
 #endif
@@ -3615,7 +3666,7 @@ static void UpdateChannelIdStatusT2(uint8_t chid, bool statusNew)
 					 return;
 				 }
 			}
-			RegParams.pSubBandParams[subBandId].subBandTimeout = 0;
+			RegParams.pSubBandParams[subBandId].availableAt = 0;
 		}
 	}
 }
@@ -3755,7 +3806,7 @@ static StackRetStatus_t setDutyCycle(LorawanRegionalAttributes_t attr, void *att
 		uint8_t bandId;
 		bandId = RegParams.pOtherChParams[updateDCycle.channelIndex].subBandId;
 		RegParams.cmnParams.paramsType2.subBandDutyCycle[bandId] = updateDCycle.dutyCycleNew;
-		RegParams.pSubBandParams[bandId].subBandTimeout = 0;
+		RegParams.pSubBandParams[bandId].availableAt = 0;
 		RegParams.pOtherChParams[updateDCycle.channelIndex].parametersDefined |= DUTY_CYCLE_DEFINED;
 #if (ENABLE_PDS == 1)
 		PDS_STORE(RegParams.regParamItems.ch_param_2_item_id);
@@ -3774,10 +3825,8 @@ static StackRetStatus_t setDutyCycleTimer(LorawanRegionalAttributes_t attr, void
 {
 	UpdateDutyCycleTimer_t updateDCTimer;
 	StackRetStatus_t result = LORAWAN_SUCCESS;
-    bool found = 0;
-    uint8_t i,bandId;
-    
-    uint32_t delta = 0, minimSubBandTimer = UINT32_MAX, ticks,nextTimer;
+    uint8_t bandId;
+	uint64_t now = SwTimerGetTime();
 	
 	memcpy(&updateDCTimer,attrInput,sizeof(UpdateDutyCycleTimer_t));
 		
@@ -3794,89 +3843,17 @@ static StackRetStatus_t setDutyCycleTimer(LorawanRegionalAttributes_t attr, void
 	// this duty cycle setting applies only for data frames; if join frame was latest, then return immediately
 	if(updateDCTimer.joining != 1)
 	{
-		// find the new timeout for the subband used for last TX
-		RegParams.pSubBandParams[bandId].subBandTimeout = ((uint32_t)updateDCTimer.timeOnAir * ((uint32_t)RegParams.cmnParams.paramsType2.subBandDutyCycle[bandId] - 1));
-		// find the new aggregated timeout over all bands
-		RegParams.aggregatedDutyCycleTimeout = (uint32_t)updateDCTimer.timeOnAir * ((uint32_t) updateDCTimer.aggDutyCycle - 1);
+		// the subband used for last TX is available again at the end of its off time,
+		// the other subbands keep theirs and need no update
+		RegParams.pSubBandParams[bandId].availableAt = now + MS_TO_US((uint64_t)((uint32_t)updateDCTimer.timeOnAir * ((uint32_t)RegParams.cmnParams.paramsType2.subBandDutyCycle[bandId] - 1)));
+		// following works if DutyCycleReq command imposed specific restrictions in addition to the regional parameters regulations
+		RegParams.aggregatedAvailableAt = now + MS_TO_US((uint64_t)((uint32_t)updateDCTimer.timeOnAir * ((uint32_t) updateDCTimer.aggDutyCycle - 1)));
 	}
 	else
 	{
 		RegParams.joinDutyCycleTimeout = (uint32_t)updateDCTimer.timeOnAir * ((uint32_t) updateDCTimer.aggDutyCycle - 1);
 	}
 	
-	// find how much time from last timeout is due yet
-	if(SwTimerIsRunning(RegParams.pDutyCycleTimer->timerId))
-	{
-		SwTimerStop(RegParams.pDutyCycleTimer->timerId);
-		ticks = SwTimerReadValue(RegParams.pDutyCycleTimer->timerId);
-		
-		delta = RegParams.pDutyCycleTimer->lastTimerValue - US_TO_MS(ticks);
-	}
-	// assume that last-used-subband has the minimum most timeout
-	minimSubBandTimer = RegParams.pSubBandParams[bandId].subBandTimeout;
-	found = 1;
-	
-	// walk over all available sub-bands
-	for(i = 0; i < RegParams.maxSubBands; i++)
-	{ // ignore if this the last used sub-band -- bandId stores it's index
-		// cond #1: it is a sub-band other than last used sub-band
-		// cond #2: it is a sub-band that cannot be used right now
-		// BOTH HAS TO HOLD TRUE
-		if((i != bandId) && (RegParams.pSubBandParams[i].subBandTimeout != 0))
-		{
-			if(RegParams.pSubBandParams[i].subBandTimeout > delta)
-			{
-				// this sub-band has timeout left yet
-				RegParams.pSubBandParams[i].subBandTimeout = 
-				          RegParams.pSubBandParams[i].subBandTimeout - delta;
-			}
-			else
-			{// this sub-band timeout has elapsed already
-				RegParams.pSubBandParams[i].subBandTimeout = 0;
-			}
-			
-			if(RegParams.pSubBandParams[i].subBandTimeout <= minimSubBandTimer && RegParams.pSubBandParams[i].subBandTimeout != 0)
-			{
-				// if this is smaller time than last used subband and it has still timeout to elapse then this is the new minimum
-				minimSubBandTimer = RegParams.pSubBandParams[i].subBandTimeout;
-				found = 1;
-			}
-		}
-	}
-	
-	// following block works if DutyCycleReq command imposed specific restrictions in addition to the regional parameters regulations
-	if(RegParams.aggregatedDutyCycleTimeout != 0)
-	{
-		if(RegParams.aggregatedDutyCycleTimeout > delta)
-		{
-			RegParams.aggregatedDutyCycleTimeout = RegParams.aggregatedDutyCycleTimeout - delta;
-		}
-		else
-		{
-			RegParams.aggregatedDutyCycleTimeout = 0;
-		}
-		
-		if(RegParams.aggregatedDutyCycleTimeout)
-		{
-			found = 1;
-		}
-	}
-	
-	
-	if(found == 1)
-	{
-		if(RegParams.aggregatedDutyCycleTimeout >= minimSubBandTimer)
-		{
-			nextTimer = RegParams.aggregatedDutyCycleTimeout;
-		}
-		else
-		{
-			nextTimer = minimSubBandTimer;
-		}
-		
-		RegParams.pDutyCycleTimer->lastTimerValue = nextTimer;
-		SwTimerStart (RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, (void *)DutyCycleCallback, NULL);
-	}
 	return result;
 }
 #endif
@@ -3887,35 +3864,19 @@ static StackRetStatus_t setDutyCycleTimer1(LorawanRegionalAttributes_t attr, voi
 	UpdateDutyCycleTimer_t updateDCTimer;
 	StackRetStatus_t result = LORAWAN_SUCCESS;
 	
-	uint32_t nextTimer;
-	
 	memcpy(&updateDCTimer,attrInput,sizeof(UpdateDutyCycleTimer_t));
 	
 	// this duty cycle setting applies only for data frames; if join frame was latest, then return immediately
 	if(updateDCTimer.joining != 1)
 	{
-		// find the new aggregated timeout over all bands
-		RegParams.aggregatedDutyCycleTimeout = (uint32_t)updateDCTimer.timeOnAir * ((uint32_t) updateDCTimer.aggDutyCycle - 1);
+		// find the end of the new aggregated off time over all bands
+		RegParams.aggregatedAvailableAt = SwTimerGetTime() + MS_TO_US((uint64_t)((uint32_t)updateDCTimer.timeOnAir * ((uint32_t) updateDCTimer.aggDutyCycle - 1)));
 	}
 	else
 	{
 		RegParams.joinDutyCycleTimeout = (uint32_t)updateDCTimer.timeOnAir * ((uint32_t) updateDCTimer.aggDutyCycle - 1);
 	}
 	
-	// Stop the dutycycle timer if it is already running
-	if(SwTimerIsRunning(RegParams.pDutyCycleTimer->timerId))
-	{
-		SwTimerStop(RegParams.pDutyCycleTimer->timerId);
-	}
-	
-	// following block works if DutyCycleReq command imposed specific restrictions in addition to the regional parameters regulations
-	if(RegParams.aggregatedDutyCycleTimeout > 0)
-	{
-		nextTimer = RegParams.aggregatedDutyCycleTimeout;
-		RegParams.pDutyCycleTimer->lastTimerValue = nextTimer;
-		result = SwTimerStart (RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, (void *)DutyCycleCallback1, NULL);
-	}
-	
 	return result;
 }
 #endif
@@ -4403,6 +4364,7 @@ static StackRetStatus_t setJoinSuccess(LorawanRegionalAttributes_t attr, void *a
 			|| ((i >= MAX_CHANNELS_BANDWIDTH_125_AU_NA) && (i != lastUsedSB + MAX_CHANNELS_BANDWIDTH_125_AU_NA - 1)))
 		{
 			RegParams.pChParams[i].status = DISABLED;	
+			Update915ChannelMask(i);
 		}
 	}
 #if (ENABLE_PDS == 1)
@@ -4419,6 +4381,7 @@ static StackRetStatus_t setEnableAllChs(LorawanRegionalAttributes_t attr, void *
 	for(uint8_t i = 0; i < (NO_OF_CH_IN_SUBBAND * (MAX_SUBBANDS + 1)); i++)
 	{
 		RegParams.pChParams[i].status = ENABLED;	
+		Update915ChannelMask(i);
 	}
 	RegParams.cmnParams.paramsType1.lastUsedSB = 0;
 #if (ENABLE_PDS == 1)
@@ -4449,6 +4412,9 @@ void Enableallchannels()
 	for(uint8_t i = 0; i < NUM_CHANNEL_GW_SUPPORTED/*(NO_OF_CH_IN_SUBBAND * (MAX_SUBBANDS + 1))*/; i++)// Enable only channels 0-7 As per Pre-Certification settings
 	{
 		RegParams.pChParams[i].status = ENABLED;
+#if (NA_BAND == 1 || AU_BAND == 1)
+		Update915ChannelMask(i);
+#endif
 	}
 	RegParams.cmnParams.paramsType1.lastUsedSB = 0;
 #if (ENABLE_PDS == 1)
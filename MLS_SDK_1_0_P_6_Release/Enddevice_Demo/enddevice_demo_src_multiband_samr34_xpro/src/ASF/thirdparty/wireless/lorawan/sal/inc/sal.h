@@ -67,6 +67,12 @@ typedef enum _salItems
 /* Total No of items in SalItems_t */
 #define SAL_ITEMS_NUM		SAL_MAX_ITEMS
 
+/* Number of keys whose CMAC subkeys are kept: AppKey, NwkSKey and the
+ * NwkSKey of the multicast groups */
+#ifndef SAL_CMAC_SUBKEY_COUNT
+#define SAL_CMAC_SUBKEY_COUNT	6
+#endif
+
 /* Describes the various status of the Security Layer for the given request */
 typedef enum _SalStatus
 {
@@ -78,6 +84,32 @@ typedef enum _SalStatus
 	SAL_INVALID_KEY_TYPE	= 0x02
 	
 } SalStatus_t;
+
+/* State of a CMAC computation whose data is given in segments */
+typedef struct _SalCmacContext
+{
+	/* Key and name of the key of the computation */
+	uint8_t* key;
+	salItems_t keyType;
+	/* CMAC value of the blocks chained so far */
+	uint8_t chain[SAL_KEY_LEN];
+	/* Block kept back until it is known whether it is the last one */
+	uint8_t pending[SAL_KEY_LEN];
+	uint8_t pendingLength;
+} SalCmacContext_t;
+
+/* Statistics of the transactions with the crypto device */
+typedef struct _SalDeviceStats
+{
+	/* Number of operations (AES, KDF, read, write) executed by the crypto device */
+	uint32_t operations;
+	/* Number of batches started by SAL_BatchStart */
+	uint32_t batches;
+	/* Time spent in the transactions with the crypto device, bus and execution, in microseconds */
+	uint32_t busTime;
+	/* Time spent in the transactions of the last batch, in microseconds */
+	uint32_t lastBatchTime;
+} SalDeviceStats_t;
  
  /**
  * \brief This function initializes the security modules like AES, ECC608 (If used)
@@ -104,6 +136,44 @@ SalStatus_t SAL_Init(void);
  */
 SalStatus_t SAL_AESEncode(unsigned char* buffer, salItems_t key_type, unsigned char* key);
 
+/**
+ * \brief This function encrypts whole blocks of data with the key specified/the key stored in ECC608A.
+ *        A key given by the upper layer is loaded in the AES engine once for all the blocks.
+ *
+ * \param[in,out]  *buffer  -  pointer to the blocks of data to be encrypted in place
+ * \param[in]  count    -  number of 16 bytes blocks
+ * \param[in]  key_type -  Name of the key which is used to encrypt the data
+ *						   (Note: This parameter is used when Key is stored in ECC608)
+ * \param[in]  *key		-  Pointer to the key used for Encryption
+ *						   (Note: This parameter is used when Key is provided by the upper layer)
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when encryption is successful
+ *         SAL_FAILURE			-- when encryption is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given as input parameter
+ */
+SalStatus_t SAL_AESEncodeBlocks(unsigned char* buffer, uint16_t count, salItems_t key_type, unsigned char* key);
+
+/**
+ * \brief This function encrypts or decrypts a buffer in counter mode (CTR) with the key specified.
+ *        The key stream of the n-th block is the encryption of the counter block incremented by n
+ *        in its last two bytes (big endian). Input and output may be the same buffer.
+ *
+ * \param[out]  *output	-  Pointer to the result, size bytes
+ * \param[in]   *input		-  Pointer to the data to be encrypted or decrypted, size bytes
+ * \param[in]	size        -  Length of the data
+ * \param[in]   *counter	-  Pointer to the 16 bytes counter block of the first block
+ * \param[in]  key_type		-  value of type salItems_t - Name of the key which is used for the key stream
+ *						       (Note: This parameter is used when key is stored in ECC608)
+ * \param[in]  *key		    -  Pointer to the key used for the key stream
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when encryption is successful
+ *         SAL_FAILURE			-- when encryption is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given as input parameter
+ */
+SalStatus_t SAL_AESCtr(uint8_t* output, uint8_t* input, uint16_t size, uint8_t* counter, salItems_t key_type, uint8_t* key);
+
 /**
  * \brief This function derives the session key using the Block of data given as input
  *
@@ -142,6 +212,69 @@ SalStatus_t SAL_DeriveSessionKey(unsigned char* block, salItems_t src_key, unsig
  */
 SalStatus_t SAL_AESCmac(uint8_t* key, salItems_t key_type, uint8_t* output, uint8_t* input, uint16_t size);
 
+/**
+ * \brief This function starts a CMAC computation whose data is given in segments by SAL_AESCmacUpdate
+ *
+ * \param[out] *context		-  Pointer to the state of the computation
+ * \param[in]  *key		    -  Pointer to the key used for calculating the CMAC value, it must stay
+ *							   valid until SAL_AESCmacFinal
+ * \param[in]  key_type		-  value of type salItems_t - Name of the key which is used to calculate the CMAC
+ *						       (Note: This parameter is used when key is stored in ECC608)
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the computation is started
+ */
+SalStatus_t SAL_AESCmacInit(SalCmacContext_t* context, uint8_t* key, salItems_t key_type);
+
+/**
+ * \brief This function adds a segment of data to a CMAC computation. The segments are
+ *        processed as if they were contiguous, without being copied together.
+ *
+ * \param[in,out] *context	-  Pointer to the state of the computation
+ * \param[in]   *input		-  Pointer to the segment
+ * \param[in]	size        -  Length of the segment
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the segment is processed
+ *         SAL_FAILURE			-- when the encryption is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given to SAL_AESCmacInit
+ */
+SalStatus_t SAL_AESCmacUpdate(SalCmacContext_t* context, uint8_t* input, uint16_t size);
+
+/**
+ * \brief This function completes a CMAC computation
+ *
+ * \param[in,out] *context	-  Pointer to the state of the computation
+ * \param[out]  *output		-  Pointer to the 16bytes CMAC value
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when CMAC calculation is successful
+ *         SAL_FAILURE			-- when CMAC calculation is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given to SAL_AESCmacInit
+ */
+SalStatus_t SAL_AESCmacFinal(SalCmacContext_t* context, uint8_t* output);
+
+/**
+ * \brief This function derives the CMAC subkeys K1/K2 of a key and keeps them for SAL_AESCmac.
+ *        Setting a new key for the same key_type and key_id replaces its subkeys.
+ *
+ * \param[in]  key_type		-  value of type salItems_t - Name of the key
+ * \param[in]  key_id		-  Index of the key among the keys of the same type (multicast group), 0 otherwise
+ * \param[in]  *key		    -  Pointer to the key (Note: not used when the key is stored in ECC608)
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the subkeys are derived and kept
+ *         SAL_FAILURE			-- when the derivation failed or there is no room left, SAL_AESCmac
+ *								   then derives the subkeys of this key on every call
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given as input parameter
+ */
+SalStatus_t SAL_CmacSubkeyUpdate(salItems_t key_type, uint8_t key_id, uint8_t* key);
+
+/**
+ * \brief This function erases all the CMAC subkeys kept by SAL_CmacSubkeyUpdate
+ */
+void SAL_CmacSubkeyClear(void);
+
 /**
  * \brief This function reads back the keys from ECC608 device using Encrypted Read
  *
@@ -156,4 +289,33 @@ SalStatus_t SAL_AESCmac(uint8_t* key, salItems_t key_type, uint8_t* output, uint
  */
 SalStatus_t SAL_Read(salItems_t key_type, uint8_t* key);
 
+/**
+ * \brief This function starts a batch of operations: the crypto device (ECC608) is kept awake
+ *        from the first operation until SAL_BatchEnd instead of being woken up for each of them.
+ *        Without crypto device it does nothing.
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the batch is started or a batch is already running
+ *         SAL_FAILURE			-- when the crypto device cannot be held awake
+ */
+SalStatus_t SAL_BatchStart(void);
+
+/**
+ * \brief This function ends the batch started by SAL_BatchStart and puts the crypto device
+ *        into the idle state
+ */
+void SAL_BatchEnd(void);
+
+/**
+ * \brief This function gives the statistics of the transactions with the crypto device
+ *
+ * \param[out]  *stats		-  Pointer to the statistics
+ */
+void SAL_GetDeviceStats(SalDeviceStats_t* stats);
+
+/**
+ * \brief This function clears the statistics of the transactions with the crypto device
+ */
+void SAL_ClearDeviceStats(void);
+
 #endif  // _SAL_H
\ No newline at end of file
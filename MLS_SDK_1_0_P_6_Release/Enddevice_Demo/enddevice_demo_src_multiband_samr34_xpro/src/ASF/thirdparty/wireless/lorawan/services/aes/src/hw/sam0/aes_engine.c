@@ -41,6 +41,9 @@
 #include "aes_engine.h"
 #include "asf.h"
 
+/* The software implementation is built instead, see src/sw/aes_engine.c */
+#ifndef AES_SW_ENGINE
+
 /**************************************** MACROS******************************/
 /* 32bit array of size 4 used as input/argument for aes drivers*/
 #define SUB_BLOCK_COUNT 4
@@ -55,6 +58,19 @@ static uint32_t io_data[SUB_BLOCK_COUNT];
 /* AES instance*/
 struct aes_module aes_instance;
 
+/* Key of the session */
+static uint32_t sessionKey[SUB_BLOCK_COUNT];
+
+/* The engine is configured with the key of the session in sessionMode */
+static bool sessionLoaded;
+
+/* Operation mode the engine is configured in for the session */
+static enum aes_operation_mode sessionMode;
+
+/************************************* PROTOTYPES*****************************/
+static void aesSessionLoad(enum aes_operation_mode mode);
+static void aesSessionProcess(unsigned char* output, unsigned char* input, uint8_t length, bool first);
+
 /*************************************IMPLEMENTATION****************************/
 /**
  * \brief Encrypts the given block of data
@@ -98,6 +114,104 @@ void AESEncode(unsigned char* block, unsigned char* masterKey)
 	aes_read_output_data(&aes_instance,io_data);
 	
 	memcpy(block,io_data,BLOCKSIZE);
+
+	/* The configuration and the key of the session are overwritten */
+	sessionLoaded = false;
+}
+
+/**
+ * \brief Starts an AES session: the key is loaded in the engine once and used
+ *        by the following session calls until another session is started.
+ * \param[in] key Cryptographic key to be used in AES encryption
+ */
+void AESSessionStart(unsigned char* key)
+{
+	uint32_t keyWords[SUB_BLOCK_COUNT];
+
+	for(uint8_t i=0;i<SUB_BLOCK_COUNT;i++)
+	{
+		keyWords[i] = convert_byte_array_to_32_bit(key+(i*(sizeof(uint32_t))));
+	}
+
+	if (memcmp(keyWords, sessionKey, sizeof(sessionKey)))
+	{
+		memcpy(sessionKey, keyWords, sizeof(sessionKey));
+		sessionLoaded = false;
+	}
+}
+
+/**
+ * \brief Encrypts whole blocks in place with the key of the session (ECB)
+ * \param[in,out] blocks Blocks of input data to be encrypted
+ * \param[in] count Number of blocks
+ */
+void AESSessionEncode(unsigned char* blocks, uint16_t count)
+{
+	aesSessionLoad(AES_ECB_MODE);
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		aesSessionProcess(&blocks[i * BLOCKSIZE], &blocks[i * BLOCKSIZE], BLOCKSIZE, false);
+	}
+}
+
+/**
+ * \brief Encrypts or decrypts a buffer in counter mode with the key of the
+ *        session. The block counter of the engine is 16 bits, enough for the
+ *        16 blocks of the largest LoRaWAN frame.
+ * \param[out] output Result, length bytes
+ * \param[in] input Data to be encrypted or decrypted, length bytes
+ * \param[in] length Length of the data in bytes
+ * \param[in] counter Counter block of the first block
+ */
+void AESSessionCtr(unsigned char* output, unsigned char* input, uint16_t length, unsigned char* counter)
+{
+	uint16_t offset;
+
+	aesSessionLoad(AES_CTR_MODE);
+
+	memcpy(io_data, counter, BLOCKSIZE);
+	aes_write_init_vector(&aes_instance, io_data);
+	aes_set_new_message(&aes_instance);
+
+	for (offset = 0; offset < length; offset += BLOCKSIZE)
+	{
+		uint8_t size = ((length - offset) < BLOCKSIZE) ? (uint8_t)(length - offset) : BLOCKSIZE;
+
+		aesSessionProcess(&output[offset], &input[offset], size, (0 == offset));
+	}
+
+	if (0 == length)
+	{
+		aes_clear_new_message(&aes_instance);
+	}
+}
+
+/**
+ * \brief Chains whole blocks through the cipher with the key of the session
+ *        (CBC-MAC), the engine chains the blocks in CBC mode
+ * \param[in,out] chain Chaining value, all zeros to start a MAC
+ * \param[in] input Blocks to be chained
+ * \param[in] count Number of blocks
+ */
+void AESSessionCbcMac(unsigned char* chain, unsigned char* input, uint16_t count)
+{
+	if (0 == count)
+	{
+		return;
+	}
+
+	aesSessionLoad(AES_CBC_MODE);
+
+	memcpy(io_data, chain, BLOCKSIZE);
+	aes_write_init_vector(&aes_instance, io_data);
+	aes_set_new_message(&aes_instance);
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		/* Only the output of the last block is the chaining value */
+		aesSessionProcess(((count - 1) == i) ? chain : NULL, &input[i * BLOCKSIZE], BLOCKSIZE, (0 == i));
+	}
 }
 
 /**
@@ -114,5 +228,61 @@ void AESInit(void)
 	//! [setup_config_defaults]
 	//! [module_enable]
 	aes_enable(&aes_instance);	
+
+	sessionLoaded = false;
+}
+
+/**
+ * \brief Configures the engine in the given mode with the key of the session,
+ *        unless it already is
+ * \param[in] mode Operation mode
+ */
+static void aesSessionLoad(enum aes_operation_mode mode)
+{
+	if (sessionLoaded && (mode == sessionMode))
+	{
+		return;
+	}
+
+	g_aes_cfg.encrypt_mode = AES_ENCRYPTION;
+	g_aes_cfg.key_size = AES_KEY_SIZE_128;
+	g_aes_cfg.start_mode = AES_AUTO_START;
+	g_aes_cfg.opmode = mode;
+	g_aes_cfg.cfb_size = AES_CFB_SIZE_128;
+	g_aes_cfg.lod = false;
+	aes_set_config(&aes_instance,AES, &g_aes_cfg);
+	aes_write_key(&aes_instance, sessionKey);
+
+	sessionMode = mode;
+	sessionLoaded = true;
+}
+
+/**
+ * \brief Runs one block through the engine, a partial block is padded with zeros
+ * \param[out] output Output block, may be NULL
+ * \param[in] input Input block
+ * \param[in] length Length of the block
+ * \param[in] first First block of a message, the new message flag is set
+ */
+static void aesSessionProcess(unsigned char* output, unsigned char* input, uint8_t length, bool first)
+{
+	memset(io_data, 0, BLOCKSIZE);
+	memcpy(io_data, input, length);
+
+	aes_write_input_data(&aes_instance, io_data);
+	if (first)
+	{
+		aes_clear_new_message(&aes_instance);
+	}
+	/* Wait for the end of the encryption process. */
+	while (!(aes_get_status(&aes_instance) & AES_ENCRYPTION_COMPLETE)) {
+	}
+	aes_read_output_data(&aes_instance,io_data);
+
+	if (NULL != output)
+	{
+		memcpy(output, io_data, length);
+	}
 }
 
+#endif /* AES_SW_ENGINE */
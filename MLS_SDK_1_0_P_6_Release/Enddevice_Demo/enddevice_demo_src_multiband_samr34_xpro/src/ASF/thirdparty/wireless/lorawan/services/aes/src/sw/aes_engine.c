@@ -0,0 +1,687 @@
+/**
+* \file  aes_engine.c
+*
+* \brief This is the software implementation of the AES Module (AES_SW_ENGINE)
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/**************************************** INCLUDES****************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "aes_engine.h"
+
+#ifdef AES_SW_ENGINE
+
+#if (AES_SW_ENGINE != AES_SW_COMPACT) && (AES_SW_ENGINE != AES_SW_TTABLE)
+#error "AES_SW_ENGINE must be AES_SW_COMPACT or AES_SW_TTABLE"
+#endif
+
+/**************************************** MACROS******************************/
+/* Number of rounds of AES-128 */
+#define AES_ROUNDS			10
+
+/* Round constant of the first round of the key expansion */
+#define AES_RCON_FIRST		0x01
+
+/**************************************** GLOBALS****************************/
+#if (AES_SW_ENGINE == AES_SW_TTABLE)
+/* S-box, for the last round and the key expansion */
+static const uint8_t sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+/* Round table: SubBytes and MixColumns of one byte of a column, the tables of
+ * the other rows are this one rotated by one, two and three bytes */
+static const uint32_t te0[256] = {
+	0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd, 0xde6f6fb1, 0x91c5c554,
+	0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d, 0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a,
+	0x8fcaca45, 0x1f82829d, 0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+	0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7, 0xe4727296, 0x9bc0c05b,
+	0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a, 0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f,
+	0x6834345c, 0x51a5a5f4, 0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+	0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1, 0x0a05050f, 0x2f9a9ab5,
+	0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d, 0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f,
+	0x1209091b, 0x1d83839e, 0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+	0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e, 0x5e2f2f71, 0x13848497,
+	0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c, 0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed,
+	0xd46a6abe, 0x8dcbcb46, 0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+	0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7, 0x66333355, 0x11858594,
+	0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81, 0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3,
+	0xa25151f3, 0x5da3a3fe, 0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+	0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a, 0xfdf3f30e, 0xbfd2d26d,
+	0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f, 0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739,
+	0x93c4c457, 0x55a7a7f2, 0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+	0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e, 0x3b9090ab, 0x0b888883,
+	0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c, 0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76,
+	0xdbe0e03b, 0x64323256, 0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+	0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4, 0xd3e4e437, 0xf279798b,
+	0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7, 0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0,
+	0xd86c6cb4, 0xac5656fa, 0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+	0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1, 0x73b4b4c7, 0x97c6c651,
+	0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21, 0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85,
+	0xe0707090, 0x7c3e3e42, 0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+	0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158, 0x3a1d1d27, 0x279e9eb9,
+	0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133, 0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7,
+	0x2d9b9bb6, 0x3c1e1e22, 0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+	0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631, 0x844242c6, 0xd06868b8,
+	0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11, 0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a
+};
+
+/* Round keys, one word per column, the first byte in the most significant bits */
+static uint32_t schedule[4 * (AES_ROUNDS + 1)];
+#else
+/* Round keys in bit planes: bit i of plane j is bit j of byte i of the round key */
+static uint16_t schedule[AES_ROUNDS + 1][8];
+#endif
+
+/* Key of the session */
+static uint8_t sessionKey[BLOCKSIZE];
+
+/* The round keys are the ones of the key of the session */
+static bool sessionLoaded;
+
+/************************************* PROTOTYPES*****************************/
+static void aesSessionLoad(void);
+static void aesExpandKey(const uint8_t *key);
+static void aesCipher(uint8_t *block);
+static uint8_t aesXtime(uint8_t x);
+#if (AES_SW_ENGINE == AES_SW_COMPACT)
+static void aesToPlanes(uint32_t *planes, const uint8_t *bytes, uint8_t count);
+static void aesFromPlanes(uint8_t *bytes, const uint32_t *planes, uint8_t count);
+static void aesSubBytes(uint32_t *planes);
+static void aesShiftRows(uint32_t *planes);
+static void aesMixColumns(uint32_t *planes);
+#endif
+
+/*************************************IMPLEMENTATION****************************/
+/**
+ * \brief Initializes the AES Engine.
+ */
+void AESInit(void)
+{
+	sessionLoaded = false;
+}
+
+/**
+ * \brief Encrypts the given block of data
+ * \param[in,out] block Block of input data to be encrypted
+ * \param[in] key Cryptographic key to be used in AES encryption
+ */
+void AESEncode(unsigned char* block, unsigned char* key)
+{
+	aesExpandKey(key);
+	aesCipher(block);
+
+	/* Like the key of the peripheral, the round keys of the session are overwritten */
+	sessionLoaded = false;
+}
+
+/**
+ * \brief Starts an AES session: the key is expanded on the first session call
+ *        and used by the following session calls until another session is
+ *        started. The keys are compared in constant time.
+ * \param[in] key Cryptographic key to be used in AES encryption
+ */
+void AESSessionStart(unsigned char* key)
+{
+	uint8_t diff = 0;
+
+	for (uint8_t i = 0; i < BLOCKSIZE; i++)
+	{
+		diff |= sessionKey[i] ^ key[i];
+	}
+
+	if (diff)
+	{
+		memcpy(sessionKey, key, BLOCKSIZE);
+		sessionLoaded = false;
+	}
+}
+
+/**
+ * \brief Encrypts whole blocks in place with the key of the session (ECB)
+ * \param[in,out] blocks Blocks of input data to be encrypted
+ * \param[in] count Number of blocks
+ */
+void AESSessionEncode(unsigned char* blocks, uint16_t count)
+{
+	aesSessionLoad();
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		aesCipher(&blocks[i * BLOCKSIZE]);
+	}
+}
+
+/**
+ * \brief Encrypts or decrypts a buffer in counter mode with the key of the
+ *        session. The counter is 16 bits like the one of the peripheral.
+ * \param[out] output Result, length bytes
+ * \param[in] input Data to be encrypted or decrypted, length bytes
+ * \param[in] length Length of the data in bytes
+ * \param[in] counter Counter block of the first block
+ */
+void AESSessionCtr(unsigned char* output, unsigned char* input, uint16_t length, unsigned char* counter)
+{
+	uint8_t block[BLOCKSIZE];
+	uint16_t blockCounter = (uint16_t)((counter[BLOCKSIZE - 2] << 8) | counter[BLOCKSIZE - 1]);
+
+	aesSessionLoad();
+
+	for (uint16_t offset = 0; offset < length; offset += BLOCKSIZE)
+	{
+		uint16_t size = ((length - offset) < BLOCKSIZE) ? (uint16_t)(length - offset) : BLOCKSIZE;
+
+		memcpy(block, counter, BLOCKSIZE - 2);
+		block[BLOCKSIZE - 2] = (uint8_t)(blockCounter >> 8);
+		block[BLOCKSIZE - 1] = (uint8_t)blockCounter;
+		aesCipher(block);
+
+		for (uint16_t i = 0; i < size; i++)
+		{
+			output[offset + i] = input[offset + i] ^ block[i];
+		}
+		blockCounter++;
+	}
+}
+
+/**
+ * \brief Chains whole blocks through the cipher with the key of the session
+ *        (CBC-MAC): chain = E(chain ^ block) for every block
+ * \param[in,out] chain Chaining value, all zeros to start a MAC
+ * \param[in] input Blocks to be chained
+ * \param[in] count Number of blocks
+ */
+void AESSessionCbcMac(unsigned char* chain, unsigned char* input, uint16_t count)
+{
+	aesSessionLoad();
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		for (uint8_t j = 0; j < BLOCKSIZE; j++)
+		{
+			chain[j] ^= input[(i * BLOCKSIZE) + j];
+		}
+		aesCipher(chain);
+	}
+}
+
+/**
+ * \brief Expands the key of the session unless it already is
+ */
+static void aesSessionLoad(void)
+{
+	if (!sessionLoaded)
+	{
+		aesExpandKey(sessionKey);
+		sessionLoaded = true;
+	}
+}
+
+/**
+ * \brief Multiplies by x in GF(2^8), without branch on the value
+ * \param[in] x Value to be multiplied
+ * \return x times x
+ */
+static uint8_t aesXtime(uint8_t x)
+{
+	return (uint8_t)((x << 1) ^ (0x1b & (uint8_t)(0 - (x >> 7))));
+}
+
+#if (AES_SW_ENGINE == AES_SW_TTABLE)
+/**
+ * \brief Rotates a word right
+ * \param[in] x Word
+ * \param[in] n Number of bits, 8, 16 or 24
+ * \return Rotated word
+ */
+static inline uint32_t aesRor(uint32_t x, uint8_t n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+/**
+ * \brief Expands the key into the round keys
+ * \param[in] key Cryptographic key
+ */
+static void aesExpandKey(const uint8_t *key)
+{
+	uint8_t rcon = AES_RCON_FIRST;
+	uint32_t t;
+
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		schedule[i] = ((uint32_t)key[4 * i] << 24) | ((uint32_t)key[4 * i + 1] << 16) |
+			((uint32_t)key[4 * i + 2] << 8) | key[4 * i + 3];
+	}
+
+	for (uint8_t i = 4; i < (4 * (AES_ROUNDS + 1)); i++)
+	{
+		t = schedule[i - 1];
+		if (0 == (i % 4))
+		{
+			/* RotWord, SubWord and the round constant */
+			t = ((uint32_t)(sbox[(t >> 16) & 0xff] ^ rcon) << 24) | ((uint32_t)sbox[(t >> 8) & 0xff] << 16) |
+				((uint32_t)sbox[t & 0xff] << 8) | sbox[t >> 24];
+			rcon = aesXtime(rcon);
+		}
+		schedule[i] = schedule[i - 4] ^ t;
+	}
+}
+
+/**
+ * \brief Encrypts one block with the round keys: every round is four lookups
+ *        per column, the last one goes through the S-box
+ * \param[in,out] block Block to be encrypted
+ */
+static void aesCipher(uint8_t *block)
+{
+	uint32_t s[4], t[4];
+	const uint32_t *rk = schedule;
+
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		s[i] = (((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+			((uint32_t)block[4 * i + 2] << 8) | block[4 * i + 3]) ^ rk[i];
+	}
+
+	for (uint8_t round = 1; round < AES_ROUNDS; round++)
+	{
+		rk += 4;
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			t[i] = te0[s[i] >> 24] ^ aesRor(te0[(s[(i + 1) & 3] >> 16) & 0xff], 8) ^
+				aesRor(te0[(s[(i + 2) & 3] >> 8) & 0xff], 16) ^ aesRor(te0[s[(i + 3) & 3] & 0xff], 24) ^ rk[i];
+		}
+		memcpy(s, t, sizeof(s));
+	}
+
+	rk += 4;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		t[i] = (((uint32_t)sbox[s[i] >> 24] << 24) | ((uint32_t)sbox[(s[(i + 1) & 3] >> 16) & 0xff] << 16) |
+			((uint32_t)sbox[(s[(i + 2) & 3] >> 8) & 0xff] << 8) | sbox[s[(i + 3) & 3] & 0xff]) ^ rk[i];
+		block[4 * i] = (uint8_t)(t[i] >> 24);
+		block[4 * i + 1] = (uint8_t)(t[i] >> 16);
+		block[4 * i + 2] = (uint8_t)(t[i] >> 8);
+		block[4 * i + 3] = (uint8_t)t[i];
+	}
+}
+#else
+/**
+ * \brief Expands the key into the round keys. SubWord goes through the S-box
+ *        circuit like the state, no table is indexed with the key.
+ * \param[in] key Cryptographic key
+ */
+static void aesExpandKey(const uint8_t *key)
+{
+	uint8_t roundKey[BLOCKSIZE];
+	uint8_t word[4];
+	uint32_t planes[8];
+	uint8_t rcon = AES_RCON_FIRST;
+
+	memcpy(roundKey, key, BLOCKSIZE);
+	aesToPlanes(planes, roundKey, BLOCKSIZE);
+	for (uint8_t j = 0; j < 8; j++)
+	{
+		schedule[0][j] = (uint16_t)planes[j];
+	}
+
+	for (uint8_t round = 1; round <= AES_ROUNDS; round++)
+	{
+		/* RotWord and SubWord of the last column */
+		word[0] = roundKey[13];
+		word[1] = roundKey[14];
+		word[2] = roundKey[15];
+		word[3] = roundKey[12];
+		aesToPlanes(planes, word, sizeof(word));
+		aesSubBytes(planes);
+		aesFromPlanes(word, planes, sizeof(word));
+		word[0] ^= rcon;
+		rcon = aesXtime(rcon);
+
+		for (uint8_t i = 0; i < BLOCKSIZE; i++)
+		{
+			roundKey[i] ^= (i < 4) ? word[i] : roundKey[i - 4];
+		}
+
+		aesToPlanes(planes, roundKey, BLOCKSIZE);
+		for (uint8_t j = 0; j < 8; j++)
+		{
+			schedule[round][j] = (uint16_t)planes[j];
+		}
+	}
+}
+
+/**
+ * \brief Encrypts one block with the round keys. The state is kept in bit
+ *        planes from the first to the last round: SubBytes is a boolean
+ *        circuit over the 16 bytes at once, ShiftRows and MixColumns are
+ *        shifts and masks. No branch or memory access depends on the data.
+ * \param[in,out] block Block to be encrypted
+ */
+static void aesCipher(uint8_t *block)
+{
+	uint32_t planes[8];
+
+	aesToPlanes(planes, block, BLOCKSIZE);
+
+	for (uint8_t round = 0; round <= AES_ROUNDS; round++)
+	{
+		if (0 != round)
+		{
+			aesSubBytes(planes);
+			aesShiftRows(planes);
+			/* MixColumns is skipped in the last round */
+			if (AES_ROUNDS != round)
+			{
+				aesMixColumns(planes);
+			}
+		}
+
+		for (uint8_t j = 0; j < 8; j++)
+		{
+			planes[j] ^= schedule[round][j];
+		}
+	}
+
+	aesFromPlanes(block, planes, BLOCKSIZE);
+}
+
+/**
+ * \brief Transposes bytes into bit planes: bit i of plane j is bit j of byte i
+ * \param[out] planes Eight bit planes
+ * \param[in] bytes Bytes to be transposed
+ * \param[in] count Number of bytes, at most 16
+ */
+static void aesToPlanes(uint32_t *planes, const uint8_t *bytes, uint8_t count)
+{
+	for (uint8_t j = 0; j < 8; j++)
+	{
+		uint32_t plane = 0;
+
+		for (uint8_t i = 0; i < count; i++)
+		{
+			plane |= (uint32_t)((bytes[i] >> j) & 1) << i;
+		}
+		planes[j] = plane;
+	}
+}
+
+/**
+ * \brief Transposes bit planes back into bytes
+ * \param[out] bytes Transposed bytes
+ * \param[in] planes Eight bit planes
+ * \param[in] count Number of bytes, at most 16
+ */
+static void aesFromPlanes(uint8_t *bytes, const uint32_t *planes, uint8_t count)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		uint8_t value = 0;
+
+		for (uint8_t j = 0; j < 8; j++)
+		{
+			value |= (uint8_t)(((planes[j] >> i) & 1) << j);
+		}
+		bytes[i] = value;
+	}
+}
+
+/**
+ * \brief S-box of every byte of the bit planes at once, with the circuit of
+ *        Boyar and Peralta (113 gates): a linear transformation on the input,
+ *        the inversion in GF(2^8) and the affine transformation on the output
+ * \param[in,out] planes Eight bit planes
+ */
+static void aesSubBytes(uint32_t *planes)
+{
+	uint32_t x0, x1, x2, x3, x4, x5, x6, x7;
+	uint32_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11;
+	uint32_t y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+	uint32_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12;
+	uint32_t z13, z14, z15, z16, z17;
+	uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12;
+	uint32_t t13, t14, t15, t16, t17, t18, t19, t20, t21, t22, t23;
+	uint32_t t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34;
+	uint32_t t35, t36, t37, t38, t39, t40, t41, t42, t43, t44, t45;
+	uint32_t t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56;
+	uint32_t t57, t58, t59, t60, t61, t62, t63, t64, t65, t66, t67;
+
+	/* x0 is the most significant bit */
+	x0 = planes[7];
+	x1 = planes[6];
+	x2 = planes[5];
+	x3 = planes[4];
+	x4 = planes[3];
+	x5 = planes[2];
+	x6 = planes[1];
+	x7 = planes[0];
+
+	/* Top linear transformation */
+	y14 = x3 ^ x5;
+	y13 = x0 ^ x6;
+	y9 = x0 ^ x3;
+	y8 = x0 ^ x5;
+	t0 = x1 ^ x2;
+	y1 = t0 ^ x7;
+	y4 = y1 ^ x3;
+	y12 = y13 ^ y14;
+	y2 = y1 ^ x0;
+	y5 = y1 ^ x6;
+	y3 = y5 ^ y8;
+	t1 = x4 ^ y12;
+	y15 = t1 ^ x5;
+	y20 = t1 ^ x1;
+	y6 = y15 ^ x7;
+	y10 = y15 ^ t0;
+	y11 = y20 ^ y9;
+	y7 = x7 ^ y11;
+	y17 = y10 ^ y11;
+	y19 = y10 ^ y8;
+	y16 = t0 ^ y11;
+	y21 = y13 ^ y16;
+	y18 = x0 ^ y16;
+
+	/* Non-linear section */
+	t2 = y12 & y15;
+	t3 = y3 & y6;
+	t4 = t3 ^ t2;
+	t5 = y4 & x7;
+	t6 = t5 ^ t2;
+	t7 = y13 & y16;
+	t8 = y5 & y1;
+	t9 = t8 ^ t7;
+	t10 = y2 & y7;
+	t11 = t10 ^ t7;
+	t12 = y9 & y11;
+	t13 = y14 & y17;
+	t14 = t13 ^ t12;
+	t15 = y8 & y10;
+	t16 = t15 ^ t12;
+	t17 = t4 ^ t14;
+	t18 = t6 ^ t16;
+	t19 = t9 ^ t14;
+	t20 = t11 ^ t16;
+	t21 = t17 ^ y20;
+	t22 = t18 ^ y19;
+	t23 = t19 ^ y21;
+	t24 = t20 ^ y18;
+
+	t25 = t21 ^ t22;
+	t26 = t21 & t23;
+	t27 = t24 ^ t26;
+	t28 = t25 & t27;
+	t29 = t28 ^ t22;
+	t30 = t23 ^ t24;
+	t31 = t22 ^ t26;
+	t32 = t31 & t30;
+	t33 = t32 ^ t24;
+	t34 = t23 ^ t33;
+	t35 = t27 ^ t33;
+	t36 = t24 & t35;
+	t37 = t36 ^ t34;
+	t38 = t27 ^ t36;
+	t39 = t29 & t38;
+	t40 = t25 ^ t39;
+
+	t41 = t40 ^ t37;
+	t42 = t29 ^ t33;
+	t43 = t29 ^ t40;
+	t44 = t33 ^ t37;
+	t45 = t42 ^ t41;
+	z0 = t44 & y15;
+	z1 = t37 & y6;
+	z2 = t33 & x7;
+	z3 = t43 & y16;
+	z4 = t40 & y1;
+	z5 = t29 & y7;
+	z6 = t42 & y11;
+	z7 = t45 & y17;
+	z8 = t41 & y10;
+	z9 = t44 & y12;
+	z10 = t37 & y3;
+	z11 = t33 & y4;
+	z12 = t43 & y13;
+	z13 = t40 & y5;
+	z14 = t29 & y2;
+	z15 = t42 & y9;
+	z16 = t45 & y14;
+	z17 = t41 & y8;
+
+	/* Bottom linear transformation */
+	t46 = z15 ^ z16;
+	t47 = z10 ^ z11;
+	t48 = z5 ^ z13;
+	t49 = z9 ^ z10;
+	t50 = z2 ^ z12;
+	t51 = z2 ^ z5;
+	t52 = z7 ^ z8;
+	t53 = z0 ^ z3;
+	t54 = z6 ^ z7;
+	t55 = z16 ^ z17;
+	t56 = z12 ^ t48;
+	t57 = t50 ^ t53;
+	t58 = z4 ^ t46;
+	t59 = z3 ^ t54;
+	t60 = t46 ^ t57;
+	t61 = z14 ^ t57;
+	t62 = t52 ^ t58;
+	t63 = t49 ^ t58;
+	t64 = z4 ^ t59;
+	t65 = t61 ^ t62;
+	t66 = z1 ^ t63;
+	planes[7] = t59 ^ t63;
+	planes[1] = t56 ^ ~t62;
+	planes[0] = t48 ^ ~t60;
+	t67 = t64 ^ t65;
+	planes[4] = t53 ^ t66;
+	planes[3] = t51 ^ t66;
+	planes[2] = t47 ^ t65;
+	planes[6] = t64 ^ ~planes[4];
+	planes[5] = t55 ^ ~t67;
+}
+
+/**
+ * \brief ShiftRows on the bit planes: byte i is in row i % 4 and column i / 4,
+ *        row r is rotated by r columns, that is 4 * r bits of a plane
+ * \param[in,out] planes Eight bit planes
+ */
+static void aesShiftRows(uint32_t *planes)
+{
+	for (uint8_t j = 0; j < 8; j++)
+	{
+		uint32_t x = planes[j];
+
+		planes[j] = (x & 0x1111) |
+			(((x & 0x2222) >> 4) | ((x & 0x0002) << 12)) |
+			(((x & 0x4444) >> 8) | ((x & 0x0044) << 8)) |
+			(((x & 0x8888) >> 12) | ((x & 0x0888) << 4));
+	}
+}
+
+/**
+ * \brief MixColumns on the bit planes: out[r] = a[r] ^ all ^ 2 * (a[r] ^ a[r + 1])
+ *        with all the sum of the four bytes of the column
+ * \param[in,out] planes Eight bit planes
+ */
+static void aesMixColumns(uint32_t *planes)
+{
+	uint32_t t[8];
+	uint32_t all;
+	uint8_t j;
+
+	/* a[r] ^ a[r + 1], the rows of a column are rotated by one bit */
+	for (j = 0; j < 8; j++)
+	{
+		t[j] = planes[j] ^ (((planes[j] >> 1) & 0x7777) | ((planes[j] << 3) & 0x8888));
+	}
+
+	for (j = 0; j < 8; j++)
+	{
+		/* The sum of the column is t[r] ^ t[r + 2] */
+		all = t[j] ^ (((t[j] >> 2) & 0x3333) | ((t[j] << 2) & 0xcccc));
+		planes[j] ^= all;
+	}
+
+	/* Multiplication of t by x: shift of the planes, reduced by 0x1b */
+	planes[0] ^= t[7];
+	planes[1] ^= t[0] ^ t[7];
+	planes[2] ^= t[1];
+	planes[3] ^= t[2] ^ t[7];
+	planes[4] ^= t[3] ^ t[7];
+	planes[5] ^= t[4];
+	planes[6] ^= t[5];
+	planes[7] ^= t[6];
+}
+#endif
+
+#endif /* AES_SW_ENGINE */
+
+/* eof aes_engine.c */
@@ -57,6 +57,14 @@
 				PDS_Store(file, itemNum); \
 				} while(0)
 
+/* Stores an item and writes its file at once, for the items which must not
+ * wait for PDS_WRITE_DELAY_MS such as the frame counter ceiling */
+#define PDS_STORE_NOW(item)			do {	\
+				PdsFileItemIdx_t file = item >> 8; \
+				uint8_t itemNum =  (uint8_t)(item & 0x00FF);\
+				PDS_StoreNow(file, itemNum); \
+				} while(0)
+
 #define PDS_DELETE(item)				do {	\
 				PdsFileItemIdx_t file = item >> 8; \
 				uint8_t itemNum =  (uint8_t)item & 0xFF; \
@@ -72,7 +80,9 @@
 #define PDS_FILE_START_OFFSET     	0x00
 
 #define PDS_NVM_VERSION				0x01	
+#define PDS_NVM_VERSION_CRC32		0x02
 #define PDS_WL_VERSION				0x01
+#define PDS_LOG_VERSION				0x01
 #define PDS_FILES_VERSION			0x01
 
 #define PDS_MAGIC					0xa5
@@ -230,6 +240,31 @@ PdsStatus_t PDS_RestoreAll(void);
 ******************************************************************************/
 PdsStatus_t PDS_StoreAll(void);
 
+/**************************************************************************//**
+\brief	This function writes the files with items stored or deleted and not
+		written yet, without waiting for the PDS task. It is called before
+		sleeping and is meant for the brownout detection of the application,
+		from the main loop: an interrupt may break in an erase of the NVM or
+		a compaction of the log. Called while a file is being written, it
+		returns PDS_ERROR and writes nothing.
+
+\param[in] none
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t PDS_Flush(void);
+
+/**************************************************************************//**
+\brief	This function stores an item and writes its file without waiting for
+		the PDS task nor PDS_WRITE_DELAY_MS, with the other items of the file
+		stored meanwhile. Called from an interrupt while the PDS task writes
+		a file, the item is left to the PDS task and PDS_ERROR is returned.
+
+\param[in] pdsFileItemIdx - The file id of the item.
+\param[in] item - The item id of the item in PDS.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t PDS_StoreNow(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item);
+
 /**************************************************************************//**
 \brief This function registers a file to the PDS.
 
@@ -239,7 +274,8 @@ PdsStatus_t PDS_StoreAll(void);
 PdsStatus_t PDS_RegFile(PdsFileItemIdx_t argFileId, PdsFileMarks_t argFileMarks);
 
 /**************************************************************************//**
-\brief This function un-registers a file to the PDS.
+\brief This function un-registers a file to the PDS. The items of the file
+       stored and not written yet are written first.
 
 \param[in] argFileId - The file id to un-register file to PDS.
 \param[out] status - The return status of the function's operation of type PdsStatus_t.
@@ -47,15 +47,68 @@
 
 //#define PDS_FLASH_START_ADDRESS        (0x003E000UL)
 #define PDS_FLASH_START_ADDRESS        NVMCTRL_RWW_EEPROM_ADDR
+/* Version of the headers of the rows written, telling their CRC */
+#if (PDS_CRC_ENGINE == PDS_CRC_DSU)
+#define PDS_NVM_WRITE_VERSION          PDS_NVM_VERSION_CRC32
+#else
+#define PDS_NVM_WRITE_VERSION          PDS_NVM_VERSION
+#endif
+
+/* CRC-32 of the DSU: reflected polynome, the result is not complemented */
+#define PDS_CRC32_POLYNOME             0xEDB88320UL
+#define PDS_CRC32_INIT                 0xFFFFFFFFUL
+
 /************************************************************************/
 /*  Static variables                                                    */
 /************************************************************************/
+#if (PDS_CRC_ENGINE == PDS_CRC_TABLE)
+/* CRC-16 CCITT of every byte value, Crc16Ccitt(0, byte) */
+static const uint16_t crc16Table[256] =
+{
+	0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
+	0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
+	0x1081, 0x0108, 0x3393, 0x221A, 0x56A5, 0x472C, 0x75B7, 0x643E,
+	0x9CC9, 0x8D40, 0xBFDB, 0xAE52, 0xDAED, 0xCB64, 0xF9FF, 0xE876,
+	0x2102, 0x308B, 0x0210, 0x1399, 0x6726, 0x76AF, 0x4434, 0x55BD,
+	0xAD4A, 0xBCC3, 0x8E58, 0x9FD1, 0xEB6E, 0xFAE7, 0xC87C, 0xD9F5,
+	0x3183, 0x200A, 0x1291, 0x0318, 0x77A7, 0x662E, 0x54B5, 0x453C,
+	0xBDCB, 0xAC42, 0x9ED9, 0x8F50, 0xFBEF, 0xEA66, 0xD8FD, 0xC974,
+	0x4204, 0x538D, 0x6116, 0x709F, 0x0420, 0x15A9, 0x2732, 0x36BB,
+	0xCE4C, 0xDFC5, 0xED5E, 0xFCD7, 0x8868, 0x99E1, 0xAB7A, 0xBAF3,
+	0x5285, 0x430C, 0x7197, 0x601E, 0x14A1, 0x0528, 0x37B3, 0x263A,
+	0xDECD, 0xCF44, 0xFDDF, 0xEC56, 0x98E9, 0x8960, 0xBBFB, 0xAA72,
+	0x6306, 0x728F, 0x4014, 0x519D, 0x2522, 0x34AB, 0x0630, 0x17B9,
+	0xEF4E, 0xFEC7, 0xCC5C, 0xDDD5, 0xA96A, 0xB8E3, 0x8A78, 0x9BF1,
+	0x7387, 0x620E, 0x5095, 0x411C, 0x35A3, 0x242A, 0x16B1, 0x0738,
+	0xFFCF, 0xEE46, 0xDCDD, 0xCD54, 0xB9EB, 0xA862, 0x9AF9, 0x8B70,
+	0x8408, 0x9581, 0xA71A, 0xB693, 0xC22C, 0xD3A5, 0xE13E, 0xF0B7,
+	0x0840, 0x19C9, 0x2B52, 0x3ADB, 0x4E64, 0x5FED, 0x6D76, 0x7CFF,
+	0x9489, 0x8500, 0xB79B, 0xA612, 0xD2AD, 0xC324, 0xF1BF, 0xE036,
+	0x18C1, 0x0948, 0x3BD3, 0x2A5A, 0x5EE5, 0x4F6C, 0x7DF7, 0x6C7E,
+	0xA50A, 0xB483, 0x8618, 0x9791, 0xE32E, 0xF2A7, 0xC03C, 0xD1B5,
+	0x2942, 0x38CB, 0x0A50, 0x1BD9, 0x6F66, 0x7EEF, 0x4C74, 0x5DFD,
+	0xB58B, 0xA402, 0x9699, 0x8710, 0xF3AF, 0xE226, 0xD0BD, 0xC134,
+	0x39C3, 0x284A, 0x1AD1, 0x0B58, 0x7FE7, 0x6E6E, 0x5CF5, 0x4D7C,
+	0xC60C, 0xD785, 0xE51E, 0xF497, 0x8028, 0x91A1, 0xA33A, 0xB2B3,
+	0x4A44, 0x5BCD, 0x6956, 0x78DF, 0x0C60, 0x1DE9, 0x2F72, 0x3EFB,
+	0xD68D, 0xC704, 0xF59F, 0xE416, 0x90A9, 0x8120, 0xB3BB, 0xA232,
+	0x5AC5, 0x4B4C, 0x79D7, 0x685E, 0x1CE1, 0x0D68, 0x3FF3, 0x2E7A,
+	0xE70E, 0xF687, 0xC41C, 0xD595, 0xA12A, 0xB0A3, 0x8238, 0x93B1,
+	0x6B46, 0x7ACF, 0x4854, 0x59DD, 0x2D62, 0x3CEB, 0x0E70, 0x1FF9,
+	0xF78F, 0xE606, 0xD49D, 0xC514, 0xB1AB, 0xA022, 0x92B9, 0x8330,
+	0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78
+};
+#endif
 
 /******************************************************************************
                    Static prototype section
 ******************************************************************************/
-static uint16_t calculate_crc(uint16_t length, uint8_t *data);
+static uint16_t calculate_crc(uint8_t version, uint16_t length, uint8_t *data);
+#if (PDS_CRC_ENGINE != PDS_CRC_TABLE)
 static uint16_t Crc16Ccitt(uint16_t initValue, uint8_t byte);
+#endif
+static uint32_t pdsNvmCrc32(uint32_t crc, uint8_t *data, uint16_t length);
+static uint32_t Crc32Bytes(uint32_t crc, uint8_t *data, uint16_t length);
 static uint32_t nvmLogicalRowToPhysicalAddr(uint16_t logicalRow);
 
 /******************************************************************************
@@ -86,6 +139,11 @@ PdsStatus_t pdsNvmInit(void)
 	{
 		return PDS_NOT_ENOUGH_MEMORY;
 	}
+
+#if (PDS_CRC_ENGINE == PDS_CRC_DSU) && defined(DSU)
+	/* The DSU is write protected after reset */
+	PAC->WRCTRL.reg = PAC_WRCTRL_PERID(ID_DSU) | PAC_WRCTRL_KEY_CLR;
+#endif
 	
 	return status;
 }
@@ -103,9 +161,9 @@ PdsStatus_t pdsNvmInit(void)
 PdsStatus_t pdsNvmWrite(uint16_t rowId, PdsMem_t *buffer, uint16_t size)
 {
 	PdsStatus_t status = PDS_OK;
-	buffer->NVM_Struct.pdsNvmHeader.version = PDS_NVM_VERSION;
+	buffer->NVM_Struct.pdsNvmHeader.version = PDS_NVM_WRITE_VERSION;
 	buffer->NVM_Struct.pdsNvmHeader.size = size;
-	buffer->NVM_Struct.pdsNvmHeader.crc = calculate_crc(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)(&(buffer->NVM_Struct.pdsNvmData)));
+	buffer->NVM_Struct.pdsNvmHeader.crc = calculate_crc(PDS_NVM_WRITE_VERSION, buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)(&(buffer->NVM_Struct.pdsNvmData)));
 	//buffer->NVM_Struct.pdsNvmHeader.size = size;
 	size += sizeof(PdsNvmHeader_t);
 	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId);
@@ -122,7 +180,8 @@ PdsStatus_t pdsNvmWrite(uint16_t rowId, PdsMem_t *buffer, uint16_t size)
 }
 
 /**************************************************************************//**
-\brief	This function will read the contents of NVM and verify the crc.
+\brief	This function will read the contents of NVM and verify the crc of the
+		engine the version of the header tells.
 
 \param[in] 	pdsFileItemIdx - The file id to be read.
 \param[in] 	buffer - The buffer containing data to be read.
@@ -158,7 +217,13 @@ PdsStatus_t pdsNvmRead(uint16_t rowId, PdsMem_t *buffer, uint16_t size)
 	}
 	crc = buffer->NVM_Struct.pdsNvmHeader.crc;
 	
-	if (crc != calculate_crc(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)&(buffer->NVM_Struct.pdsNvmData))) 
+	/* Erased and unknown rows are not worth a CRC */
+	if ((PDS_NVM_VERSION != buffer->NVM_Struct.pdsNvmHeader.version) &&
+		(PDS_NVM_VERSION_CRC32 != buffer->NVM_Struct.pdsNvmHeader.version))
+	{
+		return PDS_CRC_ERROR;
+	}
+	if (crc != calculate_crc(buffer->NVM_Struct.pdsNvmHeader.version, buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)&(buffer->NVM_Struct.pdsNvmData))) 
 	{
 		return PDS_CRC_ERROR;
 	}
@@ -209,6 +274,103 @@ PdsStatus_t pdsNvmEraseAll(void)
 	return PDS_OK;
 }
 
+/**************************************************************************//**
+\brief	Programs data into the erased part of a row, without erasing it. Only
+		the pages the data falls into are programmed; the bytes of a page
+		outside the data are programmed as 0xFF and keep their content.
+
+\param[in] 	rowId - The row to be programmed.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	data - The data to be programmed.
+\param[in] 	size - The size of the data.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsNvmProgram(uint16_t rowId, uint16_t offset, uint8_t *data, uint16_t size)
+{
+	uint8_t page[EEPROM_PAGE_SIZE];
+	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId) + offset;
+	enum status_code statusCode;
+
+	if ((uint32_t)offset + size > EEPROM_ROW_SIZE)
+	{
+		return PDS_ERROR;
+	}
+
+	while (size)
+	{
+		uint32_t pageAddr = addr & ~((uint32_t)EEPROM_PAGE_SIZE - 1);
+		uint16_t pageOffset = (uint16_t)(addr - pageAddr);
+		uint16_t chunk = EEPROM_PAGE_SIZE - pageOffset;
+
+		if (chunk > size)
+		{
+			chunk = size;
+		}
+		memset(page, UCHAR_MAX, EEPROM_PAGE_SIZE);
+		memcpy(&page[pageOffset], data, chunk);
+		do
+		{
+			statusCode = nvm_write_buffer(pageAddr, page, EEPROM_PAGE_SIZE);
+		} while (statusCode == STATUS_BUSY);
+
+		if (STATUS_OK != statusCode)
+		{
+			return PDS_ERROR;
+		}
+		addr += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Reads bytes of a row as they are, without a PDS header or CRC check.
+
+\param[in] 	rowId - The row to be read.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	data - The buffer for the data read.
+\param[in] 	size - The number of bytes to read.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsNvmReadBytes(uint16_t rowId, uint16_t offset, uint8_t *data, uint16_t size)
+{
+	status_code_t statusCode;
+	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId) + offset;
+
+	do
+	{
+		statusCode = nvm_read(INT_FLASH, addr, data, size);
+	} while ((status_code_genare_t) statusCode == STATUS_BUSY);
+
+	return (STATUS_OK == (status_code_genare_t) statusCode) ? PDS_OK : PDS_ERROR;
+}
+
+/**************************************************************************//**
+\brief	Continues a CRC in CCITT polynome over the given data.
+
+\param[in] 	crc - The CRC so far, 0 to start.
+\param[in] 	data - The data.
+\param[in] 	length - The amount of data.
+\param[out] uint16_t - The calculated 16 bit CRC.
+******************************************************************************/
+uint16_t pdsNvmCrc(uint16_t crc, uint8_t *data, uint16_t length)
+{
+#if (PDS_CRC_ENGINE == PDS_CRC_TABLE)
+	for (uint16_t i = 0; i < length; i++)
+	{
+		crc = (crc >> 8) ^ crc16Table[(uint8_t)crc ^ data[i]];
+	}
+#else
+	for (uint16_t i = 0; i < length; i++)
+	{
+		crc = Crc16Ccitt(crc, data[i]);
+	}
+#endif
+	return crc;
+}
+
+#if (PDS_CRC_ENGINE != PDS_CRC_TABLE)
 /**************************************************************************//**
 \brief	Calculates the CRC in CCITT polynome.
 
@@ -224,22 +386,99 @@ uint16_t Crc16Ccitt(uint16_t initValue, uint8_t byte)
   return ((((uint16_t)byte << 8) | ((initValue & 0xff00U) >> 8))
           ^ (uint8_t)(byte >> 4) ^ ((uint16_t)byte << 3));
 }
+#endif
+
+/**************************************************************************//**
+\brief	Continues a CRC-32 over the given data, with the DSU if available.
+		The DSU reads whole words at aligned addresses, the bytes around
+		them are done in software.
+
+\param[in] 	crc - The CRC so far, PDS_CRC32_INIT to start.
+\param[in] 	data - The data.
+\param[in] 	length - The amount of data.
+\param[out] uint32_t - The calculated 32 bit CRC.
+******************************************************************************/
+static uint32_t pdsNvmCrc32(uint32_t crc, uint8_t *data, uint16_t length)
+{
+#if (PDS_CRC_ENGINE == PDS_CRC_DSU) && defined(DSU)
+	uint16_t head = (uint16_t)((4U - ((uint32_t)data & 3U)) & 3U);
+	uint16_t words;
+
+	if (head > length)
+	{
+		head = length;
+	}
+	crc = Crc32Bytes(crc, data, head);
+	data += head;
+	length -= head;
+
+	words = length & ~3U;
+	if (words)
+	{
+		DSU->STATUSA.reg = DSU_STATUSA_DONE | DSU_STATUSA_BERR;
+		DSU->ADDR.reg = (uint32_t)data & DSU_ADDR_ADDR_Msk;
+		DSU->LENGTH.reg = DSU_LENGTH_LENGTH(words / 4U);
+		DSU->DATA.reg = crc;
+		DSU->CTRL.reg = DSU_CTRL_CRC;
+		while (!(DSU->STATUSA.reg & DSU_STATUSA_DONE))
+		{
+		}
+		/* A bus error leaves the words to the software */
+		if (DSU->STATUSA.reg & DSU_STATUSA_BERR)
+		{
+			crc = Crc32Bytes(crc, data, words);
+		}
+		else
+		{
+			crc = DSU->DATA.reg;
+		}
+		data += words;
+		length -= words;
+	}
+#endif
+	return Crc32Bytes(crc, data, length);
+}
 
 /**************************************************************************//**
-\brief	Calculates the CRC.
+\brief	Continues a CRC-32 in software, bit by bit.
 
+\param[in] 	crc - The CRC so far.
+\param[in] 	data - The data.
+\param[in] 	length - The amount of data.
+\param[out] uint32_t - The calculated 32 bit CRC.
+******************************************************************************/
+static uint32_t Crc32Bytes(uint32_t crc, uint8_t *data, uint16_t length)
+{
+	for (uint16_t i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8U; bit++)
+		{
+			crc = (crc >> 1) ^ (PDS_CRC32_POLYNOME & (0U - (crc & 1U)));
+		}
+	}
+	return crc;
+}
+
+/**************************************************************************//**
+\brief	Calculates the CRC of a row. Rows of PDS_NVM_VERSION carry a CRC-16,
+		rows of PDS_NVM_VERSION_CRC32 a CRC-32 folded into the 16 bits of the
+		header.
+
+\param[in] 	version - The version of the header of the row.
 \param[in] 	length - The amount of data for which CRC is to be calculated.
 \param[in] 	data - The data.
 \param[out] uint16_t - The calculated 16 bit CRC.
 ******************************************************************************/
-static uint16_t calculate_crc(uint16_t length, uint8_t *data)
+static uint16_t calculate_crc(uint8_t version, uint16_t length, uint8_t *data)
 {
-  uint16_t eeprom_crc = 0U;
-  for (uint16_t i = 0; i < length; i++)
+  if (PDS_NVM_VERSION_CRC32 == version)
   {
-    eeprom_crc = Crc16Ccitt(eeprom_crc, data[i]);
+    uint32_t crc = pdsNvmCrc32(PDS_CRC32_INIT, data, length);
+
+    return (uint16_t)(crc ^ (crc >> 16));
   }
-  return eeprom_crc;
+  return pdsNvmCrc(0U, data, length);
 }
 
 /**************************************************************************//**
@@ -44,6 +44,7 @@
 #include "conf_sw_timer.h"
 #include "common_hw_timer.h"
 #include "sw_timer.h"
+#include "system_trace.h"
 
 #ifndef TOTAL_NUMBER_SW_TIMESTAMPS
 #define TOTAL_NUMBER_SW_TIMESTAMPS (2u)
@@ -62,7 +63,15 @@ static void swtimerProcessOverflow(void);
 static void swtimerInternalHandler(void);
 static inline bool swtimerCompareTime(uint32_t t1, uint32_t t2);
 static void swtimerStartAbsoluteTimer(uint8_t timer_id,
-    uint32_t point_in_time, void * handler_cb, void *parameter);
+    uint32_t point_in_time, uint32_t latest_time, void * handler_cb, void *parameter);
+static uint32_t swtimerRemainingTime(uint32_t expiryTime);
+static inline uint8_t swtimerHead(void);
+static inline bool swtimerBefore(uint8_t timerA, uint8_t timerB);
+static inline void swtimerHeapPlace(uint8_t position, uint8_t timerId);
+static void swtimerSiftUp(uint8_t position);
+static void swtimerSiftDown(uint8_t position);
+static void swtimerHeapRemove(uint8_t position);
+static void swtimerHeadChanged(uint8_t oldHead);
 
 /******************************************************************************
                      Global variables section
@@ -101,8 +110,17 @@ SwTimestamp_t swTimestamp[TOTAL_NUMBER_SW_TIMESTAMPS];
 /* This is the counter of all running timers. */
 static volatile uint8_t runningTimers;
 
-/* This is the reference to the head of the running timer queue. */
-static uint_fast8_t runningTimerQueueHead;
+/*
+* This is the binary min-heap of running timers, ordered by the latest
+* expiry time. The head of the running timers is timerHeap[0].
+*/
+static uint8_t timerHeap[TOTAL_NUMBER_OF_SW_TIMERS];
+
+/* This is the start order given to the next started timer. */
+static uint16_t timerSequence;
+
+/* These are the expiry counters of the module. */
+static SwTimerStats_t timerStats;
 
 /* This is the reference to the head of the expired timer queue. */
 static uint_fast8_t expiredTimerQueueHead;
@@ -119,6 +137,14 @@ static uint8_t allocatedTimestampId = 0;
 /* This is the last known system time saved before sleep */
 static uint64_t sysTimeLastKnown = 0;
 
+/*
+* This is the part of the system time below the TC0_COUNT overflow when the
+* system timer was resumed after sleep, the restarted TC0_COUNT is added to it.
+* The timers expire in terms of TC0_COUNT, so their expiry times are
+* compared to TC0_COUNT without it.
+*/
+static uint16_t sysTimePhase = 0;
+
 /******************************************************************************
                      Interrupt service routines
 ******************************************************************************/
@@ -149,94 +175,170 @@ static void hwTimerExpiryCallback(void)
 ******************************************************************************/
 
 /**************************************************************************//**
-\brief Inserts the timer in running timers queue in sorted order
+\brief Returns the running timer which has to be served first
+\return Timer identifier, SWTIMER_INVALID if no timer is running
 ******************************************************************************/
-static void swtimerStartAbsoluteTimer(uint8_t timerId, uint32_t pointInTime,
-    void *handlerCb, void *parameter)
+static inline uint8_t swtimerHead(void)
 {
-    uint8_t flags = cpu_irq_save();
-
-    /* Check is done to see if any timer has expired */
-    swtimerInternalHandler();
+    return (0u < runningTimers) ? timerHeap[0] : SWTIMER_INVALID;
+}
 
-    swTimers[timerId].absoluteExpiryTime = pointInTime;
-    swTimers[timerId].timerCb = (void (*)(void*))handlerCb;
-    swTimers[timerId].paramCb = parameter;
-    swTimers[timerId].loaded = false;
-    runningTimers++;
+/**************************************************************************//**
+\brief Orders two running timers by latest expiry time, then by start order
+\return True if timerA has to be served before timerB
+******************************************************************************/
+static inline bool swtimerBefore(uint8_t timerA, uint8_t timerB)
+{
+    int32_t diff = (int32_t)(swTimers[timerA].latestExpiryTime - swTimers[timerB].latestExpiryTime);
 
-    if (SWTIMER_INVALID == runningTimerQueueHead)
+    if (0 != diff)
     {
-        runningTimerQueueHead = timerId;
-        loadHwTimer(runningTimerQueueHead);
+        return (diff < 0);
     }
-    else
+
+    return ((int16_t)(swTimers[timerA].sequence - swTimers[timerB].sequence) < 0);
+}
+
+/**************************************************************************//**
+\brief Stores a timer at the given position of the heap
+******************************************************************************/
+static inline void swtimerHeapPlace(uint8_t position, uint8_t timerId)
+{
+    timerHeap[position] = timerId;
+    swTimers[timerId].heapIndex = position;
+}
+
+/**************************************************************************//**
+\brief Moves the timer at the given position towards the head of the heap
+******************************************************************************/
+static void swtimerSiftUp(uint8_t position)
+{
+    uint8_t timerId = timerHeap[position];
+
+    while (0u < position)
     {
-        uint8_t index;
-        bool isTimerInserted = false;
-        uint8_t currIndex = runningTimerQueueHead;
-        uint8_t prevIndex = runningTimerQueueHead;
+        uint8_t parent = (uint8_t)((position - 1u) >> 1);
 
-        /*
-        * Loop through the running timers in the array of swTimers.
-        * Find the correct position for timer identified by 'timerId'
-        * to be inserted in the runningTimersQueue.
-        */
-        for (index = 0; index < runningTimers; index++)
+        if (!swtimerBefore(timerId, timerHeap[parent]))
         {
-            if (SWTIMER_INVALID != currIndex)
-            {
-                if (swtimerCompareTime(swTimers[currIndex].absoluteExpiryTime,
-                                       pointInTime))
-                {
-                    /*
-                    * Requested absolute time value is greater than the time
-                    * value pointed by the curr_index in the timer array
-                    */
-                    prevIndex = currIndex;
-                    currIndex = swTimers[currIndex].nextTimer;
-                }
-                else
-                {
-                /*
-                * New timer 'timerId' to be inserted is having expiryDuration
-                * that is lesser than the timer pointed by 'currentIndex'.
-                */
-                    swTimers[timerId].nextTimer = currIndex;
-                    swTimers[currIndex].loaded = false;
-                    if (runningTimerQueueHead == currIndex)
-                    {
-                        /* Insertion at the head of the timer queue. */
-                        runningTimerQueueHead = timerId;
+            break;
+        }
+        swtimerHeapPlace(position, timerHeap[parent]);
+        position = parent;
+    }
+    swtimerHeapPlace(position, timerId);
+}
 
-                        loadHwTimer(runningTimerQueueHead);
-                    }
-                    else
-                    {
-                    /* Insertion at somewhere in the middle of timer queue. */
-                        swTimers[prevIndex].nextTimer = timerId;
-                    }
+/**************************************************************************//**
+\brief Moves the timer at the given position away from the head of the heap
+******************************************************************************/
+static void swtimerSiftDown(uint8_t position)
+{
+    uint8_t timerId = timerHeap[position];
 
-                    isTimerInserted = true;
-                    break;
-                }
-            }
+    for (;;)
+    {
+        uint8_t child = (uint8_t)((position << 1) + 1u);
+
+        if (child >= runningTimers)
+        {
+            break;
         }
+        if (((child + 1u) < runningTimers) && swtimerBefore(timerHeap[child + 1u], timerHeap[child]))
+        {
+            child++;
+        }
+        if (!swtimerBefore(timerHeap[child], timerId))
+        {
+            break;
+        }
+        swtimerHeapPlace(position, timerHeap[child]);
+        position = child;
+    }
+    swtimerHeapPlace(position, timerId);
+}
+
+/**************************************************************************//**
+\brief Takes the timer at the given position out of the heap
+******************************************************************************/
+static void swtimerHeapRemove(uint8_t position)
+{
+    uint8_t lastTimer;
+
+    runningTimers--;
+    if (position == runningTimers)
+    {
+        return;
+    }
+
+    /* The last timer fills the hole and is moved to its place */
+    lastTimer = timerHeap[runningTimers];
+    swtimerHeapPlace(position, lastTimer);
+    if ((0u < position) && swtimerBefore(lastTimer, timerHeap[(position - 1u) >> 1]))
+    {
+        swtimerSiftUp(position);
+    }
+    else
+    {
+        swtimerSiftDown(position);
+    }
+}
 
-        if (!isTimerInserted)
+/**************************************************************************//**
+\brief Reloads the hardware timer if the head of the running timers changed
+\param[in] oldHead Head of the running timers before the change
+******************************************************************************/
+static void swtimerHeadChanged(uint8_t oldHead)
+{
+    uint8_t newHead = swtimerHead();
+
+    if (newHead != oldHead)
+    {
+        if (SWTIMER_INVALID != oldHead)
         {
-            /* Insertion at the tail of the timer queue. */
-            swTimers[prevIndex].nextTimer = timerId;
-            swTimers[timerId].nextTimer = SWTIMER_INVALID;
+            swTimers[oldHead].loaded = false;
         }
+        common_tc_compare_stop();
+        loadHwTimer(newHead);
     }
+}
+
+/**************************************************************************//**
+\brief Inserts the timer in the heap of running timers
+******************************************************************************/
+static void swtimerStartAbsoluteTimer(uint8_t timerId, uint32_t pointInTime,
+    uint32_t latestTime, void *handlerCb, void *parameter)
+{
+    uint8_t flags = cpu_irq_save();
+    uint8_t oldHead;
+
+    /* Check is done to see if any timer has expired */
+    swtimerInternalHandler();
+
+    oldHead = swtimerHead();
+
+    swTimers[timerId].absoluteExpiryTime = pointInTime;
+    swTimers[timerId].latestExpiryTime = latestTime;
+    swTimers[timerId].timerCb = (void (*)(void*))handlerCb;
+    swTimers[timerId].paramCb = parameter;
+    swTimers[timerId].loaded = false;
+    swTimers[timerId].sequence = timerSequence++;
+
+    /* The new timer climbs at most log2(runningTimers) levels */
+    timerHeap[runningTimers] = timerId;
+    runningTimers++;
+    swtimerSiftUp(runningTimers - 1u);
+
+    swtimerHeadChanged(oldHead);
 
     cpu_irq_restore(flags);
 }
 
 /**************************************************************************//**
 \brief Sets the timer compare value for the given timer, if it is
-       within the overflow limit, else it will not load compare
+       within the overflow limit, else it will not load compare.
+       The compare is set for the latest expiry time, a timer already past
+       its expiry time is served right away instead.
 ******************************************************************************/
 static void loadHwTimer(uint8_t timerId)
 {
@@ -254,8 +356,11 @@ static void loadHwTimer(uint8_t timerId)
                 {
                     isTimerTriggered = true;
                     SYSTEM_PostTask(TIMER_TASK_ID);
+                    return;
                 }
-                else  if ((uint32_t)TIMER_PERIOD >= timeDiff)
+
+                timeDiff = swTimers[timerId].latestExpiryTime - now;
+                if ((uint32_t)TIMER_PERIOD >= timeDiff)
                 {
                     common_tc_delay((uint16_t)timeDiff);
                     swTimers[timerId].loaded = true;
@@ -301,7 +406,7 @@ static inline uint64_t gettime(void)
     time |= ((uint64_t) sysTimeOvf) << 32;
     time |= ((uint64_t) sysTime) << 16;
     time |= (uint64_t) common_tc_read_count();
-    return time;
+    return time + sysTimePhase;
 }
 
 /**************************************************************************//**
@@ -313,9 +418,9 @@ static void swtimerProcessOverflow(void)
     uint16_t tmoHigh16, tmoLow16;
     uint8_t flags = cpu_irq_save();
 
-    if (SWTIMER_INVALID != runningTimerQueueHead && !swTimers[runningTimerQueueHead].loaded)
+    if (SWTIMER_INVALID != swtimerHead() && !swTimers[swtimerHead()].loaded)
     {
-        tmo32 = swTimers[runningTimerQueueHead].absoluteExpiryTime;
+        tmo32 = swTimers[swtimerHead()].latestExpiryTime - sysTimePhase;
         tmoHigh16 = (uint16_t)(tmo32 >> SWTIMER_SYSTIME_SHIFTMASK);
 
         if (tmoHigh16 == sysTime)
@@ -324,7 +429,7 @@ static void swtimerProcessOverflow(void)
             if (SWTIMER_MIN_TIMEOUT < tmoLow16)
             {
                 common_tc_delay(tmoLow16);
-                swTimers[runningTimerQueueHead].loaded = true;
+                swTimers[swtimerHead()].loaded = true;
             }
             else
             {
@@ -348,31 +453,47 @@ static void swtimerInternalHandler(void)
 
         if (0 < runningTimers)
         { /* Holds the number of running timers */
+            uint8_t expiredTimer = timerHeap[0];
+
+            timerStats.expiredTimers++;
+            if (0u != swTimers[expiredTimer].slack)
+            {
+                uint32_t now = (uint32_t)gettime();
+                uint32_t latestTime = swTimers[expiredTimer].latestExpiryTime;
+
+                /* Served before it would have needed a wakeup of its own */
+                if (swtimerCompareTime(now, latestTime) && (SWTIMER_MIN_TIMEOUT < (latestTime - now)))
+                {
+                    timerStats.coalescedTimers++;
+                }
+            }
+
             if ((expiredTimerQueueHead == SWTIMER_INVALID) && \
                 (expiredTimerQueueTail == SWTIMER_INVALID))
             { /* in case of this is the only timer that has expired so far */
-                expiredTimerQueueHead = runningTimerQueueHead;
-                expiredTimerQueueTail = runningTimerQueueHead;
+                expiredTimerQueueHead = expiredTimer;
             }
             else
             { /* there were already some timers expired before this one */
-                swTimers[expiredTimerQueueTail].nextTimer = runningTimerQueueHead;
-                expiredTimerQueueTail = runningTimerQueueHead;
+                swTimers[expiredTimerQueueTail].nextTimer = expiredTimer;
             }
-
-            runningTimerQueueHead = swTimers[runningTimerQueueHead].nextTimer;
-
+            expiredTimerQueueTail = expiredTimer;
             swTimers[expiredTimerQueueTail].nextTimer = SWTIMER_INVALID;
 
-            if ((--runningTimers) > 0)
-            { /* keep the ball rolling! load the next head timer from the queue */
-                loadHwTimer(runningTimerQueueHead);
+            swtimerHeapRemove(0u);
+            swTimers[expiredTimer].heapIndex = SWTIMER_INVALID;
+
+            if (runningTimers > 0)
+            { /*
+              * keep the ball rolling! load the next head timer from the heap,
+              * it is served right away if its expiry time has passed already
+              */
+                loadHwTimer(swtimerHead());
             }
         }
     }
 }
 
-
 /**************************************************************************//**
 \brief Handler for the timer tasks
 \return SYSTEM_TASK_SUCCESS after servicing the timer triggers
@@ -396,16 +517,20 @@ void SwTimerReset(void)
     runningTimers = 0u;
     isTimerTriggered = false;
 
-    runningTimerQueueHead = SWTIMER_INVALID;
+    timerSequence = 0u;
     expiredTimerQueueHead = SWTIMER_INVALID;
     expiredTimerQueueTail = SWTIMER_INVALID;
 
     for (index = 0; index < TOTAL_NUMBER_OF_SW_TIMERS; index++)
     {
         swTimers[index].nextTimer = SWTIMER_INVALID;
+        swTimers[index].heapIndex = SWTIMER_INVALID;
         swTimers[index].timerCb = NULL;
+        swTimers[index].slack = 0u;
     }
 
+    memset(&timerStats, 0, sizeof(timerStats));
+
     allocatedTimerId = 0u;
 }
 
@@ -419,6 +544,7 @@ void SystemTimerInit(void)
     /* initialize system time parameters */
     sysTimeOvf = 0x00000000;
     sysTime = 0x0000;
+    sysTimePhase = 0x0000;
 
     common_tc_init();
     set_common_tc_overflow_callback(hwTimerOverflowCallback);
@@ -488,6 +614,7 @@ StackRetStatus_t SwTimerStart(uint8_t timerId, uint32_t timerCount,
 {
     uint32_t now = 0;
     uint32_t pointInTime;
+    uint32_t slack;
 
     if (TOTAL_NUMBER_OF_SW_TIMERS <= timerId || NULL == timerCb)
     {
@@ -545,7 +672,39 @@ StackRetStatus_t SwTimerStart(uint8_t timerId, uint32_t timerCount,
         }
     }
 
-    swtimerStartAbsoluteTimer(timerId, pointInTime, timerCb, paramCb);
+    /* The latest expiry time stays within the largest timeout */
+    slack = swTimers[timerId].slack;
+    if (slack > (SWTIMER_MAX_TIMEOUT - SUB_TIME(pointInTime, now)))
+    {
+        slack = SWTIMER_MAX_TIMEOUT - SUB_TIME(pointInTime, now);
+    }
+
+    swtimerStartAbsoluteTimer(timerId, pointInTime, ADD_TIME(pointInTime, slack), timerCb, paramCb);
+    return LORAWAN_SUCCESS;
+}
+
+/**************************************************************************//**
+\brief Sets the slack of a timer
+
+       The timer may expire up to \slack microseconds after its timeout, so
+       that it is served together with another timer instead of waking the
+       MCU on its own. The slack applies from the next start of the timer
+       and stays until it is set again.
+
+\param[in] timerId Timer identifier
+\param[in] slack Tolerated delay in microseconds, 0 for an exact expiry
+
+\return LORAWAN_INVALID_PARAMETER if at least one input parameter in invalid
+        LORAWAN_SUCCESS if the slack is set
+******************************************************************************/
+StackRetStatus_t SwTimerSetSlack(uint8_t timerId, uint32_t slack)
+{
+    if ((TOTAL_NUMBER_OF_SW_TIMERS <= timerId) || (SWTIMER_MAX_TIMEOUT < slack))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    swTimers[timerId].slack = slack;
     return LORAWAN_SUCCESS;
 }
 
@@ -572,41 +731,54 @@ bool SwTimerIsRunning(uint8_t timerId)
 uint32_t SwTimerReadValue(uint8_t timerId)
 {
     uint32_t remainingTime = 0u;
-    uint32_t timerExpiryTime = 0u;
-    uint32_t currentSysTime = 0u;
+
     if ( NULL != swTimers[timerId].timerCb )
     {
-	    timerExpiryTime = swTimers[timerId].absoluteExpiryTime;
-	    currentSysTime = (uint32_t) gettime();
-	    if ( currentSysTime <= timerExpiryTime )
-	    {
-		    remainingTime = timerExpiryTime - currentSysTime;
-	    }
-	    else if ( currentSysTime > timerExpiryTime )
-	    {
-		    remainingTime = (UINT32_MAX - currentSysTime) + timerExpiryTime;
-	    }
-
-        if (remainingTime >= SWTIMER_MAX_TIMEOUT)
-        {
-            /* Diff cannot be more than max timeout */
-            remainingTime = 0;
-        }
+        remainingTime = swtimerRemainingTime(swTimers[timerId].absoluteExpiryTime);
+    }
+    return remainingTime;
+}
+
+/**************************************************************************//**
+\brief Returns the time left until the given point in time
+\param[in] expiryTime Point in time in microseconds
+\return Remaining time in microseconds, 0 if it has passed
+******************************************************************************/
+static uint32_t swtimerRemainingTime(uint32_t expiryTime)
+{
+    uint32_t remainingTime = 0u;
+    uint32_t currentSysTime = (uint32_t) gettime();
+
+    if ( currentSysTime <= expiryTime )
+    {
+        remainingTime = expiryTime - currentSysTime;
+    }
+    else if ( currentSysTime > expiryTime )
+    {
+        remainingTime = (UINT32_MAX - currentSysTime) + expiryTime;
+    }
+
+    if (remainingTime >= SWTIMER_MAX_TIMEOUT)
+    {
+        /* Diff cannot be more than max timeout */
+        remainingTime = 0;
     }
     return remainingTime;
 }
 
 /**************************************************************************//**
 \brief Returns the duration until the next timer expiry
-\return Returns the duration until the next timeout in microseconds
+\return Returns the duration until the next timeout in microseconds. A timer
+        with slack is due at its latest expiry time, the timers expiring
+        before then are served along with it.
 ******************************************************************************/
 uint32_t SwTimerNextExpiryDuration(void)
 {
     uint32_t duration = SWTIMER_INVALID_TIMEOUT;
 
-    if (SWTIMER_INVALID != runningTimerQueueHead)
+    if (SWTIMER_INVALID != swtimerHead())
     {
-        duration = SwTimerReadValue(runningTimerQueueHead);
+        duration = swtimerRemainingTime(swTimers[swtimerHead()].latestExpiryTime);
     }
 
     return duration;
@@ -618,11 +790,11 @@ uint32_t SwTimerNextExpiryDuration(void)
 ******************************************************************************/
 void SwTimerRunRemainingTime(uint32_t offset)
 {
-    void * timerCb = (void*)(swTimers[runningTimerQueueHead].timerCb);
-    void *paramCb = swTimers[runningTimerQueueHead].paramCb;
-    uint8_t timerId = runningTimerQueueHead;
+    void * timerCb = (void*)(swTimers[swtimerHead()].timerCb);
+    void *paramCb = swTimers[swtimerHead()].paramCb;
+    uint8_t timerId = swtimerHead();
 
-    if (LORAWAN_SUCCESS == SwTimerStop(runningTimerQueueHead))
+    if (LORAWAN_SUCCESS == SwTimerStop(swtimerHead()))
     {
         SwTimerStart(timerId, offset, SW_TIMEOUT_RELATIVE, timerCb, paramCb);
     }
@@ -634,10 +806,25 @@ void SwTimerRunRemainingTime(uint32_t offset)
 void SwTimersExecute(void)
 {
     uint64_t now = gettime();
+    uint8_t flags;
+    bool batched;
 
-    uint8_t flags = cpu_irq_save();
-    swtimerInternalHandler();
-    cpu_irq_restore(flags);
+    /*
+    * Timers which are due together with the expired one are moved to the
+    * expired timer queue now, each in its own short critical section,
+    * instead of going through one more timer task each.
+    */
+    do
+    {
+        flags = cpu_irq_save();
+        swtimerInternalHandler();
+        batched = isTimerTriggered;
+        if (batched)
+        {
+            SYSTEM_ClearTask(TIMER_TASK_ID);
+        }
+        cpu_irq_restore(flags);
+    } while (batched);
 
     /*
     * Process expired timers.
@@ -662,6 +849,8 @@ void SwTimersExecute(void)
             /* Callback parameter is stored */
             cbParam = swTimers[expiredTimerQueueHead].paramCb;
 
+            SYSTEM_TRACE_EVENT(SYSTEM_TRACE_TIMER_EXPIRY, expiredTimerQueueHead, 0, (uintptr_t)callback);
+
             /*
             * The expired timer's structure elements are updated
             * and the timer is taken out of expired timer queue
@@ -719,53 +908,27 @@ StackRetStatus_t SwTimerStop(uint8_t timerId)
     /* Check if any timer has expired. */
     swtimerInternalHandler();
 
-    /* The requested timer is first searched in the running timer queue */
-    if (runningTimers > 0)
+    /* A running timer is taken out of the heap at its known position */
+    if ((runningTimers > 0) && (NULL != swTimers[timerId].timerCb))
     {
-        uint8_t timer_count = runningTimers;
-        prevIndex = currIndex = runningTimerQueueHead;
-        while (timer_count > 0)
-        {
-            if (timerId == currIndex)
-            {
-                timerStopReqStatus = true;
-                if (timerId == runningTimerQueueHead)
-                {
-                    common_tc_compare_stop();
-                    runningTimerQueueHead = swTimers[timerId].nextTimer;
+        uint8_t position = swTimers[timerId].heapIndex;
 
-                    /*
-                    * The value in OVF corresponds to the timeout pointed
-                    * by the 'running_timer_queue_head'. As the head has
-                    * changed here, OVF needs to be loaded by the new
-                    * timeout value, if any.
-                    */
-                    loadHwTimer(runningTimerQueueHead);
-                }
-                else
-                {
-                    swTimers[prevIndex].nextTimer = swTimers[timerId].nextTimer;
-                }
+        if ((position < runningTimers) && (timerHeap[position] == timerId))
+        {
+            uint8_t oldHead = swtimerHead();
 
+            timerStopReqStatus = true;
+            swtimerHeapRemove(position);
+            swTimers[timerId].heapIndex = SWTIMER_INVALID;
+            if (timerId == oldHead)
+            {
                 /*
-                * The next timer element of the stopped timer is updated
-                * to its default value.
+                * The compare value corresponds to the timeout of the head.
+                * As the head has changed here, it needs to be loaded by the
+                * new timeout value, if any.
                 */
-                swTimers[timerId].nextTimer  = SWTIMER_INVALID;
-                break;
+                swtimerHeadChanged(oldHead);
             }
-            else
-            {
-                prevIndex = currIndex;
-                currIndex = swTimers[currIndex].nextTimer;
-            }
-
-            timer_count--;
-        }
-
-        if (timerStopReqStatus)
-        {
-            runningTimers--;
         }
     }
 
@@ -848,6 +1011,18 @@ StackRetStatus_t SwTimerStop(uint8_t timerId)
     return LORAWAN_INVALID_REQUEST;
 }
 
+/**************************************************************************//**
+\brief Reads the expiry counters of the timer module
+\param[out] stats Counters since the initialization of the module
+******************************************************************************/
+void SwTimerGetStats(SwTimerStats_t *stats)
+{
+    uint8_t flags = cpu_irq_save();
+
+    *stats = timerStats;
+    cpu_irq_restore(flags);
+}
+
 /**************************************************************************//**
 \brief Suspends the software timer
 ******************************************************************************/
@@ -863,26 +1038,15 @@ void SystemTimerSuspend(void)
 ******************************************************************************/
 void SystemTimerSync(uint64_t timeToSync)
 {
-    uint8_t timerId;
-    uint16_t adjustOffset;
-
     sysTimeLastKnown += timeToSync;
 
     /* 1. Update system time */
     sysTimeOvf = (uint32_t) (sysTimeLastKnown >> 32);
     sysTime = (uint16_t) ((sysTimeLastKnown >> SWTIMER_SYSTIME_SHIFTMASK) & 0xffff);
 
-    /* 2. Adjust expiration of running timers */
-    adjustOffset = (uint16_t) sysTimeLastKnown;
-    timerId = runningTimerQueueHead;
-    for (uint8_t index = 0; index < runningTimers; index++)
-    {
-        if (SWTIMER_INVALID != timerId)
-        {
-            swTimers[timerId].absoluteExpiryTime -= adjustOffset;
-            timerId = swTimers[timerId].nextTimer;
-        }
-    }
+    /* 2. Keep the part below TC0_COUNT, the system time goes on from the
+          time slept and the running timers keep their expiry times */
+    sysTimePhase = (uint16_t) sysTimeLastKnown;
 
     /* 3. Start hardware timer */
     common_tc_init();
@@ -890,9 +1054,10 @@ void SystemTimerSync(uint64_t timeToSync)
     set_common_tc_expiry_callback(hwTimerExpiryCallback);
 
     /* 4. Resume timer queue operations */
-    if (runningTimers && (SWTIMER_INVALID != runningTimerQueueHead))
+    if (runningTimers && (SWTIMER_INVALID != swtimerHead()))
     {
-        uint32_t remainingTime = SwTimerNextExpiryDuration();
+        /* The head is restarted for its expiry time, keeping its slack */
+        uint32_t remainingTime = SwTimerReadValue(swtimerHead());
 
         if (SWTIMER_MIN_TIMEOUT > remainingTime)
         {
@@ -41,10 +41,47 @@
 /************************************************************************/
 #include <stdbool.h>
 #include <stdint.h>
+#include "stack_common.h"
 
 /************************************************************************/
 /* Defines                                                              */
 /************************************************************************/
+/*
+* Scheduler slots of the stack layers, in the order of descending priority.
+* A layer with several subtasks owns a contiguous range of slots, so that
+* its subtasks are dispatched directly instead of through a second bitmap.
+*/
+#define SYSTEM_TIMER_TASK_IDX       0u
+#define SYSTEM_RADIO_TASK_IDX       1u
+#define SYSTEM_LORAWAN_TASK_IDX     6u
+#define SYSTEM_PDS_TASK_IDX         9u
+#define SYSTEM_APP_TASK_IDX         10u
+#define SYSTEM_FIXED_TASK_COUNT     11u
+
+/* Number of slots available to tasks registered by the application */
+#ifndef SYSTEM_APP_TASKS_MAX
+#define SYSTEM_APP_TASKS_MAX        4u
+#endif
+
+/* Number of events that can be queued across all tasks */
+#ifndef SYSTEM_EVENT_POOL_SIZE
+#define SYSTEM_EVENT_POOL_SIZE      8u
+#endif
+
+/* Enables the execution time and latency counters of each task. A
+ * diagnostic: every post then reads the system time with interrupts off. */
+#ifndef SYSTEM_TASK_STATS
+#define SYSTEM_TASK_STATS           0
+#endif
+
+#define SYSTEM_TASK_COUNT           (SYSTEM_FIXED_TASK_COUNT + SYSTEM_APP_TASKS_MAX)
+
+#if (SYSTEM_TASK_COUNT > 32u)
+#error "The scheduler supports at most 32 tasks"
+#endif
+
+/* Ready mask bit of the given task slot */
+#define SYSTEM_TASK_MASK(taskIdx)   ((SYSTEM_TaskMask_t)1u << (taskIdx))
 
 /************************************************************************/
 /* Types                                                                */
@@ -58,16 +95,45 @@ typedef enum _SYSTEM_TaskStatus_t
 } SYSTEM_TaskStatus_t;
 
 /*! The list of task IDs. The IDs are sorted according to descending
-priority. For each task ID there is the corresponding task handler function. */
+priority. For each task ID there is the corresponding task handler function.
+RADIO, LORAWAN and PDS IDs denote the first slot of the respective layer. */
 typedef enum _SYSTEM_Task_t
 {
-  TIMER_TASK_ID   = 1 << 0,
-  RADIO_TASK_ID   = 1 << 1,
-  LORAWAN_TASK_ID = 1 << 2,
-  PDS_TASK_ID     = 1 << 3,
-  APP_TASK_ID     = 1 << 4,
+  TIMER_TASK_ID   = 1 << SYSTEM_TIMER_TASK_IDX,
+  RADIO_TASK_ID   = 1 << SYSTEM_RADIO_TASK_IDX,
+  LORAWAN_TASK_ID = 1 << SYSTEM_LORAWAN_TASK_IDX,
+  PDS_TASK_ID     = 1 << SYSTEM_PDS_TASK_IDX,
+  APP_TASK_ID     = 1 << SYSTEM_APP_TASK_IDX,
 } SYSTEM_Task_t;
 
+/*! Set of task slots, one bit per slot */
+typedef uint32_t SYSTEM_TaskMask_t;
+
+/*! Task handler, runs to completion */
+typedef SYSTEM_TaskStatus_t (*SYSTEM_TaskHandler_t)(void);
+
+/*! Event queued to a task */
+typedef struct _SYSTEM_Event_t
+{
+  /* Event identifier, defined by the receiving task */
+  uint16_t id;
+  /* Payload of the event */
+  void *param;
+} SYSTEM_Event_t;
+
+/*! Run-to-completion counters of a task */
+typedef struct _SYSTEM_TaskStats_t
+{
+  /* Number of times the handler was called */
+  uint32_t runCount;
+  /* Total and longest execution time of the handler in microseconds */
+  uint32_t totalTimeUs;
+  uint32_t maxTimeUs;
+  /* Total and longest time from posting to dispatch in microseconds */
+  uint32_t totalLatencyUs;
+  uint32_t maxLatencyUs;
+} SYSTEM_TaskStats_t;
+
 /************************************************************************/
 /* Prototypes                                                           */
 /************************************************************************/
@@ -75,8 +141,9 @@ typedef enum _SYSTEM_Task_t
 \brief  This function is called by the stack or from the main()
 
 If several tasks have been posted by the moment of the function's call,
-they are executed in order of layers' priority: a task of the layer with the
-highest priority is executed first.
+they are executed in order of priority: the pending task with the
+highest priority is executed first, and the ready mask is checked again
+after every handler.
 *************************************************************************/
 void SYSTEM_RunTasks(void);
 
@@ -85,7 +152,8 @@ void SYSTEM_RunTasks(void);
        task handler of the corresponding stack layer. A task is processed
        when the SYSTEM_RunTasks() function.
 
-\param[in] task - ID of the posted task.
+\param[in] task - Mask of the posted task slots, bits of slots without
+                  a handler are ignored.
 *************************************************************************/
 /*
 IDs of the tasks are listed in the SYSTEM_Task_t enum. Each task has its
@@ -93,12 +161,78 @@ own priority and is called only if there is no any task with higher priority.
 A handler is called when respective task can be run. Each task has its
 own task handler.
 Correspondence between tasks and handlers is listed below:  \n
-RADIO RADIO_TaskHandler()
-HAL - HAL_TaskHandler()
-LORAWAN - LORAWAN_TaskHandler()
+TIMER - TIMER_TaskHandler()
+RADIO - RADIO_TxDoneHandler() ... RADIO_ScanHandler()
+LORAWAN - LORAWAN_JoinReqHandler() ... LORAWAN_RxHandler()
+PDS - PDS_TaskHandler()
 APP - APP_TaskHandler()
  */
-void SYSTEM_PostTask(SYSTEM_Task_t task);
+void SYSTEM_PostTask(SYSTEM_TaskMask_t task);
+
+/*********************************************************************//**
+\brief Withdraws posted tasks which have not been dispatched yet
+
+\param[in] task - Mask of the task slots to be cleared
+*************************************************************************/
+void SYSTEM_ClearTask(SYSTEM_TaskMask_t task);
+
+/*********************************************************************//**
+\brief Registers an application task below the APP task priority
+
+\param[in] handler - Handler of the task
+\param[in] priority - 0 for the highest application task priority, up to
+                      SYSTEM_APP_TASKS_MAX - 1
+\param[out] taskIdx - Slot of the task, for SYSTEM_TASK_MASK() and events
+
+\return LORAWAN_SUCCESS if the task is registered
+        LORAWAN_INVALID_PARAMETER if a parameter is out of range
+        LORAWAN_INVALID_REQUEST if the priority is already taken
+*************************************************************************/
+StackRetStatus_t SYSTEM_RegisterTask(SYSTEM_TaskHandler_t handler,
+    uint8_t priority, uint8_t *taskIdx);
+
+/*********************************************************************//**
+\brief Queues an event to a task and posts the task
+
+The handler receives one event per call with SYSTEM_GetEvent(), the task
+is posted again as long as events are left in its queue.
+
+\param[in] taskIdx - Slot of the receiving task
+\param[in] id - Event identifier
+\param[in] param - Payload of the event
+
+\return LORAWAN_SUCCESS if the event is queued
+        LORAWAN_INVALID_PARAMETER if the slot has no handler
+        LORAWAN_RESOURCE_UNAVAILABLE if the event pool is exhausted
+*************************************************************************/
+StackRetStatus_t SYSTEM_PostEvent(uint8_t taskIdx, uint16_t id, void *param);
+
+/*********************************************************************//**
+\brief Takes the oldest event queued to a task
+
+\param[in] taskIdx - Slot of the task
+\param[out] event - Dequeued event
+
+\return 'true' if an event was dequeued, 'false' if the queue is empty
+*************************************************************************/
+bool SYSTEM_GetEvent(uint8_t taskIdx, SYSTEM_Event_t *event);
+
+#if (SYSTEM_TASK_STATS == 1)
+/*********************************************************************//**
+\brief Reads the run-to-completion counters of a task
+
+\param[in] taskIdx - Slot of the task
+\param[out] stats - Counters of the task
+
+\return LORAWAN_SUCCESS, or LORAWAN_INVALID_PARAMETER for a bad slot
+*************************************************************************/
+StackRetStatus_t SYSTEM_GetTaskStats(uint8_t taskIdx, SYSTEM_TaskStats_t *stats);
+
+/*********************************************************************//**
+\brief Clears the run-to-completion counters of all tasks
+*************************************************************************/
+void SYSTEM_ResetTaskStats(void);
+#endif /* #if (SYSTEM_TASK_STATS == 1) */
 
 /*********************************************************************//**
 \brief Returns the readiness of the system for sleep
@@ -110,4 +244,3 @@ bool SYSTEM_ReadyToSleep(void);
 #endif /* SYSTEM_TASK_MANAGER_H */
 
 /* eof system_task_manager.h */
-
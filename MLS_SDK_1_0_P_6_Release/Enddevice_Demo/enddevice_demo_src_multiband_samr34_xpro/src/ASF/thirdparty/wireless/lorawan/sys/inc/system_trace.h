@@ -0,0 +1,155 @@
+/**
+* \file  system_trace.h
+*
+* \brief This is the interface of the LoRaWAN stack event trace
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef SYSTEM_TRACE_H
+#define SYSTEM_TRACE_H
+/************************************************************************/
+/* Includes                                                             */
+/************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************************************************************/
+/* Defines                                                              */
+/************************************************************************/
+/* Enables the event trace of the stack */
+#ifndef SYSTEM_TRACE_ENABLE
+#define SYSTEM_TRACE_ENABLE         0
+#endif
+
+/* Number of records of the trace ring, a power of two */
+#ifndef SYSTEM_TRACE_RECORDS
+#define SYSTEM_TRACE_RECORDS        128u
+#endif
+
+#if (SYSTEM_TRACE_RECORDS & (SYSTEM_TRACE_RECORDS - 1u))
+#error "SYSTEM_TRACE_RECORDS must be a power of two"
+#endif
+
+/* Header of a dump: magic, version, record size, number of records */
+#define SYSTEM_TRACE_MAGIC          0x4352544Du
+#define SYSTEM_TRACE_VERSION        1u
+
+/*
+* Records an event. The arguments are not evaluated when the trace is
+* disabled, so a trace point costs nothing in such builds.
+*/
+#if (SYSTEM_TRACE_ENABLE == 1)
+#define SYSTEM_TRACE_EVENT(event, arg0, arg1, arg2) \
+    SYSTEM_TraceEvent((event), (uint8_t)(arg0), (uint16_t)(arg1), (uint32_t)(arg2))
+#else
+#define SYSTEM_TRACE_EVENT(event, arg0, arg1, arg2) do { } while (0)
+#endif
+
+/************************************************************************/
+/* Types                                                                */
+/************************************************************************/
+
+/*! Events of the trace, the application uses SYSTEM_TRACE_APP and above */
+typedef enum _SYSTEM_TraceEventId_t
+{
+  /* arg2: upper 32 bits of the system time of the following records */
+  SYSTEM_TRACE_TIME_HIGH = 0,
+  /* Record overwritten while it was dumped */
+  SYSTEM_TRACE_LOST,
+  /* arg0: DIO line of the radio interrupt */
+  SYSTEM_TRACE_RADIO_DIO,
+  /* arg0: new MAC state, arg1: previous MAC state */
+  SYSTEM_TRACE_MAC_STATE,
+  /* arg0: software timer, arg2: callback address */
+  SYSTEM_TRACE_TIMER_EXPIRY,
+  /* arg0: PDS file, before and after it is written, arg1: status */
+  SYSTEM_TRACE_PDS_WRITE,
+  SYSTEM_TRACE_PDS_WRITE_DONE,
+  SYSTEM_TRACE_APP = 0x80
+} SYSTEM_TraceEventId_t;
+
+/*! Trace record, the time is the lower 32 bits of the system time in us */
+typedef struct _SYSTEM_TraceRecord_t
+{
+  uint32_t time;
+  uint8_t event;
+  uint8_t arg0;
+  uint16_t arg1;
+  uint32_t arg2;
+} SYSTEM_TraceRecord_t;
+
+/*! Header of a dump, followed by count records */
+typedef struct _SYSTEM_TraceDumpHeader_t
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t recordSize;
+  uint16_t count;
+  /* Sequence number of the first record */
+  uint32_t sequence;
+  /* Records overwritten before they were dumped */
+  uint32_t lost;
+} SYSTEM_TraceDumpHeader_t;
+
+/*! Output of the dump, sio2host_tx() for instance */
+typedef uint8_t (*SYSTEM_TraceWrite_t)(uint8_t *data, uint8_t length);
+
+/************************************************************************/
+/* Prototypes                                                           */
+/************************************************************************/
+#if (SYSTEM_TRACE_ENABLE == 1)
+/*********************************************************************//**
+\brief Records an event in the trace ring, overwriting the oldest record
+       when it is full. It may be called from interrupts.
+
+\param[in] event - Event identifier, SYSTEM_TraceEventId_t
+\param[in] arg0, arg1, arg2 - Arguments of the event
+*************************************************************************/
+void SYSTEM_TraceEvent(uint8_t event, uint8_t arg0, uint16_t arg1, uint32_t arg2);
+
+/*********************************************************************//**
+\brief Writes the records recorded since the last dump, at most the size
+       of the ring, as a SYSTEM_TraceDumpHeader_t and the records in
+       little endian. Nothing is written if there is no new record.
+       It must not be called from interrupts.
+
+\param[in] write - Output of the dump
+
+\return Number of records written
+*************************************************************************/
+uint16_t SYSTEM_TraceDump(SYSTEM_TraceWrite_t write);
+#endif /* #if (SYSTEM_TRACE_ENABLE == 1) */
+
+#endif /* SYSTEM_TRACE_H */
+
+/* eof system_trace.h */
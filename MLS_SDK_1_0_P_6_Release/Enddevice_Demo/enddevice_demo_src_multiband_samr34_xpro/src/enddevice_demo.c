@@ -285,7 +285,8 @@ const char * lw_status_str[] = {
     "SKEY_DERIVATION_FAILED",
     "MIC_CALCULATION_FAILED",
     "SKEY_READ_FAILED",
-    "JOIN_NONCE_ERROR"
+    "JOIN_NONCE_ERROR",
+    "UPLINK_EXPIRED"
 };
 
 //============================== GLOBAL VARIABLES ==============================
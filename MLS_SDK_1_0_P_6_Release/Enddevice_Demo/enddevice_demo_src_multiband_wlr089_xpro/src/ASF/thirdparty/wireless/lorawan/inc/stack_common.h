@@ -134,7 +134,8 @@ typedef enum _StackRetStatus
 	LORAWAN_SKEY_DERIVATION_FAILED				,
 	LORAWAN_MIC_CALCULATION_FAILED				,
 	LORAWAN_SKEY_READ_FAILED      ,
-    LORAWAN_JOIN_NONCE_ERROR
+    LORAWAN_JOIN_NONCE_ERROR                    ,
+    LORAWAN_UPLINK_EXPIRED
 } StackRetStatus_t;
 
 /* ISM Band Types*/
@@ -0,0 +1,78 @@
+/**
+* \file  lorawan_aggregation.h
+*
+* \brief LoRaWAN header file for aggregating the application records
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+#ifndef _LORAWAN_AGGREGATION_H_
+#define _LORAWAN_AGGREGATION_H_
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+
+/*********************************************************************//**
+\brief	Record aggregation - drops the aggregated records without any
+        callback and clears the counters
+
+\return					- none.
+*************************************************************************/
+void LorawanAggregationInit(void);
+
+/*********************************************************************//**
+\brief	Returns the time the open frame is queued at. The age of the open
+        frame is watched by the timer of the uplink queue.
+\return	    System time in us, UINT64_MAX if no frame is open
+*************************************************************************/
+uint64_t LorawanAggregationFlushTime(void);
+
+/*********************************************************************//**
+\brief	Queues the open frame if it is old enough, once the uplink queue is
+        empty and the duty cycle allows sending it. Called from the timer
+        of the uplink queue.
+\param[in]  now - system time in us
+\return					- none.
+*************************************************************************/
+void LorawanAggregationFlushDue(uint64_t now);
+
+/*********************************************************************//**
+\brief	Called by the uplink queue when a frame leaves the queue, frees the
+        aggregated frame it may be
+\param[in]  sendReq - send request of the frame
+\param[in]  status - status of the transaction of the frame
+\return					- none.
+*************************************************************************/
+void LorawanAggregationFrameDone(LorawanSendReq_t *sendReq, StackRetStatus_t status);
+
+#endif // _LORAWAN_AGGREGATION_H_
+
+//eof lorawan_aggregation.h
@@ -139,7 +139,7 @@ typedef enum _pds_mac_items_fid2
 #define PDS_MAC_JOIN_EUI_ADDR					((uint8_t *)&(loRa.activationParameters.joinEui))
 #define PDS_MAC_DEV_EUI_ADDR					((uint8_t *)&(loRa.activationParameters.deviceEui))
 #define PDS_MAC_LORAWAN_MAC_KEYS_ADDR			((uint8_t *)&(loRa.macKeys))
-#define PDS_MAC_FCNT_UP_ADDR					((uint8_t *)&(loRa.fCntUp.value))
+#define PDS_MAC_FCNT_UP_ADDR					((uint8_t *)&(loRa.fCntUpCeiling))
 #define PDS_MAC_DEV_NONCE_ADDR					((uint8_t *)&(loRa.devNonce))
 #define PDS_MAC_FCNT_DOWN_ADDR					((uint8_t *)&(loRa.fCntDown.value))
 #define PDS_MAC_LORAWAN_STATUS_ADDR				((uint8_t *)&(loRa.macStatus.value))
@@ -185,7 +185,7 @@ typedef enum _pds_mac_items_fid2
 #define PDS_MAC_JOIN_EUI_SIZE					sizeof(loRa.activationParameters.joinEui)
 #define PDS_MAC_DEV_EUI_SIZE					sizeof(loRa.activationParameters.deviceEui)
 #define PDS_MAC_LORAWAN_MAC_KEYS_SIZE			sizeof(loRa.macKeys)
-#define PDS_MAC_FCNT_UP_SIZE					sizeof(loRa.fCntUp.value)
+#define PDS_MAC_FCNT_UP_SIZE					sizeof(loRa.fCntUpCeiling)
 #define PDS_MAC_DEV_NONCE_SIZE					sizeof(loRa.devNonce)
 #define PDS_MAC_FCNT_DOWN_SIZE					sizeof(loRa.fCntDown.value)
 #define PDS_MAC_LORAWAN_STATUS_SIZE				sizeof(loRa.macStatus.value)
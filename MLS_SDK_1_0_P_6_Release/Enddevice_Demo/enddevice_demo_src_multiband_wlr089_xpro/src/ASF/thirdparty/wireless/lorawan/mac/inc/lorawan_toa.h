@@ -0,0 +1,125 @@
+/**
+* \file  lorawan_toa.h
+*
+* \brief LoRaWAN header file for the integer time-on-air engine
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+#ifndef _LORAWAN_TOA_H_
+#define _LORAWAN_TOA_H_
+
+/****************************** INCLUDES **************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "radio_interface.h"
+
+/***************************** TYPEDEFS ***************************************/
+
+/*********************************************************************//**
+\brief	Time-on-air constants of a LoRa spreading factor and bandwidth
+*************************************************************************/
+typedef struct _LorawanToaLoRa
+{
+    /* Symbol time is (1 << symbolShift) microseconds */
+    uint8_t symbolShift;
+    /* Payload bits per symbol block, 4 * (SF - 2 * LowDataRateOptimize) */
+    uint8_t blockBits;
+    /* LowDataRateOptimize is mandated for this SF and bandwidth */
+    bool ldro;
+} LorawanToaLoRa_t;
+
+/****************************** DEFINES ***************************************/
+
+/* FSK time per bit in microseconds, 50 kbps */
+#define LORAWAN_TOA_FSK_BIT_TIME_US     (20u)
+
+/* Largest payload length the time-on-air engine handles */
+#define LORAWAN_TOA_MAX_LENGTH          (255u)
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+
+/*********************************************************************//**
+\brief	Returns the time-on-air constants of a LoRa modulation
+\param[in]  sf - spreading factor, SF_7 to SF_12
+\param[in]  bw - bandwidth, BW_125KHZ to BW_500KHZ
+\return	    pointer to the constants, NULL if the modulation is not supported
+*************************************************************************/
+const LorawanToaLoRa_t *LorawanToaGetLoRa(RadioDataRate_t sf, RadioLoRaBandWidth_t bw);
+
+/*********************************************************************//**
+\brief	Computes the time-on-air of a LoRa packet, in integer arithmetic
+\param[in]  toa - constants of the modulation, see LorawanToaGetLoRa()
+\param[in]  sf - spreading factor of the modulation
+\param[in]  cr - coding rate, CR_4_5 to CR_4_8
+\param[in]  preambleLen - preamble length in symbols
+\param[in]  impHdrMode - packet is sent in implicit header mode
+\param[in]  crcOn - PHY CRC is appended to the packet
+\param[in]  length - payload length in bytes
+\return	    time-on-air in microseconds
+*************************************************************************/
+uint32_t LorawanToaLoRaPacket(const LorawanToaLoRa_t *toa, RadioDataRate_t sf,
+    RadioErrorCodingRate_t cr, uint16_t preambleLen, bool impHdrMode,
+    bool crcOn, uint8_t length);
+
+/*********************************************************************//**
+\brief	Computes the longest LoRa payload sent within a time-on-air
+\param[in]  toa - constants of the modulation, see LorawanToaGetLoRa()
+\param[in]  sf - spreading factor of the modulation
+\param[in]  cr - coding rate, CR_4_5 to CR_4_8
+\param[in]  preambleLen - preamble length in symbols
+\param[in]  impHdrMode - packet is sent in implicit header mode
+\param[in]  crcOn - PHY CRC is appended to the packet
+\param[in]  timeOnAir - time-on-air in microseconds
+\return	    payload length in bytes, -1 if not even an empty payload fits
+*************************************************************************/
+int16_t LorawanToaLoRaLength(const LorawanToaLoRa_t *toa, RadioDataRate_t sf,
+    RadioErrorCodingRate_t cr, uint16_t preambleLen, bool impHdrMode,
+    bool crcOn, uint32_t timeOnAir);
+
+/*********************************************************************//**
+\brief	Computes the time-on-air of a FSK packet
+\param[in]  length - payload length in bytes
+\return	    time-on-air in microseconds
+*************************************************************************/
+uint32_t LorawanToaFskPacket(uint8_t length);
+
+/*********************************************************************//**
+\brief	Computes the longest FSK payload sent within a time-on-air
+\param[in]  timeOnAir - time-on-air in microseconds
+\return	    payload length in bytes, -1 if not even an empty payload fits
+*************************************************************************/
+int16_t LorawanToaFskLength(uint32_t timeOnAir);
+
+#endif // _LORAWAN_TOA_H_
+
+//eof lorawan_toa.h
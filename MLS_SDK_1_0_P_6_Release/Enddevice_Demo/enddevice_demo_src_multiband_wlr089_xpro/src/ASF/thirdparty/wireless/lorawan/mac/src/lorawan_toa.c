@@ -0,0 +1,311 @@
+/**
+* \file  lorawan_toa.c
+*
+* \brief LoRaWAN integer time-on-air engine
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+/****************************** INCLUDES **************************************/
+#include "lorawan.h"
+#include "lorawan_toa.h"
+#include "lorawan_reg_params.h"
+
+/******************* CONSTANT DEFINITIONS *************************************/
+
+/* Symbols of the preamble added by the radio, in quarter symbols (4.25) */
+#define TOA_PREAMBLE_EXTRA_QUARTERS     (17u)
+
+/* Symbols of the explicit header block, always sent at CR 4/8 */
+#define TOA_HEADER_SYMBOLS              (8u)
+
+/* More symbol blocks than the longest payload needs */
+#define TOA_MAX_BLOCKS                  (256u)
+
+#define TOA_SF_COUNT                    (SF_12 - SF_7 + 1)
+#define TOA_BW_COUNT                    (BW_500KHZ - BW_125KHZ + 1)
+
+/*
+ * Refer: SX1276 data sheet section 4.1.1.7. Time on air
+ *
+ * Ts = 2^SF / BW is 2^(SF + 3) us at 125 kHz, so every symbol time of the
+ * LoRaWAN modulations is a power of two in microseconds and the whole packet
+ * time is computed with shifts. LowDataRateOptimize is mandated for symbol
+ * times above 16 ms.
+ */
+#define TOA_LORA(sf, bwIndex, ldro)     {(sf) + 3 - (bwIndex), 4 * ((sf) - ((ldro) ? 2 : 0)), (ldro)}
+
+static const LorawanToaLoRa_t toaLoRa[TOA_SF_COUNT][TOA_BW_COUNT] =
+{
+    /*   BW_125KHZ              BW_250KHZ                BW_500KHZ */
+    {TOA_LORA(7, 0, false),  TOA_LORA(7, 1, false),  TOA_LORA(7, 2, false)},
+    {TOA_LORA(8, 0, false),  TOA_LORA(8, 1, false),  TOA_LORA(8, 2, false)},
+    {TOA_LORA(9, 0, false),  TOA_LORA(9, 1, false),  TOA_LORA(9, 2, false)},
+    {TOA_LORA(10, 0, false), TOA_LORA(10, 1, false), TOA_LORA(10, 2, false)},
+    {TOA_LORA(11, 0, true),  TOA_LORA(11, 1, false), TOA_LORA(11, 2, false)},
+    {TOA_LORA(12, 0, true),  TOA_LORA(12, 1, true),  TOA_LORA(12, 2, false)}
+};
+
+/************************ PRIVATE FUNCTION PROTOTYPES *************************/
+
+static uint32_t loraFixedTime(const LorawanToaLoRa_t *toa, uint16_t preambleLen);
+
+static int32_t loraPayloadBits(RadioDataRate_t sf, bool impHdrMode, bool crcOn);
+
+static StackRetStatus_t getModulation(uint8_t datarate, RadioModulation_t *modulation,
+    RadioDataRate_t *sf, const LorawanToaLoRa_t **toa);
+
+/*********************** FUNCTION DEFINITIONS *********************************/
+
+/*********************************************************************//**
+\brief	Returns the time-on-air constants of a LoRa modulation
+*************************************************************************/
+const LorawanToaLoRa_t *LorawanToaGetLoRa(RadioDataRate_t sf, RadioLoRaBandWidth_t bw)
+{
+    if ((sf < SF_7) || (sf > SF_12) || (bw < BW_125KHZ) || (bw > BW_500KHZ))
+    {
+        return NULL;
+    }
+
+    return &toaLoRa[sf - SF_7][bw - BW_125KHZ];
+}
+
+/*********************************************************************//**
+\brief	Computes the time-on-air of a LoRa packet, in integer arithmetic
+*************************************************************************/
+uint32_t LorawanToaLoRaPacket(const LorawanToaLoRa_t *toa, RadioDataRate_t sf,
+    RadioErrorCodingRate_t cr, uint16_t preambleLen, bool impHdrMode,
+    bool crcOn, uint8_t length)
+{
+    int32_t bits = (8 * (int32_t)length) + loraPayloadBits(sf, impHdrMode, crcOn);
+    uint32_t blocks = 0;
+
+    /* Npayload = 8 + max(ceil(bits / (4 * (SF - 2 * DE))), 0) * (CR + 4) */
+    if (bits > 0)
+    {
+        blocks = ((uint32_t)bits + toa->blockBits - 1u) / toa->blockBits;
+    }
+
+    return loraFixedTime(toa, preambleLen) + ((blocks * ((uint32_t)cr + 4u)) << toa->symbolShift);
+}
+
+/*********************************************************************//**
+\brief	Computes the longest LoRa payload sent within a time-on-air
+*************************************************************************/
+int16_t LorawanToaLoRaLength(const LorawanToaLoRa_t *toa, RadioDataRate_t sf,
+    RadioErrorCodingRate_t cr, uint16_t preambleLen, bool impHdrMode,
+    bool crcOn, uint32_t timeOnAir)
+{
+    uint32_t fixedTime = loraFixedTime(toa, preambleLen);
+    uint32_t blocks;
+    int32_t bits;
+
+    if (timeOnAir < fixedTime)
+    {
+        return -1;
+    }
+
+    blocks = ((timeOnAir - fixedTime) >> toa->symbolShift) / ((uint32_t)cr + 4u);
+    if (blocks > TOA_MAX_BLOCKS)
+    {
+        blocks = TOA_MAX_BLOCKS;
+    }
+
+    /* Largest length with ceil(bits / blockBits) <= blocks */
+    bits = ((int32_t)blocks * toa->blockBits) - loraPayloadBits(sf, impHdrMode, crcOn);
+    if (bits < 0)
+    {
+        return -1;
+    }
+
+    bits /= 8;
+    return (int16_t)((bits > (int32_t)LORAWAN_TOA_MAX_LENGTH) ? LORAWAN_TOA_MAX_LENGTH : bits);
+}
+
+/*********************************************************************//**
+\brief	Computes the time-on-air of a FSK packet
+*************************************************************************/
+uint32_t LorawanToaFskPacket(uint8_t length)
+{
+    return (RADIO_PHY_FSK_PREAMBLE_BYTES_LENGTH + length) * 8u * LORAWAN_TOA_FSK_BIT_TIME_US;
+}
+
+/*********************************************************************//**
+\brief	Computes the longest FSK payload sent within a time-on-air
+*************************************************************************/
+int16_t LorawanToaFskLength(uint32_t timeOnAir)
+{
+    uint32_t bytes = timeOnAir / (8u * LORAWAN_TOA_FSK_BIT_TIME_US);
+
+    if (bytes < RADIO_PHY_FSK_PREAMBLE_BYTES_LENGTH)
+    {
+        return -1;
+    }
+
+    bytes -= RADIO_PHY_FSK_PREAMBLE_BYTES_LENGTH;
+    return (int16_t)((bytes > LORAWAN_TOA_MAX_LENGTH) ? LORAWAN_TOA_MAX_LENGTH : bytes);
+}
+
+/*********************************************************************//**
+\brief	Returns the time on air of a packet for a given payload length
+*************************************************************************/
+StackRetStatus_t LORAWAN_GetTimeOnAir(TimeOnAirParams_t *params, uint32_t *timeOnAir)
+{
+    RadioModulation_t modulation;
+    RadioDataRate_t sf;
+    const LorawanToaLoRa_t *toa;
+
+    if ((NULL == params) || (NULL == timeOnAir) ||
+        (LORAWAN_SUCCESS != getModulation(params->dr, &modulation, &sf, &toa)))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    if (MODULATION_LORA == modulation)
+    {
+        if ((params->cr < CR_4_5) || (params->cr > CR_4_8))
+        {
+            return LORAWAN_INVALID_PARAMETER;
+        }
+
+        *timeOnAir = LorawanToaLoRaPacket(toa, sf, (RadioErrorCodingRate_t)params->cr,
+            params->preambleLen, params->impHdrMode, params->crcOn, params->pktLen);
+    }
+    else
+    {
+        *timeOnAir = LorawanToaFskPacket(params->pktLen);
+    }
+
+    return LORAWAN_SUCCESS;
+}
+
+/*********************************************************************//**
+\brief	Returns the longest payload whose packet fits a time on air
+*************************************************************************/
+StackRetStatus_t LORAWAN_GetPayloadLengthForTimeOnAir(TimeOnAirParams_t *params,
+    uint32_t timeOnAir, uint8_t *length)
+{
+    RadioModulation_t modulation;
+    RadioDataRate_t sf;
+    const LorawanToaLoRa_t *toa;
+    int16_t maxLength;
+
+    if ((NULL == params) || (NULL == length) ||
+        (LORAWAN_SUCCESS != getModulation(params->dr, &modulation, &sf, &toa)))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    if (MODULATION_LORA == modulation)
+    {
+        if ((params->cr < CR_4_5) || (params->cr > CR_4_8))
+        {
+            return LORAWAN_INVALID_PARAMETER;
+        }
+
+        maxLength = LorawanToaLoRaLength(toa, sf, (RadioErrorCodingRate_t)params->cr,
+            params->preambleLen, params->impHdrMode, params->crcOn, timeOnAir);
+    }
+    else
+    {
+        maxLength = LorawanToaFskLength(timeOnAir);
+    }
+
+    if (maxLength < 0)
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    *length = (uint8_t)maxLength;
+    return LORAWAN_SUCCESS;
+}
+
+/*********************************************************************//**
+\brief	Time of the preamble and of the header block of a LoRa packet
+\param[in]  toa - constants of the modulation
+\param[in]  preambleLen - preamble length in symbols
+\return	    time in microseconds
+*************************************************************************/
+static uint32_t loraFixedTime(const LorawanToaLoRa_t *toa, uint16_t preambleLen)
+{
+    /* (preambleLen + 4.25) symbols, the symbol time is a multiple of 4 us */
+    return ((((uint32_t)preambleLen * 4u) + TOA_PREAMBLE_EXTRA_QUARTERS) << (toa->symbolShift - 2u)) +
+        (TOA_HEADER_SYMBOLS << toa->symbolShift);
+}
+
+/*********************************************************************//**
+\brief	Payload bits of a LoRa packet besides the payload bytes
+\param[in]  sf - spreading factor
+\param[in]  impHdrMode - packet is sent in implicit header mode
+\param[in]  crcOn - PHY CRC is appended to the packet
+\return	    -4 * SF + 28 + 16 * CRC - 20 * IH
+*************************************************************************/
+static int32_t loraPayloadBits(RadioDataRate_t sf, bool impHdrMode, bool crcOn)
+{
+    return 28 - (4 * (int32_t)sf) + (crcOn ? 16 : 0) - (impHdrMode ? 20 : 0);
+}
+
+/*********************************************************************//**
+\brief	Looks up the modulation of a data rate of the current band
+\param[in]  datarate - data rate
+\param[out] modulation - modulation of the data rate
+\param[out] sf - spreading factor of a LoRa data rate
+\param[out] toa - time-on-air constants of a LoRa data rate
+\return	    LORAWAN_SUCCESS, if the data rate is valid
+            LORAWAN_INVALID_PARAMETER, otherwise
+*************************************************************************/
+static StackRetStatus_t getModulation(uint8_t datarate, RadioModulation_t *modulation,
+    RadioDataRate_t *sf, const LorawanToaLoRa_t **toa)
+{
+    RadioLoRaBandWidth_t bw;
+
+    if (LORAWAN_SUCCESS != LORAREG_GetAttr(MODULATION_ATTR, &datarate, modulation))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    if (MODULATION_LORA != *modulation)
+    {
+        return LORAWAN_SUCCESS;
+    }
+
+    if ((LORAWAN_SUCCESS != LORAREG_GetAttr(SPREADING_FACTOR_ATTR, &datarate, sf)) ||
+        (LORAWAN_SUCCESS != LORAREG_GetAttr(BANDWIDTH_ATTR, &datarate, &bw)))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    *toa = LorawanToaGetLoRa(*sf, bw);
+    return (NULL == *toa) ? LORAWAN_INVALID_PARAMETER : LORAWAN_SUCCESS;
+}
+
+/* eof lorawan_toa.c */
@@ -56,6 +56,7 @@
 /* Other required headers */
 #include "atomic.h"
 #include "system_task_manager.h"
+#include "pds_interface.h"
 
 #ifdef CONF_PMM_ENABLE
 /************************************************************************/
@@ -109,6 +110,10 @@ PMM_Status_t PMM_Sleep(PMM_SleepReq_t *req)
             return status;
         }
 
+        /* The deferred PDS writes are done now: the RAM is lost in backup
+           mode, and their timer would cut a standby sleep short */
+        PDS_Flush();
+
         if ( SLEEP_MODE_BACKUP == req->sleep_mode )
         {
             canSleep = canSleep && ( SWTIMER_INVALID_TIMEOUT == SwTimerNextExpiryDuration() );
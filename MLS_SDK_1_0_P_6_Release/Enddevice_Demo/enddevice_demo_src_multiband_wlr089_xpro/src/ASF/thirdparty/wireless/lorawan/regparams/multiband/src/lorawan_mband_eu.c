@@ -158,7 +158,6 @@ StackRetStatus_t LORAReg_InitEU(IsmBand_t ismBand)
 	RegParams.pDrParams = &RegParams.cmnParams.paramsType2.DRParams[0];
 	RegParams.pSubBandParams = &RegParams.cmnParams.paramsType2.SubBands[0];
 	RegParams.pOtherChParams = &RegParams.cmnParams.paramsType2.othChParams[0];
-	RegParams.pDutyCycleTimer = &RegParams.cmnParams.paramsType2.DutyCycleTimer;
     RegParams.pJoinDutyCycleTimer = &RegParams.joinDutyCycleTimer;
 	RegParams.pJoinBackoffTimer = &RegParams.joinBackoffTimer;
 	RegParams.MinNewChIndex = 3;
@@ -170,13 +169,12 @@ StackRetStatus_t LORAReg_InitEU(IsmBand_t ismBand)
 	RegParams.defTxPwrIndx = MAC_DEF_TX_POWER_EU;
 	RegParams.cmnParams.paramsType2.minNonDefChId = 3;
 	RegParams.maxTxPwr = DEFAULT_EIRP_EU;
-	RegParams.pDutyCycleTimer->timerId = regTimerId[0];
-	RegParams.pJoinBackoffTimer->timerId = regTimerId[1];
-    RegParams.pJoinDutyCycleTimer->timerId = regTimerId[2];
+	RegParams.pJoinBackoffTimer->timerId = regTimerId[0];
+    RegParams.pJoinDutyCycleTimer->timerId = regTimerId[1];
 	RegParams.pJoinDutyCycleTimer->remainingtime =0;
 	RegParams.joinbccount =0;
 	RegParams.joinDutyCycleTimeout =0;
-	RegParams.aggregatedDutyCycleTimeout = 0;
+	RegParams.aggregatedAvailableAt = 0;
 	RegParams.band = ismBand;
 	
 	if(ismBand == ISM_EU868)
@@ -50,10 +50,30 @@
 #ifdef CRYPTO_DEV_ENABLED
 #include "conf_atcad.h"
 #include "cryptoauthlib.h"
+#include "sw_timer.h"
 #endif
 /**************************************** MACROS******************************/
 
+/**************************************** TYPES******************************/
+/* CMAC subkeys of a key */
+typedef struct _SalCmacSubkeys
+{
+	/* Whether the entry holds the subkeys of a key */
+	bool valid;
+	/* Type of the key */
+	salItems_t keyType;
+	/* Index of the key among the keys of its type */
+	uint8_t keyId;
+	/* Copy of the key, the subkeys are used only for this key */
+	uint8_t key[SAL_KEY_LEN];
+	uint8_t k1[SAL_KEY_LEN];
+	uint8_t k2[SAL_KEY_LEN];
+} SalCmacSubkeys_t;
+
 /**************************************** GLOBALS****************************/
+/* CMAC subkeys of the keys in use */
+static SalCmacSubkeys_t cmacSubkeys[SAL_CMAC_SUBKEY_COUNT];
+
 #ifdef CRYPTO_DEV_ENABLED
 /* List of Key Slot numbers in ECC608 where in LoRAWAN keys are stored */
 static const uint8_t keySlots[SAL_ITEMS_NUM] = {
@@ -79,14 +99,24 @@ static const uint8_t keySlots[SAL_ITEMS_NUM] = {
 static uint8_t keyEncryptionKey[32];
 /* Default configuration for an ECCx08A device on the I2C bus */
 static ATCAIfaceCfg cfg_atecc608a_i2c_default;
+/* Statistics of the transactions with the ECC608 */
+static SalDeviceStats_t deviceStats;
+/* Whether a batch is running and the bus time before it */
+static bool batchRunning = false;
+static uint32_t batchBusTime = 0;
 
 /**************************FUNCION DEFINITION***********************************/
 /* Function to generate random 32 bytes key and write that to Key Encryption Key Slot */
 static SalStatus_t sal_WriteKeyEncryptionKey(void);
+/* Accounts an operation of the ECC608 which started at the given time */
+static void sal_DeviceOperationDone(uint64_t startTime);
 #endif
 
-static void sal_GenerateSubkey (uint8_t* key, salItems_t key_type, uint8_t* k1, uint8_t* k2);
+static SalStatus_t sal_GenerateSubkey (uint8_t* key, salItems_t key_type, uint8_t* k1, uint8_t* k2);
 static void sal_FillSubKey( uint8_t *source, uint8_t *key, uint8_t size);
+static bool sal_IsEngineKey(salItems_t key_type);
+static SalCmacSubkeys_t* sal_FindSubkeys(salItems_t key_type, uint8_t* key);
+static SalStatus_t sal_CmacChain(SalCmacContext_t* context, uint8_t* input, uint16_t count);
 /*************************************IMPLEMENTATION****************************/
  /**
  * \brief This function initializes the security modules like AES, ECC608 (If used)
@@ -147,7 +177,8 @@ SalStatus_t SAL_AESEncode(unsigned char* buffer, salItems_t key_type, unsigned c
 #ifndef CRYPTO_DEV_ENABLED // If Keys are provide by the MAC for encrypting the data
 	memcpy(useKey, key, sizeof(useKey));
 	/* Encrypt the block using AES (HW/SW) Engine */
-	AESEncode(buffer, useKey);
+	AESSessionStart(useKey);
+	AESSessionEncode(buffer, 1);
 	key_type = key_type;
 #else // If Keys are stored inside the ECC608A device
 	ATCA_STATUS atcab_status = ATCA_SUCCESS;
@@ -161,7 +192,9 @@ SalStatus_t SAL_AESEncode(unsigned char* buffer, salItems_t key_type, unsigned c
 		{
 			/* If the key_type is APP Key, Encryption Should have done inside ECC608,
 			 * since AppKey is not readable from it */
+			uint64_t startTime = SwTimerGetTime();
 			atcab_status = atcab_aes_encrypt(keySlot, APP_KEY_SLOT_BLOCK, buffer, encData);
+			sal_DeviceOperationDone(startTime);
 			if (atcab_status == ATCA_SUCCESS)
 			{
 				memcpy(buffer, encData, sizeof(encData));
@@ -182,7 +215,8 @@ SalStatus_t SAL_AESEncode(unsigned char* buffer, salItems_t key_type, unsigned c
 		{
 			memcpy(useKey, key, sizeof(useKey));
 			/* Encrypt the block using AES (HW/SW) Engine */
-			AESEncode(buffer, useKey);
+			AESSessionStart(useKey);
+			AESSessionEncode(buffer, 1);
 		}
 		break;
 		
@@ -196,6 +230,95 @@ SalStatus_t SAL_AESEncode(unsigned char* buffer, salItems_t key_type, unsigned c
 	return sal_status;
 }
 
+/**
+ * \brief This function encrypts whole blocks of data with the key specified/the key stored in ECC608A.
+ *        A key given by the upper layer is loaded in the AES engine once for all the blocks.
+ *
+ * \param[in,out]  *buffer  -  pointer to the blocks of data to be encrypted in place
+ * \param[in]  count    -  number of 16 bytes blocks
+ * \param[in]  key_type -  Name of the key which is used to encrypt the data
+ *						   (Note: This parameter is used when Key is stored in ECC608)
+ * \param[in]  *key		-  Pointer to the key used for Encryption
+ *						   (Note: This parameter is used when Key is provided by the upper layer)
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when encryption is successful
+ *         SAL_FAILURE			-- when encryption is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given as input parameter
+ */
+SalStatus_t SAL_AESEncodeBlocks(unsigned char* buffer, uint16_t count, salItems_t key_type, unsigned char* key)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
+	uint16_t i = 0;
+
+	if (sal_IsEngineKey(key_type))
+	{
+		AESSessionStart(key);
+		AESSessionEncode(buffer, count);
+	}
+	else
+	{
+		/* The key is held by the crypto device, one block at a time */
+		for (i = 0; (i < count) && (SAL_SUCCESS == sal_status); i++)
+		{
+			sal_status = SAL_AESEncode(&buffer[i * SAL_KEY_LEN], key_type, key);
+		}
+	}
+
+	return sal_status;
+}
+
+/**
+ * \brief This function encrypts or decrypts a buffer in counter mode (CTR) with the key specified.
+ *        The key stream of the n-th block is the encryption of the counter block incremented by n
+ *        in its last two bytes (big endian). Input and output may be the same buffer.
+ *
+ * \param[out]  *output	-  Pointer to the result, size bytes
+ * \param[in]   *input		-  Pointer to the data to be encrypted or decrypted, size bytes
+ * \param[in]	size        -  Length of the data
+ * \param[in]   *counter	-  Pointer to the 16 bytes counter block of the first block
+ * \param[in]  key_type		-  value of type salItems_t - Name of the key which is used for the key stream
+ *						       (Note: This parameter is used when key is stored in ECC608)
+ * \param[in]  *key		    -  Pointer to the key used for the key stream
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when encryption is successful
+ *         SAL_FAILURE			-- when encryption is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given as input parameter
+ */
+SalStatus_t SAL_AESCtr(uint8_t* output, uint8_t* input, uint16_t size, uint8_t* counter, salItems_t key_type, uint8_t* key)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
+	uint8_t block[16];
+	uint16_t blockCounter = 0;
+	uint16_t i = 0, j = 0;
+
+	if (sal_IsEngineKey(key_type))
+	{
+		AESSessionStart(key);
+		AESSessionCtr(output, input, size, counter);
+		return sal_status;
+	}
+
+	/* The key is held by the crypto device, one block at a time */
+	blockCounter = ((uint16_t)counter[14] << 8) | counter[15];
+	for (i = 0; (i < size) && (SAL_SUCCESS == sal_status); i += sizeof(block))
+	{
+		memcpy(block, counter, sizeof(block) - 2);
+		block[14] = (uint8_t)(blockCounter >> 8);
+		block[15] = (uint8_t)blockCounter;
+		blockCounter++;
+
+		sal_status = SAL_AESEncode(block, key_type, key);
+		for (j = 0; (j < sizeof(block)) && ((i + j) < size); j++)
+		{
+			output[i + j] = input[i + j] ^ block[j];
+		}
+	}
+
+	return sal_status;
+}
+
 /**
  * \brief This function derives the session key using the Block of data given as input
  *
@@ -256,7 +379,9 @@ SalStatus_t SAL_DeriveSessionKey(unsigned char* block, salItems_t src_key, unsig
 	 *
 	 * \return ATCA_SUCCESS on success, otherwise an error code.
 	 */
+	 uint64_t startTime = SwTimerGetTime();
 	 atcad_status = atcab_kdf(derive_mode, key_id, aes_details, block, NULL, NULL);
+	 sal_DeviceOperationDone(startTime);
 	
 							
 	
@@ -289,6 +414,7 @@ SalStatus_t SAL_Read(salItems_t key_type, uint8_t* key)
 	/* Get the Key slot number based on the Key type parameter */	
 	uint8_t keyId = keySlots[key_type];
 	uint8_t block = 0;
+	uint64_t startTime = SwTimerGetTime();
 	switch(key_type)
 	{
 		case SAL_NWKS_KEY:
@@ -353,6 +479,10 @@ SalStatus_t SAL_Read(salItems_t key_type, uint8_t* key)
 		break;
 	}
 	
+	if (SAL_INVALID_KEY_TYPE != sal_status)
+	{
+		sal_DeviceOperationDone(startTime);
+	}
 	if (ATCA_SUCCESS != status)
 	{
 		sal_status = SAL_FAILURE;
@@ -366,6 +496,83 @@ SalStatus_t SAL_Read(salItems_t key_type, uint8_t* key)
     return sal_status;
 }
 
+/**
+ * \brief This function starts a batch of operations: the crypto device (ECC608) is kept awake
+ *        from the first operation until SAL_BatchEnd instead of being woken up for each of them.
+ *        Without crypto device it does nothing.
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the batch is started or a batch is already running
+ *         SAL_FAILURE			-- when the crypto device cannot be held awake
+ */
+SalStatus_t SAL_BatchStart(void)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
+#ifdef CRYPTO_DEV_ENABLED
+	if (!batchRunning)
+	{
+		if (ATCA_SUCCESS == atcab_hold_awake(true))
+		{
+			batchRunning = true;
+			batchBusTime = deviceStats.busTime;
+			deviceStats.batches++;
+		}
+		else
+		{
+			sal_status = SAL_FAILURE;
+		}
+	}
+#endif
+	return sal_status;
+}
+
+/**
+ * \brief This function ends the batch started by SAL_BatchStart and puts the crypto device
+ *        into the idle state
+ */
+void SAL_BatchEnd(void)
+{
+#ifdef CRYPTO_DEV_ENABLED
+	uint64_t startTime = 0;
+
+	if (batchRunning)
+	{
+		/* The idle sequence is a transaction of the batch but not an operation */
+		startTime = SwTimerGetTime();
+		atcab_hold_awake(false);
+		deviceStats.busTime += (uint32_t)(SwTimerGetTime() - startTime);
+
+		deviceStats.lastBatchTime = deviceStats.busTime - batchBusTime;
+		batchRunning = false;
+	}
+#endif
+}
+
+/**
+ * \brief This function gives the statistics of the transactions with the crypto device
+ *
+ * \param[out]  *stats		-  Pointer to the statistics
+ */
+void SAL_GetDeviceStats(SalDeviceStats_t* stats)
+{
+#ifdef CRYPTO_DEV_ENABLED
+	memcpy(stats, &deviceStats, sizeof(SalDeviceStats_t));
+#else
+	memset(stats, 0, sizeof(SalDeviceStats_t));
+#endif
+}
+
+/**
+ * \brief This function clears the statistics of the transactions with the crypto device
+ */
+void SAL_ClearDeviceStats(void)
+{
+#ifdef CRYPTO_DEV_ENABLED
+	memset(&deviceStats, 0, sizeof(SalDeviceStats_t));
+	batchBusTime = 0;
+#endif
+}
+
 /**
  * \brief This function calculates the CMAC value using the key specified
  *
@@ -384,92 +591,285 @@ SalStatus_t SAL_Read(salItems_t key_type, uint8_t* key)
  */
 SalStatus_t SAL_AESCmac(uint8_t* key, salItems_t key_type, uint8_t* output, uint8_t* input, uint16_t size)
 {
+	SalCmacContext_t context;
 	SalStatus_t sal_status = SAL_SUCCESS;
-	uint16_t n = 0, i = 0, j =0;
-	bool flag = false;
-	uint8_t k1[16], k2[16];
-	uint8_t x[16], y[16], mLast[16], padded[16];
-	uint8_t *ptr = NULL;
 
-	sal_GenerateSubkey(key, key_type, k1, k2);
+	sal_status = SAL_AESCmacInit(&context, key, key_type);
+	if (SAL_SUCCESS == sal_status)
+	{
+		sal_status = SAL_AESCmacUpdate(&context, input, size);
+	}
+	if (SAL_SUCCESS == sal_status)
+	{
+		sal_status = SAL_AESCmacFinal(&context, output);
+	}
+
+	return sal_status;
+}
 
-	n = (size + 15) >> 4;
-	if (n == 0)
+/**
+ * \brief This function starts a CMAC computation whose data is given in segments by SAL_AESCmacUpdate
+ *
+ * \param[out] *context		-  Pointer to the state of the computation
+ * \param[in]  *key		    -  Pointer to the key used for calculating the CMAC value, it must stay
+ *							   valid until SAL_AESCmacFinal
+ * \param[in]  key_type		-  value of type salItems_t - Name of the key which is used to calculate the CMAC
+ *						       (Note: This parameter is used when key is stored in ECC608)
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the computation is started
+ */
+SalStatus_t SAL_AESCmacInit(SalCmacContext_t* context, uint8_t* key, salItems_t key_type)
+{
+	memset(context, 0, sizeof(SalCmacContext_t));
+	context->key = key;
+	context->keyType = key_type;
+
+	return SAL_SUCCESS;
+}
+
+/**
+ * \brief This function adds a segment of data to a CMAC computation. The segments are
+ *        processed as if they were contiguous, without being copied together.
+ *
+ * \param[in,out] *context	-  Pointer to the state of the computation
+ * \param[in]   *input		-  Pointer to the segment
+ * \param[in]	size        -  Length of the segment
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the segment is processed
+ *         SAL_FAILURE			-- when the encryption is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given to SAL_AESCmacInit
+ */
+SalStatus_t SAL_AESCmacUpdate(SalCmacContext_t* context, uint8_t* input, uint16_t size)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
+	uint16_t blocks = 0;
+	uint8_t copy = 0;
+
+	while ((size > 0) && (SAL_SUCCESS == sal_status))
 	{
-		n = 1;
-		flag = 0;
+		/* The pending block is not the last one, more data follows */
+		if (sizeof(context->pending) == context->pendingLength)
+		{
+			sal_status = sal_CmacChain(context, context->pending, 1);
+			context->pendingLength = 0;
+		}
+
+		/* Whole blocks are chained from the segment itself, the last one is kept back */
+		if ((0 == context->pendingLength) && (size > sizeof(context->pending)))
+		{
+			blocks = (size - 1) / sizeof(context->pending);
+			if (SAL_SUCCESS == sal_status)
+			{
+				sal_status = sal_CmacChain(context, input, blocks);
+			}
+			input += blocks * sizeof(context->pending);
+			size -= blocks * sizeof(context->pending);
+		}
+
+		copy = sizeof(context->pending) - context->pendingLength;
+		if (copy > size)
+		{
+			copy = size;
+		}
+		memcpy(&context->pending[context->pendingLength], input, copy);
+		context->pendingLength += copy;
+		input += copy;
+		size -= copy;
+	}
+
+	return sal_status;
+}
+
+/**
+ * \brief This function completes a CMAC computation
+ *
+ * \param[in,out] *context	-  Pointer to the state of the computation
+ * \param[out]  *output		-  Pointer to the 16bytes CMAC value
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when CMAC calculation is successful
+ *         SAL_FAILURE			-- when CMAC calculation is failed
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given to SAL_AESCmacInit
+ */
+SalStatus_t SAL_AESCmacFinal(SalCmacContext_t* context, uint8_t* output)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
+	uint8_t subkeys[2][16];
+	uint8_t *k1 = subkeys[0], *k2 = subkeys[1];
+	uint8_t i = 0;
+	SalCmacSubkeys_t *cached = sal_FindSubkeys(context->keyType, context->key);
+
+	if ((NULL == cached) && !sal_IsEngineKey(context->keyType) &&
+		(SAL_SUCCESS == SAL_CmacSubkeyUpdate(context->keyType, 0, context->key)))
+	{
+		/* A key held by the crypto device does not change, keep its subkeys from the first use */
+		cached = sal_FindSubkeys(context->keyType, context->key);
+	}
+
+	if (NULL != cached)
+	{
+		k1 = cached->k1;
+		k2 = cached->k2;
 	}
 	else
 	{
-		flag = !(size % 16);
+		sal_status = sal_GenerateSubkey(context->key, context->keyType, k1, k2);
 	}
 
-	if ( flag == 1 )
+	if (sizeof(context->pending) == context->pendingLength)
 	{
-		j = 0;
-		for (i=((n-1) << 4); i<(n << 4); i++)
+		/* Complete last block */
+		for (i = 0; i < sizeof(context->pending); i++)
 		{
-			mLast[j] = input[i] ^ k1[j];
-			j++;
+			context->pending[i] ^= k1[i];
 		}
 	}
 	else
 	{
-		// padding
-		ptr = &input[size - (size%16)];
-		for (i=0; i<16; i++)
+		/* Padded last block, the pending block may still hold bytes of the previous one */
+		memset(&context->pending[context->pendingLength], 0, sizeof(context->pending) - context->pendingLength);
+		context->pending[context->pendingLength] = 0x80;
+		for (i = 0; i < sizeof(context->pending); i++)
 		{
-			if ( i < (size%16) )
-			{
-				padded[i] = ptr[i];
-			}
-			else
-			{
-				if ( i == (size%16) )
-				{
-					padded[i] = 0x80;
-				}
-				else
-				{
-					padded[i] = 0x00;
-				}
-			}
+			context->pending[i] ^= k2[i];
 		}
+	}
 
-		// XOR
-		for (i=0; i<sizeof(mLast); i++)
-		{
-			mLast[i] = padded[i] ^ k2[i];
-		}
+	if (SAL_SUCCESS == sal_status)
+	{
+		sal_status = sal_CmacChain(context, context->pending, 1);
 	}
+	memcpy(output, context->chain, sizeof(context->chain));
+	memset(context, 0, sizeof(SalCmacContext_t));
 
-	memset(x, 0, sizeof(x));
+	return sal_status;
+}
+
+/**
+ * \brief This function derives the CMAC subkeys K1/K2 of a key and keeps them for SAL_AESCmac.
+ *        Setting a new key for the same key_type and key_id replaces its subkeys.
+ *
+ * \param[in]  key_type		-  value of type salItems_t - Name of the key
+ * \param[in]  key_id		-  Index of the key among the keys of the same type (multicast group), 0 otherwise
+ * \param[in]  *key		    -  Pointer to the key (Note: not used when the key is stored in ECC608)
+ *
+ * \return value of type SalStatus_t
+ *         SAL_SUCCESS			-- when the subkeys are derived and kept
+ *         SAL_FAILURE			-- when the derivation failed or there is no room left, SAL_AESCmac
+ *								   then derives the subkeys of this key on every call
+ *		   SAL_INVALID_KEY_TYPE -- when invalid key_type is given as input parameter
+ */
+SalStatus_t SAL_CmacSubkeyUpdate(salItems_t key_type, uint8_t key_id, uint8_t* key)
+{
+	SalCmacSubkeys_t *entry = NULL;
+	uint8_t i = 0;
 
-	for (i=0; i<(n-1); i++)
+	if ((SAL_APP_KEY != key_type) && (SAL_APPS_KEY != key_type) && (SAL_NWKS_KEY != key_type) &&
+		(SAL_MCAST_APPS_KEY != key_type) && (SAL_MCAST_NWKS_KEY != key_type))
 	{
-		for (j=0; j<16; j++)
+		return SAL_INVALID_KEY_TYPE;
+	}
+
+	/* The entry of this key, or else a free one */
+	for (i = 0; i < SAL_CMAC_SUBKEY_COUNT; i++)
+	{
+		if (cmacSubkeys[i].valid && (key_type == cmacSubkeys[i].keyType) && (key_id == cmacSubkeys[i].keyId))
+		{
+			entry = &cmacSubkeys[i];
+			break;
+		}
+		if ((NULL == entry) && !cmacSubkeys[i].valid)
 		{
-			y[j] = x[j] ^ input[(i << 4)+j];
+			entry = &cmacSubkeys[i];
 		}
-		memcpy(x, y, sizeof(y));
-		SAL_AESEncode(x, key_type, key);
 	}
 
-	for (i=0; i<sizeof(x); i++)
+	if (NULL == entry)
 	{
-		y[i] = x[i] ^ mLast[i];
+		return SAL_FAILURE;
 	}
 
-	SAL_AESEncode(y, key_type, key);
+	/* Invalidate the subkeys of the previous key first */
+	memset(entry, 0, sizeof(SalCmacSubkeys_t));
 
-	memcpy(output, y, sizeof(y));
-	
-	return sal_status;
+	if (SAL_SUCCESS != sal_GenerateSubkey(key, key_type, entry->k1, entry->k2))
+	{
+		memset(entry, 0, sizeof(SalCmacSubkeys_t));
+		return SAL_FAILURE;
+	}
+
+	if (sal_IsEngineKey(key_type))
+	{
+		memcpy(entry->key, key, SAL_KEY_LEN);
+	}
+	entry->keyType = key_type;
+	entry->keyId = key_id;
+	entry->valid = true;
+
+	return SAL_SUCCESS;
+}
+
+/**
+ * \brief This function erases all the CMAC subkeys kept by SAL_CmacSubkeyUpdate
+ */
+void SAL_CmacSubkeyClear(void)
+{
+	memset(cmacSubkeys, 0, sizeof(cmacSubkeys));
 }
 
 /****************************** PRIVATE FUNCTIONS *****************************/
-static void sal_GenerateSubkey (uint8_t* key, salItems_t key_type, uint8_t* k1, uint8_t* k2)
+/* Chains whole blocks into the CMAC value: chain = AES(key, chain ^ block) */
+static SalStatus_t sal_CmacChain(SalCmacContext_t* context, uint8_t* input, uint16_t count)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
+	uint16_t i = 0;
+	uint8_t j = 0;
+
+	if (sal_IsEngineKey(context->keyType))
+	{
+		/* The AES engine chains the blocks, the key is loaded once */
+		AESSessionStart(context->key);
+		AESSessionCbcMac(context->chain, input, count);
+		return sal_status;
+	}
+
+	for (i = 0; (i < count) && (SAL_SUCCESS == sal_status); i++)
+	{
+		for (j = 0; j < sizeof(context->chain); j++)
+		{
+			context->chain[j] ^= input[(i << 4) + j];
+		}
+		sal_status = SAL_AESEncode(context->chain, context->keyType, context->key);
+	}
+
+	return sal_status;
+}
+
+/* Returns the subkeys kept for the given key, NULL if there are none. A key
+ * held by the upper layer must match the copy kept with its subkeys, a key
+ * held by the crypto device is identified by its type */
+static SalCmacSubkeys_t* sal_FindSubkeys(salItems_t key_type, uint8_t* key)
 {
+	uint8_t i = 0;
+	bool engineKey = sal_IsEngineKey(key_type);
+
+	for (i = 0; i < SAL_CMAC_SUBKEY_COUNT; i++)
+	{
+		if (cmacSubkeys[i].valid && (key_type == cmacSubkeys[i].keyType) &&
+			(!engineKey || (0 == memcmp(cmacSubkeys[i].key, key, SAL_KEY_LEN))))
+		{
+			return &cmacSubkeys[i];
+		}
+	}
+
+	return NULL;
+}
+
+static SalStatus_t sal_GenerateSubkey (uint8_t* key, salItems_t key_type, uint8_t* k1, uint8_t* k2)
+{
+	SalStatus_t sal_status = SAL_SUCCESS;
 	uint8_t i = 0;
 	uint8_t l[16];
 	uint8_t const_Rb[16] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -478,7 +878,7 @@ static void sal_GenerateSubkey (uint8_t* key, salItems_t key_type, uint8_t* k1,
 
 	memset(l, 0, sizeof(l));
 
-	SAL_AESEncode(l, key_type, key);
+	sal_status = SAL_AESEncode(l, key_type, key);
 
 	// compute k1 sub-key
 	if ( (l[0] & 0x80) == 0x00 )  // MSB( bufferLocal[0] ) is '0'
@@ -509,6 +909,30 @@ static void sal_GenerateSubkey (uint8_t* key, salItems_t key_type, uint8_t* k1,
 			k2[i] = k2[i] ^ const_Rb[i];
 		}
 	}
+
+	return sal_status;
+}
+
+/* Returns true if the key of the given type is provided by the upper layer and
+ * can be loaded in the AES engine, false if it is held by the crypto device */
+static bool sal_IsEngineKey(salItems_t key_type)
+{
+#ifndef CRYPTO_DEV_ENABLED
+	key_type = key_type;
+	return true;
+#else
+	switch(key_type)
+	{
+		case SAL_APPS_KEY:
+		case SAL_NWKS_KEY:
+		case SAL_MCAST_APPS_KEY:
+		case SAL_MCAST_NWKS_KEY:
+			return true;
+
+		default:
+			return false;
+	}
+#endif
 }
 
 static void sal_FillSubKey( uint8_t *source, uint8_t *key, uint8_t size)
@@ -561,6 +985,13 @@ static SalStatus_t sal_WriteKeyEncryptionKey(void)
 	
 	return sal_status;
 }
+
+/* Accounts an operation of the ECC608 which started at the given time */
+static void sal_DeviceOperationDone(uint64_t startTime)
+{
+	deviceStats.operations++;
+	deviceStats.busTime += (uint32_t)(SwTimerGetTime() - startTime);
+}
 #endif
 
 
@@ -0,0 +1,112 @@
+/**
+* \file  pds_log.h
+*
+* \brief This is the Pds log-structured store header file which contains the Pds log headers.
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+
+#ifndef _PDS_LOG_H_
+#define _PDS_LOG_H_
+
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include "compiler.h"
+#include "pds_nvm.h"
+#include "pds_interface.h"
+
+/******************************************************************************
+                   Defines section
+******************************************************************************/
+/* Largest number of items of a registered file, sizes the RAM index */
+#ifndef PDS_LOG_MAX_ITEMS
+#define PDS_LOG_MAX_ITEMS		32
+#endif
+
+/******************************************************************************
+                   Prototypes section
+******************************************************************************/
+
+/**************************************************************************//**
+\brief	Initializes the log-structured PDS: reads the row headers, replays the
+		records of the rows in the order they were written to build the RAM
+		index of the latest record of every item.
+
+\param[in] none
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsLogInit(void);
+
+/**************************************************************************//**
+\brief	Appends a record of an item to the log. When the row of the log is
+		full the next row is opened, and the oldest row is compacted into it.
+
+\param[in] 	pdsFileItemIdx - The file id of the item.
+\param[in] 	itemIdx - The index of the item in the item list of the file.
+\param[in] 	data - The value of the item, not used for a deleted item.
+\param[in] 	size - The size of the value.
+\param[in] 	deleted - true to record the deletion of the item.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsLogWrite(PdsFileItemIdx_t pdsFileItemIdx, uint8_t itemIdx, uint8_t *data,
+	uint8_t size, bool deleted);
+
+/**************************************************************************//**
+\brief	Builds the image of a file, in the layout of the wear levelling store,
+		from the latest records of its items.
+
+\param[in] 	pdsFileItemIdx - The file id to be read from.
+\param[in] 	buffer - The buffer for the image of the file.
+\param[in] 	size - The size of the image of the file.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsLogRead(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size);
+
+/**************************************************************************//**
+\brief This function checks if a record of an item of the file is in the log.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsLogIsFileFound(PdsFileItemIdx_t pdsFileItemIdx);
+
+/**************************************************************************//**
+\brief This function erases the RAM index and all the rows of the log.
+
+\param[out] - void
+******************************************************************************/
+void pdsLogDeleteAll(void);
+
+#endif  /* _PDS_LOG_H_ */
+
+/* eof pds_log.h */
@@ -44,12 +44,23 @@
                    Includes section
 ******************************************************************************/
 #include "system_task_manager.h"
+#include "pds_interface.h"
 
 /******************************************************************************
                    Defines section
 ******************************************************************************/
 #define PDS_TASKS_COUNT               1u
 
+/* Delay of the writes of the items stored or deleted, in ms. The files marked
+ * in the meantime are written once each: a burst of stores on a file costs one
+ * write. The timer may expire up to the same delay late to share a wakeup.
+ * PDS_Flush() writes them at once, PMM_Sleep() calls it before sleeping.
+ * PDS_STORE_NOW() items, the uplink frame counter ceiling, are not deferred.
+ * 0 writes the files as soon as the PDS task runs. */
+#ifndef PDS_WRITE_DELAY_MS
+#define PDS_WRITE_DELAY_MS            0u
+#endif
+
 /******************************************************************************
                                Types section
 *******************************************************************************/
@@ -63,6 +74,18 @@ typedef enum
 ******************************************************************************/
 SYSTEM_TaskStatus_t PDS_TaskHandler(void);
 
+/**************************************************************************//**
+\brief Prepares the PDS task, creates the timer of the deferred writes.
+
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsTaskInit(void);
+
+/**************************************************************************//**
+\brief Schedules the write of the files marked, after PDS_WRITE_DELAY_MS.
+******************************************************************************/
+void pdsPostWrite(void);
+
 /**************************************************************************//**
 \brief Set task for PDS task manager.
 
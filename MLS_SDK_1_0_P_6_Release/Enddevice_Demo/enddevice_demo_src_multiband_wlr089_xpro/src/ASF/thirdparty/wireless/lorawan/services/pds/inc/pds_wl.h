@@ -50,6 +50,8 @@
 /******************************************************************************
                    Defines section
 ******************************************************************************/
+/* Words of the bitmap of the rows holding the latest copy of a file */
+#define PDS_WL_ROW_WORDS		((EEPROM_NUM_ROWS + 31) / 32)
 
 /******************************************************************************
                                Types section
@@ -58,7 +60,7 @@ typedef struct _RowMap
 {
     uint32_t counter;
     uint16_t memId;
-    uint16_t previousIdx;
+    uint8_t size;	/* Size in the NVM header, for the CRC check of the copy */
 } RowMap_t;
 
 typedef struct _FileMap
@@ -66,19 +68,14 @@ typedef struct _FileMap
     uint16_t maxCounterRowIdx;
 } FileMap_t;
 
-typedef struct _UpdateFileMap
-{
-    uint32_t counter;
-    uint16_t memId;
-    uint16_t rowIdx;
-} UpdateFileMap_t;
-
 /******************************************************************************
                    Prototypes section
 ******************************************************************************/
 
 /**************************************************************************//**
-\brief Initializes the WL PDS by updating the row and file map.
+\brief Initializes the WL PDS by updating the row and file map. Only the
+		headers of the rows are read; the latest copy of every file is then
+		read once to check its CRC.
 
 \param[in] none
 \param[out] status - The return status of the function's operation of type PdsStatus_t.
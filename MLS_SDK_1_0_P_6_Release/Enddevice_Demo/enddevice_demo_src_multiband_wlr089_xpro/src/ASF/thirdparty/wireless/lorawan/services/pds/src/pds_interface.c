@@ -43,6 +43,7 @@
 #include "pds_common.h"
 #include "pds_task_handler.h"
 #include "pds_wl.h"
+#include "pds_log.h"
 
 /******************************************************************************
                    Global section
@@ -72,7 +73,17 @@ PdsFileMarks_t fileMarks[PDS_MAX_FILE_IDX];
 PdsStatus_t PDS_Init(void)
 {
 #if (ENABLE_PDS == 1)	
+#ifdef PDS_LOG_ENABLE
+	PdsStatus_t status = pdsLogInit();
+#else
 	PdsStatus_t status = pdsWlInit();
+#endif
+	PdsStatus_t taskStatus = pdsTaskInit();
+
+	if (PDS_OK == status)
+	{
+		status = taskStatus;
+	}
 	pdsUnInitFlag = false;
 	return status;
 #else
@@ -117,7 +128,7 @@ PdsStatus_t PDS_Store(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
 			{
 				*((fileMarks[pdsFileItemIdx].fileMarkListAddr) + item) = PDS_OP_STORE;
 				isFileSet[pdsFileItemIdx] = true;
-				pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+				pdsPostWrite();
 			}
 			else
 			{
@@ -160,7 +171,11 @@ PdsStatus_t PDS_Restore(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
 			memset(&buffer, 0, sizeof(PdsMem_t));
 			memcpy((void *)&itemInfo, (void *)(fileMarks[pdsFileItemIdx].itemListAddr + (fileMarks[pdsFileItemIdx].numItems - 1)), sizeof(ItemMap_t));
 			size = itemInfo.itemOffset + itemInfo.size + sizeof(ItemHeader_t);
+#ifdef PDS_LOG_ENABLE
+			status = pdsLogRead(pdsFileItemIdx, &buffer, size);
+#else
 			status = pdsWlRead(pdsFileItemIdx, &buffer, size);
+#endif
 			if (status != PDS_OK)
 			{
 				return status;
@@ -222,7 +237,7 @@ PdsStatus_t PDS_Delete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
 			{
 				*((fileMarks[pdsFileItemIdx].fileMarkListAddr) + item) = PDS_OP_DELETE;
 				isFileSet[pdsFileItemIdx] = true;
-				pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+				pdsPostWrite();
 			}
 			else
 			{
@@ -258,7 +273,11 @@ bool PDS_IsRestorable(void)
 			(0 != fileMarks[pdsFileItemIdx].itemListAddr)			\
 			)
 			{
+#ifdef PDS_LOG_ENABLE
+				if ( !(pdsLogIsFileFound(pdsFileItemIdx)) )
+#else
 				if ( !(isFileFound(pdsFileItemIdx)) )
+#endif
 				{
 					return return_status;
 				}
@@ -280,7 +299,11 @@ PdsStatus_t PDS_DeleteAll(void)
 #if (ENABLE_PDS == 1)
 	if (false == pdsUnInitFlag)
 	{
+#ifdef PDS_LOG_ENABLE
+		pdsLogDeleteAll();
+#else
 		pdsWlDeleteAll();
+#endif
 	}
 #endif
 	return PDS_OK;
@@ -314,7 +337,11 @@ PdsStatus_t PDS_RestoreAll(void)
 				memset(&buffer, 0, sizeof(PdsMem_t));
 				memcpy((void *)&itemInfo, (void *)(fileMarks[pdsFileItemIdx].itemListAddr + (fileMarks[pdsFileItemIdx].numItems - 1)), sizeof(ItemMap_t));
 				size = itemInfo.itemOffset + itemInfo.size + sizeof(ItemHeader_t);
+#ifdef PDS_LOG_ENABLE
+				status = pdsLogRead(pdsFileItemIdx, &buffer, size);
+#else
 				status = pdsWlRead(pdsFileItemIdx, &buffer, size);
+#endif
 				if (status != PDS_OK)
 				{
 					return status;
@@ -369,7 +396,7 @@ PdsStatus_t PDS_StoreAll(void)
 				isFileSet[pdsFileItemIdx] = true;
 			}
 		}
-		pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+		pdsPostWrite();
 	}
 #endif	
 	return PDS_OK;
@@ -414,6 +441,13 @@ PdsStatus_t PDS_UnRegFile(PdsFileItemIdx_t argFileId)
 	{
 		if (PDS_MAX_FILE_IDX > argFileId)
 		{
+			/* Write the items stored and not written yet while their RAM is
+			 * there, the PDS task cannot write a file without its marks */
+			if (isFileSet[argFileId])
+			{
+				status = PDS_Flush();
+				isFileSet[argFileId] = false;
+			}
 			memset(&fileMarks[argFileId], 0, sizeof(PdsFileMarks_t));
 		}
 		else
@@ -223,6 +223,11 @@ RadioError_t RADIO_GetAttr(RadioAttribute_t attribute, void *value)
  		{
 	 		*(int16_t *)value = radioConfiguration.packetRSSI;
  	    }
+		break;
+		case RADIO_ENERGY_TIMES:
+		{
+			Radio_GetEnergyTimes((RadioEnergyTimes_t *)value);
+		}
 		break;
 		default:
 		{
@@ -512,6 +517,7 @@ void RADIO_Init(void)
 void Radio_WriteFrequency(uint32_t frequency)
 {
     uint32_t num, num_mod;
+    uint8_t frf[3];
     // Frf = (Fxosc * num) / 2^19
     // We take advantage of the fact that 32MHz = 15625Hz * 2^11
     // This simplifies our formula to Frf = (15625Hz * num) / 2^8
@@ -533,9 +539,11 @@ void Radio_WriteFrequency(uint32_t frequency)
 
     // Now variable num holds the representation of the frequency that needs to
     // be loaded into the radio chip
-    RADIO_RegisterWrite(REG_FRFMSB, (num >> SHIFT16) & 0xFF);
-    RADIO_RegisterWrite(REG_FRFMID, (num >> SHIFT8) & 0xFF);
-    RADIO_RegisterWrite(REG_FRFLSB, num & 0xFF);
+    // FRFMSB, FRFMID and FRFLSB are placed at sequential addresses
+    frf[0] = (num >> SHIFT16) & 0xFF;
+    frf[1] = (num >> SHIFT8) & 0xFF;
+    frf[2] = num & 0xFF;
+    Radio_WriteRegisters(REG_FRFMSB, frf, sizeof(frf));
 }
 
 /*********************************************************************//**
@@ -547,6 +555,7 @@ void Radio_WriteFrequency(uint32_t frequency)
 static void Radio_WriteFSKFrequencyDeviation(uint32_t frequencyDeviation)
 {
     uint32_t num;
+    uint8_t fdev[2];
 
     // Fdev = (Fxosc * num) / 2^19
     // We take advantage of the fact that 32MHz = 15625Hz * 2^11
@@ -559,8 +568,9 @@ static void Radio_WriteFSKFrequencyDeviation(uint32_t frequencyDeviation)
 
     // Now variable num holds the representation of the frequency deviation that
     // needs to be loaded into the radio chip
-    RADIO_RegisterWrite(REG_FSK_FDEVMSB, (num >> SHIFT8) & 0xFF);
-    RADIO_RegisterWrite(REG_FSK_FDEVLSB, num & 0xFF);
+    fdev[0] = (num >> SHIFT8) & 0xFF;
+    fdev[1] = num & 0xFF;
+    Radio_WriteRegisters(REG_FSK_FDEVMSB, fdev, sizeof(fdev));
 }
 
 /*********************************************************************//**
@@ -572,15 +582,17 @@ static void Radio_WriteFSKFrequencyDeviation(uint32_t frequencyDeviation)
 static void Radio_WriteFSKBitRate(uint32_t bitRate)
 {
     uint32_t num;
+    uint8_t bitRateValue[2];
 
     num = 32000000;
     num /= bitRate;
 
     // Now variable num holds the representation of the bitrate that
     // needs to be loaded into the radio chip
-    RADIO_RegisterWrite(REG_FSK_BITRATEMSB, (num >> SHIFT8));
-    RADIO_RegisterWrite(REG_FSK_BITRATELSB, num & 0xFF);
-    RADIO_RegisterWrite(REG_FSK_BITRATEFRAC, 0x00);
+    bitRateValue[0] = (num >> SHIFT8) & 0xFF;
+    bitRateValue[1] = num & 0xFF;
+    Radio_WriteRegisters(REG_FSK_BITRATEMSB, bitRateValue, sizeof(bitRateValue));
+    Radio_WriteRegister(REG_FSK_BITRATEFRAC, 0x00);
 }
 
 /*********************************************************************//**
@@ -606,10 +618,10 @@ static void Radio_WritePower(int8_t power)
             power = 15;
         }
 
-        paDac = RADIO_RegisterRead(REG_PADAC);
+        paDac = Radio_ReadRegister(REG_PADAC);
         paDac &= ~(0x07);
         paDac |= 0x04;
-        RADIO_RegisterWrite(REG_PADAC, paDac);
+        Radio_QueueRegister(REG_PADAC, paDac);
 
         if (power < 0)
         {
@@ -617,14 +629,14 @@ static void Radio_WritePower(int8_t power)
             // Pout = 10.8 + MaxPower*0.6 - 15 + OutPower
             // Pout = -3 + OutPower
             power += 3;
-            RADIO_RegisterWrite(REG_PACONFIG, 0x20 | power);
+            Radio_QueueRegister(REG_PACONFIG, 0x20 | power);
         }
         else
         {
             // MaxPower = 7
             // Pout = 10.8 + MaxPower*0.6 - 15 + OutPower
             // Pout = OutPower
-            RADIO_RegisterWrite(REG_PACONFIG, 0x70 | power);
+            Radio_QueueRegister(REG_PACONFIG, 0x70 | power);
         }
     }
     else
@@ -647,8 +659,8 @@ static void Radio_WritePower(int8_t power)
             power = 17;
         }
 
-        ocp = RADIO_RegisterRead(REG_OCP);
-        paDac = RADIO_RegisterRead(REG_PADAC);
+        ocp = Radio_ReadRegister(REG_OCP);
+        paDac = Radio_ReadRegister(REG_PADAC);
         paDac &= ~(0x07);
         if (power == 20)
         {
@@ -663,9 +675,9 @@ static void Radio_WritePower(int8_t power)
             ocp |= 0x20;
         }
 
-        RADIO_RegisterWrite(REG_PADAC, paDac);
-        RADIO_RegisterWrite(REG_PACONFIG, 0x80 | power);
-        RADIO_RegisterWrite(REG_OCP, ocp);
+        Radio_QueueRegister(REG_PADAC, paDac);
+        Radio_QueueRegister(REG_PACONFIG, 0x80 | power);
+        Radio_QueueRegister(REG_OCP, ocp);
     }
 }
 
@@ -680,7 +692,6 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
 {
     uint32_t tempValue;
     uint8_t regValue;
-    uint8_t i;
 
     // Load configuration from RadioConfiguration_t structure into radio
     Radio_WriteMode(MODE_SLEEP, radioConfiguration.modulation, 0);
@@ -689,18 +700,24 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
 
     if (MODULATION_LORA == radioConfiguration.modulation)
     {
-        RADIO_RegisterWrite(0x39, radioConfiguration.syncWordLoRa);
+        Radio_QueueRegister(0x39, radioConfiguration.syncWordLoRa);
 
-        RADIO_RegisterWrite(REG_LORA_MODEMCONFIG1,
+        Radio_QueueRegister(REG_LORA_MODEMCONFIG1,
                             (radioConfiguration.bandWidth << SHIFT4) |
                             (radioConfiguration.errorCodingRate << SHIFT1) |
                             (radioConfiguration.implicitHeaderMode & 0x01));
 
-        RADIO_RegisterWrite(REG_LORA_MODEMCONFIG2,
+        Radio_QueueRegister(REG_LORA_MODEMCONFIG2,
                             (radioConfiguration.dataRate << SHIFT4) |
                             ((radioConfiguration.crcOn & 0x01) << SHIFT2) |
                             ((symbolTimeout & 0x0300) >> SHIFT8));
 
+        // Queued next to MODEMCONFIG2 so that the writes go out in one burst
+        Radio_QueueRegister(REG_LORA_SYMBTIMEOUTLSB, (symbolTimeout & 0xFF));
+
+        Radio_QueueRegister(REG_LORA_PREAMBLEMSB, radioConfiguration.preambleLen >> SHIFT8);
+        Radio_QueueRegister(REG_LORA_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
+
 
         // Handle frequency hopping, if necessary
         if (0 != radioConfiguration.frequencyHopPeriod)
@@ -730,15 +747,13 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         {
             tempValue = 0;
         }
-        RADIO_RegisterWrite(REG_LORA_HOPPERIOD, (uint8_t) tempValue);
-
-        RADIO_RegisterWrite(REG_LORA_SYMBTIMEOUTLSB, (symbolTimeout & 0xFF));
+        Radio_QueueRegister(REG_LORA_HOPPERIOD, (uint8_t) tempValue);
 
         // If the symbol time is > 16ms, LowDataRateOptimize needs to be set
         // This long symbol time only happens for SF12&BW125, SF12&BW250
         // and SF11&BW125 and the following if statement checks for these
         // conditions
-		regValue = RADIO_RegisterRead(REG_LORA_MODEMCONFIG3);
+		regValue = Radio_ReadRegister(REG_LORA_MODEMCONFIG3);
         
         if (((SF_12 == radioConfiguration.dataRate) &&
 			((BW_125KHZ == radioConfiguration.bandWidth) || (BW_250KHZ == radioConfiguration.bandWidth))
@@ -753,15 +768,15 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         }
 		
         regValue |= 1 << SHIFT2;         // LNA gain set by internal AGC loop
-        RADIO_RegisterWrite(REG_LORA_MODEMCONFIG3, regValue);
+        Radio_QueueRegister(REG_LORA_MODEMCONFIG3, regValue);
 
-        regValue = RADIO_RegisterRead(REG_LORA_DETECTOPTIMIZE);
+        regValue = Radio_ReadRegister(REG_LORA_DETECTOPTIMIZE);
         regValue &= ~(0x07);        // Clear DetectOptimize bits
         regValue |= 0x03;           // Set value for SF7 - SF12
-        RADIO_RegisterWrite(REG_LORA_DETECTOPTIMIZE, regValue);
+        Radio_QueueRegister(REG_LORA_DETECTOPTIMIZE, regValue);
 
         // Also set DetectionThreshold value for SF7 - SF12
-        RADIO_RegisterWrite(REG_LORA_DETECTIONTHRESHOLD, 0x0A);
+        Radio_QueueRegister(REG_LORA_DETECTIONTHRESHOLD, 0x0A);
 
         // Errata settings to mitigate spurious reception of a LoRa Signal
         if (0x12 == radioConfiguration.regVersion)
@@ -771,32 +786,29 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
             if ( (BW_125KHZ == radioConfiguration.bandWidth) ||
                 (BW_250KHZ == radioConfiguration.bandWidth) )
             {
-                regValue = RADIO_RegisterRead(0x31);
+                Radio_QueueRegister(0x2F, 0x40);
+                Radio_QueueRegister(0x30, 0x00);
+                regValue = Radio_ReadRegister(0x31);
                 regValue &= ~0x80;                                  // Clear bit 7
-                RADIO_RegisterWrite(0x31, regValue);
-                RADIO_RegisterWrite(0x2F, 0x40);
-                RADIO_RegisterWrite(0x30, 0x00);
+                Radio_QueueRegister(0x31, regValue);
             }
 
             if (BW_500KHZ == radioConfiguration.bandWidth)
             {
-                regValue = RADIO_RegisterRead(0x31);
+                regValue = Radio_ReadRegister(0x31);
                 regValue |= 0x80;                                   // Set bit 7
-                RADIO_RegisterWrite(0x31, regValue);
+                Radio_QueueRegister(0x31, regValue);
             }
         }
 
-        regValue = RADIO_RegisterRead(REG_LORA_INVERTIQ);
+        regValue = Radio_ReadRegister(REG_LORA_INVERTIQ);
         regValue &= ~(1 << 6);                                        // Clear InvertIQ bit
         regValue |= (radioConfiguration.iqInverted & 0x01) << SHIFT6;    // Set InvertIQ bit if needed
-        RADIO_RegisterWrite(REG_LORA_INVERTIQ, regValue);
-
-        RADIO_RegisterWrite(REG_LORA_PREAMBLEMSB, radioConfiguration.preambleLen >> SHIFT8);
-        RADIO_RegisterWrite(REG_LORA_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
+        Radio_QueueRegister(REG_LORA_INVERTIQ, regValue);
 
-        RADIO_RegisterWrite(REG_LORA_FIFOADDRPTR, 0x00);
-        RADIO_RegisterWrite(REG_LORA_FIFOTXBASEADDR, 0x00);
-        RADIO_RegisterWrite(REG_LORA_FIFORXBASEADDR, 0x00);
+        Radio_QueueRegister(REG_LORA_FIFOADDRPTR, 0x00);
+        Radio_QueueRegister(REG_LORA_FIFOTXBASEADDR, 0x00);
+        Radio_QueueRegister(REG_LORA_FIFORXBASEADDR, 0x00);
 
         // Errata sensitivity increase for 500kHz BW
         if (0x12 == radioConfiguration.regVersion)
@@ -806,37 +818,37 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
                 (radioConfiguration.frequency <= FREQ_1020000KHZ)
                 )
             {
-                RADIO_RegisterWrite(0x36, 0x02);
-                RADIO_RegisterWrite(0x3a, 0x64);
+                Radio_QueueRegister(0x36, 0x02);
+                Radio_QueueRegister(0x3a, 0x64);
             }
             else if ( (BW_500KHZ == radioConfiguration.bandWidth) &&
                        (radioConfiguration.frequency >= FREQ_410000KHZ) &&
                        (radioConfiguration.frequency <= FREQ_525000KHZ)
                        )
             {
-                RADIO_RegisterWrite(0x36, 0x02);
-                RADIO_RegisterWrite(0x3a, 0x7F);
+                Radio_QueueRegister(0x36, 0x02);
+                Radio_QueueRegister(0x3a, 0x7F);
             }
             else
             {
-                RADIO_RegisterWrite(0x36, 0x03);
+                Radio_QueueRegister(0x36, 0x03);
             }
 
             // LoRa Inverted Polarity 500kHz fix (May 26, 2015 document)
             if ((BW_500KHZ == radioConfiguration.bandWidth) && (1 == radioConfiguration.iqInverted))
             {
-                RADIO_RegisterWrite(0x3A, 0x65);     // Freq to time drift
-                RADIO_RegisterWrite(0x3B, 25);       // Freq to time invert = 0d25
+                Radio_QueueRegister(0x3A, 0x65);     // Freq to time drift
+                Radio_QueueRegister(0x3B, 25);       // Freq to time invert = 0d25
             }
             else
             {
-                RADIO_RegisterWrite(0x3A, 0x65);     // Freq to time drift
-                RADIO_RegisterWrite(0x3B, 29);       // Freq to time invert = 0d29 (default)
+                Radio_QueueRegister(0x3A, 0x65);     // Freq to time drift
+                Radio_QueueRegister(0x3B, 29);       // Freq to time invert = 0d29 (default)
             }
         }
 
         // Clear all interrupts (just in case)
-        RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 0xFF);
+        Radio_QueueRegister(REG_LORA_IRQFLAGS, 0xFF);
     }
     else
     {
@@ -844,18 +856,18 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         Radio_WriteFSKFrequencyDeviation(radioConfiguration.frequencyDeviation);
         Radio_WriteFSKBitRate(radioConfiguration.bitRate);
 
-        RADIO_RegisterWrite(REG_FSK_PREAMBLEMSB, (radioConfiguration.preambleLen >> SHIFT8) & 0x00FF);
-        RADIO_RegisterWrite(REG_FSK_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
+        Radio_QueueRegister(REG_FSK_PREAMBLEMSB, (radioConfiguration.preambleLen >> SHIFT8) & 0x00FF);
+        Radio_QueueRegister(REG_FSK_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
 		
 		// Triggering event: PreambleDetect does AfcAutoOn, AgcAutoOn
 		// Also sets RestartRxOnCollision bit
-		RADIO_RegisterWrite(REG_FSK_RXCONFIG, 0x9E);
+		Radio_QueueRegister(REG_FSK_RXCONFIG, 0x9E);
 
         // Configure PaRamp
-        regValue = RADIO_RegisterRead(REG_PARAMP);
+        regValue = Radio_ReadRegister(REG_PARAMP);
         regValue &= ~0x60;    // Clear shaping bits
         regValue |= radioConfiguration.fskDataShaping << SHIFT5;
-        RADIO_RegisterWrite(REG_PARAMP, regValue);
+        Radio_QueueRegister(REG_PARAMP, regValue);
 
         // Variable length packets, whitening, Clear FIFO when CRC fails
         // no address filtering, CCITT CRC and whitening
@@ -864,30 +876,32 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         {
             regValue |= 0x10;   // Enable CRC
         }
-        RADIO_RegisterWrite(REG_FSK_PACKETCONFIG1, regValue);
-        RADIO_RegisterWrite(REG_FSK_PACKETCONFIG2, 1 << SHIFT6);
+        Radio_QueueRegister(REG_FSK_PACKETCONFIG1, regValue);
+        Radio_QueueRegister(REG_FSK_PACKETCONFIG2, 1 << SHIFT6);
 
         // Syncword value
-        for (i = 0; i < radioConfiguration.syncWordLen; i++)
+        // Take advantage of the fact that the SYNCVALUE registers are
+        // placed at sequential addresses
+        if (radioConfiguration.syncWordLen != 0)
         {
-            // Take advantage of the fact that the SYNCVALUE registers are
-            // placed at sequential addresses
-            RADIO_RegisterWrite(REG_FSK_SYNCVALUE1 + i, radioConfiguration.syncWord[i]);
+            Radio_WriteRegisters(REG_FSK_SYNCVALUE1, radioConfiguration.syncWord, radioConfiguration.syncWordLen);
         }
 
         // Enable sync word generation/detection if needed, Syncword size = syncWordLen + 1 bytes
         if (radioConfiguration.syncWordLen != 0)
         {
-            RADIO_RegisterWrite(REG_FSK_SYNCCONFIG, 0x10 | (radioConfiguration.syncWordLen - 1));
+            Radio_QueueRegister(REG_FSK_SYNCCONFIG, 0x10 | (radioConfiguration.syncWordLen - 1));
         } else
         {
-            RADIO_RegisterWrite(REG_FSK_SYNCCONFIG, 0x00);
+            Radio_QueueRegister(REG_FSK_SYNCCONFIG, 0x00);
         }
 
         // Clear all FSK interrupts (just in case)
-        RADIO_RegisterWrite(REG_FSK_IRQFLAGS1, 0xFF);
-        RADIO_RegisterWrite(REG_FSK_IRQFLAGS2, 0xFF);
+        Radio_QueueRegister(REG_FSK_IRQFLAGS1, 0xFF);
+        Radio_QueueRegister(REG_FSK_IRQFLAGS2, 0xFF);
     }
+
+    Radio_FlushRegisters();
 }
 
 /**
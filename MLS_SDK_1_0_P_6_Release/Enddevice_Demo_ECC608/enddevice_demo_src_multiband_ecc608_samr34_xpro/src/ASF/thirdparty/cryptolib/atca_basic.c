@@ -28,6 +28,7 @@
 
 
 #include "atca_basic.h"
+#include "atca_execution.h"
 #include "host/atca_host.h"
 
 const char atca_version[] = { "20181025" };  // change for each release, yyyymmdd
@@ -196,6 +197,21 @@ ATCA_STATUS atcab_sleep(void)
     return atsleep(_gDevice->mIface);
 }
 
+/** \brief keep the CryptoAuth device awake between the commands which follow,
+ *         or put it into the idle state again
+ *  \param[in] hold  true to keep the device awake, false to release it
+ *  \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atcab_hold_awake(bool hold)
+{
+    if (_gDevice == NULL)
+    {
+        return ATCA_GEN_FAIL;
+    }
+
+    return atca_execute_hold(_gDevice, hold);
+}
+
 
 /** \brief auto discovery of crypto auth devices
  *
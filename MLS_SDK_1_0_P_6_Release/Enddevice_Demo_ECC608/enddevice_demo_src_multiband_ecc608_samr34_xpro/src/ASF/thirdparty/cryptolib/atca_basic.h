@@ -61,6 +61,7 @@ ATCA_STATUS _atcab_exit(void);
 ATCA_STATUS atcab_wakeup(void);
 ATCA_STATUS atcab_idle(void);
 ATCA_STATUS atcab_sleep(void);
+ATCA_STATUS atcab_hold_awake(bool hold);
 ATCA_STATUS atcab_cfg_discover(ATCAIfaceCfg cfg_array[], int max);
 ATCA_STATUS atcab_get_addr(uint8_t zone, uint16_t slot, uint8_t block, uint8_t offset, uint16_t* addr);
 ATCA_STATUS atcab_get_zone_size(uint8_t zone, uint16_t slot, size_t* size);
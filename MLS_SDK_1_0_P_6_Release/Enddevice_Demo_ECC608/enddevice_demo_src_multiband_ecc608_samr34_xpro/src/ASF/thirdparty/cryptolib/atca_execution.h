@@ -60,6 +60,7 @@ ATCA_STATUS atGetExecTime(uint8_t opcode, ATCACommand ca_cmd);
 #endif
 
 ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device);
+ATCA_STATUS atca_execute_hold(ATCADevice device, bool hold);
 
 #ifdef __cplusplus
 }
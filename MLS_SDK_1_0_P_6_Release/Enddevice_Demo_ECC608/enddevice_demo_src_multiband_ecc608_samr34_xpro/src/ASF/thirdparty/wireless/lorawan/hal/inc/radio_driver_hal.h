@@ -44,6 +44,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /***************************************** MACROS *****************************/
 #define DIO0        0x01
@@ -59,6 +60,10 @@ extern "C" {
 /***************************************** TYPES ******************************/
 typedef void (*DioInterruptHandler_t)(void);
 
+/* Completion callback of an asynchronous frame transfer, called from the
+ * interrupt of the transfer with the chip select already released */
+typedef void (*RadioTransferDone_t)(void);
+
 typedef enum _RFCtrl1
 {
 	RFO_LF = 0,
@@ -132,6 +137,61 @@ void RADIO_FrameWrite(uint8_t offset, uint8_t* buffer, uint8_t bufferLen);
  */
 void RADIO_FrameRead(uint8_t offset, uint8_t* buffer, uint8_t bufferLen);
 
+/** 
+ * \brief This function is used to write consecutive radio registers in one
+ * SPI transaction, the radio increments the register address after each byte
+ * \param[in] reg First radio register to be written
+ * \param[in] buffer Pointer to the values to be written into the registers
+ * \param[in] bufferLen Number of registers to be written
+ */
+void RADIO_RegisterBurstWrite(uint8_t reg, uint8_t* buffer, uint8_t bufferLen);
+
+/** 
+ * \brief This function is used to read consecutive radio registers in one
+ * SPI transaction, the radio increments the register address after each byte
+ * \param[in] reg First radio register to be read
+ * \param[in] buffer Pointer to the data where the register values are stored
+ * \param[in] bufferLen Number of registers to be read
+ */
+void RADIO_RegisterBurstRead(uint8_t reg, uint8_t* buffer, uint8_t bufferLen);
+
+/** 
+ * \brief This function starts writing a stream of data into the Radio Frame
+ * buffer. With RADIO_SPI_DMA_ENABLE the data is moved by the DMA controller
+ * and the function returns at once, otherwise the data is written by polling
+ * and done is called before the function returns.
+ * \param[in] offset FIFO offset to be written to
+ * \param[in] buffer Pointer to the data to be written, it must stay valid
+ * until done is called
+ * \param[in] bufferLen Length of the data to be written
+ * \param[in] done Function called in interrupt context when the transfer is
+ * complete, may be NULL
+ * \retval true if the transfer is started, false if another one is ongoing
+ */
+bool RADIO_FrameWriteAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioTransferDone_t done);
+
+/** 
+ * \brief This function starts reading a stream of data from the Radio Frame
+ * buffer. With RADIO_SPI_DMA_ENABLE the data is moved by the DMA controller
+ * and the function returns at once, otherwise the data is read by polling
+ * and done is called before the function returns.
+ * \param[in] offset FIFO offset to be read from
+ * \param[in] buffer Pointer to the data where the data is stored, it must
+ * stay valid until done is called
+ * \param[in] bufferLen Length of the data to be read from the frame buffer
+ * \param[in] done Function called in interrupt context when the transfer is
+ * complete, may be NULL
+ * \retval true if the transfer is started, false if another one is ongoing
+ */
+bool RADIO_FrameReadAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioTransferDone_t done);
+
+/** 
+ * \brief This function is used to check for an ongoing asynchronous frame
+ * transfer. The other radio accesses wait for its end by themselves.
+ * \retval true if a transfer is ongoing
+ */
+bool RADIO_SpiBusy(void);
+
 /** 
  * \brief This function is used to enable DIO0 interrupt
  */
@@ -80,6 +80,12 @@ extern "C" {
 
 #define LORAWAN_SESSIONKEY_LENGTH					(16)
 
+/* Sizes of the airtime counters, see EnergyStats_t */
+#define LORAWAN_ENERGY_CHANNELS                 72
+#define LORAWAN_ENERGY_SUB_BANDS                8
+#define LORAWAN_ENERGY_TX_POWERS                16
+#define LORAWAN_ENERGY_PORTS                    4
+
 /***************************** TYPEDEFS ***************************************/
 
 /** Features Supported List */
@@ -420,6 +426,74 @@ typedef struct _TimeOnAirParams
     uint16_t preambleLen;
 } TimeOnAirParams_t;
 
+typedef struct _EarliestTxTimeParams
+{
+    uint8_t dr;
+    uint8_t length;
+} EarliestTxTimeParams_t;
+
+/* Counters of the record aggregation, read with the AGGREGATION_STATS attribute */
+typedef struct _AggregationStats
+{
+    /* Records and aggregated frames sent */
+    uint32_t records;
+    uint32_t frames;
+    /* Records of the frames which failed, expired or no longer fit the
+     * data rate */
+    uint32_t droppedRecords;
+    /* Time on air in us of the aggregated frames, and of the same records
+     * sent in frames of their own at the same data rates */
+    uint64_t airtime;
+    uint64_t separateAirtime;
+} AggregationStats_t;
+
+/* Airtime of the FPort, read with the ENERGY_STATS attribute */
+typedef struct _EnergyPortStats
+{
+    uint8_t port;
+    uint32_t frames;
+    /* Time on air in ms */
+    uint32_t txTime;
+} EnergyPortStats_t;
+
+/* Airtime and energy counters, read with the ENERGY_STATS attribute */
+typedef struct _EnergyStats
+{
+    /* Time on air in ms of the frames sent by channel index, sub-band and
+     * transmit power index. A frame is only counted by index in range. */
+    uint32_t channelTxTime[LORAWAN_ENERGY_CHANNELS];
+    uint32_t subBandTxTime[LORAWAN_ENERGY_SUB_BANDS];
+    uint32_t powerTxTime[LORAWAN_ENERGY_TX_POWERS];
+    /* Time on air of the first FPorts sent on, port 0 holds the join
+     * requests and the frames of MAC commands only, and of the other ports */
+    EnergyPortStats_t ports[LORAWAN_ENERGY_PORTS];
+    uint32_t otherPortsTxTime;
+    /* Frames sent, retransmissions included, and retransmissions */
+    uint32_t txFrames;
+    uint32_t retransmissions;
+    /* Time in us the transceiver spent transmitting, receiving (receive
+     * windows and Class C), in standby and asleep, and the TCXO was on */
+    uint64_t txTime;
+    uint64_t rxTime;
+    uint64_t standbyTime;
+    uint64_t sleepTime;
+    uint64_t tcxoTime;
+    /* Charge in nAh drawn by the transceiver and the TCXO, estimated with
+     * the ENERGY_CURRENTS table */
+    uint64_t charge;
+} EnergyStats_t;
+
+/* Supply currents in uA of the ENERGY_CURRENTS attribute */
+typedef struct _EnergyCurrents
+{
+    /* Transmit current by transmit power index */
+    uint32_t tx[LORAWAN_ENERGY_TX_POWERS];
+    uint32_t rx;
+    uint32_t standby;
+    uint32_t sleep;
+    uint32_t tcxo;
+} EnergyCurrents_t;
+
 /* List of LORAWAN attributes */
 typedef enum _LorawanAttributes
 {
@@ -568,15 +642,17 @@ typedef enum _LorawanAttributes
 	NEXT_PAYLOAD_SIZE,
 	/* Pending Join Back Off time */
 	PENDING_JOIN_DUTY_CYCLE_TIME,
-	/* Every-time the frame counter reaches the modulo of count value, 
-	 * the Frame counter will be updated in PDS.
-	 * For eg: if maxFcntPdsUpdateValue is 2 (default value), 
-	 * then every time (Frame counter % maxFcntPdsUpdateValue) == 0, 
-	 * Frame counter is stored in PDS.
-	 * Note: After reset of the device, the PDS restore of frame 
-	 * counters will increase the value to times equal to maxFcntPdsUpdateValue
-	 * For eg: If the current stored Frame counter in PDS is 10 and maxFcntPdsUpdateValue is 2,
-	 * then during restore operation, the new frame counter will be equal to 12
+	/* Number of uplink frame counters reserved by one update in PDS.
+	 * The PDS holds a ceiling of the uplink frame counter, the counter
+	 * resumes from it after a reset. When the counter goes past the
+	 * ceiling, a new ceiling (2 ^ maxFcntPdsUpdateValue) - 1 counters ahead
+	 * is stored, so the PDS is updated once every 2 ^ maxFcntPdsUpdateValue
+	 * uplinks and a reset skips up to as many counters.
+	 * For eg: if maxFcntPdsUpdateValue is 4 and the uplink frame counter
+	 * goes from 10 to 11 past a ceiling of 10, the ceiling 26 is stored;
+	 * after a reset at any counter up to 26 the counter resumes from 26.
+	 * The downlink frame counter is stored every time it reaches a
+	 * multiple of 2 ^ maxFcntPdsUpdateValue.
 	 * This value is used in terms of power of 2. The max value is 256 (2 ^ 8).
 	 */
 	MAX_FCNT_PDS_UPDATE_VAL,
@@ -595,7 +671,18 @@ typedef enum _LorawanAttributes
     /* If set, ED shall send LinkCheckReq cmd in next TX */
     SEND_LINK_CHECK_CMD,
     /* Returns the type of update used for join nonce */
-    JOIN_NONCE_TYPE
+    JOIN_NONCE_TYPE,
+    /* Returns the system time in us from which the duty cycle allows
+     * sending a frame of EarliestTxTimeParams_t length at its data rate,
+     * the current time if it is allowed now */
+    EARLIEST_TX_TIME,
+    /* Counters of the record aggregation, see AggregationStats_t */
+    AGGREGATION_STATS,
+    /* Airtime and energy counters since the last reset, see EnergyStats_t */
+    ENERGY_STATS,
+    /* Supply currents of the energy estimate, see EnergyCurrents_t. Also
+     * writable, the default values suit an SX1276 on the RFO output. */
+    ENERGY_CURRENTS
 } LorawanAttributes_t;
 
 /* Structure holding Receive window2 parameters*/
@@ -725,6 +812,117 @@ StackRetStatus_t LORAWAN_Join(ActivationType_t activationTypeNew);
 */
 StackRetStatus_t LORAWAN_Send (LorawanSendReq_t *lorasendreq);
 
+/**
+ * @Summary
+    Queues a frame for transmission.
+ * @Description
+    This function queues a send request instead of returning LORAWAN_BUSY while
+    a transaction is ongoing or while no channel is free. The MAC sends the
+    queued frames one after the other by decreasing priority, in order of
+    queuing for the same priority, each at the earliest time the duty cycle
+    allows (EARLIEST_TX_TIME). A frame refused for lack of a free channel, by
+    the duty cycle or by listen before talk, stays queued and is tried again.
+    The transaction complete callback is called for every queued frame with
+    the send request as application handle, so the request and its buffer
+    must be kept until then. A frame not sent within its lifetime is dropped
+    with the status LORAWAN_UPLINK_EXPIRED. When the queue is full, the oldest
+    frame of the lowest priority is dropped with LORAWAN_RESOURCE_UNAVAILABLE
+    if it has a lower priority than the new frame.
+ * @Preconditions
+    The network is joined
+ * @Param
+    lorasendreq - send request, see LORAWAN_Send
+    priority - the frames of higher priority are sent first
+    lifetimeMs - time in milliseconds the frame may wait in the queue, 0 for no limit
+ * @Returns
+    LORAWAN_SUCCESS, if the frame is queued
+    LORAWAN_NWK_NOT_JOINED, if the network is not joined
+    LORAWAN_INVALID_PARAMETER, if the request is NULL or the port is not valid
+    LORAWAN_INVALID_BUFFER_LENGTH, if the frame is longer than the maximum payload at the current data rate
+    LORAWAN_INVALID_REQUEST, if the request is already queued
+    LORAWAN_RESOURCE_UNAVAILABLE, if the queue is full with frames of the same or higher priority
+ * @Example
+    LorawanSendReq_t sensorReq = {.confirmed = LORAWAN_UNCNF, .port = 2, .buffer = reading, .bufferLength = sizeof(reading)};
+    LORAWAN_SendQueued(&sensorReq, 0, 600000);
+*/
+StackRetStatus_t LORAWAN_SendQueued (LorawanSendReq_t *lorasendreq, uint8_t priority, uint32_t lifetimeMs);
+
+/**
+ * @Summary
+    Empties the uplink queue.
+ * @Description
+    This function drops the queued frames which are not handed to the MAC yet,
+    with the status LORAWAN_UPLINK_EXPIRED. A frame already being sent
+    completes its transaction.
+ * @Preconditions
+    None
+ * @Param
+    None
+ * @Returns
+    None
+ * @Example
+*/
+void LORAWAN_FlushQueue (void);
+
+/**
+ * @Summary
+    Aggregates an application record into a frame.
+ * @Description
+    This function appends a record to the aggregated frame of the port. The
+    records are concatenated as they are, the application on the server must
+    be able to split them. The frame is handed to the uplink queue (see
+    LORAWAN_SendQueued) when the next record does not fit the largest payload
+    of the current data rate beside the pending MAC answers, when a record of
+    another port is aggregated, or at once for a record of priority
+    LORAWAN_AGGREGATION_FLUSH_PRIORITY or above. Once its first record is
+    LORAWAN_AGGREGATION_MAX_AGE_MS old, the frame is handed to the queue as
+    soon as the queue is empty and the duty cycle allows sending it, it takes
+    more records until then. A frame which no longer fits the largest payload
+    because the data rate dropped is discarded when it is handed to the queue,
+    its records are counted in droppedRecords of AGGREGATION_STATS and the
+    record is aggregated into a new frame. The frame is queued with the
+    highest priority of its records and sent unconfirmed. The transaction
+    complete callback is called for every aggregated frame, with a send
+    request of the MAC holding the records as application handle.
+ * @Preconditions
+    The network is joined
+ * @Param
+    port - application port of the record
+    record - record to be sent, copied
+    length - length of the record
+    priority - priority of the record, see LORAWAN_SendQueued
+ * @Returns
+    LORAWAN_SUCCESS, if the record is aggregated
+    LORAWAN_NWK_NOT_JOINED, if the network is not joined
+    LORAWAN_INVALID_PARAMETER, if the record is NULL, empty or the port is not valid
+    LORAWAN_INVALID_BUFFER_LENGTH, if the record does not fit a frame at the current data rate
+    LORAWAN_BUSY, if all the aggregated frames are still being sent
+    LORAWAN_RESOURCE_UNAVAILABLE, if the uplink queue refuses a full frame
+ * @Example
+    uint8_t sample[4] = {0x01, 0x67, 0x00, 0xE1};
+    LORAWAN_AggregateRecord(2, sample, sizeof(sample), 0);
+*/
+StackRetStatus_t LORAWAN_AggregateRecord (uint8_t port, uint8_t *record, uint8_t length, uint8_t priority);
+
+/**
+ * @Summary
+    Sends the aggregated records.
+ * @Description
+    This function hands the aggregated frame to the uplink queue without
+    waiting for it to be full or old enough.
+ * @Preconditions
+    None
+ * @Param
+    None
+ * @Returns
+    LORAWAN_SUCCESS, if the frame is queued or there is no record
+    LORAWAN_INVALID_BUFFER_LENGTH, if the frame no longer fits the current data
+    rate, it is discarded and its records are counted as dropped
+    LORAWAN_RESOURCE_UNAVAILABLE, if the uplink queue refuses the frame
+ * @Example
+*/
+StackRetStatus_t LORAWAN_FlushRecords (void);
+
 /**
  * @Summary
     Function pauses LoRaWAN stack.
@@ -829,6 +1027,50 @@ StackRetStatus_t LORAWAN_SetAttr(LorawanAttributes_t attrType, void *attrValue);
 */
 StackRetStatus_t LORAWAN_GetAttr(LorawanAttributes_t attrType, void *attrInput, void *attrOutput);
 
+/**
+ * @Summary
+    LORAWAN Get Time On Air
+ * @Description
+    This function returns the time on air of a packet sent at a data rate of
+    the current band with the given payload length. It is computed in integer
+    arithmetic and is also returned by the PACKET_TIME_ON_AIR attribute.
+ * @Preconditions
+    None
+ * @Param
+    params    - data rate, coding rate, header mode, CRC, preamble length (symbols) and payload length
+	timeOnAir - pointer to the time on air in microseconds
+ * @Returns
+    LORAWAN_SUCCESS, if the time on air is computed
+    LORAWAN_INVALID_PARAMETER, if the data rate or the coding rate is invalid
+ * @Example
+ *  TimeOnAirParams_t toa = {.dr = DR0, .cr = CR_4_5, .crcOn = 1, .preambleLen = 8, .pktLen = 51};
+ *  uint32_t timeOnAir;
+ *  LORAWAN_GetTimeOnAir(&toa, &timeOnAir);
+*/
+StackRetStatus_t LORAWAN_GetTimeOnAir(TimeOnAirParams_t *params, uint32_t *timeOnAir);
+
+/**
+ * @Summary
+    LORAWAN Get Payload Length For Time On Air
+ * @Description
+    This function returns the longest payload whose packet is sent within the
+    given time on air, so that the application can size its payload against
+    the duty cycle budget. The pktLen member of params is not used.
+ * @Preconditions
+    None
+ * @Param
+    params    - data rate, coding rate, header mode, CRC and preamble length (symbols)
+	timeOnAir - time on air budget in microseconds
+	length    - pointer to the payload length in bytes, at most 255
+ * @Returns
+    LORAWAN_SUCCESS, if the length is computed
+    LORAWAN_INVALID_PARAMETER, if the data rate or the coding rate is invalid or
+    if not even an empty payload fits the time on air
+ * @Example
+*/
+StackRetStatus_t LORAWAN_GetPayloadLengthForTimeOnAir(TimeOnAirParams_t *params,
+    uint32_t timeOnAir, uint8_t *length);
+
 /**
  * @Summary
     LoRaWAN Set Callback Bit mask function.
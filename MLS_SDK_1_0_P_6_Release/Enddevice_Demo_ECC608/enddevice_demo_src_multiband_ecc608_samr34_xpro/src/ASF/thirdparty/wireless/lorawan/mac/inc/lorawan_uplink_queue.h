@@ -0,0 +1,72 @@
+/**
+* \file  lorawan_uplink_queue.h
+*
+* \brief LoRaWAN header file for the uplink queue
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+#ifndef _LORAWAN_UPLINK_QUEUE_H_
+#define _LORAWAN_UPLINK_QUEUE_H_
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+
+/*********************************************************************//**
+\brief	Uplink queue - drops the queued frames without any callback and
+        stops the queue timer
+
+\return					- none.
+*************************************************************************/
+void LorawanUplinkQueueInit(void);
+
+/*********************************************************************//**
+\brief	Called when a transaction completes, before the application is
+        informed. A queued frame refused for lack of a free channel is
+        kept queued.
+\param[in]  status - status of the transaction
+\return	    true, if the transaction was the one of a queued frame kept
+            queued and the application is not to be informed
+            false, otherwise
+*************************************************************************/
+bool LorawanUplinkQueueTransactionDone(StackRetStatus_t status);
+
+/*********************************************************************//**
+\brief	Schedules the release of the next queued frame, once the current
+        transaction is over and the duty cycle allows it
+
+\return					- none.
+*************************************************************************/
+void LorawanUplinkQueueSchedule(void);
+
+#endif // _LORAWAN_UPLINK_QUEUE_H_
+
+//eof lorawan_uplink_queue.h
@@ -0,0 +1,318 @@
+/**
+* \file  lorawan_aggregation.c
+*
+* \brief LoRaWAN file for aggregating the application records
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+/****************************** INCLUDES **************************************/
+#include "conf_stack.h"
+#include "lorawan.h"
+#include "lorawan_defs.h"
+#include "lorawan_private.h"
+#include "lorawan_aggregation.h"
+#include "lorawan_uplink_queue.h"
+#include "radio_interface.h"
+#include "sw_timer.h"
+
+/******************* EXTERN DEFINITIONS *************************************/
+extern LoRa_t loRa;
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+static LorawanAggregationFrame_t *AggregationGetFrame(LorawanAggregationFrameState_t state);
+static StackRetStatus_t AggregationFlush(LorawanAggregationFrame_t *frame);
+static uint32_t AggregationAirtime(uint8_t length);
+
+/*********************** FUNCTION DEFINITIONS *********************************/
+
+/*********************************************************************//**
+\brief	Record aggregation - drops the aggregated records without any
+        callback and clears the counters
+*************************************************************************/
+void LorawanAggregationInit(void)
+{
+	memset(&loRa.aggregation, 0, sizeof(loRa.aggregation));
+	loRa.aggregation.flushTime = UINT64_MAX;
+}
+
+/*********************************************************************//**
+\brief	Aggregates an application record into a frame, see lorawan.h
+*************************************************************************/
+StackRetStatus_t LORAWAN_AggregateRecord (uint8_t port, uint8_t *record, uint8_t length, uint8_t priority)
+{
+	LorawanAggregationFrame_t *frame;
+	StackRetStatus_t status;
+	uint8_t capacity;
+
+	if (loRa.macStatus.networkJoined == DISABLED)
+	{
+		return LORAWAN_NWK_NOT_JOINED;
+	}
+
+	if ((NULL == record) || (0 == length) || (port < FPORT_MIN) || (port > LORAWAN_TEST_PORT))
+	{
+		return LORAWAN_INVALID_PARAMETER;
+	}
+
+	/* Largest payload of the current data rate beside the MAC answers */
+	capacity = LorawanGetFreePayloadSize(loRa.currentDataRate);
+	if (capacity > LORAWAN_AGGREGATION_BUFFER_SIZE)
+	{
+		capacity = LORAWAN_AGGREGATION_BUFFER_SIZE;
+	}
+	if (length > capacity)
+	{
+		return LORAWAN_INVALID_BUFFER_LENGTH;
+	}
+
+	frame = AggregationGetFrame(AGGREGATION_FRAME_OPEN);
+	if ((NULL != frame) && ((frame->sendReq.port != port) ||
+		((frame->sendReq.bufferLength + length) > capacity)))
+	{
+		status = AggregationFlush(frame);
+		if ((LORAWAN_SUCCESS != status) && (AGGREGATION_FRAME_OPEN == frame->state))
+		{
+			return status;
+		}
+		/* Queued, or dropped if it no longer fits the data rate */
+		frame = NULL;
+	}
+
+	if (NULL == frame)
+	{
+		frame = AggregationGetFrame(AGGREGATION_FRAME_FREE);
+		if (NULL == frame)
+		{
+			return LORAWAN_BUSY;
+		}
+
+		frame->state = AGGREGATION_FRAME_OPEN;
+		frame->sendReq.confirmed = LORAWAN_UNCNF;
+		frame->sendReq.port = port;
+		frame->sendReq.buffer = frame->buffer;
+		frame->sendReq.bufferLength = 0;
+		frame->records = 0;
+		frame->priority = 0;
+		frame->separateAirtime = 0;
+		loRa.aggregation.flushTime = SwTimerGetTime() + MS_TO_US((uint64_t)LORAWAN_AGGREGATION_MAX_AGE_MS);
+	}
+
+	memcpy(&frame->buffer[frame->sendReq.bufferLength], record, length);
+	frame->sendReq.bufferLength += length;
+	frame->records++;
+	frame->separateAirtime += AggregationAirtime(length);
+	if (priority > frame->priority)
+	{
+		frame->priority = priority;
+	}
+
+	if ((priority >= LORAWAN_AGGREGATION_FLUSH_PRIORITY) || (frame->sendReq.bufferLength == capacity))
+	{
+		if ((LORAWAN_SUCCESS != AggregationFlush(frame)) && (AGGREGATION_FRAME_OPEN == frame->state))
+		{
+			/* The record is kept, the frame is queued again later */
+			loRa.aggregation.flushTime = SwTimerGetTime() + MS_TO_US(LORAWAN_UPLINK_QUEUE_RETRY_MS);
+		}
+	}
+
+	/* The age of the open frame is watched by the uplink queue timer */
+	LorawanUplinkQueueSchedule();
+
+	return LORAWAN_SUCCESS;
+}
+
+/*********************************************************************//**
+\brief	Sends the aggregated records, see lorawan.h
+*************************************************************************/
+StackRetStatus_t LORAWAN_FlushRecords (void)
+{
+	LorawanAggregationFrame_t *frame = AggregationGetFrame(AGGREGATION_FRAME_OPEN);
+
+	if (NULL == frame)
+	{
+		return LORAWAN_SUCCESS;
+	}
+	return AggregationFlush(frame);
+}
+
+/*********************************************************************//**
+\brief	Returns the time the open frame is queued at
+*************************************************************************/
+uint64_t LorawanAggregationFlushTime(void)
+{
+	return loRa.aggregation.flushTime;
+}
+
+/*********************************************************************//**
+\brief	Queues the open frame if it is old enough, once the uplink queue is
+        empty and the duty cycle allows sending it
+\param[in]  now - system time in us
+*************************************************************************/
+void LorawanAggregationFlushDue(uint64_t now)
+{
+	LorawanAggregationFrame_t *frame;
+	EarliestTxTimeParams_t txParams;
+	uint64_t earliestTxTime;
+
+	/* The open frame takes records until it can be sent */
+	if ((loRa.aggregation.flushTime > now) || (0 != loRa.uplinkQueue.count))
+	{
+		return;
+	}
+
+	frame = AggregationGetFrame(AGGREGATION_FRAME_OPEN);
+	if (NULL == frame)
+	{
+		loRa.aggregation.flushTime = UINT64_MAX;
+		return;
+	}
+
+	txParams.dr = loRa.currentDataRate;
+	txParams.length = frame->sendReq.bufferLength;
+	if ((LORAWAN_SUCCESS == LORAWAN_GetAttr(EARLIEST_TX_TIME, &txParams, &earliestTxTime)) &&
+		(earliestTxTime > now))
+	{
+		loRa.aggregation.flushTime = earliestTxTime;
+	}
+	else if ((LORAWAN_SUCCESS != AggregationFlush(frame)) && (AGGREGATION_FRAME_OPEN == frame->state))
+	{
+		loRa.aggregation.flushTime = now + MS_TO_US(LORAWAN_UPLINK_QUEUE_RETRY_MS);
+	}
+}
+
+/*********************************************************************//**
+\brief	Frees an aggregated frame which left the uplink queue and counts
+        it if it is sent
+\param[in]  sendReq - send request of the frame
+\param[in]  status - status of the transaction of the frame
+*************************************************************************/
+void LorawanAggregationFrameDone(LorawanSendReq_t *sendReq, StackRetStatus_t status)
+{
+	LorawanAggregation_t *aggregation = &loRa.aggregation;
+
+	for (uint8_t index = 0; index < LORAWAN_AGGREGATION_FRAMES; index++)
+	{
+		LorawanAggregationFrame_t *frame = &aggregation->frames[index];
+
+		if ((AGGREGATION_FRAME_QUEUED == frame->state) && (&frame->sendReq == sendReq))
+		{
+			if (LORAWAN_SUCCESS == status)
+			{
+				aggregation->stats.records += frame->records;
+				aggregation->stats.frames++;
+				aggregation->stats.airtime += frame->airtime;
+				aggregation->stats.separateAirtime += frame->separateAirtime;
+			}
+			else
+			{
+				aggregation->stats.droppedRecords += frame->records;
+			}
+			frame->state = AGGREGATION_FRAME_FREE;
+			return;
+		}
+	}
+}
+
+/*********************************************************************//**
+\brief	Finds an aggregated frame in a state
+\param[in]  state - state of the frame
+\return	    the first frame in this state, NULL if none
+*************************************************************************/
+static LorawanAggregationFrame_t *AggregationGetFrame(LorawanAggregationFrameState_t state)
+{
+	for (uint8_t index = 0; index < LORAWAN_AGGREGATION_FRAMES; index++)
+	{
+		if (state == loRa.aggregation.frames[index].state)
+		{
+			return &loRa.aggregation.frames[index];
+		}
+	}
+	return NULL;
+}
+
+/*********************************************************************//**
+\brief	Hands the open frame to the uplink queue
+\param[in]  frame - open frame
+\return	    status of LORAWAN_SendQueued, the frame stays open on failure
+            but for LORAWAN_INVALID_BUFFER_LENGTH: the data rate dropped
+            since the frame was filled, it is freed and its records are
+            counted as dropped
+*************************************************************************/
+static StackRetStatus_t AggregationFlush(LorawanAggregationFrame_t *frame)
+{
+	uint64_t flushTime = loRa.aggregation.flushTime;
+	StackRetStatus_t status;
+
+	/* Set before queuing, the queue timer is armed from within */
+	frame->state = AGGREGATION_FRAME_QUEUED;
+	frame->airtime = AggregationAirtime(frame->sendReq.bufferLength);
+	loRa.aggregation.flushTime = UINT64_MAX;
+
+	status = LORAWAN_SendQueued(&frame->sendReq, frame->priority, 0);
+	if (LORAWAN_INVALID_BUFFER_LENGTH == status)
+	{
+		/* Retrying would never succeed and block the aggregation */
+		loRa.aggregation.stats.droppedRecords += frame->records;
+		frame->state = AGGREGATION_FRAME_FREE;
+	}
+	else if (LORAWAN_SUCCESS != status)
+	{
+		frame->state = AGGREGATION_FRAME_OPEN;
+		loRa.aggregation.flushTime = flushTime;
+	}
+	return status;
+}
+
+/*********************************************************************//**
+\brief	Time on air of a frame without FOpts at the current data rate, the
+        data rate of the frame unless ADR changes it while queued
+\param[in]  length - length of the FRMPayload
+\return	    time on air in us, 0 if the data rate is not known
+*************************************************************************/
+static uint32_t AggregationAirtime(uint8_t length)
+{
+	TimeOnAirParams_t params;
+	uint32_t timeOnAir = 0;
+
+	params.dr = loRa.currentDataRate;
+	params.impHdrMode = 0;
+	params.crcOn = 1;
+	params.cr = CR_4_5;
+	params.pktLen = HDRS_MIC_PORT_MIN_SIZE + length;
+	params.preambleLen = RADIO_PHY_PREAMBLE_LENGTH;
+	LORAWAN_GetTimeOnAir(&params, &timeOnAir);
+
+	return timeOnAir;
+}
+
+/* eof lorawan_aggregation.c */
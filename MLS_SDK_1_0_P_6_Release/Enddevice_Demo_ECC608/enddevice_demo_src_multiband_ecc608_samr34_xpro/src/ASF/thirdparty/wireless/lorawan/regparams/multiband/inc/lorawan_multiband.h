@@ -71,29 +71,27 @@
 #define NUM_CHANNEL_GW_SUPPORTED            64
 #endif
 
+/*
+* The duty cycle needs no timer, the time from which each sub-band and the
+* aggregated duty cycle allow the next transmission is kept as system time.
+*/
 #if (JPN_BAND == 1) || (KR_BAND == 1)
 /*
-* JPN923 falls under AS923 region, so it has duty cycle support.
-* Also, JPN923 has LBT support. Since, both feature require a timer
-* for each, it needs 2 timers.
+* JPN923 and KR920 have LBT support, which requires a timer.
 * Specifically...
 * regTimerId[0] --> LBT timer
-* regTimerId[1] --> Dutycycle Timer
-* regTimerId[2] --> Join backoff timer
-* regTimerId[3] --> Join dutycycle timer
-* dutycycle timer might get added
+* regTimerId[1] --> Join backoff timer
+* regTimerId[2] --> Join dutycycle timer
 */
-#define REG_PARAMS_TIMERS_COUNT                 (4u)
+#define REG_PARAMS_TIMERS_COUNT                 (3u)
 #else
 /*
-* Bands (KR, AS, EU) other than JPN923 uses 1 timer from regional params.
+* Bands other than JPN923 and KR920 use 2 timers from regional params.
 * Specifically...
-* In KR920, regTimerId[0] --> LBT timer
-* In EU and AS, regTimerId[0] --> duty cycle timer
-* regTimerId[1] -->Join backoff timer
-* regTimerId[2] -->Join dutycycle timer
+* regTimerId[0] -->Join backoff timer (Join dutycycle timer in IND865)
+* regTimerId[1] -->Join dutycycle timer (Join backoff timer in IND865)
 */
-#define REG_PARAMS_TIMERS_COUNT                 (3u)
+#define REG_PARAMS_TIMERS_COUNT                 (2u)
 #endif
 
 /**************************Band wise macros ******************************************/
@@ -735,6 +733,8 @@ COMPILER_PACK_SET(1)
 
 #define MAX_DRPARAMS_T1                         MAX_DRPARAMS_NA
 #define MAX_CHANNELS_T1                         MAX_CHANNELS_NA
+/* Highest Tx data rate of the NA and AU bands (DR6 in AU) */
+#define MAX_TXDR_T1                             DR6
 
 #define MAX_DRPARAMS_T2                         MAX_DRPARAMS_EU
 #define MAX_CHANNELS_T2                         MAX_CHANNELS_EU
@@ -782,14 +782,6 @@ typedef struct _RegPdsItems
     uint16_t band_item_id;
 }RegPdsItems_t;
 #endif
-/*This Structure stores dutycycle timer related information*/
-typedef struct _DutyCycleTimer
-{
-    /* Duty cycle timers last value */
-    uint32_t lastTimerValue;
-    /* The unique Id given to the timer */
-    uint8_t timerId;
-}    DutyCycleTimer_t;
 /*This Structure stores Joinreq dutycycle timer related information*/
 typedef struct _JoinDutyCycleTimer
 {
@@ -822,8 +814,8 @@ typedef struct _SubBandParams
     uint32_t freqMin;
     /*End of Frequency Range of the Subband*/
     uint32_t freqMax;
-    /*Time left for the subband to be available for next transmission*/
-    uint32_t subBandTimeout;
+    /*System time in us from which the subband is available for next transmission*/
+    uint64_t availableAt;
 }SubBandParams_t;
 
 typedef struct _channelParams
@@ -868,6 +860,15 @@ typedef struct _DRParams
     RadioModulation_t modulation;
 } DRParams_t;
 
+/* Bit mask of the NA and AU channels, one bit per channel id */
+typedef struct _ChannelMask
+{
+    /* Channels 0 to 63 of 125 kHz */
+    uint64_t ch125;
+    /* Channels 64 to 71 of 500 kHz */
+    uint8_t ch500;
+} ChannelMask_t;
+
 typedef struct _RegParamsType1
 {
     DRParams_t DRParams[MAX_DRPARAMS_T1];
@@ -886,7 +887,10 @@ typedef struct _RegParamsType1
     uint8_t alternativeChannel;
 	/* Used to store the sub-band from which the channel is used for Transmission */
 	uint8_t lastUsedSB;
-	DutyCycleTimer_t DutyCycleTimer;
+	/* Channels enabled, follows the status in chParams */
+	ChannelMask_t enabledChMask;
+	/* Channels whose data range holds each of the Tx data rates */
+	ChannelMask_t drChMask[MAX_TXDR_T1 + 1];
 }RegParamsType1_t;
 
 typedef struct _RegParamsType2
@@ -894,7 +898,6 @@ typedef struct _RegParamsType2
     DRParams_t DRParams[MAX_DRPARAMS_T2];
     ChannelParams_t chParams[MAX_CHANNELS_T2];
     OthChannelParams_t othChParams[MAX_CHANNELS_T2];
-    DutyCycleTimer_t DutyCycleTimer;
 	uint32_t channelTimer[MAX_CHANNELS_T2]; /* LBT Channel timer array */
     LBTTimer_t LBTTimer;
     /*DutyCycle multiplier calculated based on the regulatory defined DutyCycle*/
@@ -923,7 +926,6 @@ typedef struct _RegParams
     ChannelParams_t *pChParams;
     OthChannelParams_t *pOtherChParams;
     SubBandParams_t *pSubBandParams;
-    DutyCycleTimer_t *pDutyCycleTimer;
 	JoinDutyCycleTimer_t *pJoinDutyCycleTimer;
 	JoinBackoffTimer_t *pJoinBackoffTimer;
     uint32_t DefRx2Freq;
@@ -950,7 +952,8 @@ typedef struct _RegParams
     //TXPower_t txPower[MAX_TX_PWR_CNT];
     /*The last channel which was used for transmission is used here*/
     uint8_t lastUsedChannelIndex;
-    uint32_t aggregatedDutyCycleTimeout;
+    /*System time in us from which the aggregated duty cycle allows the next transmission*/
+    uint64_t aggregatedAvailableAt;
 	JoinDutyCycleTimer_t joinDutyCycleTimer;
 	JoinBackoffTimer_t joinBackoffTimer;
 	/* Join request dutycycle timeout*/
@@ -1000,6 +1003,7 @@ void InitDefault920Channels (void);
 void InitDefault923Channels (void);
 void InitDefault920ChannelsKR (void);
 void Enableallchannels(void);
+void Init915ChannelMasks(void);
 
 void LORAREG_InitSetAttrFnPtrsNA(void);
 void LORAREG_InitSetAttrFnPtrsEU(void);
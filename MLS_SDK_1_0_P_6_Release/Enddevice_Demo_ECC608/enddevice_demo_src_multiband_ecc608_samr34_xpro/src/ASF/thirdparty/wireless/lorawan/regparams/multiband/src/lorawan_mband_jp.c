@@ -129,7 +129,6 @@ StackRetStatus_t LORAReg_InitJP(IsmBand_t ismBand)
 	RegParams.pDrParams = &RegParams.cmnParams.paramsType2.DRParams[0];
 	RegParams.pSubBandParams = &RegParams.cmnParams.paramsType2.SubBands[0];
 	RegParams.pOtherChParams = &RegParams.cmnParams.paramsType2.othChParams[0];
-	RegParams.pDutyCycleTimer = &RegParams.cmnParams.paramsType2.DutyCycleTimer;
     RegParams.pJoinDutyCycleTimer = &RegParams.joinDutyCycleTimer;
 	RegParams.pJoinBackoffTimer = &RegParams.joinBackoffTimer;
 	RegParams.DefRx1DataRate = MAC_RX1_WINDOW_DATARATE_JP;
@@ -148,16 +147,15 @@ StackRetStatus_t LORAReg_InitJP(IsmBand_t ismBand)
 	RegParams.defTxPwrIndx = MAC_DEF_TX_POWER_JP;
 	RegParams.maxTxPwr = DEFAULT_EIRP_JP;
 	RegParams.cmnParams.paramsType2.LBTTimer.timerId = regTimerId[0];
-	RegParams.pDutyCycleTimer->timerId = regTimerId[1];
-	RegParams.pJoinBackoffTimer->timerId = regTimerId[2];
-    RegParams.pJoinDutyCycleTimer->timerId = regTimerId[3];
+	RegParams.pJoinBackoffTimer->timerId = regTimerId[1];
+    RegParams.pJoinDutyCycleTimer->timerId = regTimerId[2];
 	RegParams.pJoinDutyCycleTimer->remainingtime =0;
 	RegParams.joinbccount =0;
 	RegParams.joinDutyCycleTimeout =0;
 	RegParams.cmnParams.paramsType2.txParams.uplinkDwellTime = 1;
 	RegParams.cmnParams.paramsType2.txParams.downlinkDwellTime = 1;
 	RegParams.band = ismBand;
-	RegParams.aggregatedDutyCycleTimeout = 0;
+	RegParams.aggregatedAvailableAt = 0;
 	if(ismBand == ISM_JPN923)
 	{
 		InitDefault920Channels();
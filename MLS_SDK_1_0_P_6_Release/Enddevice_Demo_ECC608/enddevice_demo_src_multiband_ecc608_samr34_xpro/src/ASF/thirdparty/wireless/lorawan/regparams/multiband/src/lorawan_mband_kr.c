@@ -111,7 +111,6 @@ StackRetStatus_t LORAReg_InitKR(IsmBand_t ismBand)
 	RegParams.pChParams = &RegParams.cmnParams.paramsType2.chParams[0];
 	RegParams.pDrParams = &RegParams.cmnParams.paramsType2.DRParams[0];
 	RegParams.pOtherChParams = &RegParams.cmnParams.paramsType2.othChParams[0];
-	RegParams.pDutyCycleTimer = &RegParams.cmnParams.paramsType2.DutyCycleTimer;
     RegParams.pJoinDutyCycleTimer = &RegParams.joinDutyCycleTimer;
 	RegParams.pJoinBackoffTimer = &RegParams.joinBackoffTimer;
 	RegParams.DefRx1DataRate = MAC_RX1_WINDOW_DATARATE_KR;
@@ -132,11 +131,10 @@ StackRetStatus_t LORAReg_InitKR(IsmBand_t ismBand)
 	RegParams.cmnParams.paramsType2.LBTTimer.timerId = regTimerId[0];
 	RegParams.pJoinBackoffTimer->timerId = regTimerId[1];
     RegParams.pJoinDutyCycleTimer->timerId = regTimerId[2];
-	RegParams.pDutyCycleTimer->timerId = regTimerId[3];
 	RegParams.pJoinDutyCycleTimer->remainingtime =0;
 	RegParams.joinbccount =0;
 	RegParams.joinDutyCycleTimeout =0;
-	RegParams.aggregatedDutyCycleTimeout = 0;	
+	RegParams.aggregatedAvailableAt = 0;	
 	RegParams.band = ismBand;
 	
 	if(ismBand == ISM_KR920)
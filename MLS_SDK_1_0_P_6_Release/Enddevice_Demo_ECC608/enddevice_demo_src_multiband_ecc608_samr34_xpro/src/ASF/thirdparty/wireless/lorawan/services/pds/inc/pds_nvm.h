@@ -60,6 +60,22 @@
 #define EEPROM_ROW_SIZE         (EEPROM_PAGE_SIZE*EEPROM_PAGE_PER_ROW)
 #define EEPROM_NUM_ROWS         (EEPROM_SIZE/EEPROM_ROW_SIZE)
 
+/* CRC engines of the PDS rows, selected by defining PDS_CRC_ENGINE to one of
+ * them:
+ * PDS_CRC_BITWISE - CRC-16 CCITT computed bit by bit, no table
+ * PDS_CRC_TABLE   - the same CRC-16 with a table of 512 bytes
+ * PDS_CRC_DSU     - CRC-32 of the Device Service Unit, computed in software
+ *                   where the DSU is not available
+ * The engine of a row is recorded by the version of its header, rows written
+ * by any engine are verified by all of them. */
+#define PDS_CRC_BITWISE         1
+#define PDS_CRC_TABLE           2
+#define PDS_CRC_DSU             3
+
+#ifndef PDS_CRC_ENGINE
+#define PDS_CRC_ENGINE          PDS_CRC_TABLE
+#endif
+
 
 /******************************************************************************
                                Types section
@@ -115,6 +131,39 @@ PdsStatus_t pdsNvmErase(uint16_t rowId);
 ******************************************************************************/
 PdsStatus_t pdsNvmEraseAll(void);
 
+/**************************************************************************//**
+\brief	Programs data into the erased part of a row, without erasing it. Only
+		the pages the data falls into are programmed.
+
+\param[in] 	rowId - The row to be programmed.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	data - The data to be programmed.
+\param[in] 	size - The size of the data.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsNvmProgram(uint16_t rowId, uint16_t offset, uint8_t *data, uint16_t size);
+
+/**************************************************************************//**
+\brief	Reads bytes of a row as they are, without a PDS header or CRC check.
+
+\param[in] 	rowId - The row to be read.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	data - The buffer for the data read.
+\param[in] 	size - The number of bytes to read.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsNvmReadBytes(uint16_t rowId, uint16_t offset, uint8_t *data, uint16_t size);
+
+/**************************************************************************//**
+\brief	Continues a CRC-16 in CCITT polynome over the given data.
+
+\param[in] 	crc - The CRC so far, 0 to start.
+\param[in] 	data - The data.
+\param[in] 	length - The amount of data.
+\param[out] uint16_t - The calculated 16 bit CRC.
+******************************************************************************/
+uint16_t pdsNvmCrc(uint16_t crc, uint8_t *data, uint16_t length);
+
 #endif  /* _PDS_NVM_H_ */
 
 /* eof pds_nvm.h */
\ No newline at end of file
@@ -41,21 +41,27 @@
                    Includes section
 ******************************************************************************/
 #include "system_task_manager.h"
+#include "system_trace.h"
+#include "sw_timer.h"
 #include "pds_interface.h"
 #include "pds_common.h"
 #include "pds_task_handler.h"
 #include "pds_wl.h"
-#include "atomic.h"
+#include "pds_log.h"
 #include <stdint.h>
 
 /************************************************************************/
-/*  Static variables                                                    */
+/*  Defines                                                             */
 /************************************************************************/
+/* PDS subtasks occupy consecutive scheduler slots from SYSTEM_PDS_TASK_IDX */
+#if (PDS_TASKS_COUNT > (SYSTEM_APP_TASK_IDX - SYSTEM_PDS_TASK_IDX))
+#error "PDS subtasks exceed the scheduler slots of the PDS layer"
+#endif
 
-/**************************************************************************//**
-\brief pdsTaskFlags - 8-bit bitmap for the tasks of PDS layer.
-******************************************************************************/
-static volatile uint8_t pdsTaskFlags = 0x0000u;
+#define PDS_TASKS_MASK    ((SYSTEM_TaskMask_t)((1u << PDS_TASKS_COUNT) - 1u))
+
+/* No timer of deferred writes created */
+#define PDS_WRITE_TIMER_INVALID    0xFFu
 
 /************************************************************************/
 /*  Extern variables                                                    */
@@ -63,23 +69,31 @@ static volatile uint8_t pdsTaskFlags = 0x0000u;
 extern bool isFileSet[];
 extern PdsFileMarks_t fileMarks[];
 
+/************************************************************************/
+/*  Static variables                                                    */
+/************************************************************************/
+#if (ENABLE_PDS == 1)
+/* A file is being written, a flush must not break in */
+static volatile bool pdsWriting = false;
+#if (PDS_WRITE_DELAY_MS > 0)
+static uint8_t pdsWriteTimerId = PDS_WRITE_TIMER_INVALID;
+#endif
+#endif
+
 /******************************************************************************
                    Prototypes section
 ******************************************************************************/
 #if (ENABLE_PDS == 1)
 static SYSTEM_TaskStatus_t pdsStoreDeleteHandler(void);
+static PdsStatus_t pdsWriteFile(PdsFileItemIdx_t fileId);
+#if (PDS_WRITE_DELAY_MS > 0)
+static void pdsWriteTimerCallback(void *param);
+#endif
+#ifdef PDS_LOG_ENABLE
+static PdsStatus_t pdsStoreDeleteItems(PdsFileItemIdx_t pdsFileItemIdx);
+#else
 static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buffer);
 #endif
-
-/**************************************************************************//**
-\brief Array of pds task handlers.
-******************************************************************************/
-#if (ENABLE_PDS == 1)
-static SYSTEM_TaskStatus_t (*pdsTaskHandlers[PDS_TASKS_COUNT])(void) = {
-	
-    /* In the order of descending priority */
-    pdsStoreDeleteHandler
-};
 #endif
 
 /******************************************************************************
@@ -92,12 +106,8 @@ static SYSTEM_TaskStatus_t (*pdsTaskHandlers[PDS_TASKS_COUNT])(void) = {
 ******************************************************************************/
 void pdsPostTask(PdsTaskIds_t id)
 {
-    ATOMIC_SECTION_ENTER
-    pdsTaskFlags |= id;
-    ATOMIC_SECTION_EXIT
-
-    /* Also post a PDS task to the system */
-    SYSTEM_PostTask(PDS_TASK_ID);
+    /* Each PDS subtask is dispatched directly by the system scheduler */
+    SYSTEM_PostTask(((SYSTEM_TaskMask_t)id & PDS_TASKS_MASK) << SYSTEM_PDS_TASK_IDX);
 }
 
 /**************************************************************************//**
@@ -107,45 +117,166 @@ void pdsPostTask(PdsTaskIds_t id)
 ******************************************************************************/
 void pdsClearTask(PdsTaskIds_t id)
 {
-    ATOMIC_SECTION_ENTER
-    pdsTaskFlags &= ~id;
-    ATOMIC_SECTION_EXIT
+    SYSTEM_ClearTask(((SYSTEM_TaskMask_t)id & PDS_TASKS_MASK) << SYSTEM_PDS_TASK_IDX);
 }
 
 /**************************************************************************//**
-\brief PDS task handler.
+\brief PDS task handler, services PDS_STORE_DELETE_TASK_ID.
 ******************************************************************************/
 SYSTEM_TaskStatus_t PDS_TaskHandler(void)
 {
-#if (ENABLE_PDS == 1)	
-
-    if (pdsTaskFlags)
-    {
-        for (uint16_t taskId = 0; taskId < PDS_TASKS_COUNT; taskId++)
-        {
-            if ((1 << taskId) & (pdsTaskFlags))
-            {
-
-                ATOMIC_SECTION_ENTER
-                pdsTaskFlags &= ~(1 << taskId);
-                ATOMIC_SECTION_EXIT
-
-                pdsTaskHandlers[taskId]();
-
-				if (pdsTaskFlags)
-                {
-                    SYSTEM_PostTask(PDS_TASK_ID);
-                }
-                
-                break;
-            }
-        }
-    }
-#endif
+#if (ENABLE_PDS == 1)
+    return pdsStoreDeleteHandler();
+#else
     return SYSTEM_TASK_SUCCESS;
+#endif
+}
+
+/**************************************************************************//**
+\brief Prepares the PDS task, creates the timer of the deferred writes.
+
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsTaskInit(void)
+{
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+	pdsWriteTimerId = PDS_WRITE_TIMER_INVALID;
+	if ((LORAWAN_SUCCESS != SwTimerCreate(&pdsWriteTimerId)) ||
+		(LORAWAN_SUCCESS != SwTimerSetSlack(pdsWriteTimerId, MS_TO_US(PDS_WRITE_DELAY_MS))))
+	{
+		pdsWriteTimerId = PDS_WRITE_TIMER_INVALID;
+		return PDS_ERROR;
+	}
+#endif
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief Schedules the write of the files marked, after PDS_WRITE_DELAY_MS.
+		The files marked until then are written with them.
+******************************************************************************/
+void pdsPostWrite(void)
+{
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+	if (PDS_WRITE_TIMER_INVALID != pdsWriteTimerId)
+	{
+		if (!SwTimerIsRunning(pdsWriteTimerId))
+		{
+			SwTimerStart(pdsWriteTimerId, MS_TO_US(PDS_WRITE_DELAY_MS), SW_TIMEOUT_RELATIVE,
+				(void *)pdsWriteTimerCallback, NULL);
+		}
+		return;
+	}
+#endif
+	pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+}
+
+/**************************************************************************//**
+\brief	This function writes the files with items stored or deleted and not
+		written yet, without waiting for the PDS task. It is called before
+		sleeping and is meant for the brownout detection of the application,
+		from the main loop: an interrupt may break in an erase of the NVM or
+		a compaction of the log. Called while a file is being written, it
+		returns PDS_ERROR and writes nothing.
+
+\param[in] none
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t PDS_Flush(void)
+{
+	PdsStatus_t status = PDS_OK;
+#if (ENABLE_PDS == 1)
+	if (pdsWriting)
+	{
+		return PDS_ERROR;
+	}
+
+#if (PDS_WRITE_DELAY_MS > 0)
+	if (PDS_WRITE_TIMER_INVALID != pdsWriteTimerId)
+	{
+		SwTimerStop(pdsWriteTimerId);
+	}
+#endif
+	pdsClearTask(PDS_STORE_DELETE_TASK_ID);
+
+	for (PdsFileItemIdx_t fileId = PDS_FILE_MAC_01_IDX; fileId < PDS_MAX_FILE_IDX; fileId++)
+	{
+		if (isFileSet[fileId])
+		{
+			PdsStatus_t fileStatus = pdsWriteFile(fileId);
+
+			if (PDS_OK != fileStatus)
+			{
+				status = fileStatus;
+			}
+		}
+	}
+#endif
+	return status;
+}
+
+/**************************************************************************//**
+\brief	This function stores an item and writes its file at once.
+
+\param[in] pdsFileItemIdx - The file id of the item.
+\param[in] item - The item id of the item in PDS.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t PDS_StoreNow(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
+{
+	PdsStatus_t status = PDS_Store(pdsFileItemIdx, item);
+#if (ENABLE_PDS == 1)
+	/* The file is not marked if the PDS is uninitialized */
+	if ((PDS_OK == status) && isFileSet[pdsFileItemIdx])
+	{
+		status = pdsWriting ? PDS_ERROR : pdsWriteFile(pdsFileItemIdx);
+	}
+#endif
+	return status;
 }
 
 #if (ENABLE_PDS == 1)
+#if (PDS_WRITE_DELAY_MS > 0)
+/**************************************************************************//**
+\brief	Callback of the timer of the deferred writes, posts the PDS task.
+
+\param[in] param - Not used.
+******************************************************************************/
+static void pdsWriteTimerCallback(void *param)
+{
+	(void)param;
+	pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+}
+#endif
+
+/**************************************************************************//**
+\brief	This function writes the store and delete operations pending for a file.
+
+\param[in] fileId - The file id to be written.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+static PdsStatus_t pdsWriteFile(PdsFileItemIdx_t fileId)
+{
+	PdsStatus_t status;
+#ifndef PDS_LOG_ENABLE
+	PdsMem_t buffer;
+
+	memset(&buffer, 0, sizeof(PdsMem_t));
+#endif
+	SYSTEM_TRACE_EVENT(SYSTEM_TRACE_PDS_WRITE, fileId, 0, 0);
+	pdsWriting = true;
+#ifdef PDS_LOG_ENABLE
+	status = pdsStoreDeleteItems(fileId);
+#else
+	status = pdsStoreDelete(fileId, (uint8_t *)&(buffer));
+#endif
+	SYSTEM_TRACE_EVENT(SYSTEM_TRACE_PDS_WRITE_DONE, fileId, status, 0);
+	isFileSet[fileId] = false;
+	pdsWriting = false;
+
+	return status;
+}
+
 /**************************************************************************//**
 \brief	This function checks if an operation is pending for a file and will
 		initiate store/delete operation.
@@ -157,19 +288,16 @@ static SYSTEM_TaskStatus_t pdsStoreDeleteHandler(void)
 	PdsStatus_t status = SYSTEM_TASK_SUCCESS;
 
 	PdsFileItemIdx_t fileId = PDS_FILE_MAC_01_IDX;
-	PdsMem_t buffer;
 
-	memset(&buffer, 0, sizeof(PdsMem_t));
 	for (; fileId < PDS_MAX_FILE_IDX; fileId++)
 	{
 		if (true == isFileSet[fileId])
 		{
-			status = pdsStoreDelete(fileId, (uint8_t *)&(buffer));
+			status = pdsWriteFile(fileId);
 			if (status != PDS_OK)
 			{
 				// assert;
 			}
-			isFileSet[fileId] = false;
 			fileId++;
 			break;
 		}
@@ -186,6 +314,41 @@ static SYSTEM_TaskStatus_t pdsStoreDeleteHandler(void)
 	return status;
 }
 
+#ifdef PDS_LOG_ENABLE
+/**************************************************************************//**
+\brief	This function appends a record to the log for every item of a file
+		with a store or delete mark; the other items are not written.
+
+\param[in] pdsFileItemIdx - The file id to look for.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+static PdsStatus_t pdsStoreDeleteItems(PdsFileItemIdx_t pdsFileItemIdx)
+{
+	PdsStatus_t status = PDS_OK;
+	PdsOperations_t *fileMark;
+	ItemMap_t itemInfo;
+
+	for (uint8_t itemIdx = 0; itemIdx < fileMarks[pdsFileItemIdx].numItems; itemIdx++)
+	{
+		fileMark = fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx;
+		if (PDS_OP_NONE == *fileMark)
+		{
+			continue;
+		}
+
+		memcpy((void *)&itemInfo, (fileMarks[pdsFileItemIdx].itemListAddr) + itemIdx, sizeof(ItemMap_t));
+		status = pdsLogWrite(pdsFileItemIdx, itemIdx, itemInfo.ramAddress, itemInfo.size,
+			(PDS_OP_DELETE == *fileMark));
+		*fileMark = PDS_OP_NONE;
+		if (PDS_OK != status)
+		{
+			break;
+		}
+	}
+
+	return status;
+}
+#else
 /**************************************************************************//**
 \brief This function stores and deletes the items in a file based on file marks set.
 
@@ -248,4 +411,5 @@ static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buff
 	return status;
 }
 #endif
+#endif
 /* eof pds_task_handler.c */
@@ -72,19 +72,45 @@ typedef struct _SwTimer {
 	/* Timeout in microseconds */
 	uint32_t absoluteExpiryTime;
 
+	/* Latest time the timer may be served, absoluteExpiryTime plus the slack */
+	uint32_t latestExpiryTime;
+
+	/* Delay in microseconds the expiry may be postponed by, kept over restarts */
+	uint32_t slack;
+
 	/* Callback function to be executed on expiry of the timer */
 	void (*timerCb)(void*);
 
 	/* Parameter to be passed to callback function of the expired timer */
 	void *paramCb;
 
-	/* Next timer which was started or has expired */
+	/* Next timer in the queue of expired timers */
 	uint8_t nextTimer;
 
+	/* Position of the running timer in the expiry heap */
+	uint8_t heapIndex;
+
+	/* Start order, keeps timers of the same expiry time in FIFO order */
+	uint16_t sequence;
+
 	/* Whether this time is loaded is actually loaded into timer or not? */
 	bool loaded;
 } SwTimer_t;
 
+/*
+* Expiry counters of the timer module
+*/
+typedef struct _SwTimerStats {
+	/* Timers expired so far */
+	uint32_t expiredTimers;
+
+	/*
+	* Timers served along with an earlier one while their latest expiry
+	* time was still ahead, each of them is a timer interrupt avoided
+	*/
+	uint32_t coalescedTimers;
+} SwTimerStats_t;
+
 /*
 * This defines the type of the system timestamp
 */
@@ -186,6 +212,22 @@ StackRetStatus_t SwTimerCreate(uint8_t *timerId);
 StackRetStatus_t SwTimerStart(uint8_t timerId, uint32_t timerCount,
   SwTimeoutType_t timeoutType, void *timerCb, void *paramCb);
 
+/**************************************************************************//**
+\brief Sets the slack of a timer
+
+       The timer may expire up to \slack microseconds after its timeout, so
+       that it is served together with another timer instead of waking the
+       MCU on its own. The slack applies from the next start of the timer
+       and stays until it is set again.
+
+\param[in] timerId Timer identifier
+\param[in] slack Tolerated delay in microseconds, 0 for an exact expiry
+
+\return LORAWAN_INVALID_PARAMETER if at least one input parameter in invalid
+        LORAWAN_SUCCESS if the slack is set
+******************************************************************************/
+StackRetStatus_t SwTimerSetSlack(uint8_t timerId, uint32_t slack);
+
 /**************************************************************************//**
 \brief Stops a running timer. It stops a running timer with specified timerId
 \param timer_id Timer identifier
@@ -239,10 +281,18 @@ void SwTimerRunRemainingTime(uint32_t offset);
 
 /**************************************************************************//**
 \brief Returns the duration until the next timer expiry
-\return Returns the duration until the next timeout in microseconds
+\return Returns the duration until the next timeout in microseconds. A timer
+        with slack is due at its latest expiry time, the timers expiring
+        before then are served along with it.
 ******************************************************************************/
 uint32_t SwTimerNextExpiryDuration(void);
 
+/**************************************************************************//**
+\brief Reads the expiry counters of the timer module
+\param[out] stats Counters since the initialization of the module
+******************************************************************************/
+void SwTimerGetStats(SwTimerStats_t *stats);
+
 /**************************************************************************//**
 \brief Handler for the timer tasks
 \return SYSTEM_TASK_SUCCESS after servicing the timer triggers
@@ -40,19 +40,48 @@
 #include "system_init.h"
 #include "atomic.h"
 #include "system_task_manager.h"
+#include "sw_timer.h"
+#include <string.h>
 /************************************************************************/
 /* Defines                                                              */
 /************************************************************************/
-#define SYSTEM_TASK_ID_COUNT 5u
+/* End of an event list */
+#define SYSTEM_EVENT_INVALID    0xFFu
+
+/* Multiplier of the de Bruijn sequence used to find the lowest set bit */
+#define SYSTEM_DEBRUIJN_32      0x077CB531u
+
+/************************************************************************/
+/* Types                                                                */
+/************************************************************************/
+/* Event entry of the shared pool, chained into per-task queues */
+typedef struct _SystemEventEntry_t
+{
+    SYSTEM_Event_t event;
+    uint8_t next;
+} SystemEventEntry_t;
+
+/* Head and tail of the event queue of a task */
+typedef struct _SystemEventQueue_t
+{
+    uint8_t head;
+    uint8_t tail;
+} SystemEventQueue_t;
 
 /************************************************************************/
 /* Externals                                                            */
 /************************************************************************/
-//! This function is called to process RADIO task. SHOULD be defined in RADIO.
-extern SYSTEM_TaskStatus_t RADIO_TaskHandler(void);
+//! These functions are called to process RADIO subtasks. SHOULD be defined in RADIO.
+extern SYSTEM_TaskStatus_t RADIO_TxDoneHandler(void);
+extern SYSTEM_TaskStatus_t RADIO_RxDoneHandler(void);
+extern SYSTEM_TaskStatus_t RADIO_TxHandler(void);
+extern SYSTEM_TaskStatus_t RADIO_RxHandler(void);
+extern SYSTEM_TaskStatus_t RADIO_ScanHandler(void);
 
-//! This function is called to process LORAWAN task. SHOULD be defined in LORAWAN.
-extern SYSTEM_TaskStatus_t LORAWAN_TaskHandler(void);
+//! These functions are called to process LORAWAN subtasks. SHOULD be defined in LORAWAN.
+extern SYSTEM_TaskStatus_t LORAWAN_JoinReqHandler(void);
+extern SYSTEM_TaskStatus_t LORAWAN_TxHandler(void);
+extern SYSTEM_TaskStatus_t LORAWAN_RxHandler(void);
 
 //! This function is called to process system timer task. SHOULD be defined in TIMER.
 extern SYSTEM_TaskStatus_t TIMER_TaskHandler(void);
@@ -66,59 +95,132 @@ extern SYSTEM_TaskStatus_t APP_TaskHandler(void);
 /************************************************************************/
 /*  Static variables                                                    */
 /************************************************************************/
-static SYSTEM_TaskStatus_t (*taskHandlers[SYSTEM_TASK_ID_COUNT])(void) ={
+static SYSTEM_TaskHandler_t taskHandlers[SYSTEM_TASK_COUNT] = {
   /* In the order of descending priority */
     TIMER_TaskHandler,
-    RADIO_TaskHandler,
-    LORAWAN_TaskHandler,
+    RADIO_TxDoneHandler,
+    RADIO_RxDoneHandler,
+    RADIO_TxHandler,
+    RADIO_RxHandler,
+    RADIO_ScanHandler,
+    LORAWAN_JoinReqHandler,
+    LORAWAN_TxHandler,
+    LORAWAN_RxHandler,
     PDS_TaskHandler,
     APP_TaskHandler,
+    /* Application registered tasks follow */
+};
+
+/* Bit position of the lowest set bit, indexed by the de Bruijn product */
+static const uint8_t lowestBitIndex[32] = {
+    0u, 1u, 28u, 2u, 29u, 14u, 24u, 3u, 30u, 22u, 20u, 15u, 25u, 17u, 4u, 8u,
+    31u, 27u, 13u, 23u, 21u, 19u, 16u, 7u, 26u, 12u, 18u, 6u, 11u, 5u, 10u, 9u
 };
 
-static volatile uint16_t sysTaskFlag = 0u;
+static volatile SYSTEM_TaskMask_t sysTaskFlag = 0u;
+
+/* Slots which have a handler, posts to other slots are ignored */
+static SYSTEM_TaskMask_t sysTaskValid = (SYSTEM_TASK_MASK(SYSTEM_FIXED_TASK_COUNT) - 1u);
+
+static SystemEventEntry_t eventPool[SYSTEM_EVENT_POOL_SIZE];
+static SystemEventQueue_t eventQueues[SYSTEM_TASK_COUNT];
+static uint8_t eventFree = 0u;
+static bool eventPoolReady = false;
+
+#if (SYSTEM_TASK_STATS == 1)
+static SYSTEM_TaskStats_t taskStats[SYSTEM_TASK_COUNT];
+static uint32_t taskPostTime[SYSTEM_TASK_COUNT];
+#endif
+
+/************************************************************************/
+/* Prototypes                                                           */
+/************************************************************************/
+static inline uint8_t lowestTaskIdx(SYSTEM_TaskMask_t mask);
+static void eventPoolInit(void);
 
 /************************************************************************/
 /* Implementations                                                      */
 /************************************************************************/
 /*********************************************************************//**
-\brief System tasks execution entry point
+\brief Finds the slot of the highest priority task in a non-empty mask
+\param[in] mask - Set of ready tasks
+\return Index of the lowest set bit
 *************************************************************************/
-void SYSTEM_RunTasks(void)
+static inline uint8_t lowestTaskIdx(SYSTEM_TaskMask_t mask)
 {
-    if ((1 << SYSTEM_TASK_ID_COUNT) > sysTaskFlag)
-    { /* Only valid task bits are set */
-        while (sysTaskFlag)
-        { /* One or more task are pending to execute */
-            for (uint16_t taskId = 0; taskId < SYSTEM_TASK_ID_COUNT; taskId++)
-            {
-                if ((1 << taskId) & sysTaskFlag)
-                {
-                    /*
-                    * Reset the task bit since it is to be executed now.
-                    * It is done inside atomic section to avoid any interrupt context
-                    * corrupting the bits.
-                    */
-                    ATOMIC_SECTION_ENTER
-                    sysTaskFlag &= ~(1 << taskId);
-                    ATOMIC_SECTION_EXIT
-
-                    /* Return value is not used now, can be used later */
-                    taskHandlers[taskId]();
-
-                    /* Break here so that higher priority task executes next, if any */
-                    break;
-                }
-            }
-        }
+    /* Cortex-M0+ has no CLZ, so a multiply and table lookup is used */
+    return lowestBitIndex[((mask & (0u - mask)) * SYSTEM_DEBRUIJN_32) >> 27];
+}
+
+/*********************************************************************//**
+\brief Chains all entries of the event pool into the free list, and
+       empties the queues of all tasks
+*************************************************************************/
+static void eventPoolInit(void)
+{
+    for (uint8_t i = 0u; i < SYSTEM_EVENT_POOL_SIZE; i++)
+    {
+        eventPool[i].next = ((i + 1u) < SYSTEM_EVENT_POOL_SIZE) ? (i + 1u) : SYSTEM_EVENT_INVALID;
     }
-    else
+    for (uint8_t i = 0u; i < SYSTEM_TASK_COUNT; i++)
     {
+        eventQueues[i].head = SYSTEM_EVENT_INVALID;
+        eventQueues[i].tail = SYSTEM_EVENT_INVALID;
+    }
+    eventFree = 0u;
+    eventPoolReady = true;
+}
+
+/*********************************************************************//**
+\brief System tasks execution entry point
+*************************************************************************/
+void SYSTEM_RunTasks(void)
+{
+    while (sysTaskFlag)
+    { /* One or more task are pending to execute */
+        uint8_t taskIdx;
+#if (SYSTEM_TASK_STATS == 1)
+        uint32_t startTime;
+        uint32_t elapsed;
+#endif
+
         /*
-        * Invalid task bits are set i.e., bits other than 4 LSB are set
-        * Can happen only due to corruption, so halt
-        * TODO : replace this with assert implementation
+        * Pick the highest priority task and reset its bit since it is to
+        * be executed now. It is done inside atomic section to avoid any
+        * interrupt context corrupting the bits.
         */
-        while(1);
+        ATOMIC_SECTION_ENTER
+        taskIdx = lowestTaskIdx(sysTaskFlag);
+        sysTaskFlag &= ~SYSTEM_TASK_MASK(taskIdx);
+        ATOMIC_SECTION_EXIT
+
+#if (SYSTEM_TASK_STATS == 1)
+        startTime = (uint32_t)SwTimerGetTime();
+        elapsed = startTime - taskPostTime[taskIdx];
+        taskStats[taskIdx].totalLatencyUs += elapsed;
+        if (elapsed > taskStats[taskIdx].maxLatencyUs)
+        {
+            taskStats[taskIdx].maxLatencyUs = elapsed;
+        }
+#endif
+
+        /* Return value is not used now, can be used later */
+        taskHandlers[taskIdx]();
+
+#if (SYSTEM_TASK_STATS == 1)
+        elapsed = (uint32_t)SwTimerGetTime() - startTime;
+        taskStats[taskIdx].runCount++;
+        taskStats[taskIdx].totalTimeUs += elapsed;
+        if (elapsed > taskStats[taskIdx].maxTimeUs)
+        {
+            taskStats[taskIdx].maxTimeUs = elapsed;
+        }
+#endif
+
+        if (eventPoolReady && (SYSTEM_EVENT_INVALID != eventQueues[taskIdx].head))
+        { /* Events left, the task runs again after higher priority ones */
+            SYSTEM_PostTask(SYSTEM_TASK_MASK(taskIdx));
+        }
     }
 }
 
@@ -134,21 +236,205 @@ void SYSTEM_RunTasks(void)
        A handler is called when respective task can be run. Each task has its
        own task handler. \n
 
-       Correspondence between tasks and handlers is listed below:  \n
-       RADIO RADIO_TaskHandler() \n
-       HAL - HAL_TaskHandler() \n
-       LORAWAN - LORAWAN_TaskHandler() \n
-       APP - APP_TaskHandler() \n
+\param[in] task - Mask of the posted task slots
+*************************************************************************/
+void SYSTEM_PostTask(SYSTEM_TaskMask_t task)
+{
+    ATOMIC_SECTION_ENTER
+    /* Bits of slots without a handler can only come from corruption */
+    task &= sysTaskValid;
+#if (SYSTEM_TASK_STATS == 1)
+    SYSTEM_TaskMask_t fresh = task & ~sysTaskFlag;
+
+    if (fresh)
+    { /* Latency is measured from the first post of a pending task */
+        uint32_t now = (uint32_t)SwTimerGetTime();
+
+        while (fresh)
+        {
+            uint8_t taskIdx = lowestTaskIdx(fresh);
+
+            taskPostTime[taskIdx] = now;
+            fresh &= ~SYSTEM_TASK_MASK(taskIdx);
+        }
+    }
+#endif
+    sysTaskFlag |= task;
+    ATOMIC_SECTION_EXIT
+}
+
+/*********************************************************************//**
+\brief Withdraws posted tasks which have not been dispatched yet
+
+\param[in] task - Mask of the task slots to be cleared
+*************************************************************************/
+void SYSTEM_ClearTask(SYSTEM_TaskMask_t task)
+{
+    ATOMIC_SECTION_ENTER
+    sysTaskFlag &= ~task;
+    ATOMIC_SECTION_EXIT
+}
+
+/*********************************************************************//**
+\brief Registers an application task below the APP task priority
+
+\param[in] handler - Handler of the task
+\param[in] priority - 0 for the highest application task priority
+\param[out] taskIdx - Slot of the task
+
+\return LORAWAN_SUCCESS, LORAWAN_INVALID_PARAMETER or LORAWAN_INVALID_REQUEST
+*************************************************************************/
+StackRetStatus_t SYSTEM_RegisterTask(SYSTEM_TaskHandler_t handler,
+    uint8_t priority, uint8_t *taskIdx)
+{
+    StackRetStatus_t result = LORAWAN_SUCCESS;
+    uint8_t slot = SYSTEM_FIXED_TASK_COUNT + priority;
+
+    if ((NULL == handler) || (NULL == taskIdx) || (priority >= SYSTEM_APP_TASKS_MAX))
+    {
+        result = LORAWAN_INVALID_PARAMETER;
+    }
+    else if (NULL != taskHandlers[slot])
+    {
+        result = LORAWAN_INVALID_REQUEST;
+    }
+    else
+    {
+        ATOMIC_SECTION_ENTER
+        taskHandlers[slot] = handler;
+        sysTaskValid |= SYSTEM_TASK_MASK(slot);
+        ATOMIC_SECTION_EXIT
+        *taskIdx = slot;
+    }
+
+    return result;
+}
+
+/*********************************************************************//**
+\brief Queues an event to a task and posts the task
+
+\param[in] taskIdx - Slot of the receiving task
+\param[in] id - Event identifier
+\param[in] param - Payload of the event
+
+\return LORAWAN_SUCCESS, LORAWAN_INVALID_PARAMETER or
+        LORAWAN_RESOURCE_UNAVAILABLE
+*************************************************************************/
+StackRetStatus_t SYSTEM_PostEvent(uint8_t taskIdx, uint16_t id, void *param)
+{
+    StackRetStatus_t result = LORAWAN_SUCCESS;
+
+    if ((taskIdx >= SYSTEM_TASK_COUNT) || !(sysTaskValid & SYSTEM_TASK_MASK(taskIdx)))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
+
+    ATOMIC_SECTION_ENTER
+    if (!eventPoolReady)
+    {
+        eventPoolInit();
+    }
+
+    if (SYSTEM_EVENT_INVALID == eventFree)
+    {
+        result = LORAWAN_RESOURCE_UNAVAILABLE;
+    }
+    else
+    {
+        uint8_t entry = eventFree;
+
+        eventFree = eventPool[entry].next;
+        eventPool[entry].event.id = id;
+        eventPool[entry].event.param = param;
+        eventPool[entry].next = SYSTEM_EVENT_INVALID;
+
+        if (SYSTEM_EVENT_INVALID == eventQueues[taskIdx].tail)
+        {
+            eventQueues[taskIdx].head = entry;
+        }
+        else
+        {
+            eventPool[eventQueues[taskIdx].tail].next = entry;
+        }
+        eventQueues[taskIdx].tail = entry;
+
+        SYSTEM_PostTask(SYSTEM_TASK_MASK(taskIdx));
+    }
+    ATOMIC_SECTION_EXIT
+
+    return result;
+}
+
+/*********************************************************************//**
+\brief Takes the oldest event queued to a task
+
+\param[in] taskIdx - Slot of the task
+\param[out] event - Dequeued event
+
+\return 'true' if an event was dequeued, 'false' if the queue is empty
+*************************************************************************/
+bool SYSTEM_GetEvent(uint8_t taskIdx, SYSTEM_Event_t *event)
+{
+    bool found = false;
+
+    if ((taskIdx >= SYSTEM_TASK_COUNT) || !eventPoolReady)
+    {
+        return false;
+    }
+
+    ATOMIC_SECTION_ENTER
+    uint8_t entry = eventQueues[taskIdx].head;
+
+    if (SYSTEM_EVENT_INVALID != entry)
+    {
+        *event = eventPool[entry].event;
+        eventQueues[taskIdx].head = eventPool[entry].next;
+        if (SYSTEM_EVENT_INVALID == eventQueues[taskIdx].head)
+        {
+            eventQueues[taskIdx].tail = SYSTEM_EVENT_INVALID;
+        }
+        eventPool[entry].next = eventFree;
+        eventFree = entry;
+        found = true;
+    }
+    ATOMIC_SECTION_EXIT
 
-\param[in] task - ID of the posted task.
+    return found;
+}
+
+#if (SYSTEM_TASK_STATS == 1)
+/*********************************************************************//**
+\brief Reads the run-to-completion counters of a task
+
+\param[in] taskIdx - Slot of the task
+\param[out] stats - Counters of the task
+
+\return LORAWAN_SUCCESS, or LORAWAN_INVALID_PARAMETER for a bad slot
 *************************************************************************/
+StackRetStatus_t SYSTEM_GetTaskStats(uint8_t taskIdx, SYSTEM_TaskStats_t *stats)
+{
+    if ((taskIdx >= SYSTEM_TASK_COUNT) || (NULL == stats))
+    {
+        return LORAWAN_INVALID_PARAMETER;
+    }
 
-void SYSTEM_PostTask(SYSTEM_Task_t task)
+    ATOMIC_SECTION_ENTER
+    *stats = taskStats[taskIdx];
+    ATOMIC_SECTION_EXIT
+
+    return LORAWAN_SUCCESS;
+}
+
+/*********************************************************************//**
+\brief Clears the run-to-completion counters of all tasks
+*************************************************************************/
+void SYSTEM_ResetTaskStats(void)
 {
     ATOMIC_SECTION_ENTER
-    sysTaskFlag |= task;
+    memset(taskStats, 0, sizeof(taskStats));
     ATOMIC_SECTION_EXIT
 }
+#endif /* #if (SYSTEM_TASK_STATS == 1) */
 
 /*********************************************************************//**
 \brief Returns the readiness of the system for sleep
@@ -157,8 +443,7 @@ void SYSTEM_PostTask(SYSTEM_Task_t task)
 *************************************************************************/
 bool SYSTEM_ReadyToSleep(void)
 {
-    return !(sysTaskFlag & 0xffff);
+    return !sysTaskFlag;
 }
 
 /* eof system_task_manager.c */
-
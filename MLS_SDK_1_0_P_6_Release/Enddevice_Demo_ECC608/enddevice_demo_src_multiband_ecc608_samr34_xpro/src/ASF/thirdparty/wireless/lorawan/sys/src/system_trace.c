@@ -0,0 +1,156 @@
+/**
+* \file  system_trace.c
+*
+* \brief This is the implementation of the LoRaWAN stack event trace
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/************************************************************************/
+/* Includes                                                             */
+/************************************************************************/
+#include "compiler.h"
+#include "system_trace.h"
+#include "sw_timer.h"
+#include <string.h>
+
+#if (SYSTEM_TRACE_ENABLE == 1)
+/************************************************************************/
+/* Defines                                                              */
+/************************************************************************/
+#define SYSTEM_TRACE_MASK       (SYSTEM_TRACE_RECORDS - 1u)
+
+/************************************************************************/
+/* Global variables                                                     */
+/************************************************************************/
+/* Ring of records, written at traceHead, dumped from traceTail. The
+ * indexes run freely and are masked on access. */
+static SYSTEM_TraceRecord_t traceRing[SYSTEM_TRACE_RECORDS];
+static volatile uint32_t traceHead;
+static uint32_t traceTail;
+
+/* Upper 32 bits of the system time of the last record */
+static uint32_t traceTimeHigh;
+
+/************************************************************************/
+/* Implementations                                                      */
+/************************************************************************/
+
+/*********************************************************************//**
+\brief Records an event in the trace ring, overwriting the oldest record
+       when it is full. Only the slot is taken with interrupts disabled,
+       so a record never stalls an interrupt for long.
+
+\param[in] event - Event identifier, SYSTEM_TraceEventId_t
+\param[in] arg0, arg1, arg2 - Arguments of the event
+*************************************************************************/
+void SYSTEM_TraceEvent(uint8_t event, uint8_t arg0, uint16_t arg1, uint32_t arg2)
+{
+    SYSTEM_TraceRecord_t *record;
+    uint64_t now;
+    uint8_t flags = cpu_irq_save();
+
+    /* The time is read with the slot taken so that the records are in order */
+    now = SwTimerGetTime();
+    if ((uint32_t)(now >> 32) != traceTimeHigh)
+    {
+        traceTimeHigh = (uint32_t)(now >> 32);
+        record = &traceRing[traceHead++ & SYSTEM_TRACE_MASK];
+        record->time = 0;
+        record->event = SYSTEM_TRACE_TIME_HIGH;
+        record->arg0 = 0;
+        record->arg1 = 0;
+        record->arg2 = traceTimeHigh;
+    }
+    record = &traceRing[traceHead++ & SYSTEM_TRACE_MASK];
+
+    cpu_irq_restore(flags);
+
+    record->time = (uint32_t)now;
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+    record->arg2 = arg2;
+}
+
+/*********************************************************************//**
+\brief Writes the records recorded since the last dump, at most the size
+       of the ring. The events recorded meanwhile by interrupts are kept
+       for the next dump.
+
+\param[in] write - Output of the dump
+
+\return Number of records written
+*************************************************************************/
+uint16_t SYSTEM_TraceDump(SYSTEM_TraceWrite_t write)
+{
+    SYSTEM_TraceDumpHeader_t header;
+    SYSTEM_TraceRecord_t record;
+    uint32_t head = traceHead;
+    uint32_t first = traceTail;
+
+    if ((head - first) > SYSTEM_TRACE_RECORDS)
+    {
+        first = head - SYSTEM_TRACE_RECORDS;
+    }
+    if (head == first)
+    {
+        return 0;
+    }
+
+    header.magic = SYSTEM_TRACE_MAGIC;
+    header.version = SYSTEM_TRACE_VERSION;
+    header.recordSize = sizeof(SYSTEM_TraceRecord_t);
+    header.count = (uint16_t)(head - first);
+    header.sequence = first;
+    header.lost = first - traceTail;
+    write((uint8_t *)&header, sizeof(header));
+
+    for (uint32_t sequence = first; sequence != head; sequence++)
+    {
+        record = traceRing[sequence & SYSTEM_TRACE_MASK];
+
+        /* The slot was taken again by an interrupt while it was copied */
+        if ((traceHead - sequence) > SYSTEM_TRACE_RECORDS)
+        {
+            memset(&record, 0, sizeof(record));
+            record.event = SYSTEM_TRACE_LOST;
+        }
+        write((uint8_t *)&record, sizeof(record));
+    }
+    traceTail = head;
+
+    return header.count;
+}
+#endif /* #if (SYSTEM_TRACE_ENABLE == 1) */
+
+/* eof system_trace.c */
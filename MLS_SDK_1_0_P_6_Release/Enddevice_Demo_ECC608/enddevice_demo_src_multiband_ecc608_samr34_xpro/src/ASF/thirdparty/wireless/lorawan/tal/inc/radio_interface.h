@@ -243,7 +243,8 @@ typedef enum _RadioAttribute_t
     MAX_RADIO_ATTRIBUTES,
 	RADIO_LBT_PARAMS,
 	RADIO_CLOCK_STABLE_DELAY,
-	PACKET_RSSI_VALUE
+	PACKET_RSSI_VALUE,
+	RADIO_ENERGY_TIMES
 } RadioAttribute_t;
 
 /*********************************************************************//**
@@ -351,6 +352,31 @@ typedef struct _RadioLBT_t
 	uint8_t	lbtRssiSamplesCount;
 	uint8_t lbtScanTimerId;
 } RadioLBT_t;
+
+/*********************************************************************//**
+\brief	Time in microseconds the transceiver spent in each group of
+		modes since it was initialized. Receive covers RXCONT, RXSINGLE
+		and CAD, standby covers STANDBY, FSTX and FSRX.
+*************************************************************************/
+typedef struct _RadioEnergyTimes_t
+{
+	uint64_t txTime;
+	uint64_t rxTime;
+	uint64_t standbyTime;
+	uint64_t sleepTime;
+	uint64_t tcxoTime;
+} RadioEnergyTimes_t;
+
+/*********************************************************************//**
+\brief	A structure for accounting the time spent in each mode.
+*************************************************************************/
+typedef struct _RadioEnergy_t
+{
+	RadioEnergyTimes_t times;
+	uint64_t startTime;
+	RadioMode_t mode;
+	bool tcxoOn;
+} RadioEnergy_t;
 /*#endif*/ // LBT
 
 /*********************************************************************//**
@@ -394,6 +420,7 @@ typedef struct _RadioConfiguration_t
 	uint8_t clockSource;
 	int16_t packetRSSI;
 	uint8_t volatile fskPayloadIndex;
+	RadioEnergy_t energy;
 } RadioConfiguration_t;
 
 /************************************************************************/
@@ -50,7 +50,7 @@
 /************************************************************************/
 /*  Defines                                                            */
 /************************************************************************/
-#define RADIO_LORA_BUFFER_SPACE		271u  
+#define RADIO_LORA_BUFFER_SPACE		255u
 #define RADIO_FSK_BUFFER_SPACE		64u
 #define RADIO_BUFFER_SIZE			RADIO_LORA_BUFFER_SPACE
 
@@ -84,7 +84,8 @@ typedef struct _RadioEvents_t
     uint16_t FskRxTimoutEvent : 1;
     uint16_t RxError : 1;
 	uint16_t LbtScanDoneEvent : 1;
-	uint16_t reserved : 6;
+	uint16_t LoraRxReadDoneEvent : 1;
+	uint16_t reserved : 5;
 } RadioEvents_t;
 
 /*********************************************************************//**
@@ -162,6 +163,24 @@ void Radio_SetClockInput(void);
 *************************************************************************/
 void Radio_ResetClockInput(void);
 
+/*********************************************************************//**
+\brief	This function adds the time spent in the current mode of the
+		transceiver to its counter and starts timing the new mode.
+
+\param newMode	- Mode the transceiver is switched to.
+\return			- None.
+*************************************************************************/
+void Radio_AccountMode(RadioMode_t newMode);
+
+/*********************************************************************//**
+\brief	This function returns the time spent in each mode, including
+		the time spent so far in the current mode.
+
+\param times	- Filled with the times in microseconds.
+\return			- None.
+*************************************************************************/
+void Radio_GetEnergyTimes(RadioEnergyTimes_t *times);
+
 /*********************************************************************//**
 \brief	This function handles the payload transfer of bytes from buffer
 		to FIFO. 
@@ -111,7 +111,7 @@ SYSTEM_TaskStatus_t RADIO_ScanHandler(void)
 	HAL_DisbleDIO5Interrupt();
 #endif /* ENABLE_DIO5 */
 	/* Write Bandwidth as 200KHz to read RSSI throughout channel bandwidth */
-	RADIO_RegisterWrite(REG_FSK_RXBW, FSKBW_200_0KHZ);
+	Radio_WriteRegister(REG_FSK_RXBW, FSKBW_200_0KHZ);
 	
 	Radio_WriteMode(MODE_RXCONT, MODULATION_FSK, 0);
 
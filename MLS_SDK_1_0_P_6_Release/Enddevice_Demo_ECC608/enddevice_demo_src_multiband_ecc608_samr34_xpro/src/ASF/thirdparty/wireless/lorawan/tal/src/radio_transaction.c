@@ -67,6 +67,7 @@ uint8_t radioBuffer[RADIO_BUFFER_SIZE];
 /* Static Fuctions                                                      */
 /************************************************************************/
 static void Radio_ReadPktRssi(void);
+static void Radio_RxFrameReadDone(void);
 static bool Radio_IsChannelFree(void);
 static void Radio_EnableInterruptLines(void);
 static void Radio_DisableInterruptLines(void);
@@ -156,10 +157,10 @@ RadioError_t RADIO_TransmitCW(void)
 
         // Do not set the RadioState to RADIO_STATE_TX as we are not transmitting
         // any data so mac can override this by Tx'ing or Rx'ing.
-        RADIO_RegisterWrite(0x3D, 0xA1);
-        RADIO_RegisterWrite(0x36, 0x01);
-        RADIO_RegisterWrite(0x1E, 0x08);
-        RADIO_RegisterWrite(0x01, 0x8B);
+        Radio_WriteRegister(0x3D, 0xA1);
+        Radio_WriteRegister(0x36, 0x01);
+        Radio_WriteRegister(0x1E, 0x08);
+        Radio_WriteRegister(0x01, 0x8B);
     }
     else
     {
@@ -228,7 +229,7 @@ void RADIO_InitDefaultAttributes(void)
     radioConfiguration.rxBw = FSKBW_50_0KHZ;
     radioConfiguration.afcBw = FSKBW_83_3KHZ;
     radioConfiguration.dataBufferLen = 0;
-    radioConfiguration.dataBuffer = &radioBuffer[16];
+    radioConfiguration.dataBuffer = radioBuffer;
 	radioConfiguration.lbt.lbtChannelRSSI = 0;
 	radioConfiguration.lbt.lbtIrqFlagsBackup = 0;
 	radioConfiguration.lbt.lbtRssiSamples = 0;
@@ -295,6 +296,7 @@ void RADIO_InitDefaultAttributes(void)
     }
 
     RADIO_Reset();
+    Radio_InvalidateRegisters();
 
 	if (TCXO == HAL_GetRadioClkSrc())
 	{
@@ -315,32 +317,32 @@ void RADIO_InitDefaultAttributes(void)
 
     // Do not do auto calibration at runtime, start calibration now, Temp
     // threshold for monitoring 10 deg. C, Temperature monitoring enabled
-    RADIO_RegisterWrite(REG_FSK_IMAGECAL, 0x42);
+    Radio_WriteRegister(REG_FSK_IMAGECAL, 0x42);
 
     // Wait for calibration to complete
-    while ((RADIO_RegisterRead(REG_FSK_IMAGECAL) & 0x20) != 0)
+    while ((Radio_ReadRegister(REG_FSK_IMAGECAL) & 0x20) != 0)
         ;
 
     // High frequency LNA current adjustment, 150% LNA current (Boost on)
-    RADIO_RegisterWrite(REG_LNA, 0x23);
+    Radio_WriteRegister(REG_LNA, 0x23);
 
     // Preamble detector on, 2 bytes trigger an interrupt, Chip errors tolerated
     // over the preamble size
-    RADIO_RegisterWrite(REG_FSK_PREAMBLEDETECT, 0xAA);
+    Radio_WriteRegister(REG_FSK_PREAMBLEDETECT, 0xAA);
 
     // Set FSK max payload length to 255 bytes
-    RADIO_RegisterWrite(REG_FSK_PAYLOADLENGTH, 0xFF);
+    Radio_WriteRegister(REG_FSK_PAYLOADLENGTH, 0xFF);
 
     // Packet mode
-    RADIO_RegisterWrite(REG_FSK_PACKETCONFIG2, 1 << SHIFT6);
+    Radio_WriteRegister(REG_FSK_PACKETCONFIG2, 1 << SHIFT6);
 
     // Go to LoRa mode for this register to be set
     Radio_WriteMode(MODE_SLEEP, MODULATION_LORA, 1);
 
     // Set LoRa max payload length
-    RADIO_RegisterWrite(REG_LORA_PAYLOADMAXLENGTH, 0xFF);
+    Radio_WriteRegister(REG_LORA_PAYLOADMAXLENGTH, 0xFF);
 
-    radioConfiguration.regVersion = RADIO_RegisterRead(REG_VERSION);
+    radioConfiguration.regVersion = Radio_ReadRegister(REG_VERSION);
 	
 	//Power Off the Oscillator after putting the radio sleep state
 	Radio_ResetClockInput();
@@ -558,18 +560,19 @@ SYSTEM_TaskStatus_t RADIO_TxHandler(void)
 
 	if (MODULATION_LORA == radioConfiguration.modulation)
 	{
-		RADIO_RegisterWrite(REG_LORA_PAYLOADLENGTH, txBufferLen);
+		Radio_QueueRegister(REG_LORA_PAYLOADLENGTH, txBufferLen);
 
 		// Configure PaRamp
-		regValue = RADIO_RegisterRead(REG_PARAMP);
+		regValue = Radio_ReadRegister(REG_PARAMP);
 		regValue &= ~0x0F;    // Clear lower 4 bits
 		regValue |= 0x08;     // 50us PA Ramp-up time
-		RADIO_RegisterWrite(REG_PARAMP, regValue);
+		Radio_QueueRegister(REG_PARAMP, regValue);
 
 		// DIO0 = 01 means TxDone in LoRa mode.
 		// DIO2 = 00 means FHSSChangeChannel
-		RADIO_RegisterWrite(REG_DIOMAPPING1, 0x40);
-		RADIO_RegisterWrite(REG_DIOMAPPING2, 0x00);
+		Radio_QueueRegister(REG_DIOMAPPING1, 0x40);
+		Radio_QueueRegister(REG_DIOMAPPING2, 0x00);
+		Radio_FlushRegisters();
 
 		Radio_WriteMode(MODE_STANDBY, radioConfiguration.modulation, 1);
 		RADIO_FrameWrite(REG_FIFO_ADDRESS, transmitBufferPtr, txBufferLen);
@@ -592,14 +595,14 @@ SYSTEM_TaskStatus_t RADIO_TxHandler(void)
             radioConfiguration.fskPayloadIndex = txBufferLen;
         }              
         
-        RADIO_RegisterWrite(REG_DIOMAPPING1, 0x14);
+        Radio_WriteRegister(REG_DIOMAPPING1, 0x14);
         //    | REG_DIOMAPPING1_DIO0_BITS_00
         //    | REG_DIOMAPPING1_DIO1_BITS_01
         //    | REG_DIOMAPPING1_DIO2_BITS_01
         //    | REG_DIOMAPPING1_DIO3_BITS_00);
 
-        RADIO_RegisterWrite(REG_DIOMAPPING2,
-            (RADIO_RegisterRead(REG_DIOMAPPING2)
+        Radio_WriteRegister(REG_DIOMAPPING2,
+            (Radio_ReadRegister(REG_DIOMAPPING2)
                 & REG_DIOMAPPING2_DIO4_BITMASK
                 & REG_DIOMAPPING2_DIO_BITMASK));
 	}
@@ -650,31 +653,31 @@ SYSTEM_TaskStatus_t RADIO_RxHandler(void)
     {
         // All LoRa packets are received with explicit header, so this register
         // is not used. However, a value of 0 is not allowed.
-        RADIO_RegisterWrite(REG_LORA_PAYLOADLENGTH, 0x01);
+        Radio_QueueRegister(REG_LORA_PAYLOADLENGTH, 0x01);
 
         // DIO0 = 00 means RxDone in LoRa mode
         // DIO1 = 00 means RxTimeout in LoRa mode
         // DIO2 = 00 means FHSSChangeChannel
         // Other DIOs are unused.
-        RADIO_RegisterWrite(REG_DIOMAPPING1, 0x00);
-        RADIO_RegisterWrite(REG_DIOMAPPING2, 0x00);
+        Radio_QueueRegister(REG_DIOMAPPING1, 0x00);
+        Radio_QueueRegister(REG_DIOMAPPING2, 0x00);
     }
     else
     {
-        RADIO_RegisterWrite(REG_FSK_FIFOTHRESH, (0x80 | RADIO_RX_FIFO_LEVEL));
+        Radio_QueueRegister(REG_FSK_FIFOTHRESH, (0x80 | RADIO_RX_FIFO_LEVEL));
                 
-        RADIO_RegisterWrite(REG_FSK_RXBW, radioConfiguration.rxBw);
-        RADIO_RegisterWrite(REG_FSK_AFCBW, radioConfiguration.afcBw);
+        Radio_QueueRegister(REG_FSK_RXBW, radioConfiguration.rxBw);
+        Radio_QueueRegister(REG_FSK_AFCBW, radioConfiguration.afcBw);
 
-        RADIO_RegisterWrite(REG_DIOMAPPING1,
+        Radio_QueueRegister(REG_DIOMAPPING1,
             REG_DIOMAPPING1_DIO0_BITS_00 |
             REG_DIOMAPPING1_DIO1_BITS_00 |
             REG_DIOMAPPING1_DIO2_BITS_11 |
             REG_DIOMAPPING1_DIO3_BITS_01
         );
 
-        RADIO_RegisterWrite(REG_DIOMAPPING2,
-            (RADIO_RegisterRead(REG_DIOMAPPING2) &
+        Radio_QueueRegister(REG_DIOMAPPING2,
+            (Radio_ReadRegister(REG_DIOMAPPING2) &
                 REG_DIOMAPPING2_DIO4_BITMASK &
                 REG_DIOMAPPING2_DIO_BITMASK
             ) |
@@ -689,6 +692,7 @@ SYSTEM_TaskStatus_t RADIO_RxHandler(void)
 		radioConfiguration.dataBufferLen = 0;
 		radioConfiguration.fskPayloadIndex = 0;
     }
+    Radio_FlushRegisters();
 
     // Will use non blocking switches to RadioSetMode. We don't really care
     // when it starts receiving.
@@ -744,6 +748,7 @@ SYSTEM_TaskStatus_t RADIO_TxDoneHandler(void)
 			}
         }
 		RADIO_Reset();
+		Radio_InvalidateRegisters();
 		RADIO_InitDefaultAttributes();
     }
     else if ((1 == radioEvents.LoraTxDoneEvent) || (1 == radioEvents.FskTxDoneEvent))
@@ -829,9 +834,19 @@ SYSTEM_TaskStatus_t RADIO_RxDoneHandler(void)
     {
         radioEvents.LoraRxDoneEvent = 0;
 
-        radioConfiguration.dataBufferLen = RADIO_RegisterRead(REG_LORA_RXNBBYTES);
-        RADIO_RegisterWrite(REG_LORA_FIFOADDRPTR, 0x00);
-        RADIO_FrameRead(REG_FIFO_ADDRESS,radioConfiguration.dataBuffer,radioConfiguration.dataBufferLen);
+        radioConfiguration.dataBufferLen = Radio_ReadRegister(REG_LORA_RXNBBYTES);
+        Radio_WriteRegister(REG_LORA_FIFOADDRPTR, 0x00);
+        // The payload is moved by DMA if enabled, its end posts this task again
+        if (!RADIO_FrameReadAsync(REG_FIFO_ADDRESS, radioConfiguration.dataBuffer,
+                radioConfiguration.dataBufferLen, Radio_RxFrameReadDone))
+        {
+            RADIO_FrameRead(REG_FIFO_ADDRESS,radioConfiguration.dataBuffer,radioConfiguration.dataBufferLen);
+            Radio_RxFrameReadDone();
+        }
+    }
+    else if (1 == radioEvents.LoraRxReadDoneEvent)
+    {
+        radioEvents.LoraRxReadDoneEvent = 0;
 		Radio_ReadPktRssi();
 
         Radio_WriteMode(MODE_SLEEP, radioConfiguration.modulation, 0);
@@ -896,6 +911,20 @@ SYSTEM_TaskStatus_t RADIO_RxDoneHandler(void)
     return SYSTEM_TASK_SUCCESS;
 }
 
+/*********************************************************************//**
+\brief	This function is called at the end of the read of a received
+		LoRa frame out of the radio FIFO, in interrupt context when the
+		frame is read by DMA.
+
+\param	- none
+\return	- none
+*************************************************************************/
+static void Radio_RxFrameReadDone(void)
+{
+    radioEvents.LoraRxReadDoneEvent = 1;
+    radioPostTask(RADIO_RX_DONE_TASK_ID);
+}
+
 /*********************************************************************//**
 \brief	This function is the callback function for watchdog timer 
         timeout.
@@ -936,7 +965,7 @@ void RADIO_RxTimeout(void)
 	
 	// Turning off the RF switch now.
 	Radio_DisableRfControl(RADIO_RFCTRL_RX);
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 1 << SHIFT7);
+    Radio_WriteRegister(REG_LORA_IRQFLAGS, 1 << SHIFT7);
 
     radioEvents.LoraRxTimoutEvent = 1;
     radioPostTask(RADIO_RX_DONE_TASK_ID);
@@ -1059,7 +1088,7 @@ void RADIO_TxDone(void)
 	// Turning off the RF switch now.
 	Radio_DisableRfControl(RADIO_RFCTRL_TX);
 	
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 1 << SHIFT3);
+    Radio_WriteRegister(REG_LORA_IRQFLAGS, 1 << SHIFT3);
     if ((RADIO_GetState() == RADIO_STATE_TX) || (0 == radioEvents.RxWatchdogTimoutEvent))
     {
         radioEvents.LoraTxDoneEvent = 1;
@@ -1080,7 +1109,7 @@ void RADIO_FSKPacketSent(void)
 {
     uint8_t irqFlags;
 
-    irqFlags = RADIO_RegisterRead(REG_FSK_IRQFLAGS2);
+    irqFlags = Radio_ReadRegister(REG_FSK_IRQFLAGS2);
     if ((1 << SHIFT3) == (irqFlags & (1 << SHIFT3)))
     {
         // Make sure the watchdog won't trigger MAC functions erroneously.
@@ -1108,10 +1137,10 @@ void RADIO_FSKPacketSent(void)
 void RADIO_RxDone(void)
 {
     uint8_t crc, irqFlags;
-    irqFlags = RADIO_RegisterRead(REG_LORA_IRQFLAGS);
+    irqFlags = Radio_ReadRegister(REG_LORA_IRQFLAGS);
     // Clear RxDone interrupt (also CRC error and ValidHeader interrupts, if
     // they exist)
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGS, (1 << SHIFT6) | (1 << SHIFT5) | (1 << SHIFT4));
+    Radio_WriteRegister(REG_LORA_IRQFLAGS, (1 << SHIFT6) | (1 << SHIFT5) | (1 << SHIFT4));
 
     if (((1 << SHIFT6) | (1 << SHIFT4)) == (irqFlags & ((1 << SHIFT6) | (1 << SHIFT4))))
     {
@@ -1122,7 +1151,7 @@ void RADIO_RxDone(void)
 		Radio_DisableRfControl(RADIO_RFCTRL_RX);
 
         // Read CRC info from received packet header
-        crc = RADIO_RegisterRead(REG_LORA_HOPCHANNEL);
+        crc = Radio_ReadRegister(REG_LORA_HOPCHANNEL);
         if ((0 == radioConfiguration.crcOn) || ((0 == (irqFlags & (1 << SHIFT5))) && (0 != (crc & (1 << SHIFT6)))))
         {
             // ValidHeader and RxDone are set from the initial if condition.
@@ -1153,7 +1182,7 @@ void RADIO_FSKPayloadReady(void)
 {
     uint8_t irqFlags;
 
-    irqFlags = RADIO_RegisterRead(REG_FSK_IRQFLAGS2);
+    irqFlags = Radio_ReadRegister(REG_FSK_IRQFLAGS2);
     if ((1 << SHIFT2) == (irqFlags & (1 << SHIFT2)))
     {
         // Clearing of the PayloadReady (and CrcOk) interrupt is done when the
@@ -1293,9 +1322,14 @@ void Radio_SetClockInput(void)
 	uint8_t tcxoOn;
 	if (TCXO == radioConfiguration.clockSource)
 	{
-		tcxoOn = RADIO_RegisterRead(REG_TCXO);
+		if (!radioConfiguration.energy.tcxoOn)
+		{
+			Radio_AccountMode(radioConfiguration.energy.mode);
+			radioConfiguration.energy.tcxoOn = true;
+		}
+		tcxoOn = Radio_ReadRegister(REG_TCXO);
 		// Set TcxoInputOn bit (bit 4) to One
-		RADIO_RegisterWrite(REG_TCXO, tcxoOn | (1 << SHIFT4));
+		Radio_WriteRegister(REG_TCXO, tcxoOn | (1 << SHIFT4));
 		HAL_TCXOPowerOn();
 	}
     //else if XTAL is a source it will be powered on by default
@@ -1309,16 +1343,77 @@ void Radio_ResetClockInput(void)
 {
 	if (TCXO == radioConfiguration.clockSource)
 	{
+		Radio_AccountMode(radioConfiguration.energy.mode);
+		radioConfiguration.energy.tcxoOn = false;
 		HAL_TCXOPowerOff();
 	}
 }
 
+/*********************************************************************//**
+\brief	This function adds the time elapsed since the last mode change
+		to the counters of the current mode and of the TCXO.
+*************************************************************************/
+static void Radio_AddModeTime(RadioEnergyTimes_t *times, uint64_t now)
+{
+	uint64_t elapsed = now - radioConfiguration.energy.startTime;
+
+	switch (radioConfiguration.energy.mode)
+	{
+		case MODE_SLEEP:
+			times->sleepTime += elapsed;
+			break;
+		case MODE_TX:
+			times->txTime += elapsed;
+			break;
+		case MODE_RXCONT:
+		case MODE_RXSINGLE:
+		case MODE_CAD:
+			times->rxTime += elapsed;
+			break;
+		default:
+			times->standbyTime += elapsed;
+			break;
+	}
+
+	if (radioConfiguration.energy.tcxoOn)
+	{
+		times->tcxoTime += elapsed;
+	}
+}
+
+/*********************************************************************//**
+\brief	This function adds the time spent in the current mode of the
+		transceiver to its counter and starts timing the new mode.
+*************************************************************************/
+void Radio_AccountMode(RadioMode_t newMode)
+{
+	uint64_t now = SwTimerGetTime();
+
+	Radio_AddModeTime(&radioConfiguration.energy.times, now);
+	radioConfiguration.energy.startTime = now;
+	radioConfiguration.energy.mode = newMode;
+}
+
+/*********************************************************************//**
+\brief	This function returns the time spent in each mode, including
+		the time spent so far in the current mode.
+*************************************************************************/
+void Radio_GetEnergyTimes(RadioEnergyTimes_t *times)
+{
+	*times = radioConfiguration.energy.times;
+	Radio_AddModeTime(times, SwTimerGetTime());
+}
+
 /*********************************************************************//**
 \brief	This function reads the packetRSSI value from Radio register
 *************************************************************************/
 static void Radio_ReadPktRssi(void)
 {
-	radioConfiguration.packetSNR = RADIO_RegisterRead(REG_LORA_PKTSNRVALUE);
+	uint8_t pktValues[2];
+
+	// PKTSNRVALUE and PKTRSSIVALUE are consecutive, read both in one access
+	RADIO_RegisterBurstRead(REG_LORA_PKTSNRVALUE, pktValues, sizeof(pktValues));
+	radioConfiguration.packetSNR = pktValues[0];
 	if (radioConfiguration.packetSNR & 0x80)
 	{
 		radioConfiguration.packetSNR = ((~ radioConfiguration.packetSNR + 1) & 0xFF) >> 2;
@@ -1329,7 +1424,7 @@ static void Radio_ReadPktRssi(void)
 		radioConfiguration.packetSNR = (radioConfiguration.packetSNR & 0xFF) >> 2;
 	}
 	
-	int16_t pktrssi = RADIO_RegisterRead(REG_LORA_PKTRSSIVALUE);
+	int16_t pktrssi = pktValues[1];
 	
 	if (radioConfiguration.packetSNR < 0)
 	{
@@ -1384,7 +1479,7 @@ static bool Radio_IsChannelFree(void)
 	Radio_DisableInterruptLines();
 	
 	/* Write Bandwidth as 200KHz to read RSSI throughout channel bandwidth */
-	RADIO_RegisterWrite(REG_FSK_RXBW, FSKBW_200_0KHZ);
+	Radio_WriteRegister(REG_FSK_RXBW, FSKBW_200_0KHZ);
 	
 	/* Put radio to RX Continuous mode */
 	Radio_WriteMode(MODE_RXCONT, MODULATION_FSK, BLOCKING_REQ);
@@ -104,6 +104,12 @@ extern "C" {
 #ifndef RSSI_LF_OFFSET
 #define RSSI_LF_OFFSET				-164
 #endif
+// Number of register writes queued by Radio_QueueRegister before they are
+// flushed to the transceiver. A flush runs with interrupts disabled, since
+// the DIO interrupts also access the registers.
+#ifndef RADIO_REG_QUEUE_SIZE
+#define RADIO_REG_QUEUE_SIZE		16
+#endif
 
 /************************************************************************/
 /* Types                                                                */
@@ -133,6 +139,72 @@ RadioError_t Radio_ReadLoraRssi(int16_t *rssi);
 *************************************************************************/
 RadioError_t Radio_ReadFSKRssi(int16_t *rssi);
 
+/*********************************************************************//**
+\brief	This function reads a transceiver register. Configuration
+		registers are served from the shadow of the register page in
+		use once they have been read or written; status registers and
+		registers the transceiver changes by itself are always read
+		from the transceiver, after the queued writes are flushed.
+
+\param reg	- Register to be read.
+\return		- Value of the register.
+*************************************************************************/
+uint8_t Radio_ReadRegister(uint8_t reg);
+
+/*********************************************************************//**
+\brief	This function writes a transceiver register after the queued
+		writes. The write is skipped if the shadow of a configuration
+		register already holds the value.
+
+\param reg	- Register to be written.
+\param value	- Value to be written.
+\return		- none.
+*************************************************************************/
+void Radio_WriteRegister(uint8_t reg, uint8_t value);
+
+/*********************************************************************//**
+\brief	This function writes consecutive transceiver registers in one
+		burst after the queued writes. Leading and trailing registers
+		which already hold their value are left out.
+
+\param reg		- First register to be written.
+\param buffer		- Values of the registers.
+\param bufferLen	- Number of registers to be written.
+\return			- none.
+*************************************************************************/
+void Radio_WriteRegisters(uint8_t reg, uint8_t *buffer, uint8_t bufferLen);
+
+/*********************************************************************//**
+\brief	This function queues a register write. The queued writes are
+		done in order by Radio_FlushRegisters(), writes to consecutive
+		addresses in a single burst and writes of unchanged values not
+		at all. Reads are served with the queued values.
+
+\param reg	- Register to be written.
+\param value	- Value to be written.
+\return		- none.
+*************************************************************************/
+void Radio_QueueRegister(uint8_t reg, uint8_t value);
+
+/*********************************************************************//**
+\brief	This function writes the queued register writes to the
+		transceiver. It must be called before the queued configuration
+		is needed, e.g. before a mode change or a FIFO access.
+
+\param		- none
+\return		- none.
+*************************************************************************/
+void Radio_FlushRegisters(void);
+
+/*********************************************************************//**
+\brief	This function drops the register shadow, to be called after a
+		reset of the transceiver.
+
+\param		- none
+\return		- none.
+*************************************************************************/
+void Radio_InvalidateRegisters(void);
+
 #ifdef	__cplusplus
 }
 #endif
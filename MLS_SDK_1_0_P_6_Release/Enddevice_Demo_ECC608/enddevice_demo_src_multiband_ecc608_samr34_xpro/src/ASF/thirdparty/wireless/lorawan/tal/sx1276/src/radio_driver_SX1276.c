@@ -46,14 +46,91 @@
 #include "radio_transaction.h"
 #include "sw_timer.h"
 #include "sys.h"
+#include "atomic.h"
 #include "stdint.h"
 #include "string.h"
 
+/************************************************************************/
+/*  Defines                                                             */
+/************************************************************************/
+// Size of the register shadow, the SX1276 registers are 0x00 to 0x7F
+#define RADIO_REG_SHADOW_SIZE		0x80
+
+// Bit of a register in a register bitmap
+#define RADIO_REG_BIT(reg)			(1 << ((reg) & 0x07))
+
+// Register page of the shadow, the LongRangeMode bit of REG_OPMODE
+#define RADIO_REG_PAGE_FSK			0
+#define RADIO_REG_PAGE_LORA			1
+#define RADIO_REG_PAGE_NONE			0xFF
+
+/************************************************************************/
+/*  Types                                                               */
+/************************************************************************/
+typedef struct _RadioRegisterWrite_t
+{
+    uint8_t reg;
+    uint8_t value;
+    // The transceiver may not hold the value yet
+    bool changed;
+} RadioRegisterWrite_t;
+
 /************************************************************************/
 /*  Global variables                                                    */
 /************************************************************************/
 RadioConfiguration_t radioConfiguration;
 
+/************************************************************************/
+/*  Static variables                                                    */
+/************************************************************************/
+// Registers changed by the transceiver itself or holding trigger bits, in
+// the LoRa page. They are never served from the shadow.
+static const uint8_t radioVolatileLoraRegisters[RADIO_REG_SHADOW_SIZE >> 3] =
+{
+    [REG_FIFO >> 3] = RADIO_REG_BIT(REG_FIFO) | RADIO_REG_BIT(REG_OPMODE),
+    [REG_LORA_FIFOADDRPTR >> 3] = RADIO_REG_BIT(REG_LORA_FIFOADDRPTR),
+    [REG_LORA_FIFORXCURRENTADDR >> 3] = RADIO_REG_BIT(REG_LORA_FIFORXCURRENTADDR) |
+        RADIO_REG_BIT(REG_LORA_IRQFLAGS) | RADIO_REG_BIT(REG_LORA_RXNBBYTES) |
+        RADIO_REG_BIT(REG_LORA_RXHEADERCNTVALUEMSB) | RADIO_REG_BIT(REG_LORA_RXHEADERCNTVALUELSB) |
+        RADIO_REG_BIT(REG_LORA_RXPACKETCNTVALUEMSB) | RADIO_REG_BIT(REG_LORA_RXPACKETCNTVALUELSB),
+    [REG_LORA_MODEMSTAT >> 3] = RADIO_REG_BIT(REG_LORA_MODEMSTAT) |
+        RADIO_REG_BIT(REG_LORA_PKTSNRVALUE) | RADIO_REG_BIT(REG_LORA_PKTRSSIVALUE) |
+        RADIO_REG_BIT(REG_LORA_RSSIVALUE) | RADIO_REG_BIT(REG_LORA_HOPCHANNEL),
+    [REG_LORA_FIFORXBYTEADDR >> 3] = RADIO_REG_BIT(REG_LORA_FIFORXBYTEADDR),
+    [REG_LORA_FEIMSB >> 3] = RADIO_REG_BIT(REG_LORA_FEIMSB) | RADIO_REG_BIT(REG_LORA_FEIMID) |
+        RADIO_REG_BIT(REG_LORA_FEILSB) | RADIO_REG_BIT(REG_LORA_RSSIWIDEBAND)
+};
+
+// Registers changed by the transceiver itself or holding trigger bits, in
+// the FSK page
+static const uint8_t radioVolatileFskRegisters[RADIO_REG_SHADOW_SIZE >> 3] =
+{
+    [REG_FIFO >> 3] = RADIO_REG_BIT(REG_FIFO) | RADIO_REG_BIT(REG_OPMODE),
+    [REG_FSK_RXCONFIG >> 3] = RADIO_REG_BIT(REG_FSK_RXCONFIG),
+    [REG_FSK_RSSIVALUE >> 3] = RADIO_REG_BIT(REG_FSK_RSSIVALUE),
+    [REG_FSK_AFCFEI >> 3] = RADIO_REG_BIT(REG_FSK_AFCFEI) | RADIO_REG_BIT(REG_FSK_AFCMSB) |
+        RADIO_REG_BIT(REG_FSK_AFCLSB) | RADIO_REG_BIT(REG_FSK_FEIMSB) | RADIO_REG_BIT(REG_FSK_FEILSB),
+    [REG_FSK_OSC >> 3] = RADIO_REG_BIT(REG_FSK_OSC),
+    [REG_FSK_SEQCONFIG1 >> 3] = RADIO_REG_BIT(REG_FSK_SEQCONFIG1),
+    [REG_FSK_IMAGECAL >> 3] = RADIO_REG_BIT(REG_FSK_IMAGECAL) | RADIO_REG_BIT(REG_FSK_TEMP) |
+        RADIO_REG_BIT(REG_FSK_IRQFLAGS1) | RADIO_REG_BIT(REG_FSK_IRQFLAGS2)
+};
+
+// Last value written to or read from each register of the current page
+static uint8_t radioRegisterShadow[RADIO_REG_SHADOW_SIZE];
+
+// Registers whose shadow is valid
+static uint8_t radioRegisterValid[RADIO_REG_SHADOW_SIZE >> 3];
+
+// Register page the shadow belongs to
+static uint8_t radioRegisterPage = RADIO_REG_PAGE_NONE;
+
+// Register writes waiting for Radio_FlushRegisters. The DIO interrupts
+// read and write registers too: the shadow and the queue are only used
+// with interrupts disabled, around the SPI transfers they go with.
+static RadioRegisterWrite_t radioRegisterQueue[RADIO_REG_QUEUE_SIZE];
+static uint8_t radioRegisterQueueLen;
+
 /************************************************************************/
 /*  external variables                                                    */
 /************************************************************************/
@@ -62,6 +139,9 @@ extern volatile RadioCallbackMask_t radioCallbackMask;
 /************************************************************************/
 /*  Static functions                                                    */
 /************************************************************************/
+static bool Radio_IsRegisterCacheable(uint8_t reg);
+static bool Radio_IsRegisterUnchanged(uint8_t reg, uint8_t value);
+static void Radio_UpdateShadow(uint8_t reg, uint8_t value);
 
 /************************************************************************/
 /* Implementations                                                      */
@@ -94,7 +174,13 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
     newMode &= 0x07;
     newModulation &= 0x01;
 
-    opMode = RADIO_RegisterRead(REG_OPMODE);
+    // The time spent in the previous mode counts for the energy estimate
+    if (newMode != radioConfiguration.energy.mode)
+    {
+        Radio_AccountMode(newMode);
+    }
+
+    opMode = Radio_ReadRegister(REG_OPMODE);
 
     if ((opMode & 0x80) != 0)
     {
@@ -115,7 +201,7 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
         if (MODE_SLEEP != currentMode)
         {
             // Clear mode bits, effectively going to sleep
-            RADIO_RegisterWrite(REG_OPMODE, opMode & (~0x07));
+            Radio_WriteRegister(REG_OPMODE, opMode & (~0x07));
             currentMode = MODE_SLEEP;
         }
         // Change modulation
@@ -129,7 +215,7 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
             // LoRa mode. Set MSB and clear sleep bits to make it stay in sleep
             opMode = 0x80 | (opMode & (~0x87));
         }
-        RADIO_RegisterWrite(REG_OPMODE, opMode);
+        Radio_WriteRegister(REG_OPMODE, opMode);
     }
 
     // From here on currentModulation is no longer current, we will use
@@ -142,7 +228,7 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
         // DIO5 pin to relay this information.
         if ((MODE_SLEEP != newMode) && (1 == blocking))
         {
-            dioMapping = RADIO_RegisterRead(REG_DIOMAPPING2);
+            dioMapping = Radio_ReadRegister(REG_DIOMAPPING2);
             if (MODULATION_FSK == newModulation)
             {
                 // FSK mode
@@ -153,13 +239,13 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
                 // LoRa mode
                 dioMapping &= ~0x30;    // DIO5 = 00 means ModeReady in LoRa mode
             }
-            RADIO_RegisterWrite(REG_DIOMAPPING2, dioMapping);
+            Radio_WriteRegister(REG_DIOMAPPING2, dioMapping);
         }
 
         // Do the actual mode switch.
         opMode &= ~0x07;                // Clear old mode bits
         opMode |= newMode;              // Set new mode bits
-        RADIO_RegisterWrite(REG_OPMODE, opMode);
+        Radio_WriteRegister(REG_OPMODE, opMode);
 
         // If required and possible, wait for switch to complete
         if (1 == blocking)
@@ -189,7 +275,7 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
 void RADIO_FHSSChangeChannel(void)
 {
     uint32_t freq;
-    RADIO_RegisterRead(REG_LORA_IRQFLAGS);
+    Radio_ReadRegister(REG_LORA_IRQFLAGS);
 
     if (radioConfiguration.frequencyHopPeriod)
     {
@@ -202,7 +288,7 @@ void RADIO_FHSSChangeChannel(void)
     }
 
     // Clear FHSSChangeChannel interrupt
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 1 << SHIFT1);
+    Radio_WriteRegister(REG_LORA_IRQFLAGS, 1 << SHIFT1);
 }
 
 /*********************************************************************//**
@@ -225,13 +311,13 @@ uint16_t RADIO_ReadRandom(void)
 	
     // Mask all interrupts, do many measurements of RSSI
     Radio_WriteMode(MODE_SLEEP, MODULATION_LORA, 1);
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGSMASK, 0xFF);
+    Radio_WriteRegister(REG_LORA_IRQFLAGSMASK, 0xFF);
     Radio_WriteMode(MODE_RXCONT, MODULATION_LORA, 1);
     for (i = 0; i < 16; i++)
     {
         SystemBlockingWaitMs(1);
         retVal <<= SHIFT1;
-        retVal |= RADIO_RegisterRead(REG_LORA_RSSIWIDEBAND) & 0x01;
+        retVal |= Radio_ReadRegister(REG_LORA_RSSIWIDEBAND) & 0x01;
     }
 	
 	// Turning off the RF switch now.
@@ -240,9 +326,9 @@ uint16_t RADIO_ReadRandom(void)
     // Return radio to sleep
     Radio_WriteMode(MODE_SLEEP, MODULATION_LORA, 1);
     // Clear interrupts in case any have been generated
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 0xFF);
+    Radio_WriteRegister(REG_LORA_IRQFLAGS, 0xFF);
     // Unmask all interrupts
-    RADIO_RegisterWrite(REG_LORA_IRQFLAGSMASK, 0x00);
+    Radio_WriteRegister(REG_LORA_IRQFLAGSMASK, 0x00);
 	// Disabling Radio Clock save power
 	Radio_ResetClockInput();
 	
@@ -259,11 +345,11 @@ RadioError_t Radio_ReadLoraRssi(int16_t *rssi)
 {	
 	if (radioConfiguration.frequency >= HF_FREQ_HZ)
 	{
-		*rssi = RSSI_HF_OFFSET + RADIO_RegisterRead(REG_LORA_RSSIVALUE);		
+		*rssi = RSSI_HF_OFFSET + Radio_ReadRegister(REG_LORA_RSSIVALUE);		
 	}
 	else
 	{
-		*rssi = RSSI_LF_OFFSET + RADIO_RegisterRead(REG_LORA_RSSIVALUE);
+		*rssi = RSSI_LF_OFFSET + Radio_ReadRegister(REG_LORA_RSSIVALUE);
 	}
 
 	return ERR_NONE;
@@ -278,9 +364,283 @@ RadioError_t Radio_ReadLoraRssi(int16_t *rssi)
 RadioError_t Radio_ReadFSKRssi(int16_t *rssi)
 {	
 
-	*rssi = -(RADIO_RegisterRead(REG_FSK_RSSIVALUE) >> 1);
+	*rssi = -(Radio_ReadRegister(REG_FSK_RSSIVALUE) >> 1);
 	 return ERR_NONE;
 }
+/*********************************************************************//**
+\brief	This function checks whether a register may be served from the
+		shadow of the current register page.
+
+\param reg	- Register to be checked.
+\return		- true if the register holds configuration only.
+*************************************************************************/
+static bool Radio_IsRegisterCacheable(uint8_t reg)
+{
+    const uint8_t *volatileRegisters;
+
+    if (RADIO_REG_PAGE_LORA == radioRegisterPage)
+    {
+        volatileRegisters = radioVolatileLoraRegisters;
+    }
+    else if (RADIO_REG_PAGE_FSK == radioRegisterPage)
+    {
+        volatileRegisters = radioVolatileFskRegisters;
+    }
+    else
+    {
+        return false;
+    }
+
+    return (0 == (volatileRegisters[reg >> 3] & RADIO_REG_BIT(reg)));
+}
+
+/*********************************************************************//**
+\brief	This function checks whether the transceiver is known to hold
+		the given value in a register.
+
+\param reg	- Register to be checked.
+\param value	- Value to be written.
+\return		- true if the write can be skipped.
+*************************************************************************/
+static bool Radio_IsRegisterUnchanged(uint8_t reg, uint8_t value)
+{
+    return Radio_IsRegisterCacheable(reg) &&
+        (0 != (radioRegisterValid[reg >> 3] & RADIO_REG_BIT(reg))) &&
+        (radioRegisterShadow[reg] == value);
+}
+
+/*********************************************************************//**
+\brief	This function records the value of a register. A write to
+		REG_OPMODE which switches the LongRangeMode bit selects the
+		other register page and drops the shadow.
+
+\param reg	- Register written or read.
+\param value	- Value of the register.
+\return		- none.
+*************************************************************************/
+static void Radio_UpdateShadow(uint8_t reg, uint8_t value)
+{
+    uint8_t page;
+
+    if (REG_OPMODE == reg)
+    {
+        page = (value & 0x80) ? RADIO_REG_PAGE_LORA : RADIO_REG_PAGE_FSK;
+        if (page != radioRegisterPage)
+        {
+            memset(radioRegisterValid, 0, sizeof(radioRegisterValid));
+            radioRegisterPage = page;
+        }
+    }
+    else if (Radio_IsRegisterCacheable(reg))
+    {
+        radioRegisterShadow[reg] = value;
+        radioRegisterValid[reg >> 3] |= RADIO_REG_BIT(reg);
+    }
+}
+
+/*********************************************************************//**
+\brief	This function reads a transceiver register, from the shadow
+		if the register holds configuration only.
+
+\param reg	- Register to be read.
+\return		- Value of the register.
+*************************************************************************/
+uint8_t Radio_ReadRegister(uint8_t reg)
+{
+    uint8_t value;
+    uint8_t flags = cpu_irq_save();
+
+    reg &= ~REG_WRITE;
+    if (Radio_IsRegisterCacheable(reg) && (radioRegisterValid[reg >> 3] & RADIO_REG_BIT(reg)))
+    {
+        value = radioRegisterShadow[reg];
+    }
+    else
+    {
+        Radio_FlushRegisters();
+        value = RADIO_RegisterRead(reg);
+        Radio_UpdateShadow(reg, value);
+    }
+
+    cpu_irq_restore(flags);
+    return value;
+}
+
+/*********************************************************************//**
+\brief	This function writes a transceiver register after the queued
+		writes, unless it already holds the value.
+
+\param reg	- Register to be written.
+\param value	- Value to be written.
+\return		- none.
+*************************************************************************/
+void Radio_WriteRegister(uint8_t reg, uint8_t value)
+{
+    uint8_t flags = cpu_irq_save();
+
+    reg &= ~REG_WRITE;
+    if (!Radio_IsRegisterUnchanged(reg, value))
+    {
+        Radio_FlushRegisters();
+        RADIO_RegisterWrite(reg, value);
+        Radio_UpdateShadow(reg, value);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+/*********************************************************************//**
+\brief	This function writes consecutive transceiver registers in one
+		burst after the queued writes.
+
+\param reg		- First register to be written.
+\param buffer		- Values of the registers.
+\param bufferLen	- Number of registers to be written.
+\return			- none.
+*************************************************************************/
+void Radio_WriteRegisters(uint8_t reg, uint8_t *buffer, uint8_t bufferLen)
+{
+    uint8_t first = 0;
+    uint8_t i;
+    uint8_t flags = cpu_irq_save();
+
+    reg &= ~REG_WRITE;
+    while ((bufferLen > 0) && Radio_IsRegisterUnchanged(reg + bufferLen - 1, buffer[bufferLen - 1]))
+    {
+        bufferLen--;
+    }
+    while ((first < bufferLen) && Radio_IsRegisterUnchanged(reg + first, buffer[first]))
+    {
+        first++;
+    }
+    if (first == bufferLen)
+    {
+        cpu_irq_restore(flags);
+        return;
+    }
+
+    Radio_FlushRegisters();
+    if (1 == (bufferLen - first))
+    {
+        RADIO_RegisterWrite(reg + first, buffer[first]);
+    }
+    else
+    {
+        RADIO_RegisterBurstWrite(reg + first, &buffer[first], bufferLen - first);
+    }
+    for (i = first; i < bufferLen; i++)
+    {
+        Radio_UpdateShadow(reg + i, buffer[i]);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+/*********************************************************************//**
+\brief	This function queues a register write until
+		Radio_FlushRegisters() is called.
+
+\param reg	- Register to be written.
+\param value	- Value to be written.
+\return		- none.
+*************************************************************************/
+void Radio_QueueRegister(uint8_t reg, uint8_t value)
+{
+    RadioRegisterWrite_t *entry;
+    uint8_t flags = cpu_irq_save();
+
+    if (RADIO_REG_QUEUE_SIZE == radioRegisterQueueLen)
+    {
+        Radio_FlushRegisters();
+    }
+
+    reg &= ~REG_WRITE;
+    entry = &radioRegisterQueue[radioRegisterQueueLen];
+    entry->reg = reg;
+    entry->value = value;
+    entry->changed = !Radio_IsRegisterUnchanged(reg, value);
+    radioRegisterQueueLen++;
+    Radio_UpdateShadow(reg, value);
+
+    cpu_irq_restore(flags);
+}
+
+/*********************************************************************//**
+\brief	This function writes the queued register writes in order. A run
+		of writes to consecutive addresses goes out in one burst, with
+		the unchanged registers at its ends left out.
+
+\param		- none
+\return		- none.
+*************************************************************************/
+void Radio_FlushRegisters(void)
+{
+    uint8_t values[RADIO_REG_QUEUE_SIZE];
+    uint8_t queueLen;
+    uint8_t start = 0;
+    uint8_t first;
+    uint8_t last;
+    uint8_t i;
+    uint8_t flags = cpu_irq_save();
+
+    queueLen = radioRegisterQueueLen;
+    radioRegisterQueueLen = 0;
+    while (start < queueLen)
+    {
+        last = start;
+        while (((last + 1) < queueLen) &&
+            (radioRegisterQueue[last + 1].reg == (radioRegisterQueue[last].reg + 1)))
+        {
+            last++;
+        }
+
+        first = start;
+        start = last + 1;
+        while ((first <= last) && !radioRegisterQueue[first].changed)
+        {
+            first++;
+        }
+        while ((last > first) && !radioRegisterQueue[last].changed)
+        {
+            last--;
+        }
+
+        if (first > last)
+        {
+            continue;
+        }
+        if (first == last)
+        {
+            RADIO_RegisterWrite(radioRegisterQueue[first].reg, radioRegisterQueue[first].value);
+            continue;
+        }
+        for (i = first; i <= last; i++)
+        {
+            values[i - first] = radioRegisterQueue[i].value;
+        }
+        RADIO_RegisterBurstWrite(radioRegisterQueue[first].reg, values, last - first + 1);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+/*********************************************************************//**
+\brief	This function drops the register shadow and the queued writes.
+
+\param		- none
+\return		- none.
+*************************************************************************/
+void Radio_InvalidateRegisters(void)
+{
+    uint8_t flags = cpu_irq_save();
+
+    memset(radioRegisterValid, 0, sizeof(radioRegisterValid));
+    radioRegisterPage = RADIO_REG_PAGE_NONE;
+    radioRegisterQueueLen = 0;
+
+    cpu_irq_restore(flags);
+}
+
 /**
  End of File
  */
@@ -44,7 +44,9 @@
 /****************************** MACROS **************************************/
 
 /* Number of software timers */
+#ifndef TOTAL_NUMBER_OF_TIMERS
 #define TOTAL_NUMBER_OF_TIMERS            (25u)
+#endif
 
 
 /*Define the Sub band of Channels to be enabled by default for the application*/
@@ -51,6 +51,13 @@
 #define ATCA_POLLING_MAX_TIME_MSEC        2500
 #endif
 
+/* Set by atca_execute_hold() while the device is kept awake between commands */
+static bool atca_hold_awake = false;
+/* Set while the device is held awake and was woken up by a previous command */
+static bool atca_device_awake = false;
+
+static ATCA_STATUS atca_execute_once(ATCAPacket* packet, ATCADevice device, bool wake);
+
 #ifdef ATCA_NO_POLL
 // *INDENT-OFF* - Preserve time formatting from the code formatter
 /*Execution times for ATSHA204A supported commands...*/
@@ -276,6 +283,12 @@ ATCA_STATUS atGetExecTime(uint8_t opcode, ATCACommand ca_cmd)
 /** \brief Wakes up device, sends the packet, waits for command completion,
  *         receives response, and puts the device into the idle state.
  *
+ * While the device is held awake by atca_execute_hold(), the wake up is done
+ * by the first command only and the device is not put into the idle state
+ * after a successful command. A held device which does not answer may have
+ * been put to sleep by its watchdog, the command is then sent again after a
+ * wake up.
+ *
  * \param[inout] packet  As input, the packet to be sent. As output, the
  *                       data buffer in the packet structure will contain the
  *                       response.
@@ -284,6 +297,55 @@ ATCA_STATUS atGetExecTime(uint8_t opcode, ATCACommand ca_cmd)
  * \return ATCA_SUCCESS on success, otherwise an error code.
  */
 ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
+{
+    ATCA_STATUS status;
+
+    if (atca_device_awake)
+    {
+        status = atca_execute_once(packet, device, false);
+        if (status != ATCA_COMM_FAIL)
+        {
+            return status;
+        }
+    }
+
+    return atca_execute_once(packet, device, true);
+}
+
+/** \brief Keeps the device awake between the commands sent by
+ *         atca_execute_command(), which saves a wake up and an idle
+ *         sequence per command. The device must be released before its
+ *         watchdog expires (~1.3s by default).
+ *
+ * \param[in] device  CryptoAuthentication device to hold awake.
+ * \param[in] hold    true to hold the device awake, false to put it into
+ *                    the idle state again.
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+ATCA_STATUS atca_execute_hold(ATCADevice device, bool hold)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+
+    atca_hold_awake = hold;
+    if (!hold && atca_device_awake)
+    {
+        atca_device_awake = false;
+        status = atidle(device->mIface);
+    }
+
+    return status;
+}
+
+/** \brief Sends the packet and receives the response, optionally after a wake up.
+ *
+ * \param[inout] packet  Packet to be sent and response.
+ * \param[in]    device  CryptoAuthentication device to send the command to.
+ * \param[in]    wake    true to wake the device up before the command.
+ *
+ * \return ATCA_SUCCESS on success, otherwise an error code.
+ */
+static ATCA_STATUS atca_execute_once(ATCAPacket* packet, ATCADevice device, bool wake)
 {
     ATCA_STATUS status;
     uint32_t execution_or_wait_time;
@@ -304,7 +366,7 @@ ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
         max_delay_count = ATCA_POLLING_MAX_TIME_MSEC / ATCA_POLLING_FREQUENCY_TIME_MSEC;
 #endif
 
-        if ((status = atwake(device->mIface)) != ATCA_SUCCESS)
+        if (wake && ((status = atwake(device->mIface)) != ATCA_SUCCESS))
         {
             break;
         }
@@ -365,7 +427,15 @@ ATCA_STATUS atca_execute_command(ATCAPacket* packet, ATCADevice device)
     }
     while (0);
 
-    atidle(device->mIface);
+    if (atca_hold_awake && (status == ATCA_SUCCESS))
+    {
+        atca_device_awake = true;
+    }
+    else
+    {
+        atca_device_awake = false;
+        atidle(device->mIface);
+    }
     return status;
 }
 
@@ -159,7 +159,7 @@ uint32_t LorawanClasscPause(void)
 
 	if (UINT32_MAX == timeToPause)
     {
-        loRa.macStatus.macState = IDLE;
+        LORAWAN_SET_MAC_STATE(IDLE);
     }
 
 #else /* #if (FEATURE_CLASSC == 1) */
@@ -261,7 +261,7 @@ void LorawanClasscRxDone(Hdr_t *hdr)
 
 	if (loRa.macStatus.macState == RX1_OPEN)
 	{
-		loRa.macStatus.macState = RX2_OPEN;
+		LORAWAN_SET_MAC_STATE(RX2_OPEN);
 	}
 	//Move to Receive state after packet reception
 	loRa.enableRxcWindow = true;
@@ -338,7 +338,7 @@ void LorawanClasscRxTimeout(void)
 
     if(RX1_OPEN == loRa.macStatus.macState) 
     {
-        loRa.macStatus.macState = BETWEEN_RX1_RX2;
+        LORAWAN_SET_MAC_STATE(BETWEEN_RX1_RX2);
 		LorawanConfigureRadioForRX2(false);	
     }
     
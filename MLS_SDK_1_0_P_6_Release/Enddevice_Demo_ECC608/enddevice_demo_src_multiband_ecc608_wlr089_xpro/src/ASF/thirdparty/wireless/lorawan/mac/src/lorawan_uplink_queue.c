@@ -0,0 +1,406 @@
+/**
+* \file  lorawan_uplink_queue.c
+*
+* \brief LoRaWAN file for queuing the uplink frames
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+ 
+/****************************** INCLUDES **************************************/
+#include "conf_stack.h"
+#include "lorawan.h"
+#include "lorawan_defs.h"
+#include "lorawan_private.h"
+#include "lorawan_uplink_queue.h"
+#include "lorawan_aggregation.h"
+#include "lorawan_reg_params.h"
+#include "sw_timer.h"
+
+/******************* EXTERN DEFINITIONS *************************************/
+extern LoRa_t loRa;
+
+/*************************** FUNCTIONS PROTOTYPE ******************************/
+static void UplinkQueueRemove(uint8_t index);
+static void UplinkQueueDrop(uint8_t index, StackRetStatus_t status, LorawanUplinkQueueDropped_t *dropped);
+static void UplinkQueueReport(LorawanUplinkQueueDropped_t *dropped);
+static void UplinkQueueDropExpired(uint64_t now, LorawanUplinkQueueDropped_t *dropped);
+static void UplinkQueueStartTimer(uint64_t now);
+static void UplinkQueueTimerCallback(void);
+
+/*********************** FUNCTION DEFINITIONS *********************************/
+
+/*********************************************************************//**
+\brief	Uplink queue - drops the queued frames without any callback
+*************************************************************************/
+void LorawanUplinkQueueInit(void)
+{
+	loRa.uplinkQueue.count = 0;
+	loRa.uplinkQueue.headInFlight = false;
+	loRa.uplinkQueue.releaseTime = 0;
+}
+
+/*********************************************************************//**
+\brief	Queues a frame for transmission, see lorawan.h
+*************************************************************************/
+StackRetStatus_t LORAWAN_SendQueued (LorawanSendReq_t *lorasendreq, uint8_t priority, uint32_t lifetimeMs)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+	LorawanUplinkQueueDropped_t dropped = {.count = 0};
+	uint64_t now = SwTimerGetTime();
+	uint8_t maxPayloadSize = 0;
+	uint8_t first = queue->headInFlight ? 1 : 0;
+	uint8_t index;
+
+	if (loRa.macStatus.networkJoined == DISABLED)
+	{
+		return LORAWAN_NWK_NOT_JOINED;
+	}
+
+	if (NULL == lorasendreq)
+	{
+		return LORAWAN_INVALID_PARAMETER;
+	}
+
+	if (((lorasendreq->port < FPORT_MIN) || (lorasendreq->port > LORAWAN_TEST_PORT)) &&
+		(lorasendreq->bufferLength != 0))
+	{
+		return LORAWAN_INVALID_PARAMETER;
+	}
+
+	LORAREG_GetAttr(MAX_PAYLOAD_SIZE, &(loRa.currentDataRate), &maxPayloadSize);
+	if ((lorasendreq->bufferLength + FHDR_FPORT_SIZE) > maxPayloadSize)
+	{
+		return LORAWAN_INVALID_BUFFER_LENGTH;
+	}
+
+	/* The request is the handle of its callback, it can be queued only once */
+	for (index = 0; index < queue->count; index++)
+	{
+		if (queue->entries[index].sendReq == lorasendreq)
+		{
+			return LORAWAN_INVALID_REQUEST;
+		}
+	}
+
+	UplinkQueueDropExpired(now, &dropped);
+
+	if (LORAWAN_UPLINK_QUEUE_SIZE == queue->count)
+	{
+		uint8_t lowestPriority = queue->entries[queue->count - 1].priority;
+
+		/* Oldest frame of the lowest priority */
+		index = queue->count - 1;
+		while ((index > first) && (queue->entries[index - 1].priority == lowestPriority))
+		{
+			index--;
+		}
+
+		/* The queue was full, nothing expired */
+		if ((index < first) || (lowestPriority >= priority))
+		{
+			return LORAWAN_RESOURCE_UNAVAILABLE;
+		}
+
+		UplinkQueueDrop(index, LORAWAN_RESOURCE_UNAVAILABLE, &dropped);
+	}
+
+	/* After the frames of the same or a higher priority */
+	index = first;
+	while ((index < queue->count) && (queue->entries[index].priority >= priority))
+	{
+		index++;
+	}
+	memmove(&queue->entries[index + 1], &queue->entries[index],
+		(queue->count - index) * sizeof(LorawanUplinkQueueEntry_t));
+
+	queue->entries[index].sendReq = lorasendreq;
+	queue->entries[index].priority = priority;
+	queue->entries[index].expiryTime = (0 == lifetimeMs) ? UINT64_MAX : (now + MS_TO_US((uint64_t)lifetimeMs));
+	queue->count++;
+
+	UplinkQueueReport(&dropped);
+	LorawanUplinkQueueSchedule();
+
+	return LORAWAN_SUCCESS;
+}
+
+/*********************************************************************//**
+\brief	Empties the uplink queue, see lorawan.h
+*************************************************************************/
+void LORAWAN_FlushQueue (void)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+	LorawanUplinkQueueDropped_t dropped = {.count = 0};
+	uint8_t first = queue->headInFlight ? 1 : 0;
+
+	while (queue->count > first)
+	{
+		UplinkQueueDrop(first, LORAWAN_UPLINK_EXPIRED, &dropped);
+	}
+
+	/* The frames queued again by the callbacks stay queued */
+	UplinkQueueReport(&dropped);
+	LorawanUplinkQueueSchedule();
+}
+
+/*********************************************************************//**
+\brief	Called when a transaction completes, before the application is
+        informed
+\param[in]  status - status of the transaction
+\return	    true, if the frame is kept queued
+*************************************************************************/
+bool LorawanUplinkQueueTransactionDone(StackRetStatus_t status)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+
+	if ((false == queue->headInFlight) || (loRa.appHandle != queue->entries[0].sendReq))
+	{
+		return false;
+	}
+
+	queue->headInFlight = false;
+
+	if ((LORAWAN_NO_CHANNELS_FOUND == status) || (LORAWAN_RADIO_CHANNEL_BUSY == status))
+	{
+		uint64_t now = SwTimerGetTime();
+		uint32_t lbtPauseMs = UINT32_MAX;
+
+		/* Without a pause to wait for, try again after a while */
+		queue->releaseTime = now + MS_TO_US(LORAWAN_UPLINK_QUEUE_RETRY_MS);
+		if (loRa.featuresSupported & LBT_SUPPORT)
+		{
+			LORAREG_GetAttr(MIN_LBT_CHANNEL_PAUSE_TIMER, &(loRa.currentDataRate), &lbtPauseMs);
+			if (UINT32_MAX != lbtPauseMs)
+			{
+				queue->releaseTime = now + MS_TO_US((uint64_t)lbtPauseMs);
+			}
+		}
+		return true;
+	}
+
+	LorawanAggregationFrameDone(queue->entries[0].sendReq, status);
+	UplinkQueueRemove(0);
+	return false;
+}
+
+/*********************************************************************//**
+\brief	Schedules the release of the next queued frame
+*************************************************************************/
+void LorawanUplinkQueueSchedule(void)
+{
+	UplinkQueueStartTimer(SwTimerGetTime());
+}
+
+/*********************************************************************//**
+\brief	Removes a frame from the queue
+\param[in]  index - position of the frame in the queue
+*************************************************************************/
+static void UplinkQueueRemove(uint8_t index)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+
+	queue->count--;
+	memmove(&queue->entries[index], &queue->entries[index + 1],
+		(queue->count - index) * sizeof(LorawanUplinkQueueEntry_t));
+}
+
+/*********************************************************************//**
+\brief	Removes a frame which is not sent from the queue, the application
+        is informed by UplinkQueueReport
+\param[in]  index - position of the frame in the queue
+\param[in]  status - reason the frame is dropped
+\param[out] dropped - frames to report
+*************************************************************************/
+static void UplinkQueueDrop(uint8_t index, StackRetStatus_t status, LorawanUplinkQueueDropped_t *dropped)
+{
+	dropped->sendReq[dropped->count] = loRa.uplinkQueue.entries[index].sendReq;
+	dropped->status[dropped->count] = status;
+	dropped->count++;
+	UplinkQueueRemove(index);
+}
+
+/*********************************************************************//**
+\brief	Informs the application about the queued frames which are not
+        sent. It is called once the queue is consistent: the callback may
+        queue frames again.
+\param[in]  dropped - frames removed by UplinkQueueDrop
+*************************************************************************/
+static void UplinkQueueReport(LorawanUplinkQueueDropped_t *dropped)
+{
+	appCbParams_t cbPar;
+
+	for (uint8_t index = 0; index < dropped->count; index++)
+	{
+		LorawanAggregationFrameDone(dropped->sendReq[index], dropped->status[index]);
+
+		if ((AppPayload.AppData != NULL) && (loRa.evtmask & LORAWAN_EVT_TRANSACTION_COMPLETE))
+		{
+			cbPar.evt = LORAWAN_EVT_TRANSACTION_COMPLETE;
+			cbPar.param.transCmpl.status = dropped->status[index];
+			AppPayload.AppData(dropped->sendReq[index], &cbPar);
+		}
+	}
+	dropped->count = 0;
+}
+
+/*********************************************************************//**
+\brief	Drops the frames past their lifetime, except the one being sent
+\param[in]  now - system time in us
+\param[out] dropped - frames to report
+*************************************************************************/
+static void UplinkQueueDropExpired(uint64_t now, LorawanUplinkQueueDropped_t *dropped)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+	uint8_t index = queue->headInFlight ? 1 : 0;
+
+	while (index < queue->count)
+	{
+		if (queue->entries[index].expiryTime <= now)
+		{
+			UplinkQueueDrop(index, LORAWAN_UPLINK_EXPIRED, dropped);
+		}
+		else
+		{
+			index++;
+		}
+	}
+}
+
+/*********************************************************************//**
+\brief	Starts the queue timer for the release of the first frame, if the
+        MAC is free to send it, or else for the next end of a lifetime
+\param[in]  now - system time in us
+*************************************************************************/
+static void UplinkQueueStartTimer(uint64_t now)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+	uint8_t first = queue->headInFlight ? 1 : 0;
+	uint64_t eventTime = UINT64_MAX;
+	uint64_t timeout;
+
+	SwTimerStop(queue->timerId);
+
+	if ((0 == first) && (0 != queue->count) && loRa.isTransactionDone)
+	{
+		eventTime = queue->releaseTime;
+	}
+
+	for (uint8_t index = first; index < queue->count; index++)
+	{
+		if (queue->entries[index].expiryTime < eventTime)
+		{
+			eventTime = queue->entries[index].expiryTime;
+		}
+	}
+
+	/* Age of the aggregated records, which wait for the queue to be empty */
+	if ((0 == queue->count) && (LorawanAggregationFlushTime() < eventTime))
+	{
+		eventTime = LorawanAggregationFlushTime();
+	}
+
+	if (UINT64_MAX == eventTime)
+	{
+		return;
+	}
+
+	timeout = (eventTime > now) ? (eventTime - now) : 0;
+	if (SWTIMER_MIN_TIMEOUT > timeout)
+	{
+		timeout = SWTIMER_MIN_TIMEOUT;
+	}
+	else if (SWTIMER_MAX_TIMEOUT < timeout)
+	{
+		timeout = SWTIMER_MAX_TIMEOUT;
+	}
+
+	SwTimerStart(queue->timerId, (uint32_t)timeout, SW_TIMEOUT_RELATIVE, (void *)UplinkQueueTimerCallback, NULL);
+}
+
+/*********************************************************************//**
+\brief	Queue timer callback, drops the frames past their lifetime and
+        hands the first frame to the MAC at the earliest time the duty
+        cycle allows
+*************************************************************************/
+static void UplinkQueueTimerCallback(void)
+{
+	LorawanUplinkQueue_t *queue = &loRa.uplinkQueue;
+	LorawanUplinkQueueDropped_t dropped = {.count = 0};
+	uint64_t now = SwTimerGetTime();
+
+	UplinkQueueDropExpired(now, &dropped);
+	UplinkQueueReport(&dropped);
+	LorawanAggregationFlushDue(now);
+
+	while ((false == queue->headInFlight) && (0 != queue->count) &&
+		loRa.isTransactionDone && (queue->releaseTime <= now))
+	{
+		LorawanSendReq_t *sendReq = queue->entries[0].sendReq;
+		EarliestTxTimeParams_t txParams;
+		uint64_t earliestTxTime;
+		StackRetStatus_t status;
+
+		txParams.dr = loRa.currentDataRate;
+		txParams.length = sendReq->bufferLength;
+		if ((LORAWAN_SUCCESS == LORAWAN_GetAttr(EARLIEST_TX_TIME, &txParams, &earliestTxTime)) &&
+			(earliestTxTime > now))
+		{
+			queue->releaseTime = earliestTxTime;
+			break;
+		}
+
+		/* Set before sending, the transaction may complete from within */
+		queue->headInFlight = true;
+		status = LORAWAN_Send(sendReq);
+		if (LORAWAN_SUCCESS == status)
+		{
+			continue;
+		}
+
+		queue->headInFlight = false;
+		if (LORAWAN_BUSY == status)
+		{
+			/* Sent again after the transaction of the MAC, or after a while
+			   if the MAC is busy without a transaction */
+			queue->releaseTime = now + MS_TO_US(LORAWAN_UPLINK_QUEUE_RETRY_MS);
+		}
+		else
+		{
+			UplinkQueueDrop(0, status, &dropped);
+		}
+	}
+
+	UplinkQueueReport(&dropped);
+	UplinkQueueStartTimer(now);
+}
+
+/* eof lorawan_uplink_queue.c */
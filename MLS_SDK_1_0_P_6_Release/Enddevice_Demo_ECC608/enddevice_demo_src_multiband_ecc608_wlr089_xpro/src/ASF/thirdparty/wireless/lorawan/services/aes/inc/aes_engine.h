@@ -42,6 +42,18 @@
 
 #define BLOCKSIZE 16
 
+/* Software implementations of the AES Engine (src/sw/aes_engine.c), selected
+ * in place of the AES peripheral (src/hw/sam0/aes_engine.c) by defining
+ * AES_SW_ENGINE to one of them:
+ * AES_SW_COMPACT - bitsliced, constant time, no table
+ * AES_SW_TTABLE  - round table of 1 KB, fastest, table lookups indexed by the data */
+#define AES_SW_COMPACT 1
+#define AES_SW_TTABLE 2
+
+/**************************************** INCLUDES****************************/
+
+#include <stdint.h>
+
 /************************************* PROTOTYPES*****************************/
 
 /**
@@ -56,5 +68,40 @@ void AESInit(void);
  */
 void AESEncode(unsigned char* block, unsigned char* key);
 
+/**
+ * \brief Starts an AES session: the key is loaded in the engine once and used
+ *        by the following session calls until another session is started.
+ *        Starting a session with the key already loaded costs a comparison.
+ * \param[in] key Cryptographic key to be used in AES encryption
+ */
+void AESSessionStart(unsigned char* key);
+
+/**
+ * \brief Encrypts whole blocks in place with the key of the session (ECB)
+ * \param[in,out] blocks Blocks of input data to be encrypted
+ * \param[in] count Number of blocks
+ */
+void AESSessionEncode(unsigned char* blocks, uint16_t count);
+
+/**
+ * \brief Encrypts or decrypts a buffer in counter mode with the key of the
+ *        session. The counter is incremented for every block in its last
+ *        two bytes, big endian. Input and output may be the same buffer.
+ * \param[out] output Result, length bytes
+ * \param[in] input Data to be encrypted or decrypted, length bytes
+ * \param[in] length Length of the data in bytes
+ * \param[in] counter Counter block of the first block
+ */
+void AESSessionCtr(unsigned char* output, unsigned char* input, uint16_t length, unsigned char* counter);
+
+/**
+ * \brief Chains whole blocks through the cipher with the key of the session
+ *        (CBC-MAC): chain = E(chain ^ block) for every block
+ * \param[in,out] chain Chaining value, all zeros to start a MAC
+ * \param[in] input Blocks to be chained
+ * \param[in] count Number of blocks
+ */
+void AESSessionCbcMac(unsigned char* chain, unsigned char* input, uint16_t count);
+
 
 #endif  // _AES_ENGINE_H
\ No newline at end of file
@@ -115,6 +115,34 @@ COMPILER_PACK_RESET()
 
 typedef PdsNvm_t PdsMem_t;
 
+/* Log-structured store (PDS_LOG_ENABLE): every row starts with a row header
+ * and is followed by item records, appended in the erased part of the row.
+ * The CRC of a record follows its data, it is programmed last. */
+COMPILER_PACK_SET(1)
+typedef struct _PdsLogRowHeader_t
+{
+	uint8_t magic;
+	uint8_t version;
+	uint32_t sequence;	/* Order of the rows in the log */
+	uint16_t crc;		/* CRC of the fields above */
+} PdsLogRowHeader_t;
+
+typedef struct _PdsLogRecordHeader_t
+{
+	uint8_t fileId;		/* 0xFF: erased, end of the records of the row */
+	uint8_t itemIdx;
+	uint8_t size;
+	uint8_t flags;
+} PdsLogRecordHeader_t;
+COMPILER_PACK_RESET()
+
+#define PDS_LOG_RECORD_DELETED		0x01
+
+#define PDS_LOG_ROW_HEADER_SIZE		sizeof(PdsLogRowHeader_t)
+#define PDS_LOG_RECORD_HEADER_SIZE	sizeof(PdsLogRecordHeader_t)
+#define PDS_LOG_RECORD_CRC_SIZE		sizeof(uint16_t)
+#define PDS_LOG_RECORD_SIZE(size)	(PDS_LOG_RECORD_HEADER_SIZE + (size) + PDS_LOG_RECORD_CRC_SIZE)
+
 
 
 
@@ -0,0 +1,694 @@
+/**
+* \file  pds_log.c
+*
+* \brief This is the Pds log-structured store source file which contains the Pds log implementation.
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#if (ENABLE_PDS == 1) && defined(PDS_LOG_ENABLE)
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "pds_interface.h"
+#include "pds_common.h"
+#include "pds_task_handler.h"
+#include "pds_log.h"
+
+/************************************************************************/
+/*  Defines                                                             */
+/************************************************************************/
+/* Records are located by their offset in the PDS area */
+#if (EEPROM_SIZE > USHRT_MAX)
+#error "PDS area too large for the log index"
+#endif
+
+#define PDS_LOG_NO_RECORD			USHRT_MAX
+
+/* States of a row other than the sequence number of a log row */
+#define PDS_LOG_ROW_ERASED			UINT32_MAX
+#define PDS_LOG_ROW_FOREIGN			(UINT32_MAX - 1)
+
+/* Erased rows kept ahead of the head, the oldest row is compacted when fewer
+   are left. One of them is left while a compaction is cut by a reset. */
+#define PDS_LOG_RESERVE_ROWS		2
+
+#define PDS_LOG_LOCATION(row, offset)	((uint16_t)(((row) * EEPROM_ROW_SIZE) + (offset)))
+#define PDS_LOG_ROW(location)			((uint16_t)((location) / EEPROM_ROW_SIZE))
+#define PDS_LOG_OFFSET(location)		((uint16_t)((location) % EEPROM_ROW_SIZE))
+
+/* Largest record, a value of the largest item size */
+#define PDS_LOG_RECORD_MAX_SIZE		PDS_LOG_RECORD_SIZE(UCHAR_MAX)
+
+/************************************************************************/
+/*  Extern variables                                                    */
+/************************************************************************/
+extern PdsFileMarks_t fileMarks[];
+
+/************************************************************************/
+/*  Static variables                                                    */
+/************************************************************************/
+/* Location of the latest record of every item */
+static uint16_t logIndex[PDS_MAX_FILE_IDX][PDS_LOG_MAX_ITEMS];
+
+/* Sequence number of every row, or PDS_LOG_ROW_ERASED/PDS_LOG_ROW_FOREIGN */
+static uint32_t logRowSequence[EEPROM_NUM_ROWS];
+
+/* Row the records are appended to and its first erased byte */
+static uint16_t logHeadRow;
+static uint16_t logHeadOffset;
+
+/* Sequence number of the head row */
+static uint32_t logSequence;
+
+/******************************************************************************
+                   Static prototype section
+******************************************************************************/
+static void pdsLogReset(void);
+static bool pdsLogRowErased(uint16_t rowIdx, uint8_t *rowBuffer);
+static uint16_t pdsLogCrc(uint8_t *data, uint16_t length);
+static bool pdsLogRecordValid(uint8_t *record);
+static uint16_t pdsLogRecordEnd(uint8_t *rowBuffer, uint16_t offset);
+static uint16_t pdsLogScanRow(uint16_t rowIdx, uint8_t *rowBuffer);
+static PdsStatus_t pdsLogProgram(uint8_t *record, uint16_t length);
+static PdsStatus_t pdsLogMoveRecords(uint16_t rowIdx, uint8_t *rowBuffer);
+static uint16_t pdsLogLiveSize(uint16_t rowIdx, uint8_t *rowBuffer);
+static uint16_t pdsLogFreeRow(uint8_t *rowBuffer);
+static uint16_t pdsLogOldestRow(void);
+static PdsStatus_t pdsLogOpenRow(void);
+
+/******************************************************************************
+                   Implementations section
+******************************************************************************/
+
+/**************************************************************************//**
+\brief	Initializes the log-structured PDS: reads the row headers, replays the
+		records of the rows in the order they were written to build the RAM
+		index of the latest record of every item.
+
+\param[in] none
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsLogInit(void)
+{
+	PdsStatus_t status = pdsNvmInit();
+	uint8_t rowBuffer[EEPROM_ROW_SIZE];
+	PdsLogRowHeader_t rowHeader;
+	uint32_t lastSequence = 0;
+
+	if (PDS_OK != status)
+	{
+		return status;
+	}
+	pdsLogReset();
+
+	for (uint16_t rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
+	{
+		status = pdsNvmReadBytes(rowIdx, 0, (uint8_t *)&rowHeader, PDS_LOG_ROW_HEADER_SIZE);
+		if (PDS_OK != status)
+		{
+			return status;
+		}
+
+		if ((PDS_MAGIC == rowHeader.magic) && (PDS_LOG_VERSION == rowHeader.version) &&
+			(rowHeader.sequence < PDS_LOG_ROW_FOREIGN) &&
+			(rowHeader.crc == pdsLogCrc((uint8_t *)&rowHeader, offsetof(PdsLogRowHeader_t, crc))))
+		{
+			logRowSequence[rowIdx] = rowHeader.sequence;
+		}
+		else if (!pdsLogRowErased(rowIdx, rowBuffer))
+		{
+			/* Torn erase or another format: erased before it is used */
+			logRowSequence[rowIdx] = PDS_LOG_ROW_FOREIGN;
+		}
+	}
+
+	/* Replay the rows from the oldest one, a later record of an item wins */
+	while (true)
+	{
+		uint16_t nextRow = EEPROM_NUM_ROWS;
+
+		for (uint16_t rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
+		{
+			if ((logRowSequence[rowIdx] > lastSequence) && (logRowSequence[rowIdx] < PDS_LOG_ROW_FOREIGN) &&
+				((EEPROM_NUM_ROWS == nextRow) || (logRowSequence[rowIdx] < logRowSequence[nextRow])))
+			{
+				nextRow = rowIdx;
+			}
+		}
+		if (EEPROM_NUM_ROWS == nextRow)
+		{
+			break;
+		}
+
+		lastSequence = logRowSequence[nextRow];
+		logHeadRow = nextRow;
+		logHeadOffset = pdsLogScanRow(nextRow, rowBuffer);
+		logSequence = lastSequence;
+	}
+
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Appends a record of an item to the log. When the row of the log is
+		full the next row is opened, and the oldest row is compacted into it.
+
+\param[in] 	pdsFileItemIdx - The file id of the item.
+\param[in] 	itemIdx - The index of the item in the item list of the file.
+\param[in] 	data - The value of the item, not used for a deleted item.
+\param[in] 	size - The size of the value.
+\param[in] 	deleted - true to record the deletion of the item.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsLogWrite(PdsFileItemIdx_t pdsFileItemIdx, uint8_t itemIdx, uint8_t *data,
+	uint8_t size, bool deleted)
+{
+	uint8_t record[PDS_LOG_RECORD_MAX_SIZE];
+	PdsLogRecordHeader_t *header = (PdsLogRecordHeader_t *)record;
+	uint16_t length;
+	uint16_t crc;
+	PdsStatus_t status;
+
+	if (deleted)
+	{
+		size = 0;
+	}
+	length = PDS_LOG_RECORD_SIZE(size);
+
+	if ((PDS_MAX_FILE_IDX <= pdsFileItemIdx) || (PDS_LOG_MAX_ITEMS <= itemIdx) ||
+		(length > (EEPROM_ROW_SIZE - PDS_LOG_ROW_HEADER_SIZE)))
+	{
+		return PDS_NOT_ENOUGH_MEMORY;
+	}
+
+	header->fileId = pdsFileItemIdx;
+	header->itemIdx = itemIdx;
+	header->size = size;
+	header->flags = deleted ? PDS_LOG_RECORD_DELETED : 0;
+	memcpy(&record[PDS_LOG_RECORD_HEADER_SIZE], data, size);
+	crc = pdsLogCrc(record, PDS_LOG_RECORD_HEADER_SIZE + size);
+	memcpy(&record[PDS_LOG_RECORD_HEADER_SIZE + size], (void *)&crc, PDS_LOG_RECORD_CRC_SIZE);
+
+	/* Every row opened reclaims one, the log is full when none gives room */
+	for (uint16_t rows = 0; (logHeadOffset + length) > EEPROM_ROW_SIZE; rows++)
+	{
+		if (EEPROM_NUM_ROWS == rows)
+		{
+			return PDS_NOT_ENOUGH_MEMORY;
+		}
+		status = pdsLogOpenRow();
+		if (PDS_OK != status)
+		{
+			return status;
+		}
+	}
+
+	return pdsLogProgram(record, length);
+}
+
+/**************************************************************************//**
+\brief	Builds the image of a file, in the layout of the wear levelling store,
+		from the latest records of its items.
+
+\param[in] 	pdsFileItemIdx - The file id to be read from.
+\param[in] 	buffer - The buffer for the image of the file.
+\param[in] 	size - The size of the image of the file.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsLogRead(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size)
+{
+	uint8_t record[PDS_LOG_RECORD_MAX_SIZE];
+	PdsLogRecordHeader_t *header = (PdsLogRecordHeader_t *)record;
+	uint8_t *image = (uint8_t *)&(buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlData);
+	ItemHeader_t itemHeader;
+	ItemMap_t itemInfo;
+	bool found = false;
+	PdsStatus_t status;
+
+	if (PDS_WL_DATA_SIZE < size)
+	{
+		size = PDS_WL_DATA_SIZE;
+	}
+
+	for (uint8_t itemIdx = 0; (itemIdx < fileMarks[pdsFileItemIdx].numItems) && (itemIdx < PDS_LOG_MAX_ITEMS); itemIdx++)
+	{
+		uint16_t location = logIndex[pdsFileItemIdx][itemIdx];
+
+		if (PDS_LOG_NO_RECORD == location)
+		{
+			continue;
+		}
+		memcpy((void *)&itemInfo, (void *)(fileMarks[pdsFileItemIdx].itemListAddr + itemIdx), sizeof(ItemMap_t));
+		if ((itemInfo.itemOffset + sizeof(ItemHeader_t) + itemInfo.size) > size)
+		{
+			continue;
+		}
+
+		status = pdsNvmReadBytes(PDS_LOG_ROW(location), PDS_LOG_OFFSET(location), record, PDS_LOG_RECORD_HEADER_SIZE);
+		if (PDS_OK == status)
+		{
+			status = pdsNvmReadBytes(PDS_LOG_ROW(location), PDS_LOG_OFFSET(location) + PDS_LOG_RECORD_HEADER_SIZE,
+				&record[PDS_LOG_RECORD_HEADER_SIZE], header->size + PDS_LOG_RECORD_CRC_SIZE);
+		}
+		if (PDS_OK != status)
+		{
+			return status;
+		}
+		if (!pdsLogRecordValid(record))
+		{
+			return PDS_CRC_ERROR;
+		}
+
+		itemHeader.magic = PDS_MAGIC;
+		itemHeader.version = PDS_FILES_VERSION;
+		itemHeader.itemId = itemInfo.itemId;
+		itemHeader.delete = (0 != (header->flags & PDS_LOG_RECORD_DELETED));
+		/* A value stored with another size of the item is cut to the item */
+		itemHeader.size = (itemHeader.delete || (header->size > itemInfo.size)) ? itemInfo.size : header->size;
+		memcpy(&image[itemInfo.itemOffset], (void *)&itemHeader, sizeof(ItemHeader_t));
+		if (!itemHeader.delete)
+		{
+			memcpy(&image[itemInfo.itemOffset + sizeof(ItemHeader_t)], &record[PDS_LOG_RECORD_HEADER_SIZE], itemHeader.size);
+		}
+		found = true;
+	}
+
+	return found ? PDS_OK : PDS_NOT_FOUND;
+}
+
+/**************************************************************************//**
+\brief This function checks if a record of an item of the file is in the log.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsLogIsFileFound(PdsFileItemIdx_t pdsFileItemIdx)
+{
+	for (uint8_t itemIdx = 0; itemIdx < PDS_LOG_MAX_ITEMS; itemIdx++)
+	{
+		if (PDS_LOG_NO_RECORD != logIndex[pdsFileItemIdx][itemIdx])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**************************************************************************//**
+\brief This function erases the RAM index and all the rows of the log.
+
+\param[out] - void
+******************************************************************************/
+void pdsLogDeleteAll(void)
+{
+	pdsLogReset();
+	pdsNvmEraseAll();
+}
+
+/**************************************************************************//**
+\brief	Empties the RAM index; the next record opens the first row.
+******************************************************************************/
+static void pdsLogReset(void)
+{
+	memset(logIndex, UCHAR_MAX, sizeof(logIndex));
+	memset(logRowSequence, UCHAR_MAX, sizeof(logRowSequence));
+	logHeadRow = EEPROM_NUM_ROWS - 1;
+	logHeadOffset = EEPROM_ROW_SIZE;
+	logSequence = 0;
+}
+
+/**************************************************************************//**
+\brief	Checks whether every byte of a row is erased.
+
+\param[in] 	rowIdx - The row to be checked.
+\param[in] 	rowBuffer - A buffer of the size of a row.
+\param[out] - return true or false
+******************************************************************************/
+static bool pdsLogRowErased(uint16_t rowIdx, uint8_t *rowBuffer)
+{
+	if (PDS_OK != pdsNvmReadBytes(rowIdx, 0, rowBuffer, EEPROM_ROW_SIZE))
+	{
+		return false;
+	}
+	for (uint16_t i = 0; i < EEPROM_ROW_SIZE; i++)
+	{
+		if (UCHAR_MAX != rowBuffer[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief	Calculates the CRC of a row header or a record. The CRC is programmed
+		after the data it covers and never takes the erased value, so that a
+		write cut by a reset never checks.
+
+\param[in] 	data - The data.
+\param[in] 	length - The amount of data.
+\param[out] uint16_t - The calculated 16 bit CRC.
+******************************************************************************/
+static uint16_t pdsLogCrc(uint8_t *data, uint16_t length)
+{
+	uint16_t crc = pdsNvmCrc(0, data, length);
+
+	return (USHRT_MAX == crc) ? 0 : crc;
+}
+
+/**************************************************************************//**
+\brief	Checks the CRC which follows the data of a record.
+
+\param[in] 	record - The record.
+\param[out] - return true or false
+******************************************************************************/
+static bool pdsLogRecordValid(uint8_t *record)
+{
+	uint16_t length = PDS_LOG_RECORD_HEADER_SIZE + ((PdsLogRecordHeader_t *)record)->size;
+	uint16_t crc;
+
+	memcpy((void *)&crc, &record[length], PDS_LOG_RECORD_CRC_SIZE);
+	return (crc == pdsLogCrc(record, length));
+}
+
+/**************************************************************************//**
+\brief	Checks the record at an offset of a copy of a row.
+
+\param[in] 	rowBuffer - The copy of the row.
+\param[in] 	offset - The offset of the record.
+\param[out] - returns the offset following the record, 0 if there is no
+			  valid record at the offset
+******************************************************************************/
+static uint16_t pdsLogRecordEnd(uint8_t *rowBuffer, uint16_t offset)
+{
+	PdsLogRecordHeader_t header;
+	uint16_t end;
+
+	if ((offset + PDS_LOG_RECORD_HEADER_SIZE) > EEPROM_ROW_SIZE)
+	{
+		return 0;
+	}
+	memcpy((void *)&header, &rowBuffer[offset], PDS_LOG_RECORD_HEADER_SIZE);
+	end = offset + PDS_LOG_RECORD_SIZE(header.size);
+	if ((UCHAR_MAX == header.fileId) || (end > EEPROM_ROW_SIZE))
+	{
+		return 0;
+	}
+
+	return pdsLogRecordValid(&rowBuffer[offset]) ? end : 0;
+}
+
+/**************************************************************************//**
+\brief	Reads a row of the log and points the index to its records.
+
+\param[in] 	rowIdx - The row to be scanned.
+\param[in] 	rowBuffer - A buffer of the size of a row.
+\param[out] - returns the first erased byte of the row. A row with a record
+			  which does not check, the end of a write cut by a reset, is
+			  reported as full so that nothing is appended to it.
+******************************************************************************/
+static uint16_t pdsLogScanRow(uint16_t rowIdx, uint8_t *rowBuffer)
+{
+	uint16_t offset = PDS_LOG_ROW_HEADER_SIZE;
+	uint16_t end;
+
+	if (PDS_OK != pdsNvmReadBytes(rowIdx, 0, rowBuffer, EEPROM_ROW_SIZE))
+	{
+		return EEPROM_ROW_SIZE;
+	}
+
+	while (0 != (end = pdsLogRecordEnd(rowBuffer, offset)))
+	{
+		PdsLogRecordHeader_t *header = (PdsLogRecordHeader_t *)&rowBuffer[offset];
+
+		if ((PDS_MAX_FILE_IDX > header->fileId) && (PDS_LOG_MAX_ITEMS > header->itemIdx))
+		{
+			logIndex[header->fileId][header->itemIdx] = PDS_LOG_LOCATION(rowIdx, offset);
+		}
+		offset = end;
+	}
+
+	for (end = offset; end < EEPROM_ROW_SIZE; end++)
+	{
+		if (UCHAR_MAX != rowBuffer[end])
+		{
+			return EEPROM_ROW_SIZE;
+		}
+	}
+	return offset;
+}
+
+/**************************************************************************//**
+\brief	Programs a record at the head of the log and points the index to it.
+
+\param[in] 	record - The record, header and value.
+\param[in] 	length - The size of the record.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+static PdsStatus_t pdsLogProgram(uint8_t *record, uint16_t length)
+{
+	PdsLogRecordHeader_t *header = (PdsLogRecordHeader_t *)record;
+	PdsStatus_t status = pdsNvmProgram(logHeadRow, logHeadOffset, record, length);
+
+	if (PDS_OK != status)
+	{
+		/* Nothing more is appended after a failed program */
+		logHeadOffset = EEPROM_ROW_SIZE;
+		return status;
+	}
+	logIndex[header->fileId][header->itemIdx] = PDS_LOG_LOCATION(logHeadRow, logHeadOffset);
+	logHeadOffset += length;
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Appends the records of a row which are the latest of their item to
+		the head of the log.
+
+\param[in] 	rowIdx - The row the records are moved from.
+\param[in] 	rowBuffer - The content of the row.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+static PdsStatus_t pdsLogMoveRecords(uint16_t rowIdx, uint8_t *rowBuffer)
+{
+	uint16_t offset = PDS_LOG_ROW_HEADER_SIZE;
+	uint16_t end;
+	PdsStatus_t status;
+
+	while (0 != (end = pdsLogRecordEnd(rowBuffer, offset)))
+	{
+		PdsLogRecordHeader_t *header = (PdsLogRecordHeader_t *)&rowBuffer[offset];
+
+		if ((PDS_MAX_FILE_IDX > header->fileId) && (PDS_LOG_MAX_ITEMS > header->itemIdx) &&
+			(PDS_LOG_LOCATION(rowIdx, offset) == logIndex[header->fileId][header->itemIdx]))
+		{
+			status = pdsLogProgram(&rowBuffer[offset], end - offset);
+			if (PDS_OK != status)
+			{
+				return status;
+			}
+		}
+		offset = end;
+	}
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Reads a row and sums the sizes of the records which are the latest
+		of their item.
+
+\param[in] 	rowIdx - The row to be read.
+\param[in] 	rowBuffer - A buffer of the size of a row, holds the row on return.
+\param[out] - returns the number of bytes of these records
+******************************************************************************/
+static uint16_t pdsLogLiveSize(uint16_t rowIdx, uint8_t *rowBuffer)
+{
+	uint16_t offset = PDS_LOG_ROW_HEADER_SIZE;
+	uint16_t live = 0;
+	uint16_t end;
+
+	if (PDS_LOG_ROW_FOREIGN <= logRowSequence[rowIdx])
+	{
+		return 0;
+	}
+	if (PDS_OK != pdsNvmReadBytes(rowIdx, 0, rowBuffer, EEPROM_ROW_SIZE))
+	{
+		return EEPROM_ROW_SIZE;
+	}
+
+	while (0 != (end = pdsLogRecordEnd(rowBuffer, offset)))
+	{
+		PdsLogRecordHeader_t *header = (PdsLogRecordHeader_t *)&rowBuffer[offset];
+
+		if ((PDS_MAX_FILE_IDX > header->fileId) && (PDS_LOG_MAX_ITEMS > header->itemIdx) &&
+			(PDS_LOG_LOCATION(rowIdx, offset) == logIndex[header->fileId][header->itemIdx]))
+		{
+			live += end - offset;
+		}
+		offset = end;
+	}
+	return live;
+}
+
+/**************************************************************************//**
+\brief	Finds the row to be opened next: the first erased row following the
+		head, else the first row without a latest record of an item, which
+		can be erased without losing anything. There is none only when the
+		latest records fill the PDS area.
+
+\param[in] 	rowBuffer - A buffer of the size of a row.
+\param[out] - returns the row, EEPROM_NUM_ROWS if there is none
+******************************************************************************/
+static uint16_t pdsLogFreeRow(uint8_t *rowBuffer)
+{
+	uint16_t rowIdx;
+
+	for (uint16_t n = 1; n < EEPROM_NUM_ROWS; n++)
+	{
+		rowIdx = (uint16_t)((logHeadRow + n) % EEPROM_NUM_ROWS);
+		if (PDS_LOG_ROW_ERASED == logRowSequence[rowIdx])
+		{
+			return rowIdx;
+		}
+	}
+	for (uint16_t n = 1; n < EEPROM_NUM_ROWS; n++)
+	{
+		rowIdx = (uint16_t)((logHeadRow + n) % EEPROM_NUM_ROWS);
+		if (0 == pdsLogLiveSize(rowIdx, rowBuffer))
+		{
+			return rowIdx;
+		}
+	}
+	return EEPROM_NUM_ROWS;
+}
+
+/**************************************************************************//**
+\brief	Finds the row of the log with the lowest sequence number, other than
+		the head, when fewer than PDS_LOG_RESERVE_ROWS rows are erased.
+
+\param[out] - returns the row, EEPROM_NUM_ROWS if there is none or if enough
+			  rows are erased
+******************************************************************************/
+static uint16_t pdsLogOldestRow(void)
+{
+	uint16_t oldestRow = EEPROM_NUM_ROWS;
+	uint16_t erasedRows = 0;
+
+	for (uint16_t rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
+	{
+		if (PDS_LOG_ROW_ERASED == logRowSequence[rowIdx])
+		{
+			erasedRows++;
+		}
+		if ((rowIdx != logHeadRow) && (logRowSequence[rowIdx] < PDS_LOG_ROW_FOREIGN) &&
+			((EEPROM_NUM_ROWS == oldestRow) || (logRowSequence[rowIdx] < logRowSequence[oldestRow])))
+		{
+			oldestRow = rowIdx;
+		}
+	}
+	return (erasedRows < PDS_LOG_RESERVE_ROWS) ? oldestRow : EEPROM_NUM_ROWS;
+}
+
+/**************************************************************************//**
+\brief	Opens a new head of the log. When few rows are left erased the oldest
+		row is then compacted: its latest records are moved into the new head
+		and it is erased. A record is never erased before its copy is
+		programmed; after a reset during a compaction the replay in the order
+		of the sequence numbers finds the copies, and the rest of the row is
+		compacted later.
+
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+static PdsStatus_t pdsLogOpenRow(void)
+{
+	uint8_t rowBuffer[EEPROM_ROW_SIZE];
+	PdsLogRowHeader_t rowHeader;
+	uint16_t rowIdx = pdsLogFreeRow(rowBuffer);
+	uint16_t oldestRow;
+	PdsStatus_t status;
+
+	if (EEPROM_NUM_ROWS == rowIdx)
+	{
+		return PDS_NOT_ENOUGH_MEMORY;
+	}
+	if (PDS_LOG_ROW_ERASED != logRowSequence[rowIdx])
+	{
+		/* Records all superseded, a torn erase or another format */
+		status = pdsNvmErase(rowIdx);
+		if (PDS_OK != status)
+		{
+			return status;
+		}
+		logRowSequence[rowIdx] = PDS_LOG_ROW_ERASED;
+	}
+
+	rowHeader.magic = PDS_MAGIC;
+	rowHeader.version = PDS_LOG_VERSION;
+	rowHeader.sequence = logSequence + 1;
+	rowHeader.crc = pdsLogCrc((uint8_t *)&rowHeader, offsetof(PdsLogRowHeader_t, crc));
+	status = pdsNvmProgram(rowIdx, 0, (uint8_t *)&rowHeader, PDS_LOG_ROW_HEADER_SIZE);
+	if (PDS_OK != status)
+	{
+		return status;
+	}
+	logSequence = rowHeader.sequence;
+	logRowSequence[rowIdx] = logSequence;
+	logHeadRow = rowIdx;
+	logHeadOffset = PDS_LOG_ROW_HEADER_SIZE;
+
+	/* The latest records of a row always fit into an empty row */
+	oldestRow = pdsLogOldestRow();
+	if ((EEPROM_NUM_ROWS != oldestRow) &&
+		(pdsLogLiveSize(oldestRow, rowBuffer) <= (EEPROM_ROW_SIZE - logHeadOffset)))
+	{
+		status = pdsLogMoveRecords(oldestRow, rowBuffer);
+		if (PDS_OK == status)
+		{
+			status = pdsNvmErase(oldestRow);
+		}
+		if (PDS_OK != status)
+		{
+			return status;
+		}
+		logRowSequence[oldestRow] = PDS_LOG_ROW_ERASED;
+	}
+
+	return PDS_OK;
+}
+
+#endif
+/* eof pds_log.c */
@@ -36,7 +36,7 @@
 * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
 */
 
-#if (ENABLE_PDS == 1)
+#if (ENABLE_PDS == 1) && !defined(PDS_LOG_ENABLE)
 /******************************************************************************
                    Includes section
 ******************************************************************************/
@@ -54,12 +54,19 @@
 /************************************************************************/
 static RowMap_t rowMap[EEPROM_NUM_ROWS];
 static FileMap_t fileMap[PDS_MAX_FILE_IDX];
+/* Bit set for the rows holding the latest copy of a file, the others are free */
+static uint32_t usedRows[PDS_WL_ROW_WORDS];
+/* Free rows are taken in a ring from this row on */
+static uint16_t nextRowIdx;
+/* Highest counter in the rows, the next copy gets a higher one */
+static uint32_t lastCounter;
 
 /******************************************************************************
                    Static prototype section
 ******************************************************************************/
-static void pdsUpdateRowMap(void);
-static void pdsUpdateFileMap(UpdateFileMap_t *updateFileMap);
+static void pdsResetMaps(void);
+static void pdsMarkRow(uint16_t rowIdx, bool used);
+static uint16_t pdsLatestRowIdx(uint16_t memId);
 static uint16_t pdsReturnFreeRowIdx(void);
 
 /******************************************************************************
@@ -67,7 +74,9 @@ static uint16_t pdsReturnFreeRowIdx(void);
 ******************************************************************************/
 
 /**************************************************************************//**
-\brief Initializes the WL PDS by updating the row and file map.
+\brief Initializes the WL PDS by updating the row and file map. Only the
+		headers of the rows are read; the latest copy of every file is then
+		read once to check its CRC.
 
 \param[in] none
 \param[out] status - The return status of the function's operation of type PdsStatus_t.
@@ -81,27 +90,52 @@ PdsStatus_t pdsWlInit(void)
 		return status;
 	}
 	PdsMem_t buffer;
-	memset(&rowMap, UCHAR_MAX, EEPROM_NUM_ROWS * sizeof(RowMap_t));
-    memset(&fileMap, UCHAR_MAX, PDS_MAX_FILE_IDX * sizeof(FileMap_t));
-	memset(&buffer, 0, sizeof(PdsMem_t));
-    UpdateFileMap_t updateFileMap;
-	
-    for(uint8_t rowIdx = 0; rowIdx< EEPROM_NUM_ROWS; rowIdx++)
-    {
-		status = pdsNvmRead(rowIdx, &buffer, EEPROM_ROW_SIZE);
-		if (PDS_OK == status)
+	PdsWlHeader_t *wlHeader = &buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader;
+	uint16_t lastRowIdx = USHRT_MAX;
+
+	pdsResetMaps();
+	for (uint16_t rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
+	{
+		status = pdsNvmReadBytes(rowIdx, 0, buffer.NVM_Mem.pdsNvmMem, PDS_NVM_HEADER_SIZE + PDS_WL_HEADER_SIZE);
+		if ((PDS_OK == status) && (PDS_MAGIC == wlHeader->magicNo) && (PDS_WL_VERSION == wlHeader->version) &&
+			(wlHeader->memId < PDS_MAX_FILE_IDX) && (UINT_MAX != wlHeader->counter))
+		{
+			uint16_t *maxCounterRowIdx = &fileMap[wlHeader->memId].maxCounterRowIdx;
+
+			rowMap[rowIdx].counter = wlHeader->counter;
+			rowMap[rowIdx].memId = wlHeader->memId;
+			rowMap[rowIdx].size = buffer.NVM_Struct.pdsNvmHeader.size;
+			if ((USHRT_MAX == *maxCounterRowIdx) || (rowMap[*maxCounterRowIdx].counter < wlHeader->counter))
+			{
+				*maxCounterRowIdx = rowIdx;
+			}
+			if ((USHRT_MAX == lastRowIdx) || (lastCounter < wlHeader->counter))
+			{
+				lastCounter = wlHeader->counter;
+				lastRowIdx = rowIdx;
+			}
+		}
+	}
+
+	for (uint16_t memId = 0; memId < PDS_MAX_FILE_IDX; memId++)
+	{
+		uint16_t rowIdx = fileMap[memId].maxCounterRowIdx;
+
+		/* A copy cut by a reset fails its CRC, the copy before it is then the latest */
+		while ((USHRT_MAX != rowIdx) && (PDS_OK != pdsNvmRead(rowIdx, &buffer, rowMap[rowIdx].size)))
 		{
-			rowMap[rowIdx].counter = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
-            rowMap[rowIdx].memId = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.memId;
-            rowMap[rowIdx].previousIdx = USHRT_MAX;
-            updateFileMap.counter = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
-            updateFileMap.memId = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.memId;
-            updateFileMap.rowIdx = rowIdx;
-            pdsUpdateFileMap(&updateFileMap);
+			rowMap[rowIdx].counter = UINT_MAX;
+			rowMap[rowIdx].memId = USHRT_MAX;
+			rowIdx = pdsLatestRowIdx(memId);
 		}
-    }
-    pdsUpdateRowMap();
-	
+		fileMap[memId].maxCounterRowIdx = rowIdx;
+		if (USHRT_MAX != rowIdx)
+		{
+			pdsMarkRow(rowIdx, true);
+		}
+	}
+	nextRowIdx = (USHRT_MAX == lastRowIdx) ? 0 : ((lastRowIdx + 1) % EEPROM_NUM_ROWS);
+
 	return PDS_OK;
 }
 
@@ -117,28 +151,36 @@ PdsStatus_t pdsWlInit(void)
 ******************************************************************************/
 PdsStatus_t pdsWlWrite(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size)
 {
-	UpdateFileMap_t updateFileMap;
 	PdsStatus_t status = PDS_OK;
-	uint32_t counter;
-    uint16_t rowIdx = pdsReturnFreeRowIdx();
-	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter++;
+	uint16_t rowIdx = pdsReturnFreeRowIdx();
+	uint16_t previousRowIdx = fileMap[pdsFileItemIdx].maxCounterRowIdx;
+
+	if (USHRT_MAX == rowIdx)
+	{
+		return PDS_NOT_ENOUGH_MEMORY;
+	}
+	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter = ++lastCounter;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.memId = pdsFileItemIdx;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.magicNo = PDS_MAGIC;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.version = PDS_WL_VERSION;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.size = size;
-	counter = buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
 	size += sizeof(PdsWlHeader_t);
 
+	/* The next write goes to the next row even if this one fails */
+	nextRowIdx = (rowIdx + 1) % EEPROM_NUM_ROWS;
 	status = pdsNvmWrite(rowIdx, buffer, size);
 	if (PDS_OK == status)
 	{
-		rowMap[rowIdx].counter = counter;
+		rowMap[rowIdx].counter = lastCounter;
 		rowMap[rowIdx].memId = pdsFileItemIdx;
-		rowMap[rowIdx].previousIdx = USHRT_MAX;
-		updateFileMap.counter = rowMap[rowIdx].counter;
-		updateFileMap.memId = rowMap[rowIdx].memId;
-		updateFileMap.rowIdx = rowIdx;
-		pdsUpdateFileMap(&updateFileMap);
+		rowMap[rowIdx].size = buffer->NVM_Struct.pdsNvmHeader.size;
+		fileMap[pdsFileItemIdx].maxCounterRowIdx = rowIdx;
+		pdsMarkRow(rowIdx, true);
+		if (USHRT_MAX != previousRowIdx)
+		{
+			/* The previous copy is kept until now, a cut write leaves it in place */
+			pdsMarkRow(previousRowIdx, false);
+		}
 	}
 	
 	return status;
@@ -169,127 +211,87 @@ PdsStatus_t pdsWlRead(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_
 }
 
 /**************************************************************************//**
-\brief	Updates the row map so that the old entries of the file are erased
-		in the row map.
+\brief	Clears the row and file maps: no file is found and every row is free.
 
 \param[in] - return none
 ******************************************************************************/
-static void pdsUpdateRowMap()
+static void pdsResetMaps(void)
 {
-	uint16_t rowIdx = USHRT_MAX;
-    for(uint16_t memId = 0, rowIdxLocal = 0 ; memId < PDS_MAX_FILE_IDX; memId++)
-    {
-		
-        // make all the previous indexes of the max_counter_row_idx invalid by writing 0xFF
-		if(USHRT_MAX != fileMap[memId].maxCounterRowIdx)
-		{
-			rowIdx = rowMap[fileMap[memId].maxCounterRowIdx].previousIdx;
-			rowMap[fileMap[memId].maxCounterRowIdx].previousIdx = USHRT_MAX;
-			while(rowIdx != USHRT_MAX)
-			{
-				rowIdxLocal = rowMap[rowIdx].previousIdx;
-				rowMap[rowIdx].previousIdx = USHRT_MAX;
-				rowMap[rowIdx].counter = UINT_MAX;
-				rowMap[rowIdx].memId = USHRT_MAX;
-				rowIdx = rowIdxLocal;
-			}
-		}
-    }
+	memset(&rowMap, UCHAR_MAX, EEPROM_NUM_ROWS * sizeof(RowMap_t));
+	memset(&fileMap, UCHAR_MAX, PDS_MAX_FILE_IDX * sizeof(FileMap_t));
+	memset(&usedRows, 0, sizeof(usedRows));
+	if (EEPROM_NUM_ROWS % 32)
+	{
+		/* The bits past the last row are never free */
+		usedRows[PDS_WL_ROW_WORDS - 1] = UINT32_MAX << (EEPROM_NUM_ROWS % 32);
+	}
+	nextRowIdx = 0;
+	lastCounter = 0;
 }
 
 /**************************************************************************//**
-\brief Updates the file map so that it points to the latest row index for a file id.
+\brief	Marks a row as holding the latest copy of a file or as free.
 
-\param[out] - returns none
+\param[in] 	rowIdx - The row.
+\param[in] 	used - true if the row holds the latest copy of a file.
 ******************************************************************************/
-static void pdsUpdateFileMap(UpdateFileMap_t *updateFileMap)
+static void pdsMarkRow(uint16_t rowIdx, bool used)
 {
-    uint16_t *presentRowIdx;
-    uint16_t *previousRowIdx;
-    uint16_t *lastRowIdx;
-    uint16_t prevTemp;
-    if(USHRT_MAX == fileMap[updateFileMap->memId].maxCounterRowIdx)
-    {   
-		/* If there is no entry in filemap update current rowidx as maxcounteridx*/
-        fileMap[updateFileMap->memId].maxCounterRowIdx = updateFileMap->rowIdx;
-
-    }
-    else if(rowMap[fileMap[updateFileMap->memId].maxCounterRowIdx].counter < rowMap[updateFileMap->rowIdx].counter)
-    {
-        /* If the entry in filemap is lesser than  current rowidx update current idx as maxcounteridx*/
-		// update the max counter rowIdx of the memId as previous_idx in the present row
-        rowMap[updateFileMap->rowIdx].previousIdx = fileMap[updateFileMap->memId].maxCounterRowIdx;
-        fileMap[updateFileMap->memId].maxCounterRowIdx = updateFileMap->rowIdx;
-
-    }
-	else if (rowMap[fileMap[updateFileMap->memId].maxCounterRowIdx].counter == rowMap[updateFileMap->rowIdx].counter)
-	{
+	uint32_t mask = 1UL << (rowIdx % 32);
 
-		return;
+	if (used)
+	{
+		usedRows[rowIdx / 32] |= mask;
 	}
-    else
-    {
-        previousRowIdx = &rowMap[fileMap[updateFileMap->memId].maxCounterRowIdx].previousIdx;
-        presentRowIdx = &updateFileMap->rowIdx;
-        lastRowIdx = &fileMap[updateFileMap->memId].maxCounterRowIdx;
-		do
-		{
-			if (USHRT_MAX == *previousRowIdx)
-			{
-				*previousRowIdx = *presentRowIdx;
-				break;
-			}
-			if (rowMap[*previousRowIdx].counter > rowMap[*presentRowIdx].counter)
-			{
-				lastRowIdx = previousRowIdx;
-				previousRowIdx = &rowMap[*previousRowIdx].previousIdx;
-			}
-			else
-			{
-			    prevTemp = *previousRowIdx;
-				rowMap[*lastRowIdx].previousIdx = *presentRowIdx;
-				rowMap[*presentRowIdx].previousIdx = prevTemp;
-				break;
-			}
-		} while(true);
+	else
+	{
+		usedRows[rowIdx / 32] &= ~mask;
+	}
+}
 
-    }
+/**************************************************************************//**
+\brief	Finds the row with the highest counter of a file in the row map.
+
+\param[in] 	memId - The file id.
+\param[out] - returns the row index, USHRT_MAX if no row holds the file
+******************************************************************************/
+static uint16_t pdsLatestRowIdx(uint16_t memId)
+{
+	uint16_t latestRowIdx = USHRT_MAX;
+
+	for (uint16_t rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
+	{
+		if ((memId == rowMap[rowIdx].memId) &&
+			((USHRT_MAX == latestRowIdx) || (rowMap[latestRowIdx].counter < rowMap[rowIdx].counter)))
+		{
+			latestRowIdx = rowIdx;
+		}
+	}
+	return latestRowIdx;
 }
 
 /**************************************************************************//**
-\brief Finds free row index by scanning the row map.
+\brief Finds the first free row from the ring position on, a word of the row
+		bitmap at a time.
 
-\param[out] - returns free row index
+\param[out] - returns free row index, USHRT_MAX if there is none
 ******************************************************************************/
 static uint16_t pdsReturnFreeRowIdx(void)
 {
-    uint8_t rowIdx;
-    bool found = 0;
-    for(rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
-    {
-        if( (UINT_MAX == rowMap[rowIdx].counter) &&
-            (USHRT_MAX == rowMap[rowIdx].previousIdx) &&
-            (USHRT_MAX == rowMap[rowIdx].memId) )
-        {
-            found = 1;
-            break;
-        }
-    }
-
-    if(!found)
-    {
-        pdsUpdateRowMap();
-        for(rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
-        {
-            if( (UINT_MAX == rowMap[rowIdx].counter) &&
-                (USHRT_MAX == rowMap[rowIdx].previousIdx) &&
-                (USHRT_MAX == rowMap[rowIdx].memId))
-            {
-                break;
-            }
-        }
-    }
-	return rowIdx;
+	uint16_t wordIdx = nextRowIdx / 32;
+	uint32_t freeRows = ~usedRows[wordIdx] & (UINT32_MAX << (nextRowIdx % 32));
+
+	/* The word of the ring position is visited again for the rows before it */
+	for (uint16_t words = 0; words <= PDS_WL_ROW_WORDS; words++)
+	{
+		if (freeRows)
+		{
+			return (uint16_t)((wordIdx * 32) + __builtin_ctz(freeRows));
+		}
+		wordIdx = (wordIdx + 1) % PDS_WL_ROW_WORDS;
+		freeRows = ~usedRows[wordIdx];
+	}
+	return USHRT_MAX;
 }
 
 /**************************************************************************//**
@@ -312,10 +314,8 @@ bool isFileFound(PdsFileItemIdx_t pdsFileItemIdx)
 
 void pdsWlDeleteAll(void)
 {
-	/* Clear Filemap array */
-	memset(&rowMap, UCHAR_MAX, EEPROM_NUM_ROWS * sizeof(RowMap_t));
-	/* Clear Row Map Array */
-    memset(&fileMap, UCHAR_MAX, PDS_MAX_FILE_IDX * sizeof(FileMap_t));
+	/* Clear the file and row maps */
+	pdsResetMaps();
 	/* Call NVM Erase All */
 	pdsNvmEraseAll();
 }
@@ -40,7 +40,9 @@
 /************************************************************************/
 #include "radio_interface.h"
 #include "radio_registers_SX1276.h"
+#include "radio_driver_SX1276.h"
 #include "radio_driver_hal.h"
+#include "system_trace.h"
 #include <delay.h>
 /************************************************************************/
 /*  Defines                                                             */
@@ -88,14 +90,14 @@ void RADIO_UnhandledInterrupt(RadioModulation_t modulation)
     // those registers directly.
     if (MODULATION_LORA == modulation)
     {
-        RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 0xFF);
+        Radio_WriteRegister(REG_LORA_IRQFLAGS, 0xFF);
     }
     else
     {
         // Although just some of the bits can be cleared, try to clear
         // everything
-        RADIO_RegisterWrite(REG_FSK_IRQFLAGS1, 0xFF);
-        RADIO_RegisterWrite(REG_FSK_IRQFLAGS2, 0xFF);
+        Radio_WriteRegister(REG_FSK_IRQFLAGS1, 0xFF);
+        Radio_WriteRegister(REG_FSK_IRQFLAGS2, 0xFF);
     }
 }
 
@@ -105,10 +107,11 @@ void RADIO_UnhandledInterrupt(RadioModulation_t modulation)
 *************************************************************************/
 void RADIO_DIO0(void)
 {
-
     uint8_t dioMapping;
     uint8_t opMode;
 
+    SYSTEM_TRACE_EVENT(SYSTEM_TRACE_RADIO_DIO, 0, 0, 0);
+
     // Check radio configuration (modulation and DIO0 settings).
     RADIO_getMappingAndOpmode(&dioMapping, &opMode, 0xC0, SHIFT6);
 
@@ -163,10 +166,11 @@ void RADIO_DIO0(void)
 *************************************************************************/
 void RADIO_DIO1(void)
 {
-
     uint8_t dioMapping;
     uint8_t opMode;
 
+    SYSTEM_TRACE_EVENT(SYSTEM_TRACE_RADIO_DIO, 1, 0, 0);
+
     // Check radio configuration (modulation and DIO1 settings).
     RADIO_getMappingAndOpmode(&dioMapping, &opMode, 0x30, SHIFT4);
 
@@ -220,10 +224,11 @@ void RADIO_DIO1(void)
 *************************************************************************/
 void RADIO_DIO2(void)
 {
-
     uint8_t dioMapping;
     uint8_t opMode;
 
+    SYSTEM_TRACE_EVENT(SYSTEM_TRACE_RADIO_DIO, 2, 0, 0);
+
     // Check radio configuration (modulation and DIO2 settings).
     RADIO_getMappingAndOpmode(&dioMapping, &opMode, 0x0C, SHIFT2);
 
@@ -270,10 +275,11 @@ void RADIO_DIO2(void)
 *************************************************************************/
 void RADIO_DIO3(void)
 {
-
     uint8_t dioMapping;
     uint8_t opMode;
 
+    SYSTEM_TRACE_EVENT(SYSTEM_TRACE_RADIO_DIO, 3, 0, 0);
+
     // Check radio configuration (modulation and DIO3 settings).
     RADIO_getMappingAndOpmode(&dioMapping, &opMode, 0x03, 0);
 
@@ -300,10 +306,11 @@ void RADIO_DIO3(void)
 *************************************************************************/
 void RADIO_DIO4(void)
 {
-
     uint8_t dioMapping;
     uint8_t opMode;
 
+    SYSTEM_TRACE_EVENT(SYSTEM_TRACE_RADIO_DIO, 4, 0, 0);
+
     // Check radio configuration (modulation and DIO4 settings).
     RADIO_getMappingAndOpmode(&dioMapping, &opMode,  0xC0, SHIFT6);
 
@@ -330,10 +337,11 @@ void RADIO_DIO4(void)
 *************************************************************************/
 void RADIO_DIO5(void)
 {
-
     uint8_t dioMapping;
     uint8_t opMode;
 
+    SYSTEM_TRACE_EVENT(SYSTEM_TRACE_RADIO_DIO, 5, 0, 0);
+
     // Check radio configuration (modulation and DIO5 settings).
     RADIO_getMappingAndOpmode(&dioMapping, &opMode, 0x30, SHIFT4);
 
@@ -362,8 +370,8 @@ void RADIO_DIO5(void)
 *************************************************************************/
 static void RADIO_getMappingAndOpmode(uint8_t *dioMapping, uint8_t *opMode, uint8_t mask, uint8_t shift)
 {
-    *dioMapping = (RADIO_RegisterRead(REG_DIOMAPPING1) & mask) >> shift;
-    *opMode = RADIO_RegisterRead(REG_OPMODE);
+    *dioMapping = (Radio_ReadRegister(REG_DIOMAPPING1) & mask) >> shift;
+    *opMode = Radio_ReadRegister(REG_OPMODE);
 }
 
 /* eof radio_interface.c */
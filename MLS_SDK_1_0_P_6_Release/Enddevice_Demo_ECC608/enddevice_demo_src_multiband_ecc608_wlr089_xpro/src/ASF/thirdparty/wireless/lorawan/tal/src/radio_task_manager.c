@@ -40,35 +40,17 @@
                    Includes section
 ******************************************************************************/
 #include "radio_task_manager.h"
-#include "atomic.h"
 #include <stdint.h>
 
-/************************************************************************/
-/*  Static variables                                                    */
-/************************************************************************/
-
-/**************************************************************************//**
-\brief radioTaskFlags - 16-bit bitmap for the tasks of RADIO layer.
-******************************************************************************/
-static volatile uint16_t radioTaskFlags = 0x0000u;
-
-/**************************************************************************//**
-\brief Array of radio task handlers.
-******************************************************************************/
-static SYSTEM_TaskStatus_t (*radioTaskHandlers[RADIO_TASKS_COUNT])(void) = {
-    /* In the order of descending priority */
-    RADIO_TxDoneHandler,
-    RADIO_RxDoneHandler,
-    RADIO_TxHandler,
-    RADIO_RxHandler,
-	RADIO_ScanHandler
-    /* , RADIO_SleepHandler */
-};
-
 /******************************************************************************
-                   Prototypes section
+                   Defines section
 ******************************************************************************/
-SYSTEM_TaskStatus_t RADIO_TaskHandler(void);
+/* RADIO subtasks occupy consecutive scheduler slots from SYSTEM_RADIO_TASK_IDX */
+#if (RADIO_TASKS_COUNT > (SYSTEM_LORAWAN_TASK_IDX - SYSTEM_RADIO_TASK_IDX))
+#error "RADIO subtasks exceed the scheduler slots of the RADIO layer"
+#endif
+
+#define RADIO_TASKS_MASK    ((SYSTEM_TaskMask_t)((1u << RADIO_TASKS_COUNT) - 1u))
 
 /******************************************************************************
                    Implementations section
@@ -80,12 +62,8 @@ SYSTEM_TaskStatus_t RADIO_TaskHandler(void);
 ******************************************************************************/
 void radioPostTask(RadioTaskIds_t id)
 {
-    ATOMIC_SECTION_ENTER
-    radioTaskFlags |= id;
-    ATOMIC_SECTION_EXIT
-
-    /* Also post a RADIO task to the system */
-    SYSTEM_PostTask(RADIO_TASK_ID);
+    /* Each RADIO subtask is dispatched directly by the system scheduler */
+    SYSTEM_PostTask(((SYSTEM_TaskMask_t)id & RADIO_TASKS_MASK) << SYSTEM_RADIO_TASK_IDX);
 }
 
 /**************************************************************************//**
@@ -95,47 +73,7 @@ void radioPostTask(RadioTaskIds_t id)
 ******************************************************************************/
 void radioClearTask(RadioTaskIds_t id)
 {
-    ATOMIC_SECTION_ENTER
-    radioTaskFlags &= ~id;
-    ATOMIC_SECTION_EXIT
-}
-
-/**************************************************************************//**
-\brief RADIO task handler.
-******************************************************************************/
-SYSTEM_TaskStatus_t RADIO_TaskHandler(void)
-{
-    if (radioTaskFlags)
-    {
-        for (uint16_t taskId = 0; taskId < RADIO_TASKS_COUNT; taskId++)
-        {
-            if ((1 << taskId) & (radioTaskFlags))
-            {
-
-                ATOMIC_SECTION_ENTER
-                radioTaskFlags &= ~(1 << taskId);
-                ATOMIC_SECTION_EXIT
-
-                radioTaskHandlers[taskId]();
-
-                if (radioTaskFlags)
-                {
-                    SYSTEM_PostTask(RADIO_TASK_ID);
-                }
-                
-                break;
-            }
-        }
-    }
-    /*
-     * else
-     * {
-     *   radioPostTask(RADIO_SLEEP_TASK_ID);
-       * SYSTEM_PostTask(RADIO_TASK_ID);
-     * }
-     */
-
-    return SYSTEM_TASK_SUCCESS;
+    SYSTEM_ClearTask(((SYSTEM_TaskMask_t)id & RADIO_TASKS_MASK) << SYSTEM_RADIO_TASK_IDX);
 }
 
 /* eof radio_task_manager.c */
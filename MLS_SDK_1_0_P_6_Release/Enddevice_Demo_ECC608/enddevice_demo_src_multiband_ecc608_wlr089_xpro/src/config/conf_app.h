@@ -44,7 +44,9 @@
 /****************************** MACROS **************************************/
 
 /* Number of software timers */
+#ifndef TOTAL_NUMBER_OF_TIMERS
 #define TOTAL_NUMBER_OF_TIMERS            (25u)
+#endif
 
 /* If enabled, app will use preprogrammed devEUI from module's NVM location */
 #if (MODULE_EUI_READ == 1)
@@ -48,6 +48,7 @@
 #include "sleep_timer.h"
 #endif
 #include "pds_interface.h"
+#include "pds_task_handler.h"
 #include "sal.h"
 #include "sio2host.h"
 #include "enddevice_demo.h"
@@ -63,7 +64,16 @@ static void driverInit(void);
 /* Print the cause for the latest reset in console */
 static void printResetCause(void);
 
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+/* Warn of a supply drop with an interrupt of the BOD33 */
+static void brownoutInit(void);
+#endif
+
 //============================== GLOBAL VARIABLES ==============================
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+/* Set by the BOD33 interrupt, the PDS is flushed from the main loop */
+static volatile bool brownoutDetected = false;
+#endif
 
 //================================== EXTERNS ===================================
 
@@ -137,6 +147,39 @@ static void printResetCause(void)
 }
 //------------------------------------------------------------------------------
 
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+static void brownoutInit(void)
+{
+    uint32_t bod33 = SUPC->BOD33.reg & ~(SUPC_BOD33_ENABLE | SUPC_BOD33_ACTION_Msk);
+
+    /* The BOD33 interrupts instead of resetting the device so that the
+       deferred PDS writes are done before the supply is lost. The level
+       stays the one of the user row. The action can only be changed while
+       the BOD33 is disabled. */
+    SUPC->BOD33.reg = bod33;
+    SUPC->BOD33.reg = bod33 | SUPC_BOD33_ACTION_INT | SUPC_BOD33_HYST | SUPC_BOD33_ENABLE;
+    while (!(SUPC->STATUS.reg & SUPC_STATUS_BOD33RDY));
+
+    SUPC->INTFLAG.reg = SUPC_INTFLAG_BOD33DET;
+    SUPC->INTENSET.reg = SUPC_INTENSET_BOD33DET;
+    NVIC_EnableIRQ(SYSTEM_IRQn);
+}
+//------------------------------------------------------------------------------
+
+/* Brownout of the BOD33 */
+void SYSTEM_Handler(void)
+{
+    if (SUPC->INTFLAG.reg & SUPC_INTFLAG_BOD33DET)
+    {
+        SUPC->INTFLAG.reg = SUPC_INTFLAG_BOD33DET;
+
+        /* The interrupted code may be writing or erasing the NVM */
+        brownoutDetected = true;
+    }
+}
+//------------------------------------------------------------------------------
+#endif
+
 /* Main function of Enddevice demo application */
 int main(void)
 {
@@ -162,6 +205,11 @@ int main(void)
     /* Initialize Hardware and Software Modules */
 	driverInit();
 
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+    /* Flush the deferred PDS writes on a brownout */
+    brownoutInit();
+#endif
+
     /* Initialize demo application */
     mote_demo_init();
 
@@ -175,6 +223,16 @@ int main(void)
 
         /* Run all the posted tasks */
         SYSTEM_RunTasks();
+
+#if (ENABLE_PDS == 1) && (PDS_WRITE_DELAY_MS > 0)
+        if (brownoutDetected)
+        {
+            /* Write what the PDS still holds, then reset as the BOD33 would
+               have done: the device keeps resetting until the supply is back */
+            PDS_Flush();
+            NVIC_SystemReset();
+        }
+#endif
     }
 }
 //------------------------------------------------------------------------------
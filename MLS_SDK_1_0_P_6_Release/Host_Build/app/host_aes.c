@@ -0,0 +1,413 @@
+/**
+* \file  host_aes.c
+*
+* \brief Software AES engines of the stack against the model of the peripheral
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "aes_engine.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Largest number of blocks of one operation of the checks */
+#define HOST_AES_MAX_BLOCKS             (16u)
+
+/* FRMPayload and MIC sizes of the measurements, like the MAC benchmark */
+#define HOST_AES_CTR_LENGTH             (222u)
+#define HOST_AES_CBCMAC_BLOCKS          (15u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Entry points of an AES engine */
+typedef struct _HostAesEngine
+{
+	const char *name;
+	void (*init)(void);
+	void (*encode)(unsigned char *block, unsigned char *key);
+	void (*sessionStart)(unsigned char *key);
+	void (*sessionEncode)(unsigned char *blocks, uint16_t count);
+	void (*sessionCtr)(unsigned char *output, unsigned char *input, uint16_t length, unsigned char *counter);
+	void (*sessionCbcMac)(unsigned char *chain, unsigned char *input, uint16_t count);
+} HostAesEngine_t;
+
+typedef struct _HostAesOptions
+{
+	uint32_t checks;
+	uint32_t repetitions;
+	uint32_t seed;
+} HostAesOptions_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/* Software engines of the stack sources, renamed by the build */
+void AESCompactInit(void);
+void AESCompactEncode(unsigned char *block, unsigned char *key);
+void AESCompactSessionStart(unsigned char *key);
+void AESCompactSessionEncode(unsigned char *blocks, uint16_t count);
+void AESCompactSessionCtr(unsigned char *output, unsigned char *input, uint16_t length, unsigned char *counter);
+void AESCompactSessionCbcMac(unsigned char *chain, unsigned char *input, uint16_t count);
+void AESTTableInit(void);
+void AESTTableEncode(unsigned char *block, unsigned char *key);
+void AESTTableSessionStart(unsigned char *key);
+void AESTTableSessionEncode(unsigned char *blocks, uint16_t count);
+void AESTTableSessionCtr(unsigned char *output, unsigned char *input, uint16_t length, unsigned char *counter);
+void AESTTableSessionCbcMac(unsigned char *chain, unsigned char *input, uint16_t count);
+
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static uint32_t nextRandom(void);
+static void fillRandom(uint8_t *buffer, uint16_t length);
+static bool checkVector(const HostAesEngine_t *engine);
+static bool checkRandom(void);
+static void measure(const HostAesEngine_t *engine);
+static uint64_t readCycles(void);
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostAesOptions_t options = {
+	.checks = 100000,
+	.repetitions = 2000,
+	.seed = 1
+};
+
+/* The model of the peripheral first, every engine is checked against it */
+static const HostAesEngine_t engines[] = {
+	{ "model", AESInit, AESEncode, AESSessionStart, AESSessionEncode, AESSessionCtr, AESSessionCbcMac },
+	{ "compact", AESCompactInit, AESCompactEncode, AESCompactSessionStart, AESCompactSessionEncode,
+		AESCompactSessionCtr, AESCompactSessionCbcMac },
+	{ "ttable", AESTTableInit, AESTTableEncode, AESTTableSessionStart, AESTTableSessionEncode,
+		AESTTableSessionCtr, AESTTableSessionCbcMac }
+};
+
+#define HOST_AES_ENGINES                (sizeof(engines) / sizeof(engines[0]))
+
+static uint32_t randomState;
+
+/* Keeps the timing loops from being optimized away */
+static volatile uint8_t sink;
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -n <n>         random operations checked against the model (default %u)\n"
+		"  -r <n>         repetitions of each measurement (default %u)\n"
+		"  -s <n>         seed of the random operations (default %u)\n",
+		name, (unsigned int)options.checks, (unsigned int)options.repetitions, (unsigned int)options.seed);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "n:r:s:h")))
+	{
+		switch (opt)
+		{
+			case 'n':
+				options.checks = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'r':
+				options.repetitions = (uint32_t)strtoul(optarg, NULL, 0);
+				if (0 == options.repetitions)
+				{
+					options.repetitions = 1;
+				}
+				break;
+			case 's':
+				options.seed = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				usage(argv[0]);
+				exit((opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief xorshift32, the same sequence for a given seed on every host
+******************************************************************************/
+static uint32_t nextRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void fillRandom(uint8_t *buffer, uint16_t length)
+{
+	for (uint16_t i = 0; i < length; i++)
+	{
+		buffer[i] = (uint8_t)nextRandom();
+	}
+}
+
+/**************************************************************************//**
+\brief Example vector of FIPS-197 (appendix C.1), through AESEncode() and
+       through a session
+******************************************************************************/
+static bool checkVector(const HostAesEngine_t *engine)
+{
+	static const uint8_t plaintext[BLOCKSIZE] = {
+		0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+	};
+	static const uint8_t ciphertext[BLOCKSIZE] = {
+		0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+	};
+	uint8_t key[BLOCKSIZE];
+	uint8_t block[BLOCKSIZE];
+	bool passed;
+
+	for (uint8_t i = 0; i < BLOCKSIZE; i++)
+	{
+		key[i] = i;
+	}
+
+	engine->init();
+	memcpy(block, plaintext, BLOCKSIZE);
+	engine->encode(block, key);
+	passed = (0 == memcmp(block, ciphertext, BLOCKSIZE));
+
+	memcpy(block, plaintext, BLOCKSIZE);
+	engine->sessionStart(key);
+	engine->sessionEncode(block, 1);
+	passed &= (0 == memcmp(block, ciphertext, BLOCKSIZE));
+
+	printf("%-16s : FIPS-197 C.1 %s\n", engine->name, passed ? "ok" : "FAILED");
+	return passed;
+}
+
+/**************************************************************************//**
+\brief Random operations run by every engine and compared with the model:
+       single blocks with their own key, ECB, CTR (the 16-bit counter wraps)
+       and CBC-MAC. The session key changes one time in four; a session call
+       after AESEncode() without a new session start must still use the key
+       of the session, like the peripheral.
+******************************************************************************/
+static bool checkRandom(void)
+{
+	uint8_t sessionKey[BLOCKSIZE];
+	uint8_t key[BLOCKSIZE];
+	uint8_t counter[BLOCKSIZE];
+	uint8_t input[HOST_AES_MAX_BLOCKS * BLOCKSIZE];
+	uint8_t output[HOST_AES_ENGINES][HOST_AES_MAX_BLOCKS * BLOCKSIZE];
+	uint32_t failed[HOST_AES_ENGINES] = {0};
+	bool passed = true;
+
+	randomState = options.seed ? options.seed : 1;
+	fillRandom(sessionKey, BLOCKSIZE);
+	for (uint8_t e = 0; e < HOST_AES_ENGINES; e++)
+	{
+		engines[e].init();
+		engines[e].sessionStart(sessionKey);
+	}
+
+	for (uint32_t n = 0; n < options.checks; n++)
+	{
+		uint32_t choice = nextRandom();
+		uint16_t length = 0;
+		bool newSession = (0 == (choice & 0x3));
+
+		if (newSession)
+		{
+			fillRandom(sessionKey, BLOCKSIZE);
+		}
+		fillRandom(key, BLOCKSIZE);
+		fillRandom(counter, BLOCKSIZE);
+		fillRandom(input, sizeof(input));
+		/* Counters close to the wrap of the 16-bit block counter */
+		if (0 == (choice & 0x30))
+		{
+			counter[BLOCKSIZE - 2] = 0xff;
+		}
+
+		for (uint8_t e = 0; e < HOST_AES_ENGINES; e++)
+		{
+			const HostAesEngine_t *engine = &engines[e];
+
+			memcpy(output[e], input, sizeof(input));
+			if (newSession)
+			{
+				engine->sessionStart(sessionKey);
+			}
+
+			switch ((choice >> 8) & 0x3)
+			{
+				case 0:
+					length = BLOCKSIZE;
+					engine->encode(output[e], key);
+					break;
+				case 1:
+					length = (uint16_t)(((choice >> 12) % HOST_AES_MAX_BLOCKS + 1) * BLOCKSIZE);
+					engine->sessionEncode(output[e], (uint16_t)(length / BLOCKSIZE));
+					break;
+				case 2:
+					length = (uint16_t)((choice >> 12) % (HOST_AES_MAX_BLOCKS * BLOCKSIZE));
+					engine->sessionCtr(output[e], input, length, counter);
+					break;
+				default:
+					length = BLOCKSIZE;
+					memcpy(output[e], counter, BLOCKSIZE);
+					engine->sessionCbcMac(output[e], input, (uint16_t)((choice >> 12) % (HOST_AES_MAX_BLOCKS + 1)));
+					break;
+			}
+
+			if ((0 != e) && (0 != memcmp(output[e], output[0], length)))
+			{
+				failed[e]++;
+			}
+		}
+	}
+
+	for (uint8_t e = 1; e < HOST_AES_ENGINES; e++)
+	{
+		printf("%-16s : %u random operations, %u differ from the model\n", engines[e].name,
+			(unsigned int)options.checks, (unsigned int)failed[e]);
+		passed &= (0 == failed[e]);
+	}
+	return passed;
+}
+
+/**************************************************************************//**
+\brief Minimum cycles of a key load and block, a block of a session, the
+       counter mode of a 222 bytes FRMPayload and the CBC-MAC of 15 blocks
+******************************************************************************/
+static void measure(const HostAesEngine_t *engine)
+{
+	uint8_t keys[2][BLOCKSIZE];
+	uint8_t counter[BLOCKSIZE];
+	uint8_t buffer[HOST_AES_MAX_BLOCKS * BLOCKSIZE];
+	uint64_t best[4] = {UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX};
+	uint64_t t0, t;
+
+	randomState = 1;
+	fillRandom(keys[0], sizeof(keys));
+	fillRandom(counter, BLOCKSIZE);
+	fillRandom(buffer, sizeof(buffer));
+
+	engine->init();
+	for (uint32_t r = 0; r < options.repetitions; r++)
+	{
+		/* A different key every time, the key is loaded with each block */
+		t0 = readCycles();
+		engine->encode(buffer, keys[r & 1]);
+		t = readCycles() - t0;
+		best[0] = (t < best[0]) ? t : best[0];
+
+		engine->sessionStart(keys[0]);
+		engine->sessionEncode(buffer, 0);
+		t0 = readCycles();
+		engine->sessionEncode(buffer, HOST_AES_MAX_BLOCKS);
+		t = readCycles() - t0;
+		best[1] = (t < best[1]) ? t : best[1];
+
+		t0 = readCycles();
+		engine->sessionCtr(buffer, buffer, HOST_AES_CTR_LENGTH, counter);
+		t = readCycles() - t0;
+		best[2] = (t < best[2]) ? t : best[2];
+
+		t0 = readCycles();
+		engine->sessionCbcMac(counter, buffer, HOST_AES_CBCMAC_BLOCKS);
+		t = readCycles() - t0;
+		best[3] = (t < best[3]) ? t : best[3];
+	}
+	sink = buffer[0] ^ counter[0];
+
+	printf("%-16s %12llu %12llu %12llu %12llu\n", engine->name, (unsigned long long)best[0],
+		(unsigned long long)(best[1] / HOST_AES_MAX_BLOCKS), (unsigned long long)best[2],
+		(unsigned long long)best[3]);
+}
+
+/**************************************************************************//**
+\brief Reads the time stamp counter, nanoseconds where there is none
+******************************************************************************/
+static uint64_t readCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	uint64_t tsc;
+
+	_mm_lfence();
+	tsc = __rdtsc();
+	_mm_lfence();
+	return tsc;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000uLL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+	bool passed = true;
+
+	parseOptions(argc, argv);
+
+	for (uint8_t e = 0; e < HOST_AES_ENGINES; e++)
+	{
+		passed &= checkVector(&engines[e]);
+	}
+	passed &= checkRandom();
+
+	printf("\n%-16s %12s %12s %12s %12s\n", "cycles (min)", "key+block", "block", "ctr_222", "cbcmac_240");
+	for (uint8_t e = 0; e < HOST_AES_ENGINES; e++)
+	{
+		measure(&engines[e]);
+	}
+
+	printf("%s\n", passed ? "PASSED" : "FAILED");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof host_aes.c */
@@ -0,0 +1,350 @@
+/**
+* \file  host_aggregation.c
+*
+* \brief Record aggregation across a drop of the data rate while a frame is open
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "lorawan.h"
+#include "lorawan_defs.h"
+#include "lorawan_private.h"
+#include "lorawan_aggregation.h"
+#include "sw_timer.h"
+#include "pmm.h"
+#include "host_clock.h"
+#include "host_nvm.h"
+#include "host_device.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Data rates of EU868 the frames are filled and sent at */
+#define HOST_AGGREGATION_HIGH_DR        (DR5)
+#define HOST_AGGREGATION_LOW_DR         (DR0)
+
+/* Port of the records */
+#define HOST_AGGREGATION_PORT           (2u)
+
+/* Time given to a queued frame to be sent and its receive windows to close */
+#define HOST_AGGREGATION_SEND_MS        (60000u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* How the frame filled at the high data rate is handed to the queue */
+typedef enum _HostAggregationCase
+{
+	HOST_AGGREGATION_RECORD,
+	HOST_AGGREGATION_FLUSH,
+	HOST_AGGREGATION_AGE,
+	HOST_AGGREGATION_CASES
+} HostAggregationCase_t;
+
+typedef struct _HostAggregationOptions
+{
+	uint8_t recordLength;
+	uint8_t records;
+} HostAggregationOptions_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostAggregationOptions_t options = {
+	.recordLength = 4,
+	.records = 20
+};
+
+static const char *const caseNames[HOST_AGGREGATION_CASES] = {
+	"next record", "LORAWAN_FlushRecords", "frame age"
+};
+
+static uint32_t failures;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static uint8_t capacityOf(uint8_t dr);
+static bool setDataRate(uint8_t dr);
+static void readStats(AggregationStats_t *stats);
+static bool aggregate(uint8_t records);
+static void runFor(uint32_t ms);
+static bool check(HostAggregationCase_t test);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -l <n>         length of the records (default %u)\n"
+		"  -n <n>         records of the frame filled at the high data rate (default %u)\n",
+		name, (unsigned int)options.recordLength, (unsigned int)options.records);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "l:n:h")))
+	{
+		switch (opt)
+		{
+			case 'l':
+				options.recordLength = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				options.records = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				usage(argv[0]);
+				exit((opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Capacity of an aggregated frame at a data rate, as the MAC sizes it
+******************************************************************************/
+static uint8_t capacityOf(uint8_t dr)
+{
+	uint8_t capacity = LorawanGetFreePayloadSize(dr);
+
+	return (capacity > LORAWAN_AGGREGATION_BUFFER_SIZE) ? LORAWAN_AGGREGATION_BUFFER_SIZE : capacity;
+}
+
+static bool setDataRate(uint8_t dr)
+{
+	if (LORAWAN_SUCCESS != LORAWAN_SetAttr(CURRENT_DATARATE, &dr))
+	{
+		printf("Data rate %u refused\n", (unsigned int)dr);
+		failures++;
+		return false;
+	}
+	return true;
+}
+
+static void readStats(AggregationStats_t *stats)
+{
+	LORAWAN_GetAttr(AGGREGATION_STATS, NULL, stats);
+}
+
+/**************************************************************************//**
+\brief Aggregates records of the configured length
+\return false if the stack refused one of them
+******************************************************************************/
+static bool aggregate(uint8_t records)
+{
+	uint8_t record[UINT8_MAX];
+
+	memset(record, 0xA5, sizeof(record));
+	for (uint8_t index = 0; index < records; index++)
+	{
+		StackRetStatus_t status = LORAWAN_AggregateRecord(HOST_AGGREGATION_PORT, record,
+			options.recordLength, 0);
+
+		if (LORAWAN_SUCCESS != status)
+		{
+			printf("Record %u refused, status %d\n", (unsigned int)index, status);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void runFor(uint32_t ms)
+{
+	HostDevice_Run(HostClock_Now() + MS_TO_US((uint64_t)ms));
+	/* The records come from outside the tasks, like from the interrupt of
+	   a sensor which wakes the device up first */
+	PMM_Wakeup();
+}
+
+/**************************************************************************//**
+\brief Fills a frame at the high data rate, lowers the data rate below its
+       length and hands the frame to the queue. The frame must be dropped
+       with its records counted, and the aggregation must go on at the low
+       data rate instead of retrying the frame for good.
+******************************************************************************/
+static bool check(HostAggregationCase_t test)
+{
+	AggregationStats_t before, after;
+	uint32_t expectedRecords;
+	bool passed = true;
+
+	if (!setDataRate(HOST_AGGREGATION_HIGH_DR))
+	{
+		return false;
+	}
+	readStats(&before);
+	if (!aggregate(options.records))
+	{
+		failures++;
+		return false;
+	}
+	if (!setDataRate(HOST_AGGREGATION_LOW_DR))
+	{
+		return false;
+	}
+
+	expectedRecords = before.records;
+	switch (test)
+	{
+		case HOST_AGGREGATION_RECORD:
+			/* The record does not fit the open frame and goes to a new one */
+			passed = aggregate(1);
+			expectedRecords++;
+			break;
+
+		case HOST_AGGREGATION_FLUSH:
+		{
+			StackRetStatus_t status = LORAWAN_FlushRecords();
+
+			if (LORAWAN_INVALID_BUFFER_LENGTH != status)
+			{
+				printf("Flush of the frame returned status %d\n", status);
+				passed = false;
+			}
+			passed = aggregate(1) && passed;
+			expectedRecords++;
+			break;
+		}
+
+		case HOST_AGGREGATION_AGE:
+			/* The queue timer hands the frame over once it is old enough */
+			runFor(LORAWAN_AGGREGATION_MAX_AGE_MS + HOST_AGGREGATION_SEND_MS);
+			if (UINT64_MAX != LorawanAggregationFlushTime())
+			{
+				printf("The aggregation is still due at %llu us\n",
+					(unsigned long long)LorawanAggregationFlushTime());
+				passed = false;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	/* The records aggregated after the drop are sent at the low data rate */
+	if (LORAWAN_SUCCESS != LORAWAN_FlushRecords())
+	{
+		printf("Flush at the low data rate refused\n");
+		passed = false;
+	}
+	runFor(HOST_AGGREGATION_SEND_MS);
+	readStats(&after);
+
+	if ((after.droppedRecords - before.droppedRecords) != options.records)
+	{
+		printf("%u records dropped instead of %u\n",
+			(unsigned int)(after.droppedRecords - before.droppedRecords), (unsigned int)options.records);
+		passed = false;
+	}
+	if (after.records != expectedRecords)
+	{
+		printf("%u records sent instead of %u\n",
+			(unsigned int)(after.records - before.records), (unsigned int)(expectedRecords - before.records));
+		passed = false;
+	}
+
+	printf("%-20s : %u records dropped, %u sent, %s\n", caseNames[test],
+		(unsigned int)(after.droppedRecords - before.droppedRecords),
+		(unsigned int)(after.records - before.records), passed ? "ok" : "failed");
+	if (!passed)
+	{
+		failures++;
+	}
+	return passed;
+}
+
+int main(int argc, char **argv)
+{
+	HostDeviceConfig_t device = {
+		.label = NULL,
+		.band = ISM_EU868,
+		.seed = 1,
+		.intervalMs = UINT32_MAX / 2,
+		.dataRate = HOST_DEVICE_DEFAULT_DATARATE,
+		.abp = true
+	};
+	HostDeviceStats_t stats;
+	uint32_t length;
+
+	parseOptions(argc, argv);
+
+	HostNvm_Format();
+	if (!HostDevice_Start(&device))
+	{
+		printf("Initialization of the device failed\n");
+		return EXIT_FAILURE;
+	}
+	runFor(HOST_AGGREGATION_SEND_MS);
+	HostDevice_GetStats(&stats, NULL);
+	if (HOST_CLOCK_NEVER == stats.joinTimeUs)
+	{
+		printf("Activation of the device failed\n");
+		return EXIT_FAILURE;
+	}
+
+	/* The frame must fit the high data rate and no longer the low one */
+	length = (uint32_t)options.records * options.recordLength;
+	printf("frame            : %u records of %u bytes (%u bytes), capacity %u bytes at DR%u, %u at DR%u\n",
+		(unsigned int)options.records, (unsigned int)options.recordLength, (unsigned int)length,
+		(unsigned int)capacityOf(HOST_AGGREGATION_HIGH_DR), (unsigned int)HOST_AGGREGATION_HIGH_DR,
+		(unsigned int)capacityOf(HOST_AGGREGATION_LOW_DR), (unsigned int)HOST_AGGREGATION_LOW_DR);
+	if (!options.recordLength || (length >= capacityOf(HOST_AGGREGATION_HIGH_DR)) ||
+		((length + options.recordLength) <= capacityOf(HOST_AGGREGATION_LOW_DR)) ||
+		(options.recordLength > capacityOf(HOST_AGGREGATION_LOW_DR)))
+	{
+		printf("The frame does not span the drop of the data rate\n");
+		return EXIT_FAILURE;
+	}
+
+	for (uint32_t test = 0; test < HOST_AGGREGATION_CASES; test++)
+	{
+		check((HostAggregationCase_t)test);
+	}
+
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* eof host_aggregation.c */
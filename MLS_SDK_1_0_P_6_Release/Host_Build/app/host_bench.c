@@ -0,0 +1,956 @@
+/**
+* \file  host_bench.c
+*
+* \brief Benchmark of the MAC and security hot paths on the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "lorawan.h"
+#include "lorawan_defs.h"
+#include "lorawan_private.h"
+#include "lorawan_radio.h"
+#include "lorawan_multiband.h"
+#include "sal.h"
+#include "aes_engine.h"
+#include "sw_timer.h"
+#include "conf_app.h"
+#include "host_clock.h"
+#include "host_nvm.h"
+#include "sx1276_model.h"
+#include "host_network.h"
+#include "host_device.h"
+#include "host_irq.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define HOST_BENCH_DEFAULT_ITERATIONS   (2000)
+#define HOST_BENCH_DEFAULT_THRESHOLD    (10.0)
+
+/* Data rate of the session, EU868 DR5 allows the largest frames */
+#define HOST_BENCH_DATARATE             (DR5)
+
+/* First downlink counter of the corpus */
+#define HOST_BENCH_FCNT_DOWN            (1)
+
+/* Stack on which the stack depth of every case is measured */
+#define HOST_BENCH_STACK_SIZE           (64u * 1024u)
+#define HOST_BENCH_STACK_PAINT          (0xA5)
+
+/* LORAWAN_RxDone() ends with this value once a frame went the whole path */
+#define HOST_BENCH_RX_PROCESSED         (1)
+
+/* Virtual time given to the device to activate and send its first uplink */
+#define HOST_BENCH_SETTLE_US            (60000000uLL)
+
+/* Timeouts of the timer cases, the virtual time stands still while they run */
+#define HOST_BENCH_TIMER_FIRST_US       (1000000u)
+#define HOST_BENCH_TIMER_LOAD_US        (10000000u)
+#define HOST_BENCH_TIMER_LAST_US        (100000000u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+typedef enum _HostBenchKind
+{
+	HOST_BENCH_ASSEMBLE = 0,
+	HOST_BENCH_RX_DONE,
+	HOST_BENCH_ENCRYPT,
+	HOST_BENCH_CMAC,
+	HOST_BENCH_TIMER_START,
+	HOST_BENCH_TIMER_STOP
+} HostBenchKind_t;
+
+/* A case of the corpus */
+typedef struct _HostBenchCase
+{
+	const char *name;
+	HostBenchKind_t kind;
+
+	/* Length of the payload, of the FRMPayload or of the CMAC input */
+	uint8_t length;
+
+	/* AssemblePacket(): confirmed uplink, answers to MAC commands pending */
+	bool confirmed;
+	bool macAnswers;
+
+	/* LORAWAN_RxDone(): content of the downlink */
+	bool ack;
+	const uint8_t *fOpts;
+	uint8_t fOptsLength;
+	bool portPresent;
+	uint8_t port;
+	const uint8_t *commands;
+
+	/* SwTimerStart()/SwTimerStop(): the timer expires before all others */
+	bool timerFirst;
+
+	/* EncryptFRMPayload()/SAL_AESCmac(): the reference loading the key for
+	   every block with AESEncode() */
+	bool perBlock;
+
+	/* LORAWAN_RxDone()/SAL_AESCmac(): the CMAC subkeys are not kept by the
+	   SAL and derived by every MIC computation */
+	bool noSubkeys;
+} HostBenchCase_t;
+
+/* Measurements of a case */
+typedef struct _HostBenchResult
+{
+	uint64_t cyclesMin;
+	uint64_t cyclesMedian;
+	uint64_t nsMedian;
+	int64_t instructions;
+	uint32_t stackBytes;
+	uint64_t irqOffMedian;
+} HostBenchResult_t;
+
+typedef struct _HostBenchOptions
+{
+	uint32_t iterations;
+	const char *filter;
+	const char *baseline;
+	double threshold;
+	bool json;
+} HostBenchOptions_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+extern LoRa_t loRa;
+extern uint8_t radioBuffer[];
+
+static HostBenchOptions_t options = {
+	.iterations = HOST_BENCH_DEFAULT_ITERATIONS,
+	.filter = NULL,
+	.baseline = NULL,
+	.threshold = HOST_BENCH_DEFAULT_THRESHOLD,
+	.json = false
+};
+
+/* MAC commands of EU868: LinkADRReq, DevStatusReq, DutyCycleReq, RXTimingSetupReq */
+static const uint8_t fOptsCommands[] = {
+	0x03, 0x50, 0x07, 0x00, 0x01,
+	0x06,
+	0x04, 0x00,
+	0x08, 0x01
+};
+
+/* NewChannelReq, DlChannelReq, LinkADRReq, RXParamSetupReq, DevStatusReq,
+   DutyCycleReq and RXTimingSetupReq in a port 0 FRMPayload */
+static const uint8_t portZeroCommands[] = {
+	0x07, 0x03, 0x18, 0x4E, 0x84, 0x50,
+	0x0A, 0x03, 0x18, 0x4E, 0x84,
+	0x03, 0x50, 0x0F, 0x00, 0x01,
+	0x05, 0x00, 0x52, 0xAD, 0x84,
+	0x06,
+	0x04, 0x00,
+	0x08, 0x01
+};
+
+static const HostBenchCase_t corpus[] = {
+	{.name = "assemble_unconfirmed_12", .kind = HOST_BENCH_ASSEMBLE, .length = 12},
+	{.name = "assemble_confirmed_51", .kind = HOST_BENCH_ASSEMBLE, .length = 51, .confirmed = true},
+	{.name = "assemble_unconfirmed_222", .kind = HOST_BENCH_ASSEMBLE, .length = 222},
+	{.name = "assemble_mac_answers_12", .kind = HOST_BENCH_ASSEMBLE, .length = 12, .macAnswers = true},
+	{.name = "assemble_mac_answers_port0", .kind = HOST_BENCH_ASSEMBLE, .length = 0, .macAnswers = true},
+	{.name = "rxdone_ack", .kind = HOST_BENCH_RX_DONE, .ack = true},
+	{.name = "rxdone_ack_no_subkeys", .kind = HOST_BENCH_RX_DONE, .ack = true, .noSubkeys = true},
+	{.name = "rxdone_data_16", .kind = HOST_BENCH_RX_DONE, .portPresent = true, .port = 1, .length = 16},
+	{.name = "rxdone_data_222", .kind = HOST_BENCH_RX_DONE, .portPresent = true, .port = 1, .length = 222},
+	{.name = "rxdone_fopts_commands", .kind = HOST_BENCH_RX_DONE, .fOpts = fOptsCommands,
+		.fOptsLength = sizeof(fOptsCommands), .portPresent = true, .port = 1, .length = 4},
+	{.name = "rxdone_port0_commands", .kind = HOST_BENCH_RX_DONE, .portPresent = true, .port = 0,
+		.commands = portZeroCommands, .length = sizeof(portZeroCommands)},
+	{.name = "encrypt_frmpayload_16", .kind = HOST_BENCH_ENCRYPT, .length = 16},
+	{.name = "encrypt_frmpayload_222", .kind = HOST_BENCH_ENCRYPT, .length = 222},
+	{.name = "encrypt_frmpayload_222_per_block", .kind = HOST_BENCH_ENCRYPT, .length = 222, .perBlock = true},
+	{.name = "cmac_32", .kind = HOST_BENCH_CMAC, .length = 32},
+	{.name = "cmac_32_no_subkeys", .kind = HOST_BENCH_CMAC, .length = 32, .noSubkeys = true},
+	{.name = "cmac_238", .kind = HOST_BENCH_CMAC, .length = 238},
+	{.name = "cmac_238_per_block", .kind = HOST_BENCH_CMAC, .length = 238, .perBlock = true},
+	{.name = "swtimer_start_first", .kind = HOST_BENCH_TIMER_START, .timerFirst = true},
+	{.name = "swtimer_start_last", .kind = HOST_BENCH_TIMER_START},
+	{.name = "swtimer_stop_first", .kind = HOST_BENCH_TIMER_STOP, .timerFirst = true},
+	{.name = "swtimer_stop_last", .kind = HOST_BENCH_TIMER_STOP}
+};
+
+/* State of the MAC and of the regional parameters a case starts from */
+static LoRa_t savedLoRa;
+static RegParams_t savedRegParams;
+
+/* Case being run, its input and the buffers the stack works on */
+static const HostBenchCase_t *currentCase;
+static uint8_t input[256];
+static uint8_t inputLength;
+static uint8_t work[256];
+static uint8_t output[256 + 16];
+static uint8_t cmacKey[16];
+static StackRetStatus_t rxStatus;
+
+/* Timers left over by the stack, the last one is the timer under measurement */
+static uint8_t benchTimers[TOTAL_NUMBER_OF_TIMERS];
+static uint8_t benchTimerCount;
+
+/* Stack depth measurement */
+static ucontext_t benchContext;
+static ucontext_t mainContext;
+static uint8_t *benchStack;
+
+/* Instruction counter, -1 if the kernel does not provide one */
+static int instructionCounter = -1;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static bool startDevice(void);
+static bool prepareCase(const HostBenchCase_t *benchCase);
+static void resetCase(void);
+static void releaseCase(void);
+static void runCase(void);
+static void timerCallback(void *param);
+static void encryptPerBlock(uint8_t length);
+static void cmacPerBlock(uint8_t length);
+static void emptyCase(void);
+static uint64_t readCycles(void);
+static uint64_t readNs(void);
+static void openInstructionCounter(void);
+static int64_t countInstructions(void);
+static void trampoline(void);
+static uint32_t measureStack(void (*function)(void));
+static int compareU64(const void *a, const void *b);
+static bool measureCase(const HostBenchCase_t *benchCase, HostBenchResult_t *result);
+static void printResult(const HostBenchCase_t *benchCase, const HostBenchResult_t *result);
+static bool findBaseline(const char *name, double *cyclesMin, double *stackBytes);
+
+/* Function under measurement on the painted stack */
+static void (*stackFunction)(void);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -n <n>         iterations per case (default %u)\n"
+		"  -f <text>      only run the cases whose name contains text\n"
+		"  -j             JSON lines output, one object per case\n"
+		"  -B <file>      compare with a JSON lines baseline of a previous run\n"
+		"  -T <percent>   regression threshold of the comparison (default %.0f)\n",
+		name, HOST_BENCH_DEFAULT_ITERATIONS, HOST_BENCH_DEFAULT_THRESHOLD);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "n:f:jB:T:h")))
+	{
+		switch (opt)
+		{
+			case 'n':
+				options.iterations = (uint32_t)strtoul(optarg, NULL, 0);
+				if (0 == options.iterations)
+				{
+					options.iterations = 1;
+				}
+				break;
+			case 'f':
+				options.filter = optarg;
+				break;
+			case 'j':
+				options.json = true;
+				break;
+			case 'B':
+				options.baseline = optarg;
+				break;
+			case 'T':
+				options.threshold = strtod(optarg, NULL);
+				break;
+			default:
+				usage(argv[0]);
+				exit(('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Activates the demo device by personalization and lets it send one
+       uplink, so that the MAC is in the state of a device in the field
+******************************************************************************/
+static bool startDevice(void)
+{
+	HostNetworkConfig_t networkConfig = {
+		.band = ISM_EU868,
+		.netId = 0,
+		.downlinkPeriod = 0,
+		.rssi = -80,
+		.snr = 8
+	};
+	HostDeviceConfig_t device = {
+		.label = NULL,
+		.band = ISM_EU868,
+		.seed = 1,
+		.cycles = 0,
+		.intervalMs = UINT32_MAX / 2,
+		.payloadLength = 12,
+		.dataRate = HOST_BENCH_DATARATE,
+		.abp = true
+	};
+	uint8_t nwkSKey[] = DEMO_NETWORK_SESSION_KEY;
+	uint8_t appSKey[] = DEMO_APPLICATION_SESSION_KEY;
+	HostDeviceStats_t stats;
+
+	HostNetwork_Init(&networkConfig);
+	device.air = HostNetwork_GetAir();
+	device.devAddr = DEMO_DEVICE_ADDRESS;
+	memcpy(device.nwkSKey, nwkSKey, sizeof(nwkSKey));
+	memcpy(device.appSKey, appSKey, sizeof(appSKey));
+	HostNetwork_AddAbpDevice(device.devAddr, nwkSKey, appSKey);
+
+	HostNvm_Format();
+	if (!HostDevice_Start(&device))
+	{
+		return false;
+	}
+	HostDevice_Run(HOST_BENCH_SETTLE_US);
+	HostDevice_GetStats(&stats, NULL);
+	if ((1 != stats.joins) || (1 != stats.uplinks))
+	{
+		return false;
+	}
+
+	/* The timer cases run with every timer the stack did not create */
+	while ((benchTimerCount < TOTAL_NUMBER_OF_TIMERS) &&
+		(LORAWAN_SUCCESS == SwTimerCreate(&benchTimers[benchTimerCount])))
+	{
+		benchTimerCount++;
+	}
+	if (benchTimerCount < 2u)
+	{
+		return false;
+	}
+
+	memcpy(cmacKey, nwkSKey, sizeof(cmacKey));
+	savedLoRa = loRa;
+	savedRegParams = RegParams;
+	return true;
+}
+
+/**************************************************************************//**
+\brief Builds the input of a case and the state of the MAC it starts from
+\return false if the input is not accepted by the stack
+******************************************************************************/
+static bool prepareCase(const HostBenchCase_t *benchCase)
+{
+	currentCase = benchCase;
+	loRa = savedLoRa;
+	RegParams = savedRegParams;
+
+	if (HOST_BENCH_RX_DONE == benchCase->kind)
+	{
+		HostNetworkDownlinkReq_t req = {
+			.confirmed = false,
+			.ack = benchCase->ack,
+			.fCnt = loRa.fCntDown.value + HOST_BENCH_FCNT_DOWN,
+			.fOpts = benchCase->fOpts,
+			.fOptsLength = benchCase->fOptsLength,
+			.portPresent = benchCase->portPresent,
+			.port = benchCase->port,
+			.payload = benchCase->commands ? benchCase->commands : work,
+			.payloadLength = benchCase->length
+		};
+
+		/* The frame is built into input, from the clear payload in work */
+		for (uint16_t i = 0; i < benchCase->length; i++)
+		{
+			work[i] = (uint8_t)i;
+		}
+		if (!HostNetwork_BuildDownlink(loRa.activationParameters.deviceAddress.value, &req, input, &inputLength))
+		{
+			return false;
+		}
+		/* The frame arrives in RX1 of a confirmed uplink when acknowledged */
+		loRa.macStatus.macState = RX1_OPEN;
+		loRa.lorawanMacStatus.ackRequiredFromNextDownlinkMessage = benchCase->ack;
+	}
+	else if ((HOST_BENCH_TIMER_START == benchCase->kind) || (HOST_BENCH_TIMER_STOP == benchCase->kind))
+	{
+		/* All other timers run, with expiry times between first and last */
+		for (uint8_t i = 0; (i + 1u) < benchTimerCount; i++)
+		{
+			if (LORAWAN_SUCCESS != SwTimerStart(benchTimers[i], HOST_BENCH_TIMER_LOAD_US + (i * 1000u),
+				SW_TIMEOUT_RELATIVE, (void *)timerCallback, NULL))
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		inputLength = benchCase->length;
+		for (uint16_t i = 0; i < inputLength; i++)
+		{
+			input[i] = (uint8_t)i;
+		}
+	}
+
+	if (benchCase->macAnswers)
+	{
+		static const HostBenchCase_t commands = {.name = "commands", .kind = HOST_BENCH_RX_DONE,
+			.portPresent = true, .port = 0, .commands = portZeroCommands, .length = sizeof(portZeroCommands)};
+
+		/* The answers pending after a downlink full of MAC commands */
+		if (!prepareCase(&commands))
+		{
+			return false;
+		}
+		resetCase();
+		runCase();
+		if ((HOST_BENCH_RX_PROCESSED != rxStatus) || (0 == loRa.crtMacCmdIndex))
+		{
+			return false;
+		}
+		loRa.macStatus.macState = IDLE;
+		currentCase = benchCase;
+		inputLength = benchCase->length;
+		for (uint16_t i = 0; i < inputLength; i++)
+		{
+			input[i] = (uint8_t)i;
+		}
+	}
+
+	savedLoRa = loRa;
+	savedRegParams = RegParams;
+
+	/* A frame of the corpus must make it through the whole receive path */
+	if (HOST_BENCH_RX_DONE == benchCase->kind)
+	{
+		resetCase();
+		runCase();
+		return HOST_BENCH_RX_PROCESSED == rxStatus;
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief Puts back the state and the input of the current case. Not measured.
+******************************************************************************/
+static void resetCase(void)
+{
+	loRa = savedLoRa;
+	RegParams = savedRegParams;
+	if (HOST_BENCH_RX_DONE == currentCase->kind)
+	{
+		memcpy(radioBuffer, input, inputLength);
+	}
+	else if (HOST_BENCH_TIMER_START == currentCase->kind)
+	{
+		SwTimerStop(benchTimers[benchTimerCount - 1u]);
+	}
+	else if (HOST_BENCH_TIMER_STOP == currentCase->kind)
+	{
+		if (!SwTimerIsRunning(benchTimers[benchTimerCount - 1u]))
+		{
+			SwTimerStart(benchTimers[benchTimerCount - 1u], currentCase->timerFirst ? HOST_BENCH_TIMER_FIRST_US :
+				HOST_BENCH_TIMER_LAST_US, SW_TIMEOUT_RELATIVE, (void *)timerCallback, NULL);
+		}
+	}
+	else
+	{
+		memcpy(work, input, inputLength);
+	}
+
+	if (currentCase->noSubkeys)
+	{
+		SAL_CmacSubkeyClear();
+	}
+}
+
+/**************************************************************************//**
+\brief Stops the timers started for the current case and gives the keys their
+       CMAC subkeys back. Not measured.
+******************************************************************************/
+static void releaseCase(void)
+{
+	if (currentCase->noSubkeys)
+	{
+		LorawanUpdateCmacSubkeys();
+	}
+
+	if ((HOST_BENCH_TIMER_START == currentCase->kind) || (HOST_BENCH_TIMER_STOP == currentCase->kind))
+	{
+		for (uint8_t i = 0; i < benchTimerCount; i++)
+		{
+			SwTimerStop(benchTimers[i]);
+		}
+	}
+}
+
+static void timerCallback(void *param)
+{
+	(void)param;
+}
+
+static void runCase(void)
+{
+	const HostBenchCase_t *c = currentCase;
+
+	switch (c->kind)
+	{
+		case HOST_BENCH_ASSEMBLE:
+			AssemblePacket(c->confirmed, 2, work, c->length);
+			break;
+
+		case HOST_BENCH_RX_DONE:
+			rxStatus = LORAWAN_RxDone(radioBuffer, inputLength);
+			break;
+
+		case HOST_BENCH_ENCRYPT:
+			if (c->perBlock)
+			{
+				encryptPerBlock(c->length);
+				break;
+			}
+			EncryptFRMPayload(work, c->length, 0, loRa.fCntUp.value, loRa.activationParameters.applicationSessionKeyRam,
+				SAL_APPS_KEY, 16, output, loRa.activationParameters.deviceAddress.value);
+			break;
+
+		case HOST_BENCH_CMAC:
+			if (c->perBlock)
+			{
+				cmacPerBlock(c->length);
+				break;
+			}
+			SAL_AESCmac(cmacKey, SAL_NWKS_KEY, output, work, c->length);
+			break;
+
+		case HOST_BENCH_TIMER_START:
+			SwTimerStart(benchTimers[benchTimerCount - 1u], c->timerFirst ? HOST_BENCH_TIMER_FIRST_US :
+				HOST_BENCH_TIMER_LAST_US, SW_TIMEOUT_RELATIVE, (void *)timerCallback, NULL);
+			break;
+
+		case HOST_BENCH_TIMER_STOP:
+			SwTimerStop(benchTimers[benchTimerCount - 1u]);
+			break;
+	}
+}
+
+static void emptyCase(void)
+{
+}
+
+/**************************************************************************//**
+\brief FRMPayload encryption as done before the AES sessions: one A_i block
+       and one load of the key per block of payload
+******************************************************************************/
+static void encryptPerBlock(uint8_t length)
+{
+	uint8_t block[BLOCKSIZE];
+	uint32_t devAddr = loRa.activationParameters.deviceAddress.value;
+	uint32_t fCnt = loRa.fCntUp.value;
+
+	for (uint16_t offset = 0; offset < length; offset += BLOCKSIZE)
+	{
+		memset(block, 0, sizeof(block));
+		block[0] = 0x01;
+		memcpy(&block[6], &devAddr, sizeof(devAddr));
+		memcpy(&block[10], &fCnt, sizeof(fCnt));
+		block[15] = (uint8_t)(offset / BLOCKSIZE + 1u);
+		AESEncode(block, loRa.activationParameters.applicationSessionKeyRam);
+		for (uint16_t i = 0; (i < BLOCKSIZE) && ((offset + i) < length); i++)
+		{
+			output[16 + offset + i] = work[offset + i] ^ block[i];
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief AES-CMAC as done before the AES sessions: the subkey and every block
+       of the chain load the key
+******************************************************************************/
+static void cmacPerBlock(uint8_t length)
+{
+	uint8_t subkey[BLOCKSIZE] = {0};
+	uint8_t chain[BLOCKSIZE] = {0};
+	uint8_t last[BLOCKSIZE] = {0};
+	uint16_t n = (length + BLOCKSIZE - 1u) / BLOCKSIZE;
+	uint8_t rest = length % BLOCKSIZE;
+	uint8_t msb;
+
+	AESEncode(subkey, cmacKey);
+	msb = subkey[0] & 0x80u;
+	for (uint8_t i = 0; i < BLOCKSIZE; i++)
+	{
+		subkey[i] = (uint8_t)((subkey[i] << 1) | ((i < BLOCKSIZE - 1u) ? (subkey[i + 1u] >> 7) : 0u));
+	}
+	subkey[BLOCKSIZE - 1u] ^= msb ? 0x87u : 0u;
+	if (rest)
+	{
+		/* K2 for an incomplete last block */
+		msb = subkey[0] & 0x80u;
+		for (uint8_t i = 0; i < BLOCKSIZE; i++)
+		{
+			subkey[i] = (uint8_t)((subkey[i] << 1) | ((i < BLOCKSIZE - 1u) ? (subkey[i + 1u] >> 7) : 0u));
+		}
+		subkey[BLOCKSIZE - 1u] ^= msb ? 0x87u : 0u;
+		memcpy(last, &work[(n - 1u) * BLOCKSIZE], rest);
+		last[rest] = 0x80u;
+	}
+	else
+	{
+		memcpy(last, &work[(n - 1u) * BLOCKSIZE], BLOCKSIZE);
+	}
+
+	for (uint16_t b = 0; b < n; b++)
+	{
+		const uint8_t *block = (b < n - 1u) ? &work[b * BLOCKSIZE] : last;
+
+		for (uint8_t i = 0; i < BLOCKSIZE; i++)
+		{
+			chain[i] ^= block[i] ^ ((b < n - 1u) ? 0u : subkey[i]);
+		}
+		AESEncode(chain, cmacKey);
+	}
+	memcpy(output, chain, sizeof(chain));
+}
+
+/**************************************************************************//**
+\brief Reads the time stamp counter, nanoseconds where there is none
+******************************************************************************/
+static uint64_t readCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	uint64_t tsc;
+
+	_mm_lfence();
+	tsc = __rdtsc();
+	_mm_lfence();
+	return tsc;
+#else
+	return readNs();
+#endif
+}
+
+static uint64_t readNs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000uLL) + (uint64_t)now.tv_nsec;
+}
+
+/**************************************************************************//**
+\brief Opens the user space instruction counter of the thread, if allowed
+******************************************************************************/
+static void openInstructionCounter(void)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	instructionCounter = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static int64_t countInstructions(void)
+{
+	uint64_t value;
+
+	if ((instructionCounter < 0) || (sizeof(value) != read(instructionCounter, &value, sizeof(value))))
+	{
+		return -1;
+	}
+	return (int64_t)value;
+}
+
+static void trampoline(void)
+{
+	stackFunction();
+}
+
+/**************************************************************************//**
+\brief Runs a function on a painted stack
+\return Number of stack bytes written by the function and the trampoline
+******************************************************************************/
+static uint32_t measureStack(void (*function)(void))
+{
+	uint32_t untouched = 0;
+
+	memset(benchStack, HOST_BENCH_STACK_PAINT, HOST_BENCH_STACK_SIZE);
+	getcontext(&benchContext);
+	benchContext.uc_stack.ss_sp = benchStack;
+	benchContext.uc_stack.ss_size = HOST_BENCH_STACK_SIZE;
+	benchContext.uc_link = &mainContext;
+	stackFunction = function;
+	makecontext(&benchContext, trampoline, 0);
+	swapcontext(&mainContext, &benchContext);
+
+	/* The stack grows down, from the end of the buffer */
+	while ((untouched < HOST_BENCH_STACK_SIZE) && (HOST_BENCH_STACK_PAINT == benchStack[untouched]))
+	{
+		untouched++;
+	}
+	return HOST_BENCH_STACK_SIZE - untouched;
+}
+
+static int compareU64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**************************************************************************//**
+\brief Runs a case the configured number of times
+\return false if the case cannot be prepared
+******************************************************************************/
+static bool measureCase(const HostBenchCase_t *benchCase, HostBenchResult_t *result)
+{
+	uint64_t *cycles = malloc(options.iterations * sizeof(uint64_t));
+	uint64_t *ns = malloc(options.iterations * sizeof(uint64_t));
+	uint64_t *irqOff = malloc(options.iterations * sizeof(uint64_t));
+	uint64_t instructions = 0;
+	bool counted = true;
+
+	if ((NULL == cycles) || (NULL == ns) || (NULL == irqOff) || !prepareCase(benchCase))
+	{
+		free(cycles);
+		free(ns);
+		free(irqOff);
+		return false;
+	}
+
+	/* Warm the caches and the branch predictors */
+	for (uint32_t i = 0; i < 16u; i++)
+	{
+		resetCase();
+		runCase();
+	}
+
+	for (uint32_t i = 0; i < options.iterations; i++)
+	{
+		int64_t before;
+		int64_t after;
+		uint64_t t0;
+		uint64_t c0;
+
+		resetCase();
+		HostIrq_TakeMaxMaskedCycles();
+		before = countInstructions();
+		t0 = readNs();
+		c0 = readCycles();
+		runCase();
+		cycles[i] = readCycles() - c0;
+		ns[i] = readNs() - t0;
+		after = countInstructions();
+		irqOff[i] = HostIrq_TakeMaxMaskedCycles();
+		if ((before < 0) || (after < 0))
+		{
+			counted = false;
+		}
+		else
+		{
+			instructions += (uint64_t)(after - before);
+		}
+	}
+
+	qsort(cycles, options.iterations, sizeof(uint64_t), compareU64);
+	qsort(ns, options.iterations, sizeof(uint64_t), compareU64);
+	qsort(irqOff, options.iterations, sizeof(uint64_t), compareU64);
+	result->cyclesMin = cycles[0];
+	result->cyclesMedian = cycles[options.iterations / 2];
+	result->nsMedian = ns[options.iterations / 2];
+	result->instructions = counted ? (int64_t)(instructions / options.iterations) : -1;
+	result->irqOffMedian = irqOff[options.iterations / 2];
+
+	resetCase();
+	result->stackBytes = measureStack(runCase) - measureStack(emptyCase);
+	releaseCase();
+
+	free(cycles);
+	free(ns);
+	free(irqOff);
+	return true;
+}
+
+static void printResult(const HostBenchCase_t *benchCase, const HostBenchResult_t *result)
+{
+	char instructions[24] = "n/a";
+
+	if (options.json)
+	{
+		if (result->instructions >= 0)
+		{
+			snprintf(instructions, sizeof(instructions), "%lld", (long long)result->instructions);
+		}
+		else
+		{
+			strcpy(instructions, "null");
+		}
+		printf("{\"case\":\"%s\",\"iterations\":%u,\"cycles_min\":%llu,\"cycles_median\":%llu,"
+			"\"ns_median\":%llu,\"instructions\":%s,\"stack_bytes\":%u,\"irq_off_cycles\":%llu}\n",
+			benchCase->name, (unsigned int)options.iterations, (unsigned long long)result->cyclesMin,
+			(unsigned long long)result->cyclesMedian, (unsigned long long)result->nsMedian, instructions,
+			(unsigned int)result->stackBytes, (unsigned long long)result->irqOffMedian);
+		return;
+	}
+
+	if (result->instructions >= 0)
+	{
+		snprintf(instructions, sizeof(instructions), "%lld", (long long)result->instructions);
+	}
+	printf("%-32s %10llu %10llu %10llu %12s %8u %10llu\n", benchCase->name, (unsigned long long)result->cyclesMin,
+		(unsigned long long)result->cyclesMedian, (unsigned long long)result->nsMedian, instructions,
+		(unsigned int)result->stackBytes, (unsigned long long)result->irqOffMedian);
+}
+
+/**************************************************************************//**
+\brief Looks a case up in the baseline file, written by -j
+\return true if the case is found
+******************************************************************************/
+static bool findBaseline(const char *name, double *cyclesMin, double *stackBytes)
+{
+	FILE *file = fopen(options.baseline, "r");
+	char line[512];
+	bool found = false;
+
+	if (NULL == file)
+	{
+		return false;
+	}
+	while (!found && fgets(line, sizeof(line), file))
+	{
+		char caseName[64];
+		unsigned long long cycles;
+		unsigned int stack;
+		const char *field;
+
+		if ((1 != sscanf(line, "{\"case\":\"%63[^\"]\"", caseName)) || (0 != strcmp(caseName, name)))
+		{
+			continue;
+		}
+		field = strstr(line, "\"cycles_min\":");
+		if (field && (1 == sscanf(field, "\"cycles_min\":%llu", &cycles)))
+		{
+			field = strstr(line, "\"stack_bytes\":");
+			if (field && (1 == sscanf(field, "\"stack_bytes\":%u", &stack)))
+			{
+				*cyclesMin = (double)cycles;
+				*stackBytes = (double)stack;
+				found = true;
+			}
+		}
+	}
+	fclose(file);
+	return found;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t regressions = 0;
+	uint32_t failures = 0;
+
+	parseOptions(argc, argv);
+	benchStack = malloc(HOST_BENCH_STACK_SIZE);
+	if ((NULL == benchStack) || !startDevice())
+	{
+		printf("Initialization of the device failed\n");
+		return EXIT_FAILURE;
+	}
+	openInstructionCounter();
+	HostIrq_SetCycleCounter(readCycles);
+
+	if (!options.json)
+	{
+		printf("timer cases      : %u timers of the application started\n", (unsigned int)benchTimerCount);
+		printf("%-32s %10s %10s %10s %12s %8s %10s\n", "case", "cyc min", "cyc median", "ns median", "instructions",
+			"stack B", "irq-off");
+	}
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+	{
+		HostBenchResult_t result;
+		double baseCycles;
+		double baseStack;
+
+		if (options.filter && (NULL == strstr(corpus[i].name, options.filter)))
+		{
+			continue;
+		}
+		if (!measureCase(&corpus[i], &result))
+		{
+			printf("%s: frame rejected by the stack\n", corpus[i].name);
+			failures++;
+			continue;
+		}
+		printResult(&corpus[i], &result);
+
+		if (options.baseline && findBaseline(corpus[i].name, &baseCycles, &baseStack))
+		{
+			double cyclesDelta = (baseCycles > 0) ? (100.0 * (result.cyclesMin - baseCycles) / baseCycles) : 0.0;
+
+			if ((cyclesDelta > options.threshold) || (result.stackBytes > baseStack))
+			{
+				fprintf(stderr, "%s: regression, cycles %+.1f%%, stack %u bytes (baseline %.0f)\n",
+					corpus[i].name, cyclesDelta, (unsigned int)result.stackBytes, baseStack);
+				regressions++;
+			}
+		}
+	}
+
+	free(benchStack);
+	return (failures || regressions) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* eof host_bench.c */
@@ -0,0 +1,486 @@
+/**
+* \file  host_channels.c
+*
+* \brief NA and AU channel masks against the channel parameters and the channel selection they replaced
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <getopt.h>
+#include "lorawan.h"
+#include "lorawan_reg_params.h"
+#include "lorawan_multiband.h"
+#include "radio_interface.h"
+#include "pds_interface.h"
+#include "host_nvm.h"
+#include "host_device.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Mismatches printed before going on silently */
+#define HOST_CHANNELS_MAX_REPORTS       (10u)
+
+/* One channel change every n selections on average in the second run */
+#define HOST_CHANNELS_CHANGE_INTERVAL   (8u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Changes of the channel parameters after which the masks are compared */
+typedef enum _HostChannelsStep
+{
+	HOST_CHANNELS_RESET,
+	HOST_CHANNELS_DATA_RANGE,
+	HOST_CHANNELS_STATUS,
+	HOST_CHANNELS_JOIN_SUCCESS,
+	HOST_CHANNELS_JOIN_ENABLE_ALL,
+	HOST_CHANNELS_ENABLE_ALL,
+	HOST_CHANNELS_RESTORE,
+	HOST_CHANNELS_STEPS
+} HostChannelsStep_t;
+
+typedef struct _HostChannelsOptions
+{
+	uint32_t selections;
+	uint32_t seed;
+} HostChannelsOptions_t;
+
+typedef struct _HostChannelsCounters
+{
+	uint32_t steps[HOST_CHANNELS_STEPS];
+	uint32_t selections;
+	uint32_t noChannel;
+	uint32_t failures;
+} HostChannelsCounters_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostChannelsOptions_t options = {
+	.selections = 100000,
+	.seed = 1
+};
+
+static const char *const stepNames[HOST_CHANNELS_STEPS] = {
+	"reset", "setDataRange", "UpdateChannelIdStatus", "setJoinSuccess",
+	"setEnableAllChs", "Enableallchannels", "PDS restore"
+};
+
+static HostChannelsCounters_t counters;
+static uint32_t randomState;
+
+/* Channels used in the current round by the former selection */
+static bool referenceUsed[MAX_CHANNELS_AU_NA];
+
+/* Channels picked by the stack and by the former selection */
+static uint32_t stackHits[MAX_CHANNELS_AU_NA];
+static uint32_t referenceHits[MAX_CHANNELS_AU_NA];
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static uint32_t nextRandom(void);
+static void fail(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static bool maskBit(const ChannelMask_t *mask, uint8_t chid);
+static void checkMasks(HostChannelsStep_t step);
+static void change(HostChannelsStep_t step);
+static StackRetStatus_t referenceSearch(uint8_t currDr, uint8_t *channelIndex, uint8_t *lastUsedSB);
+static void selectChannel(void);
+static void run(const char *band, const char *name, uint32_t changeInterval);
+static bool checkBand(IsmBand_t band, const char *name);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -n <n>         channel selections of each run (default %u)\n"
+		"  -s <n>         seed of the changes and of the selections (default %u)\n",
+		name, (unsigned int)options.selections, (unsigned int)options.seed);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "n:s:h")))
+	{
+		switch (opt)
+		{
+			case 'n':
+				options.selections = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				options.seed = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				usage(argv[0]);
+				exit((opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief xorshift32, the same sequence for a given seed on every host
+******************************************************************************/
+static uint32_t nextRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void fail(const char *format, ...)
+{
+	va_list args;
+
+	if (counters.failures++ < HOST_CHANNELS_MAX_REPORTS)
+	{
+		va_start(args, format);
+		vprintf(format, args);
+		va_end(args);
+		printf("\n");
+	}
+}
+
+static bool maskBit(const ChannelMask_t *mask, uint8_t chid)
+{
+	if (chid < MAX_CHANNELS_BANDWIDTH_125_AU_NA)
+	{
+		return 0 != (mask->ch125 & ((uint64_t)1 << chid));
+	}
+	return 0 != (mask->ch500 & (1u << (chid - MAX_CHANNELS_BANDWIDTH_125_AU_NA)));
+}
+
+/**************************************************************************//**
+\brief Compares the enabled and data rate masks with the channel parameters
+******************************************************************************/
+static void checkMasks(HostChannelsStep_t step)
+{
+	const RegParamsType1_t *params = &RegParams.cmnParams.paramsType1;
+
+	counters.steps[step]++;
+	for (uint8_t chid = 0; chid < MAX_CHANNELS_AU_NA; chid++)
+	{
+		const ChannelParams_t *channel = &RegParams.pChParams[chid];
+
+		if (maskBit(&params->enabledChMask, chid) != (ENABLED == channel->status))
+		{
+			fail("%s: channel %u status %u, enabled mask bit %u", stepNames[step], chid,
+				channel->status, maskBit(&params->enabledChMask, chid));
+		}
+		for (uint8_t dr = 0; dr <= MAX_TXDR_T1; dr++)
+		{
+			bool inRange = (dr >= channel->dataRange.min) && (dr <= channel->dataRange.max);
+
+			if (maskBit(&params->drChMask[dr], chid) != inRange)
+			{
+				fail("%s: channel %u DR%u-DR%u, DR%u mask bit %u", stepNames[step], chid,
+					channel->dataRange.min, channel->dataRange.max, dr,
+					maskBit(&params->drChMask[dr], chid));
+			}
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Changes the channel parameters the way the MAC does, then checks the
+       masks. The restore starts from the RAM of a device after a reset.
+******************************************************************************/
+static void change(HostChannelsStep_t step)
+{
+	RegParamsType1_t *params = &RegParams.cmnParams.paramsType1;
+
+	switch (step)
+	{
+		case HOST_CHANNELS_DATA_RANGE:
+		{
+			uint8_t min = params->minTxDR + (nextRandom() % (params->maxTxDR - params->minTxDR + 1));
+			uint8_t max = min + (nextRandom() % (params->maxTxDR - min + 1));
+			ValUpdateDrange_t update = {
+				.channelIndex = (uint8_t)(nextRandom() % MAX_CHANNELS_AU_NA),
+				.dataRangeNew = (uint8_t)((max << 4) | min)
+			};
+
+			/* Ranges out of the band are refused and change nothing */
+			LORAREG_SetAttr(DATA_RANGE, &update);
+			break;
+		}
+		case HOST_CHANNELS_STATUS:
+		{
+			UpdateChId_t update = {
+				.channelIndex = (uint8_t)(nextRandom() % MAX_CHANNELS_AU_NA),
+				.statusNew = (0 != (nextRandom() % 4))
+			};
+
+			LORAREG_SetAttr(CHANNEL_ID_STATUS, &update);
+			break;
+		}
+		case HOST_CHANNELS_JOIN_SUCCESS:
+			LORAREG_SetAttr(REG_JOIN_SUCCESS, NULL);
+			break;
+		case HOST_CHANNELS_JOIN_ENABLE_ALL:
+			LORAREG_SetAttr(REG_JOIN_ENABLE_ALL, NULL);
+			break;
+		case HOST_CHANNELS_ENABLE_ALL:
+			Enableallchannels();
+			break;
+		case HOST_CHANNELS_RESTORE:
+		{
+			ChannelParams_t stored[MAX_CHANNELS_AU_NA];
+
+			PDS_Flush();
+			memcpy(stored, RegParams.pChParams, sizeof(stored));
+			memset(RegParams.pChParams, 0, sizeof(stored));
+			memset(&params->enabledChMask, 0xFF, sizeof(params->enabledChMask));
+			memset(params->drChMask, 0xFF, sizeof(params->drChMask));
+			PDS_RestoreAll();
+			if (0 != memcmp(stored, RegParams.pChParams, sizeof(stored)))
+			{
+				fail("%s: the channel parameters differ from the stored ones", stepNames[step]);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+	checkMasks(step);
+}
+
+/**************************************************************************//**
+\brief The data channel search of the stack before the channel masks: the
+       eligible channels are listed from channel 0 and rand() picks one
+******************************************************************************/
+static StackRetStatus_t referenceSearch(uint8_t currDr, uint8_t *channelIndex, uint8_t *lastUsedSB)
+{
+	uint8_t chList[MAX_CHANNELS_AU_NA][2];
+	uint8_t lastUsed = RegParams.lastUsedChannelIndex;
+	uint8_t num = 0;
+
+	for (uint8_t i = 0, k = 0; i < MAX_CHANNELS_AU_NA; i += NO_OF_CH_IN_SUBBAND, k++)
+	{
+		for (uint8_t j = 0; j < NO_OF_CH_IN_SUBBAND; j++)
+		{
+			const ChannelParams_t *channel = &RegParams.pChParams[i + j];
+
+			if ((currDr >= channel->dataRange.min) && (currDr <= channel->dataRange.max) &&
+				(ENABLED == channel->status) && ((i + j) != lastUsed) && !referenceUsed[i + j])
+			{
+				chList[num][0] = i + j;
+				chList[num][1] = ((i + j) >= MAX_CHANNELS_BANDWIDTH_125_AU_NA) ?
+					((i + j) - MAX_CHANNELS_BANDWIDTH_125_AU_NA + 1) : (k + 1);
+				num++;
+			}
+		}
+	}
+
+	if (0 != num)
+	{
+		uint8_t randomNumber = rand() % num;
+
+		*channelIndex = chList[randomNumber][0];
+		referenceUsed[*channelIndex] = true;
+#if (RANDOM_NW_ACQ == 1)
+		*lastUsedSB = (chList[randomNumber][1] >= MAX_SUBBANDS) ? 0 : chList[randomNumber][1];
+#endif
+		return LORAWAN_SUCCESS;
+	}
+
+	/* All the eligible channels were used once, the last one may go again */
+	memset(referenceUsed, 0, sizeof(referenceUsed));
+	if ((lastUsed < MAX_CHANNELS_AU_NA) && (ENABLED == RegParams.pChParams[lastUsed].status) &&
+		(currDr >= RegParams.pChParams[lastUsed].dataRange.min) &&
+		(currDr <= RegParams.pChParams[lastUsed].dataRange.max))
+	{
+		*channelIndex = lastUsed;
+		referenceUsed[lastUsed] = true;
+		return LORAWAN_SUCCESS;
+	}
+	return LORAWAN_NO_CHANNELS_FOUND;
+}
+
+/**************************************************************************//**
+\brief Selects a data channel through the regional interface, as the MAC does
+       for an uplink, and with the former search from the same rand() state
+******************************************************************************/
+static void selectChannel(void)
+{
+	RegParamsType1_t *params = &RegParams.cmnParams.paramsType1;
+	NewTxChannelReq_t request = {
+		.transmissionType = true,
+		.txPwr = 0,
+		.currDr = params->minTxDR + (nextRandom() % (params->maxTxDR - params->minTxDR + 1))
+	};
+	radioConfig_t radioConfig;
+	uint8_t expectedChannel = RegParams.lastUsedChannelIndex;
+	uint8_t expectedSB = params->lastUsedSB;
+	unsigned int seed = nextRandom();
+	StackRetStatus_t expected;
+	StackRetStatus_t status;
+
+	srand(seed);
+	expected = referenceSearch(request.currDr, &expectedChannel, &expectedSB);
+	srand(seed);
+	status = LORAREG_GetAttr(NEW_TX_CHANNEL_CONFIG, &request, &radioConfig);
+
+	counters.selections++;
+	if ((status != expected) || (RegParams.lastUsedChannelIndex != expectedChannel) ||
+		(params->lastUsedSB != expectedSB))
+	{
+		fail("selection %u DR%u: status %u channel %u sub-band %u, expected status %u channel %u sub-band %u",
+			(unsigned int)counters.selections, request.currDr, status, RegParams.lastUsedChannelIndex,
+			params->lastUsedSB, expected, expectedChannel, expectedSB);
+		/* Go on from the pick of the former search */
+		RegParams.lastUsedChannelIndex = expectedChannel;
+		params->lastUsedSB = expectedSB;
+	}
+	if (LORAWAN_SUCCESS != status)
+	{
+		counters.noChannel++;
+		return;
+	}
+	stackHits[RegParams.lastUsedChannelIndex]++;
+	referenceHits[expectedChannel]++;
+}
+
+/**************************************************************************//**
+\brief Selections with the channel parameters changed every changeInterval
+       selections on average, 0 never. Prints how the picks spread over the
+       channels.
+******************************************************************************/
+static void run(const char *band, const char *name, uint32_t changeInterval)
+{
+	uint32_t channels = 0;
+	uint32_t minHits = UINT32_MAX;
+	uint32_t maxHits = 0;
+	uint32_t noChannel = counters.noChannel;
+
+	memset(stackHits, 0, sizeof(stackHits));
+	memset(referenceHits, 0, sizeof(referenceHits));
+	for (uint32_t n = 0; n < options.selections; n++)
+	{
+		if (changeInterval && (0 == (nextRandom() % changeInterval)))
+		{
+			change((HostChannelsStep_t)(HOST_CHANNELS_DATA_RANGE +
+				(nextRandom() % (HOST_CHANNELS_STEPS - HOST_CHANNELS_DATA_RANGE))));
+		}
+		selectChannel();
+	}
+
+	for (uint8_t chid = 0; chid < MAX_CHANNELS_AU_NA; chid++)
+	{
+		if (stackHits[chid])
+		{
+			channels++;
+			minHits = (stackHits[chid] < minHits) ? stackHits[chid] : minHits;
+			maxHits = (stackHits[chid] > maxHits) ? stackHits[chid] : maxHits;
+		}
+	}
+	if (0 != memcmp(stackHits, referenceHits, sizeof(stackHits)))
+	{
+		fail("%s %s: the channels are not spread as by the former selection", band, name);
+	}
+	printf("%-6s %-9s : %u selections, %u without channel, %u channels picked %u to %u times\n",
+		band, name, (unsigned int)options.selections, (unsigned int)(counters.noChannel - noChannel),
+		(unsigned int)channels, (unsigned int)(channels ? minHits : 0), (unsigned int)maxHits);
+}
+
+static bool checkBand(IsmBand_t band, const char *name)
+{
+	if (LORAWAN_SUCCESS != LORAWAN_Reset(band))
+	{
+		printf("%-6s : not built\n", name);
+		return false;
+	}
+	checkMasks(HOST_CHANNELS_RESET);
+
+	/* Every change once, then the selections on the default channels and
+	   with changes in between */
+	for (uint32_t step = HOST_CHANNELS_DATA_RANGE; step < HOST_CHANNELS_STEPS; step++)
+	{
+		change((HostChannelsStep_t)step);
+	}
+	LORAREG_SetAttr(REG_JOIN_ENABLE_ALL, NULL);
+	run(name, "fixed", 0);
+	run(name, "changes", HOST_CHANNELS_CHANGE_INTERVAL);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	HostDeviceConfig_t device = {
+		.label = NULL,
+		.band = ISM_NA915,
+		.seed = 1,
+		.intervalMs = UINT32_MAX / 2,
+		.dataRate = HOST_DEVICE_DEFAULT_DATARATE,
+		.abp = true
+	};
+	uint32_t checks = 0;
+
+	parseOptions(argc, argv);
+	randomState = options.seed ? options.seed : 1;
+
+	HostNvm_Format();
+	if (!HostDevice_Start(&device))
+	{
+		printf("Initialization of the device failed\n");
+		return EXIT_FAILURE;
+	}
+
+	checkBand(ISM_NA915, "na915");
+	checkBand(ISM_AU915, "au915");
+
+	printf("mask checks      :");
+	for (uint32_t step = 0; step < HOST_CHANNELS_STEPS; step++)
+	{
+		printf("%s %u %s", step ? "," : "", (unsigned int)counters.steps[step], stepNames[step]);
+		checks += counters.steps[step];
+	}
+	printf("\n");
+	printf("%s\n", (counters.failures || !checks) ? "FAILED" : "PASSED");
+	return (counters.failures || !checks) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* eof host_channels.c */
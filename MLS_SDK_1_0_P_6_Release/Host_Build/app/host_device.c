@@ -0,0 +1,792 @@
+/**
+* \file  host_device.c
+*
+* \brief End device application of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include "sys.h"
+#include "system_init.h"
+#include "system_task_manager.h"
+#include "radio_driver_hal.h"
+#include "lorawan.h"
+#include "lorawan_reg_params.h"
+#include "radio_interface.h"
+#include "sw_timer.h"
+#include "pmm.h"
+#include "sleep_timer.h"
+#include "pds_interface.h"
+#include "sal.h"
+#include "conf_app.h"
+#include "conf_pmm.h"
+#include "host_clock.h"
+#include "host_nvm.h"
+#include "host_device.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Data rates searched for the configured spreading factor */
+#define HOST_DEVICE_MAX_DATARATES       (16)
+
+/* Retry delay of a refused send or join in ms */
+#define HOST_DEVICE_RETRY_DELAY_MS      (1000)
+
+/* Uplinks handed to the uplink queue of the stack at a time */
+#define HOST_DEVICE_QUEUED_UPLINKS      (8)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+typedef enum _HostDeviceState
+{
+	HOST_DEVICE_JOIN = 0,
+	HOST_DEVICE_SEND,
+	HOST_DEVICE_WAIT,
+	HOST_DEVICE_DONE
+} HostDeviceState_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostDeviceConfig_t deviceConfig;
+static HostDeviceState_t deviceState = HOST_DEVICE_DONE;
+static HostDeviceStats_t deviceStats;
+static uint8_t appTimerId;
+static uint64_t runUntil;
+static uint32_t intervalRandom;
+static uint8_t payload[SX1276_MODEL_MAX_PAYLOAD];
+/* The stack keeps a reference to the request until the transaction ends */
+static LorawanSendReq_t sendReq;
+/* Queued uplinks, a request is free again once its transaction is reported */
+static LorawanSendReq_t queuedReq[HOST_DEVICE_QUEUED_UPLINKS];
+static uint8_t queuedPayload[HOST_DEVICE_QUEUED_UPLINKS][SX1276_MODEL_MAX_PAYLOAD];
+static bool queuedBusy[HOST_DEVICE_QUEUED_UPLINKS];
+static uint32_t queuedReading[HOST_DEVICE_QUEUED_UPLINKS];
+static uint32_t readings;
+static uint32_t refusedReadings;
+static PMM_SleepReq_t sleepReq;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void trace(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static bool driverInit(void);
+static void provision(bool credentials);
+static bool restore(void);
+static uint8_t dataRateOf(uint8_t spreadingFactor);
+static uint32_t nextIntervalMs(void);
+static uint32_t pendingWaitMs(bool join);
+static void startAppTimer(HostDeviceState_t next, uint32_t delayMs);
+static void appTimerCallback(void *param);
+static void joinCallback(StackRetStatus_t status);
+static void appDataCallback(void *appHandle, appCbParams_t *data);
+static void transactionComplete(StackRetStatus_t status);
+static void sendUplink(void);
+static void queueUplink(void);
+static void queuedComplete(void *appHandle, StackRetStatus_t status);
+static void aggregatedComplete(StackRetStatus_t status);
+static void aggregationCheckDone(void);
+static bool queueEmpty(void);
+static bool idle(void);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void trace(const char *format, ...)
+{
+	va_list args;
+
+	if (!deviceConfig.verbose)
+	{
+		return;
+	}
+	printf("[%10.3f] %s%s", HostClock_Now() / 1e6, deviceConfig.label ? deviceConfig.label : "",
+		deviceConfig.label ? ": " : "");
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	printf("\n");
+}
+
+/**************************************************************************//**
+\brief Same sequence as driverInit() of the reference demo
+******************************************************************************/
+static bool driverInit(void)
+{
+	/* Initialize the Radio Hardware */
+	HAL_RadioInit();
+	/* Initialize the Software Timer Module */
+	SystemTimerInit();
+	/* Initialize the Sleep Timer Module */
+	SleepTimerInit();
+	/* PDS Module Init */
+	PDS_Init();
+	/* Initializes the Security modules */
+	return SAL_SUCCESS == SAL_Init();
+}
+
+/**************************************************************************//**
+\brief Hands the credentials and policies of the configuration to the stack
+\param[in] credentials false to keep the credentials of a restored session
+******************************************************************************/
+static void provision(bool credentials)
+{
+	JoinNonceType_t joinNonceType = DEMO_APP_JOIN_NONCE_TYPE;
+
+	LORAWAN_SetAttr(JOIN_BACKOFF_ENABLE, &deviceConfig.joinBackoff);
+	LORAWAN_SetAttr(REGIONAL_DUTY_CYCLE, &deviceConfig.dutyCycle);
+	LORAWAN_SetAttr(JOIN_NONCE_TYPE, &joinNonceType);
+	LORAWAN_SetAttr(MAX_FCNT_PDS_UPDATE_VAL, &deviceConfig.fCntReservation);
+	if (HOST_DEVICE_DEFAULT_DATARATE != deviceConfig.dataRate)
+	{
+		LORAWAN_SetAttr(CURRENT_DATARATE, &deviceConfig.dataRate);
+	}
+
+	if (!credentials)
+	{
+		return;
+	}
+	if (deviceConfig.abp)
+	{
+		LORAWAN_SetAttr(DEV_ADDR, &deviceConfig.devAddr);
+		LORAWAN_SetAttr(APPS_KEY, deviceConfig.appSKey);
+		LORAWAN_SetAttr(NWKS_KEY, deviceConfig.nwkSKey);
+	}
+	else
+	{
+		LORAWAN_SetAttr(DEV_EUI, deviceConfig.devEui);
+		LORAWAN_SetAttr(JOIN_EUI, deviceConfig.joinEui);
+		LORAWAN_SetAttr(APP_KEY, deviceConfig.appKey);
+	}
+}
+
+/**************************************************************************//**
+\brief Same restore sequence as the reference demo: the band of the stored
+       session resets the stack before the second restore
+\return true if the restored session has joined the network
+******************************************************************************/
+static bool restore(void)
+{
+	uint8_t band = 0xFF;
+	LorawanStatus_t status = {.value = 0};
+
+	PDS_RestoreAll();
+	LORAWAN_GetAttr(ISMBAND, NULL, &band);
+	if (LORAWAN_SUCCESS != LORAWAN_Reset((IsmBand_t)band))
+	{
+		return false;
+	}
+	PDS_RestoreAll();
+	LORAWAN_GetAttr(LORAWAN_STATUS, NULL, &status.value);
+	return status.networkJoined;
+}
+
+/**************************************************************************//**
+\brief Looks up the data rate of the regional plan using the given spreading
+       factor at 125kHz
+******************************************************************************/
+static uint8_t dataRateOf(uint8_t spreadingFactor)
+{
+	for (uint8_t dr = 0; dr < HOST_DEVICE_MAX_DATARATES; dr++)
+	{
+		RadioDataRate_t sf;
+		RadioLoRaBandWidth_t bw;
+
+		if ((LORAWAN_SUCCESS == LORAREG_GetAttr(SPREADING_FACTOR_ATTR, &dr, &sf)) &&
+			(LORAWAN_SUCCESS == LORAREG_GetAttr(BANDWIDTH_ATTR, &dr, &bw)) &&
+			(spreadingFactor == sf) && (BW_125KHZ == bw))
+		{
+			return dr;
+		}
+	}
+	return HOST_DEVICE_DEFAULT_DATARATE;
+}
+
+/**************************************************************************//**
+\brief Returns the delay until the next uplink, exponentially distributed
+       around the configured interval if requested
+******************************************************************************/
+static uint32_t nextIntervalMs(void)
+{
+	double u;
+
+	if (!deviceConfig.randomInterval || (0 == deviceConfig.intervalMs))
+	{
+		return deviceConfig.intervalMs;
+	}
+
+	/* xorshift32, independent of the stack generator */
+	intervalRandom ^= intervalRandom << 13;
+	intervalRandom ^= intervalRandom >> 17;
+	intervalRandom ^= intervalRandom << 5;
+	u = (intervalRandom + 1.0) / 4294967297.0;
+	return (uint32_t)(-log(u) * deviceConfig.intervalMs);
+}
+
+/**************************************************************************//**
+\brief Returns the wait until the duty cycle, and for a join request the join
+       backoff, let the stack transmit again. The bands without duty cycle
+       report UINT32_MAX as pending time. An uplink waits until the earliest
+       time the stack reports for its length and data rate.
+\param[in] join true for a join request
+******************************************************************************/
+static uint32_t pendingWaitMs(bool join)
+{
+	uint32_t pendingMs = UINT32_MAX;
+	uint32_t waitMs = 0;
+	EarliestTxTimeParams_t txParams;
+	uint64_t earliestTxTime;
+
+	LORAWAN_GetAttr(CURRENT_DATARATE, NULL, &txParams.dr);
+	txParams.length = deviceConfig.payloadLength;
+	if (!join && (LORAWAN_SUCCESS == LORAWAN_GetAttr(EARLIEST_TX_TIME, &txParams, &earliestTxTime)))
+	{
+		uint64_t now = SwTimerGetTime();
+
+		if (earliestTxTime > now)
+		{
+			/* Rounded up to the next millisecond */
+			waitMs = (uint32_t)US_TO_MS(earliestTxTime - now + MS_TO_US(1) - 1);
+		}
+	}
+	else
+	{
+		LORAWAN_GetAttr(PENDING_DUTY_CYCLE_TIME, NULL, &pendingMs);
+		if (UINT32_MAX != pendingMs)
+		{
+			waitMs = pendingMs;
+		}
+	}
+	if (join)
+	{
+		pendingMs = UINT32_MAX;
+		LORAWAN_GetAttr(PENDING_JOIN_DUTY_CYCLE_TIME, NULL, &pendingMs);
+		if ((UINT32_MAX != pendingMs) && (pendingMs > waitMs))
+		{
+			waitMs = pendingMs;
+		}
+	}
+	return waitMs ? (waitMs + 1) : HOST_DEVICE_RETRY_DELAY_MS;
+}
+
+static void startAppTimer(HostDeviceState_t next, uint32_t delayMs)
+{
+	if (0 == delayMs)
+	{
+		deviceState = next;
+		SYSTEM_PostTask(APP_TASK_ID);
+		return;
+	}
+	deviceState = HOST_DEVICE_WAIT;
+	SwTimerStart(appTimerId, MS_TO_US(delayMs), SW_TIMEOUT_RELATIVE, (void *)appTimerCallback,
+		(void *)(uintptr_t)next);
+}
+
+static void appTimerCallback(void *param)
+{
+	deviceState = (HostDeviceState_t)(uintptr_t)param;
+	SYSTEM_PostTask(APP_TASK_ID);
+}
+
+static void joinCallback(StackRetStatus_t status)
+{
+	if (LORAWAN_SUCCESS == status)
+	{
+		uint32_t devAddr;
+
+		if (0 == deviceStats.joins++)
+		{
+			deviceStats.joinTimeUs = HostClock_Now();
+		}
+		LORAWAN_GetAttr(DEV_ADDR, NULL, &devAddr);
+		trace("Join success, device address 0x%08x", (unsigned int)devAddr);
+		if (HOST_DEVICE_DEFAULT_DATARATE != deviceConfig.dataRate)
+		{
+			LORAWAN_SetAttr(CURRENT_DATARATE, &deviceConfig.dataRate);
+		}
+		if (deviceConfig.restore)
+		{
+			PDS_StoreAll();
+		}
+		startAppTimer(HOST_DEVICE_SEND, 0);
+		return;
+	}
+
+	trace("Join failed, status %d", status);
+	if (deviceConfig.maxJoinAttempts && (deviceStats.joinAttempts >= deviceConfig.maxJoinAttempts))
+	{
+		deviceState = HOST_DEVICE_DONE;
+		return;
+	}
+	if (LORAWAN_NO_CHANNELS_FOUND == status)
+	{
+		/* Wait for the duty cycle and join backoff budgets */
+		deviceStats.dutyCycleWaits++;
+		startAppTimer(HOST_DEVICE_JOIN, pendingWaitMs(true));
+		return;
+	}
+	startAppTimer(HOST_DEVICE_JOIN, 0);
+}
+
+static void appDataCallback(void *appHandle, appCbParams_t *data)
+{
+	switch (data->evt)
+	{
+		case LORAWAN_EVT_RX_DATA_AVAILABLE:
+			deviceStats.downlinks++;
+			trace("Downlink, %u bytes", (unsigned int)data->param.rxData.dataLength);
+			break;
+
+		case LORAWAN_EVT_TRANSACTION_COMPLETE:
+			if (deviceConfig.aggregate)
+			{
+				aggregatedComplete(data->param.transCmpl.status);
+			}
+			else if (deviceConfig.queued)
+			{
+				queuedComplete(appHandle, data->param.transCmpl.status);
+			}
+			else
+			{
+				transactionComplete(data->param.transCmpl.status);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void transactionComplete(StackRetStatus_t status)
+{
+	uint32_t count;
+
+	if (LORAWAN_NO_CHANNELS_FOUND == status)
+	{
+		/* No channel is free in the duty cycle budget; try again once one is */
+		deviceStats.dutyCycleWaits++;
+		startAppTimer(HOST_DEVICE_SEND, pendingWaitMs(false));
+		return;
+	}
+
+	if (LORAWAN_SUCCESS == status)
+	{
+		deviceStats.uplinks++;
+	}
+	else
+	{
+		deviceStats.uplinkFailures++;
+	}
+	count = deviceStats.uplinks + deviceStats.uplinkFailures;
+	trace("Uplink %u complete, status %d", (unsigned int)count, status);
+
+	if (deviceConfig.cycles && (count >= deviceConfig.cycles))
+	{
+		deviceState = HOST_DEVICE_DONE;
+		return;
+	}
+	startAppTimer(HOST_DEVICE_SEND, nextIntervalMs());
+}
+
+static void sendUplink(void)
+{
+	StackRetStatus_t status;
+	uint32_t count = deviceStats.uplinks + deviceStats.uplinkFailures;
+
+	for (uint8_t i = 0; i < deviceConfig.payloadLength; i++)
+	{
+		payload[i] = (uint8_t)(count + i);
+	}
+	sendReq.confirmed = deviceConfig.confirmed ? LORAWAN_CNF : LORAWAN_UNCNF;
+	sendReq.port = DEMO_APP_FPORT;
+	sendReq.buffer = payload;
+	sendReq.bufferLength = deviceConfig.payloadLength;
+
+	status = LORAWAN_Send(&sendReq);
+	if (LORAWAN_SUCCESS != status)
+	{
+		/* Retry after the next event, e.g. the end of a duty cycle wait */
+		deviceStats.uplinkFailures++;
+		trace("Send refused, status %d", status);
+		if (deviceConfig.cycles && ((count + 1) >= deviceConfig.cycles))
+		{
+			deviceState = HOST_DEVICE_DONE;
+			return;
+		}
+		startAppTimer(HOST_DEVICE_SEND,
+			deviceConfig.intervalMs ? deviceConfig.intervalMs : HOST_DEVICE_RETRY_DELAY_MS);
+	}
+}
+
+/**************************************************************************//**
+\brief Takes a reading and hands it to the uplink queue of the stack, which
+       sends it as soon as the duty cycle allows, or to the record aggregation
+       of the stack. A reading is lost when the stack refuses it.
+******************************************************************************/
+static void queueUplink(void)
+{
+	StackRetStatus_t status = LORAWAN_RESOURCE_UNAVAILABLE;
+	uint32_t count = readings++;
+	uint8_t slot = HOST_DEVICE_QUEUED_UPLINKS;
+
+	if (deviceConfig.aggregate)
+	{
+		for (uint8_t i = 0; i < deviceConfig.payloadLength; i++)
+		{
+			payload[i] = (uint8_t)(count + i);
+		}
+		status = LORAWAN_AggregateRecord(DEMO_APP_FPORT, payload, deviceConfig.payloadLength, 0);
+	}
+	else
+	{
+		for (slot = 0; (slot < HOST_DEVICE_QUEUED_UPLINKS) && queuedBusy[slot]; slot++)
+		{
+		}
+	}
+	if (slot < HOST_DEVICE_QUEUED_UPLINKS)
+	{
+		for (uint8_t i = 0; i < deviceConfig.payloadLength; i++)
+		{
+			queuedPayload[slot][i] = (uint8_t)(count + i);
+		}
+		queuedReq[slot].confirmed = deviceConfig.confirmed ? LORAWAN_CNF : LORAWAN_UNCNF;
+		queuedReq[slot].port = DEMO_APP_FPORT;
+		queuedReq[slot].buffer = queuedPayload[slot];
+		queuedReq[slot].bufferLength = deviceConfig.payloadLength;
+		queuedReading[slot] = count + 1;
+		status = LORAWAN_SendQueued(&queuedReq[slot], 0, deviceConfig.queueLifetimeMs);
+		queuedBusy[slot] = (LORAWAN_SUCCESS == status);
+	}
+	if (LORAWAN_SUCCESS != status)
+	{
+		deviceStats.uplinkFailures++;
+		refusedReadings++;
+		trace("Reading %u lost, status %d", (unsigned int)(count + 1), status);
+	}
+
+	if (deviceConfig.cycles && (readings >= deviceConfig.cycles))
+	{
+		if (deviceConfig.aggregate)
+		{
+			/* Send the last records, done once they are reported */
+			LORAWAN_FlushRecords();
+			aggregationCheckDone();
+			return;
+		}
+		/* Done once the queue has reported all the uplinks */
+		if (queueEmpty())
+		{
+			deviceState = HOST_DEVICE_DONE;
+		}
+		return;
+	}
+	startAppTimer(HOST_DEVICE_SEND,
+		deviceConfig.intervalMs ? nextIntervalMs() : HOST_DEVICE_RETRY_DELAY_MS);
+}
+
+static void queuedComplete(void *appHandle, StackRetStatus_t status)
+{
+	uint8_t slot;
+
+	for (slot = 0; (slot < HOST_DEVICE_QUEUED_UPLINKS) && (appHandle != &queuedReq[slot]); slot++)
+	{
+	}
+	if (HOST_DEVICE_QUEUED_UPLINKS == slot)
+	{
+		/* Transaction of the MAC commands alone */
+		return;
+	}
+	queuedBusy[slot] = false;
+
+	if (LORAWAN_SUCCESS == status)
+	{
+		deviceStats.uplinks++;
+	}
+	else
+	{
+		deviceStats.uplinkFailures++;
+		if (LORAWAN_UPLINK_EXPIRED == status)
+		{
+			deviceStats.expiredUplinks++;
+		}
+	}
+	trace("Uplink of reading %u complete, status %d", (unsigned int)queuedReading[slot], status);
+
+	if (deviceConfig.cycles && (readings >= deviceConfig.cycles) && queueEmpty())
+	{
+		deviceState = HOST_DEVICE_DONE;
+	}
+}
+
+static void aggregatedComplete(StackRetStatus_t status)
+{
+	if (LORAWAN_SUCCESS == status)
+	{
+		deviceStats.uplinks++;
+	}
+	else
+	{
+		deviceStats.uplinkFailures++;
+	}
+	trace("Uplink of aggregated readings complete, status %d", status);
+	aggregationCheckDone();
+}
+
+/**************************************************************************//**
+\brief Reads the counters of the aggregation, the device is done once every
+       reading is sent, dropped or refused
+******************************************************************************/
+static void aggregationCheckDone(void)
+{
+	AggregationStats_t stats;
+
+	LORAWAN_GetAttr(AGGREGATION_STATS, NULL, &stats);
+	deviceStats.aggregatedReadings = stats.records;
+	deviceStats.aggregatedAirtimeUs = stats.airtime;
+	deviceStats.separateAirtimeUs = stats.separateAirtime;
+
+	if (deviceConfig.cycles && (readings >= deviceConfig.cycles) &&
+		((stats.records + stats.droppedRecords + refusedReadings) >= readings))
+	{
+		deviceState = HOST_DEVICE_DONE;
+	}
+}
+
+static bool queueEmpty(void)
+{
+	for (uint8_t slot = 0; slot < HOST_DEVICE_QUEUED_UPLINKS; slot++)
+	{
+		if (queuedBusy[slot])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief Task handler of the application layer, called by SYSTEM_RunTasks()
+******************************************************************************/
+SYSTEM_TaskStatus_t APP_TaskHandler(void)
+{
+	switch (deviceState)
+	{
+		case HOST_DEVICE_JOIN:
+		{
+			StackRetStatus_t status;
+
+			deviceStats.joinAttempts++;
+			deviceState = HOST_DEVICE_WAIT;
+			status = LORAWAN_Join(deviceConfig.abp ? LORAWAN_ABP : LORAWAN_OTAA);
+			if (LORAWAN_SUCCESS != status)
+			{
+				trace("Join request refused, status %d", status);
+				startAppTimer(HOST_DEVICE_JOIN, HOST_DEVICE_RETRY_DELAY_MS);
+			}
+			break;
+		}
+
+		case HOST_DEVICE_SEND:
+			deviceState = HOST_DEVICE_WAIT;
+			if (deviceConfig.queued || deviceConfig.aggregate)
+			{
+				queueUplink();
+			}
+			else
+			{
+				sendUplink();
+			}
+			break;
+
+		default:
+			break;
+	}
+	return SYSTEM_TASK_SUCCESS;
+}
+
+/**************************************************************************//**
+\brief Waits for the next interrupt, in the sleep mode of the reference demo
+       whenever the stack allows it
+\return false if no interrupt is due before the horizon of the clock
+******************************************************************************/
+static bool idle(void)
+{
+	if (!SYSTEM_ReadyToSleep())
+	{
+		return true;
+	}
+
+	sleepReq.sleepTimeMs = PMM_SLEEPTIME_MAX_MS;
+	sleepReq.pmmWakeupCallback = NULL;
+	sleepReq.sleep_mode = CONF_PMM_SLEEPMODE_WHEN_IDLE;
+	if (LORAWAN_ReadyToSleep(false) && (PMM_SLEEP_REQ_PROCESSED == PMM_Sleep(&sleepReq)))
+	{
+		deviceStats.sleeps++;
+		/* The wakeup may lie beyond the horizon, the clock stops there */
+		return !SYSTEM_ReadyToSleep() || (HostClock_NextDue() <= runUntil);
+	}
+
+	return HostClock_WaitForInterrupt();
+}
+
+/******************************************************************************
+                     Interface section
+******************************************************************************/
+/**************************************************************************//**
+\brief Powers the device on
+******************************************************************************/
+bool HostDevice_Start(const HostDeviceConfig_t *config)
+{
+	bool joined = false;
+
+	deviceConfig = *config;
+	memset(&deviceStats, 0, sizeof(deviceStats));
+	deviceStats.joinTimeUs = HOST_CLOCK_NEVER;
+	intervalRandom = config->seed ? config->seed : 1u;
+	memset(queuedBusy, 0, sizeof(queuedBusy));
+	readings = 0;
+	refusedReadings = 0;
+
+	HostClock_Reset();
+	SX1276Model_Reset();
+	SX1276Model_Seed(config->seed);
+	SX1276Model_SetAir(config->air);
+
+	INTERRUPT_GlobalInterruptEnable();
+	if (!driverInit() || (LORAWAN_SUCCESS != SwTimerCreate(&appTimerId)) ||
+		(LORAWAN_SUCCESS != SwTimerSetSlack(appTimerId, MS_TO_US(config->timerSlackMs))))
+	{
+		return false;
+	}
+	LORAWAN_Init(appDataCallback, joinCallback);
+	if (LORAWAN_SUCCESS != LORAWAN_Reset(config->band))
+	{
+		return false;
+	}
+	if (config->spreadingFactor)
+	{
+		deviceConfig.dataRate = dataRateOf(config->spreadingFactor);
+	}
+	if (config->restore && PDS_IsRestorable())
+	{
+		joined = restore();
+		trace("Restored from PDS, %s", joined ? "joined" : "not joined");
+	}
+	provision(!joined);
+	LORAWAN_GetAttr(UPLINK_COUNTER, NULL, &deviceStats.fCntUpStart);
+
+	/* Kick-start application tasks */
+	Stack_Init();
+	startAppTimer(joined ? HOST_DEVICE_SEND : HOST_DEVICE_JOIN, config->startDelayMs);
+	return true;
+}
+
+/**************************************************************************//**
+\brief Runs the device until it has nothing left to do before the given time
+******************************************************************************/
+bool HostDevice_Run(uint64_t until)
+{
+	runUntil = until;
+	HostClock_SetHorizon(until);
+	while (HOST_DEVICE_DONE != deviceState)
+	{
+		/* Run all the posted tasks */
+		SYSTEM_RunTasks();
+		if ((HOST_DEVICE_DONE == deviceState) || !idle())
+		{
+			break;
+		}
+	}
+
+	if ((HOST_DEVICE_DONE != deviceState) && (HOST_CLOCK_NEVER == HostClock_NextDue()))
+	{
+		trace("No pending event, the stack is stuck");
+		deviceState = HOST_DEVICE_DONE;
+	}
+	if (HOST_DEVICE_DONE == deviceState)
+	{
+		/* The device is switched off: its brownout detection writes the
+		   deferred PDS items */
+		PDS_Flush();
+	}
+	return HOST_DEVICE_DONE != deviceState;
+}
+
+/**************************************************************************//**
+\brief Returns the virtual time of the next event of the device
+******************************************************************************/
+uint64_t HostDevice_NextEvent(void)
+{
+	if (HOST_DEVICE_DONE == deviceState)
+	{
+		return HOST_CLOCK_NEVER;
+	}
+	/* Posted tasks run right away */
+	return SYSTEM_ReadyToSleep() ? HostClock_NextDue() : HostClock_Now();
+}
+
+/**************************************************************************//**
+\brief Reads the result counters of the device
+******************************************************************************/
+void HostDevice_GetStats(HostDeviceStats_t *stats, SX1276ModelStats_t *radio)
+{
+	SwTimerStats_t timers;
+
+	SwTimerGetStats(&timers);
+	deviceStats.expiredTimers = timers.expiredTimers;
+	deviceStats.coalescedTimers = timers.coalescedTimers;
+	LORAWAN_GetAttr(UPLINK_COUNTER, NULL, &deviceStats.fCntUp);
+	*stats = deviceStats;
+	if (radio)
+	{
+		SX1276Model_GetStats(radio);
+	}
+}
+
+/**************************************************************************//**
+\brief Reads the airtime and energy counters of the stack
+******************************************************************************/
+void HostDevice_GetEnergy(EnergyStats_t *energy)
+{
+	LORAWAN_GetAttr(ENERGY_STATS, NULL, energy);
+}
+
+/* eof host_device.c */
@@ -0,0 +1,216 @@
+/**
+* \file  host_device.h
+*
+* \brief End device application of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_DEVICE_H
+#define HOST_DEVICE_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stack_common.h"
+#include "lorawan.h"
+#include "sx1276_model.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Entry points of the device image loaded by the simulator */
+#define HOST_DEVICE_API                 __attribute__((visibility("default")))
+
+/* Data rate value leaving the choice to the stack */
+#define HOST_DEVICE_DEFAULT_DATARATE    (0xFF)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Settings of an end device */
+typedef struct _HostDeviceConfig
+{
+	/* Name printed in front of the trace lines, may be NULL */
+	const char *label;
+
+	/* Regional band */
+	IsmBand_t band;
+
+	/* Over the air activation credentials */
+	uint8_t devEui[8];
+	uint8_t joinEui[8];
+	uint8_t appKey[16];
+
+	/* Activation by personalization credentials */
+	uint32_t devAddr;
+	uint8_t nwkSKey[16];
+	uint8_t appSKey[16];
+
+	/* Medium the transceiver is attached to */
+	const SX1276Air_t *air;
+
+	/* Seed of the transceiver noise, hence of the stack random generator */
+	uint32_t seed;
+
+	/* Number of uplinks to send, 0 for no limit */
+	uint32_t cycles;
+
+	/* Delay between power on and the join request in ms */
+	uint32_t startDelayMs;
+
+	/* Delay between two uplinks in ms */
+	uint32_t intervalMs;
+
+	/* Delay in ms the application timer may be postponed by to share a wakeup */
+	uint32_t timerSlackMs;
+
+	/* Join attempts before giving up, 0 for no limit */
+	uint16_t maxJoinAttempts;
+
+	/* Uplink payload length */
+	uint8_t payloadLength;
+
+	/* Uplink data rate or HOST_DEVICE_DEFAULT_DATARATE */
+	uint8_t dataRate;
+
+	/* Uplink spreading factor at 125kHz, overrides dataRate unless 0 */
+	uint8_t spreadingFactor;
+
+	/* 2 ^ fCntReservation uplink frame counters are reserved per PDS update */
+	uint8_t fCntReservation;
+
+	/* Keep the session in PDS across power cycles as the reference demo
+	 * does: resume it instead of provisioning and joining when it can be
+	 * restored, store all the items once joined otherwise */
+	bool restore;
+
+	/* Draw the intervals from an exponential distribution of the given mean */
+	bool randomInterval;
+	bool abp;
+	bool confirmed;
+
+	/* Hand the uplinks to the uplink queue of the stack: a reading is taken
+	 * every interval, whether the previous uplink is complete or not */
+	bool queued;
+
+	/* Lifetime of a queued uplink in ms, 0 for no limit */
+	uint32_t queueLifetimeMs;
+
+	/* Aggregate the readings into frames with LORAWAN_AggregateRecord() */
+	bool aggregate;
+
+	/* Regional duty cycle and join backoff enforcement */
+	bool dutyCycle;
+	bool joinBackoff;
+
+	/* Print a line for every transaction */
+	bool verbose;
+} HostDeviceConfig_t;
+
+/* Result counters of a device */
+typedef struct _HostDeviceStats
+{
+	uint32_t joinAttempts;
+	uint32_t joins;
+	uint32_t uplinks;
+	uint32_t uplinkFailures;
+	uint32_t downlinks;
+	uint32_t dutyCycleWaits;
+
+	/* Queued uplinks dropped by the stack past their lifetime */
+	uint32_t expiredUplinks;
+
+	/* Aggregated readings sent and their time on air, and the time on air
+	   of the same readings sent one per frame, in us */
+	uint32_t aggregatedReadings;
+	uint64_t aggregatedAirtimeUs;
+	uint64_t separateAirtimeUs;
+	uint32_t sleeps;
+
+	/* Software timer expiries, and those which shared another wakeup */
+	uint32_t expiredTimers;
+	uint32_t coalescedTimers;
+
+	/* Virtual time of the first successful join, HOST_CLOCK_NEVER if none */
+	uint64_t joinTimeUs;
+
+	/* Uplink frame counter after the start and now */
+	uint32_t fCntUpStart;
+	uint32_t fCntUp;
+} HostDeviceStats_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Powers the device on: resets the virtual hardware, initializes the
+       stack and provisions the credentials, or resumes the session stored
+       in PDS when asked to. Nothing runs until HostDevice_Run() is called.
+\param[in] config Device settings, copied
+\return true if the stack could be initialized
+******************************************************************************/
+HOST_DEVICE_API bool HostDevice_Start(const HostDeviceConfig_t *config);
+
+/**************************************************************************//**
+\brief Runs the device until it has nothing left to do before the given
+       virtual time
+\param[in] until Absolute virtual time in microseconds or HOST_CLOCK_NEVER
+\return false once the device is done (all cycles sent, join given up or
+        no event pending anymore)
+******************************************************************************/
+HOST_DEVICE_API bool HostDevice_Run(uint64_t until);
+
+/**************************************************************************//**
+\brief Returns the virtual time of the next event of the device
+\return Due time in microseconds or HOST_CLOCK_NEVER
+******************************************************************************/
+HOST_DEVICE_API uint64_t HostDevice_NextEvent(void);
+
+/**************************************************************************//**
+\brief Reads the result counters of the device
+\param[out] stats Application counters
+\param[out] radio Transceiver counters, may be NULL
+******************************************************************************/
+HOST_DEVICE_API void HostDevice_GetStats(HostDeviceStats_t *stats, SX1276ModelStats_t *radio);
+
+/**************************************************************************//**
+\brief Reads the airtime and energy counters of the stack
+\param[out] energy Counters since the last reset of the stack
+******************************************************************************/
+HOST_DEVICE_API void HostDevice_GetEnergy(EnergyStats_t *energy);
+
+#endif /* HOST_DEVICE_H */
+
+/* eof host_device.h */
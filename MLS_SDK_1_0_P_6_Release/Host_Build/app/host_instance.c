@@ -0,0 +1,289 @@
+/**
+* \file  host_instance.c
+*
+* \brief Multiple instances of the stack image in one process
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <link.h>
+#include "host_instance.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Writable PT_LOAD segments handled per object */
+#define HOST_INSTANCE_MAX_RANGES        (4)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Writable range of the loaded object, RELRO excluded */
+typedef struct _HostInstanceRange
+{
+	uint8_t *start;
+	size_t length;
+} HostInstanceRange_t;
+
+/* Search context of dl_iterate_phdr() */
+typedef struct _HostInstanceLookup
+{
+	ElfW(Addr) base;
+	bool found;
+} HostInstanceLookup_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static void *objectHandle;
+static HostInstanceRange_t ranges[HOST_INSTANCE_MAX_RANGES];
+static uint8_t rangeCount;
+static size_t imageSize;
+
+/* Saved data segments, imageSize bytes per instance */
+static uint8_t *images;
+static uint32_t imageCount;
+static uint32_t currentInstance = HOST_INSTANCE_NONE;
+static uint64_t switchCount;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static int findSegments(struct dl_phdr_info *info, size_t size, void *data);
+static void saveImage(uint8_t *image);
+static void restoreImage(const uint8_t *image);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**************************************************************************//**
+\brief dl_iterate_phdr() callback collecting the writable segments of the
+       object loaded at the searched base address
+******************************************************************************/
+static int findSegments(struct dl_phdr_info *info, size_t size, void *data)
+{
+	HostInstanceLookup_t *lookup = (HostInstanceLookup_t *)data;
+	ElfW(Addr) relroStart = 0;
+	ElfW(Addr) relroEnd = 0;
+
+	(void)size;
+	if (info->dlpi_addr != lookup->base)
+	{
+		return 0;
+	}
+
+	for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++)
+	{
+		if (PT_GNU_RELRO == info->dlpi_phdr[i].p_type)
+		{
+			relroStart = info->dlpi_phdr[i].p_vaddr;
+			relroEnd = relroStart + info->dlpi_phdr[i].p_memsz;
+		}
+	}
+
+	for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++)
+	{
+		const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+		ElfW(Addr) start = phdr->p_vaddr;
+		ElfW(Addr) end = phdr->p_vaddr + phdr->p_memsz;
+
+		if ((PT_LOAD != phdr->p_type) || !(phdr->p_flags & PF_W) ||
+			(HOST_INSTANCE_MAX_RANGES == rangeCount))
+		{
+			continue;
+		}
+		/* The RELRO part is read-only once the object is relocated */
+		if ((relroStart <= start) && (start < relroEnd))
+		{
+			start = relroEnd;
+		}
+		if (start >= end)
+		{
+			continue;
+		}
+		ranges[rangeCount].start = (uint8_t *)(info->dlpi_addr + start);
+		ranges[rangeCount].length = end - start;
+		imageSize += ranges[rangeCount].length;
+		rangeCount++;
+	}
+
+	lookup->found = true;
+	return 1;
+}
+
+static void saveImage(uint8_t *image)
+{
+	for (uint8_t i = 0; i < rangeCount; i++)
+	{
+		memcpy(image, ranges[i].start, ranges[i].length);
+		image += ranges[i].length;
+	}
+}
+
+static void restoreImage(const uint8_t *image)
+{
+	for (uint8_t i = 0; i < rangeCount; i++)
+	{
+		memcpy(ranges[i].start, image, ranges[i].length);
+		image += ranges[i].length;
+	}
+}
+
+/******************************************************************************
+                     Interface section
+******************************************************************************/
+/**************************************************************************//**
+\brief Loads the shared object and creates the instances
+******************************************************************************/
+bool HostInstance_Load(const char *path, uint32_t count)
+{
+	struct link_map *map;
+	HostInstanceLookup_t lookup;
+
+	HostInstance_Unload();
+
+	/* Every reference has to be bound now, lazy binding would write into
+	   the data segment behind the back of the instances */
+	objectHandle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	if (NULL == objectHandle)
+	{
+		printf("%s\n", dlerror());
+		return false;
+	}
+	if (0 != dlinfo(objectHandle, RTLD_DI_LINKMAP, &map))
+	{
+		HostInstance_Unload();
+		return false;
+	}
+
+	lookup.base = map->l_addr;
+	lookup.found = false;
+	dl_iterate_phdr(findSegments, &lookup);
+	if (!lookup.found || (0 == imageSize))
+	{
+		HostInstance_Unload();
+		return false;
+	}
+
+	images = malloc(imageSize * (size_t)count);
+	if (NULL == images)
+	{
+		HostInstance_Unload();
+		return false;
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		saveImage(&images[imageSize * i]);
+	}
+	imageCount = count;
+	currentInstance = HOST_INSTANCE_NONE;
+	switchCount = 0;
+	return true;
+}
+
+/**************************************************************************//**
+\brief Releases the instances and unloads the shared object
+******************************************************************************/
+void HostInstance_Unload(void)
+{
+	if (objectHandle)
+	{
+		dlclose(objectHandle);
+		objectHandle = NULL;
+	}
+	free(images);
+	images = NULL;
+	imageCount = 0;
+	imageSize = 0;
+	rangeCount = 0;
+	currentInstance = HOST_INSTANCE_NONE;
+}
+
+/**************************************************************************//**
+\brief Looks up an entry point of the shared object
+******************************************************************************/
+void *HostInstance_Symbol(const char *name)
+{
+	return objectHandle ? dlsym(objectHandle, name) : NULL;
+}
+
+/**************************************************************************//**
+\brief Makes an instance the one the shared object operates on
+******************************************************************************/
+void HostInstance_Select(uint32_t index)
+{
+	if ((index == currentInstance) || (index >= imageCount))
+	{
+		return;
+	}
+	if (HOST_INSTANCE_NONE != currentInstance)
+	{
+		saveImage(&images[imageSize * currentInstance]);
+	}
+	restoreImage(&images[imageSize * index]);
+	currentInstance = index;
+	switchCount++;
+}
+
+/**************************************************************************//**
+\brief Returns the selected instance
+******************************************************************************/
+uint32_t HostInstance_Current(void)
+{
+	return currentInstance;
+}
+
+/**************************************************************************//**
+\brief Returns the size of the state of one instance
+******************************************************************************/
+size_t HostInstance_ImageSize(void)
+{
+	return imageSize;
+}
+
+/**************************************************************************//**
+\brief Returns the number of instance switches performed so far
+******************************************************************************/
+uint64_t HostInstance_Switches(void)
+{
+	return switchCount;
+}
+
+/* eof host_instance.c */
@@ -0,0 +1,108 @@
+/**
+* \file  host_instance.h
+*
+* \brief Multiple instances of the stack image in one process
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_INSTANCE_H
+#define HOST_INSTANCE_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Value of HostInstance_Current() before any instance was selected */
+#define HOST_INSTANCE_NONE              (UINT32_MAX)
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Loads the shared object holding the stack, the host hardware and the
+       device application. The stack keeps its whole state in static
+       variables; instances are obtained by giving each one its own copy of
+       the writable data segment of the object and swapping the copies in
+       and out as the instances get scheduled.
+\param[in] path Path of the shared object
+\param[in] count Number of instances, each one starts from the initial
+           content of the data segment
+\return true if the object could be loaded
+******************************************************************************/
+bool HostInstance_Load(const char *path, uint32_t count);
+
+/**************************************************************************//**
+\brief Releases the instances and unloads the shared object
+******************************************************************************/
+void HostInstance_Unload(void);
+
+/**************************************************************************//**
+\brief Looks up an entry point of the shared object
+\param[in] name Symbol name
+\return Address of the symbol or NULL
+******************************************************************************/
+void *HostInstance_Symbol(const char *name);
+
+/**************************************************************************//**
+\brief Makes an instance the one the shared object operates on
+\param[in] index Instance index
+******************************************************************************/
+void HostInstance_Select(uint32_t index);
+
+/**************************************************************************//**
+\brief Returns the selected instance
+\return Instance index or HOST_INSTANCE_NONE
+******************************************************************************/
+uint32_t HostInstance_Current(void);
+
+/**************************************************************************//**
+\brief Returns the size of the state of one instance
+\return Size of the writable data segment in bytes
+******************************************************************************/
+size_t HostInstance_ImageSize(void);
+
+/**************************************************************************//**
+\brief Returns the number of instance switches performed so far
+\return Number of switches
+******************************************************************************/
+uint64_t HostInstance_Switches(void);
+
+#endif /* HOST_INSTANCE_H */
+
+/* eof host_instance.h */
@@ -0,0 +1,568 @@
+/**
+* \file  host_main.c
+*
+* \brief Host demo application running the stack against the simulated transceiver
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "conf_app.h"
+#include "host_clock.h"
+#include "host_nvm.h"
+#include "host_aes.h"
+#include "aes_engine.h"
+#include "host_radio.h"
+#include "sx1276_model.h"
+#include "host_network.h"
+#include "host_device.h"
+#include "system_task_manager.h"
+#include "system_trace.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define HOST_DEFAULT_CYCLES             (100)
+#define HOST_DEFAULT_PAYLOAD_LENGTH     (12)
+#define HOST_DEFAULT_NET_ID             (0x000013)
+#define HOST_DOWNLINK_RSSI_DBM          (-80)
+#define HOST_DOWNLINK_SNR_DB            (8)
+
+/* A join attempt is repeated at most this many times */
+#define HOST_MAX_JOIN_ATTEMPTS          (8)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+typedef struct _HostOptions
+{
+	uint32_t cycles;
+	uint32_t seed;
+	uint32_t intervalMs;
+	uint32_t timerSlackMs;
+	uint32_t queueLifetimeMs;
+	uint16_t downlinkPeriod;
+	uint8_t payloadLength;
+	uint8_t fCntReservation;
+	IsmBand_t band;
+	const char *nvmFile;
+	const char *traceFile;
+	bool confirmed;
+	bool abp;
+	bool dutyCycle;
+	bool restore;
+	bool queued;
+	bool aggregate;
+	bool energy;
+	bool quiet;
+	bool taskStats;
+} HostOptions_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostOptions_t options = {
+	.cycles = HOST_DEFAULT_CYCLES,
+	.seed = 1,
+	.intervalMs = 0,
+	.timerSlackMs = 0,
+	.queueLifetimeMs = 0,
+	.downlinkPeriod = 4,
+	.payloadLength = HOST_DEFAULT_PAYLOAD_LENGTH,
+	.fCntReservation = 0,
+	.band = ISM_EU868,
+	.nvmFile = NULL,
+	.traceFile = NULL,
+	.confirmed = false,
+	.abp = false,
+	.dutyCycle = false,
+	.restore = false,
+	.queued = false,
+	.aggregate = false,
+	.energy = false,
+	.quiet = false,
+	.taskStats = false
+};
+
+static const struct
+{
+	const char *name;
+	IsmBand_t band;
+} bandNames[] = {
+	{"eu868", ISM_EU868},
+	{"na915", ISM_NA915},
+	{"au915", ISM_AU915},
+	{"as923", ISM_THAI923},
+	{"kr920", ISM_KR920},
+	{"jp923", ISM_JPN923},
+	{"in865", ISM_IND865}
+};
+
+#if (SYSTEM_TASK_STATS == 1)
+/* Names of the scheduler slots of the stack, in the order of priority */
+static const char *const taskNames[SYSTEM_FIXED_TASK_COUNT] = {
+	"timer",
+	"radio tx done",
+	"radio rx done",
+	"radio tx",
+	"radio rx",
+	"radio scan",
+	"lorawan join",
+	"lorawan tx",
+	"lorawan rx",
+	"pds",
+	"app"
+};
+#endif
+
+#if (SYSTEM_TRACE_ENABLE == 1)
+/* Stands for the serial port the trace is dumped to */
+static FILE *traceFile = NULL;
+#endif
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static void provision(HostDeviceConfig_t *device);
+static void report(double wallSeconds);
+#if (SYSTEM_TASK_STATS == 1)
+static void reportTasks(void);
+#endif
+#if (SYSTEM_TRACE_ENABLE == 1)
+static uint8_t writeTrace(uint8_t *data, uint8_t length);
+#endif
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -n <cycles>    number of uplinks to send (default %u)\n"
+		"  -b <band>      eu868, na915, au915, as923, kr920, jp923, in865\n"
+		"  -i <ms>        interval between uplinks in ms (default 0)\n"
+		"  -S <ms>        slack of the uplink interval timer in ms (default 0)\n"
+		"  -l <bytes>     uplink payload length (default %u)\n"
+		"  -D <n>         network sends a downlink every n-th uplink, 0 for none\n"
+		"  -c             confirmed uplinks\n"
+		"  -a             activation by personalization\n"
+		"  -d             keep the regional duty cycle enforced\n"
+		"  -Q <ms>        queue the uplinks in the stack, dropped after <ms>, 0 never\n"
+		"  -g             aggregate the uplinks of -l bytes as records of larger frames\n"
+		"  -e             print the airtime and energy counters of the stack\n"
+		"  -f <file>      file backing the emulated NVM\n"
+		"  -r             keep the session in the NVM file, resume it if stored\n"
+		"  -F <n>         reserve 2^n uplink frame counters per NVM update (default 0)\n"
+		"  -s <seed>      seed of the stack random generator\n"
+		"  -q             quiet, only print the summary\n"
+		"  -t             print the scheduler counters of every task\n"
+		"  -T <file>      dump the event trace of the stack to <file>\n",
+		name, HOST_DEFAULT_CYCLES, HOST_DEFAULT_PAYLOAD_LENGTH);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "n:b:i:S:l:D:cadQ:gef:rF:s:qtT:h")))
+	{
+		switch (opt)
+		{
+			case 'n':
+				options.cycles = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+			{
+				bool found = false;
+
+				for (size_t i = 0; i < sizeof(bandNames) / sizeof(bandNames[0]); i++)
+				{
+					if (0 == strcmp(optarg, bandNames[i].name))
+					{
+						options.band = bandNames[i].band;
+						found = true;
+					}
+				}
+				if (!found)
+				{
+					usage(argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			}
+			case 'i':
+				options.intervalMs = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'S':
+				options.timerSlackMs = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'l':
+				options.payloadLength = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'D':
+				options.downlinkPeriod = (uint16_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				options.confirmed = true;
+				break;
+			case 'a':
+				options.abp = true;
+				break;
+			case 'd':
+				options.dutyCycle = true;
+				break;
+			case 'Q':
+				options.queued = true;
+				options.queueLifetimeMs = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'g':
+				options.aggregate = true;
+				break;
+			case 'e':
+				options.energy = true;
+				break;
+			case 'f':
+				options.nvmFile = optarg;
+				break;
+			case 'r':
+				options.restore = true;
+				break;
+			case 'F':
+				options.fCntReservation = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				options.seed = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'q':
+				options.quiet = true;
+				break;
+			case 't':
+#if (SYSTEM_TASK_STATS == 1)
+				options.taskStats = true;
+				break;
+#else
+				printf("The stack is built without the task counters (MLS_TASK_STATS)\n");
+				exit(EXIT_FAILURE);
+#endif
+			case 'T':
+#if (SYSTEM_TRACE_ENABLE == 1)
+				options.traceFile = optarg;
+				break;
+#else
+				printf("The stack is built without the event trace (MLS_SYSTEM_TRACE)\n");
+				exit(EXIT_FAILURE);
+#endif
+			default:
+				usage(argv[0]);
+				exit(('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Hands the demo credentials of conf_app.h to the device and the network
+******************************************************************************/
+static void provision(HostDeviceConfig_t *device)
+{
+	uint8_t devEui[] = DEMO_DEVICE_EUI;
+	uint8_t joinEui[] = DEMO_JOIN_EUI;
+	uint8_t appKey[] = DEMO_APPLICATION_KEY;
+	uint8_t nwkSKey[] = DEMO_NETWORK_SESSION_KEY;
+	uint8_t appSKey[] = DEMO_APPLICATION_SESSION_KEY;
+
+	memcpy(device->devEui, devEui, sizeof(device->devEui));
+	memcpy(device->joinEui, joinEui, sizeof(device->joinEui));
+	memcpy(device->appKey, appKey, sizeof(device->appKey));
+	memcpy(device->nwkSKey, nwkSKey, sizeof(device->nwkSKey));
+	memcpy(device->appSKey, appSKey, sizeof(device->appSKey));
+	device->devAddr = DEMO_DEVICE_ADDRESS;
+
+	if (options.abp)
+	{
+		HostNetwork_AddAbpDevice(device->devAddr, nwkSKey, appSKey);
+	}
+	else
+	{
+		HostNetwork_AddOtaaDevice(devEui, joinEui, appKey);
+	}
+}
+
+/**************************************************************************//**
+\brief Prints the airtime and energy counters of the stack, the airtime by
+       channel and sub-band only for those used
+******************************************************************************/
+static void reportEnergy(void)
+{
+	EnergyStats_t energy;
+
+	HostDevice_GetEnergy(&energy);
+	printf("energy           : %.3f s tx, %.3f s rx, %.3f s standby, %.3f s asleep, %.3f s tcxo, %.3f uAh\n",
+		energy.txTime / 1e6, energy.rxTime / 1e6, energy.standbyTime / 1e6, energy.sleepTime / 1e6,
+		energy.tcxoTime / 1e6, energy.charge / 1e3);
+	printf("frames sent      : %u, %u retransmissions\n", (unsigned int)energy.txFrames,
+		(unsigned int)energy.retransmissions);
+	printf("airtime by port  :");
+	for (uint8_t i = 0; i < LORAWAN_ENERGY_PORTS; i++)
+	{
+		if (energy.ports[i].frames)
+		{
+			printf(" %u: %.3f s in %u frames,", energy.ports[i].port, energy.ports[i].txTime / 1e3,
+				(unsigned int)energy.ports[i].frames);
+		}
+	}
+	printf(" other: %.3f s\n", energy.otherPortsTxTime / 1e3);
+	printf("airtime by chan. :");
+	for (uint8_t i = 0; i < LORAWAN_ENERGY_CHANNELS; i++)
+	{
+		if (energy.channelTxTime[i])
+		{
+			printf(" %u: %.3f s", i, energy.channelTxTime[i] / 1e3);
+		}
+	}
+	printf("\nairtime by band  :");
+	for (uint8_t i = 0; i < LORAWAN_ENERGY_SUB_BANDS; i++)
+	{
+		if (energy.subBandTxTime[i])
+		{
+			printf(" %u: %.3f s", i, energy.subBandTxTime[i] / 1e3);
+		}
+	}
+	printf("\n");
+}
+
+static void report(double wallSeconds)
+{
+	HostDeviceStats_t counters;
+	SX1276ModelStats_t radio;
+	HostNvmStats_t nvm;
+	HostRadioStats_t dma;
+	HostNetworkStats_t network;
+	double virtualSeconds = HostClock_Now() / 1e6;
+	uint32_t cycles;
+
+	HostDevice_GetStats(&counters, &radio);
+	HostNvm_GetStats(&nvm);
+	HostRadio_GetStats(&dma);
+	cycles = counters.uplinks + counters.uplinkFailures;
+	HostNetwork_GetStats(&network);
+
+	printf("joins            : %u/%u\n", (unsigned int)counters.joins, (unsigned int)counters.joinAttempts);
+	printf("uplinks          : %u ok, %u failed\n", (unsigned int)counters.uplinks,
+		(unsigned int)counters.uplinkFailures);
+	printf("downlinks        : %u received, %u sent by the network\n", (unsigned int)counters.downlinks,
+		(unsigned int)network.downlinks);
+	printf("uplink counter   : %u at start, %u at end\n", (unsigned int)counters.fCntUpStart,
+		(unsigned int)counters.fCntUp);
+	printf("network          : %u uplinks, %u MIC errors\n", (unsigned int)network.uplinks,
+		(unsigned int)network.micErrors);
+	printf("radio            : %u tx, %u rx, %u timeouts, %.3f s on air\n", (unsigned int)radio.txFrames,
+		(unsigned int)radio.rxFrames, (unsigned int)radio.rxTimeouts, radio.txTimeUs / 1e6);
+	printf("spi              : %u transactions, %u bytes\n", (unsigned int)radio.spiTransactions,
+		(unsigned int)radio.spiBytes);
+	printf("spi dma          : %u transfers, %u bytes, %u waits\n", (unsigned int)dma.dmaTransfers,
+		(unsigned int)dma.dmaBytes, (unsigned int)dma.dmaWaits);
+#ifndef AES_SW_ENGINE
+	printf("aes              : %u blocks, %u key loads\n", (unsigned int)HostAes_GetBlockCount(),
+		(unsigned int)HostAes_GetKeyLoadCount());
+#else
+	/* The software engine of the stack does not count its blocks */
+	printf("aes              : software engine (%s)\n", (AES_SW_COMPACT == AES_SW_ENGINE) ? "compact" : "ttable");
+#endif
+	printf("nvm              : %u row erases (max %u per row), %u page writes, %u bytes read\n",
+		(unsigned int)nvm.rowErases, (unsigned int)nvm.maxRowErases, (unsigned int)nvm.pageWrites,
+		(unsigned int)nvm.bytesRead);
+	printf("duty cycle waits : %u\n", (unsigned int)counters.dutyCycleWaits);
+	if (options.queued)
+	{
+		printf("expired uplinks  : %u\n", (unsigned int)counters.expiredUplinks);
+	}
+	if (options.aggregate)
+	{
+		printf("aggregation      : %u readings sent, %.3f s on air, %.3f s in frames of their own\n",
+			(unsigned int)counters.aggregatedReadings, counters.aggregatedAirtimeUs / 1e6,
+			counters.separateAirtimeUs / 1e6);
+	}
+	if (options.energy)
+	{
+		reportEnergy();
+	}
+	printf("sleeps           : %u\n", (unsigned int)counters.sleeps);
+	printf("timers           : %u expired, %u coalesced (timer interrupts avoided)\n",
+		(unsigned int)counters.expiredTimers, (unsigned int)counters.coalescedTimers);
+	printf("virtual time     : %.3f s\n", virtualSeconds);
+	printf("wall time        : %.6f s\n", wallSeconds);
+	if (wallSeconds > 0)
+	{
+		printf("cycles/s         : %.1f\n", cycles / wallSeconds);
+	}
+}
+
+/**************************************************************************//**
+\brief Prints the run-to-completion counters of the scheduler, times are in
+       virtual microseconds so the latency shows how long a posted task
+       waited behind higher priority tasks and emulated interrupts
+******************************************************************************/
+#if (SYSTEM_TASK_STATS == 1)
+static void reportTasks(void)
+{
+	printf("%-16s %10s %12s %10s %12s %10s\n", "task", "runs", "exec us", "max", "latency us", "max");
+	for (uint8_t taskIdx = 0; taskIdx < SYSTEM_FIXED_TASK_COUNT; taskIdx++)
+	{
+		SYSTEM_TaskStats_t stats;
+
+		SYSTEM_GetTaskStats(taskIdx, &stats);
+		printf("%-16s %10u %12u %10u %12u %10u\n", taskNames[taskIdx], (unsigned int)stats.runCount,
+			(unsigned int)stats.totalTimeUs, (unsigned int)stats.maxTimeUs,
+			(unsigned int)stats.totalLatencyUs, (unsigned int)stats.maxLatencyUs);
+	}
+}
+#endif
+
+#if (SYSTEM_TRACE_ENABLE == 1)
+/**************************************************************************//**
+rief Writer of the trace dump, in place of sio2host_tx on a board
+******************************************************************************/
+static uint8_t writeTrace(uint8_t *data, uint8_t length)
+{
+	return (uint8_t)fwrite(data, 1, length, traceFile);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+	HostNetworkConfig_t networkConfig = {
+		.band = ISM_EU868,
+		.netId = HOST_DEFAULT_NET_ID,
+		.downlinkPeriod = 0,
+		.rssi = HOST_DOWNLINK_RSSI_DBM,
+		.snr = HOST_DOWNLINK_SNR_DB
+	};
+	HostDeviceConfig_t device = {
+		.label = NULL,
+		.maxJoinAttempts = HOST_MAX_JOIN_ATTEMPTS,
+		.dataRate = HOST_DEVICE_DEFAULT_DATARATE,
+		.joinBackoff = false
+	};
+	HostDeviceStats_t stats;
+	struct timespec start;
+	struct timespec end;
+
+	parseOptions(argc, argv);
+	networkConfig.downlinkPeriod = options.downlinkPeriod;
+	networkConfig.band = options.band;
+	HostNetwork_Init(&networkConfig);
+
+	device.band = options.band;
+	device.air = HostNetwork_GetAir();
+	device.seed = options.seed;
+	device.cycles = options.cycles;
+	device.intervalMs = options.intervalMs;
+	device.timerSlackMs = options.timerSlackMs;
+	device.payloadLength = options.payloadLength;
+	device.abp = options.abp;
+	device.confirmed = options.confirmed;
+	device.dutyCycle = options.dutyCycle;
+	device.queued = options.queued;
+	device.queueLifetimeMs = options.queueLifetimeMs;
+	device.aggregate = options.aggregate;
+	device.fCntReservation = options.fCntReservation;
+	device.restore = options.restore;
+	device.verbose = !options.quiet;
+	provision(&device);
+
+	HostNvm_Format();
+	if (options.nvmFile && !HostNvm_Attach(options.nvmFile))
+	{
+		printf("Cannot open %s\n", options.nvmFile);
+		return EXIT_FAILURE;
+	}
+	if (!HostDevice_Start(&device))
+	{
+		printf("Initialization of the stack failed\n");
+		return EXIT_FAILURE;
+	}
+
+#if (SYSTEM_TRACE_ENABLE == 1)
+	if (options.traceFile)
+	{
+		traceFile = fopen(options.traceFile, "wb");
+		if (NULL == traceFile)
+		{
+			printf("Cannot open %s\n", options.traceFile);
+			return EXIT_FAILURE;
+		}
+	}
+#endif
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+#if (SYSTEM_TRACE_ENABLE == 1)
+	/* The device is stopped at each event so the ring is drained before
+	   it wraps, as a host polling the serial port would */
+	while (traceFile && HostDevice_Run(HostDevice_NextEvent()))
+	{
+		SYSTEM_TraceDump(writeTrace);
+	}
+#endif
+	while (HostDevice_Run(HOST_CLOCK_NEVER))
+	{
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+#if (SYSTEM_TRACE_ENABLE == 1)
+	if (traceFile)
+	{
+		SYSTEM_TraceDump(writeTrace);
+		fclose(traceFile);
+	}
+#endif
+
+	report((end.tv_sec - start.tv_sec) + ((end.tv_nsec - start.tv_nsec) / 1e9));
+#if (SYSTEM_TASK_STATS == 1)
+	if (options.taskStats)
+	{
+		reportTasks();
+	}
+#endif
+	HostDevice_GetStats(&stats, NULL);
+	return (stats.uplinks == options.cycles) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof host_main.c */
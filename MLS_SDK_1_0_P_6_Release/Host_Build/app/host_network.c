@@ -0,0 +1,783 @@
+/**
+* \file  host_network.c
+*
+* \brief Minimal LoRaWAN network server emulation for the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <string.h>
+#include "host_clock.h"
+#include "host_aes.h"
+#include "host_network.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define BLOCK_SIZE                  (16)
+#define MIC_SIZE                    (4)
+
+/* Message types, MHDR[7:5] */
+#define MTYPE_JOIN_REQUEST          (0)
+#define MTYPE_JOIN_ACCEPT           (1)
+#define MTYPE_UNCONFIRMED_UP        (2)
+#define MTYPE_UNCONFIRMED_DOWN      (3)
+#define MTYPE_CONFIRMED_UP          (4)
+#define MTYPE_CONFIRMED_DOWN        (5)
+
+#define JOIN_REQUEST_SIZE           (23)
+#define FHDR_MIN_SIZE               (7)
+
+/* FCtrl bits */
+#define FCTRL_ACK                   (0x20)
+#define FCTRL_FOPTS_LEN_MASK        (0x0F)
+
+/* Direction in the B0 and Ai blocks */
+#define DIR_UPLINK                  (0)
+#define DIR_DOWNLINK                (1)
+
+/* Downlink radio settings */
+#define DOWNLINK_PREAMBLE           (8)
+#define DOWNLINK_CODING_RATE        (1)
+#define DOWNLINK_POWER              (14)
+
+/* Bandwidth codes (RegModemConfig1) */
+#define BW_125                      (7)
+#define BW_500                      (9)
+
+/* US902-928 and AU915-928 channel plans */
+#define NA_UPLINK_125_BASE_HZ       (902300000u)
+#define AU_UPLINK_125_BASE_HZ       (915200000u)
+#define UPLINK_125_STEP_HZ          (200000u)
+#define UPLINK_500_OFFSET_HZ        (700000u)
+#define UPLINK_500_STEP_HZ          (1600000u)
+#define DOWNLINK_BASE_HZ            (923300000u)
+#define DOWNLINK_STEP_HZ            (600000u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Device record of the network server */
+typedef struct _HostNetworkDevice
+{
+	bool inUse;
+	bool otaa;
+	bool activated;
+	uint8_t devEui[8];
+	uint8_t joinEui[8];
+	uint8_t appKey[BLOCK_SIZE];
+	uint8_t nwkSKey[BLOCK_SIZE];
+	uint8_t appSKey[BLOCK_SIZE];
+	uint32_t devAddr;
+	uint32_t joinNonce;
+	uint32_t fCntUp;
+	uint32_t fCntDown;
+	uint32_t uplinks;
+} HostNetworkDevice_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostNetworkConfig_t networkConfig;
+static HostNetworkDevice_t devices[HOST_NETWORK_MAX_DEVICES];
+static HostNetworkStats_t networkStats;
+static uint32_t nextDevAddr;
+
+/* Downlinks queued on the point to point air */
+static SX1276Frame_t downlinks[HOST_NETWORK_MAX_DOWNLINKS];
+static bool downlinkPending[HOST_NETWORK_MAX_DOWNLINKS];
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void doubleBlock(uint8_t *block);
+static void aesCmac(const uint8_t *key, const uint8_t *data, uint16_t length, uint8_t *mac);
+static uint32_t computeMic(const uint8_t *key, const uint8_t *data, uint16_t length);
+static uint32_t computeDataMic(const uint8_t *key, uint8_t dir, uint32_t devAddr, uint32_t fCnt,
+	const uint8_t *frame, uint8_t length);
+static void cryptPayload(const uint8_t *key, uint8_t dir, uint32_t devAddr, uint32_t fCnt,
+	uint8_t *payload, uint8_t length);
+static uint32_t readLe32(const uint8_t *p);
+static void writeLe32(uint8_t *p, uint32_t value);
+static HostNetworkDevice_t *allocateDevice(void);
+static HostNetworkDevice_t *findByEui(const uint8_t *devEui, const uint8_t *joinEui);
+static HostNetworkDevice_t *findByAddress(uint32_t devAddr);
+static void setDownlinkRadio(const SX1276Frame_t *uplink, SX1276Frame_t *downlink);
+static bool handleJoinRequest(const SX1276Frame_t *uplink, SX1276Frame_t *downlink);
+static bool handleDataUplink(const SX1276Frame_t *uplink, SX1276Frame_t *downlink);
+static void airTransmit(void *ctx, const SX1276Frame_t *frame);
+static bool airLookup(void *ctx, const SX1276RxWindow_t *window, SX1276Frame_t *frame);
+static SX1276RxOutcome_t airDeliver(void *ctx, const SX1276Frame_t *frame);
+static int16_t airChannelRssi(void *ctx, uint32_t frequency);
+
+static const SX1276Air_t pointToPointAir = {
+	.transmit = airTransmit,
+	.lookup = airLookup,
+	.deliver = airDeliver,
+	.channelRssi = airChannelRssi,
+	.ctx = NULL
+};
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static uint32_t readLe32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void writeLe32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+/**************************************************************************//**
+\brief Multiplication by x in GF(2^128) as used for the CMAC subkeys
+******************************************************************************/
+static void doubleBlock(uint8_t *block)
+{
+	uint8_t carry = block[0] & 0x80;
+
+	for (uint8_t i = 0; i < BLOCK_SIZE - 1; i++)
+	{
+		block[i] = (uint8_t)((block[i] << 1) | (block[i + 1] >> 7));
+	}
+	block[BLOCK_SIZE - 1] = (uint8_t)((block[BLOCK_SIZE - 1] << 1) ^ (carry ? 0x87 : 0x00));
+}
+
+/**************************************************************************//**
+\brief AES-CMAC (RFC 4493)
+******************************************************************************/
+static void aesCmac(const uint8_t *key, const uint8_t *data, uint16_t length, uint8_t *mac)
+{
+	uint8_t subKey[BLOCK_SIZE] = {0};
+	uint8_t last[BLOCK_SIZE];
+	uint16_t blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	bool complete = (0 != length) && (0 == (length % BLOCK_SIZE));
+
+	if (0 == blocks)
+	{
+		blocks = 1;
+	}
+
+	/* K1 = L.x, K2 = L.x^2 with L = AES(key, 0) */
+	HostAes_Encrypt(subKey, key);
+	doubleBlock(subKey);
+	if (!complete)
+	{
+		doubleBlock(subKey);
+	}
+
+	memset(last, 0, sizeof(last));
+	if (complete)
+	{
+		memcpy(last, &data[(blocks - 1) * BLOCK_SIZE], BLOCK_SIZE);
+	}
+	else
+	{
+		uint16_t rest = length - ((blocks - 1) * BLOCK_SIZE);
+		memcpy(last, &data[(blocks - 1) * BLOCK_SIZE], rest);
+		last[rest] = 0x80;
+	}
+	for (uint8_t i = 0; i < BLOCK_SIZE; i++)
+	{
+		last[i] ^= subKey[i];
+	}
+
+	memset(mac, 0, BLOCK_SIZE);
+	for (uint16_t block = 0; block < blocks - 1; block++)
+	{
+		for (uint8_t i = 0; i < BLOCK_SIZE; i++)
+		{
+			mac[i] ^= data[(block * BLOCK_SIZE) + i];
+		}
+		HostAes_Encrypt(mac, key);
+	}
+	for (uint8_t i = 0; i < BLOCK_SIZE; i++)
+	{
+		mac[i] ^= last[i];
+	}
+	HostAes_Encrypt(mac, key);
+}
+
+static uint32_t computeMic(const uint8_t *key, const uint8_t *data, uint16_t length)
+{
+	uint8_t mac[BLOCK_SIZE];
+
+	aesCmac(key, data, length, mac);
+	return readLe32(mac);
+}
+
+/**************************************************************************//**
+\brief Computes the MIC of a data frame, B0 | MHDR ... FRMPayload
+******************************************************************************/
+static uint32_t computeDataMic(const uint8_t *key, uint8_t dir, uint32_t devAddr, uint32_t fCnt,
+	const uint8_t *frame, uint8_t length)
+{
+	uint8_t buffer[BLOCK_SIZE + SX1276_MODEL_MAX_PAYLOAD];
+
+	memset(buffer, 0, BLOCK_SIZE);
+	buffer[0] = 0x49;
+	buffer[5] = dir;
+	writeLe32(&buffer[6], devAddr);
+	writeLe32(&buffer[10], fCnt);
+	buffer[15] = length;
+	memcpy(&buffer[BLOCK_SIZE], frame, length);
+	return computeMic(key, buffer, (uint16_t)(BLOCK_SIZE + length));
+}
+
+/**************************************************************************//**
+\brief Encrypts or decrypts a FRMPayload in counter mode
+******************************************************************************/
+static void cryptPayload(const uint8_t *key, uint8_t dir, uint32_t devAddr, uint32_t fCnt,
+	uint8_t *payload, uint8_t length)
+{
+	uint8_t block[BLOCK_SIZE];
+
+	for (uint16_t offset = 0; offset < length; offset += BLOCK_SIZE)
+	{
+		memset(block, 0, sizeof(block));
+		block[0] = 0x01;
+		block[5] = dir;
+		writeLe32(&block[6], devAddr);
+		writeLe32(&block[10], fCnt);
+		block[15] = (uint8_t)((offset / BLOCK_SIZE) + 1);
+		HostAes_Encrypt(block, key);
+
+		for (uint8_t i = 0; (i < BLOCK_SIZE) && ((offset + i) < length); i++)
+		{
+			payload[offset + i] ^= block[i];
+		}
+	}
+}
+
+static HostNetworkDevice_t *allocateDevice(void)
+{
+	for (uint32_t i = 0; i < HOST_NETWORK_MAX_DEVICES; i++)
+	{
+		if (!devices[i].inUse)
+		{
+			memset(&devices[i], 0, sizeof(devices[i]));
+			devices[i].inUse = true;
+			return &devices[i];
+		}
+	}
+	return NULL;
+}
+
+static HostNetworkDevice_t *findByEui(const uint8_t *devEui, const uint8_t *joinEui)
+{
+	for (uint32_t i = 0; i < HOST_NETWORK_MAX_DEVICES; i++)
+	{
+		if (devices[i].inUse && devices[i].otaa &&
+			(0 == memcmp(devices[i].devEui, devEui, sizeof(devices[i].devEui))) &&
+			(0 == memcmp(devices[i].joinEui, joinEui, sizeof(devices[i].joinEui))))
+		{
+			return &devices[i];
+		}
+	}
+	return NULL;
+}
+
+static HostNetworkDevice_t *findByAddress(uint32_t devAddr)
+{
+	for (uint32_t i = 0; i < HOST_NETWORK_MAX_DEVICES; i++)
+	{
+		if (devices[i].inUse && devices[i].activated && (devices[i].devAddr == devAddr))
+		{
+			return &devices[i];
+		}
+	}
+	return NULL;
+}
+
+/**************************************************************************//**
+\brief Selects the RX1 channel and data rate. US902-928 and AU915-928 have a
+       dedicated downlink channel plan, every other region answers on the
+       uplink channel with the uplink data rate.
+******************************************************************************/
+static void setDownlinkRadio(const SX1276Frame_t *uplink, SX1276Frame_t *downlink)
+{
+	uint32_t frequency = uplink->frequency;
+	uint8_t sf = uplink->sf;
+	uint8_t bw = uplink->bw;
+
+	if ((ISM_NA915 == networkConfig.band) || (ISM_AU915 == networkConfig.band))
+	{
+		bool au = ISM_AU915 == networkConfig.band;
+		uint32_t base = au ? AU_UPLINK_125_BASE_HZ : NA_UPLINK_125_BASE_HZ;
+		uint8_t channel;
+		uint8_t upDr;
+		uint8_t downDr;
+
+		/* Channels are rounded, the synthesizer step makes the carrier deviate slightly from the grid */
+		if (BW_500 == bw)
+		{
+			/* 500kHz channels are spaced by 1.6MHz, 700kHz above the first 125kHz one */
+			channel = (uint8_t)(64 + ((frequency - base - UPLINK_500_OFFSET_HZ + (UPLINK_500_STEP_HZ / 2)) /
+				UPLINK_500_STEP_HZ));
+			upDr = au ? 6 : 4;
+		}
+		else
+		{
+			channel = (uint8_t)((frequency - base + (UPLINK_125_STEP_HZ / 2)) / UPLINK_125_STEP_HZ);
+			upDr = (uint8_t)(au ? (12 - sf) : (10 - sf));
+		}
+		/* RX1 data rate with an offset of 0, DR8 (SF12) to DR13 (SF7) */
+		downDr = (uint8_t)(upDr + (au ? 8 : 10));
+		if (downDr > 13)
+		{
+			downDr = 13;
+		}
+		frequency = DOWNLINK_BASE_HZ + ((channel % 8) * DOWNLINK_STEP_HZ);
+		sf = (uint8_t)(20 - downDr);
+		bw = BW_500;
+	}
+
+	downlink->frequency = frequency;
+	downlink->lora = true;
+	downlink->sf = sf;
+	downlink->bw = bw;
+	downlink->cr = DOWNLINK_CODING_RATE;
+	downlink->preambleLen = DOWNLINK_PREAMBLE;
+	downlink->iqInverted = true;
+	downlink->crcOn = false;
+	downlink->power = DOWNLINK_POWER;
+	downlink->rssi = networkConfig.rssi;
+	downlink->snr = networkConfig.snr;
+}
+
+/**************************************************************************//**
+\brief Answers a join-request with a join-accept in the first join window
+******************************************************************************/
+static bool handleJoinRequest(const SX1276Frame_t *uplink, SX1276Frame_t *downlink)
+{
+	const uint8_t *frame = uplink->payload;
+	uint8_t joinEui[8];
+	uint8_t devEui[8];
+	uint8_t keyInput[BLOCK_SIZE];
+	HostNetworkDevice_t *device;
+	uint8_t *accept = downlink->payload;
+
+	networkStats.joinRequests++;
+	if (JOIN_REQUEST_SIZE != uplink->length)
+	{
+		return false;
+	}
+
+	/* The EUIs are sent least significant byte first */
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		joinEui[i] = frame[8 - i];
+		devEui[i] = frame[16 - i];
+	}
+	device = findByEui(devEui, joinEui);
+	if (NULL == device)
+	{
+		networkStats.unknownDevices++;
+		return false;
+	}
+	if (computeMic(device->appKey, frame, JOIN_REQUEST_SIZE - MIC_SIZE) !=
+		readLe32(&frame[JOIN_REQUEST_SIZE - MIC_SIZE]))
+	{
+		networkStats.micErrors++;
+		return false;
+	}
+
+	device->joinNonce++;
+	if (!device->activated)
+	{
+		device->devAddr = nextDevAddr++;
+	}
+	device->activated = true;
+	device->fCntUp = 0;
+	device->fCntDown = 0;
+	device->uplinks = 0;
+
+	/* MHDR | JoinNonce | NetID | DevAddr | DLSettings | RxDelay | MIC */
+	memset(downlink, 0, sizeof(*downlink));
+	accept[0] = MTYPE_JOIN_ACCEPT << 5;
+	accept[1] = (uint8_t)device->joinNonce;
+	accept[2] = (uint8_t)(device->joinNonce >> 8);
+	accept[3] = (uint8_t)(device->joinNonce >> 16);
+	accept[4] = (uint8_t)networkConfig.netId;
+	accept[5] = (uint8_t)(networkConfig.netId >> 8);
+	accept[6] = (uint8_t)(networkConfig.netId >> 16);
+	writeLe32(&accept[7], device->devAddr);
+	accept[11] = 0x00;
+	accept[12] = 0x01;
+	writeLe32(&accept[13], computeMic(device->appKey, accept, 13));
+	downlink->length = 17;
+
+	/* Session keys: aes128_encrypt(AppKey, 0x0N | JoinNonce | NetID | DevNonce | pad16) */
+	memset(keyInput, 0, sizeof(keyInput));
+	memcpy(&keyInput[1], &accept[1], 6);
+	memcpy(&keyInput[7], &frame[17], 2);
+	keyInput[0] = 0x01;
+	memcpy(device->nwkSKey, keyInput, BLOCK_SIZE);
+	HostAes_Encrypt(device->nwkSKey, device->appKey);
+	keyInput[0] = 0x02;
+	memcpy(device->appSKey, keyInput, BLOCK_SIZE);
+	HostAes_Encrypt(device->appSKey, device->appKey);
+
+	/* The device decrypts the join-accept with the AES encrypt operation */
+	HostAes_Decrypt(&accept[1], device->appKey);
+
+	setDownlinkRadio(uplink, downlink);
+	downlink->start = uplink->start + uplink->duration + HOST_NETWORK_JOIN_DELAY_US;
+	downlink->duration = SX1276Model_TimeOnAir(downlink);
+	networkStats.joinAccepts++;
+	return true;
+}
+
+/**************************************************************************//**
+\brief Checks a data uplink and answers it when an acknowledgment or a
+       periodic downlink is due
+******************************************************************************/
+static bool handleDataUplink(const SX1276Frame_t *uplink, SX1276Frame_t *downlink)
+{
+	const uint8_t *frame = uplink->payload;
+	uint8_t mType = frame[0] >> 5;
+	HostNetworkDevice_t *device;
+	uint32_t devAddr;
+	uint32_t fCnt;
+	uint8_t index;
+	bool sendData;
+	uint8_t *dl = downlink->payload;
+
+	if (uplink->length < (1 + FHDR_MIN_SIZE + MIC_SIZE))
+	{
+		return false;
+	}
+
+	devAddr = readLe32(&frame[1]);
+	device = findByAddress(devAddr);
+	if (NULL == device)
+	{
+		networkStats.unknownDevices++;
+		return false;
+	}
+
+	/* Recover the 32 bit counter from its 16 least significant bits */
+	fCnt = (device->fCntUp & 0xFFFF0000u) | frame[6] | ((uint32_t)frame[7] << 8);
+	if ((device->uplinks) && (fCnt < device->fCntUp))
+	{
+		fCnt += 0x10000u;
+	}
+	if (computeDataMic(device->nwkSKey, DIR_UPLINK, devAddr, fCnt, frame, (uint8_t)(uplink->length - MIC_SIZE)) !=
+		readLe32(&frame[uplink->length - MIC_SIZE]))
+	{
+		networkStats.micErrors++;
+		return false;
+	}
+	device->fCntUp = fCnt;
+	device->uplinks++;
+	networkStats.uplinks++;
+	if (MTYPE_CONFIRMED_UP == mType)
+	{
+		networkStats.confirmedUplinks++;
+	}
+
+	sendData = networkConfig.downlinkPeriod && (0 == (device->uplinks % networkConfig.downlinkPeriod));
+	if ((MTYPE_CONFIRMED_UP != mType) && !sendData)
+	{
+		return false;
+	}
+
+	/* MHDR | DevAddr | FCtrl | FCnt | [FPort | FRMPayload] | MIC */
+	memset(downlink, 0, sizeof(*downlink));
+	index = 0;
+	dl[index++] = MTYPE_UNCONFIRMED_DOWN << 5;
+	writeLe32(&dl[index], devAddr);
+	index += 4;
+	dl[index++] = (MTYPE_CONFIRMED_UP == mType) ? FCTRL_ACK : 0x00;
+	dl[index++] = (uint8_t)device->fCntDown;
+	dl[index++] = (uint8_t)(device->fCntDown >> 8);
+	if (sendData)
+	{
+		uint8_t fOptsLen = frame[5] & FCTRL_FOPTS_LEN_MASK;
+		uint8_t port = 1;
+
+		if (uplink->length > (1 + FHDR_MIN_SIZE + fOptsLen + MIC_SIZE))
+		{
+			port = frame[1 + FHDR_MIN_SIZE + fOptsLen];
+		}
+		dl[index++] = port;
+		/* The payload echoes the uplink counter */
+		writeLe32(&dl[index], fCnt);
+		cryptPayload(device->appSKey, DIR_DOWNLINK, devAddr, device->fCntDown, &dl[index], 4);
+		index += 4;
+	}
+	writeLe32(&dl[index], computeDataMic(device->nwkSKey, DIR_DOWNLINK, devAddr, device->fCntDown, dl, index));
+	index += MIC_SIZE;
+	downlink->length = index;
+	device->fCntDown++;
+
+	setDownlinkRadio(uplink, downlink);
+	downlink->start = uplink->start + uplink->duration + HOST_NETWORK_RX1_DELAY_US;
+	downlink->duration = SX1276Model_TimeOnAir(downlink);
+	networkStats.downlinks++;
+	return true;
+}
+
+/******************************************************************************
+                     Point to point air
+******************************************************************************/
+static void airTransmit(void *ctx, const SX1276Frame_t *frame)
+{
+	SX1276Frame_t downlink;
+
+	(void)ctx;
+	if (frame->iqInverted || !HostNetwork_HandleUplink(frame, &downlink))
+	{
+		return;
+	}
+	for (uint8_t i = 0; i < HOST_NETWORK_MAX_DOWNLINKS; i++)
+	{
+		if (!downlinkPending[i])
+		{
+			downlinks[i] = downlink;
+			downlinkPending[i] = true;
+			break;
+		}
+	}
+}
+
+static bool airLookup(void *ctx, const SX1276RxWindow_t *window, SX1276Frame_t *frame)
+{
+	uint8_t best = HOST_NETWORK_MAX_DOWNLINKS;
+	uint64_t now = HostClock_Now();
+
+	(void)ctx;
+	for (uint8_t i = 0; i < HOST_NETWORK_MAX_DOWNLINKS; i++)
+	{
+		if (!downlinkPending[i])
+		{
+			continue;
+		}
+		/* Downlinks nobody listened to are dropped once they are over */
+		if ((downlinks[i].start + downlinks[i].duration) < now)
+		{
+			downlinkPending[i] = false;
+			continue;
+		}
+		if (SX1276Model_FrameMatches(window, &downlinks[i]) &&
+			((HOST_NETWORK_MAX_DOWNLINKS == best) || (downlinks[i].start < downlinks[best].start)))
+		{
+			best = i;
+		}
+	}
+
+	if (HOST_NETWORK_MAX_DOWNLINKS == best)
+	{
+		return false;
+	}
+	*frame = downlinks[best];
+	return true;
+}
+
+static SX1276RxOutcome_t airDeliver(void *ctx, const SX1276Frame_t *frame)
+{
+	(void)ctx;
+	for (uint8_t i = 0; i < HOST_NETWORK_MAX_DOWNLINKS; i++)
+	{
+		if (downlinkPending[i] && (downlinks[i].start == frame->start))
+		{
+			downlinkPending[i] = false;
+		}
+	}
+	return SX1276_RX_OK;
+}
+
+static int16_t airChannelRssi(void *ctx, uint32_t frequency)
+{
+	uint64_t now = HostClock_Now();
+
+	(void)ctx;
+	for (uint8_t i = 0; i < HOST_NETWORK_MAX_DOWNLINKS; i++)
+	{
+		if (downlinkPending[i] && (downlinks[i].frequency == frequency) &&
+			(downlinks[i].start <= now) && (now < (downlinks[i].start + downlinks[i].duration)))
+		{
+			return downlinks[i].rssi;
+		}
+	}
+	return SX1276_MODEL_NOISE_FLOOR_DBM;
+}
+
+/******************************************************************************
+                     Interface section
+******************************************************************************/
+/**************************************************************************//**
+\brief Initializes the network server and drops every known device
+******************************************************************************/
+void HostNetwork_Init(const HostNetworkConfig_t *config)
+{
+	networkConfig = *config;
+	memset(devices, 0, sizeof(devices));
+	memset(&networkStats, 0, sizeof(networkStats));
+	memset(downlinkPending, 0, sizeof(downlinkPending));
+	/* Addresses from the experimental NwkID range */
+	nextDevAddr = 0x00000001u | (networkConfig.netId << 25);
+}
+
+/**************************************************************************//**
+\brief Provisions a device for over the air activation
+******************************************************************************/
+bool HostNetwork_AddOtaaDevice(const uint8_t *devEui, const uint8_t *joinEui, const uint8_t *appKey)
+{
+	HostNetworkDevice_t *device = allocateDevice();
+
+	if (NULL == device)
+	{
+		return false;
+	}
+	device->otaa = true;
+	memcpy(device->devEui, devEui, sizeof(device->devEui));
+	memcpy(device->joinEui, joinEui, sizeof(device->joinEui));
+	memcpy(device->appKey, appKey, sizeof(device->appKey));
+	return true;
+}
+
+/**************************************************************************//**
+\brief Provisions a device activated by personalization
+******************************************************************************/
+bool HostNetwork_AddAbpDevice(uint32_t devAddr, const uint8_t *nwkSKey, const uint8_t *appSKey)
+{
+	HostNetworkDevice_t *device = allocateDevice();
+
+	if (NULL == device)
+	{
+		return false;
+	}
+	device->activated = true;
+	device->devAddr = devAddr;
+	memcpy(device->nwkSKey, nwkSKey, sizeof(device->nwkSKey));
+	memcpy(device->appSKey, appSKey, sizeof(device->appSKey));
+	return true;
+}
+
+/**************************************************************************//**
+\brief Processes an uplink frame and builds the answer of the server
+******************************************************************************/
+bool HostNetwork_HandleUplink(const SX1276Frame_t *uplink, SX1276Frame_t *downlink)
+{
+	uint8_t mType;
+
+	if (!uplink->lora || (0 == uplink->length))
+	{
+		return false;
+	}
+
+	mType = uplink->payload[0] >> 5;
+	if (MTYPE_JOIN_REQUEST == mType)
+	{
+		return handleJoinRequest(uplink, downlink);
+	}
+	if ((MTYPE_UNCONFIRMED_UP == mType) || (MTYPE_CONFIRMED_UP == mType))
+	{
+		return handleDataUplink(uplink, downlink);
+	}
+	return false;
+}
+
+/**************************************************************************//**
+\brief Builds a data downlink to a known device
+******************************************************************************/
+bool HostNetwork_BuildDownlink(uint32_t devAddr, const HostNetworkDownlinkReq_t *req, uint8_t *frame,
+	uint8_t *length)
+{
+	HostNetworkDevice_t *device = findByAddress(devAddr);
+	uint16_t size = 1 + FHDR_MIN_SIZE + req->fOptsLength + MIC_SIZE;
+	uint8_t index = 0;
+
+	if (req->portPresent)
+	{
+		size += 1 + req->payloadLength;
+	}
+	if ((NULL == device) || (req->fOptsLength > FCTRL_FOPTS_LEN_MASK) || (size > SX1276_MODEL_MAX_PAYLOAD))
+	{
+		return false;
+	}
+
+	/* MHDR | DevAddr | FCtrl | FCnt | FOpts | [FPort | FRMPayload] | MIC */
+	frame[index++] = (req->confirmed ? MTYPE_CONFIRMED_DOWN : MTYPE_UNCONFIRMED_DOWN) << 5;
+	writeLe32(&frame[index], devAddr);
+	index += 4;
+	frame[index++] = (req->ack ? FCTRL_ACK : 0x00) | req->fOptsLength;
+	frame[index++] = (uint8_t)req->fCnt;
+	frame[index++] = (uint8_t)(req->fCnt >> 8);
+	if (req->fOptsLength)
+	{
+		memcpy(&frame[index], req->fOpts, req->fOptsLength);
+		index += req->fOptsLength;
+	}
+	if (req->portPresent)
+	{
+		frame[index++] = req->port;
+		if (req->payloadLength)
+		{
+			memcpy(&frame[index], req->payload, req->payloadLength);
+		}
+		cryptPayload(req->port ? device->appSKey : device->nwkSKey, DIR_DOWNLINK, devAddr, req->fCnt,
+			&frame[index], req->payloadLength);
+		index += req->payloadLength;
+	}
+	writeLe32(&frame[index], computeDataMic(device->nwkSKey, DIR_DOWNLINK, devAddr, req->fCnt, frame, index));
+	index += MIC_SIZE;
+	*length = index;
+	return true;
+}
+
+/**************************************************************************//**
+\brief Returns a point to point medium to the network server
+******************************************************************************/
+const SX1276Air_t *HostNetwork_GetAir(void)
+{
+	return &pointToPointAir;
+}
+
+/**************************************************************************//**
+\brief Reads the traffic counters
+******************************************************************************/
+void HostNetwork_GetStats(HostNetworkStats_t *stats)
+{
+	*stats = networkStats;
+}
+
+/* eof host_network.c */
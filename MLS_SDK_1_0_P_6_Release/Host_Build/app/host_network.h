@@ -0,0 +1,175 @@
+/**
+* \file  host_network.h
+*
+* \brief Minimal LoRaWAN network server emulation for the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_NETWORK_H
+#define HOST_NETWORK_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stack_common.h"
+#include "sx1276_model.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Number of end devices the emulated network server can track */
+#ifndef HOST_NETWORK_MAX_DEVICES
+#define HOST_NETWORK_MAX_DEVICES        (16)
+#endif
+
+/* Number of downlinks that can be pending on the point to point air */
+#define HOST_NETWORK_MAX_DOWNLINKS      (4)
+
+/* Receive delays in microseconds */
+#define HOST_NETWORK_RX1_DELAY_US       (1000000uLL)
+#define HOST_NETWORK_JOIN_DELAY_US      (5000000uLL)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Settings of the emulated network server */
+typedef struct _HostNetworkConfig
+{
+	/* Regional band, selects the RX1 channel plan */
+	IsmBand_t band;
+	/* Network identifier announced in join-accepts */
+	uint32_t netId;
+	/* A data downlink is sent for every n-th uplink, 0 for none */
+	uint16_t downlinkPeriod;
+	/* Signal quality of the downlinks at the end device */
+	int16_t rssi;
+	int8_t snr;
+} HostNetworkConfig_t;
+
+/* Traffic counters of the emulated network server */
+typedef struct _HostNetworkStats
+{
+	uint32_t joinRequests;
+	uint32_t joinAccepts;
+	uint32_t uplinks;
+	uint32_t confirmedUplinks;
+	uint32_t downlinks;
+	uint32_t micErrors;
+	uint32_t unknownDevices;
+} HostNetworkStats_t;
+
+/* Data downlink built on request, e.g. for a frame corpus */
+typedef struct _HostNetworkDownlinkReq
+{
+	/* Confirmed data down instead of unconfirmed */
+	bool confirmed;
+	/* Acknowledges the last confirmed uplink */
+	bool ack;
+	/* Frame counter of the downlink */
+	uint32_t fCnt;
+	/* MAC commands piggybacked in FOpts, up to 15 bytes */
+	const uint8_t *fOpts;
+	uint8_t fOptsLength;
+	/* The FPort field is present, FRMPayload follows */
+	bool portPresent;
+	uint8_t port;
+	/* FRMPayload in clear, MAC commands if the port is 0 */
+	const uint8_t *payload;
+	uint8_t payloadLength;
+} HostNetworkDownlinkReq_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Initializes the network server and drops every known device
+\param[in] config Server settings
+******************************************************************************/
+void HostNetwork_Init(const HostNetworkConfig_t *config);
+
+/**************************************************************************//**
+\brief Provisions a device for over the air activation
+\param[in] devEui Device EUI, most significant byte first as in conf_app.h
+\param[in] joinEui Join EUI, most significant byte first
+\param[in] appKey Application key
+\return true if the device could be added
+******************************************************************************/
+bool HostNetwork_AddOtaaDevice(const uint8_t *devEui, const uint8_t *joinEui, const uint8_t *appKey);
+
+/**************************************************************************//**
+\brief Provisions a device activated by personalization
+\param[in] devAddr Device address
+\param[in] nwkSKey Network session key
+\param[in] appSKey Application session key
+\return true if the device could be added
+******************************************************************************/
+bool HostNetwork_AddAbpDevice(uint32_t devAddr, const uint8_t *nwkSKey, const uint8_t *appSKey);
+
+/**************************************************************************//**
+\brief Processes an uplink frame and builds the answer of the server
+\param[in] uplink Frame sent by an end device
+\param[out] downlink Downlink frame to be sent in RX1, start time included
+\return true if a downlink is to be sent
+******************************************************************************/
+bool HostNetwork_HandleUplink(const SX1276Frame_t *uplink, SX1276Frame_t *downlink);
+
+/**************************************************************************//**
+\brief Builds a data downlink to a known device, encrypted and signed with
+       its session keys. The frame counter of the server is not touched.
+\param[in] devAddr Address of the device
+\param[in] req Content of the downlink
+\param[out] frame PHYPayload, SX1276_MODEL_MAX_PAYLOAD bytes at most
+\param[out] length Length of the PHYPayload
+\return true if the device is known and the frame fits
+******************************************************************************/
+bool HostNetwork_BuildDownlink(uint32_t devAddr, const HostNetworkDownlinkReq_t *req, uint8_t *frame,
+	uint8_t *length);
+
+/**************************************************************************//**
+\brief Returns a point to point medium connecting the transceiver model to
+       the network server. Every uplink is received and answered.
+\return Air interface to be given to SX1276Model_SetAir()
+******************************************************************************/
+const SX1276Air_t *HostNetwork_GetAir(void);
+
+/**************************************************************************//**
+\brief Reads the traffic counters
+\param[out] stats Counters
+******************************************************************************/
+void HostNetwork_GetStats(HostNetworkStats_t *stats);
+
+#endif /* HOST_NETWORK_H */
+
+/* eof host_network.h */
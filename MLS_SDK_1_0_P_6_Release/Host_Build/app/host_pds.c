@@ -0,0 +1,546 @@
+/**
+* \file  host_pds.c
+*
+* \brief Persistent data server of the stack under power cuts and restarts
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "pds_interface.h"
+#include "sw_timer.h"
+#include "host_nvm.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define HOST_PDS_FILES                  (3u)
+#define HOST_PDS_MAX_ITEMS              (26u)
+#define HOST_PDS_MAX_ITEM_SIZE          (16u)
+
+/* Frame counter of the first file, stored by most operations */
+#define HOST_PDS_FCNT_ITEM              (24u)
+
+/* Content of the RAM of an item before it is restored */
+#define HOST_PDS_SENTINEL               (0xEEu)
+
+/* Failures printed in detail */
+#define HOST_PDS_MAX_REPORTS            (10u)
+
+#ifdef PDS_LOG_ENABLE
+#define HOST_PDS_STORE_NAME             "log-structured"
+#else
+#define HOST_PDS_STORE_NAME             "wear levelled rows"
+#endif
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+typedef enum _HostPdsState
+{
+	HOST_PDS_NEVER = 0,
+	HOST_PDS_STORED,
+	HOST_PDS_DELETED
+} HostPdsState_t;
+
+/* What a restore of an item must give */
+typedef struct _HostPdsItem
+{
+	HostPdsState_t state;
+	uint8_t value[HOST_PDS_MAX_ITEM_SIZE];
+} HostPdsItem_t;
+
+typedef HostPdsItem_t HostPdsModel_t[HOST_PDS_FILES][HOST_PDS_MAX_ITEMS];
+
+/* A file registered to the PDS, shaped like the files of the MAC */
+typedef struct _HostPdsFile
+{
+	PdsFileItemIdx_t fileId;
+	uint8_t numItems;
+	const uint8_t *sizes;
+	ItemMap_t items[HOST_PDS_MAX_ITEMS];
+	PdsOperations_t marks[HOST_PDS_MAX_ITEMS];
+	uint8_t ram[HOST_PDS_MAX_ITEMS][HOST_PDS_MAX_ITEM_SIZE];
+} HostPdsFile_t;
+
+typedef struct _HostPdsOptions
+{
+	uint32_t operations;
+	uint32_t powerInterval;
+	uint32_t restartInterval;
+	uint32_t seed;
+} HostPdsOptions_t;
+
+typedef struct _HostPdsCounters
+{
+	uint32_t operations;
+	uint32_t itemsStored;
+	uint32_t itemsDeleted;
+	uint32_t restarts;
+	uint32_t powerLosses;
+	uint32_t failures;
+	uint64_t rowErases;
+	uint64_t pageWrites;
+	uint64_t bytesRead;
+	uint64_t storeNs;
+	uint64_t initBytesRead;
+	uint64_t initNs;
+	uint64_t restoreNs;
+} HostPdsCounters_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static uint32_t nextRandom(void);
+static uint32_t nextInterval(uint32_t average);
+static void registerFiles(void);
+static void setItem(HostPdsModel_t model, uint8_t file, uint8_t item, bool deleted);
+static void runOperation(void);
+static bool matches(const HostPdsItem_t *expected, PdsStatus_t status, const uint8_t *ram, uint8_t size);
+static void restart(HostPdsModel_t before);
+static void report(void);
+static uint64_t readNs(void);
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+extern bool isFileSet[];
+
+static HostPdsOptions_t options = {
+	.operations = 20000,
+	.powerInterval = 400,
+	.restartInterval = 500,
+	.seed = 1
+};
+
+/* Item sizes of the MAC files and of an application file */
+static const uint8_t macFid1Sizes[] = {
+	1, 1, 4, 1, 2, 4, 4, 16, 16, 1, 1, 1, 8, 1, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 4, 4
+};
+static const uint8_t macFid2Sizes[] = {
+	5, 1, 1, 4, 16, 16, 16, 8, 8, 1, 4, 4, 1, 2, 1, 4, 5
+};
+static const uint8_t appSizes[] = {
+	16, 4, 1, 8
+};
+
+static HostPdsFile_t files[HOST_PDS_FILES] = {
+	{ .fileId = PDS_FILE_MAC_01_IDX, .numItems = sizeof(macFid1Sizes), .sizes = macFid1Sizes },
+	{ .fileId = PDS_FILE_MAC_02_IDX, .numItems = sizeof(macFid2Sizes), .sizes = macFid2Sizes },
+	{ .fileId = PDS_FILE_APP_DATA1_13_IDX, .numItems = sizeof(appSizes), .sizes = appSizes }
+};
+
+/* Restore results expected after the completed operations */
+static HostPdsModel_t model;
+
+static HostPdsCounters_t counters;
+static uint32_t randomState;
+static uint32_t frameCounter;
+static uint32_t nextRestart;
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -n <n>         operations (default %u)\n"
+		"  -p <n>         cut the power every n NVM operations on average, 0 never (default %u)\n"
+		"  -r <n>         restart every n operations on average, 0 never (default %u)\n"
+		"  -s <n>         seed of the operations (default %u)\n",
+		name, (unsigned int)options.operations, (unsigned int)options.powerInterval,
+		(unsigned int)options.restartInterval, (unsigned int)options.seed);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "n:p:r:s:h")))
+	{
+		switch (opt)
+		{
+			case 'n':
+				options.operations = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'p':
+				options.powerInterval = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'r':
+				options.restartInterval = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				options.seed = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				usage(argv[0]);
+				exit((opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief xorshift32, the same sequence for a given seed on every host
+******************************************************************************/
+static uint32_t nextRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+/**************************************************************************//**
+\brief Uniform between 1 and twice the average, 0 for an average of 0
+******************************************************************************/
+static uint32_t nextInterval(uint32_t average)
+{
+	return average ? (1 + (nextRandom() % (2 * average))) : 0;
+}
+
+/**************************************************************************//**
+\brief Registers the files with their items laid out one after the other,
+       like the item lists of the MAC
+******************************************************************************/
+static void registerFiles(void)
+{
+	for (uint8_t f = 0; f < HOST_PDS_FILES; f++)
+	{
+		HostPdsFile_t *file = &files[f];
+		PdsFileMarks_t fileMarks;
+		uint8_t offset = PDS_FILE_START_OFFSET;
+
+		for (uint8_t i = 0; i < file->numItems; i++)
+		{
+			file->items[i].ramAddress = file->ram[i];
+			file->items[i].fileId = (uint8_t)file->fileId;
+			file->items[i].itemId = i;
+			file->items[i].size = file->sizes[i];
+			file->items[i].itemOffset = offset;
+			offset += (uint8_t)(PDS_SIZE_OF_ITEM_HDR + file->sizes[i]);
+		}
+
+		fileMarks.fileMarkListAddr = file->marks;
+		fileMarks.numItems = file->numItems;
+		fileMarks.itemListAddr = file->items;
+		fileMarks.fIDcb = NULL;
+		PDS_RegFile(file->fileId, fileMarks);
+	}
+}
+
+/**************************************************************************//**
+\brief Stores a new value of an item, or deletes it, and notes the result in
+       a model
+******************************************************************************/
+static void setItem(HostPdsModel_t target, uint8_t file, uint8_t item, bool deleted)
+{
+	HostPdsFile_t *pdsFile = &files[file];
+	HostPdsItem_t *expected = &target[file][item];
+
+	if (deleted)
+	{
+		expected->state = HOST_PDS_DELETED;
+		PDS_Delete(pdsFile->fileId, item);
+		counters.itemsDeleted++;
+		return;
+	}
+
+	if ((0 == file) && (HOST_PDS_FCNT_ITEM == item))
+	{
+		frameCounter++;
+		memcpy(pdsFile->ram[item], &frameCounter, sizeof(frameCounter));
+	}
+	else
+	{
+		for (uint8_t i = 0; i < pdsFile->sizes[item]; i++)
+		{
+			pdsFile->ram[item][i] = (uint8_t)nextRandom();
+		}
+	}
+	expected->state = HOST_PDS_STORED;
+	memcpy(expected->value, pdsFile->ram[item], pdsFile->sizes[item]);
+	PDS_Store(pdsFile->fileId, item);
+	counters.itemsStored++;
+}
+
+/**************************************************************************//**
+\brief One operation: mostly the frame counter, else a few items of a file,
+       a deletion, or every item. A cut of the power ends the operation with
+       a restart.
+******************************************************************************/
+static void runOperation(void)
+{
+	static HostPdsModel_t before;
+	HostNvmStats_t start;
+	HostNvmStats_t end;
+	uint32_t choice = nextRandom() % 1000;
+	uint64_t t0;
+
+	memcpy(before, model, sizeof(model));
+	HostNvm_GetStats(&start);
+	t0 = readNs();
+
+	if (choice < 700)
+	{
+		setItem(model, 0, HOST_PDS_FCNT_ITEM, false);
+	}
+	else if (choice < 950)
+	{
+		uint8_t file = (uint8_t)(nextRandom() % HOST_PDS_FILES);
+		uint8_t count = (uint8_t)(1 + (nextRandom() % 4));
+
+		for (uint8_t i = 0; i < count; i++)
+		{
+			setItem(model, file, (uint8_t)(nextRandom() % files[file].numItems), false);
+		}
+	}
+	else if (choice < 995)
+	{
+		uint8_t file = (uint8_t)(nextRandom() % HOST_PDS_FILES);
+
+		setItem(model, file, (uint8_t)(nextRandom() % files[file].numItems), true);
+	}
+	else if (choice < 999)
+	{
+		for (uint8_t file = 0; file < HOST_PDS_FILES; file++)
+		{
+			for (uint8_t item = 0; item < files[file].numItems; item++)
+			{
+				setItem(model, file, item, false);
+			}
+		}
+	}
+	else
+	{
+		/* Not cut: the check does not model a partly erased store */
+		HostNvm_FailAfter(0);
+		PDS_DeleteAll();
+		memset(model, 0, sizeof(model));
+		memcpy(before, model, sizeof(model));
+		HostNvm_FailAfter(nextInterval(options.powerInterval));
+	}
+	/* Every pending file is written, deferred or not */
+	PDS_Flush();
+
+	counters.storeNs += readNs() - t0;
+	HostNvm_GetStats(&end);
+	counters.rowErases += end.rowErases - start.rowErases;
+	counters.pageWrites += end.pageWrites - start.pageWrites;
+	counters.bytesRead += end.bytesRead - start.bytesRead;
+	counters.operations++;
+
+	if (HostNvm_PowerLost())
+	{
+		counters.powerLosses++;
+		restart(before);
+	}
+	else if (nextRestart && (0 == --nextRestart))
+	{
+		restart(model);
+	}
+}
+
+/**************************************************************************//**
+\brief Checks the result of a restore against the expected one. An item
+       never stored reads as zeros when other items of the file are stored.
+******************************************************************************/
+static bool matches(const HostPdsItem_t *expected, PdsStatus_t status, const uint8_t *ram, uint8_t size)
+{
+	switch (expected->state)
+	{
+		case HOST_PDS_STORED:
+			return (PDS_OK == status) && (0 == memcmp(ram, expected->value, size));
+		case HOST_PDS_DELETED:
+			return (PDS_ITEM_DELETED == status);
+		default:
+			if (PDS_NOT_FOUND == status)
+			{
+				return true;
+			}
+			for (uint8_t i = 0; i < size; i++)
+			{
+				if (0 != ram[i])
+				{
+					return false;
+				}
+			}
+			return (PDS_OK == status);
+	}
+}
+
+/**************************************************************************//**
+\brief Restarts the PDS from the NVM and restores every item. After a cut of
+       the power an item of the cut operation may restore to its value before
+       or after the operation, every other item to its last value.
+\param[in] before Expected results before the last operation
+******************************************************************************/
+static void restart(HostPdsModel_t before)
+{
+	HostNvmStats_t start;
+	HostNvmStats_t end;
+	uint64_t t0;
+
+	/* RAM of the device after a reset */
+	for (uint8_t f = 0; f < HOST_PDS_FILES; f++)
+	{
+		memset(files[f].ram, HOST_PDS_SENTINEL, sizeof(files[f].ram));
+		memset(files[f].marks, PDS_OP_NONE, sizeof(files[f].marks));
+	}
+	memset(isFileSet, false, PDS_MAX_FILE_IDX * sizeof(bool));
+
+	HostNvm_FailAfter(0);
+	SystemTimerInit();
+	HostNvm_GetStats(&start);
+	t0 = readNs();
+	PDS_Init();
+	counters.initNs += readNs() - t0;
+	HostNvm_GetStats(&end);
+	counters.initBytesRead += end.bytesRead - start.bytesRead;
+	counters.restarts++;
+
+	for (uint8_t f = 0; f < HOST_PDS_FILES; f++)
+	{
+		HostPdsFile_t *file = &files[f];
+
+		for (uint8_t item = 0; item < file->numItems; item++)
+		{
+			PdsStatus_t status;
+
+			t0 = readNs();
+			status = PDS_Restore(file->fileId, item);
+			counters.restoreNs += readNs() - t0;
+
+			if (matches(&model[f][item], status, file->ram[item], file->sizes[item]))
+			{
+				continue;
+			}
+			if (matches(&before[f][item], status, file->ram[item], file->sizes[item]))
+			{
+				model[f][item] = before[f][item];
+				continue;
+			}
+
+			if (counters.failures++ < HOST_PDS_MAX_REPORTS)
+			{
+				printf("operation %u: file %u item %u restored with status %u, expected state %u\n",
+					(unsigned int)counters.operations, (unsigned int)file->fileId, (unsigned int)item,
+					(unsigned int)status, (unsigned int)model[f][item].state);
+			}
+			/* Go on from what the PDS holds */
+			model[f][item].state = (PDS_OK == status) ? HOST_PDS_STORED :
+				((PDS_ITEM_DELETED == status) ? HOST_PDS_DELETED : HOST_PDS_NEVER);
+			memcpy(model[f][item].value, file->ram[item], file->sizes[item]);
+		}
+	}
+
+	/* The frame counter goes on from the restored value */
+	if (HOST_PDS_STORED == model[0][HOST_PDS_FCNT_ITEM].state)
+	{
+		memcpy(&frameCounter, model[0][HOST_PDS_FCNT_ITEM].value, sizeof(frameCounter));
+	}
+
+	HostNvm_FailAfter(nextInterval(options.powerInterval));
+	nextRestart = nextInterval(options.restartInterval);
+}
+
+static void report(void)
+{
+	HostNvmStats_t nvm;
+	double operations = counters.operations ? counters.operations : 1;
+	double restarts = counters.restarts ? counters.restarts : 1;
+
+	HostNvm_GetStats(&nvm);
+	printf("store            : %s\n", HOST_PDS_STORE_NAME);
+	printf("operations       : %u (%u items stored, %u deleted), %u restarts, %u power losses\n",
+		(unsigned int)counters.operations, (unsigned int)counters.itemsStored,
+		(unsigned int)counters.itemsDeleted, (unsigned int)counters.restarts,
+		(unsigned int)counters.powerLosses);
+	printf("per operation    : %.3f row erases, %.2f page writes, %.0f bytes read, %.0f ns\n",
+		counters.rowErases / operations, counters.pageWrites / operations,
+		counters.bytesRead / operations, counters.storeNs / operations);
+	printf("wear             : %u row erases, at most %u per row\n",
+		(unsigned int)nvm.rowErases, (unsigned int)nvm.maxRowErases);
+	printf("restart          : %.0f bytes read, %.0f ns, %.0f ns to restore all items\n",
+		counters.initBytesRead / restarts, counters.initNs / restarts, counters.restoreNs / restarts);
+}
+
+/**************************************************************************//**
+\brief Reads a monotonic clock in nanoseconds
+******************************************************************************/
+static uint64_t readNs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000uLL) + (uint64_t)now.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	parseOptions(argc, argv);
+	randomState = options.seed ? options.seed : 1;
+
+	HostNvm_Format();
+	HostNvm_ResetStats();
+	SystemTimerInit();
+	PDS_Init();
+	registerFiles();
+	HostNvm_FailAfter(nextInterval(options.powerInterval));
+	nextRestart = nextInterval(options.restartInterval);
+
+	for (uint32_t n = 0; n < options.operations; n++)
+	{
+		runOperation();
+	}
+	/* Everything stored must restore after the last operation */
+	if (!HostNvm_PowerLost())
+	{
+		restart(model);
+	}
+
+	report();
+	printf("%s\n", counters.failures ? "FAILED" : "PASSED");
+	return counters.failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* eof host_pds.c */
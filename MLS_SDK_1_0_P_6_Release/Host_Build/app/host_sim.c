@@ -0,0 +1,1342 @@
+/**
+* \file  host_sim.c
+*
+* \brief Discrete event simulation of many end devices sharing one gateway
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <limits.h>
+#include "host_clock.h"
+#include "sx1276_model.h"
+#include "host_network.h"
+#include "host_device.h"
+#include "host_instance.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define HOST_SIM_MAX_DEVICES            HOST_NETWORK_MAX_DEVICES
+#define HOST_SIM_DEFAULT_DEVICES        (100)
+#define HOST_SIM_DEFAULT_DURATION_S     (3600)
+#define HOST_SIM_DEFAULT_INTERVAL_S     (600)
+#define HOST_SIM_DEFAULT_JOIN_WINDOW_S  (10)
+#define HOST_SIM_DEFAULT_PAYLOAD_LENGTH (12)
+#define HOST_SIM_DEFAULT_RADIUS_M       (10000.0)
+#define HOST_SIM_DEFAULT_EXPONENT       (2.7)
+#define HOST_SIM_DEFAULT_MARGIN_DB      (5.0)
+#define HOST_SIM_DEFAULT_CAPTURE_DB     (6.0)
+#define HOST_SIM_DEFAULT_DEMODULATORS   (8)
+#define HOST_SIM_DEFAULT_GATEWAY_DBM    (14)
+#define HOST_SIM_NET_ID                 (0x000013)
+
+/* Transmit power assumed by the spreading factor choice */
+#define HOST_SIM_DEVICE_POWER_DBM       (14)
+
+/* Sender of the frames transmitted by the gateway */
+#define HOST_SIM_GATEWAY                (UINT32_MAX)
+
+/* Receiver noise figure and thermal noise density */
+#define HOST_SIM_NOISE_FIGURE_DB        (6.0)
+#define HOST_SIM_THERMAL_NOISE_DBM_HZ   (-174.0)
+
+/* Spreading factors covered by the interference model */
+#define HOST_SIM_MIN_SF                 (7)
+#define HOST_SIM_MAX_SF                 (12)
+#define HOST_SIM_SF_COUNT               (HOST_SIM_MAX_SF - HOST_SIM_MIN_SF + 1)
+
+/* Path loss reference distance */
+#define HOST_SIM_REFERENCE_DISTANCE_M   (1.0)
+#define HOST_SIM_SPEED_OF_LIGHT         (299792458.0)
+
+/* Frame layout used to account the application payload */
+#define HOST_SIM_MTYPE_JOIN_REQUEST     (0)
+#define HOST_SIM_FHDR_OFFSET            (1)
+#define HOST_SIM_FHDR_MIN_SIZE          (7)
+#define HOST_SIM_MIC_SIZE               (4)
+#define HOST_SIM_FOPTS_LEN_MASK         (0x0F)
+
+#define SF_INDEX(sf)                    ((uint8_t)((((sf) < HOST_SIM_MIN_SF) ? HOST_SIM_MIN_SF : (sf)) - HOST_SIM_MIN_SF))
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+typedef enum _HostSimEventKind
+{
+	/* The next event of a device is due */
+	HOST_SIM_EVENT_DEVICE = 0,
+
+	/* An uplink is over, the gateway decides about its reception */
+	HOST_SIM_EVENT_UPLINK_END
+} HostSimEventKind_t;
+
+/* Entry of the event queue */
+typedef struct _HostSimEvent
+{
+	uint64_t due;
+	/* Insertion order, keeps events of equal time in FIFO order */
+	uint64_t seq;
+	uint32_t id;
+	HostSimEventKind_t kind;
+} HostSimEvent_t;
+
+/* Outcome of an uplink at the gateway */
+typedef enum _HostSimFate
+{
+	HOST_SIM_FATE_RECEIVED = 0,
+	HOST_SIM_FATE_BELOW_SENSITIVITY,
+	HOST_SIM_FATE_NO_DEMODULATOR,
+	HOST_SIM_FATE_HALF_DUPLEX,
+	HOST_SIM_FATE_COLLISION,
+	HOST_SIM_FATE_COUNT,
+	HOST_SIM_FATE_PENDING = HOST_SIM_FATE_COUNT
+} HostSimFate_t;
+
+/* A frame on the shared air */
+typedef struct _HostSimFrame
+{
+	SX1276Frame_t frame;
+	uint32_t sender;
+	HostSimFate_t fate;
+	/* The uplink holds one of the demodulators of the gateway */
+	bool demodulating;
+	/* Every receiver decision involving the frame has been taken */
+	bool ended;
+	bool inUse;
+} HostSimFrame_t;
+
+/* Placement and radio settings of a device */
+typedef struct _HostSimDevice
+{
+	double x;
+	double y;
+	/* Path loss to the gateway in dB, shadowing included */
+	double pathLoss;
+	uint8_t sf;
+	bool running;
+} HostSimDevice_t;
+
+/* Entry points of the device image */
+typedef struct _HostSimDeviceApi
+{
+	bool (*start)(const HostDeviceConfig_t *config);
+	bool (*run)(uint64_t until);
+	uint64_t (*nextEvent)(void);
+	void (*getStats)(HostDeviceStats_t *stats, SX1276ModelStats_t *radio);
+} HostSimDeviceApi_t;
+
+/* Uplink counters of the gateway */
+typedef struct _HostSimUplinkStats
+{
+	uint32_t sent;
+	uint32_t fate[HOST_SIM_FATE_COUNT];
+	uint64_t airtimeUs;
+} HostSimUplinkStats_t;
+
+typedef struct _HostSimOptions
+{
+	uint32_t devices;
+	uint32_t durationS;
+	uint32_t intervalS;
+	uint32_t joinWindowS;
+	uint32_t seed;
+	uint16_t downlinkPeriod;
+	uint8_t payloadLength;
+	uint8_t demodulators;
+	uint8_t fixedSf;
+	int8_t gatewayPower;
+	IsmBand_t band;
+	double radius;
+	double exponent;
+	double shadowing;
+	double margin;
+	double capture;
+	const char *library;
+	bool fixedInterval;
+	bool confirmed;
+	bool abp;
+	bool dutyCycle;
+	bool joinBackoff;
+	bool orthogonal;
+	bool verbose;
+} HostSimOptions_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostSimOptions_t options = {
+	.devices = HOST_SIM_DEFAULT_DEVICES,
+	.durationS = HOST_SIM_DEFAULT_DURATION_S,
+	.intervalS = HOST_SIM_DEFAULT_INTERVAL_S,
+	.joinWindowS = HOST_SIM_DEFAULT_JOIN_WINDOW_S,
+	.seed = 1,
+	.downlinkPeriod = 0,
+	.payloadLength = HOST_SIM_DEFAULT_PAYLOAD_LENGTH,
+	.demodulators = HOST_SIM_DEFAULT_DEMODULATORS,
+	.fixedSf = 0,
+	.gatewayPower = HOST_SIM_DEFAULT_GATEWAY_DBM,
+	.band = ISM_EU868,
+	.radius = HOST_SIM_DEFAULT_RADIUS_M,
+	.exponent = HOST_SIM_DEFAULT_EXPONENT,
+	.shadowing = 0.0,
+	.margin = HOST_SIM_DEFAULT_MARGIN_DB,
+	.capture = HOST_SIM_DEFAULT_CAPTURE_DB,
+	.library = NULL,
+	.fixedInterval = false,
+	.confirmed = false,
+	.abp = false,
+	.dutyCycle = true,
+	.joinBackoff = true,
+	.orthogonal = false,
+	.verbose = false
+};
+
+static const struct
+{
+	const char *name;
+	IsmBand_t band;
+	uint32_t frequency;
+	uint8_t maxSf;
+} bandNames[] = {
+	{"eu868", ISM_EU868, 868100000u, 12},
+	{"na915", ISM_NA915, 902300000u, 10},
+	{"au915", ISM_AU915, 915200000u, 12},
+	{"as923", ISM_THAI923, 923200000u, 12},
+	{"kr920", ISM_KR920, 922100000u, 12},
+	{"jp923", ISM_JPN923, 923200000u, 12},
+	{"in865", ISM_IND865, 865062500u, 12}
+};
+
+/* Sensitivity at 125kHz for SF7..SF12 in dBm, SX1276 datasheet */
+static const double sensitivity125[HOST_SIM_SF_COUNT] = {
+	-123.0, -126.0, -129.0, -132.0, -133.0, -136.0
+};
+
+/*
+* Signal to interference ratio in dB needed by a frame of the row spreading
+* factor against an interferer of the column spreading factor. The diagonal
+* is the capture threshold, the rest is the imperfect orthogonality of the
+* spreading factors (Goursaud and Gorce, 2015).
+*/
+static const double rejection[HOST_SIM_SF_COUNT][HOST_SIM_SF_COUNT] = {
+	{  0.0, -16.0, -18.0, -19.0, -19.0, -20.0},
+	{-24.0,   0.0, -20.0, -22.0, -22.0, -22.0},
+	{-27.0, -27.0,   0.0, -23.0, -25.0, -25.0},
+	{-30.0, -30.0, -30.0,   0.0, -26.0, -28.0},
+	{-33.0, -33.0, -33.0, -33.0,   0.0, -29.0},
+	{-36.0, -36.0, -36.0, -36.0, -36.0,   0.0}
+};
+
+static HostSimDeviceApi_t deviceApi;
+static HostSimDevice_t *devices;
+static uint32_t bandIndex;
+static uint64_t simNow;
+static uint64_t randomState;
+
+/* Event queue, binary min-heap */
+static HostSimEvent_t *events;
+static uint32_t eventCount;
+static uint32_t eventCapacity;
+static uint64_t eventSeq;
+
+/* Frames on the air */
+static HostSimFrame_t *frames;
+static uint32_t frameCapacity;
+static uint32_t *activeFrames;
+static uint32_t activeCount;
+static uint32_t longestFrameUs;
+
+/* Counters */
+static HostSimUplinkStats_t uplinkStats[HOST_SIM_SF_COUNT];
+static HostSimUplinkStats_t joinStats;
+static uint64_t goodputBytes;
+static uint64_t deviceRuns;
+static uint32_t downlinksScheduled;
+static uint32_t downlinksGatewayBusy;
+static uint32_t downlinksDemodulated;
+static uint32_t downlinksLost;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static double randomUniform(void);
+static double randomNormal(void);
+static void pushEvent(uint64_t due, HostSimEventKind_t kind, uint32_t id);
+static bool popEvent(HostSimEvent_t *ev);
+static double bandwidthHz(uint8_t bw);
+static double sensitivity(uint8_t sf, uint8_t bw);
+static double noiseFloor(uint8_t bw);
+static double pathLossAt(double distance);
+static double linkLoss(uint32_t a, uint32_t b);
+static uint32_t allocateFrame(void);
+static void releaseFrames(void);
+static bool overlaps(const SX1276Frame_t *a, const SX1276Frame_t *b);
+static bool gatewayTransmitting(const SX1276Frame_t *frame);
+static bool survives(uint32_t victim, uint32_t receiver);
+static uint16_t applicationPayload(const SX1276Frame_t *frame);
+static void scheduleDownlink(const SX1276Frame_t *downlink);
+static void uplinkEnd(uint32_t index);
+static void airTransmit(void *ctx, const SX1276Frame_t *frame);
+static bool airLookup(void *ctx, const SX1276RxWindow_t *window, SX1276Frame_t *frame);
+static SX1276RxOutcome_t airDeliver(void *ctx, const SX1276Frame_t *frame);
+static int16_t airChannelRssi(void *ctx, uint32_t frequency);
+static bool loadDevices(const char *argv0);
+static bool startDevices(void);
+static void runDevice(uint32_t index);
+static int compareTimes(const void *a, const void *b);
+static void report(double wallSeconds);
+
+static const SX1276Air_t sharedAir = {
+	.transmit = airTransmit,
+	.lookup = airLookup,
+	.deliver = airDeliver,
+	.channelRssi = airChannelRssi,
+	.ctx = NULL
+};
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -N <devices>   number of end devices (default %u, at most %u)\n"
+		"  -b <band>      eu868, na915, au915, as923, kr920, jp923, in865\n"
+		"  -t <s>         simulated time (default %u)\n"
+		"  -i <s>         mean interval between uplinks (default %u)\n"
+		"  -F             fixed instead of exponentially distributed intervals\n"
+		"  -w <s>         devices power on uniformly within this window (default %u)\n"
+		"  -l <bytes>     uplink payload length (default %u)\n"
+		"  -c             confirmed uplinks\n"
+		"  -a             activation by personalization\n"
+		"  -D <n>         network sends a downlink every n-th uplink, 0 for none\n"
+		"  -u             do not enforce the regional duty cycle\n"
+		"  -J             disable the join backoff of the stack\n"
+		"  -r <m>         radius of the cell (default %.0f)\n"
+		"  -e <n>         path loss exponent (default %.1f)\n"
+		"  -g <dB>        standard deviation of the shadowing (default 0)\n"
+		"  -S <sf>        fixed spreading factor instead of the link budget choice\n"
+		"  -M <dB>        link margin of the spreading factor choice (default %.0f)\n"
+		"  -m <n>         demodulators of the gateway (default %u)\n"
+		"  -C <dB>        capture threshold (default %.0f)\n"
+		"  -o             perfectly orthogonal spreading factors\n"
+		"  -P <dBm>       gateway transmit power (default %d)\n"
+		"  -L <file>      device image (default next to the executable)\n"
+		"  -s <seed>      seed of the placement and of the devices\n"
+		"  -v             trace every device transaction\n",
+		name, HOST_SIM_DEFAULT_DEVICES, HOST_SIM_MAX_DEVICES, HOST_SIM_DEFAULT_DURATION_S,
+		HOST_SIM_DEFAULT_INTERVAL_S, HOST_SIM_DEFAULT_JOIN_WINDOW_S, HOST_SIM_DEFAULT_PAYLOAD_LENGTH,
+		HOST_SIM_DEFAULT_RADIUS_M, HOST_SIM_DEFAULT_EXPONENT, HOST_SIM_DEFAULT_MARGIN_DB,
+		HOST_SIM_DEFAULT_DEMODULATORS, HOST_SIM_DEFAULT_CAPTURE_DB, HOST_SIM_DEFAULT_GATEWAY_DBM);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "N:b:t:i:Fw:l:caD:uJr:e:g:S:M:m:C:oP:L:s:vh")))
+	{
+		switch (opt)
+		{
+			case 'N':
+				options.devices = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+			{
+				bool found = false;
+
+				for (uint32_t i = 0; i < sizeof(bandNames) / sizeof(bandNames[0]); i++)
+				{
+					if (0 == strcmp(optarg, bandNames[i].name))
+					{
+						options.band = bandNames[i].band;
+						bandIndex = i;
+						found = true;
+					}
+				}
+				if (!found)
+				{
+					usage(argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			}
+			case 't':
+				options.durationS = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'i':
+				options.intervalS = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'F':
+				options.fixedInterval = true;
+				break;
+			case 'w':
+				options.joinWindowS = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'l':
+				options.payloadLength = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				options.confirmed = true;
+				break;
+			case 'a':
+				options.abp = true;
+				break;
+			case 'D':
+				options.downlinkPeriod = (uint16_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'u':
+				options.dutyCycle = false;
+				break;
+			case 'J':
+				options.joinBackoff = false;
+				break;
+			case 'r':
+				options.radius = strtod(optarg, NULL);
+				break;
+			case 'e':
+				options.exponent = strtod(optarg, NULL);
+				break;
+			case 'g':
+				options.shadowing = strtod(optarg, NULL);
+				break;
+			case 'S':
+				options.fixedSf = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'M':
+				options.margin = strtod(optarg, NULL);
+				break;
+			case 'm':
+				options.demodulators = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'C':
+				options.capture = strtod(optarg, NULL);
+				break;
+			case 'o':
+				options.orthogonal = true;
+				break;
+			case 'P':
+				options.gatewayPower = (int8_t)strtol(optarg, NULL, 0);
+				break;
+			case 'L':
+				options.library = optarg;
+				break;
+			case 's':
+				options.seed = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'v':
+				options.verbose = true;
+				break;
+			default:
+				usage(argv[0]);
+				exit(('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+
+	if ((0 == options.devices) || (options.devices > HOST_SIM_MAX_DEVICES) ||
+		(options.fixedSf && ((options.fixedSf < HOST_SIM_MIN_SF) || (options.fixedSf > bandNames[bandIndex].maxSf))))
+	{
+		usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**************************************************************************//**
+\brief Uniform random number in ]0, 1[, xorshift64*
+******************************************************************************/
+static double randomUniform(void)
+{
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+	return (((randomState * 2685821657736338717uLL) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/**************************************************************************//**
+\brief Standard normal random number, Box-Muller
+******************************************************************************/
+static double randomNormal(void)
+{
+	return sqrt(-2.0 * log(randomUniform())) * cos(2.0 * M_PI * randomUniform());
+}
+
+/******************************************************************************
+                     Event queue
+******************************************************************************/
+static void pushEvent(uint64_t due, HostSimEventKind_t kind, uint32_t id)
+{
+	HostSimEvent_t ev = {.due = due, .seq = eventSeq++, .id = id, .kind = kind};
+	uint32_t pos;
+
+	if (eventCount == eventCapacity)
+	{
+		eventCapacity = eventCapacity ? (eventCapacity * 2u) : 1024u;
+		events = realloc(events, eventCapacity * sizeof(HostSimEvent_t));
+		if (NULL == events)
+		{
+			printf("Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* Sift up */
+	pos = eventCount++;
+	while (pos > 0)
+	{
+		uint32_t parent = (pos - 1u) / 2u;
+
+		if ((events[parent].due < ev.due) ||
+			((events[parent].due == ev.due) && (events[parent].seq < ev.seq)))
+		{
+			break;
+		}
+		events[pos] = events[parent];
+		pos = parent;
+	}
+	events[pos] = ev;
+}
+
+static bool popEvent(HostSimEvent_t *ev)
+{
+	HostSimEvent_t last;
+	uint32_t pos = 0;
+
+	if (0 == eventCount)
+	{
+		return false;
+	}
+	*ev = events[0];
+	last = events[--eventCount];
+
+	/* Sift down */
+	while (true)
+	{
+		uint32_t child = (2u * pos) + 1u;
+
+		if (child >= eventCount)
+		{
+			break;
+		}
+		if (((child + 1u) < eventCount) &&
+			((events[child + 1u].due < events[child].due) ||
+			((events[child + 1u].due == events[child].due) && (events[child + 1u].seq < events[child].seq))))
+		{
+			child++;
+		}
+		if ((last.due < events[child].due) || ((last.due == events[child].due) && (last.seq < events[child].seq)))
+		{
+			break;
+		}
+		events[pos] = events[child];
+		pos = child;
+	}
+	events[pos] = last;
+	return true;
+}
+
+/******************************************************************************
+                     Channel model
+******************************************************************************/
+static double bandwidthHz(uint8_t bw)
+{
+	static const double table[] = {
+		7800.0, 10400.0, 15600.0, 20800.0, 31250.0, 41700.0, 62500.0, 125000.0, 250000.0, 500000.0
+	};
+
+	return (bw < (sizeof(table) / sizeof(table[0]))) ? table[bw] : 125000.0;
+}
+
+static double sensitivity(uint8_t sf, uint8_t bw)
+{
+	return sensitivity125[SF_INDEX(sf)] + (10.0 * log10(bandwidthHz(bw) / 125000.0));
+}
+
+static double noiseFloor(uint8_t bw)
+{
+	return HOST_SIM_THERMAL_NOISE_DBM_HZ + (10.0 * log10(bandwidthHz(bw))) + HOST_SIM_NOISE_FIGURE_DB;
+}
+
+/**************************************************************************//**
+\brief Log-distance path loss, free space up to the reference distance
+******************************************************************************/
+static double pathLossAt(double distance)
+{
+	double lambda = HOST_SIM_SPEED_OF_LIGHT / bandNames[bandIndex].frequency;
+	double reference = 20.0 * log10((4.0 * M_PI * HOST_SIM_REFERENCE_DISTANCE_M) / lambda);
+
+	if (distance < HOST_SIM_REFERENCE_DISTANCE_M)
+	{
+		distance = HOST_SIM_REFERENCE_DISTANCE_M;
+	}
+	return reference + (10.0 * options.exponent * log10(distance / HOST_SIM_REFERENCE_DISTANCE_M));
+}
+
+/**************************************************************************//**
+\brief Path loss between two nodes, devices or the gateway
+******************************************************************************/
+static double linkLoss(uint32_t a, uint32_t b)
+{
+	if (HOST_SIM_GATEWAY == a)
+	{
+		return devices[b].pathLoss;
+	}
+	if (HOST_SIM_GATEWAY == b)
+	{
+		return devices[a].pathLoss;
+	}
+	return pathLossAt(hypot(devices[a].x - devices[b].x, devices[a].y - devices[b].y));
+}
+
+static uint32_t allocateFrame(void)
+{
+	for (uint32_t i = 0; i < frameCapacity; i++)
+	{
+		if (!frames[i].inUse)
+		{
+			frames[i].inUse = true;
+			activeFrames[activeCount++] = i;
+			return i;
+		}
+	}
+
+	frameCapacity = frameCapacity ? (frameCapacity * 2u) : 256u;
+	frames = realloc(frames, frameCapacity * sizeof(HostSimFrame_t));
+	activeFrames = realloc(activeFrames, frameCapacity * sizeof(uint32_t));
+	if ((NULL == frames) || (NULL == activeFrames))
+	{
+		printf("Out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (uint32_t i = frameCapacity / 2u; i < frameCapacity; i++)
+	{
+		frames[i].inUse = false;
+	}
+	return allocateFrame();
+}
+
+/**************************************************************************//**
+\brief Drops the frames no pending decision can overlap with anymore
+******************************************************************************/
+static void releaseFrames(void)
+{
+	uint32_t i = 0;
+
+	while (i < activeCount)
+	{
+		HostSimFrame_t *rec = &frames[activeFrames[i]];
+		uint64_t end = rec->frame.start + rec->frame.duration;
+
+		if ((rec->ended || (HOST_SIM_GATEWAY == rec->sender)) && ((end + longestFrameUs) < simNow))
+		{
+			rec->inUse = false;
+			activeFrames[i] = activeFrames[--activeCount];
+			continue;
+		}
+		i++;
+	}
+}
+
+/**************************************************************************//**
+\brief Checks whether two frames overlap in time and in spectrum
+******************************************************************************/
+static bool overlaps(const SX1276Frame_t *a, const SX1276Frame_t *b)
+{
+	double distance = fabs((double)a->frequency - (double)b->frequency);
+
+	if ((a->start >= (b->start + b->duration)) || (b->start >= (a->start + a->duration)))
+	{
+		return false;
+	}
+	return distance < ((bandwidthHz(a->bw) + bandwidthHz(b->bw)) / 2.0);
+}
+
+static bool gatewayTransmitting(const SX1276Frame_t *frame)
+{
+	for (uint32_t i = 0; i < activeCount; i++)
+	{
+		const HostSimFrame_t *rec = &frames[activeFrames[i]];
+		uint64_t end = rec->frame.start + rec->frame.duration;
+
+		if ((HOST_SIM_GATEWAY == rec->sender) && (rec->frame.start < (frame->start + frame->duration)) &&
+			(frame->start < end))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**************************************************************************//**
+\brief Decides whether a frame survives the interference at a receiver.
+       The interferers are summed per spreading factor, and the frame
+       survives if it is strong enough against every sum: by the capture
+       threshold against its own spreading factor, by the rejection of the
+       spreading factors against the others.
+\param[in] victim Index of the frame
+\param[in] receiver Receiving device or HOST_SIM_GATEWAY
+\return true if the frame can be demodulated
+******************************************************************************/
+static bool survives(uint32_t victim, uint32_t receiver)
+{
+	const HostSimFrame_t *v = &frames[victim];
+	double interference[HOST_SIM_SF_COUNT] = {0.0};
+	double signal = v->frame.power - linkLoss(v->sender, receiver);
+	uint8_t vsf = SF_INDEX(v->frame.sf);
+
+	for (uint32_t i = 0; i < activeCount; i++)
+	{
+		const HostSimFrame_t *rec = &frames[activeFrames[i]];
+
+		if ((activeFrames[i] == victim) || (rec->sender == receiver) || !rec->frame.lora ||
+			!overlaps(&rec->frame, &v->frame))
+		{
+			continue;
+		}
+		interference[SF_INDEX(rec->frame.sf)] += pow(10.0, (rec->frame.power - linkLoss(rec->sender, receiver)) / 10.0);
+	}
+
+	for (uint8_t sf = 0; sf < HOST_SIM_SF_COUNT; sf++)
+	{
+		double threshold = (sf == vsf) ? options.capture : rejection[vsf][sf];
+
+		if ((interference[sf] <= 0.0) || (options.orthogonal && (sf != vsf)))
+		{
+			continue;
+		}
+		if ((signal - (10.0 * log10(interference[sf]))) < threshold)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief Returns the FRMPayload length of a data uplink
+******************************************************************************/
+static uint16_t applicationPayload(const SX1276Frame_t *frame)
+{
+	uint16_t overhead;
+
+	if (frame->length < (HOST_SIM_FHDR_OFFSET + HOST_SIM_FHDR_MIN_SIZE + HOST_SIM_MIC_SIZE))
+	{
+		return 0;
+	}
+	overhead = HOST_SIM_FHDR_OFFSET + HOST_SIM_FHDR_MIN_SIZE + HOST_SIM_MIC_SIZE +
+		(frame->payload[HOST_SIM_FHDR_OFFSET + 4] & HOST_SIM_FOPTS_LEN_MASK);
+	/* FPort comes with a payload only */
+	return (frame->length > (overhead + 1u)) ? (uint16_t)(frame->length - overhead - 1u) : 0;
+}
+
+/******************************************************************************
+                     Gateway
+******************************************************************************/
+/**************************************************************************//**
+\brief Queues a downlink of the network server for transmission. The gateway
+       has a single transmitter, a downlink overlapping another one is
+       dropped.
+******************************************************************************/
+static void scheduleDownlink(const SX1276Frame_t *downlink)
+{
+	uint32_t index;
+
+	if (gatewayTransmitting(downlink))
+	{
+		downlinksGatewayBusy++;
+		return;
+	}
+	index = allocateFrame();
+	frames[index].frame = *downlink;
+	frames[index].frame.power = options.gatewayPower;
+	frames[index].sender = HOST_SIM_GATEWAY;
+	frames[index].fate = HOST_SIM_FATE_PENDING;
+	frames[index].demodulating = false;
+	frames[index].ended = false;
+	if (downlink->duration > longestFrameUs)
+	{
+		longestFrameUs = downlink->duration;
+	}
+	downlinksScheduled++;
+}
+
+/**************************************************************************//**
+\brief Decides about the reception of an uplink at its end
+******************************************************************************/
+static void uplinkEnd(uint32_t index)
+{
+	HostSimFrame_t *rec = &frames[index];
+	HostSimUplinkStats_t *stats;
+	bool join = (HOST_SIM_MTYPE_JOIN_REQUEST == (rec->frame.payload[0] >> 5));
+
+	rec->demodulating = false;
+	if (HOST_SIM_FATE_PENDING == rec->fate)
+	{
+		if (gatewayTransmitting(&rec->frame))
+		{
+			rec->fate = HOST_SIM_FATE_HALF_DUPLEX;
+		}
+		else if (!survives(index, HOST_SIM_GATEWAY))
+		{
+			rec->fate = HOST_SIM_FATE_COLLISION;
+		}
+		else
+		{
+			rec->fate = HOST_SIM_FATE_RECEIVED;
+		}
+	}
+
+	stats = join ? &joinStats : &uplinkStats[SF_INDEX(rec->frame.sf)];
+	stats->fate[rec->fate]++;
+
+	if (HOST_SIM_FATE_RECEIVED == rec->fate)
+	{
+		SX1276Frame_t uplink = rec->frame;
+		SX1276Frame_t downlink;
+		HostNetworkStats_t before;
+		HostNetworkStats_t after;
+		double rssi = rec->frame.power - devices[rec->sender].pathLoss;
+
+		uplink.rssi = (int16_t)lround(rssi);
+		uplink.snr = (int8_t)fmax(-20.0, fmin(20.0, rssi - noiseFloor(rec->frame.bw)));
+
+		HostNetwork_GetStats(&before);
+		if (HostNetwork_HandleUplink(&uplink, &downlink))
+		{
+			scheduleDownlink(&downlink);
+		}
+		HostNetwork_GetStats(&after);
+		if (after.uplinks != before.uplinks)
+		{
+			goodputBytes += applicationPayload(&uplink);
+		}
+	}
+	rec->ended = true;
+	releaseFrames();
+}
+
+/******************************************************************************
+                     Shared air
+******************************************************************************/
+/**************************************************************************//**
+\brief A device starts a transmission. Uplinks get a demodulator of the
+       gateway if they are strong enough and one is free.
+******************************************************************************/
+static void airTransmit(void *ctx, const SX1276Frame_t *frame)
+{
+	uint32_t sender = HostInstance_Current();
+	uint32_t index;
+	uint32_t busy = 0;
+	HostSimFrame_t *rec;
+	HostSimUplinkStats_t *stats;
+
+	(void)ctx;
+	if (!frame->lora || frame->iqInverted)
+	{
+		return;
+	}
+
+	index = allocateFrame();
+	rec = &frames[index];
+	rec->frame = *frame;
+	rec->sender = sender;
+	rec->fate = HOST_SIM_FATE_PENDING;
+	rec->demodulating = false;
+	rec->ended = false;
+	if (frame->duration > longestFrameUs)
+	{
+		longestFrameUs = frame->duration;
+	}
+
+	stats = (HOST_SIM_MTYPE_JOIN_REQUEST == (frame->payload[0] >> 5)) ? &joinStats : &uplinkStats[SF_INDEX(frame->sf)];
+	stats->sent++;
+	stats->airtimeUs += frame->duration;
+
+	for (uint32_t i = 0; i < activeCount; i++)
+	{
+		if (frames[activeFrames[i]].demodulating)
+		{
+			busy++;
+		}
+	}
+
+	if ((frame->power - devices[sender].pathLoss) < sensitivity(frame->sf, frame->bw))
+	{
+		rec->fate = HOST_SIM_FATE_BELOW_SENSITIVITY;
+	}
+	else if (busy >= options.demodulators)
+	{
+		rec->fate = HOST_SIM_FATE_NO_DEMODULATOR;
+	}
+	else
+	{
+		rec->demodulating = true;
+	}
+	pushEvent(frame->start + frame->duration, HOST_SIM_EVENT_UPLINK_END, index);
+}
+
+/**************************************************************************//**
+\brief Finds the earliest downlink the receiver of the running device can
+       lock onto
+******************************************************************************/
+static bool airLookup(void *ctx, const SX1276RxWindow_t *window, SX1276Frame_t *frame)
+{
+	uint32_t receiver = HostInstance_Current();
+	const HostSimFrame_t *best = NULL;
+	double rssi = 0.0;
+
+	(void)ctx;
+	for (uint32_t i = 0; i < activeCount; i++)
+	{
+		const HostSimFrame_t *rec = &frames[activeFrames[i]];
+		double level;
+
+		if ((HOST_SIM_GATEWAY != rec->sender) || !SX1276Model_FrameMatches(window, &rec->frame))
+		{
+			continue;
+		}
+		level = rec->frame.power - devices[receiver].pathLoss;
+		if ((level >= sensitivity(rec->frame.sf, rec->frame.bw)) && ((NULL == best) || (rec->frame.start < best->frame.start)))
+		{
+			best = rec;
+			rssi = level;
+		}
+	}
+
+	if (NULL == best)
+	{
+		return false;
+	}
+	*frame = best->frame;
+	frame->rssi = (int16_t)lround(rssi);
+	frame->snr = (int8_t)fmax(-20.0, fmin(20.0, rssi - noiseFloor(frame->bw)));
+	return true;
+}
+
+/**************************************************************************//**
+\brief Decides at the end of a downlink whether the running device got it
+******************************************************************************/
+static SX1276RxOutcome_t airDeliver(void *ctx, const SX1276Frame_t *frame)
+{
+	uint32_t receiver = HostInstance_Current();
+
+	(void)ctx;
+	for (uint32_t i = 0; i < activeCount; i++)
+	{
+		const HostSimFrame_t *rec = &frames[activeFrames[i]];
+
+		if ((HOST_SIM_GATEWAY == rec->sender) && (rec->frame.start == frame->start) &&
+			(rec->frame.frequency == frame->frequency))
+		{
+			if (survives(activeFrames[i], receiver))
+			{
+				downlinksDemodulated++;
+				return SX1276_RX_OK;
+			}
+			break;
+		}
+	}
+	downlinksLost++;
+	return SX1276_RX_LOST;
+}
+
+/**************************************************************************//**
+\brief Signal strength seen by the running device on a channel, used by the
+       listen before talk of the stack
+******************************************************************************/
+static int16_t airChannelRssi(void *ctx, uint32_t frequency)
+{
+	uint32_t receiver = HostInstance_Current();
+	double power = 0.0;
+
+	(void)ctx;
+	for (uint32_t i = 0; i < activeCount; i++)
+	{
+		const HostSimFrame_t *rec = &frames[activeFrames[i]];
+
+		if ((rec->sender == receiver) || (rec->frame.start > simNow) ||
+			((rec->frame.start + rec->frame.duration) <= simNow) ||
+			(fabs((double)rec->frame.frequency - (double)frequency) >= bandwidthHz(rec->frame.bw)))
+		{
+			continue;
+		}
+		power += pow(10.0, (rec->frame.power - linkLoss(rec->sender, receiver)) / 10.0);
+	}
+
+	if ((power <= 0.0) || ((10.0 * log10(power)) < SX1276_MODEL_NOISE_FLOOR_DBM))
+	{
+		return SX1276_MODEL_NOISE_FLOOR_DBM;
+	}
+	return (int16_t)lround(10.0 * log10(power));
+}
+
+/******************************************************************************
+                     Devices
+******************************************************************************/
+/**************************************************************************//**
+\brief Loads the device image and resolves its entry points
+******************************************************************************/
+static bool loadDevices(const char *argv0)
+{
+	char path[PATH_MAX];
+
+	if (options.library)
+	{
+		snprintf(path, sizeof(path), "%s", options.library);
+	}
+	else
+	{
+		char self[PATH_MAX];
+		ssize_t length = readlink("/proc/self/exe", self, sizeof(self) - 1u);
+
+		if (length < 0)
+		{
+			snprintf(self, sizeof(self), "%s", argv0);
+		}
+		else
+		{
+			self[length] = '\0';
+		}
+		snprintf(path, sizeof(path), "%s/%s", dirname(self), HOST_SIM_DEVICE_LIBRARY);
+	}
+
+	if (!HostInstance_Load(path, options.devices))
+	{
+		printf("Cannot load the device image %s\n", path);
+		return false;
+	}
+
+	*(void **)&deviceApi.start = HostInstance_Symbol("HostDevice_Start");
+	*(void **)&deviceApi.run = HostInstance_Symbol("HostDevice_Run");
+	*(void **)&deviceApi.nextEvent = HostInstance_Symbol("HostDevice_NextEvent");
+	*(void **)&deviceApi.getStats = HostInstance_Symbol("HostDevice_GetStats");
+	if (!deviceApi.start || !deviceApi.run || !deviceApi.nextEvent || !deviceApi.getStats)
+	{
+		printf("%s is not a device image\n", path);
+		return false;
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief Places the devices, provisions them in the network and powers them on
+******************************************************************************/
+static bool startDevices(void)
+{
+	static const uint8_t joinEui[8] = {0x70, 0xB3, 0xD5, 0x7E, 0xD0, 0x00, 0x00, 0x01};
+	uint8_t maxSf = bandNames[bandIndex].maxSf;
+	char (*labels)[16] = calloc(options.devices, sizeof(*labels));
+
+	devices = calloc(options.devices, sizeof(HostSimDevice_t));
+	if ((NULL == devices) || (NULL == labels))
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < options.devices; i++)
+	{
+		HostDeviceConfig_t config;
+		HostSimDevice_t *dev = &devices[i];
+		double radius = options.radius * sqrt(randomUniform());
+		double angle = 2.0 * M_PI * randomUniform();
+		double rssi;
+
+		dev->x = radius * cos(angle);
+		dev->y = radius * sin(angle);
+		dev->pathLoss = pathLossAt(radius) + (options.shadowing * randomNormal());
+
+		memset(&config, 0, sizeof(config));
+		snprintf(labels[i], sizeof(labels[i]), "dev%u", (unsigned int)i);
+		config.label = labels[i];
+		config.band = options.band;
+		config.air = &sharedAir;
+		config.seed = (uint32_t)(randomUniform() * UINT32_MAX) | 1u;
+		config.cycles = 0;
+		config.startDelayMs = (uint32_t)(randomUniform() * options.joinWindowS * 1000.0);
+		config.intervalMs = options.intervalS * 1000u;
+		config.randomInterval = !options.fixedInterval;
+		config.payloadLength = options.payloadLength;
+		config.dataRate = HOST_DEVICE_DEFAULT_DATARATE;
+		config.abp = options.abp;
+		config.confirmed = options.confirmed;
+		config.dutyCycle = options.dutyCycle;
+		config.joinBackoff = options.joinBackoff;
+		config.verbose = options.verbose;
+
+		/* Lowest spreading factor closing the link with the margin, the
+		   choice an ADR capable network would converge to */
+		dev->sf = options.fixedSf;
+		if (0 == dev->sf)
+		{
+			rssi = HOST_SIM_DEVICE_POWER_DBM - dev->pathLoss;
+			for (dev->sf = HOST_SIM_MIN_SF; dev->sf < maxSf; dev->sf++)
+			{
+				if (rssi >= (sensitivity125[SF_INDEX(dev->sf)] + options.margin))
+				{
+					break;
+				}
+			}
+		}
+		config.spreadingFactor = dev->sf;
+
+		memcpy(config.joinEui, joinEui, sizeof(config.joinEui));
+		config.devEui[0] = 0x00;
+		config.devEui[1] = 0x04;
+		config.devEui[2] = 0xA3;
+		config.devEui[3] = 0x0B;
+		for (uint8_t b = 0; b < 4; b++)
+		{
+			config.devEui[4 + b] = (uint8_t)(i >> (24 - (8 * b)));
+		}
+		for (uint8_t b = 0; b < sizeof(config.appKey); b++)
+		{
+			config.appKey[b] = (uint8_t)(randomUniform() * 256.0);
+			config.nwkSKey[b] = (uint8_t)(randomUniform() * 256.0);
+			config.appSKey[b] = (uint8_t)(randomUniform() * 256.0);
+		}
+		config.devAddr = (HOST_SIM_NET_ID << 25) | 0x01000000u | i;
+
+		if ((options.abp && !HostNetwork_AddAbpDevice(config.devAddr, config.nwkSKey, config.appSKey)) ||
+			(!options.abp && !HostNetwork_AddOtaaDevice(config.devEui, config.joinEui, config.appKey)))
+		{
+			return false;
+		}
+
+		HostInstance_Select(i);
+		if (!deviceApi.start(&config))
+		{
+			printf("Device %u failed to start\n", (unsigned int)i);
+			return false;
+		}
+		dev->running = true;
+		pushEvent(deviceApi.nextEvent(), HOST_SIM_EVENT_DEVICE, i);
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief Runs the events of a device due at the current time
+******************************************************************************/
+static void runDevice(uint32_t index)
+{
+	uint64_t next;
+
+	HostInstance_Select(index);
+	deviceRuns++;
+	devices[index].running = deviceApi.run(simNow);
+	next = deviceApi.nextEvent();
+	if (devices[index].running && (HOST_CLOCK_NEVER != next))
+	{
+		pushEvent(next, HOST_SIM_EVENT_DEVICE, index);
+	}
+}
+
+static int compareTimes(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void report(double wallSeconds)
+{
+	static const uint8_t percentiles[] = {50, 90, 99, 100};
+	HostNetworkStats_t network;
+	HostSimUplinkStats_t total;
+	uint64_t *joinTimes = calloc(options.devices, sizeof(uint64_t));
+	uint64_t txTimeUs = 0;
+	uint64_t maxTxTimeUs = 0;
+	uint32_t joined = 0;
+	uint32_t dutyCycleWaits = 0;
+	uint32_t joinAttempts = 0;
+	uint32_t deviceDownlinks = 0;
+	double seconds = options.durationS;
+
+	memset(&total, 0, sizeof(total));
+	for (uint32_t i = 0; i < options.devices; i++)
+	{
+		HostDeviceStats_t stats;
+		SX1276ModelStats_t radio;
+
+		HostInstance_Select(i);
+		deviceApi.getStats(&stats, &radio);
+		joinAttempts += stats.joinAttempts;
+		dutyCycleWaits += stats.dutyCycleWaits;
+		deviceDownlinks += stats.downlinks;
+		txTimeUs += radio.txTimeUs;
+		if (radio.txTimeUs > maxTxTimeUs)
+		{
+			maxTxTimeUs = radio.txTimeUs;
+		}
+		if (joinTimes && (HOST_CLOCK_NEVER != stats.joinTimeUs))
+		{
+			joinTimes[joined++] = stats.joinTimeUs;
+		}
+	}
+	HostNetwork_GetStats(&network);
+
+	printf("devices          : %u, image %zu bytes\n", (unsigned int)options.devices, HostInstance_ImageSize());
+	printf("joined           : %u (%u join attempts, %u on air, %u accepted)\n", (unsigned int)joined,
+		(unsigned int)joinAttempts, (unsigned int)joinStats.sent, (unsigned int)network.joinAccepts);
+	if (joinTimes && joined)
+	{
+		qsort(joinTimes, joined, sizeof(uint64_t), compareTimes);
+		printf("join convergence :");
+		for (uint8_t p = 0; p < sizeof(percentiles); p++)
+		{
+			uint32_t n = (uint32_t)(((uint64_t)options.devices * percentiles[p] + 99u) / 100u);
+
+			if (n <= joined)
+			{
+				printf(" %u%% %.3f s", percentiles[p], joinTimes[(n ? n : 1u) - 1u] / 1e6);
+			}
+		}
+		printf("\n");
+	}
+	free(joinTimes);
+
+	printf("uplinks          :  SF     sent   received  below sens   no demod  gw tx  collision\n");
+	for (uint8_t sf = 0; sf < HOST_SIM_SF_COUNT; sf++)
+	{
+		const HostSimUplinkStats_t *s = &uplinkStats[sf];
+
+		total.sent += s->sent;
+		total.airtimeUs += s->airtimeUs;
+		for (uint8_t f = 0; f < HOST_SIM_FATE_COUNT; f++)
+		{
+			total.fate[f] += s->fate[f];
+		}
+		if (s->sent)
+		{
+			printf("                   %2u %8u %10u %11u %10u %6u %10u\n", sf + HOST_SIM_MIN_SF,
+				(unsigned int)s->sent, (unsigned int)s->fate[HOST_SIM_FATE_RECEIVED],
+				(unsigned int)s->fate[HOST_SIM_FATE_BELOW_SENSITIVITY],
+				(unsigned int)s->fate[HOST_SIM_FATE_NO_DEMODULATOR],
+				(unsigned int)s->fate[HOST_SIM_FATE_HALF_DUPLEX], (unsigned int)s->fate[HOST_SIM_FATE_COLLISION]);
+		}
+	}
+	printf("                  all %8u %10u %11u %10u %6u %10u\n", (unsigned int)total.sent,
+		(unsigned int)total.fate[HOST_SIM_FATE_RECEIVED], (unsigned int)total.fate[HOST_SIM_FATE_BELOW_SENSITIVITY],
+		(unsigned int)total.fate[HOST_SIM_FATE_NO_DEMODULATOR], (unsigned int)total.fate[HOST_SIM_FATE_HALF_DUPLEX],
+		(unsigned int)total.fate[HOST_SIM_FATE_COLLISION]);
+	printf("                 join %8u %10u %11u %10u %6u %10u\n", (unsigned int)joinStats.sent,
+		(unsigned int)joinStats.fate[HOST_SIM_FATE_RECEIVED], (unsigned int)joinStats.fate[HOST_SIM_FATE_BELOW_SENSITIVITY],
+		(unsigned int)joinStats.fate[HOST_SIM_FATE_NO_DEMODULATOR], (unsigned int)joinStats.fate[HOST_SIM_FATE_HALF_DUPLEX],
+		(unsigned int)joinStats.fate[HOST_SIM_FATE_COLLISION]);
+
+	total.sent += joinStats.sent;
+	total.airtimeUs += joinStats.airtimeUs;
+	total.fate[HOST_SIM_FATE_COLLISION] += joinStats.fate[HOST_SIM_FATE_COLLISION];
+	if (total.sent)
+	{
+		printf("collision rate   : %.4f\n", (double)total.fate[HOST_SIM_FATE_COLLISION] / total.sent);
+	}
+	printf("delivery ratio   : %.4f (%u of %u data uplinks at the network, %u MIC errors)\n",
+		(total.sent - joinStats.sent) ? (double)network.uplinks / (total.sent - joinStats.sent) : 0.0,
+		(unsigned int)network.uplinks, (unsigned int)(total.sent - joinStats.sent), (unsigned int)network.micErrors);
+	printf("goodput          : %.1f bit/s (%llu payload bytes)\n", (goodputBytes * 8.0) / seconds,
+		(unsigned long long)goodputBytes);
+	printf("channel load     : %.4f Erlang of uplink airtime\n", total.airtimeUs / (seconds * 1e6));
+	printf("downlinks        : %u sent, %u gateway busy, %u demodulated, %u lost by receivers, %u at the application\n",
+		(unsigned int)downlinksScheduled, (unsigned int)downlinksGatewayBusy, (unsigned int)downlinksDemodulated,
+		(unsigned int)downlinksLost, (unsigned int)deviceDownlinks);
+	printf("duty cycle       : %.4f%% mean, %.4f%% max, %u waits\n",
+		(100.0 * txTimeUs) / (seconds * 1e6 * options.devices), (100.0 * maxTxTimeUs) / (seconds * 1e6),
+		(unsigned int)dutyCycleWaits);
+	printf("virtual time     : %.3f s\n", seconds);
+	printf("wall time        : %.6f s\n", wallSeconds);
+	printf("device runs      : %llu, %llu image switches\n", (unsigned long long)deviceRuns,
+		(unsigned long long)HostInstance_Switches());
+}
+
+int main(int argc, char **argv)
+{
+	HostNetworkConfig_t networkConfig = {
+		.netId = HOST_SIM_NET_ID,
+		.rssi = SX1276_MODEL_NOISE_FLOOR_DBM,
+		.snr = 0
+	};
+	HostSimEvent_t ev;
+	uint64_t endTime;
+	struct timespec start;
+	struct timespec end;
+
+	parseOptions(argc, argv);
+	randomState = ((uint64_t)options.seed << 1) | 1u;
+	endTime = (uint64_t)options.durationS * 1000000uLL;
+
+	networkConfig.band = options.band;
+	networkConfig.downlinkPeriod = options.downlinkPeriod;
+	HostNetwork_Init(&networkConfig);
+
+	if (!loadDevices(argv[0]) || !startDevices())
+	{
+		return EXIT_FAILURE;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (popEvent(&ev) && (ev.due <= endTime))
+	{
+		if (ev.due > simNow)
+		{
+			simNow = ev.due;
+		}
+		if (HOST_SIM_EVENT_DEVICE == ev.kind)
+		{
+			runDevice(ev.id);
+		}
+		else
+		{
+			uplinkEnd(ev.id);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	report((end.tv_sec - start.tv_sec) + ((end.tv_nsec - start.tv_nsec) / 1e9));
+	HostInstance_Unload();
+	return EXIT_SUCCESS;
+}
+
+/* eof host_sim.c */
@@ -0,0 +1,530 @@
+/**
+* \file  host_toa.c
+*
+* \brief Validation of the integer time-on-air engine on the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <math.h>
+#include "lorawan.h"
+#include "lorawan_toa.h"
+#include "lorawan_reg_params.h"
+#include "radio_interface.h"
+#include "sw_timer.h"
+#include "host_nvm.h"
+#include "host_device.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Data rates probed in every band, the invalid ones must be refused */
+#define HOST_TOA_DATARATES              (16u)
+
+/* Preamble of the LoRaWAN frames, in symbols */
+#define HOST_TOA_PREAMBLE               (8u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Outcome of a comparison with the reference */
+typedef struct _HostToaResult
+{
+	uint64_t checked;
+	uint64_t exact;
+	/* Reference truncated one microsecond below its exact value */
+	uint64_t roundedDown;
+	uint64_t failed;
+} HostToaResult_t;
+
+typedef struct _HostToaOptions
+{
+	uint16_t maxPreamble;
+	bool verbose;
+} HostToaOptions_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostToaOptions_t options = {
+	.maxPreamble = 255,
+	.verbose = false
+};
+
+/* Names of the bands, in the order of IsmBand_t */
+static const char *const bandNames[] = {
+	"eu868", "eu433", "na915", "au915", "kr920", "jpn923", "brn923", "cmb923",
+	"ins923", "laos923", "nz923", "sp923", "twn923", "thai923", "vtm923", "ind865"
+};
+
+/* Keeps the timing loops from being optimized away */
+static volatile uint32_t sink;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static double referenceTimeOnAir(RadioModulation_t modulation, RadioDataRate_t sf,
+	RadioLoRaBandWidth_t bw, uint8_t preambleLen, uint8_t impHdrMode, uint8_t crcOn,
+	uint8_t cr, uint8_t length);
+static void compare(HostToaResult_t *result, uint32_t timeOnAir, double reference);
+static void printResult(const char *name, const HostToaResult_t *result);
+static bool checkLoRa(void);
+static bool checkLengths(void);
+static bool checkFsk(void);
+static bool checkDataRates(void);
+static void measure(void);
+static const char *bandName(IsmBand_t band);
+static uint64_t readNs(void);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options]\n"
+		"  -p <n>         largest preamble length of the sweep (default %u)\n"
+		"  -v             print every mismatch\n",
+		name, (unsigned int)options.maxPreamble);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "p:vh")))
+	{
+		switch (opt)
+		{
+			case 'p':
+				options.maxPreamble = (uint16_t)strtoul(optarg, NULL, 0);
+				if (options.maxPreamble > UINT8_MAX)
+				{
+					options.maxPreamble = UINT8_MAX;
+				}
+				break;
+			case 'v':
+				options.verbose = true;
+				break;
+			default:
+				usage(argv[0]);
+				exit((opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief The double precision time on air the MAC computed so far, unchanged
+       but for the modulation being passed in instead of looked up. The
+       LowDataRateOptimize decision takes the bandwidth of the data rate.
+\return Time on air in microseconds, before the truncation to an integer
+******************************************************************************/
+static double referenceTimeOnAir(RadioModulation_t modulation, RadioDataRate_t sf,
+	RadioLoRaBandWidth_t bw, uint8_t preambleLen, uint8_t impHdrMode, uint8_t crcOn,
+	uint8_t cr, uint8_t length)
+{
+	bool lowDataRateOptimize = false;
+	double bwHz, ts, tp, tmpDouble, time = 0.0;
+	uint32_t np;
+
+	if (MODULATION_LORA != modulation)
+	{
+		return (RADIO_PHY_FSK_PREAMBLE_BYTES_LENGTH + length) * 8 * 20;
+	}
+
+	if ((SF_12 == sf && (BW_125KHZ == bw || BW_250KHZ == bw)) || (SF_11 == sf && BW_125KHZ == bw))
+	{
+		lowDataRateOptimize = true;
+	}
+	bwHz = (BW_125KHZ == bw) ? 125000.0 : ((BW_250KHZ == bw) ? 250000.0 : 500000.0);
+
+	ts = 1 / (bwHz / (1 << sf));
+	tp = (preambleLen + 4.25) * ts;
+	tmpDouble = ((8 * length) - (4 * sf) + 28 + (16 * crcOn) - (impHdrMode ? 20 : 0));
+	tmpDouble /= (4 * (sf - (lowDataRateOptimize ? 2 : 0)));
+
+	/* A negative double converts to 0 on the Cortex-M0+ (__aeabi_d2uiz) */
+	np = (tmpDouble > 0.0) ? (uint32_t)tmpDouble : 0;
+	if ((tmpDouble - (double)np) > 0.0)
+	{
+		np += 1;
+	}
+	np *= (cr + 4);
+	np += 8;
+
+	time = (tp + (np * ts));
+	return MS_TO_US(1000 * time);
+}
+
+/**************************************************************************//**
+\brief Compares a time on air with the reference. The reference used to be
+       truncated, one microsecond less than its exact value when the product
+       ends just below an integer; that is the only difference allowed.
+******************************************************************************/
+static void compare(HostToaResult_t *result, uint32_t timeOnAir, double reference)
+{
+	uint32_t truncated = (uint32_t)reference;
+
+	result->checked++;
+	if (timeOnAir == truncated)
+	{
+		result->exact++;
+	}
+	else if ((timeOnAir == truncated + 1u) && ((uint32_t)llround(reference) == timeOnAir))
+	{
+		result->roundedDown++;
+	}
+	else
+	{
+		result->failed++;
+	}
+}
+
+static void printResult(const char *name, const HostToaResult_t *result)
+{
+	printf("%-16s : %llu checked, %llu exact, %llu reference rounded down, %llu failed\n", name,
+		(unsigned long long)result->checked, (unsigned long long)result->exact,
+		(unsigned long long)result->roundedDown, (unsigned long long)result->failed);
+}
+
+/**************************************************************************//**
+\brief Every LoRa spreading factor, bandwidth, coding rate, header mode, CRC,
+       preamble and payload length against the reference
+******************************************************************************/
+static bool checkLoRa(void)
+{
+	HostToaResult_t result = {0};
+
+	for (uint8_t sf = SF_7; sf <= SF_12; sf++)
+	{
+		for (uint8_t bw = BW_125KHZ; bw <= BW_500KHZ; bw++)
+		{
+			const LorawanToaLoRa_t *toa = LorawanToaGetLoRa((RadioDataRate_t)sf, (RadioLoRaBandWidth_t)bw);
+
+			for (uint8_t cr = CR_4_5; cr <= CR_4_8; cr++)
+			{
+				for (uint8_t flags = 0; flags < 4; flags++)
+				{
+					bool impHdrMode = (flags & 1u) != 0;
+					bool crcOn = (flags & 2u) != 0;
+
+					for (uint32_t preamble = 0; preamble <= options.maxPreamble; preamble++)
+					{
+						for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+						{
+							uint64_t failed = result.failed;
+							uint32_t timeOnAir = LorawanToaLoRaPacket(toa, (RadioDataRate_t)sf,
+								(RadioErrorCodingRate_t)cr, (uint16_t)preamble, impHdrMode, crcOn, (uint8_t)length);
+							double reference = referenceTimeOnAir(MODULATION_LORA, (RadioDataRate_t)sf,
+								(RadioLoRaBandWidth_t)bw, (uint8_t)preamble, impHdrMode, crcOn, cr, (uint8_t)length);
+
+							compare(&result, timeOnAir, reference);
+							if (options.verbose && (failed != result.failed))
+							{
+								printf("SF%u bw %u CR4/%u ih %u crc %u preamble %u length %u: %u us, reference %.3f us\n",
+									sf, bw, cr + 4u, impHdrMode, crcOn, preamble, length, timeOnAir, reference);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	printResult("lora", &result);
+	return 0 == result.failed;
+}
+
+/**************************************************************************//**
+\brief The longest payload within a time on air, at every step of the time on
+       air function and one microsecond below it
+******************************************************************************/
+static bool checkLengths(void)
+{
+	uint64_t checked = 0;
+	uint64_t failed = 0;
+
+	for (uint8_t sf = SF_7; sf <= SF_12; sf++)
+	{
+		for (uint8_t bw = BW_125KHZ; bw <= BW_500KHZ; bw++)
+		{
+			const LorawanToaLoRa_t *toa = LorawanToaGetLoRa((RadioDataRate_t)sf, (RadioLoRaBandWidth_t)bw);
+
+			for (uint8_t cr = CR_4_5; cr <= CR_4_8; cr++)
+			{
+				for (uint8_t flags = 0; flags < 4; flags++)
+				{
+					bool impHdrMode = (flags & 1u) != 0;
+					bool crcOn = (flags & 2u) != 0;
+					uint32_t times[LORAWAN_TOA_MAX_LENGTH + 1];
+
+					for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+					{
+						times[length] = LorawanToaLoRaPacket(toa, (RadioDataRate_t)sf, (RadioErrorCodingRate_t)cr,
+							HOST_TOA_PREAMBLE, impHdrMode, crcOn, (uint8_t)length);
+					}
+
+					for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+					{
+						for (uint32_t below = 0; below < 2; below++)
+						{
+							uint32_t budget = times[length] - below;
+							int16_t expected = -1;
+							int16_t maxLength = LorawanToaLoRaLength(toa, (RadioDataRate_t)sf,
+								(RadioErrorCodingRate_t)cr, HOST_TOA_PREAMBLE, impHdrMode, crcOn, budget);
+
+							while ((expected < (int16_t)LORAWAN_TOA_MAX_LENGTH) && (times[expected + 1] <= budget))
+							{
+								expected++;
+							}
+							checked++;
+							if (maxLength != expected)
+							{
+								failed++;
+								if (options.verbose)
+								{
+									printf("SF%u bw %u CR4/%u ih %u crc %u within %u us: %d bytes, expected %d\n",
+										sf, bw, cr + 4u, impHdrMode, crcOn, budget, maxLength, expected);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	printf("%-16s : %llu checked, %llu failed\n", "lora lengths", (unsigned long long)checked,
+		(unsigned long long)failed);
+	return 0 == failed;
+}
+
+/**************************************************************************//**
+\brief Every FSK payload length against the reference, and back
+******************************************************************************/
+static bool checkFsk(void)
+{
+	HostToaResult_t result = {0};
+
+	for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+	{
+		uint32_t timeOnAir = LorawanToaFskPacket((uint8_t)length);
+
+		compare(&result, timeOnAir, referenceTimeOnAir(MODULATION_FSK, SF_7, BW_125KHZ, 0, 0, 0, 0, (uint8_t)length));
+		if ((LorawanToaFskLength(timeOnAir) != (int16_t)length) ||
+			(LorawanToaFskLength(timeOnAir - 1u) != (int16_t)length - 1))
+		{
+			result.failed++;
+		}
+	}
+
+	printResult("fsk", &result);
+	return 0 == result.failed;
+}
+
+/**************************************************************************//**
+\brief Every data rate of every band through the interface of the MAC
+******************************************************************************/
+static bool checkDataRates(void)
+{
+	HostToaResult_t result = {0};
+	uint32_t bands = 0;
+
+	for (uint32_t band = ISM_EU868; band <= ISM_IND865; band++)
+	{
+		if (LORAWAN_SUCCESS != LORAWAN_Reset((IsmBand_t)band))
+		{
+			continue;
+		}
+		bands++;
+
+		for (uint8_t dr = 0; dr < HOST_TOA_DATARATES; dr++)
+		{
+			RadioModulation_t modulation;
+			RadioDataRate_t sf = SF_7;
+			RadioLoRaBandWidth_t bw = BW_125KHZ;
+			bool valid = (LORAWAN_SUCCESS == LORAREG_GetAttr(MODULATION_ATTR, &dr, &modulation));
+
+			/* The reserved LoRa data rates have neither a spreading factor nor a bandwidth */
+			if (valid && (MODULATION_LORA == modulation))
+			{
+				LORAREG_GetAttr(SPREADING_FACTOR_ATTR, &dr, &sf);
+				LORAREG_GetAttr(BANDWIDTH_ATTR, &dr, &bw);
+				valid = (sf >= SF_7) && (sf <= SF_12) && (bw >= BW_125KHZ) && (bw <= BW_500KHZ);
+			}
+
+			for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+			{
+				TimeOnAirParams_t params = {
+					.dr = dr,
+					.impHdrMode = 0,
+					.crcOn = 1,
+					.cr = CR_4_5,
+					.pktLen = (uint8_t)length,
+					.preambleLen = HOST_TOA_PREAMBLE
+				};
+				uint32_t timeOnAir = 0;
+				StackRetStatus_t status = LORAWAN_GetAttr(PACKET_TIME_ON_AIR, &params, &timeOnAir);
+
+				if (!valid)
+				{
+					result.checked++;
+					if (LORAWAN_INVALID_PARAMETER == status)
+					{
+						result.exact++;
+					}
+					else
+					{
+						result.failed++;
+					}
+					break;
+				}
+				if (LORAWAN_SUCCESS != status)
+				{
+					result.checked++;
+					result.failed++;
+					if (options.verbose && (0 == length))
+					{
+						printf("%-8s DR%-2u refused, status %d\n", bandName((IsmBand_t)band), dr, status);
+					}
+					continue;
+				}
+				compare(&result, timeOnAir, referenceTimeOnAir(modulation, sf, bw, HOST_TOA_PREAMBLE,
+					params.impHdrMode, params.crcOn, params.cr, params.pktLen));
+				if (options.verbose && (0 == length))
+				{
+					printf("%-8s DR%-2u %s SF%u bw %u: %u us empty\n",
+						bandName((IsmBand_t)band), dr,
+						(MODULATION_LORA == modulation) ? "lora" : "fsk ", sf, bw, timeOnAir);
+				}
+			}
+		}
+	}
+
+	printf("bands            : %u\n", (unsigned int)bands);
+	printResult("data rates", &result);
+	return 0 == result.failed;
+}
+
+/**************************************************************************//**
+\brief Host time per call of the engine and of the reference over one sweep.
+       The Cortex-M0+ has no FPU, the gap is much larger on the target.
+******************************************************************************/
+static void measure(void)
+{
+	const LorawanToaLoRa_t *toa = LorawanToaGetLoRa(SF_12, BW_125KHZ);
+	uint32_t calls = 0;
+	uint32_t sum = 0;
+	uint64_t engineNs;
+	uint64_t referenceNs;
+	uint64_t t0;
+
+	t0 = readNs();
+	for (uint32_t preamble = 0; preamble <= UINT8_MAX; preamble++)
+	{
+		for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+		{
+			sum += LorawanToaLoRaPacket(toa, SF_12, CR_4_5, (uint16_t)preamble, false, true, (uint8_t)length);
+			calls++;
+		}
+	}
+	engineNs = readNs() - t0;
+
+	t0 = readNs();
+	for (uint32_t preamble = 0; preamble <= UINT8_MAX; preamble++)
+	{
+		for (uint32_t length = 0; length <= LORAWAN_TOA_MAX_LENGTH; length++)
+		{
+			sum += (uint32_t)referenceTimeOnAir(MODULATION_LORA, SF_12, BW_125KHZ, (uint8_t)preamble, 0, 1,
+				CR_4_5, (uint8_t)length);
+		}
+	}
+	referenceNs = readNs() - t0;
+	sink = sum;
+
+	printf("time per call    : %.1f ns integer, %.1f ns double\n", (double)engineNs / calls,
+		(double)referenceNs / calls);
+}
+
+static const char *bandName(IsmBand_t band)
+{
+	return ((uint32_t)band < sizeof(bandNames) / sizeof(bandNames[0])) ? bandNames[band] : "?";
+}
+
+static uint64_t readNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000uLL) + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	HostDeviceConfig_t device = {
+		.label = NULL,
+		.band = ISM_EU868,
+		.seed = 1,
+		.intervalMs = UINT32_MAX / 2,
+		.dataRate = HOST_DEVICE_DEFAULT_DATARATE,
+		.abp = true
+	};
+	bool passed = true;
+
+	parseOptions(argc, argv);
+	HostNvm_Format();
+	if (!HostDevice_Start(&device))
+	{
+		printf("Initialization of the device failed\n");
+		return EXIT_FAILURE;
+	}
+
+	passed &= checkLoRa();
+	passed &= checkLengths();
+	passed &= checkFsk();
+	passed &= checkDataRates();
+	measure();
+
+	printf("%s\n", passed ? "PASSED" : "FAILED");
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof host_toa.c */
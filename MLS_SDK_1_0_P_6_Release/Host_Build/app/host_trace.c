@@ -0,0 +1,296 @@
+/**
+* \file  host_trace.c
+*
+* \brief Decoder of the stack event trace dumps into a timeline
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "system_trace.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Events counted by the summary, the application events share one counter */
+#define HOST_TRACE_EVENTS               (SYSTEM_TRACE_PDS_WRITE_DONE + 2u)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+typedef struct _HostTraceOptions
+{
+	const char *file;
+	bool summary;
+} HostTraceOptions_t;
+
+/* Decoding state carried across the records and dumps */
+typedef struct _HostTraceState
+{
+	uint64_t timeHigh;
+	uint32_t lastLow;
+	uint64_t lastTime;
+	/* Time of the last MAC state change and of the pending PDS write */
+	uint64_t macStateTime;
+	uint64_t pdsWriteTime;
+	uint64_t counts[HOST_TRACE_EVENTS];
+	uint64_t lost;
+} HostTraceState_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static HostTraceOptions_t options = {
+	.file = NULL,
+	.summary = false
+};
+
+/* LoRaMacState_t of lorawan_private.h */
+static const char *const macStateNames[] = {
+	"IDLE", "TRANSMISSION_OCCURRING", "BEFORE_RX1", "RX1_OPEN",
+	"BETWEEN_RX1_RX2", "RX2_OPEN", "RETRANSMISSION_DELAY", "ABP_DELAY"
+};
+
+static const char *const eventNames[HOST_TRACE_EVENTS] = {
+	"time", "lost", "radio", "mac", "timer", "pds", "pds", "app"
+};
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void usage(const char *name);
+static void parseOptions(int argc, char **argv);
+static bool decodeDump(FILE *file, HostTraceState_t *state);
+static void decodeRecord(const SYSTEM_TraceRecord_t *record, HostTraceState_t *state);
+static const char *macStateName(uint8_t state);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static void usage(const char *name)
+{
+	printf("usage: %s [options] <dump>\n"
+		"  -s             only print the number of events of each kind\n",
+		name);
+}
+
+static void parseOptions(int argc, char **argv)
+{
+	int opt;
+
+	while (-1 != (opt = getopt(argc, argv, "sh")))
+	{
+		switch (opt)
+		{
+			case 's':
+				options.summary = true;
+				break;
+			default:
+				usage(argv[0]);
+				exit((opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (optind != (argc - 1))
+	{
+		usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	options.file = argv[optind];
+}
+
+/**************************************************************************//**
+\brief Decodes the next dump of the file, the dumps of a device are written
+       one after the other
+\return false at the end of the file or on a malformed dump
+******************************************************************************/
+static bool decodeDump(FILE *file, HostTraceState_t *state)
+{
+	SYSTEM_TraceDumpHeader_t header;
+	SYSTEM_TraceRecord_t record;
+
+	if (1 != fread(&header, sizeof(header), 1, file))
+	{
+		return false;
+	}
+	if ((SYSTEM_TRACE_MAGIC != header.magic) || (SYSTEM_TRACE_VERSION != header.version) ||
+		(sizeof(SYSTEM_TraceRecord_t) != header.recordSize))
+	{
+		printf("malformed dump header\n");
+		return false;
+	}
+
+	/* The ring wrapped since the previous dump */
+	if (0 != header.lost)
+	{
+		state->lost += header.lost;
+		if (!options.summary)
+		{
+			printf("%38s %u records lost\n", "", (unsigned int)header.lost);
+		}
+	}
+
+	for (uint16_t i = 0; i < header.count; i++)
+	{
+		if (1 != fread(&record, sizeof(record), 1, file))
+		{
+			printf("truncated dump\n");
+			return false;
+		}
+		decodeRecord(&record, state);
+	}
+
+	return true;
+}
+
+/**************************************************************************//**
+\brief Rebuilds the system time of a record and prints it with the time
+       since the previous record
+******************************************************************************/
+static void decodeRecord(const SYSTEM_TraceRecord_t *record, HostTraceState_t *state)
+{
+	uint64_t time;
+	uint8_t kind = (record->event < SYSTEM_TRACE_APP) ? record->event : (HOST_TRACE_EVENTS - 1u);
+
+	if (kind >= HOST_TRACE_EVENTS)
+	{
+		kind = SYSTEM_TRACE_LOST;
+	}
+	state->counts[kind]++;
+
+	if (SYSTEM_TRACE_TIME_HIGH == record->event)
+	{
+		state->timeHigh = (uint64_t)record->arg2 << 32;
+		state->lastLow = 0;
+		return;
+	}
+	if (SYSTEM_TRACE_LOST == record->event)
+	{
+		state->lost++;
+		if (!options.summary)
+		{
+			printf("%38s record overwritten during the dump\n", "");
+		}
+		return;
+	}
+
+	/* The time high record is missing if it was overwritten: unwrap */
+	if (record->time < state->lastLow)
+	{
+		state->timeHigh += (uint64_t)1 << 32;
+	}
+	state->lastLow = record->time;
+	time = state->timeHigh | record->time;
+
+	if (!options.summary)
+	{
+		printf("%14.6f s %+12.6f s  %-6s ", time / 1e6,
+			(state->lastTime ? (double)(time - state->lastTime) : 0.0) / 1e6, eventNames[kind]);
+		switch (record->event)
+		{
+			case SYSTEM_TRACE_RADIO_DIO:
+				printf("DIO%u\n", record->arg0);
+				break;
+			case SYSTEM_TRACE_MAC_STATE:
+				printf("%s -> %s after %.3f ms\n", macStateName((uint8_t)record->arg1),
+					macStateName(record->arg0), (time - state->macStateTime) / 1e3);
+				break;
+			case SYSTEM_TRACE_TIMER_EXPIRY:
+				printf("timer %u expired, callback 0x%08x\n", record->arg0, (unsigned int)record->arg2);
+				break;
+			case SYSTEM_TRACE_PDS_WRITE:
+				printf("file %u written\n", record->arg0);
+				break;
+			case SYSTEM_TRACE_PDS_WRITE_DONE:
+				printf("file %u done, status %u, %.3f ms\n", record->arg0, record->arg1,
+					(time - state->pdsWriteTime) / 1e3);
+				break;
+			default:
+				printf("event 0x%02x: %u %u %u\n", record->event, record->arg0, record->arg1,
+					(unsigned int)record->arg2);
+				break;
+		}
+	}
+
+	if (SYSTEM_TRACE_MAC_STATE == record->event)
+	{
+		state->macStateTime = time;
+	}
+	else if (SYSTEM_TRACE_PDS_WRITE == record->event)
+	{
+		state->pdsWriteTime = time;
+	}
+	state->lastTime = time;
+}
+
+static const char *macStateName(uint8_t state)
+{
+	return (state < sizeof(macStateNames) / sizeof(macStateNames[0])) ? macStateNames[state] : "?";
+}
+
+int main(int argc, char **argv)
+{
+	HostTraceState_t state;
+	FILE *file;
+
+	parseOptions(argc, argv);
+	file = fopen(options.file, "rb");
+	if (NULL == file)
+	{
+		printf("Cannot open %s\n", options.file);
+		return EXIT_FAILURE;
+	}
+
+	memset(&state, 0, sizeof(state));
+	while (decodeDump(file, &state))
+	{
+	}
+	fclose(file);
+
+	for (uint8_t kind = SYSTEM_TRACE_RADIO_DIO; kind < HOST_TRACE_EVENTS; kind++)
+	{
+		if (SYSTEM_TRACE_PDS_WRITE_DONE != kind)
+		{
+			printf("%-16s : %llu\n", eventNames[kind], (unsigned long long)state.counts[kind]);
+		}
+	}
+	printf("%-16s : %llu\n", "lost", (unsigned long long)state.lost);
+
+	return EXIT_SUCCESS;
+}
+
+/* eof host_trace.c */
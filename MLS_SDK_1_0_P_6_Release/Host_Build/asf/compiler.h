@@ -0,0 +1,104 @@
+/**
+* \file  compiler.h
+*
+* \brief Host replacement for the ASF compiler abstraction header
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef UTILS_COMPILER_H_INCLUDED
+#define UTILS_COMPILER_H_INCLUDED
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "parts.h"
+#include "io.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define COMPILER_PRAGMA(arg)            _Pragma(#arg)
+#define COMPILER_PACK_SET(alignment)    COMPILER_PRAGMA(pack(alignment))
+#define COMPILER_PACK_RESET()           COMPILER_PRAGMA(pack())
+#define COMPILER_WORD_ALIGNED           __attribute__((__aligned__(4)))
+#define COMPILER_ALIGNED(a)             __attribute__((__aligned__(a)))
+
+#ifndef UNUSED
+#define UNUSED(v)                       (void)(v)
+#endif
+
+#define Assert(expr)                    ((void) 0)
+
+#ifndef Min
+#define Min(a, b)                       (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef Max
+#define Max(a, b)                       (((a) > (b)) ? (a) : (b))
+#endif
+
+/* Interrupt control maps onto the host interrupt emulation (host_irq.c) */
+typedef uint32_t irqflags_t;
+
+void host_irq_enable(void);
+void host_irq_disable(void);
+irqflags_t cpu_irq_save(void);
+void cpu_irq_restore(irqflags_t flags);
+void cpu_irq_enter_critical(void);
+void cpu_irq_leave_critical(void);
+
+#define cpu_irq_enable()                host_irq_enable()
+#define cpu_irq_disable()               host_irq_disable()
+#define Enable_global_interrupt()       host_irq_enable()
+#define Disable_global_interrupt()      host_irq_disable()
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**
+ * \brief Converts a 4 byte array into a 32-bit value (little endian)
+ * \param[in] data Pointer to the 4 byte array
+ * \return 32-bit value
+ */
+static inline uint32_t convert_byte_array_to_32_bit(uint8_t *data)
+{
+	return ((uint32_t)data[0]) | ((uint32_t)data[1] << 8) |
+	       ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+#endif /* UTILS_COMPILER_H_INCLUDED */
+
+/* eof compiler.h */
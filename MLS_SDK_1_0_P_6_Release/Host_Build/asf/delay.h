@@ -0,0 +1,63 @@
+/**
+* \file  delay.h
+*
+* \brief Host replacement for the ASF delay service
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef DELAY_H_INCLUDED
+#define DELAY_H_INCLUDED
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**
+ * \brief Advances the host virtual clock by the given number of microseconds
+ *        while servicing any emulated interrupt that falls into the delay
+ * \param[in] us Delay in microseconds
+ */
+void HostClock_Delay(uint64_t us);
+
+#define delay_init()        ((void) 0)
+#define delay_us(us)        HostClock_Delay((uint64_t)(us))
+#define delay_ms(ms)        HostClock_Delay((uint64_t)(ms) * 1000u)
+#define delay_s(s)          HostClock_Delay((uint64_t)(s) * 1000000u)
+
+#endif /* DELAY_H_INCLUDED */
+
+/* eof delay.h */
@@ -0,0 +1,104 @@
+/**
+* \file  nvm.h
+*
+* \brief Host replacement for the SAM0 NVM controller driver header
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef NVM_H_INCLUDED
+#define NVM_H_INCLUDED
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include "status_codes.h"
+#include "io.h"
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* NVM controller parameters */
+struct nvm_parameters {
+	/** Number of bytes per page */
+	uint8_t  page_size;
+	/** Number of pages in the main array */
+	uint16_t nvm_number_of_pages;
+	/** Size of the emulated EEPROM memory section */
+	uint32_t eeprom_number_of_pages;
+	/** Size of the Bootloader memory section */
+	uint32_t bootloader_number_of_pages;
+	/** Number of pages in read while write EEPROM (RWWEE) emulation area */
+	uint16_t rww_eeprom_number_of_pages;
+};
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**
+ * \brief Reads the parameters of the emulated NVM controller
+ * \param[out] parameters Parameters of the NVM controller
+ */
+void nvm_get_parameters(struct nvm_parameters *const parameters);
+
+/**
+ * \brief Erases a row of the emulated NVM
+ * \param[in] row_address Address of the row to be erased
+ * \return STATUS_OK on success, STATUS_ERR_BAD_ADDRESS otherwise
+ */
+enum status_code nvm_erase_row(const uint32_t row_address);
+
+/**
+ * \brief Reads a number of bytes from a page of the emulated NVM
+ * \param[in] source_address Source address within the NVM
+ * \param[out] buffer Destination buffer
+ * \param[in] length Number of bytes to read (at most one page)
+ * \return STATUS_OK on success, STATUS_ERR_BAD_ADDRESS otherwise
+ */
+enum status_code nvm_read_buffer(const uint32_t source_address,
+		uint8_t *const buffer, uint16_t length);
+
+/**
+ * \brief Programs a number of bytes into a page of the emulated NVM. Like
+ *        the flash array, programming can only clear bits.
+ * \param[in] destination_address Destination address within the NVM
+ * \param[in] buffer Source buffer
+ * \param[in] length Number of bytes to program (at most one page)
+ * \return STATUS_OK on success, STATUS_ERR_BAD_ADDRESS otherwise
+ */
+enum status_code nvm_write_buffer(const uint32_t destination_address,
+		const uint8_t *buffer, uint16_t length);
+
+#endif /* NVM_H_INCLUDED */
+
+/* eof nvm.h */
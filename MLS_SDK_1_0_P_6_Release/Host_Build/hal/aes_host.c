@@ -0,0 +1,408 @@
+/**
+* \file  aes_host.c
+*
+* \brief Host model of the AES peripheral (AES-128 ECB)
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "aes_engine.h"
+#include "host_aes.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define AES_ROUNDS                  10
+#define AES_KEY_SCHEDULE_SIZE       (BLOCKSIZE * (AES_ROUNDS + 1))
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+static const uint8_t sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+/* Inverse S-box, built from sbox on first use */
+static uint8_t invSbox[256];
+static uint8_t invSboxReady;
+
+/* Number of processed blocks */
+static uint32_t blockCount;
+
+/* Number of key expansions, each one models a key load of the peripheral */
+static uint32_t keyLoadCount;
+
+#ifndef AES_SW_ENGINE
+/* Key of the session and its schedule */
+static uint8_t sessionKey[BLOCKSIZE];
+static uint8_t sessionSchedule[AES_KEY_SCHEDULE_SIZE];
+static bool sessionLoaded;
+#endif
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static uint8_t xtime(uint8_t x);
+static uint8_t gmul(uint8_t a, uint8_t b);
+static void expandKey(const uint8_t *key, uint8_t *schedule);
+static void addRoundKey(uint8_t *state, const uint8_t *roundKey);
+static void encryptBlock(uint8_t *block, const uint8_t *key);
+static void cipherBlock(uint8_t *block, const uint8_t *schedule);
+#ifndef AES_SW_ENGINE
+static void sessionLoad(void);
+#endif
+static void buildInvSbox(void);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static uint8_t xtime(uint8_t x)
+{
+	return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static uint8_t gmul(uint8_t a, uint8_t b)
+{
+	uint8_t p = 0;
+
+	while (b)
+	{
+		if (b & 1)
+		{
+			p ^= a;
+		}
+		a = xtime(a);
+		b >>= 1;
+	}
+	return p;
+}
+
+static void expandKey(const uint8_t *key, uint8_t *schedule)
+{
+	uint8_t rcon = 0x01;
+	uint8_t t[4];
+
+	memcpy(schedule, key, BLOCKSIZE);
+	for (uint8_t i = BLOCKSIZE; i < AES_KEY_SCHEDULE_SIZE; i += 4)
+	{
+		memcpy(t, &schedule[i - 4], 4);
+		if (0 == (i % BLOCKSIZE))
+		{
+			uint8_t first = t[0];
+			t[0] = sbox[t[1]] ^ rcon;
+			t[1] = sbox[t[2]];
+			t[2] = sbox[t[3]];
+			t[3] = sbox[first];
+			rcon = xtime(rcon);
+		}
+		for (uint8_t j = 0; j < 4; j++)
+		{
+			schedule[i + j] = schedule[i + j - BLOCKSIZE] ^ t[j];
+		}
+	}
+}
+
+static void addRoundKey(uint8_t *state, const uint8_t *roundKey)
+{
+	for (uint8_t i = 0; i < BLOCKSIZE; i++)
+	{
+		state[i] ^= roundKey[i];
+	}
+}
+
+#ifndef AES_SW_ENGINE
+/**
+ * \brief Initializes the AES Engine.
+ */
+void AESInit(void)
+{
+	buildInvSbox();
+	sessionLoaded = false;
+}
+#endif
+
+/**************************************************************************//**
+\brief Builds the inverse S-box on first use
+******************************************************************************/
+static void buildInvSbox(void)
+{
+	if (!invSboxReady)
+	{
+		for (uint16_t i = 0; i < 256; i++)
+		{
+			invSbox[sbox[i]] = (uint8_t)i;
+		}
+		invSboxReady = 1;
+	}
+}
+
+/**************************************************************************//**
+\brief Encrypts a single block with AES-128
+******************************************************************************/
+static void encryptBlock(uint8_t *block, const uint8_t *key)
+{
+	uint8_t schedule[AES_KEY_SCHEDULE_SIZE];
+
+	/* Like the peripheral, the key is loaded for every block */
+	expandKey(key, schedule);
+	cipherBlock(block, schedule);
+}
+
+/**************************************************************************//**
+\brief Encrypts a single block with an expanded key
+******************************************************************************/
+static void cipherBlock(uint8_t *block, const uint8_t *schedule)
+{
+	uint8_t tmp[BLOCKSIZE];
+
+	addRoundKey(block, schedule);
+
+	for (uint8_t round = 1; round <= AES_ROUNDS; round++)
+	{
+		/* SubBytes and ShiftRows */
+		for (uint8_t i = 0; i < BLOCKSIZE; i++)
+		{
+			tmp[i] = sbox[block[(i + 4 * (i % 4)) % BLOCKSIZE]];
+		}
+
+		/* MixColumns, skipped in the last round */
+		if (AES_ROUNDS != round)
+		{
+			for (uint8_t c = 0; c < BLOCKSIZE; c += 4)
+			{
+				uint8_t a0 = tmp[c], a1 = tmp[c + 1], a2 = tmp[c + 2], a3 = tmp[c + 3];
+				uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+				block[c]     = a0 ^ all ^ xtime(a0 ^ a1);
+				block[c + 1] = a1 ^ all ^ xtime(a1 ^ a2);
+				block[c + 2] = a2 ^ all ^ xtime(a2 ^ a3);
+				block[c + 3] = a3 ^ all ^ xtime(a3 ^ a0);
+			}
+		}
+		else
+		{
+			memcpy(block, tmp, BLOCKSIZE);
+		}
+
+		addRoundKey(block, &schedule[round * BLOCKSIZE]);
+	}
+}
+
+/* With AES_SW_ENGINE the stack runs on the software engine of the stack
+ * sources, the model only serves the network server emulation */
+#ifndef AES_SW_ENGINE
+/**
+ * \brief Encrypts the given block of data
+ * \param[in,out] block Block of input data to be encrypted
+ * \param[in] key Cryptographic key to be used in AES encryption
+ */
+void AESEncode(unsigned char* block, unsigned char* key)
+{
+	encryptBlock(block, key);
+	blockCount++;
+	keyLoadCount++;
+}
+
+/**
+ * \brief Starts an AES session, the key is expanded on the first session call
+ * \param[in] key Cryptographic key to be used in AES encryption
+ */
+void AESSessionStart(unsigned char* key)
+{
+	if (memcmp(sessionKey, key, BLOCKSIZE))
+	{
+		memcpy(sessionKey, key, BLOCKSIZE);
+		sessionLoaded = false;
+	}
+}
+
+/**
+ * \brief Encrypts whole blocks in place with the key of the session (ECB)
+ * \param[in,out] blocks Blocks of input data to be encrypted
+ * \param[in] count Number of blocks
+ */
+void AESSessionEncode(unsigned char* blocks, uint16_t count)
+{
+	sessionLoad();
+	for (uint16_t i = 0; i < count; i++)
+	{
+		cipherBlock(&blocks[i * BLOCKSIZE], sessionSchedule);
+	}
+	blockCount += count;
+}
+
+/**
+ * \brief Encrypts or decrypts a buffer in counter mode with the key of the
+ *        session, the counter is 16 bits like the one of the peripheral
+ * \param[out] output Result, length bytes
+ * \param[in] input Data to be encrypted or decrypted, length bytes
+ * \param[in] length Length of the data in bytes
+ * \param[in] counter Counter block of the first block
+ */
+void AESSessionCtr(unsigned char* output, unsigned char* input, uint16_t length, unsigned char* counter)
+{
+	uint8_t block[BLOCKSIZE];
+	uint16_t count = (uint16_t)((counter[BLOCKSIZE - 2] << 8) | counter[BLOCKSIZE - 1]);
+
+	sessionLoad();
+	for (uint16_t offset = 0; offset < length; offset += BLOCKSIZE)
+	{
+		uint16_t size = ((length - offset) < BLOCKSIZE) ? (uint16_t)(length - offset) : BLOCKSIZE;
+
+		memcpy(block, counter, BLOCKSIZE - 2);
+		block[BLOCKSIZE - 2] = (uint8_t)(count >> 8);
+		block[BLOCKSIZE - 1] = (uint8_t)count;
+		cipherBlock(block, sessionSchedule);
+		for (uint16_t i = 0; i < size; i++)
+		{
+			output[offset + i] = input[offset + i] ^ block[i];
+		}
+		count++;
+		blockCount++;
+	}
+}
+
+/**
+ * \brief Chains whole blocks through the cipher with the key of the session
+ *        (CBC-MAC): chain = E(chain ^ block) for every block
+ * \param[in,out] chain Chaining value, all zeros to start a MAC
+ * \param[in] input Blocks to be chained
+ * \param[in] count Number of blocks
+ */
+void AESSessionCbcMac(unsigned char* chain, unsigned char* input, uint16_t count)
+{
+	sessionLoad();
+	for (uint16_t i = 0; i < count; i++)
+	{
+		addRoundKey(chain, &input[i * BLOCKSIZE]);
+		cipherBlock(chain, sessionSchedule);
+	}
+	blockCount += count;
+}
+
+/**************************************************************************//**
+\brief Expands the key of the session unless it is already
+******************************************************************************/
+static void sessionLoad(void)
+{
+	if (!sessionLoaded)
+	{
+		expandKey(sessionKey, sessionSchedule);
+		sessionLoaded = true;
+		keyLoadCount++;
+	}
+}
+#endif
+
+/**************************************************************************//**
+\brief Encrypts a single block with AES-128 without accounting it
+******************************************************************************/
+void HostAes_Encrypt(uint8_t *block, const uint8_t *key)
+{
+	encryptBlock(block, key);
+}
+
+/**************************************************************************//**
+\brief Decrypts a single block with AES-128
+******************************************************************************/
+void HostAes_Decrypt(uint8_t *block, const uint8_t *key)
+{
+	uint8_t schedule[AES_KEY_SCHEDULE_SIZE];
+	uint8_t tmp[BLOCKSIZE];
+
+	buildInvSbox();
+	expandKey(key, schedule);
+	addRoundKey(block, &schedule[AES_ROUNDS * BLOCKSIZE]);
+
+	for (uint8_t round = AES_ROUNDS; round > 0; round--)
+	{
+		/* InvShiftRows and InvSubBytes */
+		for (uint8_t i = 0; i < BLOCKSIZE; i++)
+		{
+			tmp[(i + 4 * (i % 4)) % BLOCKSIZE] = invSbox[block[i]];
+		}
+		memcpy(block, tmp, BLOCKSIZE);
+
+		addRoundKey(block, &schedule[(round - 1) * BLOCKSIZE]);
+
+		/* InvMixColumns, skipped after the first round key */
+		if (1 != round)
+		{
+			for (uint8_t c = 0; c < BLOCKSIZE; c += 4)
+			{
+				uint8_t a0 = block[c], a1 = block[c + 1], a2 = block[c + 2], a3 = block[c + 3];
+				block[c]     = gmul(a0, 14) ^ gmul(a1, 11) ^ gmul(a2, 13) ^ gmul(a3, 9);
+				block[c + 1] = gmul(a0, 9) ^ gmul(a1, 14) ^ gmul(a2, 11) ^ gmul(a3, 13);
+				block[c + 2] = gmul(a0, 13) ^ gmul(a1, 9) ^ gmul(a2, 14) ^ gmul(a3, 11);
+				block[c + 3] = gmul(a0, 11) ^ gmul(a1, 13) ^ gmul(a2, 9) ^ gmul(a3, 14);
+			}
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Returns the number of blocks processed by the AES model
+******************************************************************************/
+uint32_t HostAes_GetBlockCount(void)
+{
+	return blockCount;
+}
+
+/**************************************************************************//**
+\brief Returns the number of keys loaded by the AES model
+******************************************************************************/
+uint32_t HostAes_GetKeyLoadCount(void)
+{
+	return keyLoadCount;
+}
+
+/* eof aes_host.c */
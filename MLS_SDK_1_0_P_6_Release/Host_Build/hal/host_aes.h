@@ -0,0 +1,83 @@
+/**
+* \file  host_aes.h
+*
+* \brief Host model of the AES peripheral
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_AES_H
+#define HOST_AES_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Encrypts a single block with AES-128. Unlike AESEncode() the block is
+       not accounted, so that the host side network server emulation does not
+       show up in the statistics of the device.
+\param[in,out] block Block of data to be encrypted
+\param[in] key Cryptographic key
+******************************************************************************/
+void HostAes_Encrypt(uint8_t *block, const uint8_t *key);
+
+/**************************************************************************//**
+\brief Decrypts a single block with AES-128. The stack itself never needs the
+       inverse cipher; it is used by the host side network server emulation
+       to build join-accept frames.
+\param[in,out] block Block of data to be decrypted
+\param[in] key Cryptographic key
+******************************************************************************/
+void HostAes_Decrypt(uint8_t *block, const uint8_t *key);
+
+/**************************************************************************//**
+\brief Returns the number of blocks encrypted through AESEncode() and the
+       session calls
+\return Block count
+******************************************************************************/
+uint32_t HostAes_GetBlockCount(void);
+
+/**************************************************************************//**
+\brief Returns the number of keys loaded into the AES model: one per block
+       through AESEncode(), one per key change of the session calls
+\return Key load count
+******************************************************************************/
+uint32_t HostAes_GetKeyLoadCount(void);
+
+#endif /* HOST_AES_H */
+
+/* eof host_aes.h */
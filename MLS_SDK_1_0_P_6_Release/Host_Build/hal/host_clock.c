@@ -0,0 +1,243 @@
+/**
+* \file  host_clock.c
+*
+* \brief Virtual microsecond clock and interrupt event queue of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stddef.h>
+#include "host_clock.h"
+#include "host_irq.h"
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* Current virtual time in microseconds */
+static uint64_t hostClockNow;
+
+/* Waiting functions never advance the clock beyond this point */
+static uint64_t hostClockHorizon = HOST_CLOCK_NEVER;
+
+/* Pending events sorted by due time */
+static HostClockEvent_t *pendingHead;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void runDueEvents(void);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**************************************************************************//**
+\brief Runs every pending event that is due at the current time
+******************************************************************************/
+static void runDueEvents(void)
+{
+	HostClockEvent_t *ev;
+
+	while (pendingHead && (pendingHead->due <= hostClockNow) && HostIrq_CanRun())
+	{
+		ev = pendingHead;
+		pendingHead = ev->next;
+		ev->next = NULL;
+		ev->armed = false;
+
+		HostIrq_Enter();
+		ev->handler(ev->ctx);
+		HostIrq_Exit();
+	}
+}
+
+/**************************************************************************//**
+\brief Resets the virtual clock to zero and drops every pending event
+******************************************************************************/
+void HostClock_Reset(void)
+{
+	while (pendingHead)
+	{
+		HostClock_Disarm(pendingHead);
+	}
+	hostClockNow = 0;
+	hostClockHorizon = HOST_CLOCK_NEVER;
+}
+
+/**************************************************************************//**
+\brief Returns the current virtual time
+******************************************************************************/
+uint64_t HostClock_Now(void)
+{
+	return hostClockNow;
+}
+
+/**************************************************************************//**
+\brief Initializes an event with its interrupt handler
+******************************************************************************/
+void HostClock_InitEvent(HostClockEvent_t *ev, HostClockHandler_t handler, void *ctx)
+{
+	ev->due = HOST_CLOCK_NEVER;
+	ev->handler = handler;
+	ev->ctx = ctx;
+	ev->armed = false;
+	ev->next = NULL;
+}
+
+/**************************************************************************//**
+\brief Arms (or re-arms) an event at an absolute virtual time
+******************************************************************************/
+void HostClock_Arm(HostClockEvent_t *ev, uint64_t due)
+{
+	HostClockEvent_t **link = &pendingHead;
+
+	if (ev->armed)
+	{
+		HostClock_Disarm(ev);
+	}
+
+	/* Events with equal due time keep their arming order */
+	while (*link && ((*link)->due <= due))
+	{
+		link = &(*link)->next;
+	}
+
+	ev->due = due;
+	ev->armed = true;
+	ev->next = *link;
+	*link = ev;
+}
+
+/**************************************************************************//**
+\brief Removes an event from the pending list
+******************************************************************************/
+void HostClock_Disarm(HostClockEvent_t *ev)
+{
+	HostClockEvent_t **link = &pendingHead;
+
+	if (!ev->armed)
+	{
+		return;
+	}
+
+	while (*link && (*link != ev))
+	{
+		link = &(*link)->next;
+	}
+
+	if (*link)
+	{
+		*link = ev->next;
+	}
+	ev->next = NULL;
+	ev->armed = false;
+}
+
+/**************************************************************************//**
+\brief Returns the virtual time of the earliest pending event
+******************************************************************************/
+uint64_t HostClock_NextDue(void)
+{
+	return pendingHead ? pendingHead->due : HOST_CLOCK_NEVER;
+}
+
+/**************************************************************************//**
+\brief Limits how far the clock may be advanced by waiting functions
+******************************************************************************/
+void HostClock_SetHorizon(uint64_t horizon)
+{
+	hostClockHorizon = horizon;
+}
+
+/**************************************************************************//**
+\brief Advances the clock to the earliest pending event and runs it
+******************************************************************************/
+bool HostClock_WaitForInterrupt(void)
+{
+	uint64_t next = HostClock_NextDue();
+
+	if ((HOST_CLOCK_NEVER == next) || (next > hostClockHorizon))
+	{
+		if ((HOST_CLOCK_NEVER != hostClockHorizon) && (hostClockHorizon > hostClockNow))
+		{
+			hostClockNow = hostClockHorizon;
+		}
+		return false;
+	}
+
+	if (next > hostClockNow)
+	{
+		hostClockNow = next;
+	}
+	runDueEvents();
+	return true;
+}
+
+/**************************************************************************//**
+\brief Advances the clock to the given time, running every due event
+******************************************************************************/
+void HostClock_AdvanceTo(uint64_t time)
+{
+	while (pendingHead && (pendingHead->due <= time) && HostIrq_CanRun())
+	{
+		if (pendingHead->due > hostClockNow)
+		{
+			hostClockNow = pendingHead->due;
+		}
+		runDueEvents();
+	}
+
+	if (time > hostClockNow)
+	{
+		hostClockNow = time;
+	}
+}
+
+/**************************************************************************//**
+\brief Busy waits for the given duration, servicing due interrupts
+******************************************************************************/
+void HostClock_Delay(uint64_t us)
+{
+	HostClock_AdvanceTo(hostClockNow + us);
+}
+
+/**************************************************************************//**
+\brief Runs the events that became due while interrupts were masked
+******************************************************************************/
+void HostClock_ServicePending(void)
+{
+	runDueEvents();
+}
+
+/* eof host_clock.c */
@@ -0,0 +1,156 @@
+/**
+* \file  host_clock.h
+*
+* \brief Virtual microsecond clock and interrupt event queue of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* Time value meaning "no event pending" */
+#define HOST_CLOCK_NEVER            (UINT64_MAX)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Handler executed in emulated interrupt context when an event is due */
+typedef void (*HostClockHandler_t)(void *ctx);
+
+/*
+* An emulated interrupt source. The structure is owned by the peripheral
+* model; the clock only links it into its sorted pending list.
+*/
+typedef struct _HostClockEvent
+{
+	/* Virtual time in microseconds at which the handler is run */
+	uint64_t due;
+
+	/* Interrupt handler */
+	HostClockHandler_t handler;
+
+	/* Argument passed to the handler */
+	void *ctx;
+
+	/* Whether the event is linked into the pending list */
+	bool armed;
+
+	/* Next pending event */
+	struct _HostClockEvent *next;
+} HostClockEvent_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Resets the virtual clock to zero and drops every pending event
+******************************************************************************/
+void HostClock_Reset(void);
+
+/**************************************************************************//**
+\brief Returns the current virtual time
+\return Virtual time in microseconds
+******************************************************************************/
+uint64_t HostClock_Now(void);
+
+/**************************************************************************//**
+\brief Initializes an event with its interrupt handler
+\param[in] ev Event to be initialized
+\param[in] handler Handler run when the event is due
+\param[in] ctx Argument for the handler
+******************************************************************************/
+void HostClock_InitEvent(HostClockEvent_t *ev, HostClockHandler_t handler, void *ctx);
+
+/**************************************************************************//**
+\brief Arms (or re-arms) an event at an absolute virtual time
+\param[in] ev Event to be armed
+\param[in] due Absolute virtual time in microseconds
+******************************************************************************/
+void HostClock_Arm(HostClockEvent_t *ev, uint64_t due);
+
+/**************************************************************************//**
+\brief Removes an event from the pending list
+\param[in] ev Event to be disarmed
+******************************************************************************/
+void HostClock_Disarm(HostClockEvent_t *ev);
+
+/**************************************************************************//**
+\brief Returns the virtual time of the earliest pending event
+\return Due time in microseconds or HOST_CLOCK_NEVER
+******************************************************************************/
+uint64_t HostClock_NextDue(void);
+
+/**************************************************************************//**
+\brief Limits how far the clock may be advanced by waiting functions.
+       An external scheduler uses this to keep instances in lock step.
+\param[in] horizon Absolute virtual time or HOST_CLOCK_NEVER
+******************************************************************************/
+void HostClock_SetHorizon(uint64_t horizon);
+
+/**************************************************************************//**
+\brief Advances the clock to the earliest pending event (within the horizon)
+       and runs every event due at that time. This is the host equivalent
+       of the WFI instruction.
+\return true if the clock has been advanced, false if nothing is pending
+******************************************************************************/
+bool HostClock_WaitForInterrupt(void);
+
+/**************************************************************************//**
+\brief Advances the clock to the given time, running every due event
+\param[in] time Absolute virtual time in microseconds
+******************************************************************************/
+void HostClock_AdvanceTo(uint64_t time);
+
+/**************************************************************************//**
+\brief Busy waits for the given duration, servicing due interrupts
+\param[in] us Delay in microseconds
+******************************************************************************/
+void HostClock_Delay(uint64_t us);
+
+/**************************************************************************//**
+\brief Runs the events that became due while interrupts were masked
+******************************************************************************/
+void HostClock_ServicePending(void);
+
+#endif /* HOST_CLOCK_H */
+
+/* eof host_clock.h */
@@ -0,0 +1,244 @@
+/**
+* \file  host_irq.c
+*
+* \brief Interrupt masking emulation of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include "compiler.h"
+#include "system_interrupt.h"
+#include "host_clock.h"
+#include "host_irq.h"
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* Global interrupt enable, the equivalent of PRIMASK being clear */
+static bool irqEnabled = true;
+
+/* Nesting depth of the critical sections */
+static uint32_t criticalNesting;
+
+/* Interrupt state at the entry of the outermost critical section */
+static bool criticalPrevState;
+
+/* Set while an emulated interrupt handler is executing */
+static bool inHandler;
+
+/* Number of interrupts serviced */
+static uint32_t irqCount;
+
+/* Cycle counter timing the masked sections, NULL when not measured */
+static uint64_t (*cycleCounter)(void);
+
+/* Counter value when the interrupts were masked */
+static uint64_t maskedSince;
+
+/* Longest masked section since the last HostIrq_TakeMaxMaskedCycles() */
+static uint64_t maxMaskedCycles;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void maskIrq(void);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**************************************************************************//**
+\brief Clears the emulated global interrupt enable
+******************************************************************************/
+static void maskIrq(void)
+{
+	if (irqEnabled && cycleCounter)
+	{
+		maskedSince = cycleCounter();
+	}
+	irqEnabled = false;
+}
+
+/**************************************************************************//**
+\brief Checks whether emulated interrupts may be taken right now
+******************************************************************************/
+bool HostIrq_CanRun(void)
+{
+	return irqEnabled && !inHandler;
+}
+
+/**************************************************************************//**
+\brief Marks the entry of an emulated interrupt handler
+******************************************************************************/
+void HostIrq_Enter(void)
+{
+	inHandler = true;
+	irqCount++;
+}
+
+/**************************************************************************//**
+\brief Marks the exit of an emulated interrupt handler
+******************************************************************************/
+void HostIrq_Exit(void)
+{
+	inHandler = false;
+}
+
+/**************************************************************************//**
+\brief Returns the number of emulated interrupts serviced so far
+******************************************************************************/
+uint32_t HostIrq_GetCount(void)
+{
+	return irqCount;
+}
+
+/**************************************************************************//**
+\brief Installs the cycle counter timing the sections with interrupts masked
+******************************************************************************/
+void HostIrq_SetCycleCounter(uint64_t (*counter)(void))
+{
+	cycleCounter = counter;
+	maxMaskedCycles = 0;
+	if (!irqEnabled && cycleCounter)
+	{
+		maskedSince = cycleCounter();
+	}
+}
+
+/**************************************************************************//**
+\brief Returns the longest section with interrupts masked and restarts
+******************************************************************************/
+uint64_t HostIrq_TakeMaxMaskedCycles(void)
+{
+	uint64_t cycles = maxMaskedCycles;
+
+	maxMaskedCycles = 0;
+	return cycles;
+}
+
+/**************************************************************************//**
+\brief Enables the emulated global interrupt
+******************************************************************************/
+void host_irq_enable(void)
+{
+	if (!irqEnabled && cycleCounter)
+	{
+		uint64_t cycles = cycleCounter() - maskedSince;
+
+		if (cycles > maxMaskedCycles)
+		{
+			maxMaskedCycles = cycles;
+		}
+	}
+	irqEnabled = true;
+	HostClock_ServicePending();
+}
+
+/**************************************************************************//**
+\brief Disables the emulated global interrupt
+******************************************************************************/
+void host_irq_disable(void)
+{
+	maskIrq();
+}
+
+/**************************************************************************//**
+\brief Saves the interrupt state and disables interrupts
+\return Interrupt state before the call
+******************************************************************************/
+irqflags_t cpu_irq_save(void)
+{
+	irqflags_t flags = irqEnabled ? 1 : 0;
+
+	maskIrq();
+	return flags;
+}
+
+/**************************************************************************//**
+\brief Restores a previously saved interrupt state
+\param[in] flags Interrupt state returned by cpu_irq_save()
+******************************************************************************/
+void cpu_irq_restore(irqflags_t flags)
+{
+	if (flags)
+	{
+		host_irq_enable();
+	}
+}
+
+/**************************************************************************//**
+\brief Enters a nested critical section
+******************************************************************************/
+void cpu_irq_enter_critical(void)
+{
+	if (0 == criticalNesting)
+	{
+		criticalPrevState = irqEnabled;
+		maskIrq();
+	}
+	criticalNesting++;
+}
+
+/**************************************************************************//**
+\brief Leaves a nested critical section
+******************************************************************************/
+void cpu_irq_leave_critical(void)
+{
+	if (criticalNesting)
+	{
+		criticalNesting--;
+		if ((0 == criticalNesting) && criticalPrevState)
+		{
+			host_irq_enable();
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Enters a critical section
+******************************************************************************/
+void system_interrupt_enter_critical_section(void)
+{
+	cpu_irq_enter_critical();
+}
+
+/**************************************************************************//**
+\brief Leaves a critical section
+******************************************************************************/
+void system_interrupt_leave_critical_section(void)
+{
+	cpu_irq_leave_critical();
+}
+
+/* eof host_irq.c */
@@ -0,0 +1,87 @@
+/**
+* \file  host_irq.h
+*
+* \brief Interrupt masking emulation of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_IRQ_H
+#define HOST_IRQ_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Checks whether emulated interrupts may be taken right now
+\return true if interrupts are enabled and no handler is running
+******************************************************************************/
+bool HostIrq_CanRun(void);
+
+/**************************************************************************//**
+\brief Marks the entry of an emulated interrupt handler
+******************************************************************************/
+void HostIrq_Enter(void);
+
+/**************************************************************************//**
+\brief Marks the exit of an emulated interrupt handler
+******************************************************************************/
+void HostIrq_Exit(void);
+
+/**************************************************************************//**
+\brief Returns the number of emulated interrupts serviced so far
+\return Interrupt count
+******************************************************************************/
+uint32_t HostIrq_GetCount(void);
+
+/**************************************************************************//**
+\brief Installs the cycle counter timing the sections with interrupts masked
+\param[in] counter Returns a monotonic cycle count, NULL stops the measurement
+******************************************************************************/
+void HostIrq_SetCycleCounter(uint64_t (*counter)(void));
+
+/**************************************************************************//**
+\brief Returns the longest section with interrupts masked since the last
+       call, and restarts the measurement
+\return Cycles of the longest masked section
+******************************************************************************/
+uint64_t HostIrq_TakeMaxMaskedCycles(void);
+
+#endif /* HOST_IRQ_H */
+
+/* eof host_irq.h */
@@ -0,0 +1,110 @@
+/**
+* \file  host_nvm.h
+*
+* \brief Control interface of the emulated NVM of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_NVM_H
+#define HOST_NVM_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Wear and traffic counters of the emulated NVM */
+typedef struct _HostNvmStats
+{
+	/* Number of row erase operations */
+	uint32_t rowErases;
+
+	/* Number of page program operations */
+	uint32_t pageWrites;
+
+	/* Number of bytes read */
+	uint32_t bytesRead;
+
+	/* Highest erase count of any single row */
+	uint32_t maxRowErases;
+} HostNvmStats_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Erases the whole emulated NVM to 0xFF
+******************************************************************************/
+void HostNvm_Format(void);
+
+/**************************************************************************//**
+\brief Backs the emulated NVM by a file. The current content of the file is
+       loaded, and every erase or program operation is written through.
+\param[in] path Path of the image file, NULL for RAM only operation
+\return true if the file could be opened
+******************************************************************************/
+bool HostNvm_Attach(const char *path);
+
+/**************************************************************************//**
+\brief Reads the wear and traffic counters
+\param[out] stats Counters
+******************************************************************************/
+void HostNvm_GetStats(HostNvmStats_t *stats);
+
+/**************************************************************************//**
+\brief Clears the wear and traffic counters
+******************************************************************************/
+void HostNvm_ResetStats(void);
+
+/**************************************************************************//**
+\brief Cuts the power during a later erase or program operation: that
+       operation is done for the first half of its bytes only, and nothing is
+       erased or programmed after it until the next call.
+\param[in] operations Erase and page program operations until the cut, the
+           cut one included; 0 to run without a cut
+******************************************************************************/
+void HostNvm_FailAfter(uint32_t operations);
+
+/**************************************************************************//**
+\brief Tells whether the power was cut since the last HostNvm_FailAfter()
+\return true if an operation was cut
+******************************************************************************/
+bool HostNvm_PowerLost(void);
+
+#endif /* HOST_NVM_H */
+
+/* eof host_nvm.h */
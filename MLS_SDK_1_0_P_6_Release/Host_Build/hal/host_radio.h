@@ -0,0 +1,74 @@
+/**
+* \file  host_radio.h
+*
+* \brief Control interface of the radio SPI emulation of the host build
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef HOST_RADIO_H
+#define HOST_RADIO_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* Counters of the emulated DMA transfers of the radio SPI */
+typedef struct _HostRadioStats
+{
+	/* Number of frame buffer transfers moved by DMA */
+	uint32_t dmaTransfers;
+
+	/* Number of data bytes moved by DMA */
+	uint32_t dmaBytes;
+
+	/* Number of register accesses which had to wait for the end of a transfer */
+	uint32_t dmaWaits;
+} HostRadioStats_t;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Reads the DMA transfer counters, all zero when the build does not
+       define RADIO_SPI_DMA_ENABLE
+\param[out] stats Counters
+******************************************************************************/
+void HostRadio_GetStats(HostRadioStats_t *stats);
+
+#endif /* HOST_RADIO_H */
+
+/* eof host_radio.h */
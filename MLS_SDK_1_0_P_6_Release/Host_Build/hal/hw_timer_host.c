@@ -0,0 +1,172 @@
+/**
+* \file  hw_timer_host.c
+*
+* \brief Host model of the TC based common hardware timer
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stddef.h>
+#include "hw_timer.h"
+#include "common_hw_timer.h"
+#include "host_clock.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* The counter is 16 bits wide and runs at 1MHz */
+#define HW_TIMER_PERIOD_US          (0x10000uL)
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* Virtual time at which the counter was last cleared */
+static uint64_t counterBase;
+
+/* Overflow and compare channel interrupt sources */
+static HostClockEvent_t overflowEvent;
+static HostClockEvent_t compareEvent;
+
+/* Registered callbacks */
+static tmr_callback_t overflowCallback;
+static tmr_callback_t expiryCallback;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void overflowIsr(void *ctx);
+static void compareIsr(void *ctx);
+
+/******************************************************************************
+                     Interrupt service routines
+******************************************************************************/
+/* Counter wrapped from 0xFFFF to 0x0000 */
+static void overflowIsr(void *ctx)
+{
+	HostClock_Arm(&overflowEvent, overflowEvent.due + HW_TIMER_PERIOD_US);
+	if (overflowCallback)
+	{
+		overflowCallback();
+	}
+	(void)ctx;
+}
+
+/* Compare channel 0 matched, one shot */
+static void compareIsr(void *ctx)
+{
+	if (expiryCallback)
+	{
+		expiryCallback();
+	}
+	(void)ctx;
+}
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**************************************************************************//**
+\brief Clears and starts the counter with the overflow interrupt enabled
+******************************************************************************/
+void common_tc_init(void)
+{
+	HostClock_InitEvent(&overflowEvent, overflowIsr, NULL);
+	HostClock_InitEvent(&compareEvent, compareIsr, NULL);
+
+	counterBase = HostClock_Now();
+	HostClock_Arm(&overflowEvent, counterBase + HW_TIMER_PERIOD_US);
+}
+
+/**************************************************************************//**
+\brief Reads the current value of the counter
+\return Counter value in microseconds
+******************************************************************************/
+uint16_t common_tc_read_count(void)
+{
+	return (uint16_t)(HostClock_Now() - counterBase);
+}
+
+/**************************************************************************//**
+\brief Loads the compare channel relative to the current counter value
+\param[in] value Number of microseconds until the compare match
+******************************************************************************/
+void common_tc_delay(uint16_t value)
+{
+	HostClock_Arm(&compareEvent, HostClock_Now() + value);
+}
+
+/**************************************************************************//**
+\brief Disables the compare interrupt
+******************************************************************************/
+void common_tc_compare_stop(void)
+{
+	HostClock_Disarm(&compareEvent);
+}
+
+/**************************************************************************//**
+\brief Disables the overflow interrupt
+******************************************************************************/
+void common_tc_overflow_stop(void)
+{
+	HostClock_Disarm(&overflowEvent);
+}
+
+/**************************************************************************//**
+\brief Stops the counter
+******************************************************************************/
+void common_tc_stop(void)
+{
+	common_tc_compare_stop();
+	common_tc_overflow_stop();
+}
+
+/**************************************************************************//**
+\brief Registers the overflow callback
+\param[in] callback Function called on every counter overflow
+******************************************************************************/
+void set_common_tc_overflow_callback(tmr_callback_t callback)
+{
+	overflowCallback = callback;
+}
+
+/**************************************************************************//**
+\brief Registers the compare match callback
+\param[in] callback Function called on a compare match
+******************************************************************************/
+void set_common_tc_expiry_callback(tmr_callback_t callback)
+{
+	expiryCallback = callback;
+}
+
+/* eof hw_timer_host.c */
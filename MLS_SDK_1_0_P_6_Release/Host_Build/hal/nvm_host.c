@@ -0,0 +1,386 @@
+/**
+* \file  nvm_host.c
+*
+* \brief RAM and file backed emulation of the RWW EEPROM section
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "status_codes.h"
+#include "nvm.h"
+#include "common_nvm.h"
+#include "host_nvm.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define NVM_SIZE                    (NVMCTRL_RWWEE_PAGES * NVMCTRL_PAGE_SIZE)
+#define NVM_ROWS                    (NVMCTRL_RWWEE_PAGES / NVMCTRL_ROW_PAGES)
+#define NVM_ERASED_VALUE            (0xFF)
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* Content of the RWW EEPROM section */
+static uint8_t nvmArray[NVM_SIZE];
+
+/* Erase count of every row */
+static uint32_t nvmRowErases[NVM_ROWS];
+
+/* Backing image file */
+static FILE *nvmFile;
+
+/* Traffic counters */
+static HostNvmStats_t nvmStats;
+
+/* Whether the array content is valid */
+static bool nvmLoaded;
+
+/* Operations until the power is cut, 0 when no cut is armed */
+static uint32_t nvmFailCountdown;
+
+/* Whether the power was cut */
+static bool nvmPowerLost;
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static bool nvmRangeValid(uint32_t address, uint32_t length);
+static void nvmFlush(uint32_t offset, uint32_t length);
+static void nvmLoad(void);
+static uint32_t nvmOperationLength(uint32_t length);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**************************************************************************//**
+\brief Checks whether a range lies within the RWW EEPROM section
+******************************************************************************/
+static bool nvmRangeValid(uint32_t address, uint32_t length)
+{
+	return (address >= NVMCTRL_RWW_EEPROM_ADDR) &&
+		((address - NVMCTRL_RWW_EEPROM_ADDR) + length <= NVM_SIZE);
+}
+
+/**************************************************************************//**
+\brief Writes a modified range through to the image file
+******************************************************************************/
+static void nvmFlush(uint32_t offset, uint32_t length)
+{
+	if (nvmFile)
+	{
+		fseek(nvmFile, (long)offset, SEEK_SET);
+		fwrite(&nvmArray[offset], 1, length, nvmFile);
+		fflush(nvmFile);
+	}
+}
+
+/**************************************************************************//**
+\brief Makes sure the array holds erased flash on first use
+******************************************************************************/
+static void nvmLoad(void)
+{
+	if (!nvmLoaded)
+	{
+		memset(nvmArray, NVM_ERASED_VALUE, sizeof(nvmArray));
+		nvmLoaded = true;
+	}
+}
+
+/**************************************************************************//**
+\brief Returns the number of bytes of an erase or program operation which
+       are done before the power is cut
+******************************************************************************/
+static uint32_t nvmOperationLength(uint32_t length)
+{
+	if (nvmPowerLost)
+	{
+		return 0;
+	}
+	if (nvmFailCountdown && (0 == --nvmFailCountdown))
+	{
+		nvmPowerLost = true;
+		return length / 2;
+	}
+	return length;
+}
+
+/**************************************************************************//**
+\brief Erases the whole emulated NVM to 0xFF
+******************************************************************************/
+void HostNvm_Format(void)
+{
+	memset(nvmArray, NVM_ERASED_VALUE, sizeof(nvmArray));
+	nvmLoaded = true;
+	nvmFlush(0, NVM_SIZE);
+}
+
+/**************************************************************************//**
+\brief Backs the emulated NVM by a file
+******************************************************************************/
+bool HostNvm_Attach(const char *path)
+{
+	size_t length;
+
+	if (nvmFile)
+	{
+		fclose(nvmFile);
+		nvmFile = NULL;
+	}
+
+	if (NULL == path)
+	{
+		return true;
+	}
+
+	nvmFile = fopen(path, "r+b");
+	if (NULL == nvmFile)
+	{
+		nvmFile = fopen(path, "w+b");
+		if (NULL == nvmFile)
+		{
+			return false;
+		}
+	}
+
+	memset(nvmArray, NVM_ERASED_VALUE, sizeof(nvmArray));
+	length = fread(nvmArray, 1, sizeof(nvmArray), nvmFile);
+	nvmLoaded = true;
+	if (length < sizeof(nvmArray))
+	{
+		/* New or truncated image: the missing part reads as erased */
+		nvmFlush(length, NVM_SIZE - length);
+	}
+	return true;
+}
+
+/**************************************************************************//**
+\brief Reads the wear and traffic counters
+******************************************************************************/
+void HostNvm_GetStats(HostNvmStats_t *stats)
+{
+	uint32_t max = 0;
+
+	for (uint32_t row = 0; row < NVM_ROWS; row++)
+	{
+		if (nvmRowErases[row] > max)
+		{
+			max = nvmRowErases[row];
+		}
+	}
+	nvmStats.maxRowErases = max;
+	*stats = nvmStats;
+}
+
+/**************************************************************************//**
+\brief Clears the wear and traffic counters
+******************************************************************************/
+void HostNvm_ResetStats(void)
+{
+	memset(&nvmStats, 0, sizeof(nvmStats));
+	memset(nvmRowErases, 0, sizeof(nvmRowErases));
+}
+
+/**************************************************************************//**
+\brief Cuts the power during a later erase or program operation
+******************************************************************************/
+void HostNvm_FailAfter(uint32_t operations)
+{
+	nvmFailCountdown = operations;
+	nvmPowerLost = false;
+}
+
+/**************************************************************************//**
+\brief Tells whether the power was cut since the last HostNvm_FailAfter()
+******************************************************************************/
+bool HostNvm_PowerLost(void)
+{
+	return nvmPowerLost;
+}
+
+/**
+ * \brief Reads the parameters of the emulated NVM controller
+ */
+void nvm_get_parameters(struct nvm_parameters *const parameters)
+{
+	memset(parameters, 0, sizeof(*parameters));
+	parameters->page_size = NVMCTRL_PAGE_SIZE;
+	parameters->nvm_number_of_pages = 4096;
+	parameters->rww_eeprom_number_of_pages = NVMCTRL_RWWEE_PAGES;
+}
+
+/**
+ * \brief Initializes the emulated NVM controller
+ */
+status_code_t nvm_init(mem_type_t mem)
+{
+	if (INT_FLASH != mem)
+	{
+		return ERR_INVALID_ARG;
+	}
+	nvmLoad();
+	return (status_code_t)STATUS_OK;
+}
+
+/**
+ * \brief Erases a row of the emulated NVM
+ */
+enum status_code nvm_erase_row(const uint32_t row_address)
+{
+	uint32_t offset;
+
+	if (!nvmRangeValid(row_address, NVMCTRL_ROW_SIZE) || (row_address % NVMCTRL_ROW_SIZE))
+	{
+		return STATUS_ERR_BAD_ADDRESS;
+	}
+	nvmLoad();
+
+	offset = row_address - NVMCTRL_RWW_EEPROM_ADDR;
+	memset(&nvmArray[offset], NVM_ERASED_VALUE, nvmOperationLength(NVMCTRL_ROW_SIZE));
+	nvmRowErases[offset / NVMCTRL_ROW_SIZE]++;
+	nvmStats.rowErases++;
+	nvmFlush(offset, NVMCTRL_ROW_SIZE);
+	return STATUS_OK;
+}
+
+/**
+ * \brief Reads a number of bytes from a page of the emulated NVM
+ */
+enum status_code nvm_read_buffer(const uint32_t source_address,
+		uint8_t *const buffer, uint16_t length)
+{
+	if ((length > NVMCTRL_PAGE_SIZE) || !nvmRangeValid(source_address, length))
+	{
+		return STATUS_ERR_BAD_ADDRESS;
+	}
+	nvmLoad();
+
+	memcpy(buffer, &nvmArray[source_address - NVMCTRL_RWW_EEPROM_ADDR], length);
+	nvmStats.bytesRead += length;
+	return STATUS_OK;
+}
+
+/**
+ * \brief Programs a number of bytes into a page of the emulated NVM
+ */
+enum status_code nvm_write_buffer(const uint32_t destination_address,
+		const uint8_t *buffer, uint16_t length)
+{
+	uint32_t offset;
+
+	if ((length > NVMCTRL_PAGE_SIZE) || !nvmRangeValid(destination_address, length) ||
+		((destination_address % NVMCTRL_PAGE_SIZE) + length > NVMCTRL_PAGE_SIZE))
+	{
+		return STATUS_ERR_BAD_ADDRESS;
+	}
+	nvmLoad();
+
+	offset = destination_address - NVMCTRL_RWW_EEPROM_ADDR;
+	length = (uint16_t)nvmOperationLength(length);
+	for (uint16_t i = 0; i < length; i++)
+	{
+		nvmArray[offset + i] &= buffer[i];
+	}
+	nvmStats.pageWrites++;
+	nvmFlush(offset, length);
+	return STATUS_OK;
+}
+
+/**
+ * \brief Reads a number of bytes from the emulated NVM
+ */
+status_code_t nvm_read(mem_type_t mem, uint32_t address, void *buffer,
+		uint32_t len)
+{
+	if ((INT_FLASH != mem) || !nvmRangeValid(address, len))
+	{
+		return ERR_INVALID_ARG;
+	}
+	nvmLoad();
+
+	memcpy(buffer, &nvmArray[address - NVMCTRL_RWW_EEPROM_ADDR], len);
+	nvmStats.bytesRead += len;
+	return (status_code_t)STATUS_OK;
+}
+
+/**
+ * \brief Writes a number of bytes to the emulated NVM. Like the SAM0 common
+ *        NVM driver every touched row is backed up, erased and reprogrammed.
+ */
+status_code_t nvm_write(mem_type_t mem, uint32_t address, void *buffer,
+		uint32_t len)
+{
+	uint8_t rowBuffer[NVMCTRL_ROW_SIZE];
+	const uint8_t *src = (const uint8_t *)buffer;
+	uint32_t rowStart;
+	uint32_t rowOffset;
+	uint32_t chunk;
+
+	if ((INT_FLASH != mem) || !nvmRangeValid(address, len))
+	{
+		return ERR_INVALID_ARG;
+	}
+	nvmLoad();
+
+	while (len)
+	{
+		rowStart = address & ~(uint32_t)(NVMCTRL_ROW_SIZE - 1);
+		rowOffset = address - rowStart;
+		chunk = NVMCTRL_ROW_SIZE - rowOffset;
+		if (chunk > len)
+		{
+			chunk = len;
+		}
+
+		memcpy(rowBuffer, &nvmArray[rowStart - NVMCTRL_RWW_EEPROM_ADDR], NVMCTRL_ROW_SIZE);
+		memcpy(&rowBuffer[rowOffset], src, chunk);
+
+		nvm_erase_row(rowStart);
+		for (uint32_t page = 0; page < NVMCTRL_ROW_PAGES; page++)
+		{
+			nvm_write_buffer(rowStart + (page * NVMCTRL_PAGE_SIZE),
+				&rowBuffer[page * NVMCTRL_PAGE_SIZE], NVMCTRL_PAGE_SIZE);
+		}
+
+		address += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+	return (status_code_t)STATUS_OK;
+}
+
+/* eof nvm_host.c */
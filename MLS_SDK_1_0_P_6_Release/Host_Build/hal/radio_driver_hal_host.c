@@ -0,0 +1,581 @@
+/**
+* \file  radio_driver_hal_host.c
+*
+* \brief Radio Driver HAL for the host build, backed by the SX1276 model
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "asf.h"
+#include "radio_driver_hal.h"
+#include "sys.h"
+#include "sx1276_model.h"
+#include "host_clock.h"
+#include "host_irq.h"
+#include "host_radio.h"
+#ifdef CONF_PMM_ENABLE
+#include "pmm.h"
+#endif
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#ifndef RADIO_CLK_STABILITATION_DELAY
+/* Delay in ms for Radio clock source to stabilize */
+#define RADIO_CLK_STABILITATION_DELAY      0
+#endif
+
+#ifndef RADIO_CLK_SRC
+/* Clock source for SX1276 radio */
+#define RADIO_CLK_SRC                      XTAL
+#endif
+
+/* Number of DIO lines of the transceiver */
+#define RADIO_DIO_COUNT                    (6)
+
+/* Duration of one SPI byte at the 2MHz clock of the target, in microseconds */
+#define RADIO_SPI_BYTE_US                  (4)
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* DIO interrupt handlers registered by the radio driver */
+static DioInterruptHandler_t interruptHandlerDio[RADIO_DIO_COUNT];
+
+/* External interrupt line enable status, one bit per DIO */
+static uint8_t dioEnabled;
+
+static uint8_t dioStatus;
+
+#ifdef RADIO_SPI_DMA_ENABLE
+/* End of the ongoing DMA transfer, the transfer complete interrupt */
+static HostClockEvent_t spiDmaEvent;
+
+/* Whether a DMA transfer is ongoing */
+static bool spiDmaBusy;
+
+/* Completion callback of the ongoing transfer */
+static RadioTransferDone_t spiDmaDone;
+
+static HostRadioStats_t radioStats;
+#endif
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void HAL_RadioDioCallback(uint8_t dio);
+#ifdef RADIO_SPI_DMA_ENABLE
+static void HAL_SPIDmaStart(uint8_t bufferLen, RadioTransferDone_t done);
+static void HAL_SPIDmaComplete(void *ctx);
+static void HAL_SPIDmaWait(void);
+#endif
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**
+ * \brief Called by the transceiver model on a rising edge of a DIO line,
+ *        the equivalent of the EIC callbacks of the target driver
+ * \param[in] dio DIO line number (0 to 5)
+ */
+static void HAL_RadioDioCallback(uint8_t dio)
+{
+	if ((dio < RADIO_DIO_COUNT) && (dioEnabled & (1 << dio)) && interruptHandlerDio[dio])
+	{
+#ifdef CONF_PMM_ENABLE
+		PMM_Wakeup();
+#endif
+		interruptHandlerDio[dio]();
+	}
+}
+
+/**
+ * \brief This function is used to initialize the Radio Hardware
+ * The transceiver model is attached and all the DIO lines are enabled
+ */
+void HAL_RadioInit(void)
+{
+	dioEnabled = (1 << RADIO_DIO_COUNT) - 1;
+	SX1276Model_SetDioHandler(HAL_RadioDioCallback);
+#ifdef RADIO_SPI_DMA_ENABLE
+	HostClock_Disarm(&spiDmaEvent);
+	HostClock_InitEvent(&spiDmaEvent, HAL_SPIDmaComplete, NULL);
+	spiDmaBusy = false;
+	spiDmaDone = NULL;
+#endif
+}
+
+/**
+ * \brief This function is used to initialize the SPI Interface after PMM wakeup
+ */
+void HAL_Radio_resources_init(void)
+{
+}
+
+/**
+ * \brief This function is used to deinitialize the SPI Interface
+ */
+void HAL_RadioDeInit(void)
+{
+}
+
+/**
+ * \brief This function resets the Radio hardware by pulling the reset pin low
+ */
+void RADIO_Reset(void)
+{
+	SX1276Model_Reset();
+	SystemBlockingWaitMs(1);
+}
+
+/**
+ * \brief This function is used to write a byte of data to the radio register
+ * \param[in] reg Radio register to be written
+ * \param[in] value Value to be written into the radio register
+ */
+void RADIO_RegisterWrite(uint8_t reg, uint8_t value)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	HAL_SPIDmaWait();
+#endif
+	SX1276Model_WriteRegister(reg & ~REG_WRITE_CMD, value);
+}
+
+/**
+ * \brief This function is used to read a byte of data from the radio register
+ * \param[in] reg Radio register to be read
+ * \retval  Value read from the radio register
+ */
+uint8_t RADIO_RegisterRead(uint8_t reg)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	HAL_SPIDmaWait();
+#endif
+	return SX1276Model_ReadRegister(reg & ~REG_WRITE_CMD);
+}
+
+/**
+ * \brief This function is used to  write a stream of data into the Radio Frame buffer
+ * \param[in] FIFO offset to be written to
+ * \param[in] buffer Pointer to the data to be written into the frame buffer
+ * \param[in] bufferLen Length of the data to be written
+ */
+void RADIO_FrameWrite(uint8_t offset, uint8_t* buffer, uint8_t bufferLen)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	HAL_SPIDmaWait();
+#endif
+	SX1276Model_WriteBurst(offset & ~REG_WRITE_CMD, buffer, bufferLen);
+}
+
+/**
+ * \brief This function is used to  read a stream of data from the Radio Frame buffer
+ * \param[in] FIFO offset to be read from
+ * \param[in] buffer Pointer to the data where the data is read and stored
+ * \param[in] bufferLen Length of the data to be read from the frame buffer
+ */
+void RADIO_FrameRead(uint8_t offset, uint8_t* buffer, uint8_t bufferLen)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	HAL_SPIDmaWait();
+#endif
+	SX1276Model_ReadBurst(offset & ~REG_WRITE_CMD, buffer, bufferLen);
+}
+
+/**
+ * \brief This function is used to write consecutive radio registers in one
+ * SPI transaction
+ * \param[in] reg First radio register to be written
+ * \param[in] buffer Pointer to the values to be written into the registers
+ * \param[in] bufferLen Number of registers to be written
+ */
+void RADIO_RegisterBurstWrite(uint8_t reg, uint8_t* buffer, uint8_t bufferLen)
+{
+	RADIO_FrameWrite(reg, buffer, bufferLen);
+}
+
+/**
+ * \brief This function is used to read consecutive radio registers in one
+ * SPI transaction
+ * \param[in] reg First radio register to be read
+ * \param[in] buffer Pointer to the data where the register values are stored
+ * \param[in] bufferLen Number of registers to be read
+ */
+void RADIO_RegisterBurstRead(uint8_t reg, uint8_t* buffer, uint8_t bufferLen)
+{
+	RADIO_FrameRead(reg, buffer, bufferLen);
+}
+
+/**
+ * \brief This function starts writing a stream of data into the Radio Frame
+ * buffer. The transceiver model takes the data at once, the completion is an
+ * event at the end of the SPI transaction of the target.
+ * \param[in] offset FIFO offset to be written to
+ * \param[in] buffer Pointer to the data to be written
+ * \param[in] bufferLen Length of the data to be written
+ * \param[in] done Function called when the transfer is complete, may be NULL
+ * \retval true if the transfer is started, false if another one is ongoing
+ */
+bool RADIO_FrameWriteAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioTransferDone_t done)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	if (spiDmaBusy)
+	{
+		return false;
+	}
+
+	if (bufferLen)
+	{
+		SX1276Model_WriteBurst(offset & ~REG_WRITE_CMD, buffer, bufferLen);
+		HAL_SPIDmaStart(bufferLen, done);
+		return true;
+	}
+#endif
+	RADIO_FrameWrite(offset, buffer, bufferLen);
+	if (done)
+	{
+		done();
+	}
+	return true;
+}
+
+/**
+ * \brief This function starts reading a stream of data from the Radio Frame
+ * buffer. The transceiver model delivers the data at once, the completion is
+ * an event at the end of the SPI transaction of the target.
+ * \param[in] offset FIFO offset to be read from
+ * \param[in] buffer Pointer to the data where the data is stored
+ * \param[in] bufferLen Length of the data to be read from the frame buffer
+ * \param[in] done Function called when the transfer is complete, may be NULL
+ * \retval true if the transfer is started, false if another one is ongoing
+ */
+bool RADIO_FrameReadAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioTransferDone_t done)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	if (spiDmaBusy)
+	{
+		return false;
+	}
+
+	if (bufferLen)
+	{
+		SX1276Model_ReadBurst(offset & ~REG_WRITE_CMD, buffer, bufferLen);
+		HAL_SPIDmaStart(bufferLen, done);
+		return true;
+	}
+#endif
+	RADIO_FrameRead(offset, buffer, bufferLen);
+	if (done)
+	{
+		done();
+	}
+	return true;
+}
+
+/**
+ * \brief This function is used to check for an ongoing asynchronous frame transfer
+ * \retval true if a transfer is ongoing
+ */
+bool RADIO_SpiBusy(void)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	return spiDmaBusy;
+#else
+	return false;
+#endif
+}
+
+#ifdef RADIO_SPI_DMA_ENABLE
+/**
+ * \brief Schedules the end of a DMA transfer after the address byte and the
+ * data went over the bus
+ * \param[in] bufferLen Length of the data
+ * \param[in] done Callback called at the end of the transfer
+ */
+static void HAL_SPIDmaStart(uint8_t bufferLen, RadioTransferDone_t done)
+{
+	spiDmaDone = done;
+	spiDmaBusy = true;
+	radioStats.dmaTransfers++;
+	radioStats.dmaBytes += bufferLen;
+	HostClock_Arm(&spiDmaEvent, HostClock_Now() + (1 + bufferLen) * RADIO_SPI_BYTE_US);
+}
+
+/**
+ * \brief Transfer complete interrupt of the DMA controller
+ * \param[in] ctx Unused
+ */
+static void HAL_SPIDmaComplete(void *ctx)
+{
+	RadioTransferDone_t done = spiDmaDone;
+
+	(void)ctx;
+	spiDmaDone = NULL;
+	spiDmaBusy = false;
+	if (done)
+	{
+		done();
+	}
+}
+
+/**
+ * \brief Waits for the end of an ongoing DMA transfer. With interrupts masked
+ * the target polls the channel flag, the transfer then ends without its
+ * interrupt.
+ */
+static void HAL_SPIDmaWait(void)
+{
+	if (!spiDmaBusy)
+	{
+		return;
+	}
+
+	radioStats.dmaWaits++;
+	HostClock_AdvanceTo(spiDmaEvent.due);
+	if (spiDmaBusy)
+	{
+		HostClock_Disarm(&spiDmaEvent);
+		HAL_SPIDmaComplete(NULL);
+	}
+}
+#endif
+
+/**
+ * \brief Reads the DMA transfer counters
+ * \param[out] stats Counters
+ */
+void HostRadio_GetStats(HostRadioStats_t *stats)
+{
+#ifdef RADIO_SPI_DMA_ENABLE
+	*stats = radioStats;
+#else
+	memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+void HAL_EnableDIO0Interrupt(void)
+{
+	dioEnabled |= (1 << 0);
+}
+
+void HAL_DisbleDIO0Interrupt(void)
+{
+	dioEnabled &= ~(1 << 0);
+}
+
+void HAL_EnableDIO1Interrupt(void)
+{
+	dioEnabled |= (1 << 1);
+}
+
+void HAL_DisbleDIO1Interrupt(void)
+{
+	dioEnabled &= ~(1 << 1);
+}
+
+void HAL_EnableDIO2Interrupt(void)
+{
+	dioEnabled |= (1 << 2);
+}
+
+void HAL_DisbleDIO2Interrupt(void)
+{
+	dioEnabled &= ~(1 << 2);
+}
+
+void HAL_EnableDIO3Interrupt(void)
+{
+	dioEnabled |= (1 << 3);
+}
+
+void HAL_DisbleDIO3Interrupt(void)
+{
+	dioEnabled &= ~(1 << 3);
+}
+
+void HAL_EnableDIO4Interrupt(void)
+{
+	dioEnabled |= (1 << 4);
+}
+
+void HAL_DisbleDIO4Interrupt(void)
+{
+	dioEnabled &= ~(1 << 4);
+}
+
+void HAL_EnableDIO5Interrupt(void)
+{
+	dioEnabled |= (1 << 5);
+}
+
+void HAL_DisbleDIO5Interrupt(void)
+{
+	dioEnabled &= ~(1 << 5);
+}
+
+uint8_t HAL_DIO0PinValue(void)
+{
+	return (SX1276Model_GetDioLevels() >> 0) & 1;
+}
+
+uint8_t HAL_DIO1PinValue(void)
+{
+	return (SX1276Model_GetDioLevels() >> 1) & 1;
+}
+
+uint8_t HAL_DIO2PinValue(void)
+{
+	return (SX1276Model_GetDioLevels() >> 2) & 1;
+}
+
+uint8_t HAL_DIO3PinValue(void)
+{
+	return (SX1276Model_GetDioLevels() >> 3) & 1;
+}
+
+uint8_t HAL_DIO4PinValue(void)
+{
+	return (SX1276Model_GetDioLevels() >> 4) & 1;
+}
+
+uint8_t HAL_DIO5PinValue(void)
+{
+	return (SX1276Model_GetDioLevels() >> 5) & 1;
+}
+
+/**
+ * \brief This function is used to get the interrupt status
+ * The interrupt status is cleared after calling this function
+ * \retval Returns the mask of received interrupts
+ */
+uint8_t INTERRUPT_GetDioStatus(void)
+{
+	uint8_t a;
+
+	INTERRUPT_GlobalInterruptDisable();
+	a = dioStatus;
+	dioStatus = 0;
+	INTERRUPT_GlobalInterruptEnable();
+	return a;
+}
+
+/**
+ * \brief This function is used to get the interrupt status
+ * The interrupt status is not cleared after calling this function
+ * \retval Returns the mask of received interrupts
+ */
+uint8_t INTERRUPT_PeekDioStatus(void)
+{
+	return dioStatus;
+}
+
+/**
+ * \brief This function sets the interrupt handler for given DIO interrupt
+ *
+ * \param[in] dioPin  - DIO pin
+ * \param[in] handler - function to be called upon given DIO interrupt
+ */
+void HAL_RegisterDioInterruptHandler(uint8_t dioPin, DioInterruptHandler_t handler)
+{
+	for (uint8_t dio = 0; dio < RADIO_DIO_COUNT; dio++)
+	{
+		if (dioPin == (1 << dio))
+		{
+			interruptHandlerDio[dio] = handler;
+			break;
+		}
+	}
+}
+
+/**
+ * \brief This function Enables RF Control pins
+ *
+ * \param[in] RFCtrl1 RFO_LF, RFO_HF or PA_BOOST
+ * \param[in] RFCtrl2 RX or TX
+ */
+void HAL_EnableRFCtrl(RFCtrl1_t RFCtrl1, RFCtrl2_t RFCtrl2)
+{
+	/* The model has no RF switch */
+	(void)RFCtrl1;
+	(void)RFCtrl2;
+}
+
+/**
+ * \brief This function Disables RF Control pins
+ *
+ * \param[in] RFCtrl1 RFO_LF, RFO_HF or PA_BOOST
+ * \param[in] RFCtrl2 RX or TX
+ */
+void HAL_DisableRFCtrl(RFCtrl1_t RFCtrl1, RFCtrl2_t RFCtrl2)
+{
+	(void)RFCtrl1;
+	(void)RFCtrl2;
+}
+
+/**
+ * \brief This function is used to get the radio clock source
+ * \retval Returns the clock source, TCXO or XTAL
+ */
+RadioClockSources_t HAL_GetRadioClkSrc(void)
+{
+	return RADIO_CLK_SRC;
+}
+
+/**
+ * \brief This function is used to get the radio clock stabilization delay
+ * \retval Returns the delay in ms
+ */
+uint8_t HAL_GetRadioClkStabilizationDelay(void)
+{
+	return RADIO_CLK_STABILITATION_DELAY;
+}
+
+/**
+ * \brief This function powers on the TCXO, no TCXO in the model
+ */
+void HAL_TCXOPowerOn(void)
+{
+}
+
+/**
+ * \brief This function powers off the TCXO, no TCXO in the model
+ */
+void HAL_TCXOPowerOff(void)
+{
+}
+
+/* eof radio_driver_hal_host.c */
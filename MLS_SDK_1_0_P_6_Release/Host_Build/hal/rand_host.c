@@ -0,0 +1,76 @@
+/**
+* \file  rand_host.c
+*
+* \brief rand() and srand() of the target C library
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdlib.h>
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/*
+* The stack seeds the generator from the radio and draws channels and join
+* delays from it. Defining it here gives the sequence of the newlib build of
+* the target and keeps the generator inside the stack image, so simulated
+* instances do not share it.
+*/
+static unsigned long long randNext = 1;
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**************************************************************************//**
+\brief Seeds the pseudo random generator
+\param[in] seed Seed value
+******************************************************************************/
+void srand(unsigned int seed)
+{
+	randNext = seed;
+}
+
+/**************************************************************************//**
+\brief Returns the next pseudo random number, same LCG as newlib
+\return Value between 0 and RAND_MAX
+******************************************************************************/
+int rand(void)
+{
+	randNext = (randNext * 6364136223846793005uLL) + 1u;
+	return (int)((randNext >> 32) & RAND_MAX);
+}
+
+/* eof rand_host.c */
@@ -0,0 +1,76 @@
+/**
+* \file  sleep_host.c
+*
+* \brief Host implementation of the MCU sleep modes
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include "sleep.h"
+#include "host_clock.h"
+
+#ifdef CONF_PMM_ENABLE
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**
+ * \brief Puts the system in given sleep mode
+ *
+ * Like the WFI instruction on the target, the call returns after the next
+ * interrupt has been serviced.
+ *
+ * \param[in] mode - sleep mode
+ */
+void HAL_Sleep(HAL_SleepMode_t mode)
+{
+	switch (mode)
+	{
+		case SLEEP_MODE_STANDBY:
+		case SLEEP_MODE_BACKUP:
+		{
+			HostClock_WaitForInterrupt();
+			break;
+		}
+		default:
+		{
+			/* other sleep modes are not implemented currently */
+			break;
+		}
+	}
+}
+
+#endif /* #ifdef CONF_PMM_ENABLE */
+
+/* eof sleep_host.c */
@@ -0,0 +1,127 @@
+/**
+* \file  sleep_timer_host.c
+*
+* \brief Host model of the RTC based sleep timer
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stddef.h>
+#include "sleep_timer.h"
+#include "host_clock.h"
+
+#ifdef CONF_PMM_ENABLE
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+/* The RTC runs from the 32.768kHz crystal without prescaler */
+#define RTC_FREQUENCY_HZ            (32768uLL)
+#define US_PER_SECOND               (1000000uLL)
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* Virtual time at which the counter was last cleared */
+static uint64_t counterBase;
+
+/* Compare channel 0 interrupt source */
+static HostClockEvent_t compareEvent;
+
+/* Callback of compare channel 0 */
+static void (*compareCallback)(void);
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static void compareIsr(void *ctx);
+
+/******************************************************************************
+                     Interrupt service routines
+******************************************************************************/
+static void compareIsr(void *ctx)
+{
+	if (compareCallback)
+	{
+		compareCallback();
+	}
+	(void)ctx;
+}
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+/**
+* \brief Initializes the sleep timer module
+*/
+void SleepTimerInit(void)
+{
+	HostClock_InitEvent(&compareEvent, compareIsr, NULL);
+	counterBase = HostClock_Now();
+	compareCallback = NULL;
+}
+
+/**
+* \brief Calculate the Elapsed Time from the previous call of this function
+* \retval Elapsed time in ticks
+*/
+uint32_t SleepTimerGetElapsedTime(void)
+{
+	return (uint32_t)(((HostClock_Now() - counterBase) * RTC_FREQUENCY_HZ) / US_PER_SECOND);
+}
+
+/**
+* \brief Initializes the sleep timer
+*/
+void SleepTimerStart(uint32_t sleepTicks, void (*cb)(void))
+{
+	uint64_t now = HostClock_Now();
+
+	counterBase = now;
+	compareCallback = cb;
+	/* Compare matches at the first microsecond the counter reaches sleepTicks */
+	HostClock_Arm(&compareEvent,
+		now + (((uint64_t)sleepTicks * US_PER_SECOND) + RTC_FREQUENCY_HZ - 1) / RTC_FREQUENCY_HZ);
+}
+
+/**
+* \brief Stop the sleep timer
+*/
+void SleepTimerStop(void)
+{
+	HostClock_Disarm(&compareEvent);
+}
+#endif /* CONF_PMM_ENABLE */
+
+/* eof sleep_timer_host.c */
@@ -0,0 +1,1131 @@
+/**
+* \file  sx1276_model.c
+*
+* \brief Register level model of the SX1276 transceiver
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "host_clock.h"
+#include "sx1276_model.h"
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define REG_COUNT                   (0x80)
+#define FIFO_SIZE                   (256)
+
+/* Common registers */
+#define R_FIFO                      (0x00)
+#define R_OPMODE                    (0x01)
+#define R_FRFMSB                    (0x06)
+#define R_FRFMID                    (0x07)
+#define R_FRFLSB                    (0x08)
+#define R_PACONFIG                  (0x09)
+#define R_DIOMAPPING1               (0x40)
+#define R_DIOMAPPING2               (0x41)
+#define R_VERSION                   (0x42)
+#define R_PADAC                     (0x4D)
+
+/* LoRa registers */
+#define R_LORA_FIFOADDRPTR          (0x0D)
+#define R_LORA_FIFOTXBASEADDR       (0x0E)
+#define R_LORA_FIFORXBASEADDR       (0x0F)
+#define R_LORA_FIFORXCURRENTADDR    (0x10)
+#define R_LORA_IRQFLAGSMASK         (0x11)
+#define R_LORA_IRQFLAGS             (0x12)
+#define R_LORA_RXNBBYTES            (0x13)
+#define R_LORA_PKTSNRVALUE          (0x19)
+#define R_LORA_PKTRSSIVALUE         (0x1A)
+#define R_LORA_RSSIVALUE            (0x1B)
+#define R_LORA_HOPCHANNEL           (0x1C)
+#define R_LORA_MODEMCONFIG1         (0x1D)
+#define R_LORA_MODEMCONFIG2         (0x1E)
+#define R_LORA_SYMBTIMEOUTLSB       (0x1F)
+#define R_LORA_PREAMBLEMSB          (0x20)
+#define R_LORA_PREAMBLELSB          (0x21)
+#define R_LORA_PAYLOADLENGTH        (0x22)
+#define R_LORA_PAYLOADMAXLENGTH     (0x23)
+#define R_LORA_FIFORXBYTEADDR       (0x25)
+#define R_LORA_MODEMCONFIG3         (0x26)
+#define R_LORA_RSSIWIDEBAND         (0x2C)
+#define R_LORA_INVERTIQ             (0x33)
+#define R_LORA_SYNCWORD             (0x39)
+
+/* FSK registers */
+#define R_FSK_BITRATEMSB            (0x02)
+#define R_FSK_BITRATELSB            (0x03)
+#define R_FSK_RSSIVALUE             (0x11)
+#define R_FSK_PREAMBLEMSB           (0x25)
+#define R_FSK_PREAMBLELSB           (0x26)
+#define R_FSK_SYNCCONFIG            (0x27)
+#define R_FSK_PACKETCONFIG1         (0x30)
+#define R_FSK_IMAGECAL              (0x3B)
+#define R_FSK_IRQFLAGS1             (0x3E)
+#define R_FSK_IRQFLAGS2             (0x3F)
+
+/* LoRa interrupt flags */
+#define IRQ_RXTIMEOUT               (1 << 7)
+#define IRQ_RXDONE                  (1 << 6)
+#define IRQ_PAYLOADCRCERROR         (1 << 5)
+#define IRQ_VALIDHEADER             (1 << 4)
+#define IRQ_TXDONE                  (1 << 3)
+#define IRQ_CADDONE                 (1 << 2)
+
+/* FSK interrupt flags (RegIrqFlags2) */
+#define IRQ2_FIFOEMPTY              (1 << 6)
+#define IRQ2_PACKETSENT             (1 << 3)
+#define IRQ2_PAYLOADREADY           (1 << 2)
+#define IRQ2_CRCOK                  (1 << 1)
+
+/* RegOpMode fields */
+#define OPMODE_LORA                 (0x80)
+#define OPMODE_MODE_MASK            (0x07)
+
+/* RSSI register offset in the high frequency band */
+#define RSSI_HF_OFFSET              (157)
+
+/* A receiver accepts carriers within this offset */
+#define FREQUENCY_TOLERANCE_HZ      (25000)
+
+/* Number of symbols a CAD takes */
+#define CAD_SYMBOLS                 (2)
+
+#define US_PER_SECOND               (1000000uLL)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* State of a running receiver */
+typedef struct _ModelRx
+{
+	bool active;
+	bool single;
+	bool locked;
+	SX1276RxWindow_t window;
+	SX1276Frame_t frame;
+} ModelRx_t;
+
+/* State of a running FSK transmission */
+typedef struct _ModelFskTx
+{
+	bool active;
+	uint16_t have;
+	uint16_t needed;
+	SX1276Frame_t frame;
+} ModelFskTx_t;
+
+/******************************************************************************
+                     Global variables section
+******************************************************************************/
+/* Registers shared by both modems and the overlaid modem specific pages */
+static uint8_t regCommon[REG_COUNT];
+static uint8_t regLora[REG_COUNT];
+static uint8_t regFsk[REG_COUNT];
+
+/* LoRa data buffer, addressed through RegFifoAddrPtr */
+static uint8_t loraFifo[FIFO_SIZE];
+
+/* FSK FIFO, a byte queue */
+static uint8_t fskFifo[FIFO_SIZE];
+static uint16_t fskFifoHead;
+static uint16_t fskFifoCount;
+
+/* Interrupt flags */
+static uint8_t loraIrqFlags;
+static uint8_t fskIrqFlags2;
+
+/* Level of the DIO lines */
+static uint8_t dioLevels;
+
+/* Medium and DIO handler */
+static const SX1276Air_t *modelAir;
+static SX1276DioHandler_t dioHandler;
+
+/* Activity */
+static ModelRx_t rx;
+static ModelFskTx_t fskTx;
+static SX1276Frame_t txFrame;
+
+/* Interrupt sources */
+static HostClockEvent_t txEvent;
+static HostClockEvent_t rxEvent;
+static HostClockEvent_t timeoutEvent;
+static HostClockEvent_t fifoEvent;
+static HostClockEvent_t syncEvent;
+static HostClockEvent_t cadEvent;
+
+/* Counters */
+static SX1276ModelStats_t stats;
+static uint64_t modeSince;
+
+/* Wideband RSSI noise generator */
+static uint32_t noiseState = 0x2545F491u;
+
+/* Bandwidths in RegModemConfig1 encoding */
+static const uint32_t bandwidthHz[10] = {
+	7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+static uint8_t *regPointer(uint8_t reg);
+static bool isLora(void);
+static uint8_t currentMode(void);
+static void setMode(uint8_t mode);
+static void accountModeTime(void);
+static void raiseDio(uint8_t dio);
+static uint8_t dioMapping(uint8_t dio);
+static void stopActivity(void);
+static void writeOpMode(uint8_t value);
+static uint32_t readFrequency(void);
+static int8_t readPower(void);
+static uint32_t readFskBitrate(void);
+static uint32_t fskBytesTime(uint32_t bytes, uint32_t bitrate);
+static void startLoraTx(void);
+static void startFskTx(void);
+static void feedFskTx(void);
+static void startRx(bool single);
+static void lookupFrame(void);
+static void startCad(void);
+static void fskFifoPush(uint8_t value);
+static uint8_t fskFifoPop(void);
+static uint32_t nextNoise(void);
+static void txDoneIsr(void *ctx);
+static void rxDoneIsr(void *ctx);
+static void rxTimeoutIsr(void *ctx);
+static void fifoEmptyIsr(void *ctx);
+static void syncAddressIsr(void *ctx);
+static void cadDoneIsr(void *ctx);
+
+/******************************************************************************
+                     Implementation section
+******************************************************************************/
+static bool isLora(void)
+{
+	return 0 != (regCommon[R_OPMODE] & OPMODE_LORA);
+}
+
+static uint8_t currentMode(void)
+{
+	return regCommon[R_OPMODE] & OPMODE_MODE_MASK;
+}
+
+/**************************************************************************//**
+\brief Returns the storage of a register taking the modem overlay into account
+******************************************************************************/
+static uint8_t *regPointer(uint8_t reg)
+{
+	reg &= (REG_COUNT - 1);
+	if (((reg >= 0x02) && (reg <= 0x05)) || ((reg >= 0x0D) && (reg <= 0x3F)))
+	{
+		return isLora() ? &regLora[reg] : &regFsk[reg];
+	}
+	return &regCommon[reg];
+}
+
+static void accountModeTime(void)
+{
+	uint64_t now = HostClock_Now();
+
+	stats.modeTimeUs[currentMode()] += now - modeSince;
+	modeSince = now;
+}
+
+/**************************************************************************//**
+\brief Changes the operating mode from within the model (e.g. automatic
+       return to standby at the end of a transmission)
+******************************************************************************/
+static void setMode(uint8_t mode)
+{
+	accountModeTime();
+	regCommon[R_OPMODE] = (regCommon[R_OPMODE] & ~OPMODE_MODE_MASK) | (mode & OPMODE_MODE_MASK);
+}
+
+static uint8_t dioMapping(uint8_t dio)
+{
+	if (dio < 4)
+	{
+		return (regCommon[R_DIOMAPPING1] >> (6 - (2 * dio))) & 0x03;
+	}
+	return (regCommon[R_DIOMAPPING2] >> (6 - (2 * (dio - 4)))) & 0x03;
+}
+
+static void raiseDio(uint8_t dio)
+{
+	dioLevels |= (uint8_t)(1 << dio);
+	if (dioHandler)
+	{
+		dioHandler(dio);
+	}
+}
+
+static uint32_t nextNoise(void)
+{
+	noiseState ^= noiseState << 13;
+	noiseState ^= noiseState >> 17;
+	noiseState ^= noiseState << 5;
+	return noiseState;
+}
+
+static void fskFifoPush(uint8_t value)
+{
+	if (fskFifoCount < FIFO_SIZE)
+	{
+		fskFifo[(fskFifoHead + fskFifoCount) % FIFO_SIZE] = value;
+		fskFifoCount++;
+	}
+}
+
+static uint8_t fskFifoPop(void)
+{
+	uint8_t value = 0;
+
+	if (fskFifoCount)
+	{
+		value = fskFifo[fskFifoHead];
+		fskFifoHead = (fskFifoHead + 1) % FIFO_SIZE;
+		fskFifoCount--;
+		if (0 == fskFifoCount)
+		{
+			/* PayloadReady and CrcOk are cleared once the FIFO is empty */
+			fskIrqFlags2 &= ~(IRQ2_PAYLOADREADY | IRQ2_CRCOK);
+		}
+	}
+	return value;
+}
+
+static uint32_t readFrequency(void)
+{
+	uint64_t frf = ((uint32_t)regCommon[R_FRFMSB] << 16) |
+		((uint32_t)regCommon[R_FRFMID] << 8) | regCommon[R_FRFLSB];
+
+	/* Fstep = 32MHz / 2^19 = 15625Hz / 2^8 */
+	return (uint32_t)(((frf * 15625u) + 128u) >> 8);
+}
+
+static int8_t readPower(void)
+{
+	uint8_t paConfig = regCommon[R_PACONFIG];
+	int16_t outputPower = paConfig & 0x0F;
+
+	if (paConfig & 0x80)
+	{
+		if (0x07 == (regCommon[R_PADAC] & 0x07))
+		{
+			return (int8_t)(5 + outputPower);
+		}
+		return (int8_t)(2 + outputPower);
+	}
+	/* Pout = 10.8 + 0.6 * MaxPower - 15 + OutputPower */
+	return (int8_t)((108 + (6 * ((paConfig >> 4) & 0x07)) - 150 + (10 * outputPower)) / 10);
+}
+
+static uint32_t readFskBitrate(void)
+{
+	uint32_t divider = ((uint32_t)regFsk[R_FSK_BITRATEMSB] << 8) | regFsk[R_FSK_BITRATELSB];
+
+	return divider ? (uint32_t)(32000000u / divider) : 4800u;
+}
+
+static uint32_t fskBytesTime(uint32_t bytes, uint32_t bitrate)
+{
+	return (uint32_t)(((uint64_t)bytes * 8u * US_PER_SECOND) / bitrate);
+}
+
+/**************************************************************************//**
+\brief Cancels every ongoing transmission, reception or CAD
+******************************************************************************/
+static void stopActivity(void)
+{
+	HostClock_Disarm(&txEvent);
+	HostClock_Disarm(&rxEvent);
+	HostClock_Disarm(&timeoutEvent);
+	HostClock_Disarm(&fifoEvent);
+	HostClock_Disarm(&syncEvent);
+	HostClock_Disarm(&cadEvent);
+	rx.active = false;
+	rx.locked = false;
+	fskTx.active = false;
+}
+
+/**************************************************************************//**
+\brief Handles a write to RegOpMode
+******************************************************************************/
+static void writeOpMode(uint8_t value)
+{
+	uint8_t oldMode = currentMode();
+	uint8_t newMode = value & OPMODE_MODE_MASK;
+
+	/* LongRangeMode can only be modified in sleep mode */
+	if ((SX1276_MODE_SLEEP != oldMode) && ((value ^ regCommon[R_OPMODE]) & OPMODE_LORA))
+	{
+		value = (value & ~OPMODE_LORA) | (regCommon[R_OPMODE] & OPMODE_LORA);
+	}
+
+	accountModeTime();
+	regCommon[R_OPMODE] = value;
+
+	if (newMode == oldMode)
+	{
+		return;
+	}
+
+	stopActivity();
+	dioLevels = 0;
+
+	switch (newMode)
+	{
+		case SX1276_MODE_SLEEP:
+			/* The data buffer is cleared in sleep mode */
+			memset(loraFifo, 0, sizeof(loraFifo));
+			fskFifoHead = 0;
+			fskFifoCount = 0;
+			break;
+
+		case SX1276_MODE_TX:
+			if (isLora())
+			{
+				startLoraTx();
+			}
+			else
+			{
+				startFskTx();
+			}
+			break;
+
+		case SX1276_MODE_RXCONT:
+			startRx(false);
+			break;
+
+		case SX1276_MODE_RXSINGLE:
+			if (isLora())
+			{
+				startRx(true);
+			}
+			break;
+
+		case SX1276_MODE_CAD:
+			if (isLora())
+			{
+				startCad();
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**************************************************************************//**
+\brief Starts a LoRa transmission from the data buffer
+******************************************************************************/
+static void startLoraTx(void)
+{
+	uint8_t base = regLora[R_LORA_FIFOTXBASEADDR];
+
+	memset(&txFrame, 0, sizeof(txFrame));
+	txFrame.start = HostClock_Now();
+	txFrame.frequency = readFrequency();
+	txFrame.lora = true;
+	txFrame.sf = regLora[R_LORA_MODEMCONFIG2] >> 4;
+	txFrame.bw = regLora[R_LORA_MODEMCONFIG1] >> 4;
+	txFrame.cr = (regLora[R_LORA_MODEMCONFIG1] >> 1) & 0x07;
+	txFrame.crcOn = 0 != (regLora[R_LORA_MODEMCONFIG2] & 0x04);
+	txFrame.iqInverted = 0 != (regLora[R_LORA_INVERTIQ] & 0x40);
+	txFrame.preambleLen = ((uint16_t)regLora[R_LORA_PREAMBLEMSB] << 8) | regLora[R_LORA_PREAMBLELSB];
+	txFrame.power = readPower();
+	txFrame.rssi = txFrame.power;
+	txFrame.length = regLora[R_LORA_PAYLOADLENGTH];
+	for (uint16_t i = 0; i < txFrame.length; i++)
+	{
+		txFrame.payload[i] = loraFifo[(uint8_t)(base + i)];
+	}
+	txFrame.duration = SX1276Model_TimeOnAir(&txFrame);
+
+	if (modelAir && modelAir->transmit)
+	{
+		modelAir->transmit(modelAir->ctx, &txFrame);
+	}
+	HostClock_Arm(&txEvent, txFrame.start + txFrame.duration);
+}
+
+/**************************************************************************//**
+\brief Starts an FSK transmission, the FIFO may be refilled on FifoEmpty
+******************************************************************************/
+static void startFskTx(void)
+{
+	memset(&fskTx, 0, sizeof(fskTx));
+	fskTx.active = true;
+	fskTx.frame.start = HostClock_Now();
+	fskTx.frame.frequency = readFrequency();
+	fskTx.frame.lora = false;
+	fskTx.frame.bitrate = readFskBitrate();
+	fskTx.frame.preambleLen = ((uint16_t)regFsk[R_FSK_PREAMBLEMSB] << 8) | regFsk[R_FSK_PREAMBLELSB];
+	fskTx.frame.crcOn = 0 != (regFsk[R_FSK_PACKETCONFIG1] & 0x10);
+	fskTx.frame.power = readPower();
+	fskTx.frame.rssi = fskTx.frame.power;
+	feedFskTx();
+}
+
+/**************************************************************************//**
+\brief Moves FIFO content into the frame being sent
+******************************************************************************/
+static void feedFskTx(void)
+{
+	uint16_t consumed = 0;
+
+	while (fskFifoCount && ((0 == fskTx.needed) || (fskTx.have < fskTx.needed)))
+	{
+		uint8_t value = fskFifoPop();
+
+		if (0 == fskTx.have)
+		{
+			fskTx.frame.length = value;
+			fskTx.needed = (uint16_t)(value + 1);
+		}
+		else
+		{
+			fskTx.frame.payload[fskTx.have - 1] = value;
+		}
+		fskTx.have++;
+		consumed++;
+	}
+
+	if (fskTx.needed && (fskTx.have >= fskTx.needed))
+	{
+		fskTx.frame.duration = SX1276Model_TimeOnAir(&fskTx.frame);
+		if (modelAir && modelAir->transmit)
+		{
+			modelAir->transmit(modelAir->ctx, &fskTx.frame);
+		}
+		HostClock_Disarm(&fifoEvent);
+		HostClock_Arm(&txEvent, fskTx.frame.start + fskTx.frame.duration);
+	}
+	else if (consumed)
+	{
+		HostClock_Arm(&fifoEvent, HostClock_Now() + fskBytesTime(consumed, fskTx.frame.bitrate));
+	}
+}
+
+/**************************************************************************//**
+\brief Starts a reception
+\param[in] single true for RXSINGLE with symbol timeout
+******************************************************************************/
+static void startRx(bool single)
+{
+	uint64_t now = HostClock_Now();
+
+	memset(&rx, 0, sizeof(rx));
+	rx.active = true;
+	rx.single = single;
+	rx.window.open = now;
+	rx.window.frequency = readFrequency();
+	rx.window.lora = isLora();
+	rx.window.detectDeadline = UINT64_MAX;
+
+	if (rx.window.lora)
+	{
+		rx.window.sf = regLora[R_LORA_MODEMCONFIG2] >> 4;
+		rx.window.bw = regLora[R_LORA_MODEMCONFIG1] >> 4;
+		rx.window.iqInverted = 0 != (regLora[R_LORA_INVERTIQ] & 0x40);
+		if (single)
+		{
+			uint32_t symbols = (((uint32_t)regLora[R_LORA_MODEMCONFIG2] & 0x03) << 8) |
+				regLora[R_LORA_SYMBTIMEOUTLSB];
+			rx.window.detectDeadline = now +
+				((uint64_t)symbols * SX1276Model_SymbolTime(rx.window.sf, rx.window.bw));
+			HostClock_Arm(&timeoutEvent, rx.window.detectDeadline);
+		}
+	}
+	lookupFrame();
+}
+
+/**************************************************************************//**
+\brief Asks the medium for a frame the running receiver can lock onto
+******************************************************************************/
+static void lookupFrame(void)
+{
+	uint64_t end;
+
+	if (!rx.active || rx.locked || (NULL == modelAir) || (NULL == modelAir->lookup))
+	{
+		return;
+	}
+
+	if (modelAir->lookup(modelAir->ctx, &rx.window, &rx.frame))
+	{
+		rx.locked = true;
+		HostClock_Disarm(&timeoutEvent);
+
+		end = rx.frame.start + rx.frame.duration;
+		if (end < HostClock_Now())
+		{
+			end = HostClock_Now();
+		}
+		HostClock_Arm(&rxEvent, end);
+
+		if (!rx.window.lora)
+		{
+			uint32_t syncBytes = ((regFsk[R_FSK_SYNCCONFIG] & 0x07) + 1);
+			uint64_t sync = rx.frame.start +
+				fskBytesTime(rx.frame.preambleLen + syncBytes, rx.frame.bitrate);
+			HostClock_Arm(&syncEvent, (sync < HostClock_Now()) ? HostClock_Now() : sync);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief Starts a channel activity detection
+******************************************************************************/
+static void startCad(void)
+{
+	uint8_t sf = regLora[R_LORA_MODEMCONFIG2] >> 4;
+	uint8_t bw = regLora[R_LORA_MODEMCONFIG1] >> 4;
+
+	HostClock_Arm(&cadEvent, HostClock_Now() + (CAD_SYMBOLS * SX1276Model_SymbolTime(sf, bw)));
+}
+
+/******************************************************************************
+                     Interrupt sources
+******************************************************************************/
+static void txDoneIsr(void *ctx)
+{
+	SX1276Frame_t *frame = isLora() ? &txFrame : &fskTx.frame;
+
+	stats.txFrames++;
+	stats.txTimeUs += frame->duration;
+	fskTx.active = false;
+	setMode(SX1276_MODE_STANDBY);
+
+	if (isLora())
+	{
+		loraIrqFlags |= IRQ_TXDONE;
+		if ((0x01 == dioMapping(0)) && !(regLora[R_LORA_IRQFLAGSMASK] & IRQ_TXDONE))
+		{
+			raiseDio(0);
+		}
+	}
+	else
+	{
+		fskIrqFlags2 |= IRQ2_PACKETSENT;
+		if (0x00 == dioMapping(0))
+		{
+			raiseDio(0);
+		}
+	}
+	(void)ctx;
+}
+
+static void rxDoneIsr(void *ctx)
+{
+	SX1276RxOutcome_t outcome = SX1276_RX_OK;
+	uint64_t now = HostClock_Now();
+
+	HostClock_Disarm(&syncEvent);
+	if (modelAir && modelAir->deliver)
+	{
+		outcome = modelAir->deliver(modelAir->ctx, &rx.frame);
+	}
+	rx.locked = false;
+
+	if (SX1276_RX_LOST == outcome)
+	{
+		if (rx.single)
+		{
+			if (now >= rx.window.detectDeadline)
+			{
+				rxTimeoutIsr(NULL);
+				return;
+			}
+			HostClock_Arm(&timeoutEvent, rx.window.detectDeadline);
+		}
+		/* The receiver searches again for a preamble from now on */
+		rx.window.open = now;
+		lookupFrame();
+		return;
+	}
+
+	if (SX1276_RX_OK == outcome)
+	{
+		stats.rxFrames++;
+	}
+	else
+	{
+		stats.rxErrors++;
+	}
+
+	if (rx.window.lora)
+	{
+		uint8_t base = regLora[R_LORA_FIFORXBASEADDR];
+
+		for (uint16_t i = 0; i < rx.frame.length; i++)
+		{
+			loraFifo[(uint8_t)(base + i)] = rx.frame.payload[i];
+		}
+		regLora[R_LORA_FIFORXCURRENTADDR] = base;
+		regLora[R_LORA_FIFORXBYTEADDR] = (uint8_t)(base + rx.frame.length);
+		regLora[R_LORA_RXNBBYTES] = rx.frame.length;
+		regLora[R_LORA_PKTSNRVALUE] = (uint8_t)(rx.frame.snr * 4);
+		regLora[R_LORA_PKTRSSIVALUE] = (uint8_t)(rx.frame.rssi + RSSI_HF_OFFSET);
+		regLora[R_LORA_HOPCHANNEL] = rx.frame.crcOn ? 0x40 : 0x00;
+
+		loraIrqFlags |= IRQ_RXDONE | IRQ_VALIDHEADER;
+		if (SX1276_RX_CRC_ERROR == outcome)
+		{
+			loraIrqFlags |= IRQ_PAYLOADCRCERROR;
+		}
+
+		if (rx.single)
+		{
+			rx.active = false;
+			setMode(SX1276_MODE_STANDBY);
+		}
+		else
+		{
+			rx.window.open = now;
+		}
+
+		if ((0x00 == dioMapping(0)) && !(regLora[R_LORA_IRQFLAGSMASK] & IRQ_RXDONE))
+		{
+			raiseDio(0);
+		}
+	}
+	else
+	{
+		fskFifoPush(rx.frame.length);
+		for (uint16_t i = 0; i < rx.frame.length; i++)
+		{
+			fskFifoPush(rx.frame.payload[i]);
+		}
+		fskIrqFlags2 |= IRQ2_PAYLOADREADY;
+		if (SX1276_RX_OK == outcome)
+		{
+			fskIrqFlags2 |= IRQ2_CRCOK;
+		}
+		rx.window.open = now;
+
+		if (0x00 == dioMapping(0))
+		{
+			raiseDio(0);
+		}
+	}
+
+	/* A continuous receiver goes on listening */
+	lookupFrame();
+	(void)ctx;
+}
+
+static void rxTimeoutIsr(void *ctx)
+{
+	stats.rxTimeouts++;
+	rx.active = false;
+	loraIrqFlags |= IRQ_RXTIMEOUT;
+	setMode(SX1276_MODE_STANDBY);
+
+	if ((0x00 == dioMapping(1)) && !(regLora[R_LORA_IRQFLAGSMASK] & IRQ_RXTIMEOUT))
+	{
+		raiseDio(1);
+	}
+	(void)ctx;
+}
+
+static void fifoEmptyIsr(void *ctx)
+{
+	/* DIO1 = 01 is FifoEmpty in FSK transmit */
+	if (fskTx.active && (0x01 == dioMapping(1)))
+	{
+		raiseDio(1);
+	}
+	(void)ctx;
+}
+
+static void syncAddressIsr(void *ctx)
+{
+	/* DIO2 = 11 is SyncAddress in FSK receive */
+	if (0x03 == dioMapping(2))
+	{
+		raiseDio(2);
+	}
+	(void)ctx;
+}
+
+static void cadDoneIsr(void *ctx)
+{
+	loraIrqFlags |= IRQ_CADDONE;
+	setMode(SX1276_MODE_STANDBY);
+	if ((0x02 == dioMapping(0)) && !(regLora[R_LORA_IRQFLAGSMASK] & IRQ_CADDONE))
+	{
+		raiseDio(0);
+	}
+	(void)ctx;
+}
+
+/******************************************************************************
+                     Interface section
+******************************************************************************/
+/**************************************************************************//**
+\brief Puts the model into its power on reset state
+******************************************************************************/
+void SX1276Model_Reset(void)
+{
+	HostClock_InitEvent(&txEvent, txDoneIsr, NULL);
+	HostClock_InitEvent(&rxEvent, rxDoneIsr, NULL);
+	HostClock_InitEvent(&timeoutEvent, rxTimeoutIsr, NULL);
+	HostClock_InitEvent(&fifoEvent, fifoEmptyIsr, NULL);
+	HostClock_InitEvent(&syncEvent, syncAddressIsr, NULL);
+	HostClock_InitEvent(&cadEvent, cadDoneIsr, NULL);
+	stopActivity();
+
+	memset(regCommon, 0, sizeof(regCommon));
+	memset(regLora, 0, sizeof(regLora));
+	memset(regFsk, 0, sizeof(regFsk));
+	memset(loraFifo, 0, sizeof(loraFifo));
+	fskFifoHead = 0;
+	fskFifoCount = 0;
+	loraIrqFlags = 0;
+	fskIrqFlags2 = 0;
+	dioLevels = 0;
+
+	/* Power on defaults: FSK standby at 434MHz */
+	regCommon[R_OPMODE] = 0x09;
+	regCommon[R_FRFMSB] = 0x6C;
+	regCommon[R_FRFMID] = 0x80;
+	regCommon[R_PACONFIG] = 0x4F;
+	regCommon[R_VERSION] = 0x12;
+	regCommon[R_PADAC] = 0x84;
+
+	regLora[R_LORA_FIFOTXBASEADDR] = 0x80;
+	regLora[R_LORA_MODEMCONFIG1] = 0x72;
+	regLora[R_LORA_MODEMCONFIG2] = 0x70;
+	regLora[R_LORA_SYMBTIMEOUTLSB] = 0x64;
+	regLora[R_LORA_PREAMBLELSB] = 0x08;
+	regLora[R_LORA_PAYLOADLENGTH] = 0x01;
+	regLora[R_LORA_PAYLOADMAXLENGTH] = 0xFF;
+	regLora[R_LORA_INVERTIQ] = 0x27;
+	regLora[R_LORA_SYNCWORD] = 0x12;
+
+	regFsk[R_FSK_BITRATEMSB] = 0x1A;
+	regFsk[R_FSK_BITRATELSB] = 0x0B;
+	regFsk[R_FSK_PREAMBLELSB] = 0x03;
+	regFsk[R_FSK_SYNCCONFIG] = 0x93;
+	regFsk[R_FSK_PACKETCONFIG1] = 0x90;
+	regFsk[R_FSK_IMAGECAL] = 0x82;
+
+	modeSince = HostClock_Now();
+}
+
+/**************************************************************************//**
+\brief Seeds the generator behind the wideband RSSI noise
+******************************************************************************/
+void SX1276Model_Seed(uint32_t seed)
+{
+	noiseState = seed ? seed : 0x2545F491u;
+}
+
+/**************************************************************************//**
+\brief Attaches the model to a medium
+******************************************************************************/
+void SX1276Model_SetAir(const SX1276Air_t *air)
+{
+	modelAir = air;
+}
+
+/**************************************************************************//**
+\brief Registers the handler for rising DIO lines
+******************************************************************************/
+void SX1276Model_SetDioHandler(SX1276DioHandler_t handler)
+{
+	dioHandler = handler;
+}
+
+/**************************************************************************//**
+\brief Notifies the model that a frame has been added to the medium
+******************************************************************************/
+void SX1276Model_AirChanged(void)
+{
+	lookupFrame();
+}
+
+/**************************************************************************//**
+\brief SPI write access to a single register
+******************************************************************************/
+void SX1276Model_WriteRegister(uint8_t reg, uint8_t value)
+{
+	stats.spiTransactions++;
+	stats.spiBytes += 2;
+	SX1276Model_WriteBurst(reg, &value, 1);
+	stats.spiTransactions--;
+	stats.spiBytes -= 2;
+}
+
+/**************************************************************************//**
+\brief SPI read access to a single register
+******************************************************************************/
+uint8_t SX1276Model_ReadRegister(uint8_t reg)
+{
+	uint8_t value;
+
+	SX1276Model_ReadBurst(reg, &value, 1);
+	return value;
+}
+
+/**************************************************************************//**
+\brief SPI burst write
+******************************************************************************/
+void SX1276Model_WriteBurst(uint8_t reg, const uint8_t *buffer, uint8_t length)
+{
+	stats.spiTransactions++;
+	stats.spiBytes += 1u + length;
+	reg &= (REG_COUNT - 1);
+
+	for (uint16_t i = 0; i < length; i++)
+	{
+		uint8_t value = buffer[i];
+
+		if (R_FIFO == reg)
+		{
+			if (isLora())
+			{
+				loraFifo[regLora[R_LORA_FIFOADDRPTR]++] = value;
+			}
+			else
+			{
+				fskFifoPush(value);
+			}
+			/* The FIFO address does not auto-increment */
+			continue;
+		}
+
+		if (R_OPMODE == reg)
+		{
+			writeOpMode(value);
+		}
+		else if (isLora() && (R_LORA_IRQFLAGS == reg))
+		{
+			loraIrqFlags &= ~value;
+			dioLevels = 0;
+		}
+		else if (!isLora() && ((R_FSK_IRQFLAGS1 == reg) || (R_FSK_IRQFLAGS2 == reg)))
+		{
+			if (R_FSK_IRQFLAGS2 == reg)
+			{
+				fskIrqFlags2 &= ~(value & 0x10);
+			}
+		}
+		else if (R_VERSION != reg)
+		{
+			*regPointer(reg) = value;
+		}
+		reg = (reg + 1) & (REG_COUNT - 1);
+	}
+
+	if (fskTx.active && (0 == reg))
+	{
+		feedFskTx();
+	}
+}
+
+/**************************************************************************//**
+\brief SPI burst read
+******************************************************************************/
+void SX1276Model_ReadBurst(uint8_t reg, uint8_t *buffer, uint8_t length)
+{
+	stats.spiTransactions++;
+	stats.spiBytes += 1u + length;
+	reg &= (REG_COUNT - 1);
+
+	for (uint16_t i = 0; i < length; i++)
+	{
+		uint8_t value;
+
+		if (R_FIFO == reg)
+		{
+			buffer[i] = isLora() ? loraFifo[regLora[R_LORA_FIFOADDRPTR]++] : fskFifoPop();
+			continue;
+		}
+
+		if (isLora() && (R_LORA_IRQFLAGS == reg))
+		{
+			value = loraIrqFlags;
+		}
+		else if (isLora() && (R_LORA_RSSIWIDEBAND == reg))
+		{
+			value = (uint8_t)nextNoise();
+		}
+		else if ((isLora() && (R_LORA_RSSIVALUE == reg)) || (!isLora() && (R_FSK_RSSIVALUE == reg)))
+		{
+			int16_t rssi = SX1276_MODEL_NOISE_FLOOR_DBM;
+
+			if (modelAir && modelAir->channelRssi)
+			{
+				rssi = modelAir->channelRssi(modelAir->ctx, readFrequency());
+			}
+			value = isLora() ? (uint8_t)(rssi + RSSI_HF_OFFSET) : (uint8_t)(-2 * rssi);
+		}
+		else if (!isLora() && (R_FSK_IMAGECAL == reg))
+		{
+			/* The image calibration completes immediately */
+			value = regFsk[R_FSK_IMAGECAL] & ~0x20;
+		}
+		else if (!isLora() && (R_FSK_IRQFLAGS1 == reg))
+		{
+			/* ModeReady */
+			value = 0x80;
+		}
+		else if (!isLora() && (R_FSK_IRQFLAGS2 == reg))
+		{
+			value = fskIrqFlags2 | (fskFifoCount ? 0 : IRQ2_FIFOEMPTY);
+		}
+		else
+		{
+			value = *regPointer(reg);
+		}
+		buffer[i] = value;
+		reg = (reg + 1) & (REG_COUNT - 1);
+	}
+}
+
+/**************************************************************************//**
+\brief Returns the logic level of the DIO lines as a bit mask
+******************************************************************************/
+uint8_t SX1276Model_GetDioLevels(void)
+{
+	return dioLevels;
+}
+
+/**************************************************************************//**
+\brief Returns the current operating mode
+******************************************************************************/
+uint8_t SX1276Model_GetOpMode(void)
+{
+	return regCommon[R_OPMODE];
+}
+
+/**************************************************************************//**
+\brief Returns the duration of one LoRa symbol
+******************************************************************************/
+uint32_t SX1276Model_SymbolTime(uint8_t sf, uint8_t bw)
+{
+	uint32_t hz = bandwidthHz[(bw < 10) ? bw : 7];
+
+	return (uint32_t)((((uint64_t)1 << sf) * US_PER_SECOND) / hz);
+}
+
+/**************************************************************************//**
+\brief Computes the time on air of a frame
+******************************************************************************/
+uint32_t SX1276Model_TimeOnAir(const SX1276Frame_t *frame)
+{
+	uint32_t hz;
+	int32_t num;
+	int32_t den;
+	uint32_t payloadSymbols;
+	uint32_t quarterSymbols;
+	bool ldro;
+
+	if (!frame->lora)
+	{
+		uint32_t syncBytes = ((regFsk[R_FSK_SYNCCONFIG] & 0x07) + 1);
+		uint32_t bytes = frame->preambleLen + syncBytes + 1u + frame->length + (frame->crcOn ? 2u : 0u);
+
+		return fskBytesTime(bytes, frame->bitrate ? frame->bitrate : 50000u);
+	}
+
+	hz = bandwidthHz[(frame->bw < 10) ? frame->bw : 7];
+	/* LowDataRateOptimize is mandated for symbols longer than 16ms */
+	ldro = SX1276Model_SymbolTime(frame->sf, frame->bw) > 16000u;
+
+	num = (8 * (int32_t)frame->length) - (4 * (int32_t)frame->sf) + 28 + (frame->crcOn ? 16 : 0);
+	den = 4 * ((int32_t)frame->sf - (ldro ? 2 : 0));
+	payloadSymbols = 8;
+	if (num > 0)
+	{
+		payloadSymbols += (uint32_t)((num + den - 1) / den) * (frame->cr + 4u);
+	}
+
+	/* (preamble + 4.25 + payload) symbols, in quarter symbols */
+	quarterSymbols = (4u * frame->preambleLen) + 17u + (4u * payloadSymbols);
+	return (uint32_t)(((uint64_t)quarterSymbols * ((uint64_t)1 << frame->sf) * US_PER_SECOND) / (4u * (uint64_t)hz));
+}
+
+/**************************************************************************//**
+\brief Checks whether a receiver window can lock onto a frame
+******************************************************************************/
+bool SX1276Model_FrameMatches(const SX1276RxWindow_t *window, const SX1276Frame_t *frame)
+{
+	uint64_t lockTime;
+	int64_t offset = (int64_t)frame->frequency - (int64_t)window->frequency;
+
+	if ((offset > FREQUENCY_TOLERANCE_HZ) || (offset < -FREQUENCY_TOLERANCE_HZ) ||
+		(window->lora != frame->lora))
+	{
+		return false;
+	}
+
+	if (frame->lora)
+	{
+		uint16_t margin = (frame->preambleLen > SX1276_MODEL_PREAMBLE_LOCK) ?
+			(uint16_t)(frame->preambleLen - SX1276_MODEL_PREAMBLE_LOCK) : 0;
+
+		if ((window->sf != frame->sf) || (window->bw != frame->bw) ||
+			(window->iqInverted != frame->iqInverted))
+		{
+			return false;
+		}
+		/* Latest receiver start that still catches enough preamble symbols */
+		lockTime = frame->start + ((uint64_t)margin * SX1276Model_SymbolTime(frame->sf, frame->bw));
+	}
+	else
+	{
+		lockTime = frame->start + fskBytesTime(frame->preambleLen / 2u, frame->bitrate);
+	}
+
+	return (lockTime >= window->open) && (frame->start <= window->detectDeadline);
+}
+
+/**************************************************************************//**
+\brief Reads the activity counters
+******************************************************************************/
+void SX1276Model_GetStats(SX1276ModelStats_t *out)
+{
+	accountModeTime();
+	*out = stats;
+}
+
+/* eof sx1276_model.c */
@@ -0,0 +1,282 @@
+/**
+* \file  sx1276_model.h
+*
+* \brief Register level model of the SX1276 transceiver
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#ifndef SX1276_MODEL_H
+#define SX1276_MODEL_H
+
+/******************************************************************************
+                     Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+                     Macros section
+******************************************************************************/
+#define SX1276_MODEL_MAX_PAYLOAD        (255)
+
+/* Noise floor reported when no signal is present */
+#define SX1276_MODEL_NOISE_FLOOR_DBM    (-125)
+
+/* Number of preamble symbols the modem needs to lock onto a frame */
+#define SX1276_MODEL_PREAMBLE_LOCK      (5)
+
+/* Operating modes, RegOpMode[2:0] */
+#define SX1276_MODE_SLEEP               (0)
+#define SX1276_MODE_STANDBY             (1)
+#define SX1276_MODE_FSTX                (2)
+#define SX1276_MODE_TX                  (3)
+#define SX1276_MODE_FSRX                (4)
+#define SX1276_MODE_RXCONT              (5)
+#define SX1276_MODE_RXSINGLE            (6)
+#define SX1276_MODE_CAD                 (7)
+#define SX1276_MODE_COUNT               (8)
+
+/******************************************************************************
+                     Types section
+******************************************************************************/
+/* A frame on the air */
+typedef struct _SX1276Frame
+{
+	/* Virtual time of the first preamble symbol in microseconds */
+	uint64_t start;
+
+	/* Time on air in microseconds */
+	uint32_t duration;
+
+	/* Carrier frequency in Hz */
+	uint32_t frequency;
+
+	/* true for LoRa, false for FSK */
+	bool lora;
+
+	/* LoRa spreading factor (6..12) */
+	uint8_t sf;
+
+	/* LoRa bandwidth in RegModemConfig1 encoding (7 = 125kHz ... 9 = 500kHz) */
+	uint8_t bw;
+
+	/* LoRa coding rate denominator offset (1 = 4/5 ... 4 = 4/8) */
+	uint8_t cr;
+
+	/* FSK bit rate in bits per second */
+	uint32_t bitrate;
+
+	/* Number of preamble symbols (LoRa) or bytes (FSK) */
+	uint16_t preambleLen;
+
+	/* Whether the I/Q signals are inverted */
+	bool iqInverted;
+
+	/* Whether the payload CRC is present */
+	bool crcOn;
+
+	/* Transmit power in dBm */
+	int8_t power;
+
+	/* Received signal strength and signal to noise ratio at the receiver */
+	int16_t rssi;
+	int8_t snr;
+
+	/* Payload */
+	uint8_t length;
+	uint8_t payload[SX1276_MODEL_MAX_PAYLOAD];
+} SX1276Frame_t;
+
+/* A receive window as seen by the air interface */
+typedef struct _SX1276RxWindow
+{
+	/* Virtual time the receiver was started */
+	uint64_t open;
+
+	/* Latest time a preamble may start to be detected, UINT64_MAX if continuous */
+	uint64_t detectDeadline;
+
+	/* Receiver settings, same encoding as SX1276Frame_t */
+	uint32_t frequency;
+	bool lora;
+	uint8_t sf;
+	uint8_t bw;
+	bool iqInverted;
+} SX1276RxWindow_t;
+
+/* Outcome of a reception decided by the air interface */
+typedef enum _SX1276RxOutcome
+{
+	/* The frame has been received intact */
+	SX1276_RX_OK = 0,
+
+	/* The header was received but the payload got corrupted */
+	SX1276_RX_CRC_ERROR,
+
+	/* The frame could not be demodulated at all */
+	SX1276_RX_LOST
+} SX1276RxOutcome_t;
+
+/*
+* The medium the transceiver is attached to. Every member is optional.
+*/
+typedef struct _SX1276Air
+{
+	/* A transmission has started; the frame is complete at this point */
+	void (*transmit)(void *ctx, const SX1276Frame_t *frame);
+
+	/* Looks up the earliest frame the receiver can lock onto */
+	bool (*lookup)(void *ctx, const SX1276RxWindow_t *window, SX1276Frame_t *frame);
+
+	/* Decides at the end of a frame whether it was received intact */
+	SX1276RxOutcome_t (*deliver)(void *ctx, const SX1276Frame_t *frame);
+
+	/* Returns the instantaneous signal strength in dBm on a frequency */
+	int16_t (*channelRssi)(void *ctx, uint32_t frequency);
+
+	/* Opaque argument of the callbacks */
+	void *ctx;
+} SX1276Air_t;
+
+/* Activity counters of the model */
+typedef struct _SX1276ModelStats
+{
+	/* SPI transactions and bytes clocked including the address byte */
+	uint32_t spiTransactions;
+	uint32_t spiBytes;
+
+	/* Frames sent, received, corrupted and receive timeouts */
+	uint32_t txFrames;
+	uint32_t rxFrames;
+	uint32_t rxErrors;
+	uint32_t rxTimeouts;
+
+	/* Accumulated transmit time in microseconds */
+	uint64_t txTimeUs;
+
+	/* Time spent in every operating mode in microseconds */
+	uint64_t modeTimeUs[SX1276_MODE_COUNT];
+} SX1276ModelStats_t;
+
+/* Handler invoked when a DIO line rises */
+typedef void (*SX1276DioHandler_t)(uint8_t dio);
+
+/******************************************************************************
+                     Prototypes section
+******************************************************************************/
+/**************************************************************************//**
+\brief Puts the model into its power on reset state
+******************************************************************************/
+void SX1276Model_Reset(void);
+
+/**************************************************************************//**
+\brief Seeds the generator behind the wideband RSSI noise
+\param[in] seed Seed value
+******************************************************************************/
+void SX1276Model_Seed(uint32_t seed);
+
+/**************************************************************************//**
+\brief Attaches the model to a medium
+\param[in] air Air interface or NULL to detach
+******************************************************************************/
+void SX1276Model_SetAir(const SX1276Air_t *air);
+
+/**************************************************************************//**
+\brief Registers the handler for rising DIO lines
+\param[in] handler DIO handler
+******************************************************************************/
+void SX1276Model_SetDioHandler(SX1276DioHandler_t handler);
+
+/**************************************************************************//**
+\brief Notifies the model that a frame has been added to the medium so that
+       a running receiver can pick it up
+******************************************************************************/
+void SX1276Model_AirChanged(void);
+
+/**************************************************************************//**
+\brief SPI access to a single register
+******************************************************************************/
+void SX1276Model_WriteRegister(uint8_t reg, uint8_t value);
+uint8_t SX1276Model_ReadRegister(uint8_t reg);
+
+/**************************************************************************//**
+\brief SPI burst access. Address 0 accesses the FIFO, every other address
+       auto-increments.
+******************************************************************************/
+void SX1276Model_WriteBurst(uint8_t reg, const uint8_t *buffer, uint8_t length);
+void SX1276Model_ReadBurst(uint8_t reg, uint8_t *buffer, uint8_t length);
+
+/**************************************************************************//**
+\brief Returns the logic level of the DIO lines as a bit mask
+\return Bit n is set while DIOn is high
+******************************************************************************/
+uint8_t SX1276Model_GetDioLevels(void);
+
+/**************************************************************************//**
+\brief Returns the current operating mode
+\return RegOpMode value
+******************************************************************************/
+uint8_t SX1276Model_GetOpMode(void);
+
+/**************************************************************************//**
+\brief Checks whether a receiver window can lock onto a frame
+\param[in] window Receiver window
+\param[in] frame Candidate frame
+\return true if the frame is detectable in the window
+******************************************************************************/
+bool SX1276Model_FrameMatches(const SX1276RxWindow_t *window, const SX1276Frame_t *frame);
+
+/**************************************************************************//**
+\brief Computes the LoRa time on air of a frame
+\param[in] frame Frame with modem settings and length
+\return Time on air in microseconds
+******************************************************************************/
+uint32_t SX1276Model_TimeOnAir(const SX1276Frame_t *frame);
+
+/**************************************************************************//**
+\brief Returns the duration of one LoRa symbol
+\param[in] sf Spreading factor
+\param[in] bw Bandwidth in RegModemConfig1 encoding
+\return Symbol time in microseconds
+******************************************************************************/
+uint32_t SX1276Model_SymbolTime(uint8_t sf, uint8_t bw);
+
+/**************************************************************************//**
+\brief Reads the activity counters
+\param[out] stats Counters, mode times are accounted up to now
+******************************************************************************/
+void SX1276Model_GetStats(SX1276ModelStats_t *stats);
+
+#endif /* SX1276_MODEL_H */
+
+/* eof sx1276_model.h */